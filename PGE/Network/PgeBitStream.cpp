@@ -0,0 +1,357 @@
+/*
+    ###################################################################################
+    PgeBitStream.cpp
+    This file is part of PGE.
+    PR00F's Game Engine bit-packed serializer
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgeBitStream.h"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace pge_network {
+
+    static constexpr std::size_t nVarUIntGroupBits = 7;
+    static constexpr std::size_t nVarUIntMaxGroups = 5;  // ceil(32 / 7)
+
+    /**
+        @param fMin       Minimum of the range.
+        @param fMax       Maximum of the range, must be greater than fMin.
+        @param fPrecision Maximum allowed difference between adjacent quantized values, must be positive.
+                          The actual error of a quantized value is at most half of this.
+                          Throws std::runtime_error if the parameters are invalid, or more than 32 bits would be needed.
+    */
+    PgeFloatQuantizer::PgeFloatQuantizer(const float& fMin, const float& fMax, const float& fPrecision) noexcept(false) :
+        m_fMin(fMin),
+        m_fMax(fMax),
+        m_nMaxQuantized(0),
+        m_fStepsPerUnit(0),
+        m_fUnitsPerStep(0),
+        m_nBits(0)
+    {
+        if (!(fMin < fMax) || !(fPrecision > 0.f) || !std::isfinite(fMin) || !std::isfinite(fMax))
+        {
+            throw std::runtime_error("PgeFloatQuantizer(): invalid range or precision!");
+        }
+
+        // relative tolerance of float rounding, so that e.g. range 2000 with precision 0.01f is 200000 steps, even though 0.01f is slightly less than 0.01
+        const double fSteps = std::ceil((static_cast<double>(fMax) - fMin) / fPrecision * (1.0 - 1e-6));
+        if (fSteps > std::numeric_limits<uint32_t>::max())
+        {
+            throw std::runtime_error("PgeFloatQuantizer(): precision is too fine for the range!");
+        }
+
+        m_nMaxQuantized = static_cast<uint32_t>(fSteps);
+        m_fStepsPerUnit = m_nMaxQuantized / (static_cast<double>(fMax) - fMin);
+        m_fUnitsPerStep = (static_cast<double>(fMax) - fMin) / m_nMaxQuantized;
+        for (uint64_t n = m_nMaxQuantized; n > 0; n >>= 1)
+        {
+            ++m_nBits;
+        }
+    }
+
+    const float& PgeFloatQuantizer::getMin() const
+    {
+        return m_fMin;
+    }
+
+    const float& PgeFloatQuantizer::getMax() const
+    {
+        return m_fMax;
+    }
+
+    /**
+        @return Number of bits needed for a quantized value.
+    */
+    const std::size_t& PgeFloatQuantizer::getBits() const
+    {
+        return m_nBits;
+    }
+
+    uint32_t PgeFloatQuantizer::quantize(const float& f) const
+    {
+        // written this way so NaN is mapped to minimum
+        if (!(f > m_fMin))
+        {
+            return 0;
+        }
+        if (!(f < m_fMax))
+        {
+            return m_nMaxQuantized;
+        }
+        return static_cast<uint32_t>((static_cast<double>(f) - m_fMin) * m_fStepsPerUnit + 0.5);
+    }
+
+    float PgeFloatQuantizer::dequantize(const uint32_t& nQuantized) const
+    {
+        if (nQuantized >= m_nMaxQuantized)
+        {
+            return m_fMax;
+        }
+        return static_cast<float>(m_fMin + nQuantized * m_fUnitsPerStep);
+    }
+
+
+    /**
+        @param pBuffer        The buffer to write to, must be valid during the lifetime of this writer.
+        @param nCapacityBytes Size of the buffer in bytes.
+    */
+    PgeBitWriter::PgeBitWriter(TByte* pBuffer, const std::size_t& nCapacityBytes) :
+        m_pBuffer(pBuffer),
+        m_nCapacityBits(nCapacityBytes * 8),
+        m_nBitPos(0),
+        m_bOverflowed(false)
+    {
+    }
+
+    /**
+        Writes the lowest nBits bits of the given value.
+
+        @param nValue Value to be written, bits above nBits are ignored.
+        @param nBits  Number of bits to be written, in range [1, 32].
+
+        @return True on success, false if the buffer has not enough space or nBits is invalid.
+    */
+    bool PgeBitWriter::writeBits(const uint32_t& nValue, const std::size_t& nBits)
+    {
+        if (m_bOverflowed || (nBits == 0) || (nBits > 32) || (m_nBitPos + nBits > m_nCapacityBits))
+        {
+            m_bOverflowed = true;
+            return false;
+        }
+
+        const std::size_t iByte = m_nBitPos / 8;
+        const std::size_t nShift = m_nBitPos % 8;
+        const uint64_t nMaskedValue = static_cast<uint64_t>(nValue) & ((uint64_t(1) << nBits) - 1u);
+        // keep the already written lower bits of the current partial byte
+        uint64_t nScratch = (nShift == 0) ? 0u : (m_pBuffer[iByte] & ((1u << nShift) - 1u));
+        nScratch |= nMaskedValue << nShift;
+
+        const std::size_t nBytes = (nShift + nBits + 7) / 8;
+        for (std::size_t i = 0; i < nBytes; i++)
+        {
+            m_pBuffer[iByte + i] = static_cast<TByte>(nScratch >> (8 * i));
+        }
+
+        m_nBitPos += nBits;
+        return true;
+    }
+
+    bool PgeBitWriter::writeBool(const bool& b)
+    {
+        return writeBits(b ? 1u : 0u, 1);
+    }
+
+    /**
+        Writes the given value in groups of 7 bits, each group followed by a continuation bit, so small values take less space:
+        values below 2^7 take 8 bits, below 2^14 take 16 bits, and so on, at most 40 bits.
+    */
+    bool PgeBitWriter::writeVarUInt(const uint32_t& nValue)
+    {
+        uint32_t n = nValue;
+        while (n >= (1u << nVarUIntGroupBits))
+        {
+            if (!writeBits((n & ((1u << nVarUIntGroupBits) - 1u)) | (1u << nVarUIntGroupBits), nVarUIntGroupBits + 1))
+            {
+                return false;
+            }
+            n >>= nVarUIntGroupBits;
+        }
+        return writeBits(n, nVarUIntGroupBits + 1);
+    }
+
+    /**
+        Writes the given value zigzag-encoded as in writeVarUInt(), so small negative values take less space too.
+    */
+    bool PgeBitWriter::writeVarInt(const int32_t& nValue)
+    {
+        const uint32_t nZigZag = (static_cast<uint32_t>(nValue) << 1) ^ static_cast<uint32_t>(nValue >> 31);
+        return writeVarUInt(nZigZag);
+    }
+
+    /**
+        Writes the given float with full 32 bits, for values that cannot be quantized.
+    */
+    bool PgeBitWriter::writeFloat(const float& f)
+    {
+        static_assert(sizeof(float) == sizeof(uint32_t));
+        uint32_t n;
+        memcpy(&n, &f, sizeof(n));
+        return writeBits(n, 32);
+    }
+
+    /**
+        Writes the given float quantized by the given quantizer, taking quantizer.getBits() bits.
+    */
+    bool PgeBitWriter::writeQuantizedFloat(const float& f, const PgeFloatQuantizer& quantizer)
+    {
+        return writeBits(quantizer.quantize(f), quantizer.getBits());
+    }
+
+    std::size_t PgeBitWriter::getSizeBits() const
+    {
+        return m_nBitPos;
+    }
+
+    /**
+        @return Number of bytes written so far, including the last partially written byte.
+    */
+    std::size_t PgeBitWriter::getSizeBytes() const
+    {
+        return (m_nBitPos + 7) / 8;
+    }
+
+    bool PgeBitWriter::isOverflowed() const
+    {
+        return m_bOverflowed;
+    }
+
+    /**
+        Restarts writing from the beginning of the buffer, also clearing the overflow state.
+    */
+    void PgeBitWriter::reset()
+    {
+        m_nBitPos = 0;
+        m_bOverflowed = false;
+    }
+
+
+    /**
+        @param pBuffer    The buffer to read from, must be valid during the lifetime of this reader.
+        @param nSizeBytes Size of the buffer in bytes.
+    */
+    PgeBitReader::PgeBitReader(const TByte* pBuffer, const std::size_t& nSizeBytes) :
+        m_pBuffer(pBuffer),
+        m_nSizeBits(nSizeBytes * 8),
+        m_nBitPos(0),
+        m_bOverflowed(false)
+    {
+    }
+
+    /**
+        @param nValue Output, the value read, unchanged on failure.
+        @param nBits  Number of bits to be read, in range [1, 32].
+
+        @return True on success, false if the buffer has not enough remaining bits or nBits is invalid.
+    */
+    bool PgeBitReader::readBits(uint32_t& nValue, const std::size_t& nBits)
+    {
+        if (m_bOverflowed || (nBits == 0) || (nBits > 32) || (m_nBitPos + nBits > m_nSizeBits))
+        {
+            m_bOverflowed = true;
+            return false;
+        }
+
+        const std::size_t iByte = m_nBitPos / 8;
+        const std::size_t nShift = m_nBitPos % 8;
+        const std::size_t nBytes = (nShift + nBits + 7) / 8;
+        uint64_t nScratch = 0;
+        for (std::size_t i = 0; i < nBytes; i++)
+        {
+            nScratch |= static_cast<uint64_t>(m_pBuffer[iByte + i]) << (8 * i);
+        }
+
+        nValue = static_cast<uint32_t>((nScratch >> nShift) & ((uint64_t(1) << nBits) - 1u));
+        m_nBitPos += nBits;
+        return true;
+    }
+
+    bool PgeBitReader::readBool(bool& b)
+    {
+        uint32_t n;
+        if (!readBits(n, 1))
+        {
+            return false;
+        }
+        b = (n != 0);
+        return true;
+    }
+
+    /**
+        Reads a value written by PgeBitWriter::writeVarUInt().
+        Malformed data, i.e. a value not fitting into 32 bits, is treated as overflow.
+    */
+    bool PgeBitReader::readVarUInt(uint32_t& nValue)
+    {
+        uint64_t n = 0;
+        for (std::size_t iGroup = 0; iGroup < nVarUIntMaxGroups; iGroup++)
+        {
+            uint32_t nGroup;
+            if (!readBits(nGroup, nVarUIntGroupBits + 1))
+            {
+                return false;
+            }
+            n |= static_cast<uint64_t>(nGroup & ((1u << nVarUIntGroupBits) - 1u)) << (iGroup * nVarUIntGroupBits);
+            if ((nGroup & (1u << nVarUIntGroupBits)) == 0)
+            {
+                if (n > std::numeric_limits<uint32_t>::max())
+                {
+                    break;
+                }
+                nValue = static_cast<uint32_t>(n);
+                return true;
+            }
+        }
+
+        m_bOverflowed = true;
+        return false;
+    }
+
+    bool PgeBitReader::readVarInt(int32_t& nValue)
+    {
+        uint32_t nZigZag;
+        if (!readVarUInt(nZigZag))
+        {
+            return false;
+        }
+        nValue = static_cast<int32_t>((nZigZag >> 1) ^ (~(nZigZag & 1u) + 1u));
+        return true;
+    }
+
+    bool PgeBitReader::readFloat(float& f)
+    {
+        uint32_t n;
+        if (!readBits(n, 32))
+        {
+            return false;
+        }
+        memcpy(&f, &n, sizeof(f));
+        return true;
+    }
+
+    /**
+        Reads a float written by PgeBitWriter::writeQuantizedFloat(), the given quantizer must be the same as used for writing.
+    */
+    bool PgeBitReader::readQuantizedFloat(float& f, const PgeFloatQuantizer& quantizer)
+    {
+        uint32_t n;
+        if (!readBits(n, quantizer.getBits()))
+        {
+            return false;
+        }
+        f = quantizer.dequantize(n);
+        return true;
+    }
+
+    std::size_t PgeBitReader::getReadBits() const
+    {
+        return m_nBitPos;
+    }
+
+    std::size_t PgeBitReader::getRemainingBits() const
+    {
+        return m_nSizeBits - m_nBitPos;
+    }
+
+    bool PgeBitReader::isOverflowed() const
+    {
+        return m_bOverflowed;
+    }
+
+} // namespace pge_network
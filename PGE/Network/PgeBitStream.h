@@ -0,0 +1,152 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeBitStream.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine bit-packed serializer
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <cstdint>
+
+#include "PgePacket.h"
+
+namespace pge_network
+{
+
+    /**
+        Maps floats of a given range to unsigned integers of as few bits as needed for the given precision, and back.
+        Values outside the range are clamped, NaN is mapped to the minimum.
+
+        Intended to be constructed once per kind of value, e.g. one for positions, one for angles, and reused for all messages.
+    */
+    class PgeFloatQuantizer
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeFloatQuantizer is included")
+#endif
+
+    public:
+
+        PgeFloatQuantizer(const float& fMin, const float& fMax, const float& fPrecision) noexcept(false);
+        ~PgeFloatQuantizer() = default;
+
+        PgeFloatQuantizer(const PgeFloatQuantizer&) = default;
+        PgeFloatQuantizer& operator=(const PgeFloatQuantizer&) = default;
+        PgeFloatQuantizer(PgeFloatQuantizer&&) = default;
+        PgeFloatQuantizer& operator=(PgeFloatQuantizer&&) = default;
+
+        const float& getMin() const;
+        const float& getMax() const;
+        const std::size_t& getBits() const;
+
+        uint32_t quantize(const float& f) const;
+        float dequantize(const uint32_t& nQuantized) const;
+
+    private:
+
+        float m_fMin;
+        float m_fMax;
+        uint32_t m_nMaxQuantized;  /**< Number of steps within the range. */
+        double m_fStepsPerUnit;
+        double m_fUnitsPerStep;
+        std::size_t m_nBits;
+
+    }; // class PgeFloatQuantizer
+
+    /**
+        Writes values into a caller-provided buffer, packed at bit granularity, least significant bits first.
+
+        The buffer is always complete after each write, so there is no need to flush.
+        Writing beyond the capacity of the buffer does not write anything, and makes all subsequent writes fail too,
+        so it is enough to check isOverflowed() once after writing a whole message.
+
+        Typical usage is writing into a local buffer of MsgApp::nMaxMessageLengthBytes, then copying getSizeBytes() bytes
+        into the memory area returned by PgePacket::preparePktMsgAppFill().
+    */
+    class PgeBitWriter
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeBitWriter is included")
+#endif
+
+    public:
+
+        PgeBitWriter(TByte* pBuffer, const std::size_t& nCapacityBytes);
+        ~PgeBitWriter() = default;
+
+        PgeBitWriter(const PgeBitWriter&) = delete;
+        PgeBitWriter& operator=(const PgeBitWriter&) = delete;
+        PgeBitWriter(PgeBitWriter&&) = delete;
+        PgeBitWriter& operator=(PgeBitWriter&&) = delete;
+
+        bool writeBits(const uint32_t& nValue, const std::size_t& nBits);
+        bool writeBool(const bool& b);
+        bool writeVarUInt(const uint32_t& nValue);
+        bool writeVarInt(const int32_t& nValue);
+        bool writeFloat(const float& f);
+        bool writeQuantizedFloat(const float& f, const PgeFloatQuantizer& quantizer);
+
+        std::size_t getSizeBits() const;
+        std::size_t getSizeBytes() const;
+        bool isOverflowed() const;
+        void reset();
+
+    private:
+
+        TByte* const m_pBuffer;
+        const std::size_t m_nCapacityBits;
+        std::size_t m_nBitPos;
+        bool m_bOverflowed;
+
+    }; // class PgeBitWriter
+
+    /**
+        Reads values written by PgeBitWriter from a caller-provided buffer, values must be read in the same order and with
+        the same widths as they were written.
+
+        Reading beyond the size of the buffer does not change the output value, and makes all subsequent reads fail too,
+        so it is enough to check isOverflowed() once after reading a whole message.
+    */
+    class PgeBitReader
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeBitReader is included")
+#endif
+
+    public:
+
+        PgeBitReader(const TByte* pBuffer, const std::size_t& nSizeBytes);
+        ~PgeBitReader() = default;
+
+        PgeBitReader(const PgeBitReader&) = delete;
+        PgeBitReader& operator=(const PgeBitReader&) = delete;
+        PgeBitReader(PgeBitReader&&) = delete;
+        PgeBitReader& operator=(PgeBitReader&&) = delete;
+
+        bool readBits(uint32_t& nValue, const std::size_t& nBits);
+        bool readBool(bool& b);
+        bool readVarUInt(uint32_t& nValue);
+        bool readVarInt(int32_t& nValue);
+        bool readFloat(float& f);
+        bool readQuantizedFloat(float& f, const PgeFloatQuantizer& quantizer);
+
+        std::size_t getReadBits() const;
+        std::size_t getRemainingBits() const;
+        bool isOverflowed() const;
+
+    private:
+
+        const TByte* const m_pBuffer;
+        const std::size_t m_nSizeBits;
+        std::size_t m_nBitPos;
+        bool m_bOverflowed;
+
+    }; // class PgeBitReader
+
+} // namespace pge_network
@@ -0,0 +1,235 @@
+/*
+    ###################################################################################
+    PgeBulkReceiver.cpp
+    This file is part of PGE.
+    PR00F's Game Engine bulk transfer receiver
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgeBulkReceiver.h"
+
+#include <stdexcept>
+
+namespace pge_network {
+
+    /**
+        @param msgIdChunk        App message id used by PgeBulkSender for sending chunks.
+        @param msgIdAck          App message id to be used for sending acknowledgements.
+                                 Throws std::runtime_error if equals to msgIdChunk.
+        @param nMaxBlobSizeBytes Blobs bigger than this are ignored, so a sender cannot make the receiver allocate arbitrary amount of memory.
+                                 Throws std::runtime_error if 0.
+    */
+    PgeBulkReceiver::PgeBulkReceiver(
+        const MsgApp::TMsgId& msgIdChunk,
+        const MsgApp::TMsgId& msgIdAck,
+        const uint32_t& nMaxBlobSizeBytes) noexcept(false) :
+        m_msgIdChunk(msgIdChunk),
+        m_msgIdAck(msgIdAck),
+        m_nMaxBlobSizeBytes(nMaxBlobSizeBytes),
+        m_nCompletedBlobCount(0),
+        m_nFailedBlobCount(0)
+    {
+        if (msgIdChunk == msgIdAck)
+        {
+            throw std::runtime_error("PgeBulkReceiver(): chunk and ack app message ids must differ!");
+        }
+        if (nMaxBlobSizeBytes == 0)
+        {
+            throw std::runtime_error("PgeBulkReceiver(): max blob size must be positive!");
+        }
+    }
+
+    const MsgApp::TMsgId& PgeBulkReceiver::getMsgIdChunk() const
+    {
+        return m_msgIdChunk;
+    }
+
+    const MsgApp::TMsgId& PgeBulkReceiver::getMsgIdAck() const
+    {
+        return m_msgIdAck;
+    }
+
+    const uint32_t& PgeBulkReceiver::getMaxBlobSizeBytes() const
+    {
+        return m_nMaxBlobSizeBytes;
+    }
+
+    /**
+        Processes the given packet if it carries a chunk sent by PgeBulkSender.
+        Chunks are expected in order: a chunk not continuing the received part of the blob makes the receiver tell the sender where to
+        continue from, and such chunks are ignored until the sender continues from there.
+        When the last chunk of a blob is processed, the checksum of the whole blob is verified: on mismatch, the blob is received again.
+
+        @param serverClient The server or client instance to be used for sending acknowledgements.
+        @param pkt          The received packet.
+
+        @return True if the given packet is a chunk, even if it is ignored, false otherwise.
+    */
+    bool PgeBulkReceiver::handleChunkPkt(PgeIServerClient& serverClient, const PgePacket& pkt)
+    {
+        if ((PgePacket::getPacketId(pkt) != PgePktId::Application) || (PgePacket::getMsgAppIdFromPkt(pkt) != m_msgIdChunk))
+        {
+            return false;
+        }
+
+        const MsgApp& msgApp = *PgePacket::getMsgAppFromPkt(pkt);
+        const MsgApp::TMsgSize nMsgSize = MsgApp::getMsgAppDataActualSizeBytes(msgApp);
+        if (nMsgSize <= sizeof(MsgBulkChunkHeader))
+        {
+            CConsole::getConsoleInstance("PgeBulkReceiver").EOLn("%s: invalid chunk size %u!", __func__, nMsgSize);
+            return true;
+        }
+
+        MsgBulkChunkHeader header;
+        memcpy(&header, MsgApp::getMsgAppData(msgApp), sizeof(header));
+        const uint32_t nDataSize = nMsgSize - sizeof(MsgBulkChunkHeader);
+        if ((header.m_nBlobSizeBytes > m_nMaxBlobSizeBytes) ||
+            (header.m_nOffset > header.m_nBlobSizeBytes) ||
+            (nDataSize > header.m_nBlobSizeBytes - header.m_nOffset))
+        {
+            CConsole::getConsoleInstance("PgeBulkReceiver").EOLn("%s: invalid chunk of blob %u: size %u, offset %u, data size %u!",
+                __func__, header.m_blobId, header.m_nBlobSizeBytes, header.m_nOffset, nDataSize);
+            return true;
+        }
+
+        const PgeNetworkConnectionHandle connHandle = PgePacket::getServerSideConnectionHandle(pkt);
+        Blob& blob = m_mapBlobs[header.m_blobId];
+        if ((blob.m_vData.size() != header.m_nBlobSizeBytes) || (blob.m_nBlobChecksum != header.m_nBlobChecksum))
+        {
+            // new blob, or the sender has a different blob with the same id: what we have is useless
+            blob.m_vData.resize(header.m_nBlobSizeBytes);
+            blob.m_nBlobChecksum = header.m_nBlobChecksum;
+            blob.m_nReceivedBytes = 0;
+            blob.m_nAckedBytes = 0;
+            blob.m_bComplete = false;
+            blob.m_bResumeSent = false;
+        }
+
+        if (header.m_nOffset == 0)
+        {
+            // sender always starts from the beginning, and also continues from there if we told so
+            blob.m_bResumeSent = false;
+        }
+
+        if (blob.m_bComplete || (header.m_nOffset != blob.m_nReceivedBytes))
+        {
+            // chunks sent before the sender processed our resume ack are also ignored here, without telling again
+            if (!blob.m_bResumeSent)
+            {
+                sendAck(serverClient, connHandle, header.m_blobId, blob, true);
+            }
+            return true;
+        }
+
+        memcpy(blob.m_vData.data() + header.m_nOffset, MsgApp::getMsgAppData(msgApp) + sizeof(MsgBulkChunkHeader), nDataSize);
+        blob.m_nReceivedBytes += nDataSize;
+        blob.m_bResumeSent = false;
+
+        if (blob.m_nReceivedBytes == header.m_nBlobSizeBytes)
+        {
+            if (PgeBulkTransfer::getChecksum(blob.m_vData.data(), blob.m_vData.size()) == blob.m_nBlobChecksum)
+            {
+                blob.m_bComplete = true;
+                ++m_nCompletedBlobCount;
+                sendAck(serverClient, connHandle, header.m_blobId, blob, false);
+                CConsole::getConsoleInstance("PgeBulkReceiver").OLn("%s: blob %u received", __func__, header.m_blobId);
+            }
+            else
+            {
+                CConsole::getConsoleInstance("PgeBulkReceiver").EOLn("%s: checksum mismatch of blob %u, receiving again!", __func__, header.m_blobId);
+                ++m_nFailedBlobCount;
+                blob.m_nReceivedBytes = 0;
+                sendAck(serverClient, connHandle, header.m_blobId, blob, true);
+            }
+        }
+        else if (blob.m_nReceivedBytes - blob.m_nAckedBytes >= PgeBulkTransfer::nAckIntervalBytes)
+        {
+            sendAck(serverClient, connHandle, header.m_blobId, blob, false);
+        }
+        return true;
+    }
+
+    /**
+        Gets progress of the given blob.
+
+        @return True if any chunk of the given blob has been received, false otherwise.
+    */
+    bool PgeBulkReceiver::getProgress(const PgeBulkTransfer::TBlobId& blobId, PgeBulkTransfer::Progress& progress) const
+    {
+        const auto it = m_mapBlobs.find(blobId);
+        if (it == m_mapBlobs.end())
+        {
+            return false;
+        }
+        progress.m_nBlobSizeBytes = static_cast<uint32_t>(it->second.m_vData.size());
+        progress.m_nDoneBytes = it->second.m_nReceivedBytes;
+        progress.m_bComplete = it->second.m_bComplete;
+        return true;
+    }
+
+    /**
+        @return The given blob if it has been completely received and verified, nullptr otherwise.
+    */
+    const std::vector<TByte>* PgeBulkReceiver::getBlob(const PgeBulkTransfer::TBlobId& blobId) const
+    {
+        const auto it = m_mapBlobs.find(blobId);
+        return ((it == m_mapBlobs.end()) || !it->second.m_bComplete) ? nullptr : &it->second.m_vData;
+    }
+
+    /**
+        Frees the given blob, complete or not. If the sender is still sending it, it will be received from the beginning.
+
+        @return True if there was such blob, false otherwise.
+    */
+    bool PgeBulkReceiver::removeBlob(const PgeBulkTransfer::TBlobId& blobId)
+    {
+        return m_mapBlobs.erase(blobId) > 0;
+    }
+
+    uint32_t PgeBulkReceiver::getCompletedBlobCount() const
+    {
+        return m_nCompletedBlobCount;
+    }
+
+    /**
+        @return Number of times a blob failed checksum verification after receiving all its bytes.
+    */
+    uint32_t PgeBulkReceiver::getFailedBlobCount() const
+    {
+        return m_nFailedBlobCount;
+    }
+
+    void PgeBulkReceiver::sendAck(
+        PgeIServerClient& serverClient,
+        const PgeNetworkConnectionHandle& connHandle,
+        const PgeBulkTransfer::TBlobId& blobId,
+        Blob& blob,
+        const bool& bResume) const
+    {
+        PgePacket pkt;
+        // server overwrites the connection handle with the actual handle of the client upon receiving
+        PgePacket::initPktMsgApp(pkt, ServerConnHandle, PgePacket::AutoFill::NONE);
+        TByte* const pData = PgePacket::preparePktMsgAppFill(pkt, m_msgIdAck, sizeof(MsgBulkAck));
+        if (!pData)
+        {
+            CConsole::getConsoleInstance("PgeBulkReceiver").EOLn("%s: preparePktMsgAppFill() failed!", __func__);
+            return;
+        }
+
+        MsgBulkAck ack;
+        ack.m_blobId = blobId;
+        ack.m_nBlobChecksum = blob.m_nBlobChecksum;
+        ack.m_nReceivedBytes = blob.m_nReceivedBytes;
+        ack.m_bResume = bResume;
+        memcpy(pData, &ack, sizeof(ack));
+        // chunk packets received by client have ServerConnHandle, by server have the handle of the client
+        serverClient.send(pkt, connHandle);
+
+        blob.m_nAckedBytes = blob.m_nReceivedBytes;
+        blob.m_bResumeSent = bResume;
+    }
+
+} // namespace pge_network
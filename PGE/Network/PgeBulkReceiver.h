@@ -0,0 +1,96 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeBulkReceiver.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine bulk transfer receiver
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <map>
+#include <vector>
+
+#include "PgeBulkTransfer.h"
+#include "PgeIServerClient.h"
+#include "PgePacket.h"
+
+namespace pge_network
+{
+
+    /**
+        Receiving side of the bulk transfer channel, the sending side is PgeBulkSender. Can be used on both server and client side.
+
+        Blobs are identified by their id only, so blob ids must be unique across all senders, e.g. a server receiving blobs from multiple
+        clients should have the clients include something client-specific in the blob id.
+        The buffer of a blob is allocated with the full blob size when its first chunk is received, and chunks are copied right into place.
+
+        Blobs are kept until removeBlob(), also the incomplete ones, even if the connection is lost: so when the sender starts sending
+        the same blob again, e.g. after reconnecting, the receiver tells the sender to continue from where it stopped.
+        A complete blob is never received again: the sender is told right away that the blob is already here.
+    */
+    class PgeBulkReceiver
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeBulkReceiver is included")
+#endif
+
+    public:
+
+        PgeBulkReceiver(
+            const MsgApp::TMsgId& msgIdChunk,
+            const MsgApp::TMsgId& msgIdAck,
+            const uint32_t& nMaxBlobSizeBytes) noexcept(false);
+        ~PgeBulkReceiver() = default;
+
+        PgeBulkReceiver(const PgeBulkReceiver&) = delete;
+        PgeBulkReceiver& operator=(const PgeBulkReceiver&) = delete;
+        PgeBulkReceiver(PgeBulkReceiver&&) = delete;
+        PgeBulkReceiver& operator=(PgeBulkReceiver&&) = delete;
+
+        const MsgApp::TMsgId& getMsgIdChunk() const;
+        const MsgApp::TMsgId& getMsgIdAck() const;
+        const uint32_t& getMaxBlobSizeBytes() const;
+
+        bool handleChunkPkt(PgeIServerClient& serverClient, const PgePacket& pkt);
+
+        bool getProgress(const PgeBulkTransfer::TBlobId& blobId, PgeBulkTransfer::Progress& progress) const;
+        const std::vector<TByte>* getBlob(const PgeBulkTransfer::TBlobId& blobId) const;
+        bool removeBlob(const PgeBulkTransfer::TBlobId& blobId);
+
+        uint32_t getCompletedBlobCount() const;
+        uint32_t getFailedBlobCount() const;
+
+    private:
+
+        struct Blob
+        {
+            std::vector<TByte> m_vData;          /**< Allocated with the full blob size upfront. */
+            uint32_t m_nBlobChecksum;
+            uint32_t m_nReceivedBytes;           /**< Received in order. */
+            uint32_t m_nAckedBytes;              /**< Last acknowledged. */
+            bool m_bComplete;
+            bool m_bResumeSent;                  /**< Waiting for the sender to continue as told by the last resume ack. */
+        };
+
+        const MsgApp::TMsgId m_msgIdChunk;
+        const MsgApp::TMsgId m_msgIdAck;
+        const uint32_t m_nMaxBlobSizeBytes;
+        std::map<PgeBulkTransfer::TBlobId, Blob> m_mapBlobs;
+        uint32_t m_nCompletedBlobCount;
+        uint32_t m_nFailedBlobCount;
+
+        void sendAck(
+            PgeIServerClient& serverClient,
+            const PgeNetworkConnectionHandle& connHandle,
+            const PgeBulkTransfer::TBlobId& blobId,
+            Blob& blob,
+            const bool& bResume) const;
+
+    }; // class PgeBulkReceiver
+
+} // namespace pge_network
@@ -0,0 +1,414 @@
+/*
+    ###################################################################################
+    PgeBulkSender.cpp
+    This file is part of PGE.
+    PR00F's Game Engine bulk transfer sender
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgeBulkSender.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace pge_network {
+
+    static constexpr int64_t nMicroBytesPerByte = 1000000;
+    static constexpr PgeBulkTransfer::TTimeUSecs nMaxUpdateGapUSecs = 1000000;
+
+    /**
+        @param msgIdChunk App message id to be used for sending chunks.
+        @param msgIdAck   App message id to be used by PgeBulkReceiver for sending acknowledgements.
+                          Throws std::runtime_error if equals to msgIdChunk.
+    */
+    PgeBulkSender::PgeBulkSender(
+        const MsgApp::TMsgId& msgIdChunk,
+        const MsgApp::TMsgId& msgIdAck) noexcept(false) :
+        m_msgIdChunk(msgIdChunk),
+        m_msgIdAck(msgIdAck),
+        m_nBytesPerSecond(nDefaultBytesPerSecond),
+        m_nMaxBytesInFlight(nDefaultMaxBytesInFlight),
+        m_nCompletedTransferCount(0),
+        m_nSentChunkDataBytes(0)
+    {
+        if (msgIdChunk == msgIdAck)
+        {
+            throw std::runtime_error("PgeBulkSender(): chunk and ack app message ids must differ!");
+        }
+    }
+
+    const MsgApp::TMsgId& PgeBulkSender::getMsgIdChunk() const
+    {
+        return m_msgIdChunk;
+    }
+
+    const MsgApp::TMsgId& PgeBulkSender::getMsgIdAck() const
+    {
+        return m_msgIdAck;
+    }
+
+    /**
+        @return Bandwidth budget of bulk data per connection, including chunk headers.
+    */
+    const uint32_t& PgeBulkSender::getBytesPerSecond() const
+    {
+        return m_nBytesPerSecond;
+    }
+
+    /**
+        Sets the bandwidth budget of bulk data per connection, including chunk headers.
+        Throws std::runtime_error if 0.
+    */
+    void PgeBulkSender::setBytesPerSecond(const uint32_t& nBytesPerSecond) noexcept(false)
+    {
+        if (nBytesPerSecond == 0)
+        {
+            throw std::runtime_error("PgeBulkSender::setBytesPerSecond(): budget must be positive!");
+        }
+        m_nBytesPerSecond = nBytesPerSecond;
+    }
+
+    /**
+        @return Maximum number of blob bytes sent to a connection ahead of the progress acknowledged by the receiver, per transfer.
+    */
+    const uint32_t& PgeBulkSender::getMaxBytesInFlight() const
+    {
+        return m_nMaxBytesInFlight;
+    }
+
+    /**
+        Sets the maximum number of blob bytes sent to a connection ahead of the progress acknowledged by the receiver, per transfer.
+        Throws std::runtime_error if less than nMinMaxBytesInFlight, since the receiver acknowledges only every
+        PgeBulkTransfer::nAckIntervalBytes bytes.
+    */
+    void PgeBulkSender::setMaxBytesInFlight(const uint32_t& nMaxBytesInFlight) noexcept(false)
+    {
+        if (nMaxBytesInFlight < nMinMaxBytesInFlight)
+        {
+            throw std::runtime_error("PgeBulkSender::setMaxBytesInFlight(): too small value!");
+        }
+        m_nMaxBytesInFlight = nMaxBytesInFlight;
+    }
+
+    /**
+        Registers the given blob to be sent to the given connection by subsequent update() calls.
+        A completed transfer of the same blob to the same connection is restarted.
+
+        @param connHandle The connection to send to, ServerConnHandle on client side.
+        @param blobId     Id of the blob, identifying it on the receiver side, so it must not be used for a different blob
+                          while the receiver still keeps the old one, unless the application wants it to be replaced.
+        @param pBlob      The blob, must not be modified until the transfer is complete or cancelled.
+
+        @return True on success, false if blob is null, empty or too big, or is being sent to the connection already.
+    */
+    bool PgeBulkSender::startTransfer(
+        const PgeNetworkConnectionHandle& connHandle,
+        const PgeBulkTransfer::TBlobId& blobId,
+        const std::shared_ptr<const std::vector<TByte>>& pBlob)
+    {
+        if (!pBlob || pBlob->empty() || (pBlob->size() > std::numeric_limits<uint32_t>::max()))
+        {
+            CConsole::getConsoleInstance("PgeBulkSender").EOLn("%s: invalid blob %u!", __func__, blobId);
+            return false;
+        }
+
+        Transfer* pTransfer = findTransfer(connHandle, blobId);
+        if (pTransfer && !pTransfer->m_bComplete)
+        {
+            CConsole::getConsoleInstance("PgeBulkSender").EOLn("%s: blob %u is already being sent to connection %u!", __func__, blobId, connHandle);
+            return false;
+        }
+        if (!pTransfer)
+        {
+            pTransfer = &m_mapConnections[connHandle].m_vTransfers.emplace_back();
+        }
+
+        pTransfer->m_blobId = blobId;
+        pTransfer->m_pBlob = pBlob;
+        pTransfer->m_nBlobSizeBytes = static_cast<uint32_t>(pBlob->size());
+        pTransfer->m_nBlobChecksum = PgeBulkTransfer::getChecksum(pBlob->data(), pBlob->size());
+        pTransfer->m_nNextOffset = 0;
+        pTransfer->m_nAckedOffset = 0;
+        pTransfer->m_bComplete = false;
+        return true;
+    }
+
+    /**
+        Forgets the given transfer, the receiver keeps the part already received, so the transfer can be resumed later.
+
+        @return True if there was such transfer, false otherwise.
+    */
+    bool PgeBulkSender::cancelTransfer(const PgeNetworkConnectionHandle& connHandle, const PgeBulkTransfer::TBlobId& blobId)
+    {
+        const auto itConn = m_mapConnections.find(connHandle);
+        if (itConn == m_mapConnections.end())
+        {
+            return false;
+        }
+
+        std::vector<Transfer>& vTransfers = itConn->second.m_vTransfers;
+        const auto it = std::find_if(vTransfers.begin(), vTransfers.end(), [&blobId](const Transfer& transfer) { return transfer.m_blobId == blobId; });
+        if (it == vTransfers.end())
+        {
+            return false;
+        }
+        vTransfers.erase(it);
+        return true;
+    }
+
+    /**
+        Forgets all transfers of the given connection, e.g. when it disconnects.
+    */
+    void PgeBulkSender::removeClient(const PgeNetworkConnectionHandle& connHandle)
+    {
+        m_mapConnections.erase(connHandle);
+    }
+
+    /**
+        Sends as many chunks to each connection as its bandwidth budget allows, taking turns between the transfers of the connection.
+        The budget grows with the time elapsed since the previous invocation, up to 100 ms worth of it, so a long pause between
+        invocations does not result in a burst.
+
+        @param serverClient The server or client instance to be used for sending.
+        @param nTimeUSecs   Current time in microseconds, any monotonic clock.
+    */
+    void PgeBulkSender::update(PgeIServerClient& serverClient, const PgeBulkTransfer::TTimeUSecs& nTimeUSecs)
+    {
+        const int64_t nMaxBudgetMicroBytes = getMaxBudgetMicroBytes();
+        for (auto& connHandleAndConn : m_mapConnections)
+        {
+            Connection& conn = connHandleAndConn.second;
+            if (conn.m_bUpdated)
+            {
+                const PgeBulkTransfer::TTimeUSecs nElapsedUSecs = std::clamp(nTimeUSecs - conn.m_nLastUpdateUSecs, PgeBulkTransfer::TTimeUSecs(0), nMaxUpdateGapUSecs);
+                conn.m_nBudgetMicroBytes = std::min(conn.m_nBudgetMicroBytes + nElapsedUSecs * m_nBytesPerSecond, nMaxBudgetMicroBytes);
+            }
+            else
+            {
+                conn.m_nBudgetMicroBytes = nMaxBudgetMicroBytes;
+                conn.m_bUpdated = true;
+            }
+            conn.m_nLastUpdateUSecs = nTimeUSecs;
+
+            // 1 chunk per transfer in turns, stopping when a full round found nothing to send
+            std::size_t nIdleCount = 0;
+            while (nIdleCount < conn.m_vTransfers.size())
+            {
+                if (conn.m_iNextTransfer >= conn.m_vTransfers.size())
+                {
+                    conn.m_iNextTransfer = 0;
+                }
+                Transfer& transfer = conn.m_vTransfers[conn.m_iNextTransfer];
+                if (!isSendable(transfer))
+                {
+                    ++nIdleCount;
+                    ++conn.m_iNextTransfer;
+                    continue;
+                }
+
+                const uint32_t nDataSize = getNextChunkDataSize(transfer);
+                const int64_t nCostMicroBytes = (PgeBulkTransfer::nChunkHeaderSizeBytes + nDataSize) * nMicroBytesPerByte;
+                if (conn.m_nBudgetMicroBytes < nCostMicroBytes)
+                {
+                    // this transfer takes its turn first next time
+                    break;
+                }
+                if (!sendChunk(serverClient, connHandleAndConn.first, transfer, nDataSize))
+                {
+                    break;
+                }
+                conn.m_nBudgetMicroBytes -= nCostMicroBytes;
+                nIdleCount = 0;
+                ++conn.m_iNextTransfer;
+            }
+        }
+    }
+
+    /**
+        Processes the given packet if it carries an acknowledgement sent by PgeBulkReceiver.
+        The connection is identified by the server-side connection handle of the packet.
+        Acknowledgements of unknown transfers are ignored, e.g. those arriving after cancelTransfer().
+
+        @return True if the given packet is an acknowledgement, false otherwise.
+    */
+    bool PgeBulkSender::handleAckPkt(const PgePacket& pkt)
+    {
+        if ((PgePacket::getPacketId(pkt) != PgePktId::Application) || (PgePacket::getMsgAppIdFromPkt(pkt) != m_msgIdAck))
+        {
+            return false;
+        }
+
+        const MsgApp& msgApp = *PgePacket::getMsgAppFromPkt(pkt);
+        if (MsgApp::getMsgAppDataActualSizeBytes(msgApp) != sizeof(MsgBulkAck))
+        {
+            CConsole::getConsoleInstance("PgeBulkSender").EOLn("%s: invalid ack size %u!", __func__, MsgApp::getMsgAppDataActualSizeBytes(msgApp));
+            return true;
+        }
+
+        MsgBulkAck ack;
+        memcpy(&ack, MsgApp::getMsgAppData(msgApp), sizeof(ack));
+        Transfer* const pTransfer = findTransfer(PgePacket::getServerSideConnectionHandle(pkt), ack.m_blobId);
+        if (!pTransfer || pTransfer->m_bComplete)
+        {
+            return true;
+        }
+        if ((ack.m_nBlobChecksum != pTransfer->m_nBlobChecksum) || (ack.m_nReceivedBytes > pTransfer->m_nBlobSizeBytes))
+        {
+            CConsole::getConsoleInstance("PgeBulkSender").EOLn("%s: invalid ack of blob %u: checksum %u, received bytes %u!",
+                __func__, ack.m_blobId, ack.m_nBlobChecksum, ack.m_nReceivedBytes);
+            return true;
+        }
+
+        if (ack.m_bResume)
+        {
+            // both forward (receiver already has more) and backward (receiver dropped what it had)
+            pTransfer->m_nAckedOffset = ack.m_nReceivedBytes;
+            pTransfer->m_nNextOffset = ack.m_nReceivedBytes;
+        }
+        else if (ack.m_nReceivedBytes > pTransfer->m_nAckedOffset)
+        {
+            pTransfer->m_nAckedOffset = ack.m_nReceivedBytes;
+            pTransfer->m_nNextOffset = std::max(pTransfer->m_nNextOffset, pTransfer->m_nAckedOffset);
+        }
+
+        if (pTransfer->m_nAckedOffset == pTransfer->m_nBlobSizeBytes)
+        {
+            pTransfer->m_bComplete = true;
+            pTransfer->m_pBlob.reset();
+            ++m_nCompletedTransferCount;
+            CConsole::getConsoleInstance("PgeBulkSender").OLn("%s: blob %u sent to connection %u",
+                __func__, ack.m_blobId, PgePacket::getServerSideConnectionHandle(pkt));
+        }
+        return true;
+    }
+
+    /**
+        Gets progress of the given transfer as acknowledged by the receiver.
+        Completed transfers are kept until cancelTransfer() or removeClient().
+
+        @return True if there is such transfer, false otherwise.
+    */
+    bool PgeBulkSender::getProgress(
+        const PgeNetworkConnectionHandle& connHandle,
+        const PgeBulkTransfer::TBlobId& blobId,
+        PgeBulkTransfer::Progress& progress) const
+    {
+        const Transfer* const pTransfer = findTransfer(connHandle, blobId);
+        if (!pTransfer)
+        {
+            return false;
+        }
+        progress.m_nBlobSizeBytes = pTransfer->m_nBlobSizeBytes;
+        progress.m_nDoneBytes = pTransfer->m_nAckedOffset;
+        progress.m_bComplete = pTransfer->m_bComplete;
+        return true;
+    }
+
+    /**
+        @return Number of not yet completed transfers of all connections.
+    */
+    std::size_t PgeBulkSender::getActiveTransferCount() const
+    {
+        std::size_t nCount = 0;
+        for (const auto& connHandleAndConn : m_mapConnections)
+        {
+            nCount += std::count_if(
+                connHandleAndConn.second.m_vTransfers.begin(),
+                connHandleAndConn.second.m_vTransfers.end(),
+                [](const Transfer& transfer) { return !transfer.m_bComplete; });
+        }
+        return nCount;
+    }
+
+    uint32_t PgeBulkSender::getCompletedTransferCount() const
+    {
+        return m_nCompletedTransferCount;
+    }
+
+    /**
+        @return Total number of blob bytes sent in chunks, including bytes sent again after resuming, excluding chunk headers.
+    */
+    uint64_t PgeBulkSender::getSentChunkDataBytes() const
+    {
+        return m_nSentChunkDataBytes;
+    }
+
+    PgeBulkSender::Transfer* PgeBulkSender::findTransfer(const PgeNetworkConnectionHandle& connHandle, const PgeBulkTransfer::TBlobId& blobId)
+    {
+        return const_cast<Transfer*>(static_cast<const PgeBulkSender*>(this)->findTransfer(connHandle, blobId));
+    }
+
+    const PgeBulkSender::Transfer* PgeBulkSender::findTransfer(const PgeNetworkConnectionHandle& connHandle, const PgeBulkTransfer::TBlobId& blobId) const
+    {
+        const auto itConn = m_mapConnections.find(connHandle);
+        if (itConn == m_mapConnections.end())
+        {
+            return nullptr;
+        }
+        for (const auto& transfer : itConn->second.m_vTransfers)
+        {
+            if (transfer.m_blobId == blobId)
+            {
+                return &transfer;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+        @return 100 ms worth of budget, but at least a full chunk so any budget can make progress.
+    */
+    int64_t PgeBulkSender::getMaxBudgetMicroBytes() const
+    {
+        return std::max(
+            static_cast<int64_t>(m_nBytesPerSecond) * (nMicroBytesPerByte / 10),
+            static_cast<int64_t>(MsgApp::nMaxMessageLengthBytes) * nMicroBytesPerByte);
+    }
+
+    bool PgeBulkSender::isSendable(const Transfer& transfer) const
+    {
+        return !transfer.m_bComplete &&
+            (transfer.m_nNextOffset < transfer.m_nBlobSizeBytes) &&
+            (transfer.m_nNextOffset - transfer.m_nAckedOffset < m_nMaxBytesInFlight);
+    }
+
+    uint32_t PgeBulkSender::getNextChunkDataSize(const Transfer& transfer) const
+    {
+        return std::min(transfer.m_nBlobSizeBytes - transfer.m_nNextOffset, static_cast<uint32_t>(PgeBulkTransfer::nMaxChunkDataSizeBytes));
+    }
+
+    bool PgeBulkSender::sendChunk(
+        PgeIServerClient& serverClient,
+        const PgeNetworkConnectionHandle& connHandle,
+        Transfer& transfer,
+        const uint32_t& nDataSize)
+    {
+        PgePacket pkt;
+        PgePacket::initPktMsgApp(pkt, ServerConnHandle, PgePacket::AutoFill::NONE);
+        TByte* const pData = PgePacket::preparePktMsgAppFill(
+            pkt, m_msgIdChunk, static_cast<MsgApp::TMsgSize>(PgeBulkTransfer::nChunkHeaderSizeBytes + nDataSize));
+        if (!pData)
+        {
+            CConsole::getConsoleInstance("PgeBulkSender").EOLn("%s: preparePktMsgAppFill() failed!", __func__);
+            return false;
+        }
+
+        MsgBulkChunkHeader header;
+        header.m_blobId = transfer.m_blobId;
+        header.m_nBlobSizeBytes = transfer.m_nBlobSizeBytes;
+        header.m_nBlobChecksum = transfer.m_nBlobChecksum;
+        header.m_nOffset = transfer.m_nNextOffset;
+        memcpy(pData, &header, sizeof(header));
+        memcpy(pData + sizeof(header), transfer.m_pBlob->data() + transfer.m_nNextOffset, nDataSize);
+        serverClient.send(pkt, connHandle);
+
+        transfer.m_nNextOffset += nDataSize;
+        m_nSentChunkDataBytes += nDataSize;
+        return true;
+    }
+
+} // namespace pge_network
@@ -0,0 +1,135 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeBulkSender.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine bulk transfer sender
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "PgeBulkTransfer.h"
+#include "PgeIServerClient.h"
+#include "PgePacket.h"
+
+namespace pge_network
+{
+
+    /**
+        Sending side of the bulk transfer channel, the receiving side is PgeBulkReceiver. Can be used on both server and client side,
+        on client side the connection handle of transfers is always ServerConnHandle.
+
+        startTransfer() only registers a blob to be sent to a connection, chunks are sent by update() invoked regularly, e.g. every tick.
+        Each connection has its own bandwidth budget shared by all its transfers in round-robin fashion, so bulk data is spread over time
+        instead of filling the send buffer at once and delaying gameplay messages behind it: set the budget to what remains of the link
+        capacity after gameplay traffic.
+        Also at most getMaxBytesInFlight() bytes are sent ahead of the progress acknowledged by the receiver, so a slow receiver cannot make
+        bulk data pile up in the send buffer either.
+
+        Blob data is shared, not copied, so the same blob can be sent to any number of clients without extra memory.
+        Transfers are resumable: if a client reconnects and the same blob is started to be sent to its new connection, the receiver tells
+        how much it already has, and the transfer continues from there, only at most getMaxBytesInFlight() bytes being sent again.
+    */
+    class PgeBulkSender
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeBulkSender is included")
+#endif
+
+    public:
+
+        static constexpr uint32_t nDefaultBytesPerSecond = 128 * 1024;
+        static constexpr uint32_t nDefaultMaxBytesInFlight = 32 * 1024;
+        static constexpr uint32_t nMinMaxBytesInFlight = 2 * PgeBulkTransfer::nAckIntervalBytes;
+
+        PgeBulkSender(
+            const MsgApp::TMsgId& msgIdChunk,
+            const MsgApp::TMsgId& msgIdAck) noexcept(false);
+        ~PgeBulkSender() = default;
+
+        PgeBulkSender(const PgeBulkSender&) = delete;
+        PgeBulkSender& operator=(const PgeBulkSender&) = delete;
+        PgeBulkSender(PgeBulkSender&&) = delete;
+        PgeBulkSender& operator=(PgeBulkSender&&) = delete;
+
+        const MsgApp::TMsgId& getMsgIdChunk() const;
+        const MsgApp::TMsgId& getMsgIdAck() const;
+
+        const uint32_t& getBytesPerSecond() const;
+        void setBytesPerSecond(const uint32_t& nBytesPerSecond) noexcept(false);
+        const uint32_t& getMaxBytesInFlight() const;
+        void setMaxBytesInFlight(const uint32_t& nMaxBytesInFlight) noexcept(false);
+
+        bool startTransfer(
+            const PgeNetworkConnectionHandle& connHandle,
+            const PgeBulkTransfer::TBlobId& blobId,
+            const std::shared_ptr<const std::vector<TByte>>& pBlob);
+        bool cancelTransfer(const PgeNetworkConnectionHandle& connHandle, const PgeBulkTransfer::TBlobId& blobId);
+        void removeClient(const PgeNetworkConnectionHandle& connHandle);
+
+        void update(PgeIServerClient& serverClient, const PgeBulkTransfer::TTimeUSecs& nTimeUSecs);
+        bool handleAckPkt(const PgePacket& pkt);
+
+        bool getProgress(
+            const PgeNetworkConnectionHandle& connHandle,
+            const PgeBulkTransfer::TBlobId& blobId,
+            PgeBulkTransfer::Progress& progress) const;
+        std::size_t getActiveTransferCount() const;
+        uint32_t getCompletedTransferCount() const;
+        uint64_t getSentChunkDataBytes() const;
+
+    private:
+
+        struct Transfer
+        {
+            PgeBulkTransfer::TBlobId m_blobId;
+            std::shared_ptr<const std::vector<TByte>> m_pBlob;  /**< Released when complete. */
+            uint32_t m_nBlobSizeBytes;
+            uint32_t m_nBlobChecksum;
+            uint32_t m_nNextOffset;                              /**< Next byte to be sent. */
+            uint32_t m_nAckedOffset;                             /**< Bytes acknowledged by the receiver. */
+            bool m_bComplete;
+        };
+
+        /**
+            Per connection state. Budget is stored in millionths of bytes, so no rounding error accumulates between updates.
+        */
+        struct Connection
+        {
+            std::vector<Transfer> m_vTransfers;
+            std::size_t m_iNextTransfer = 0;                     /**< Round-robin position. */
+            int64_t m_nBudgetMicroBytes = 0;
+            PgeBulkTransfer::TTimeUSecs m_nLastUpdateUSecs = 0;
+            bool m_bUpdated = false;
+        };
+
+        const MsgApp::TMsgId m_msgIdChunk;
+        const MsgApp::TMsgId m_msgIdAck;
+        uint32_t m_nBytesPerSecond;
+        uint32_t m_nMaxBytesInFlight;
+        std::map<PgeNetworkConnectionHandle, Connection> m_mapConnections;
+        uint32_t m_nCompletedTransferCount;
+        uint64_t m_nSentChunkDataBytes;
+
+        Transfer* findTransfer(const PgeNetworkConnectionHandle& connHandle, const PgeBulkTransfer::TBlobId& blobId);
+        const Transfer* findTransfer(const PgeNetworkConnectionHandle& connHandle, const PgeBulkTransfer::TBlobId& blobId) const;
+        int64_t getMaxBudgetMicroBytes() const;
+        bool isSendable(const Transfer& transfer) const;
+        uint32_t getNextChunkDataSize(const Transfer& transfer) const;
+        bool sendChunk(
+            PgeIServerClient& serverClient,
+            const PgeNetworkConnectionHandle& connHandle,
+            Transfer& transfer,
+            const uint32_t& nDataSize);
+
+    }; // class PgeBulkSender
+
+} // namespace pge_network
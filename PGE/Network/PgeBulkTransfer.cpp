@@ -0,0 +1,37 @@
+/*
+    ###################################################################################
+    PgeBulkTransfer.cpp
+    This file is part of PGE.
+    PR00F's Game Engine bulk transfer common definitions
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgeBulkTransfer.h"
+
+namespace pge_network {
+
+    /**
+        @return Ratio of transferred bytes in [0, 1] range.
+    */
+    float PgeBulkTransfer::Progress::getRatio() const
+    {
+        return (m_nBlobSizeBytes == 0) ? 1.f : (static_cast<float>(m_nDoneBytes) / m_nBlobSizeBytes);
+    }
+
+    /**
+        32-bit FNV-1a hash of the given data, used for detecting corrupted or changed blobs, not for security.
+    */
+    uint32_t PgeBulkTransfer::getChecksum(const TByte* pData, const std::size_t& nSize)
+    {
+        uint32_t nHash = 2166136261u;
+        for (std::size_t i = 0; i < nSize; i++)
+        {
+            nHash = (nHash ^ pData[i]) * 16777619u;
+        }
+        return nHash;
+    }
+
+} // namespace pge_network
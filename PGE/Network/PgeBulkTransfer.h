@@ -0,0 +1,97 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeBulkTransfer.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine bulk transfer common definitions
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <cstdint>
+#include <type_traits>
+
+#include "PgePacket.h"
+
+namespace pge_network
+{
+
+    /**
+        Common definitions of the bulk transfer channel, used by PgeBulkSender and PgeBulkReceiver.
+
+        A blob is an arbitrary-size byte array identified by a TBlobId chosen by the application, e.g. a map file or a custom spray.
+        It is sent in chunks, each chunk being a separate app message with MsgBulkChunkHeader followed by at most nMaxChunkDataSizeBytes
+        bytes of the blob, and the receiver acknowledges its progress by MsgBulkAck.
+        Chunks must be sent on a reliable lane, so the app message id of chunks should not be configured in
+        PgeIServerClient::getMsgAppId2SendLaneMap(), or should be configured to PgeSendLane::Reliable.
+    */
+    class PgeBulkTransfer
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeBulkTransfer is included")
+#endif
+
+    public:
+
+        typedef uint32_t TBlobId;
+        typedef int64_t TTimeUSecs;
+
+        static constexpr std::size_t nChunkHeaderSizeBytes = 16;  /**< sizeof(MsgBulkChunkHeader). */
+        static constexpr std::size_t nMaxChunkDataSizeBytes = MsgApp::nMaxMessageLengthBytes - nChunkHeaderSizeBytes;
+        static constexpr uint32_t nAckIntervalBytes = 4096;      /**< Receiver acknowledges progress at least this often. */
+
+        /**
+            Progress of a single blob transfer.
+        */
+        struct Progress
+        {
+            uint32_t m_nBlobSizeBytes;
+            uint32_t m_nDoneBytes;      /**< Sender side: acknowledged by receiver, receiver side: received. */
+            bool m_bComplete;           /**< All bytes transferred and checksum verified by receiver. */
+
+            float getRatio() const;
+        }; // struct Progress
+
+        // ---------------------------------------------------------------------------
+
+        static uint32_t getChecksum(const TByte* pData, const std::size_t& nSize);
+
+    }; // class PgeBulkTransfer
+
+    /**
+        Header of each chunk app message sent by PgeBulkSender, followed by the chunk data.
+        Blob size and checksum are repeated in every chunk, so the receiver can detect if a blob with the same id has changed.
+    */
+    struct MsgBulkChunkHeader
+    {
+        PgeBulkTransfer::TBlobId m_blobId;
+        uint32_t m_nBlobSizeBytes;
+        uint32_t m_nBlobChecksum;
+        uint32_t m_nOffset;         /**< Offset of chunk data within the blob. */
+    };
+    static_assert(std::is_trivial_v<MsgBulkChunkHeader>);
+    static_assert(std::is_trivially_copyable_v<MsgBulkChunkHeader>);
+    static_assert(std::is_standard_layout_v<MsgBulkChunkHeader>);
+    static_assert(sizeof(MsgBulkChunkHeader) == PgeBulkTransfer::nChunkHeaderSizeBytes);
+
+    /**
+        App message sent by PgeBulkReceiver to acknowledge the number of bytes received in order.
+        If m_bResume is set, the sender continues from m_nReceivedBytes even if it has already sent more, or has not sent that many yet:
+        this is how the receiver resumes a transfer interrupted e.g. by reconnecting, and how it restarts a transfer failing checksum verification.
+    */
+    struct MsgBulkAck
+    {
+        PgeBulkTransfer::TBlobId m_blobId;
+        uint32_t m_nBlobChecksum;
+        uint32_t m_nReceivedBytes;
+        bool m_bResume;
+    };
+    static_assert(std::is_trivial_v<MsgBulkAck>);
+    static_assert(std::is_trivially_copyable_v<MsgBulkAck>);
+    static_assert(std::is_standard_layout_v<MsgBulkAck>);
+
+} // namespace pge_network
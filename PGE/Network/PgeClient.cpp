@@ -37,11 +37,19 @@ public:
 
     std::size_t getPacketQueueSize() const override;
     pge_network::PgePacket popFrontPacket() noexcept(false) override;
+    const pge_network::PgePacket& borrowFrontPacket() noexcept(false) override;
+    void releaseFrontPacket() override;
+    uint32_t getPacketQueueDroppedCount() const override;
+    std::size_t getPacketQueueHighWaterMark() const override;
 
-    std::set<pge_network::PgePktId>& getAllowListedPgeMessages() override;
-    std::set<pge_network::MsgApp::TMsgId>& getAllowListedAppMessages() override;
+    pge_network::PgePktIdAllowList& getAllowListedPgeMessages() override;
+    pge_network::MsgAppIdAllowList& getAllowListedAppMessages() override;
+    std::map<pge_network::MsgApp::TMsgId, pge_network::PgeSendLane>& getMsgAppId2SendLaneMap() override;
+    pge_network::PgeMsgAppCompressor& getMsgAppCompressor() override;
+    std::map<pge_network::MsgApp::TMsgId, pge_network::PgeMsgAppCompressor::MsgAppStats> getMsgAppCompressionStats() const override;
 
     void send(const pge_network::PgePacket& pkt, const pge_network::PgeNetworkConnectionHandle& connHandle = pge_network::ServerConnHandle) override;
+    void flushBatchedPackets() override;
 
     uint32_t getRxPacketCount() const override;
     uint32_t getTxPacketCount() const override;
@@ -55,11 +63,18 @@ public:
     const std::map<pge_network::MsgApp::TMsgId, uint32_t>& getTxMsgCount() const override;
     const std::map<pge_network::MsgApp::TMsgId, uint32_t>& getInjectMsgCount() const override;
 
+    const std::map<pge_network::PgeSendLane, uint32_t>& getRxLaneMsgCount() const override;
+    const std::map<pge_network::PgeSendLane, uint32_t>& getTxLaneMsgCount() const override;
+
+    const pge_network::PgeNetworkStats& getNetworkStats() const override;
+
     std::map<pge_network::MsgApp::TMsgId, std::string>& getMsgAppId2StringMap() override;
 
     uint32_t getRxByteCount() const override;
     uint32_t getTxByteCount() const override;
     uint32_t getInjectByteCount() const override;
+    pge_network::PgeHandoffStats getHandoffStats() const override;
+    pge_network::PgeConnectionTelemetry getConnectionTelemetry() const override;
 
     void WriteList() const override;
 
@@ -93,6 +108,8 @@ private:
 
     PGEcfgProfiles& m_cfgProfiles;
     PgeGnsClient& m_gnsClient;
+    mutable pge_network::PgeNetworkConnectionHandle m_connHandle;            /**< Copy returned by getConnectionHandle(). */
+    mutable pge_network::PgeNetworkConnectionHandle m_connHandleServerSide;  /**< Copy returned by getConnectionHandleServerSide(). */
 
     explicit PgeClientImpl(PGEcfgProfiles& cfgProfiles);
     PgeClientImpl(const PgeClientImpl&);
@@ -156,7 +173,8 @@ void PgeClientImpl::disconnect(const std::string& sExtraDebugText)
 
 void PgeClientImpl::Update()
 {
-    if (m_gnsClient.isConnected())
+    // while the network I/O thread is running, the connection handle belongs to it, and we need to take over what it received anyway
+    if (m_gnsClient.isIoThreadRunning() || m_gnsClient.isConnected())
     {
         m_gnsClient.pollIncomingMessages();
     }
@@ -165,7 +183,7 @@ void PgeClientImpl::Update()
 
 bool PgeClientImpl::pollIncomingMessages()
 {
-    if (m_gnsClient.isConnected())
+    if (m_gnsClient.isIoThreadRunning() || m_gnsClient.isConnected())
     {
         return m_gnsClient.pollIncomingMessages();
     }
@@ -187,16 +205,52 @@ pge_network::PgePacket PgeClientImpl::popFrontPacket() noexcept(false)
     return m_gnsClient.popFrontPacket();
 }
 
-std::set<pge_network::PgePktId>& PgeClientImpl::getAllowListedPgeMessages()
+const pge_network::PgePacket& PgeClientImpl::borrowFrontPacket() noexcept(false)
+{
+    return m_gnsClient.borrowFrontPacket();
+}
+
+void PgeClientImpl::releaseFrontPacket()
+{
+    m_gnsClient.releaseFrontPacket();
+}
+
+uint32_t PgeClientImpl::getPacketQueueDroppedCount() const
+{
+    return m_gnsClient.getPacketQueueDroppedCount();
+}
+
+std::size_t PgeClientImpl::getPacketQueueHighWaterMark() const
+{
+    return m_gnsClient.getPacketQueueHighWaterMark();
+}
+
+pge_network::PgePktIdAllowList& PgeClientImpl::getAllowListedPgeMessages()
 {
     return m_gnsClient.getAllowListedPgeMessages();
 }
 
-std::set<pge_network::MsgApp::TMsgId>& PgeClientImpl::getAllowListedAppMessages()
+pge_network::MsgAppIdAllowList& PgeClientImpl::getAllowListedAppMessages()
 {
     return m_gnsClient.getAllowListedAppMessages();
 }
 
+std::map<pge_network::MsgApp::TMsgId, pge_network::PgeSendLane>& PgeClientImpl::getMsgAppId2SendLaneMap()
+{
+    return m_gnsClient.getMsgAppId2SendLaneMap();
+}
+
+pge_network::PgeMsgAppCompressor& PgeClientImpl::getMsgAppCompressor()
+{
+    return m_gnsClient.getMsgAppCompressor();
+}
+
+std::map<pge_network::MsgApp::TMsgId, pge_network::PgeMsgAppCompressor::MsgAppStats> PgeClientImpl::getMsgAppCompressionStats() const
+{
+    const auto lock = m_gnsClient.lockIoThread();
+    return m_gnsClient.getMsgAppCompressor().getStats();
+}
+
 void PgeClientImpl::send(const pge_network::PgePacket& pkt, const pge_network::PgeNetworkConnectionHandle& connHandle)
 {
     if (connHandle != pge_network::ServerConnHandle)
@@ -207,6 +261,11 @@ void PgeClientImpl::send(const pge_network::PgePacket& pkt, const pge_network::P
     m_gnsClient.sendToServer(pkt);
 }
 
+void PgeClientImpl::flushBatchedPackets()
+{
+    m_gnsClient.flushBatchedPackets();
+}
+
 uint32_t PgeClientImpl::getRxPacketCount() const
 {
     return m_gnsClient.getRxPacketCount();
@@ -252,6 +311,21 @@ const std::map<pge_network::MsgApp::TMsgId, uint32_t>& PgeClientImpl::getInjectM
     return m_gnsClient.getInjectMsgCount();
 }
 
+const std::map<pge_network::PgeSendLane, uint32_t>& PgeClientImpl::getRxLaneMsgCount() const
+{
+    return m_gnsClient.getRxLaneMsgCount();
+}
+
+const std::map<pge_network::PgeSendLane, uint32_t>& PgeClientImpl::getTxLaneMsgCount() const
+{
+    return m_gnsClient.getTxLaneMsgCount();
+}
+
+const pge_network::PgeNetworkStats& PgeClientImpl::getNetworkStats() const
+{
+    return m_gnsClient.getNetworkStats();
+}
+
 std::map<pge_network::MsgApp::TMsgId, std::string>& PgeClientImpl::getMsgAppId2StringMap()
 {
     return m_gnsClient.getMsgAppId2StringMap();
@@ -272,6 +346,17 @@ uint32_t PgeClientImpl::getInjectByteCount() const
     return m_gnsClient.getInjectByteCount();
 }
 
+pge_network::PgeHandoffStats PgeClientImpl::getHandoffStats() const
+{
+    return m_gnsClient.getHandoffStats();
+}
+
+pge_network::PgeConnectionTelemetry PgeClientImpl::getConnectionTelemetry() const
+{
+    const auto lock = m_gnsClient.lockIoThread();
+    return m_gnsClient.getConnectionTelemetry();
+}
+
 void PgeClientImpl::WriteList() const
 {
     getConsole().OLnOI("PgeClient::WriteList() start");
@@ -298,12 +383,17 @@ void PgeClientImpl::WriteList() const
 
 const pge_network::PgeNetworkConnectionHandle& PgeClientImpl::getConnectionHandle() const
 {
-    return static_cast<pge_network::PgeNetworkConnectionHandle>(m_gnsClient.getConnectionHandle());
+    // network I/O thread might change the handle, so we return a copy taken under lock
+    const auto lock = m_gnsClient.lockIoThread();
+    m_connHandle = static_cast<pge_network::PgeNetworkConnectionHandle>(m_gnsClient.getConnectionHandle());
+    return m_connHandle;
 }
 
 const pge_network::PgeNetworkConnectionHandle& PgeClientImpl::getConnectionHandleServerSide() const
 {
-    return static_cast<pge_network::PgeNetworkConnectionHandle>(m_gnsClient.getConnectionHandleServerSide());
+    const auto lock = m_gnsClient.lockIoThread();
+    m_connHandleServerSide = static_cast<pge_network::PgeNetworkConnectionHandle>(m_gnsClient.getConnectionHandleServerSide());
+    return m_connHandleServerSide;
 }
 
 const char* PgeClientImpl::getServerAddress() const
@@ -318,51 +408,61 @@ bool PgeClientImpl::connectToServer(const std::string& sServerAddress, const std
 
 int PgeClientImpl::getPing(bool bForceUpdate)
 {
+    const auto lock = m_gnsClient.lockIoThread();
     return m_gnsClient.getRealTimeStatus(bForceUpdate).m_nPing;
 }
 
 float PgeClientImpl::getQualityLocal(bool bForceUpdate)
 {
+    const auto lock = m_gnsClient.lockIoThread();
     return m_gnsClient.getRealTimeStatus(bForceUpdate).m_flConnectionQualityLocal;
 }
 
 float PgeClientImpl::getQualityRemote(bool bForceUpdate)
 {
+    const auto lock = m_gnsClient.lockIoThread();
     return m_gnsClient.getRealTimeStatus(bForceUpdate).m_flConnectionQualityRemote;
 }
 
 float PgeClientImpl::getRxByteRate(bool bForceUpdate)
 {
+    const auto lock = m_gnsClient.lockIoThread();
     return m_gnsClient.getRealTimeStatus(bForceUpdate).m_flInBytesPerSec;
 }
 
 float PgeClientImpl::getTxByteRate(bool bForceUpdate)
 {
+    const auto lock = m_gnsClient.lockIoThread();
     return m_gnsClient.getRealTimeStatus(bForceUpdate).m_flOutBytesPerSec;
 }
 
 int64_t PgeClientImpl::getPendingUnreliableBytes(bool bForceUpdate)
 {
+    const auto lock = m_gnsClient.lockIoThread();
     return m_gnsClient.getRealTimeStatus(bForceUpdate).m_cbPendingUnreliable;
 }
 
 int64_t PgeClientImpl::getPendingReliableBytes(bool bForceUpdate)
 {
+    const auto lock = m_gnsClient.lockIoThread();
     return m_gnsClient.getRealTimeStatus(bForceUpdate).m_cbPendingReliable;
 }
 
 int64_t PgeClientImpl::getSentButUnAckedReliableBytes(bool bForceUpdate)
 {
+    const auto lock = m_gnsClient.lockIoThread();
     return m_gnsClient.getRealTimeStatus(bForceUpdate).m_cbSentUnackedReliable;
 }
 
 int64_t PgeClientImpl::getInternalQueueTimeUSecs(bool bForceUpdate)
 {
+    const auto lock = m_gnsClient.lockIoThread();
     return static_cast<int64_t>(m_gnsClient.getRealTimeStatus(bForceUpdate).m_usecQueueTime);
 }
 
 std::string PgeClientImpl::getDetailedConnectionStatus() const
 {
+    const auto lock = m_gnsClient.lockIoThread();
     return m_gnsClient.getDetailedConnectionStatus();
 }
 
@@ -375,7 +475,9 @@ std::string PgeClientImpl::getDetailedConnectionStatus() const
 
 PgeClientImpl::PgeClientImpl(PGEcfgProfiles& cfgProfiles) :
     m_cfgProfiles(cfgProfiles),
-    m_gnsClient(PgeGnsClient::createAndGet(cfgProfiles))
+    m_gnsClient(PgeGnsClient::createAndGet(cfgProfiles)),
+    m_connHandle(pge_network::ServerConnHandle),
+    m_connHandleServerSide(pge_network::ServerConnHandle)
 {
     m_gnsClient.getAllowListedPgeMessages().insert(pge_network::MsgUserDisconnectedFromServer::id);
     m_gnsClient.getAllowListedPgeMessages().insert(pge_network::MsgApp::id);
@@ -383,7 +485,9 @@ PgeClientImpl::PgeClientImpl(PGEcfgProfiles& cfgProfiles) :
 
 PgeClientImpl::PgeClientImpl(const PgeClientImpl& other) :
     m_cfgProfiles(other.m_cfgProfiles),
-    m_gnsClient(PgeGnsClient::createAndGet(other.m_cfgProfiles))
+    m_gnsClient(PgeGnsClient::createAndGet(other.m_cfgProfiles)),
+    m_connHandle(pge_network::ServerConnHandle),
+    m_connHandleServerSide(pge_network::ServerConnHandle)
 {
 }
 
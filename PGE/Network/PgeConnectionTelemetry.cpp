@@ -0,0 +1,426 @@
+/*
+    ###################################################################################
+    PgeConnectionTelemetry.cpp
+    This file is part of PGE.
+    PR00F's Game Engine per-connection network telemetry sampler
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgeConnectionTelemetry.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace pge_network {
+
+    PgeConnectionTelemetry::Sample::Sample()
+    {
+        m_fValues.fill(0.f);
+    }
+
+    PgeConnectionTelemetry::WindowStats::WindowStats() :
+        m_nCount(0),
+        m_fMin(0.f),
+        m_fAvg(0.f),
+        m_fMax(0.f),
+        m_fP99(0.f)
+    {
+    }
+
+    const char* PgeConnectionTelemetry::getMetricString(const Metric& metric)
+    {
+        switch (metric)
+        {
+        case Metric::Ping:
+            return "ping_ms";
+        case Metric::QualityLocal:
+            return "quality_local";
+        case Metric::QualityRemote:
+            return "quality_remote";
+        case Metric::RxBytesPerSec:
+            return "rx_bytes_per_sec";
+        case Metric::TxBytesPerSec:
+            return "tx_bytes_per_sec";
+        case Metric::PendingUnreliableBytes:
+            return "pending_unreliable_bytes";
+        case Metric::PendingReliableBytes:
+            return "pending_reliable_bytes";
+        case Metric::SentUnAckedReliableBytes:
+            return "sent_unacked_reliable_bytes";
+        case Metric::QueueTimeUSecs:
+            return "queue_time_us";
+        default:
+            return "unknown";
+        }
+    }
+
+    /**
+        Creates a disabled telemetry: reserve() and setSampleInterval() need to be called before sampling.
+    */
+    PgeConnectionTelemetry::PgeConnectionTelemetry() :
+        m_nCapacity(0),
+        m_sampleInterval(0),
+        m_bSampled(false),
+        m_bHasSample(false),
+        m_nDroppedSampleCount(0)
+    {
+    }
+
+    /**
+        Sets the number of samples stored per connection.
+        If capacity doesn't change, the already stored samples are kept, otherwise all samples are cleared.
+        Memory for a connection is allocated only when it is first sampled.
+
+        @param nCapacity Number of samples per connection, must be in range [1, nMaxCapacity].
+
+        @return True on success, false if nCapacity is out of range.
+    */
+    bool PgeConnectionTelemetry::reserve(const std::size_t& nCapacity)
+    {
+        if ((nCapacity == 0) || (nCapacity > nMaxCapacity))
+        {
+            return false;
+        }
+
+        if (nCapacity != m_nCapacity)
+        {
+            m_nCapacity = nCapacity;
+            clear();
+        }
+        return true;
+    }
+
+    /**
+        Removes all connections and their samples, capacity and sample interval are kept.
+    */
+    void PgeConnectionTelemetry::clear()
+    {
+        m_vConnections.clear();
+        m_bSampled = false;
+        m_bHasSample = false;
+        m_nDroppedSampleCount = 0;
+    }
+
+    std::size_t PgeConnectionTelemetry::capacity() const
+    {
+        return m_nCapacity;
+    }
+
+    const std::chrono::milliseconds& PgeConnectionTelemetry::getSampleInterval() const
+    {
+        return m_sampleInterval;
+    }
+
+    /**
+        @param interval Minimum time between 2 samplings, 0 disables sampling.
+    */
+    void PgeConnectionTelemetry::setSampleInterval(const std::chrono::milliseconds& interval)
+    {
+        m_sampleInterval = interval;
+    }
+
+    /**
+        @return True if both capacity and sample interval are set.
+    */
+    bool PgeConnectionTelemetry::isEnabled() const
+    {
+        return (m_nCapacity > 0) && (m_sampleInterval.count() > 0);
+    }
+
+    /**
+        Tells if the owner should sample the connections now, and if so, considers the sampling done at the given time.
+        Expected to be invoked frequently, e.g. every frame, it is cheap when sampling is not due.
+
+        @param timeNow Current time.
+
+        @return True if enabled and the sample interval elapsed since the last sampling, false otherwise.
+    */
+    bool PgeConnectionTelemetry::beginSampling(const TimePoint& timeNow)
+    {
+        if (!isEnabled() || (m_bSampled && (timeNow - m_timeLastSampling < m_sampleInterval)))
+        {
+            return false;
+        }
+
+        m_bSampled = true;
+        m_timeLastSampling = timeNow;
+        return true;
+    }
+
+    /**
+        Stores the given sample of the given connection, overwriting the oldest sample of the connection if its ring is full.
+
+        @param connHandle The sampled connection.
+        @param sample     The sample, its time is expected to be not earlier than the previous sample of the same connection.
+
+        @return False if there is no capacity, or nMaxConnectionCount connections are already tracked, true otherwise.
+    */
+    bool PgeConnectionTelemetry::addSample(const PgeNetworkConnectionHandle& connHandle, const Sample& sample)
+    {
+        ConnectionSamples* pConnSamples = findConnectionSamples(connHandle);
+        if (!pConnSamples)
+        {
+            if ((m_nCapacity == 0) || (m_vConnections.size() >= nMaxConnectionCount))
+            {
+                m_nDroppedSampleCount++;
+                return false;
+            }
+
+            m_vConnections.push_back(ConnectionSamples());
+            pConnSamples = &m_vConnections.back();
+            pConnSamples->m_connHandle = connHandle;
+            pConnSamples->m_vSamples.resize(m_nCapacity);
+            pConnSamples->m_nFront = 0;
+            pConnSamples->m_nCount = 0;
+        }
+
+        if (!m_bHasSample)
+        {
+            m_bHasSample = true;
+            m_timeFirstSample = sample.m_time;
+        }
+
+        if (pConnSamples->m_nCount < m_nCapacity)
+        {
+            pConnSamples->m_vSamples[(pConnSamples->m_nFront + pConnSamples->m_nCount) % m_nCapacity] = sample;
+            pConnSamples->m_nCount++;
+        }
+        else
+        {
+            pConnSamples->m_vSamples[pConnSamples->m_nFront] = sample;
+            pConnSamples->m_nFront = (pConnSamples->m_nFront + 1) % m_nCapacity;
+        }
+        return true;
+    }
+
+    /**
+        @return Handles of all tracked connections, in order of their first sample.
+    */
+    std::vector<PgeNetworkConnectionHandle> PgeConnectionTelemetry::getConnectionHandles() const
+    {
+        std::vector<PgeNetworkConnectionHandle> vConnHandles;
+        vConnHandles.reserve(m_vConnections.size());
+        for (const auto& connSamples : m_vConnections)
+        {
+            vConnHandles.push_back(connSamples.m_connHandle);
+        }
+        return vConnHandles;
+    }
+
+    std::size_t PgeConnectionTelemetry::getSampleCount(const PgeNetworkConnectionHandle& connHandle) const
+    {
+        const ConnectionSamples* const pConnSamples = findConnectionSamples(connHandle);
+        return pConnSamples ? pConnSamples->m_nCount : 0;
+    }
+
+    /**
+        @param connHandle The sampled connection.
+        @param index      Index of the sample, 0 being the oldest stored sample of the connection.
+
+        @return The sample, or nullptr if connection is not tracked or index is out of range.
+    */
+    const PgeConnectionTelemetry::Sample* PgeConnectionTelemetry::getSample(
+        const PgeNetworkConnectionHandle& connHandle,
+        const std::size_t& index) const
+    {
+        const ConnectionSamples* const pConnSamples = findConnectionSamples(connHandle);
+        if (!pConnSamples || (index >= pConnSamples->m_nCount))
+        {
+            return nullptr;
+        }
+        return &getSample(*pConnSamples, index);
+    }
+
+    /**
+        @return Number of samples dropped because there was no capacity or too many connections were already tracked.
+    */
+    uint32_t PgeConnectionTelemetry::getDroppedSampleCount() const
+    {
+        return m_nDroppedSampleCount;
+    }
+
+    /**
+        Calculates the statistics of the given metric over the stored samples of the given connection taken in the given time range.
+
+        @param connHandle The sampled connection.
+        @param metric     The metric.
+        @param timeFrom   Start of the time range, inclusive.
+        @param timeTo     End of the time range, exclusive.
+
+        @return The statistics, with zero count if there is no sample in the time range.
+    */
+    PgeConnectionTelemetry::WindowStats PgeConnectionTelemetry::getWindowStats(
+        const PgeNetworkConnectionHandle& connHandle,
+        const Metric& metric,
+        const TimePoint& timeFrom,
+        const TimePoint& timeTo) const
+    {
+        WindowStats stats;
+        const ConnectionSamples* const pConnSamples = findConnectionSamples(connHandle);
+        if (!pConnSamples)
+        {
+            return stats;
+        }
+
+        const std::size_t iMetric = static_cast<std::size_t>(metric);
+        std::vector<float> vValues;
+        double fSum = 0.0;
+        for (std::size_t i = 0; i < pConnSamples->m_nCount; i++)
+        {
+            const Sample& sample = getSample(*pConnSamples, i);
+            if ((sample.m_time < timeFrom) || (sample.m_time >= timeTo))
+            {
+                continue;
+            }
+
+            const float fValue = sample.m_fValues[iMetric];
+            if (vValues.empty())
+            {
+                stats.m_fMin = fValue;
+                stats.m_fMax = fValue;
+            }
+            else
+            {
+                stats.m_fMin = std::min(stats.m_fMin, fValue);
+                stats.m_fMax = std::max(stats.m_fMax, fValue);
+            }
+            fSum += fValue;
+            vValues.push_back(fValue);
+        }
+
+        if (vValues.empty())
+        {
+            return stats;
+        }
+
+        stats.m_nCount = static_cast<uint32_t>(vValues.size());
+        stats.m_fAvg = static_cast<float>(fSum / vValues.size());
+
+        // nearest-rank: smallest value with at least 99% of the values not greater than it
+        const std::size_t nRank = (vValues.size() * 99 + 99) / 100;
+        std::nth_element(vValues.begin(), vValues.begin() + (nRank - 1), vValues.end());
+        stats.m_fP99 = vValues[nRank - 1];
+
+        return stats;
+    }
+
+    /**
+        Exports all stored samples, 1 line per sample, grouped by connection, in chronological order within a connection.
+        Time is in milliseconds since the first sample.
+
+        @return The CSV text.
+    */
+    std::string PgeConnectionTelemetry::exportCsv() const
+    {
+        std::stringstream ss;
+        ss << "conn,time_ms";
+        for (std::size_t iMetric = 0; iMetric < nMetricCount; iMetric++)
+        {
+            ss << "," << getMetricString(static_cast<Metric>(iMetric));
+        }
+        ss << "\n";
+
+        for (const auto& connSamples : m_vConnections)
+        {
+            for (std::size_t i = 0; i < connSamples.m_nCount; i++)
+            {
+                const Sample& sample = getSample(connSamples, i);
+                ss << connSamples.m_connHandle << "," << getMillisSinceFirstSample(sample.m_time);
+                for (const auto& fValue : sample.m_fValues)
+                {
+                    ss << "," << fValue;
+                }
+                ss << "\n";
+            }
+        }
+
+        return ss.str();
+    }
+
+    /**
+        Exports the statistics of all metrics per connection per consecutive time window, 1 line per window per metric.
+        Windows start at the first sample, empty windows are skipped. Time is in milliseconds since the first sample.
+
+        @param window Length of a time window, must be positive.
+
+        @return The CSV text, having only the header if window is not positive.
+    */
+    std::string PgeConnectionTelemetry::exportWindowStatsCsv(const std::chrono::milliseconds& window) const
+    {
+        std::stringstream ss;
+        ss << "conn,window_start_ms,metric,count,min,avg,max,p99\n";
+        if (window.count() <= 0)
+        {
+            return ss.str();
+        }
+
+        for (const auto& connSamples : m_vConnections)
+        {
+            if (connSamples.m_nCount == 0)
+            {
+                continue;
+            }
+
+            const TimePoint timeLast = getSample(connSamples, connSamples.m_nCount - 1).m_time;
+            TimePoint timeWindowStart = m_timeFirstSample + window * (getMillisSinceFirstSample(getSample(connSamples, 0).m_time) / window.count());
+            for (; timeWindowStart <= timeLast; timeWindowStart += window)
+            {
+                for (std::size_t iMetric = 0; iMetric < nMetricCount; iMetric++)
+                {
+                    const WindowStats stats =
+                        getWindowStats(connSamples.m_connHandle, static_cast<Metric>(iMetric), timeWindowStart, timeWindowStart + window);
+                    if (stats.m_nCount == 0)
+                    {
+                        break;
+                    }
+                    ss << connSamples.m_connHandle << "," << getMillisSinceFirstSample(timeWindowStart) << ","
+                        << getMetricString(static_cast<Metric>(iMetric)) << "," << stats.m_nCount << ","
+                        << stats.m_fMin << "," << stats.m_fAvg << "," << stats.m_fMax << "," << stats.m_fP99 << "\n";
+                }
+            }
+        }
+
+        return ss.str();
+    }
+
+    PgeConnectionTelemetry::ConnectionSamples* PgeConnectionTelemetry::findConnectionSamples(const PgeNetworkConnectionHandle& connHandle)
+    {
+        for (auto& connSamples : m_vConnections)
+        {
+            if (connSamples.m_connHandle == connHandle)
+            {
+                return &connSamples;
+            }
+        }
+        return nullptr;
+    }
+
+    const PgeConnectionTelemetry::ConnectionSamples* PgeConnectionTelemetry::findConnectionSamples(
+        const PgeNetworkConnectionHandle& connHandle) const
+    {
+        for (const auto& connSamples : m_vConnections)
+        {
+            if (connSamples.m_connHandle == connHandle)
+            {
+                return &connSamples;
+            }
+        }
+        return nullptr;
+    }
+
+    const PgeConnectionTelemetry::Sample& PgeConnectionTelemetry::getSample(
+        const ConnectionSamples& connSamples,
+        const std::size_t& index) const
+    {
+        return connSamples.m_vSamples[(connSamples.m_nFront + index) % m_nCapacity];
+    }
+
+    int64_t PgeConnectionTelemetry::getMillisSinceFirstSample(const TimePoint& time) const
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(time - m_timeFirstSample).count();
+    }
+
+} // namespace pge_network
@@ -0,0 +1,158 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeConnectionTelemetry.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine per-connection network telemetry sampler
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <array>
+#include <chrono>  // requires cpp11
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "PgePacket.h"
+
+namespace pge_network
+{
+
+    /**
+        Time series of connection status samples per connection, e.g. ping, quality, byte rates, pending bytes and queue time,
+        so network saturation can be correlated with hitches after a match, without running a debugger.
+
+        Samples of each connection are stored in a fixed-capacity ring buffer preallocated when the connection is first sampled,
+        so adding a sample is just a copy, without any lookup beyond a linear search among the few connections, or allocation.
+        When the ring of a connection is full, its oldest sample is overwritten.
+        Connections are kept after they are closed, so their history can still be exported at the end of the match.
+        At most nMaxConnectionCount connections are tracked, samples of further connections are dropped.
+
+        The owner decides what and when to sample, beginSampling() only tells if the sample interval has elapsed.
+        The whole object is copyable, so a snapshot can be taken by simply copying it, e.g. for exporting from another thread later.
+        Not thread-safe.
+    */
+    class PgeConnectionTelemetry
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeConnectionTelemetry is included")
+#endif
+
+    public:
+
+        typedef std::chrono::time_point<std::chrono::steady_clock> TimePoint;
+
+        enum class Metric : uint8_t
+        {
+            Ping = 0,                  /**< Round-trip time in milliseconds. */
+            QualityLocal,              /**< Ratio of packets delivered by remote host to us, [0..1]. */
+            QualityRemote,             /**< Ratio of packets delivered by us to remote host, [0..1]. */
+            RxBytesPerSec,
+            TxBytesPerSec,
+            PendingUnreliableBytes,    /**< Unreliable bytes queued for sending. */
+            PendingReliableBytes,      /**< Reliable bytes queued for sending. */
+            SentUnAckedReliableBytes,  /**< Reliable bytes sent but not yet acknowledged. */
+            QueueTimeUSecs             /**< Estimated time a message queued now would wait before being sent. */
+        };
+
+        static constexpr std::size_t nMetricCount = static_cast<std::size_t>(Metric::QueueTimeUSecs) + 1;
+        static constexpr std::size_t nMaxCapacity = 1u << 16;       /**< Maximum number of samples per connection. */
+        static constexpr std::size_t nMaxConnectionCount = 64;      /**< Maximum number of tracked connections. */
+
+        /**
+            Status of a single connection at a given time.
+        */
+        struct Sample
+        {
+            TimePoint m_time;
+            std::array<float, nMetricCount> m_fValues;  /**< Indexed by Metric. */
+
+            Sample();
+        }; // struct Sample
+
+        /**
+            Statistics of a single metric over a range of samples.
+        */
+        struct WindowStats
+        {
+            uint32_t m_nCount;  /**< Number of samples in the window, other members are 0 if this is 0. */
+            float m_fMin;
+            float m_fAvg;
+            float m_fMax;
+            float m_fP99;       /**< 99th percentile, nearest-rank method. */
+
+            WindowStats();
+        }; // struct WindowStats
+
+        static const char* getMetricString(const Metric& metric);
+
+        // ---------------------------------------------------------------------------
+
+        PgeConnectionTelemetry();
+        ~PgeConnectionTelemetry() = default;
+
+        PgeConnectionTelemetry(const PgeConnectionTelemetry&) = default;
+        PgeConnectionTelemetry& operator=(const PgeConnectionTelemetry&) = default;
+        PgeConnectionTelemetry(PgeConnectionTelemetry&&) = default;
+        PgeConnectionTelemetry& operator=(PgeConnectionTelemetry&&) = default;
+
+        bool reserve(const std::size_t& nCapacity);
+        void clear();
+        std::size_t capacity() const;
+
+        const std::chrono::milliseconds& getSampleInterval() const;
+        void setSampleInterval(const std::chrono::milliseconds& interval);
+        bool isEnabled() const;
+        bool beginSampling(const TimePoint& timeNow);
+
+        bool addSample(const PgeNetworkConnectionHandle& connHandle, const Sample& sample);
+
+        std::vector<PgeNetworkConnectionHandle> getConnectionHandles() const;
+        std::size_t getSampleCount(const PgeNetworkConnectionHandle& connHandle) const;
+        const Sample* getSample(const PgeNetworkConnectionHandle& connHandle, const std::size_t& index) const;
+        uint32_t getDroppedSampleCount() const;
+
+        WindowStats getWindowStats(
+            const PgeNetworkConnectionHandle& connHandle,
+            const Metric& metric,
+            const TimePoint& timeFrom,
+            const TimePoint& timeTo) const;
+
+        std::string exportCsv() const;
+        std::string exportWindowStatsCsv(const std::chrono::milliseconds& window) const;
+
+    private:
+
+        /**
+            Ring buffer of samples of a single connection.
+        */
+        struct ConnectionSamples
+        {
+            PgeNetworkConnectionHandle m_connHandle;
+            std::vector<Sample> m_vSamples;  /**< Preallocated to capacity. */
+            std::size_t m_nFront;            /**< Index of the oldest sample. */
+            std::size_t m_nCount;
+        };
+
+        std::size_t m_nCapacity;
+        std::chrono::milliseconds m_sampleInterval;
+        TimePoint m_timeLastSampling;
+        bool m_bSampled;                 /**< True if beginSampling() returned true at least once since last clear(). */
+        TimePoint m_timeFirstSample;     /**< CSV times are relative to this. */
+        bool m_bHasSample;
+        uint32_t m_nDroppedSampleCount;
+        std::vector<ConnectionSamples> m_vConnections;
+
+        ConnectionSamples* findConnectionSamples(const PgeNetworkConnectionHandle& connHandle);
+        const ConnectionSamples* findConnectionSamples(const PgeNetworkConnectionHandle& connHandle) const;
+        const Sample& getSample(const ConnectionSamples& connSamples, const std::size_t& index) const;
+        int64_t getMillisSinceFirstSample(const TimePoint& time) const;
+
+    }; // class PgeConnectionTelemetry
+
+} // namespace pge_network
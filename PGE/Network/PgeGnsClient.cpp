@@ -59,6 +59,9 @@ bool PgeGnsClient::connectToServer(
     const std::string& sServerAddress,
     const std::string& sAppVersion)
 {
+    // I/O thread might be still running if connection was lost without disconnectClient(), from now on we own the connection again
+    stopIoThread();
+
     if (isConnected())
     {
         CConsole::getConsoleInstance("PgeGnsClient").EOLn("%s ERROR: already connected to %s!", __func__, m_szAddr);
@@ -105,9 +108,17 @@ bool PgeGnsClient::connectToServer(
         CConsole::getConsoleInstance("PgeGnsClient").OLn("%s() client app version is specified as: %s!", __func__, m_sAppVersion.c_str());
     }
 
+    if (!reservePacketQueue() || !startPacketCapture() || !startTelemetry())
+    {
+        return false;
+    }
+
     SteamNetworkingConfigValue_t opt;
     opt.SetPtr(k_ESteamNetworkingConfig_Callback_ConnectionStatusChanged, (void*)steamNetConnectionStatusChangedCallback);
 
+    // batch might contain app messages from a previous connection that was lost without disconnectClient()
+    initPktBatches(m_pktBatches);
+
     // From now steamNetConnectionStatusChangedCallback() will be called back for connection status updates and that is where m_sAppVersion is also sent to server
     m_hConnection = m_pInterface->ConnectByIPAddress(m_addrServer, 1, &opt);
     if (m_hConnection == k_HSteamNetConnection_Invalid)
@@ -119,11 +130,16 @@ bool PgeGnsClient::connectToServer(
     //SteamNetConnectionInfo_t connInfo;
     //m_pInterface->GetConnectionInfo(m_hConnection, &connInfo);
 
+    startIoThread();
+
     return true;
 }
 
 bool PgeGnsClient::disconnectClient(const std::string& sExtraDebugText)
 {
+    // from now on we own the connection again
+    stopIoThread();
+
     if (!isConnected())
     {
         CConsole::getConsoleInstance("PgeGnsClient").OLn("%s not connected.", __func__);
@@ -146,11 +162,14 @@ bool PgeGnsClient::disconnectClient(const std::string& sExtraDebugText)
         pkt,
         static_cast<pge_network::PgeNetworkConnectionHandle>(k_HSteamNetConnection_Invalid));
     // we push this packet to our pkt queue, this is how we "send" message to ourselves so client game loop can process it
-    m_queuePackets.push_back(pkt);
+    enqueuePkt(pkt);
 
     // we cannot inject similar pkt about ourselves because we dont have our server-side connection handle (that would be stored in
     // m_hConnectionServerSide - somehow I never implemented it)
 
+    // whatever app messages are still waiting in batch, we send them out before closing connection
+    flushBatchedPackets();
+
     m_pInterface->CloseConnection(m_hConnection, k_ESteamNetConnectionEnd_App_Generic, sExtraDebugTextToSend.c_str(), true);
     m_hConnection = k_HSteamNetConnection_Invalid;
     m_hConnectionServerSide = k_HSteamNetConnection_Invalid;
@@ -183,56 +202,48 @@ const char* PgeGnsClient::getServerAddress() const
 
 void PgeGnsClient::sendToServer(const pge_network::PgePacket& pkt)
 {
+    if (needsHandoffToIoThread())
+    {
+        TxCmd* const pCmd = beginTxCmd(TxCmd::Type::Send);
+        if (pCmd)
+        {
+            pCmd->m_pkt = pkt;
+            endTxCmd(*pCmd);
+        }
+        return;
+    }
+
     if (!isConnected())
     {
         CConsole::getConsoleInstance("PgeGnsClient").EOLn("%s not connected!", __func__);
         return;
     }
 
-    uint32_t nActualPktSize;
-    if (pge_network::PgePacket::getPacketId(pkt) == pge_network::PgePktId::Application)
+    batchPkt(m_hConnection, m_pktBatches, pkt);
+}
+
+/**
+* Sends out the app messages batched by sendToServer() to the server.
+* Expected to be invoked once per frame, after the application has sent all its messages for the current frame.
+*/
+void PgeGnsClient::flushBatchedPackets()
+{
+    if (needsHandoffToIoThread())
     {
-        // We need the real used memory size so we can truncate the sent pkt to that.
-        // We need to consider member padding and the actual message sizes to have a correct value.
-        // 'cData' is our point of view since from there we need to calculate.
-        const pge_network::MsgApp* pMsgApp = pge_network::PgePacket::getMsgAppFromPkt(pkt);
-        assert(pMsgApp);  // never null since it points into pkt
-        const pge_network::TByte* pMsgAppInByteSteps = reinterpret_cast<const pge_network::TByte*>(pMsgApp);  // we can step this ptr in Bytes
-        
-        const uint8_t nMessageCount = pge_network::PgePacket::getMessageAppCount(pkt);
-        assert(nMessageCount == 1); // for now only 1 msg/pkt
-        for (uint8_t i = 0; i < nMessageCount; i++)
+        TxCmd* const pCmd = beginTxCmd(TxCmd::Type::Flush);
+        if (pCmd)
         {
-            pMsgApp = reinterpret_cast<const pge_network::MsgApp*>(pMsgAppInByteSteps);
-            // moving pMsgAppInByteSteps by the _actual_ size of the current MsgApp struct (considering the actual app message size there)
-            pMsgAppInByteSteps += pge_network::MsgApp::getMsgAppTotalActualSizeBytes(*pMsgApp);
+            endTxCmd(*pCmd);
         }
-        // now pMsgAppInByteSteps points to RIGHT AFTER the 1st byte of the last application message
-        const pge_network::TByte* pPkt = (const pge_network::TByte*)(&pkt);
-        nActualPktSize = pMsgAppInByteSteps - pPkt;
-    }
-    else
-    {
-        nActualPktSize = static_cast<uint32_t>(sizeof(pkt));
+        return;
     }
 
-    m_pInterface->SendMessageToConnection(m_hConnection, &pkt, nActualPktSize, k_nSteamNetworkingSend_Reliable, nullptr);
-    if (m_nTxPktCount == 1)
-    {
-        m_time1stTxPkt = std::chrono::steady_clock::now();
-    }
-    m_nTxPktCount++;
-    if (pge_network::PgePacket::getPacketId(pkt) == pge_network::PgePktId::Application)
+    if (!isConnected())
     {
-        const pge_network::MsgApp* pMsgApp = pge_network::PgePacket::getMsgAppFromPkt(pkt);
-        const uint8_t nMessageCount = pge_network::PgePacket::getMessageAppCount(pkt);
-        for (uint8_t i = 0; i < nMessageCount; i++)
-        {
-            // TODO: nooo, I need to properly iterate to next appmsg as I iterate in above loop!
-            ++m_nTxMsgCount[pge_network::MsgApp::getMsgAppMsgId(*pMsgApp)];
-        }
+        return;
     }
-    m_nTxByteCount += nActualPktSize;
+
+    flushBatchPkts(m_hConnection, m_pktBatches);
 }
 
 const SteamNetConnectionRealTimeStatus_t& PgeGnsClient::getRealTimeStatus(bool bForceUpdate)
@@ -277,6 +288,7 @@ PgeGnsClient::PgeGnsClient(PGEcfgProfiles& cfgProfiles) :
 {
     m_addrServer.Clear();
     memset(&m_connRtStatus, 0, sizeof(m_connRtStatus));
+    initPktBatches(m_pktBatches);
 } // PgeGnsClient()
 
 PgeGnsClient::PgeGnsClient(const PgeGnsClient& other) :
@@ -319,6 +331,7 @@ void PgeGnsClient::onSteamNetConnectionStatusChanged(SteamNetConnectionStatusCha
     // so no need to utilize mutexes around here.
     // And the other function pollIncomingMessages() is also invoked by PGE::runGame().
     // So it is safe to do operations on m_queuePackets.
+    // If the network I/O thread is running, then this is invoked only by the I/O thread, and injected packets go to its handoff queue.
 
     assert(pInfo->m_hConn == m_hConnection || m_hConnection == k_HSteamNetConnection_Invalid);
 
@@ -409,3 +422,44 @@ void PgeGnsClient::onSteamNetConnectionStatusChanged(SteamNetConnectionStatusCha
         break;
     }
 }
+
+bool PgeGnsClient::canPollIncomingMessages() const
+{
+    return isConnected();
+}
+
+/**
+* Executes the given command handed over by the application thread, on the network I/O thread.
+* 
+* @param cmd The command to be executed.
+*/
+void PgeGnsClient::executeTxCmd(const TxCmd& cmd)
+{
+    switch (cmd.m_type)
+    {
+    case TxCmd::Type::Send:
+        sendToServer(cmd.m_pkt);
+        break;
+    case TxCmd::Type::Flush:
+        flushBatchedPackets();
+        break;
+    case TxCmd::Type::Inject:
+        captureInjectedPkt(cmd.m_pkt);
+        break;
+    default:
+        CConsole::getConsoleInstance("PgeGnsClient").EOLn("%s: unexpected cmd type: %u!", __func__, static_cast<uint32_t>(cmd.m_type));
+    }
+}
+
+/**
+* Collects the connection handle of the server connection, if any, to be sampled by the telemetry.
+* 
+* @param vConns Receives the connection handle.
+*/
+void PgeGnsClient::collectTelemetryConns(std::vector<HSteamNetConnection>& vConns) const
+{
+    if (m_hConnection != k_HSteamNetConnection_Invalid)
+    {
+        vConns.push_back(m_hConnection);
+    }
+}
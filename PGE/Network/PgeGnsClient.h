@@ -100,6 +100,7 @@ public:
     const char* getServerAddress() const;
 
     void sendToServer(const pge_network::PgePacket& pkt);
+    void flushBatchedPackets();
 
     /* Debug functions. */
 
@@ -112,6 +113,9 @@ protected:
     virtual bool validateSteamNetworkingMessage(const HSteamNetConnection& connHandle) const override;
     virtual void updateIncomingPgePacket(pge_network::PgePacket& pkt, const HSteamNetConnection& connHandle) const override;
     virtual void onSteamNetConnectionStatusChanged(SteamNetConnectionStatusChangedCallback_t* pInfo) override;
+    virtual bool canPollIncomingMessages() const override;
+    virtual void executeTxCmd(const TxCmd& cmd) override;
+    virtual void collectTelemetryConns(std::vector<HSteamNetConnection>& vConns) const override;
 
 private:
 
@@ -130,6 +134,8 @@ private:
 
     SteamNetConnectionRealTimeStatus_t m_connRtStatus;
 
+    SendLane2PktBatchArray m_pktBatches;  /**< App messages sent to server are batched here per send lane until flushBatchedPackets(). */
+
     // ---------------------------------------------------------------------------
 
     explicit PgeGnsClient(PGEcfgProfiles& cfgProfiles);
@@ -10,6 +10,7 @@
 
 #include "PureBaseIncludes.h"  // PCH
 
+#include <algorithm>
 #include <cassert>
 
 #include "PgeGnsServer.h"
@@ -75,6 +76,11 @@ bool PgeGnsServer::startListening(const std::string& sAppVersion)
         CConsole::getConsoleInstance("PgeGnsServer").OLn("%s() server app version is specified as: %s!", __func__, m_sAppVersion.c_str());
     }
 
+    if (!reservePacketQueue() || !startPacketCapture() || !startTelemetry())
+    {
+        return false;
+    }
+
     SteamNetworkingIPAddr serverLocalAddr;
     serverLocalAddr.Clear();
     serverLocalAddr.m_port = m_nPort;
@@ -98,11 +104,12 @@ bool PgeGnsServer::startListening(const std::string& sAppVersion)
     }
     CConsole::getConsoleInstance("PgeGnsServer").OLn("%s() Server listening on port %d", __func__, m_nPort);
 
-    // Add ourselves to the client list, using std::map wacky syntax
+    // Add ourselves to the client list
     // k_HSteamNetConnection_Invalid will mean the server itself
-    m_mapClients[k_HSteamNetConnection_Invalid];
-    memset(m_mapClients[k_HSteamNetConnection_Invalid].m_szAddr, sizeof(m_mapClients[k_HSteamNetConnection_Invalid].m_szAddr), 0);
-    memset(&m_mapClients[k_HSteamNetConnection_Invalid].m_connRtStatus, sizeof(m_mapClients[k_HSteamNetConnection_Invalid].m_connRtStatus), 0);
+    if (!findClient(k_HSteamNetConnection_Invalid))
+    {
+        addClient(k_HSteamNetConnection_Invalid);
+    }
 
     // here we create a client connect pkt that will be injected to our queue so app level will process it and create
     // player object or whatever they want for the server itself, as it was a real client
@@ -114,10 +121,12 @@ bool PgeGnsServer::startListening(const std::string& sAppVersion)
         "" /* we dont know our own IP address, later the 1st connecting client will tell us anyway */);
 
     // we push this packet to our pkt queue, this is how we "send" message to ourselves so server game loop can process it
-    m_queuePackets.push_back(pktUserConnected);
+    enqueuePkt(pktUserConnected);
 
     // TODOOO: network layer needs to set user name! SetClientNick(k_HSteamNetConnection_Invalid, PgePacket::getMessageAsUserConnected(pkt).sUserName);
 
+    startIoThread();
+
     return true;
 }
 
@@ -129,16 +138,22 @@ bool PgeGnsServer::stopListening(const std::string& sExtraDebugText)
         return true;
     }
 
+    // from now on we own the connections again
+    stopIoThread();
+
+    // whatever app messages are still waiting in batches, we send them out before closing connections
+    flushBatchedPackets();
+
     // Close all the connections
     CConsole::getConsoleInstance("PgeGnsServer").OLn(
         "Server closing connections for %u client(s) (including itself) ... Reason: %s",
-        m_mapClients.size(),
+        m_vClients.size(),
         sExtraDebugText.empty() ? "unspecified" : sExtraDebugText.c_str());
 
-    // I always forget but m_mapClients also contains the server itself with invalid handle, this should be renamed so I never forget again!
-    for (const auto& itClient : m_mapClients)
+    // I always forget but m_vClients also contains the server itself with invalid handle, this should be renamed so I never forget again!
+    for (const auto& client : m_vClients)
     {
-        const HSteamNetConnection& hClientConnection = itClient.first;
+        const HSteamNetConnection& hClientConnection = client.m_hConn;
         logDetailedConnectionStatus(hClientConnection);
 
         // inform all clients about disconnecting this client;
@@ -184,7 +199,7 @@ bool PgeGnsServer::stopListening(const std::string& sExtraDebugText)
         static_cast<pge_network::PgeNetworkConnectionHandle>(k_HSteamNetConnection_Invalid));
     
     // we push this packet to our pkt queue, this is how we "send" message to ourselves so server game loop can process it
-    m_queuePackets.push_back(pkt);
+    enqueuePkt(pkt);
 
     return true;
 }
@@ -204,113 +219,174 @@ void PgeGnsServer::sendToClient(const HSteamNetConnection& conn, const pge_netwo
         return;
     }
 
-    uint32_t nActualPktSize;
-    if (pge_network::PgePacket::getPacketId(pkt) == pge_network::PgePktId::Application)
+    if (needsHandoffToIoThread())
     {
-        // We need the real used memory size so we can truncate the sent pkt to that.
-        // We need to consider member padding and the actual message sizes to have a correct value.
-        // 'cData' is our point of view since from there we need to calculate.
-        const pge_network::MsgApp* pMsgApp = pge_network::PgePacket::getMsgAppFromPkt(pkt);
-        assert(pMsgApp);  // never null since it points into pkt
-        const pge_network::TByte* pMsgAppInByteSteps = reinterpret_cast<const pge_network::TByte*>(pMsgApp);  // we can step this ptr in Bytes
-
-        const uint8_t nMessageCount = pge_network::PgePacket::getMessageAppCount(pkt);
-        assert(nMessageCount == 1); // for now only 1 msg/pkt
-        for (uint8_t i = 0; i < nMessageCount; i++)
+        TxCmd* const pCmd = beginTxCmd(TxCmd::Type::Send);
+        if (pCmd)
         {
-            pMsgApp = reinterpret_cast<const pge_network::MsgApp*>(pMsgAppInByteSteps);
-            // moving pMsgAppInByteSteps by the _actual_ size of the current MsgApp struct (considering the actual app message size there)
-            pMsgAppInByteSteps += pge_network::MsgApp::getMsgAppTotalActualSizeBytes(*pMsgApp);
+            pCmd->m_conn = conn;
+            pCmd->m_pkt = pkt;
+            endTxCmd(*pCmd);
         }
-        // now pMsgAppInByteSteps points to RIGHT AFTER the 1st byte of the last application message
-        const pge_network::TByte* pPkt = (const pge_network::TByte*)(&pkt);
-        nActualPktSize = pMsgAppInByteSteps - pPkt;
-    }
-    else
-    {
-        nActualPktSize = static_cast<uint32_t>(sizeof(pkt));
+        return;
     }
 
-    m_pInterface->SendMessageToConnection(conn, &pkt, nActualPktSize, k_nSteamNetworkingSend_Reliable, nullptr);
-    if (m_nTxPktCount == 1)
+    TClient* const pClient = findClient(conn);
+    if (!pClient)
     {
-        m_time1stTxPkt = std::chrono::steady_clock::now();
+        // not a known client, there is no batch for it, GNS will anyway reject sending if connection is not valid
+        sendPkt(conn, pkt, pge_network::PgeSendLane::Reliable);
+        return;
     }
-    m_nTxPktCount++;
+
     if (pge_network::PgePacket::getPacketId(pkt) == pge_network::PgePktId::Application)
     {
+        // app messages broadcast earlier in the same send lane need to go out first, to keep the original order
         const pge_network::MsgApp* pMsgApp = pge_network::PgePacket::getMsgAppFromPkt(pkt);
         const uint8_t nMessageCount = pge_network::PgePacket::getMessageAppCount(pkt);
-        for (uint8_t i = 0; i < nMessageCount; i++)
+        for (uint8_t i = 0; (i < nMessageCount) && pMsgApp; i++)
         {
-            // TODO: nooo, I need to properly iterate to next appmsg as I iterate in above loop!
-            ++m_nTxMsgCount[pge_network::MsgApp::getMsgAppMsgId(*pMsgApp)];
-            //if (pge_network::MsgApp::getMsgAppMsgId(*pMsgApp) == 1u )
-            //{
-            //    CConsole::getConsoleInstance("PgeGnsServer").OLn("%s() Sending out UserSetupFromServer to %u", __func__, conn);
-            //}
+            const pge_network::PgeSendLane lane = getSendLaneByMsgAppId(pge_network::MsgApp::getMsgAppMsgId(*pMsgApp));
+            flushBroadcastPktBatch(lane);
+            m_bClientPktBatchesPending[static_cast<size_t>(lane)] = true;
+            pMsgApp = pge_network::PgePacket::getNextMsgAppFromPkt(pkt, *pMsgApp);
         }
     }
-    m_nTxByteCount += nActualPktSize;
+    else
+    {
+        // non-app packets are sent immediately, so all app messages broadcast earlier need to go out first
+        flushBroadcastPktBatches();
+    }
+
+    batchPkt(conn, pClient->m_pktBatches, pkt);
 }
 
+/**
+* Sends the given packet to all clients except the given one.
+* The packet is copied only once for all clients: app messages are batched into common batch packets until flushBatchedPackets(),
+* and any other packet is sent immediately to all clients in a single GNS call.
+* 
+* @param pkt    The packet to be sent.
+* @param except The client not to receive the packet. Server never receives the packet anyway.
+*/
 void PgeGnsServer::sendToAllClientsExcept(const pge_network::PgePacket& pkt, const HSteamNetConnection& except)
 {
     static_assert(k_HSteamNetConnection_Invalid == 0U, "on upper layers we use connHandle 0 to identify server, so here k_HSteamNetConnection_Invalid must be 0");
-    //CConsole::getConsoleInstance("PgeGnsServer").OLn("%s() start to %u clients ...", __func__, m_mapClients.size());
-    for (auto& client : m_mapClients)
+    if (needsHandoffToIoThread())
     {
-        //CConsole::getConsoleInstance("PgeGnsServer").OLn("%s() client: %u ...", __func__, client.first);
-        if (client.first == k_HSteamNetConnection_Invalid)
+        TxCmd* const pCmd = beginTxCmd(TxCmd::Type::SendToAllExcept);
+        if (pCmd)
         {
-            // silent ignore, in the future maybe we will simply inject a message to ourselves' message queue
-            // that is how server can handle itself as a client similar to any other client
-            continue;
+            pCmd->m_vExcepts.clear();
+            if (except != k_HSteamNetConnection_Invalid)
+            {
+                pCmd->m_vExcepts.push_back(except);
+            }
+            pCmd->m_pkt = pkt;
+            endTxCmd(*pCmd);
         }
-        if (client.first != except)
+        return;
+    }
+
+    m_vExcepts.clear();
+    if (except != k_HSteamNetConnection_Invalid)
+    {
+        m_vExcepts.push_back(except);
+    }
+    broadcastPkt(pkt, m_vExcepts);
+}
+
+/**
+* Same as the other sendToAllClientsExcept(), but with multiple clients not to receive the packet.
+* 
+* @param pkt     The packet to be sent.
+* @param excepts The clients not to receive the packet. Server never receives the packet anyway.
+*/
+void PgeGnsServer::sendToAllClientsExcept(const pge_network::PgePacket& pkt, const std::set<HSteamNetConnection>& excepts)
+{
+    // on the application thread while the I/O thread is running, m_vExcepts belongs to the I/O thread, so we use the slot of the command
+    const bool bHandoff = needsHandoffToIoThread();
+    TxCmd* const pCmd = bHandoff ? beginTxCmd(TxCmd::Type::SendToAllExcept) : nullptr;
+    if (bHandoff && !pCmd)
+    {
+        return;
+    }
+    std::vector<HSteamNetConnection>& vExcepts = pCmd ? pCmd->m_vExcepts : m_vExcepts;
+
+    vExcepts.clear();
+    for (const auto& except : excepts)
+    {
+        // std::set is ordered so vExcepts stays sorted as expected by broadcastPkt()
+        if (except != k_HSteamNetConnection_Invalid)
         {
-            sendToClient(client.first, pkt);
+            vExcepts.push_back(except);
         }
     }
-    //CConsole::getConsoleInstance("PgeGnsServer").OLn("%s() end", __func__);
+
+    if (pCmd)
+    {
+        pCmd->m_pkt = pkt;
+        endTxCmd(*pCmd);
+        return;
+    }
+    broadcastPkt(pkt, m_vExcepts);
 }
 
-void PgeGnsServer::inject(const pge_network::PgePacket& pkt)
+/**
+* Sends out the app messages batched by sendToClient() and sendToAllClientsExcept() to all clients.
+* Expected to be invoked once per frame, after the application has sent all its messages for the current frame.
+*/
+void PgeGnsServer::flushBatchedPackets()
 {
-    m_queuePackets.push_back(pkt);
-    if (m_nInjectPktCount == 1)
+    if (needsHandoffToIoThread())
     {
-        m_time1stInjectPkt = std::chrono::steady_clock::now();
+        TxCmd* const pCmd = beginTxCmd(TxCmd::Type::Flush);
+        if (pCmd)
+        {
+            endTxCmd(*pCmd);
+        }
+        return;
     }
-    m_nInjectPktCount++;
-    if (pge_network::PgePacket::getPacketId(pkt) == pge_network::PgePktId::Application)
+
+    // within a send lane, either the broadcast batch packet or the client batch packets store app messages, never both,
+    // so the order of flushing doesn't matter here
+    flushBroadcastPktBatches();
+    for (auto& client : m_vClients)
     {
-        const pge_network::MsgApp* pMsgApp = pge_network::PgePacket::getMsgAppFromPkt(pkt);
-        const uint8_t nMessageCount = pge_network::PgePacket::getMessageAppCount(pkt);
-        assert(nMessageCount == 1); // for now only 1 msg/pkt
-        for (uint8_t i = 0; i < nMessageCount; i++)
+        if (client.m_hConn == k_HSteamNetConnection_Invalid)
         {
-            // TODO: nooo, I need to properly iterate to next appmsg as I iterate in sendToClient()!
-            ++m_nInjectMsgCount[pge_network::MsgApp::getMsgAppMsgId(*pMsgApp)];
+            // server never sends to itself, its batch is always empty
+            continue;
         }
+        flushBatchPkts(client.m_hConn, client.m_pktBatches);
+    }
+    m_bClientPktBatchesPending.fill(false);
+}
+
+void PgeGnsServer::inject(const pge_network::PgePacket& pkt)
+{
+    enqueuePkt(pkt);
+    if (!needsHandoffToIoThread())
+    {
+        // otherwise the I/O thread counts it, since it owns the statistics
+        countInjectedPkt(pkt);
     }
-    m_nInjectByteCount += sizeof(pkt);
 }
 
 void PgeGnsServer::WriteServerClientList()
 {
     CConsole::getConsoleInstance("PgeGnsServer").OLnOI("Listing Clients:");
-    for (const auto& client : m_mapClients)
+    for (const auto& client : m_vClients)
     {
-        if (client.first == k_HSteamNetConnection_Invalid)
+        if (client.m_hConn == k_HSteamNetConnection_Invalid)
         {
             CConsole::getConsoleInstance("PgeGnsServer").OLn("connHandle: %u (this is me); Name: %s; Address: %s",
-                client.first, client.second.m_sCustomName.c_str(), client.second.m_szAddr);
+                client.m_hConn, client.m_sCustomName.c_str(), client.m_szAddr);
         }
         else
         {
             CConsole::getConsoleInstance("PgeGnsServer").OLn("connHandle: %u; Name: %s; Address: %s",
-                client.first, client.second.m_sCustomName.c_str(), client.second.m_szAddr);
+                client.m_hConn, client.m_sCustomName.c_str(), client.m_szAddr);
         }
     }
     CConsole::getConsoleInstance("PgeGnsServer").OO();
@@ -337,8 +413,8 @@ const SteamNetConnectionRealTimeStatus_t& PgeGnsServer::getRealTimeStatus(const
     if (!pClient)
     {
         CConsole::getConsoleInstance("PgeGnsServer").EOLn("%s: connHandle %u not valid!", __func__, connHandle);
-        assert(!m_mapClients.empty());                         // never empty, first elem is always server (we)
-        return m_mapClients.begin()->second.m_connRtStatus;    // return with server's full zero data
+        assert(!m_vClients.empty());                 // never empty, first elem is always server (we)
+        return m_vClients.front().m_connRtStatus;    // return with server's full zero data
     }
 
     if (bForceUpdate)
@@ -371,10 +447,10 @@ bool PgeGnsServer::pgeMessageIsHandledAtGnsLevel(const pge_network::PgePacket& p
     {
         // this should be the very 1st PgePacket we receive from a just connected client
         const auto nClientConnHandle = pge_network::PgePacket::getServerSideConnectionHandle(pktReceivedFromClient);
-        const auto itClient = m_mapClients.find(nClientConnHandle);
-        if (itClient == m_mapClients.end())
+        const TClient* const pClient = findClient(nClientConnHandle);
+        if (!pClient)
         {
-            CConsole::getConsoleInstance("PgeGnsServer").EOLn("%s: SERVER Cannot happen: a client (%u) sent MsgClientAppVersionFromClient but not present in clients map!",
+            CConsole::getConsoleInstance("PgeGnsServer").EOLn("%s: SERVER Cannot happen: a client (%u) sent MsgClientAppVersionFromClient but not present in clients array!",
                 __func__, nClientConnHandle);
             assert(false);
         }
@@ -391,19 +467,19 @@ bool PgeGnsServer::pgeMessageIsHandledAtGnsLevel(const pge_network::PgePacket& p
                 pge_network::PgePacket pktUserConnected;
                 pge_network::PgePacket::initPktPgeMsgUserConnected(
                     pktUserConnected,
-                    itClient->first,
+                    pClient->m_hConn,
                     false /* bCurrentClient */,
-                    itClient->second.m_szAddr);
+                    pClient->m_szAddr);
             
                 // we push this packet to our pkt queue, this is how we "send" message to ourselves so server game loop can process it
-                m_queuePackets.push_back(pktUserConnected);
+                enqueuePkt(pktUserConnected);
             }
             else
             {
                 CConsole::getConsoleInstance("PgeGnsServer").EOLn("%s: SERVER client (%u) app version mismatching (%s), disconnecting client!",
                     __func__, nClientConnHandle, msgClientAppVersion.m_szAppVersion);
 
-                m_mapClients.erase(itClient);
+                removeClient(nClientConnHandle);
                 const std::string sDebugText = "Server app version mismatching with client app version: " + m_sAppVersion + " != " + std::string(msgClientAppVersion.m_szAppVersion);
                 m_pInterface->CloseConnection(nClientConnHandle, 0, sDebugText.c_str(), false);
             }
@@ -428,10 +504,9 @@ bool PgeGnsServer::validateSteamNetworkingMessage(const HSteamNetConnection& con
         return false;
     }
 
-    const auto itClient = m_mapClients.find(connHandle);
-    if (itClient == m_mapClients.end())
+    if (!findClient(connHandle))
     {
-        CConsole::getConsoleInstance("PgeGnsServer").EOLn("%s: SERVER failed to find connection %u in m_mapClients!",
+        CConsole::getConsoleInstance("PgeGnsServer").EOLn("%s: SERVER failed to find connection %u in m_vClients!",
             __func__, static_cast<unsigned int>(connHandle));
         return false;
     }
@@ -475,21 +550,22 @@ void PgeGnsServer::onSteamNetConnectionStatusChanged(SteamNetConnectionStatusCha
             default: // k_ESteamNetworkingConnectionState_ProblemDetectedLocally
                 pszDebugLogAction = "disappeared, problem detected locally";
             } // end switch m_eState
-            const auto itClient = m_mapClients.find(pInfo->m_hConn);
-            if (itClient == m_mapClients.end())
+            const TClient* const pClient = findClient(pInfo->m_hConn);
+            if (!pClient)
             {
                 sprintf(szTemp, "Not stored (maybe already deleted) client %s, reason %d: %s", pszDebugLogAction, pInfo->m_info.m_eEndReason, pInfo->m_info.m_szEndDebug);
             }
             else
             {
-                sprintf(szTemp, "%s %s, reason %d: %s", itClient->second.m_sCustomName.c_str(), pszDebugLogAction, pInfo->m_info.m_eEndReason, pInfo->m_info.m_szEndDebug);
-                m_mapClients.erase(itClient);  // dont try to send anything to the disconnected client :)
+                sprintf(szTemp, "%s %s, reason %d: %s", pClient->m_sCustomName.c_str(), pszDebugLogAction, pInfo->m_info.m_eEndReason, pInfo->m_info.m_szEndDebug);
+                removeClient(pInfo->m_hConn);  // dont try to send anything to the disconnected client :)
+                m_stats.removeConnection(pInfo->m_hConn);
 
-                // App level should be notified only if we found it in m_mapClients, otherwise probably this client was never known by app level
+                // App level should be notified only if we found it in m_vClients, otherwise probably this client was never known by app level
                 pge_network::PgePacket pkt;
                 pge_network::PgePacket::initPktPgeMsgUserDisconnected(pkt, pInfo->m_hConn);
                 // we push this packet to our pkt queue, this is how we "send" message to ourselves so server game loop can process it
-                m_queuePackets.push_back(pkt);
+                enqueuePkt(pkt);
                 sendToAllClientsExcept(pkt);
             }
             CConsole::getConsoleInstance("PgeGnsServer").OLn("%s: SERVER Connection %s (handle %u) %s",
@@ -521,7 +597,7 @@ void PgeGnsServer::onSteamNetConnectionStatusChanged(SteamNetConnectionStatusCha
     case k_ESteamNetworkingConnectionState_Connecting:
     {
         // This must be a new connection
-        assert(m_mapClients.find(pInfo->m_hConn) == m_mapClients.end());
+        assert(!findClient(pInfo->m_hConn));
 
         CConsole::getConsoleInstance("PgeGnsServer").OLn("%s: SERVER Connection request from %s", __func__, pInfo->m_info.m_szConnectionDescription);
 
@@ -545,10 +621,13 @@ void PgeGnsServer::onSteamNetConnectionStatusChanged(SteamNetConnectionStatusCha
             break;
         }
 
-        // Add them to the client list, using std::map wacky syntax
-        m_mapClients[pInfo->m_hConn];
-        pInfo->m_info.m_addrRemote.ToString(m_mapClients[pInfo->m_hConn].m_szAddr, sizeof(m_mapClients[pInfo->m_hConn].m_szAddr), true);
-        CConsole::getConsoleInstance("PgeGnsServer").OLn("%s: SERVER A client is connecting from %s ...", __func__, m_mapClients[pInfo->m_hConn].m_szAddr);
+        // app messages broadcast so far were sent before this client was known, it should not receive them
+        flushBroadcastPktBatches();
+
+        // Add them to the client list
+        TClient& client = addClient(pInfo->m_hConn);
+        pInfo->m_info.m_addrRemote.ToString(client.m_szAddr, sizeof(client.m_szAddr), true);
+        CConsole::getConsoleInstance("PgeGnsServer").OLn("%s: SERVER A client is connecting from %s ...", __func__, client.m_szAddr);
 
         // since v0.2.4, we do NOT inject MsgUserConnected, instead we expect client now to send us a MsgClientAppVersionFromClient that we handle in
         // pgeMessageIsHandledAtGnsLevel(), and based on version match, we inject MsgUserConnected there!
@@ -561,10 +640,9 @@ void PgeGnsServer::onSteamNetConnectionStatusChanged(SteamNetConnectionStatusCha
         // We will get a callback immediately after accepting the connection.
         // Since we are the server, we can ignore this, it's not news to us.
 
-        const auto itClient = m_mapClients.find(pInfo->m_hConn);
-        if (itClient == m_mapClients.end())
+        if (!findClient(pInfo->m_hConn))
         {
-            CConsole::getConsoleInstance("PgeGnsServer").EOLn("%s: SERVER Cannot happen: a client (%u) has reached state Connected but not present in clients map!",
+            CConsole::getConsoleInstance("PgeGnsServer").EOLn("%s: SERVER Cannot happen: a client (%u) has reached state Connected but not present in clients array!",
                 __func__, pInfo->m_hConn);
             assert(false);
         }
@@ -593,6 +671,55 @@ void PgeGnsServer::onSteamNetConnectionStatusChanged(SteamNetConnectionStatusCha
     }
 }  // onSteamNetConnectionStatusChanged()
 
+bool PgeGnsServer::canPollIncomingMessages() const
+{
+    return isListening();
+}
+
+/**
+* Executes the given command handed over by the application thread, on the network I/O thread.
+* 
+* @param cmd The command to be executed.
+*/
+void PgeGnsServer::executeTxCmd(const TxCmd& cmd)
+{
+    switch (cmd.m_type)
+    {
+    case TxCmd::Type::Send:
+        sendToClient(cmd.m_conn, cmd.m_pkt);
+        break;
+    case TxCmd::Type::SendToAllExcept:
+        broadcastPkt(cmd.m_pkt, cmd.m_vExcepts);
+        break;
+    case TxCmd::Type::Flush:
+        flushBatchedPackets();
+        break;
+    case TxCmd::Type::Inject:
+        captureInjectedPkt(cmd.m_pkt);
+        countInjectedPkt(cmd.m_pkt);
+        break;
+    default:
+        CConsole::getConsoleInstance("PgeGnsServer").EOLn("%s: unknown cmd type: %u!", __func__, static_cast<uint32_t>(cmd.m_type));
+    }
+}
+
+/**
+* Collects the connection handles of all clients, to be sampled by the telemetry.
+* 
+* @param vConns Receives the connection handles.
+*/
+void PgeGnsServer::collectTelemetryConns(std::vector<HSteamNetConnection>& vConns) const
+{
+    for (const auto& client : m_vClients)
+    {
+        // server itself has no connection to be sampled
+        if (client.m_hConn != k_HSteamNetConnection_Invalid)
+        {
+            vConns.push_back(client.m_hConn);
+        }
+    }
+}
+
 
 // ############################### PRIVATE ###############################
 
@@ -603,6 +730,8 @@ PgeGnsServer::PgeGnsServer(PGEcfgProfiles& cfgProfiles) :
     m_hListenSock(k_HSteamListenSocket_Invalid),
     m_hPollGroup(k_HSteamNetPollGroup_Invalid)
 {
+    initPktBatches(m_broadcastPktBatches);
+    m_bClientPktBatchesPending.fill(false);
 } // PgeGnsServer()
 
 PgeGnsServer::PgeGnsServer(const PgeGnsServer& other) :
@@ -632,14 +761,14 @@ const PgeGnsServer::TClient* PgeGnsServer::isClientConnectionHandleValid(const H
         return nullptr;
     }
 
-    const auto itClient = m_mapClients.find(connHandle);
-    if (itClient == m_mapClients.end())
+    const TClient* const pClient = findClient(connHandle);
+    if (!pClient)
     {
         CConsole::getConsoleInstance("PgeGnsServer").EOLn("%s: connHandle %u not found!", __func__, connHandle);
         return nullptr;
     }
 
-    return &itClient->second;
+    return pClient;
 }
 
 PgeGnsServer::TClient* PgeGnsServer::isClientConnectionHandleValid(const HSteamNetConnection& connHandle)
@@ -647,3 +776,218 @@ PgeGnsServer::TClient* PgeGnsServer::isClientConnectionHandleValid(const HSteamN
     // simply invoke the const-version of isClientConnectionHandleValid() above by const-casting:
     return const_cast<TClient*>((const_cast<const PgeGnsServer* const>(this))->isClientConnectionHandleValid(connHandle));
 }
+
+/**
+* @return The client with the given connection handle, or nullptr if not found. Server itself is found by k_HSteamNetConnection_Invalid.
+*/
+const PgeGnsServer::TClient* PgeGnsServer::findClient(const HSteamNetConnection& connHandle) const
+{
+    for (const auto& client : m_vClients)
+    {
+        if (client.m_hConn == connHandle)
+        {
+            return &client;
+        }
+    }
+    return nullptr;
+}
+
+PgeGnsServer::TClient* PgeGnsServer::findClient(const HSteamNetConnection& connHandle)
+{
+    return const_cast<TClient*>((const_cast<const PgeGnsServer* const>(this))->findClient(connHandle));
+}
+
+/**
+* Adds a new client with the given connection handle, with zeroed data and empty batch packets.
+* The returned reference is valid only until the next addition or removal of a client.
+*/
+PgeGnsServer::TClient& PgeGnsServer::addClient(const HSteamNetConnection& connHandle)
+{
+    // value-initialization zeroes the address and the status too
+    m_vClients.emplace_back();
+    TClient& client = m_vClients.back();
+    client.m_hConn = connHandle;
+    initPktBatches(client.m_pktBatches);
+    return client;
+}
+
+/**
+* Removes the client with the given connection handle, if found.
+* Order of clients is not kept, the last client is moved to the place of the removed client.
+*/
+void PgeGnsServer::removeClient(const HSteamNetConnection& connHandle)
+{
+    TClient* const pClient = findClient(connHandle);
+    if (!pClient)
+    {
+        return;
+    }
+
+    if (pClient != &m_vClients.back())
+    {
+        *pClient = std::move(m_vClients.back());
+    }
+    m_vClients.pop_back();
+}
+
+/**
+* Updates the inject statistics as the given packet was injected.
+* 
+* @param pkt The injected packet.
+*/
+void PgeGnsServer::countInjectedPkt(const pge_network::PgePacket& pkt)
+{
+    const pge_network::PgeNetworkStats::TimePoint timeInject = std::chrono::steady_clock::now();
+    if (m_nInjectPktCount == 1)
+    {
+        m_time1stInjectPkt = timeInject;
+    }
+    m_nInjectPktCount++;
+    m_stats.addPkt(
+        pge_network::PgeNetworkStats::Direction::Inject,
+        pge_network::PgePacket::getServerSideConnectionHandle(pkt),
+        pge_network::PgePacket::getPktActualSizeBytes(pkt),
+        timeInject);
+    if (pge_network::PgePacket::getPacketId(pkt) == pge_network::PgePktId::Application)
+    {
+        const pge_network::MsgApp* pMsgApp = pge_network::PgePacket::getMsgAppFromPkt(pkt);
+        const uint8_t nMessageCount = pge_network::PgePacket::getMessageAppCount(pkt);
+        assert(nMessageCount == 1); // for now only 1 msg/pkt
+        for (uint8_t i = 0; (i < nMessageCount) && pMsgApp; i++)
+        {
+            const pge_network::MsgApp::TMsgId& msgAppId = pge_network::MsgApp::getMsgAppMsgId(*pMsgApp);
+            m_stats.addMsgApp(
+                pge_network::PgeNetworkStats::Direction::Inject,
+                msgAppId,
+                pge_network::MsgApp::getMsgAppTotalActualSizeBytes(*pMsgApp),
+                getSendLaneByMsgAppId(msgAppId),
+                timeInject);
+            pMsgApp = pge_network::PgePacket::getNextMsgAppFromPkt(pkt, *pMsgApp);
+        }
+    }
+    m_nInjectByteCount += sizeof(pkt);
+}
+
+/**
+* Sends the given packet to all clients except the given ones, copying it only once for all clients.
+* App messages are batched into m_broadcastPktBatches, any other packet is sent immediately.
+* 
+* A broadcast batch packet is sent out before storing app messages with different server-side connection handle or different
+* excepted clients, and client batch packets of the same send lane are sent out before storing app messages in a broadcast batch packet.
+* This way the original order of messages is kept within the same send lane, as in PgeGnsWrapper::batchPkt().
+* 
+* @param pkt      The packet to be sent.
+* @param vExcepts Sorted clients not to receive the packet.
+*/
+void PgeGnsServer::broadcastPkt(const pge_network::PgePacket& pkt, const std::vector<HSteamNetConnection>& vExcepts)
+{
+    if (pge_network::PgePacket::getPacketId(pkt) != pge_network::PgePktId::Application)
+    {
+        // non-app packets are sent immediately, so all batched app messages need to go out first
+        flushBatchedPackets();
+        collectBroadcastConns(vExcepts);
+        sendPktToConnections(m_vBroadcastConns, pkt, pge_network::PgeSendLane::Reliable);
+        return;
+    }
+
+    const pge_network::MsgApp* pMsgApp = pge_network::PgePacket::getMsgAppFromPkt(pkt);
+    const uint8_t nMessageCount = pge_network::PgePacket::getMessageAppCount(pkt);
+    for (uint8_t i = 0; (i < nMessageCount) && pMsgApp; i++)
+    {
+        const pge_network::PgeSendLane lane = getSendLaneByMsgAppId(pge_network::MsgApp::getMsgAppMsgId(*pMsgApp));
+        const size_t iLane = static_cast<size_t>(lane);
+        pge_network::PgePacket& pktBatch = m_broadcastPktBatches[iLane];
+
+        if (m_bClientPktBatchesPending[iLane])
+        {
+            flushClientPktBatches(lane);
+        }
+
+        if ((pge_network::PgePacket::getServerSideConnectionHandle(pkt) != pge_network::PgePacket::getServerSideConnectionHandle(pktBatch)) ||
+            (m_vBroadcastExcepts[iLane] != vExcepts))
+        {
+            // connection handle and excepted clients are per-packet, so we cannot mix app messages with different ones in the same packet
+            flushBroadcastPktBatch(lane);
+            pge_network::PgePacket::getServerSideConnectionHandle(pktBatch) = pge_network::PgePacket::getServerSideConnectionHandle(pkt);
+            m_vBroadcastExcepts[iLane] = vExcepts;  // no allocation once capacity is enough
+        }
+
+        if (!pge_network::PgePacket::addPktMsgApp(pktBatch, *pMsgApp))
+        {
+            // not enough space in the batch packet, send it out and retry with an empty batch packet
+            flushBroadcastPktBatch(lane);
+            if (!pge_network::PgePacket::addPktMsgApp(pktBatch, *pMsgApp))
+            {
+                CConsole::getConsoleInstance("PgeGnsServer").EOLn("%s: failed to batch app message %u!",
+                    __func__, pge_network::MsgApp::getMsgAppMsgId(*pMsgApp));
+                assert(false);
+            }
+        }
+        pMsgApp = pge_network::PgePacket::getNextMsgAppFromPkt(pkt, *pMsgApp);
+    }
+}
+
+/**
+* Collects the connection handles of all clients except the given ones into m_vBroadcastConns.
+* 
+* @param vExcepts Sorted clients to be left out.
+*/
+void PgeGnsServer::collectBroadcastConns(const std::vector<HSteamNetConnection>& vExcepts)
+{
+    m_vBroadcastConns.clear();
+    for (const auto& client : m_vClients)
+    {
+        // server never sends to itself
+        if ((client.m_hConn != k_HSteamNetConnection_Invalid) && !std::binary_search(vExcepts.begin(), vExcepts.end(), client.m_hConn))
+        {
+            m_vBroadcastConns.push_back(client.m_hConn);
+        }
+    }
+}
+
+/**
+* Sends out the broadcast batch packet of the given send lane to all clients except its excepted clients, if it stores any app message,
+* and empties the batch packet.
+*/
+void PgeGnsServer::flushBroadcastPktBatch(const pge_network::PgeSendLane& lane)
+{
+    const size_t iLane = static_cast<size_t>(lane);
+    pge_network::PgePacket& pktBatch = m_broadcastPktBatches[iLane];
+    const pge_network::PgePacket& pktBatchAsConst = pktBatch;  // non-const getMessageAppCount() is private
+    if (pge_network::PgePacket::getMessageAppCount(pktBatchAsConst) == 0)
+    {
+        return;
+    }
+
+    collectBroadcastConns(m_vBroadcastExcepts[iLane]);
+    sendPktToConnections(m_vBroadcastConns, pktBatch, lane);
+    pge_network::PgePacket::initPktMsgApp(
+        pktBatch,
+        pge_network::PgePacket::getServerSideConnectionHandle(pktBatch),
+        pge_network::PgePacket::AutoFill::NONE);
+}
+
+void PgeGnsServer::flushBroadcastPktBatches()
+{
+    for (size_t iLane = 0; iLane < m_broadcastPktBatches.size(); iLane++)
+    {
+        flushBroadcastPktBatch(static_cast<pge_network::PgeSendLane>(iLane));
+    }
+}
+
+/**
+* Sends out the client batch packets of the given send lane to all clients.
+*/
+void PgeGnsServer::flushClientPktBatches(const pge_network::PgeSendLane& lane)
+{
+    for (auto& client : m_vClients)
+    {
+        if (client.m_hConn == k_HSteamNetConnection_Invalid)
+        {
+            // server never sends to itself, its batch is always empty
+            continue;
+        }
+        flushBatchPkt(client.m_hConn, client.m_pktBatches, lane);
+    }
+    m_bClientPktBatchesPending[static_cast<size_t>(lane)] = false;
+}
@@ -13,11 +13,13 @@
 
 #include "../PGEallHeaders.h"
 
+#include <array>
 #include <chrono>  // requires cpp11
 #include <cstdint>
 #include <deque>
-#include <map>
+#include <set>
 #include <string>
+#include <vector>
 
 #include "../Config/PGEcfgProfiles.h"
 #include "PgePacket.h"
@@ -83,6 +85,8 @@ public:
 
     void sendToClient(const HSteamNetConnection& conn, const pge_network::PgePacket& pkt);
     void sendToAllClientsExcept(const pge_network::PgePacket& pkt, const HSteamNetConnection& except = k_HSteamNetConnection_Invalid);
+    void sendToAllClientsExcept(const pge_network::PgePacket& pkt, const std::set<HSteamNetConnection>& excepts);
+    void flushBatchedPackets();
 
     void inject(const pge_network::PgePacket& pkt);
 
@@ -101,29 +105,39 @@ protected:
     virtual bool validateSteamNetworkingMessage(const HSteamNetConnection& connHandle) const override;
     virtual void updateIncomingPgePacket(pge_network::PgePacket& pkt, const HSteamNetConnection& connHandle) const override;
     virtual void onSteamNetConnectionStatusChanged(SteamNetConnectionStatusChangedCallback_t* pInfo) override;
+    virtual bool canPollIncomingMessages() const override;
+    virtual void executeTxCmd(const TxCmd& cmd) override;
+    virtual void collectTelemetryConns(std::vector<HSteamNetConnection>& vConns) const override;
 
 private:
 
     struct TClient
     {
+        HSteamNetConnection m_hConn;
         std::string m_sCustomName;  /**< App level can set a custom name for client which is useful for debugging. */
         char m_szAddr[SteamNetworkingIPAddr::k_cchMaxString];
         SteamNetConnectionRealTimeStatus_t m_connRtStatus;
+        SendLane2PktBatchArray m_pktBatches;  /**< App messages sent to this client are batched here per send lane until flushBatchedPackets(). */
     };
 
-    typedef std::map< HSteamNetConnection, TClient > SteamNetConnHandle2TClientMap;
-
     uint16 m_nPort;
 
     HSteamListenSocket m_hListenSock;
     HSteamNetPollGroup m_hPollGroup;
 
-    SteamNetConnHandle2TClientMap m_mapClients;
-    // The connection handle is used to identify clients in the map.
+    std::vector<TClient> m_vClients;
+    // Contiguous so iterating over all clients when broadcasting is cheap, we never have so many clients that a linear search would hurt.
+    // The connection handle is used to identify clients in the array.
     // This handle for a client is NOT the same as the handle on the client side, obviously.
-    // Note that the first connection is this map is an invalid connection (k_HSteamNetConnection_Invalid), which
+    // Note that the first connection is this array is an invalid connection (k_HSteamNetConnection_Invalid), which
     // is the server itself, this is how this layer stores nickname for the server (self).
 
+    SendLane2PktBatchArray m_broadcastPktBatches;  /**< App messages sent to all clients are batched here per send lane, to be copied only once for all clients. */
+    std::array<std::vector<HSteamNetConnection>, pge_network::nSendLaneCount> m_vBroadcastExcepts;  /**< Per send lane, sorted clients not to receive the broadcast batch packet. */
+    std::array<bool, pge_network::nSendLaneCount> m_bClientPktBatchesPending;  /**< Per send lane, true if any client batch packet might store app messages. */
+    std::vector<HSteamNetConnection> m_vExcepts;         /**< Reused by sendToAllClientsExcept(), so it doesn't allocate per call. */
+    std::vector<HSteamNetConnection> m_vBroadcastConns;  /**< Reused by flushBroadcastPktBatch(), so it doesn't allocate per call. */
+
     // ---------------------------------------------------------------------------
 
     explicit PgeGnsServer(PGEcfgProfiles& cfgProfiles);
@@ -133,4 +147,16 @@ private:
     const TClient* isClientConnectionHandleValid(const HSteamNetConnection& connHandle) const;
     TClient* isClientConnectionHandleValid(const HSteamNetConnection& connHandle);
 
+    const TClient* findClient(const HSteamNetConnection& connHandle) const;
+    TClient* findClient(const HSteamNetConnection& connHandle);
+    TClient& addClient(const HSteamNetConnection& connHandle);
+    void removeClient(const HSteamNetConnection& connHandle);
+    void countInjectedPkt(const pge_network::PgePacket& pkt);
+
+    void broadcastPkt(const pge_network::PgePacket& pkt, const std::vector<HSteamNetConnection>& vExcepts);
+    void collectBroadcastConns(const std::vector<HSteamNetConnection>& vExcepts);
+    void flushBroadcastPktBatch(const pge_network::PgeSendLane& lane);
+    void flushBroadcastPktBatches();
+    void flushClientPktBatches(const pge_network::PgeSendLane& lane);
+
 }; // class PgeGnsServer
\ No newline at end of file
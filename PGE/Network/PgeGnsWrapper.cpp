@@ -12,9 +12,37 @@
 #include "PgeGnsWrapper.h"
 
 #include <cassert>
+#include <fstream>
 
 #include "../PGEincludes.h"
 #include "../PGEpragmas.h"
+#include "PgeINetwork.h"
+
+
+/** The network I/O thread waits at most this long for work from the application thread, between 2 polls of GNS. */
+static const std::chrono::milliseconds IO_THREAD_POLL_INTERVAL(1);
+
+/** A received PgePacket is unpacked into at most this many PgePackets, i.e. as many MsgApps as fit into it with zero-size data. */
+static const std::size_t RX_MAX_UNPACKED_PKTS_PER_GNS_MSG =
+    pge_network::MsgAppArea::nMaxMessagesAreaLengthBytes / (sizeof(pge_network::MsgApp::TMsgId) + sizeof(pge_network::MsgApp::TMsgSize));
+
+/** Slots of the packet queue never filled by received packets, so packets injected by PGE, e.g. MsgUserConnected, always fit. */
+static const std::size_t RX_QUEUE_INJECT_HEADROOM = 64;
+
+/** The packet queue should be able to hold a full received batch besides the headroom for injected packets. */
+static const std::size_t RX_QUEUE_MIN_CAPACITY = RX_MAX_UNPACKED_PKTS_PER_GNS_MSG + RX_QUEUE_INJECT_HEADROOM;
+
+/** The application thread waits at most this long for room in the full tx handoff queue, then the command is dropped. */
+static const std::chrono::milliseconds IO_THREAD_TX_HANDOFF_TIMEOUT(100);
+
+/** The application thread checks the full tx handoff queue this often while waiting. */
+static const std::chrono::microseconds IO_THREAD_TX_HANDOFF_RETRY_INTERVAL(100);
+
+/** The network I/O thread publishes its statistics for the application thread this often. */
+static const std::chrono::milliseconds IO_THREAD_STATS_PUBLISH_INTERVAL(250);
+
+/** Length of the time windows in the exported telemetry window statistics. */
+static const std::chrono::milliseconds TELEMETRY_EXPORT_WINDOW(1000);
 
 
 static void NetworkDbg(ESteamNetworkingSocketsDebugOutputType eType, const char* pszMsg)
@@ -84,6 +112,9 @@ bool PgeGnsWrapper::destroy()
         return true;
     }
 
+    // derived classes already stop it before closing their connections, this is just for safety
+    stopIoThread();
+
     m_pInterface = nullptr;
 
     CConsole::getConsoleInstance("PgeGnsWrapper").OLn("");
@@ -95,31 +126,35 @@ bool PgeGnsWrapper::destroy()
     CConsole::getConsoleInstance("PgeGnsWrapper").OLn("Total Tx'd Bytes : %u", getTxByteCount());
     CConsole::getConsoleInstance("PgeGnsWrapper").OLn("Total Rx'd Bytes : %u", getRxByteCount());
     CConsole::getConsoleInstance("PgeGnsWrapper").OLn("Total Inj'd Bytes: %u", getInjectByteCount());
-    
+
     CConsole::getConsoleInstance("PgeGnsWrapper").OLn("");
-    CConsole::getConsoleInstance("PgeGnsWrapper").OLnOI("Total Tx'd App Msg Count per AppMsgId:");
-    for (const auto& txMsgCount : m_nTxMsgCount)
-    {
-        CConsole::getConsoleInstance("PgeGnsWrapper").OLn("Id %u %s: %u", txMsgCount.first, getStringByMsgAppId(txMsgCount.first).c_str(), txMsgCount.second);
-    }
-    CConsole::getConsoleInstance("PgeGnsWrapper").OO();
+    CConsole::getConsoleInstance("PgeGnsWrapper").OLn("Pkt Queue Capacity       : %u", m_queuePackets.capacity());
+    CConsole::getConsoleInstance("PgeGnsWrapper").OLn("Pkt Queue High Water Mark: %u", getPacketQueueHighWaterMark());
+    CConsole::getConsoleInstance("PgeGnsWrapper").OLn("Pkt Queue Dropped Count  : %u", getPacketQueueDroppedCount());
+    
+    logMsgAppStats(pge_network::PgeNetworkStats::Direction::Tx, "Total Tx'd App Msg Count per AppMsgId:");
+    logMsgAppStats(pge_network::PgeNetworkStats::Direction::Rx, "Total Rx'd App Msg Count per AppMsgId:");
+    logMsgAppStats(pge_network::PgeNetworkStats::Direction::Inject, "Total Inj'd App Msg Count per AppMsgId:");
 
     CConsole::getConsoleInstance("PgeGnsWrapper").OLn("");
-    CConsole::getConsoleInstance("PgeGnsWrapper").OLnOI("Total Rx'd App Msg Count per AppMsgId:");
-    for (const auto& rxMsgCount : m_nRxMsgCount)
+    CConsole::getConsoleInstance("PgeGnsWrapper").OLnOI("Total Tx'd App Msg Count per Send Lane:");
+    for (const auto& txLaneMsgCount : m_stats.getLaneMsgCountMap(pge_network::PgeNetworkStats::Direction::Tx))
     {
-        CConsole::getConsoleInstance("PgeGnsWrapper").OLn("Id %u %s: %u", rxMsgCount.first, getStringByMsgAppId(rxMsgCount.first).c_str(), rxMsgCount.second);
+        CConsole::getConsoleInstance("PgeGnsWrapper").OLn("%s: %u", getSendLaneString(txLaneMsgCount.first), txLaneMsgCount.second);
     }
     CConsole::getConsoleInstance("PgeGnsWrapper").OO();
 
     CConsole::getConsoleInstance("PgeGnsWrapper").OLn("");
-    CConsole::getConsoleInstance("PgeGnsWrapper").OLnOI("Total Inj'd App Msg Count per AppMsgId:");
-    for (const auto& injectMsgCount : m_nInjectMsgCount)
+    CConsole::getConsoleInstance("PgeGnsWrapper").OLnOI("Total Rx'd App Msg Count per Send Lane:");
+    for (const auto& rxLaneMsgCount : m_stats.getLaneMsgCountMap(pge_network::PgeNetworkStats::Direction::Rx))
     {
-        CConsole::getConsoleInstance("PgeGnsWrapper").OLn("Id %u %s: %u", injectMsgCount.first, getStringByMsgAppId(injectMsgCount.first).c_str(), injectMsgCount.second);
+        CConsole::getConsoleInstance("PgeGnsWrapper").OLn("%s: %u", getSendLaneString(rxLaneMsgCount.first), rxLaneMsgCount.second);
     }
     CConsole::getConsoleInstance("PgeGnsWrapper").OLnOO("");
 
+    m_capture.close();
+    exportTelemetry();
+
     GameNetworkingSockets_Kill();  // hopefully this can be invoked even if GNS has been already killed
     return true;
 } // destroy()
@@ -131,139 +166,64 @@ bool PgeGnsWrapper::isInitialized() const
 
 bool PgeGnsWrapper::pollIncomingMessages()
 {
-    static const int nIncomingMsgArraySize = 10;
-    ISteamNetworkingMessage* pIncomingGnsMsg[nIncomingMsgArraySize];
-
-    if (!isInitialized())
-    {
-        CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s not initialized!", __func__);
-        return false;
-    }
-
-    // numGnsMsgs is actually the number of received PgePackets, however GNS talks about SteamNetworkingMessage,
-    // but PGE puts a PgePacket into such message, and a PgePacket can contain multiple MsgApps, so pls don't
-    // mix the MsgApps with SteamNetworkingMessages, they are not the same messages.
-    const int numGnsMsgs = receiveMessages(pIncomingGnsMsg, nIncomingMsgArraySize);
-    if (numGnsMsgs == 0)
+    if (needsHandoffToIoThread())
     {
+        // I/O thread is receiving the messages, here we just take over what it has received so far
+        handOverIoThreadRxPkts();
         return false;
     }
 
-    if (numGnsMsgs < 0)
-    {
-        // This case falling here would be normal when GNS instance is not connected, actually sometimes
-        // we do disconnect on purpose in different cases other than exiting the application.
-        // However, we still log this as error and expect the caller NOT invoke us when they know we are not connected.
-        CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: Error checking for messages!", __func__);
-        return false;
-    }
+    return receiveIncomingMessages();
+}
 
-    if (!pIncomingGnsMsg)
+void PgeGnsWrapper::pollConnectionStateChanges()
+{
+    if (needsHandoffToIoThread())
     {
-        CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: pIncomingGnsMsg null!", __func__);
-        return false;
+        return;
     }
 
-    for (int i = 0; i < numGnsMsgs; i++)
-    {
-        if (!validateSteamNetworkingMessage(pIncomingGnsMsg[i]->m_conn))
-        {
-            continue;
-        }
-
-        // PgePacket is a fixed-size memory area, during sending we truncate it to actual size, which is this size:
-        const int nActualPktSize = (pIncomingGnsMsg[i])->m_cbSize;
-        pge_network::PgePacket pkt;
-        assert(nActualPktSize <= sizeof(pkt));
-        assert(nActualPktSize > 0);
-        
-        memcpy(&pkt, (pIncomingGnsMsg[i])->m_pData, nActualPktSize);
-        updateIncomingPgePacket(pkt, pIncomingGnsMsg[i]->m_conn);
-
-        // We don't need this anymore.
-        // Note that we could even push pIncomingGnsMsg to a queue, and process it later, and
-        // release it later, that could be a good speed optimization.
-        (pIncomingGnsMsg[i])->Release();
-
-        const pge_network::PgePacket& pktAsConst = pkt;  // from now on we use this const version
-
-        if (pge_network::PgePacket::getPacketId(pktAsConst) == pge_network::PgePktId::Application)
-        {
-            const uint8_t nMessageCount = pge_network::PgePacket::getMessageAppCount(pktAsConst);
-            if (nMessageCount == 0)
-            {
-                CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: app message pkt with msg count 0 from connection %u!",
-                    __func__, pge_network::PgePacket::getServerSideConnectionHandle(pktAsConst));
-                assert(false);
-                continue;
-            }
-
-            // for now we support only 1 app msg / pkt
-            assert(nMessageCount == 1);
-
-            const pge_network::MsgApp* pMsgApp = pge_network::PgePacket::getMsgAppFromPkt(pktAsConst);
-            assert(pMsgApp);  // never null since it points into pkt
-            
-            for (uint8_t iAppMsg = 0; iAppMsg < nMessageCount; iAppMsg++)
-            {
-                // TODO: nooo I need proper iteration for every msgId!
-                const pge_network::MsgApp::TMsgId& msgAppId = pge_network::MsgApp::getMsgAppMsgId(*pMsgApp);
-                if (m_allowListedAppMessages.end() == m_allowListedAppMessages.find(msgAppId))
-                {
-                    CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: non-allowlisted app message received: %u from connection %u!",
-                        __func__, msgAppId, pge_network::PgePacket::getServerSideConnectionHandle(pktAsConst));
-                    assert(false);
-                    continue;
-                }
-                ++m_nRxMsgCount[msgAppId];
-                
-                // we could also check if nMsgSize is non-zero, however we shouldnt: app is allowed to define zero-size AppMsg, it is
-                // not our business here to judge.
-                pMsgApp += pge_network::MsgApp::getMsgAppTotalActualSizeBytes(*pMsgApp);
-            }
-        }
-        else
-        {
-            if (m_allowListedPgeMessages.end() == m_allowListedPgeMessages.find(pge_network::PgePacket::getPacketId(pktAsConst)))
-            {
-                CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: non-allowlisted pge message received: %u from connection %u!",
-                    __func__, pge_network::PgePacket::getPacketId(pktAsConst), pge_network::PgePacket::getServerSideConnectionHandle(pktAsConst));
-                assert(false);
-                continue;
-            }
-
-            if (pgeMessageIsHandledAtGnsLevel(pktAsConst))
-            {
-                CConsole::getConsoleInstance("PgeGnsWrapper").OLn("%s: PGE message %u handled at GNS level without reaching PGE level, from connection %u!",
-                    __func__, pge_network::PgePacket::getPacketId(pktAsConst), pge_network::PgePacket::getServerSideConnectionHandle(pktAsConst));
-                continue;
-            }
-        }
+    // since this is also static, we cannot set it in ctor, because both PgeGnsServer and PgeGnsClient are instantiated, and
+    // their ctor would set this same static variable ... so it won't work to set it in the ctor.
+    // For now I'm just leaving this here so it is always set by the proper instance.
+    s_pCallbackInstance = this;
+    m_pInterface->RunCallbacks(); // triggers steamNetConnectionStatusChangedCallback()
 
-        // TODO: m_nRxByteCount should be incremented earlier since there are cases in the loop where we continue to next pkt, or we should
-        // update the definition of m_nRxByteCount to counting only those pkts which are actually pushed into PGE queue!
-        m_nRxByteCount += nActualPktSize;
-        // TODO: would be nice if even the size of pushed packets would be the actual to copy less memory
-        // or at least use emplace_back()
-        m_queuePackets.push_back(pktAsConst);
-    } // for i
+    sampleTelemetry();
+}
 
-    if (m_nRxPktCount == 0)
-    {
-        m_time1stRxPkt = std::chrono::steady_clock::now();
-    }
-    m_nRxPktCount += numGnsMsgs;
+/**
+* @return True if the network I/O thread is running, regardless of which thread is asking.
+*/
+bool PgeGnsWrapper::isIoThreadRunning() const
+{
+    return m_bIoThreadRunning;
+}
 
-    return true;
+/**
+* Debug functions accessing the connections should hold the returned lock while being invoked on the application thread,
+* so that the network I/O thread does not change the connections meanwhile.
+* 
+* @return Lock owning the mutex held by the I/O thread while it is working, or a lock owning nothing if the I/O thread is not running.
+*/
+std::unique_lock<std::mutex> PgeGnsWrapper::lockIoThread() const
+{
+    return needsHandoffToIoThread() ? std::unique_lock<std::mutex>(m_mtxIoThread) : std::unique_lock<std::mutex>();
 }
 
-void PgeGnsWrapper::pollConnectionStateChanges()
+/**
+* To be invoked on the application thread.
+* 
+* @return Latencies of handing over received packets to the application, and fill levels of the handoff queues.
+*/
+pge_network::PgeHandoffStats PgeGnsWrapper::getHandoffStats() const
 {
-    // since this is also static, we cannot set it in ctor, because both PgeGnsServer and PgeGnsClient are instantiated, and
-    // their ctor would set this same static variable ... so it won't work to set it in the ctor.
-    // For now I'm just leaving this here so it is always set by the proper instance.
-    s_pCallbackInstance = this;
-    m_pInterface->RunCallbacks(); // triggers steamNetConnectionStatusChangedCallback()
+    pge_network::PgeHandoffStats stats = m_handoffStats;
+    stats.m_bIoThread = isIoThreadRunning();
+    stats.m_nRxQueueHighWaterMark = m_queueIoThreadRx.getHighWaterMark();
+    stats.m_nRxQueueFullCount = m_queueIoThreadRx.getFullCount();
+    stats.m_nTxQueueHighWaterMark = m_queueIoThreadTx.getHighWaterMark();
+    return stats;
 }
 
 std::size_t PgeGnsWrapper::getPacketQueueSize() const
@@ -273,73 +233,111 @@ std::size_t PgeGnsWrapper::getPacketQueueSize() const
 
 pge_network::PgePacket PgeGnsWrapper::popFrontPacket() noexcept(false)
 {
-    pge_network::PgePacket pkt = m_queuePackets.front();
-    m_queuePackets.pop_front();
+    pge_network::PgePacket pkt = m_queuePackets.borrowFront();
+    m_queuePackets.releaseFront();
     return pkt;
 }
 
-std::set<pge_network::PgePktId>& PgeGnsWrapper::getAllowListedPgeMessages()
+const pge_network::PgePacket& PgeGnsWrapper::borrowFrontPacket() noexcept(false)
+{
+    return m_queuePackets.borrowFront();
+}
+
+void PgeGnsWrapper::releaseFrontPacket()
+{
+    m_queuePackets.releaseFront();
+}
+
+uint32_t PgeGnsWrapper::getPacketQueueDroppedCount() const
+{
+    return m_queuePackets.getDroppedCount();
+}
+
+std::size_t PgeGnsWrapper::getPacketQueueHighWaterMark() const
+{
+    return m_queuePackets.getHighWaterMark();
+}
+
+pge_network::PgePktIdAllowList& PgeGnsWrapper::getAllowListedPgeMessages()
 {
     return m_allowListedPgeMessages;
 }
 
-std::set<pge_network::MsgApp::TMsgId>& PgeGnsWrapper::getAllowListedAppMessages()
+pge_network::MsgAppIdAllowList& PgeGnsWrapper::getAllowListedAppMessages()
 {
     return m_allowListedAppMessages;
 }
 
 uint32_t PgeGnsWrapper::getRxPacketCount() const
 {
-    return m_nRxPktCount;
+    return needsHandoffToIoThread() ? m_statsSnapshot.m_nRxPktCount : m_nRxPktCount;
 }
 
 uint32_t PgeGnsWrapper::getTxPacketCount() const
 {
-    return m_nTxPktCount;
+    return needsHandoffToIoThread() ? m_statsSnapshot.m_nTxPktCount : m_nTxPktCount;
 }
 
 uint32_t PgeGnsWrapper::getInjectPacketCount() const
 {
-    return m_nInjectPktCount;
+    return needsHandoffToIoThread() ? m_statsSnapshot.m_nInjectPktCount : m_nInjectPktCount;
 }
 
 uint32_t PgeGnsWrapper::getRxPacketPerSecondCount() const
 {
+    const auto& time1stRxPkt = needsHandoffToIoThread() ? m_statsSnapshot.m_time1stRxPkt : m_time1stRxPkt;
     const auto nSecsSince1stRxPkt =
-        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - m_time1stRxPkt).count();
+        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - time1stRxPkt).count();
 
     return static_cast<uint32_t>(nSecsSince1stRxPkt != 0 ? (getRxPacketCount() / nSecsSince1stRxPkt) : 0);
 }
 
 uint32_t PgeGnsWrapper::getTxPacketPerSecondCount() const
 {
+    const auto& time1stTxPkt = needsHandoffToIoThread() ? m_statsSnapshot.m_time1stTxPkt : m_time1stTxPkt;
     const auto nSecsSince1stTxPkt =
-        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - m_time1stTxPkt).count();
+        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - time1stTxPkt).count();
 
     return static_cast<uint32_t>(nSecsSince1stTxPkt != 0 ? (getTxPacketCount() / nSecsSince1stTxPkt) : 0);
 }
 
 uint32_t PgeGnsWrapper::getInjectPacketPerSecondCount() const
 {
+    const auto& time1stInjectPkt = needsHandoffToIoThread() ? m_statsSnapshot.m_time1stInjectPkt : m_time1stInjectPkt;
     const auto nSecsSince1stInjectPkt =
-        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - m_time1stInjectPkt).count();
+        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - time1stInjectPkt).count();
 
     return static_cast<uint32_t>(nSecsSince1stInjectPkt != 0 ? (getInjectPacketCount() / nSecsSince1stInjectPkt) : 0);
 }
 
 const std::map<pge_network::MsgApp::TMsgId, uint32_t>& PgeGnsWrapper::getRxMsgCount() const
 {
-    return m_nRxMsgCount;
+    return getNetworkStats().getMsgAppCountMap(pge_network::PgeNetworkStats::Direction::Rx);
 }
 
 const std::map<pge_network::MsgApp::TMsgId, uint32_t>& PgeGnsWrapper::getTxMsgCount() const
 {
-    return m_nTxMsgCount;
+    return getNetworkStats().getMsgAppCountMap(pge_network::PgeNetworkStats::Direction::Tx);
 }
 
 const std::map<pge_network::MsgApp::TMsgId, uint32_t>& PgeGnsWrapper::getInjectMsgCount() const
 {
-    return m_nInjectMsgCount;
+    return getNetworkStats().getMsgAppCountMap(pge_network::PgeNetworkStats::Direction::Inject);
+}
+
+const std::map<pge_network::PgeSendLane, uint32_t>& PgeGnsWrapper::getRxLaneMsgCount() const
+{
+    return getNetworkStats().getLaneMsgCountMap(pge_network::PgeNetworkStats::Direction::Rx);
+}
+
+const std::map<pge_network::PgeSendLane, uint32_t>& PgeGnsWrapper::getTxLaneMsgCount() const
+{
+    return getNetworkStats().getLaneMsgCountMap(pge_network::PgeNetworkStats::Direction::Tx);
+}
+
+const pge_network::PgeNetworkStats& PgeGnsWrapper::getNetworkStats() const
+{
+    return needsHandoffToIoThread() ? m_statsSnapshot.m_stats : m_stats;
 }
 
 std::map<pge_network::MsgApp::TMsgId, std::string>& PgeGnsWrapper::getMsgAppId2StringMap()
@@ -347,19 +345,46 @@ std::map<pge_network::MsgApp::TMsgId, std::string>& PgeGnsWrapper::getMsgAppId2S
     return m_mapMsgAppId2String;
 }
 
+std::map<pge_network::MsgApp::TMsgId, pge_network::PgeSendLane>& PgeGnsWrapper::getMsgAppId2SendLaneMap()
+{
+    return m_mapMsgAppId2SendLane;
+}
+
+/**
+* Gets the compressor of app messages, to configure which app message ids are compressed on sending.
+* While the network I/O thread is running, it compresses and decompresses, so the statistics must be accessed while holding lockIoThread().
+* 
+* @return The compressor of app messages.
+*/
+pge_network::PgeMsgAppCompressor& PgeGnsWrapper::getMsgAppCompressor()
+{
+    return m_compressor;
+}
+
 uint32_t PgeGnsWrapper::getRxByteCount() const
 {
-    return m_nRxByteCount;
+    return needsHandoffToIoThread() ? m_statsSnapshot.m_nRxByteCount : m_nRxByteCount;
 }
 
 uint32_t PgeGnsWrapper::getTxByteCount() const
 {
-    return m_nTxByteCount;
+    return needsHandoffToIoThread() ? m_statsSnapshot.m_nTxByteCount : m_nTxByteCount;
 }
 
 uint32_t PgeGnsWrapper::getInjectByteCount() const
 {
-    return m_nInjectByteCount;
+    return needsHandoffToIoThread() ? m_statsSnapshot.m_nInjectByteCount : m_nInjectByteCount;
+}
+
+/**
+* Gets the per-connection telemetry sampled every CVAR_NET_TELEMETRY_INTERVAL_MS milliseconds.
+* While the network I/O thread is running, it samples the telemetry, so this must be invoked while holding lockIoThread().
+* 
+* @return The per-connection telemetry, copy it to take a snapshot.
+*/
+const pge_network::PgeConnectionTelemetry& PgeGnsWrapper::getConnectionTelemetry() const
+{
+    return m_telemetry;
 }
 
 
@@ -373,6 +398,73 @@ void PgeGnsWrapper::steamNetConnectionStatusChangedCallback(SteamNetConnectionSt
     s_pCallbackInstance->onSteamNetConnectionStatusChanged(pInfo);
 }
 
+/**
+* Gets the GameNetworkingSockets send flags to be used for the given send lane.
+* 
+* @param lane The send lane.
+* 
+* @return The k_nSteamNetworkingSend_* flags matching the given send lane.
+*/
+int PgeGnsWrapper::getSteamNetworkingSendFlags(const pge_network::PgeSendLane& lane)
+{
+    switch (lane)
+    {
+    case pge_network::PgeSendLane::ReliableNoNagle:
+        return k_nSteamNetworkingSend_ReliableNoNagle;
+    case pge_network::PgeSendLane::Unreliable:
+        return k_nSteamNetworkingSend_Unreliable;
+    case pge_network::PgeSendLane::UnreliableNoDelay:
+        return k_nSteamNetworkingSend_UnreliableNoDelay;
+    default:
+        return k_nSteamNetworkingSend_Reliable;
+    }
+}
+
+const char* PgeGnsWrapper::getSendLaneString(const pge_network::PgeSendLane& lane)
+{
+    switch (lane)
+    {
+    case pge_network::PgeSendLane::Reliable:
+        return "Reliable";
+    case pge_network::PgeSendLane::ReliableNoNagle:
+        return "ReliableNoNagle";
+    case pge_network::PgeSendLane::Unreliable:
+        return "Unreliable";
+    case pge_network::PgeSendLane::UnreliableNoDelay:
+        return "UnreliableNoDelay";
+    default:
+        return "Unknown";
+    }
+}
+
+/**
+* Initializes all batch packets of a connection to empty app message packets.
+* 
+* @param pktBatches The batch packets to be initialized.
+*/
+void PgeGnsWrapper::initPktBatches(SendLane2PktBatchArray& pktBatches)
+{
+    for (auto& pktBatch : pktBatches)
+    {
+        pge_network::PgePacket::initPktMsgApp(pktBatch, pge_network::ServerConnHandle, pge_network::PgePacket::AutoFill::NONE);
+    }
+}
+
+/**
+* Free callback of GNS messages sent by sendPktToConnections(), deletes the shared packet when no more GNS message refers to it.
+* GNS might invoke this on any thread.
+* 
+* @param pGnsMsg The GNS message being released, its m_nUserData stores the pointer to the SharedPkt.
+*/
+void PgeGnsWrapper::freeSharedPkt(SteamNetworkingMessage_t* pGnsMsg)
+{
+    SharedPkt* const pSharedPkt = reinterpret_cast<SharedPkt*>(static_cast<intptr_t>(pGnsMsg->m_nUserData));
+    if (pSharedPkt->m_nRefCount.fetch_sub(1) == 1)
+    {
+        delete pSharedPkt;
+    }
+}
+
 PgeGnsWrapper::PgeGnsWrapper(PGEcfgProfiles& cfgProfiles) :
     m_cfgProfiles(cfgProfiles),
     m_pInterface(nullptr),
@@ -381,7 +473,10 @@ PgeGnsWrapper::PgeGnsWrapper(PGEcfgProfiles& cfgProfiles) :
     m_nInjectPktCount(0),
     m_nRxByteCount(0),
     m_nTxByteCount(0),
-    m_nInjectByteCount(0)
+    m_nInjectByteCount(0),
+    m_bIoThreadRunning(false),
+    m_bIoThreadStopRequested(false),
+    m_bStatsPublished(false)
 {
 } // PgeGnsWrapper()
 
@@ -396,73 +491,1222 @@ PgeGnsWrapper& PgeGnsWrapper::operator=(const PgeGnsWrapper&)
     return *this;
 }
 
-std::string PgeGnsWrapper::getStringByMsgAppId(const pge_network::MsgApp::TMsgId& id) const
+/**
+* Preallocates the packet queue based on CVAR_NET_RX_QUEUE_CAPACITY.
+* Expected to be invoked before starting listening or connecting, so no allocation happens later when packets are received.
+* Capacity is raised to RX_QUEUE_MIN_CAPACITY if less, so a full received batch always fits besides the headroom for injected packets.
+* If capacity doesn't change, the already queued packets are kept.
+* 
+* @return True on success, false otherwise.
+*/
+bool PgeGnsWrapper::reservePacketQueue()
 {
-    const auto& it = m_mapMsgAppId2String.find(id);
-    if (it != m_mapMsgAppId2String.end())
+    if (m_cfgProfiles.getVars()[pge_network::PgeINetwork::CVAR_NET_RX_QUEUE_CAPACITY].getAsString().empty())
     {
-        return it->second;
+        m_cfgProfiles.getVars()[pge_network::PgeINetwork::CVAR_NET_RX_QUEUE_CAPACITY].Set(1024);
+        CConsole::getConsoleInstance("PgeGnsWrapper").OLn("%s: Missing rx queue capacity in config, defaulting to: %d!",
+            __func__, m_cfgProfiles.getVars()[pge_network::PgeINetwork::CVAR_NET_RX_QUEUE_CAPACITY].getAsInt());
     }
-    return "UNKNOWN_MSG";
-}
 
-std::string PgeGnsWrapper::getDetailedConnectionStatus(const HSteamNetConnection& connHandle) const
-{
-    if (!isInitialized() || (connHandle == k_HSteamNetConnection_Invalid))
+    const int nCapacity = m_cfgProfiles.getVars()[pge_network::PgeINetwork::CVAR_NET_RX_QUEUE_CAPACITY].getAsInt();
+    if ((nCapacity <= 0) || (static_cast<std::size_t>(nCapacity) > pge_network::PgePacketRing::nMaxCapacity))
     {
-        CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s not connected or invalid connHandle: %u!", __func__, connHandle);
-        assert(false);
-        return "";
+        CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: failed to reserve rx queue with capacity %d, valid range is [1, %u]!",
+            __func__, nCapacity, pge_network::PgePacketRing::nMaxCapacity);
+        return false;
     }
 
-    char szDetailedStatus[4096];
-    const int nRes = m_pInterface->GetDetailedConnectionStatus(connHandle, szDetailedStatus, sizeof(szDetailedStatus));
-    if (nRes == 0)
+    if (static_cast<std::size_t>(nCapacity) < RX_QUEUE_MIN_CAPACITY)
     {
-        // only in this case szDetailedStatus is null-terminated and perfect!
-        return std::string(szDetailedStatus);
-        //const std::string sDetailedStatusWithUnixNewlines(szDetailedStatus);
-        //const size_t nNewlineCount = std::count(sDetailedStatusWithUnixNewlines.cbegin(), sDetailedStatusWithUnixNewlines.cend(), '\n');
-        //std::string sDetailedStatusWithWindowsNewlines;
-        //sDetailedStatusWithWindowsNewlines.reserve(sDetailedStatusWithUnixNewlines.size() + nNewlineCount);
-        //for (const auto& c : sDetailedStatusWithUnixNewlines)
-        //{
-        //    sDetailedStatusWithWindowsNewlines += c;
-        //    if (c == '\n')
-        //    {
-        //        sDetailedStatusWithWindowsNewlines += '\r';
-        //    }
-        //}
-        //return sDetailedStatusWithWindowsNewlines;
+        CConsole::getConsoleInstance("PgeGnsWrapper").OLn("%s: rx queue capacity %d is too low, raising to: %u!",
+            __func__, nCapacity, RX_QUEUE_MIN_CAPACITY);
     }
-    else
+
+    if (!m_queuePackets.reserve(std::max(static_cast<std::size_t>(nCapacity), RX_QUEUE_MIN_CAPACITY)))
     {
-        CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s GetDetailedConnectionStatus() returned %d!", __func__, nRes);
-        return "";
+        CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: failed to reserve rx queue with capacity %d!", __func__, nCapacity);
+        return false;
     }
+
+    CConsole::getConsoleInstance("PgeGnsWrapper").OLn("%s: rx queue capacity: %u", __func__, m_queuePackets.capacity());
+    return true;
 }
 
-void PgeGnsWrapper::logDetailedConnectionStatus(const HSteamNetConnection& connHandle) const
+/**
+* Starts capturing all sent, received and injected packets to the file specified by CVAR_NET_CAPTURE_FILE.
+* Expected to be invoked before starting listening or connecting, right after reservePacketQueue().
+* Does nothing if the CVAR is empty or capturing is already running, e.g. when reconnecting, the same capture is continued.
+* 
+* @return False if the capture file cannot be created, true otherwise.
+*/
+bool PgeGnsWrapper::startPacketCapture()
 {
-    CConsole::getConsoleInstance("PgeGnsWrapper").OLn("Detailed Connection Status for connHandle %u: ", connHandle);
+    const std::string sCaptureFilename = m_cfgProfiles.getVars()[pge_network::PgeINetwork::CVAR_NET_CAPTURE_FILE].getAsString();
+    if (sCaptureFilename.empty() || m_capture.isOpen())
+    {
+        return true;
+    }
 
-    if (connHandle == k_HSteamNetConnection_Invalid)
+    return m_capture.open(sCaptureFilename);
+}
+
+/**
+* Enables sampling the status of all connections based on CVAR_NET_TELEMETRY_INTERVAL_MS and CVAR_NET_TELEMETRY_CAPACITY.
+* Expected to be invoked before starting listening or connecting, right after startPacketCapture(), so the sample buffers are
+* allocated before the match starts.
+* If capacity doesn't change, the already stored samples are kept, e.g. when reconnecting, the same telemetry is continued.
+* 
+* @return True on success or if telemetry is disabled, false if the capacity is invalid.
+*/
+bool PgeGnsWrapper::startTelemetry()
+{
+    const int nIntervalMillisecs = m_cfgProfiles.getVars()[pge_network::PgeINetwork::CVAR_NET_TELEMETRY_INTERVAL_MS].getAsInt();
+    if (nIntervalMillisecs <= 0)
     {
-        CConsole::getConsoleInstance("PgeGnsWrapper").OLn("  Returning immediately, this is invalid handle (for server it is itself)!");
-        return;
+        m_telemetry.setSampleInterval(std::chrono::milliseconds(0));
+        return true;
     }
 
-    // we need this line-by-line logging otherwise no paragraph breaks will be inserted into the html at each newline;
-    // note that this could be a feature of the logger lib in the future.
-    std::stringstream ssDetailedConnStatus(getDetailedConnectionStatus(connHandle));
-    while (ssDetailedConnStatus)
+    if (m_cfgProfiles.getVars()[pge_network::PgeINetwork::CVAR_NET_TELEMETRY_CAPACITY].getAsString().empty())
     {
-        std::string sLine;
-        std::getline(ssDetailedConnStatus, sLine);
-        CConsole::getConsoleInstance("PgeGnsWrapper").OLn("%s", sLine.c_str());
+        m_cfgProfiles.getVars()[pge_network::PgeINetwork::CVAR_NET_TELEMETRY_CAPACITY].Set(600);
+        CConsole::getConsoleInstance("PgeGnsWrapper").OLn("%s: Missing telemetry capacity in config, defaulting to: %d!",
+            __func__, m_cfgProfiles.getVars()[pge_network::PgeINetwork::CVAR_NET_TELEMETRY_CAPACITY].getAsInt());
     }
-    CConsole::getConsoleInstance("PgeGnsWrapper").OLn("");
+
+    const int nCapacity = m_cfgProfiles.getVars()[pge_network::PgeINetwork::CVAR_NET_TELEMETRY_CAPACITY].getAsInt();
+    if ((nCapacity <= 0) || !m_telemetry.reserve(static_cast<std::size_t>(nCapacity)))
+    {
+        CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: failed to reserve telemetry with capacity %d, valid range is [1, %u]!",
+            __func__, nCapacity, pge_network::PgeConnectionTelemetry::nMaxCapacity);
+        return false;
+    }
+
+    m_telemetry.setSampleInterval(std::chrono::milliseconds(nIntervalMillisecs));
+    m_vTelemetryConns.reserve(pge_network::PgeConnectionTelemetry::nMaxConnectionCount);
+
+    CConsole::getConsoleInstance("PgeGnsWrapper").OLn("%s: telemetry interval: %d ms, capacity: %u",
+        __func__, nIntervalMillisecs, m_telemetry.capacity());
+    return true;
 }
 
+/**
+* Stores the given packet in the packet queue, so app level will receive it as it was received from network.
+* This is how we inject PGE messages to ourselves.
+* Injected packets are never dropped: received packets never fill the last RX_QUEUE_INJECT_HEADROOM slots of the packet queue, and
+* if even those are used up, the packet waits in the overflow queue, see storeInjectedPkt().
+* The packet is also captured if packet capture is running.
+* If invoked on the application thread while the network I/O thread is running, the packet is directly stored in the packet queue
+* so app level receives it in the same frame as without the I/O thread, and capturing is handed over to the I/O thread.
+* 
+* @param pkt The packet to be stored.
+*/
+void PgeGnsWrapper::enqueuePkt(const pge_network::PgePacket& pkt)
+{
+    if (needsHandoffToIoThread())
+    {
+        storeInjectedPkt(pkt);
 
-// ############################### PRIVATE ###############################
+        // if the command is dropped, the packet is still injected, just not captured and counted
+        TxCmd* const pCmd = beginTxCmd(TxCmd::Type::Inject);
+        if (pCmd)
+        {
+            pCmd->m_pkt = pkt;
+            endTxCmd(*pCmd);
+        }
+        return;
+    }
+
+    captureInjectedPkt(pkt);
+    if (!isIoThreadRunning())
+    {
+        storeInjectedPkt(pkt);
+        return;
+    }
+
+    // on the I/O thread, timestamp is needed only for the handoff latency
+    const SteamNetworkingMicroseconds usecNow = SteamNetworkingUtils()->GetLocalTimestamp();
+    pge_network::PgePacket* const pPktSlot = m_queueIoThreadRxOverflow.empty() ? beginPushBackRxPkt(0, usecNow) : nullptr;
+    if (pPktSlot)
+    {
+        *pPktSlot = pkt;
+        endPushBackRxPkt(0, usecNow);
+        return;
+    }
+
+    // allocates, however this happens only if app level doesn't consume the packet queue for long
+    m_queueIoThreadRxOverflow.push_back(RxHandoffPkt{ pkt, 0, usecNow });
+}
+
+/**
+* Stores the given injected packet in the packet queue, or in the overflow queue if the packet queue is full or the overflow queue is
+* not empty, so injected packets are never dropped and keep their order.
+* Packets in the overflow queue are moved to the packet queue by moveOverflowPktsToPacketQueue() before anything else is received.
+* To be invoked only on the application thread.
+* 
+* @param pkt The injected packet.
+*/
+void PgeGnsWrapper::storeInjectedPkt(const pge_network::PgePacket& pkt)
+{
+    if (m_queuePktsOverflow.empty() && !m_queuePackets.full())
+    {
+        m_queuePackets.pushBack(pkt);
+        return;
+    }
+
+    // allocates, however this happens only if app level doesn't consume the packet queue for long
+    m_queuePktsOverflow.push_back(pkt);
+}
+
+/**
+* Moves as many packets from the overflow queue to the packet queue as fit.
+* To be invoked only on the application thread.
+*/
+void PgeGnsWrapper::moveOverflowPktsToPacketQueue()
+{
+    while (!m_queuePktsOverflow.empty() && !m_queuePackets.full())
+    {
+        m_queuePackets.pushBack(m_queuePktsOverflow.front());
+        m_queuePktsOverflow.pop_front();
+    }
+}
+
+/**
+* Captures the given injected packet if packet capture is running.
+* 
+* @param pkt The injected packet.
+*/
+void PgeGnsWrapper::captureInjectedPkt(const pge_network::PgePacket& pkt)
+{
+    if (m_capture.isOpen())
+    {
+        m_capture.record(
+            pge_network::PgeNetworkStats::Direction::Inject,
+            pge_network::PgePacket::getServerSideConnectionHandle(pkt),
+            pkt,
+            pge_network::PgePacket::getPktActualSizeBytes(pkt),
+            std::chrono::steady_clock::now());
+    }
+}
+
+/**
+* Starts the network I/O thread if CVAR_NET_IO_THREAD is set.
+* Expected to be invoked by the derived class on the application thread, right after it started listening or connecting.
+* If the thread cannot be started, everything keeps running on the application thread.
+*/
+void PgeGnsWrapper::startIoThread()
+{
+    if (isIoThreadRunning() || !m_cfgProfiles.getVars()[pge_network::PgeINetwork::CVAR_NET_IO_THREAD].getAsBool())
+    {
+        return;
+    }
+
+    if (!m_queueIoThreadRx.reserve(m_queuePackets.capacity()) || !m_queueIoThreadTx.reserve(m_queuePackets.capacity()))
+    {
+        CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: failed to reserve handoff queues, staying on application thread!", __func__);
+        return;
+    }
+    m_queueIoThreadRx.resetCounters();
+    m_queueIoThreadTx.resetCounters();
+    m_handoffStats = pge_network::PgeHandoffStats();
+
+    // statistics getters read the snapshot from now on
+    takeStatsSnapshot(m_statsSnapshot);
+    m_bStatsPublished = false;
+    m_timeStatsPublished = std::chrono::steady_clock::now();
+
+    m_bIoThreadStopRequested = false;
+    m_bIoThreadRunning = true;
+    try
+    {
+        // I/O thread does everything under this lock, so it sees m_ioThread only after it is assigned here
+        std::lock_guard<std::mutex> lock(m_mtxIoThread);
+        m_ioThread = std::thread(&PgeGnsWrapper::runIoThread, this);
+    }
+    catch (const std::system_error& e)
+    {
+        m_bIoThreadRunning = false;
+        CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: failed to start I/O thread: %s, staying on application thread!", __func__, e.what());
+        return;
+    }
+
+    CConsole::getConsoleInstance("PgeGnsWrapper").OLn("%s: I/O thread started, handoff queue capacity: %u",
+        __func__, m_queueIoThreadRx.capacity());
+}
+
+/**
+* Stops the network I/O thread if it is running.
+* Commands already handed over to the I/O thread are executed, and packets received by it are moved to the packet queue before return.
+* Expected to be invoked by the derived class on the application thread, before it stops listening or disconnects.
+*/
+void PgeGnsWrapper::stopIoThread()
+{
+    if (!isIoThreadRunning())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lockWakeup(m_mtxIoThreadWakeup);
+        m_bIoThreadStopRequested = true;
+    }
+    m_cvIoThreadWakeup.notify_one();
+    m_ioThread.join();
+    m_bIoThreadRunning = false;
+
+    handOverIoThreadRxPkts();
+
+    // whatever did not fit into the packet queue waits in the overflow queue in the same order, nothing received is dropped
+    const RxHandoffPkt* pHandoffPkt;
+    while ((pHandoffPkt = m_queueIoThreadRx.front()) != nullptr)
+    {
+        m_queuePktsOverflow.push_back(pHandoffPkt->m_pkt);
+        m_queueIoThreadRx.popFront();
+    }
+    for (const auto& handoffPkt : m_queueIoThreadRxOverflow)
+    {
+        m_queuePktsOverflow.push_back(handoffPkt.m_pkt);
+    }
+    m_queueIoThreadRxOverflow.clear();
+
+    const pge_network::PgeHandoffStats stats = getHandoffStats();
+    CConsole::getConsoleInstance("PgeGnsWrapper").OLn(
+        "%s: I/O thread stopped, rx latency avg/max: %u/%u us, handoff latency avg/max: %u/%u us, rx queue hwm/full: %u/%u, tx queue hwm/full/dropped: %u/%u/%u",
+        __func__,
+        static_cast<uint32_t>(stats.m_rxLatency.getAvgUSecs()), static_cast<uint32_t>(stats.m_rxLatency.m_nMaxUSecs),
+        static_cast<uint32_t>(stats.m_handoffLatency.getAvgUSecs()), static_cast<uint32_t>(stats.m_handoffLatency.m_nMaxUSecs),
+        static_cast<uint32_t>(stats.m_nRxQueueHighWaterMark), stats.m_nRxQueueFullCount,
+        static_cast<uint32_t>(stats.m_nTxQueueHighWaterMark), stats.m_nTxQueueFullCount, stats.m_nTxCmdDroppedCount);
+}
+
+/**
+* @return True if invoked on the application thread while the network I/O thread is running, in which case the work needs to be
+*         handed over to the I/O thread. False if invoked on the I/O thread, or if the I/O thread is not running.
+*/
+bool PgeGnsWrapper::needsHandoffToIoThread() const
+{
+    return m_bIoThreadRunning && (std::this_thread::get_id() != m_ioThread.get_id());
+}
+
+/**
+* Gets the back slot of the tx handoff queue to be filled by the application thread.
+* If the queue is full, waits for the I/O thread to make room, but at most for IO_THREAD_TX_HANDOFF_TIMEOUT, so a stuck I/O thread
+* cannot block the application thread.
+* Must be followed by endTxCmd() if the command is returned.
+* 
+* @param type The type of the command.
+* 
+* @return The command to be filled, or nullptr if the queue stayed full, in which case the command is dropped and counted.
+*/
+PgeGnsWrapper::TxCmd* PgeGnsWrapper::beginTxCmd(const TxCmd::Type& type)
+{
+    TxCmd* pCmd = m_queueIoThreadTx.beginPushBack();
+    if (!pCmd)
+    {
+        // the I/O thread normally makes room soon
+        m_handoffStats.m_nTxQueueFullCount++;
+        m_cvIoThreadWakeup.notify_one();
+        const auto timeGiveUp = std::chrono::steady_clock::now() + IO_THREAD_TX_HANDOFF_TIMEOUT;
+        while (!pCmd && (std::chrono::steady_clock::now() < timeGiveUp))
+        {
+            std::this_thread::sleep_for(IO_THREAD_TX_HANDOFF_RETRY_INTERVAL);
+            pCmd = m_queueIoThreadTx.beginPushBack();
+        }
+
+        if (!pCmd)
+        {
+            m_handoffStats.m_nTxCmdDroppedCount++;
+            CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: tx handoff queue full for %d ms, dropped command %u!",
+                __func__, static_cast<int>(IO_THREAD_TX_HANDOFF_TIMEOUT.count()), static_cast<uint32_t>(type));
+            return nullptr;
+        }
+    }
+
+    pCmd->m_type = type;
+    return pCmd;
+}
+
+/**
+* Hands over the command filled after beginTxCmd() to the I/O thread.
+* Flush commands also wake up the I/O thread, since those are typically the last commands of a frame.
+* 
+* @param cmd The command returned by beginTxCmd().
+*/
+void PgeGnsWrapper::endTxCmd(const TxCmd& cmd)
+{
+    const bool bFlush = (cmd.m_type == TxCmd::Type::Flush);
+    m_queueIoThreadTx.endPushBack();
+    if (bFlush)
+    {
+        m_cvIoThreadWakeup.notify_one();
+    }
+}
+
+/**
+* Gets the send lane configured for the given app message id.
+* 
+* @param id The app message id.
+* 
+* @return The send lane configured in m_mapMsgAppId2SendLane, or PgeSendLane::Reliable if not configured.
+*/
+pge_network::PgeSendLane PgeGnsWrapper::getSendLaneByMsgAppId(const pge_network::MsgApp::TMsgId& id) const
+{
+    const auto it = m_mapMsgAppId2SendLane.find(id);
+    return (it == m_mapMsgAppId2SendLane.end()) ? pge_network::PgeSendLane::Reliable : it->second;
+}
+
+/**
+* Sends the given packet to the given connection immediately, without batching.
+* App messages are compressed as configured in m_compressor, and only the actually used memory area of the packet is sent.
+* Updates the tx statistics.
+* 
+* @param conn The connection to send the given packet to.
+* @param pkt  The packet to be sent.
+* @param lane The send lane defining the send semantics of the packet. Should be PgeSendLane::Reliable for non-app packets.
+*/
+void PgeGnsWrapper::sendPkt(const HSteamNetConnection& conn, const pge_network::PgePacket& pkt, const pge_network::PgeSendLane& lane)
+{
+    pge_network::PgePacket pktCompressed;
+    const pge_network::PgePacket& pktToSend = m_compressor.compressPkt(pkt, pktCompressed) ? pktCompressed : pkt;
+    const uint32_t nActualPktSize = pge_network::PgePacket::getPktActualSizeBytes(pktToSend);
+
+    m_pInterface->SendMessageToConnection(conn, &pktToSend, nActualPktSize, getSteamNetworkingSendFlags(lane), nullptr);
+    updateTxStats(conn, pktToSend, nActualPktSize, lane, std::chrono::steady_clock::now());
+}
+
+/**
+* Sends the given packet to all the given connections immediately, without batching.
+* App messages are compressed only once for all connections, as configured in m_compressor.
+* The actually used memory area of the packet is copied only once into a reference-counted buffer shared by all
+* the GNS messages, and all GNS messages are passed to GNS in a single call.
+* Updates the tx statistics for each connection.
+* 
+* @param vConns The connections to send the given packet to.
+* @param pkt    The packet to be sent.
+* @param lane   The send lane defining the send semantics of the packet. Should be PgeSendLane::Reliable for non-app packets.
+*/
+void PgeGnsWrapper::sendPktToConnections(
+    const std::vector<HSteamNetConnection>& vConns,
+    const pge_network::PgePacket& pkt,
+    const pge_network::PgeSendLane& lane)
+{
+    if (vConns.size() <= 1)
+    {
+        // GNS copies the packet anyway, not worth allocating a shared buffer
+        if (!vConns.empty())
+        {
+            sendPkt(vConns[0], pkt, lane);
+        }
+        return;
+    }
+
+    pge_network::PgePacket pktCompressed;
+    const pge_network::PgePacket& pktToSend = m_compressor.compressPkt(pkt, pktCompressed) ? pktCompressed : pkt;
+    const uint32_t nActualPktSize = pge_network::PgePacket::getPktActualSizeBytes(pktToSend);
+    SharedPkt* const pSharedPkt = new SharedPkt;
+    pSharedPkt->m_nRefCount = static_cast<uint32_t>(vConns.size());
+    memcpy(&(pSharedPkt->m_pkt), &pktToSend, nActualPktSize);
+
+    const int nSendFlags = getSteamNetworkingSendFlags(lane);
+    m_vTxGnsMsgs.clear();
+    for (const auto& conn : vConns)
+    {
+        SteamNetworkingMessage_t* const pGnsMsg = SteamNetworkingUtils()->AllocateMessage(0);
+        pGnsMsg->m_pData = &(pSharedPkt->m_pkt);
+        pGnsMsg->m_cbSize = nActualPktSize;
+        pGnsMsg->m_pfnFreeData = freeSharedPkt;
+        pGnsMsg->m_nUserData = static_cast<int64>(reinterpret_cast<intptr_t>(pSharedPkt));
+        pGnsMsg->m_conn = conn;
+        pGnsMsg->m_nFlags = nSendFlags;
+        m_vTxGnsMsgs.push_back(pGnsMsg);
+    }
+
+    // GNS takes ownership of the messages even if sending fails, so pSharedPkt must not be touched after this
+    m_pInterface->SendMessages(static_cast<int>(m_vTxGnsMsgs.size()), m_vTxGnsMsgs.data(), nullptr);
+
+    const pge_network::PgeNetworkStats::TimePoint timeTx = std::chrono::steady_clock::now();
+    for (const auto& conn : vConns)
+    {
+        updateTxStats(conn, pktToSend, nActualPktSize, lane, timeTx);
+    }
+}
+
+/**
+* Batches the app message(s) of the given packet into the batch packets belonging to the given connection.
+* Each app message goes into the batch packet of its send lane, as configured in m_mapMsgAppId2SendLane.
+* Batch packets are sent out only by flushBatchPkts(), or when they cannot store more app messages.
+* This way multiple app messages sent within the same frame will be sent in as few packets as possible, resulting in
+* less GNS per-message overhead.
+* 
+* A batch packet is also sent out before storing app messages with different server-side connection handle, and all batch packets
+* are sent out before sending a non-app packet, since non-app packets are always sent immediately.
+* This way the original order of messages is kept within the same send lane.
+* 
+* @param conn       The connection to which the batch packets belong.
+* @param pktBatches The batch packets of the given connection, initialized by initPktBatches().
+* @param pkt        The packet to be batched.
+*/
+void PgeGnsWrapper::batchPkt(const HSteamNetConnection& conn, SendLane2PktBatchArray& pktBatches, const pge_network::PgePacket& pkt)
+{
+    if (pge_network::PgePacket::getPacketId(pkt) != pge_network::PgePktId::Application)
+    {
+        flushBatchPkts(conn, pktBatches);
+        sendPkt(conn, pkt, pge_network::PgeSendLane::Reliable);
+        return;
+    }
+
+    const pge_network::MsgApp* pMsgApp = pge_network::PgePacket::getMsgAppFromPkt(pkt);
+    const uint8_t nMessageCount = pge_network::PgePacket::getMessageAppCount(pkt);
+    for (uint8_t i = 0; (i < nMessageCount) && pMsgApp; i++)
+    {
+        const pge_network::PgeSendLane lane = getSendLaneByMsgAppId(pge_network::MsgApp::getMsgAppMsgId(*pMsgApp));
+        pge_network::PgePacket& pktBatch = pktBatches[static_cast<size_t>(lane)];
+
+        if (pge_network::PgePacket::getServerSideConnectionHandle(pkt) != pge_network::PgePacket::getServerSideConnectionHandle(pktBatch))
+        {
+            // connection handle is per-packet, so we cannot mix app messages with different connection handle in the same packet
+            const pge_network::PgePacket& pktBatchAsConst = pktBatch;  // non-const getMessageAppCount() is private
+            if (pge_network::PgePacket::getMessageAppCount(pktBatchAsConst) > 0)
+            {
+                sendPkt(conn, pktBatch, lane);
+                pge_network::PgePacket::initPktMsgApp(pktBatch, pge_network::ServerConnHandle, pge_network::PgePacket::AutoFill::NONE);
+            }
+            pge_network::PgePacket::getServerSideConnectionHandle(pktBatch) = pge_network::PgePacket::getServerSideConnectionHandle(pkt);
+        }
+
+        if (!pge_network::PgePacket::addPktMsgApp(pktBatch, *pMsgApp))
+        {
+            // not enough space in the batch packet, send it out and retry with an empty batch packet
+            sendPkt(conn, pktBatch, lane);
+            pge_network::PgePacket::initPktMsgApp(
+                pktBatch,
+                pge_network::PgePacket::getServerSideConnectionHandle(pkt),
+                pge_network::PgePacket::AutoFill::NONE);
+            if (!pge_network::PgePacket::addPktMsgApp(pktBatch, *pMsgApp))
+            {
+                CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: failed to batch app message %u to connection %u!",
+                    __func__, pge_network::MsgApp::getMsgAppMsgId(*pMsgApp), conn);
+                assert(false);
+            }
+        }
+        pMsgApp = pge_network::PgePacket::getNextMsgAppFromPkt(pkt, *pMsgApp);
+    }
+}
+
+/**
+* Sends out the batch packet of the given send lane to the given connection if it stores any app message, and empties the batch packet.
+* 
+* @param conn       The connection to which the batch packets belong.
+* @param pktBatches The batch packets of the given connection, initialized by initPktBatches().
+* @param lane       The send lane of the batch packet to be sent out.
+*/
+void PgeGnsWrapper::flushBatchPkt(const HSteamNetConnection& conn, SendLane2PktBatchArray& pktBatches, const pge_network::PgeSendLane& lane)
+{
+    pge_network::PgePacket& pktBatch = pktBatches[static_cast<size_t>(lane)];
+    const pge_network::PgePacket& pktBatchAsConst = pktBatch;  // non-const getMessageAppCount() is private
+    if (pge_network::PgePacket::getMessageAppCount(pktBatchAsConst) == 0)
+    {
+        return;
+    }
+
+    sendPkt(conn, pktBatch, lane);
+    pge_network::PgePacket::initPktMsgApp(
+        pktBatch,
+        pge_network::PgePacket::getServerSideConnectionHandle(pktBatch),
+        pge_network::PgePacket::AutoFill::NONE);
+}
+
+/**
+* Sends out the given batch packets to the given connection if they store any app message, and empties the batch packets.
+* Each batch packet is sent with the send flags of its own send lane.
+* 
+* @param conn       The connection to which the batch packets belong.
+* @param pktBatches The batch packets of the given connection, initialized by initPktBatches().
+*/
+void PgeGnsWrapper::flushBatchPkts(const HSteamNetConnection& conn, SendLane2PktBatchArray& pktBatches)
+{
+    for (size_t iLane = 0; iLane < pktBatches.size(); iLane++)
+    {
+        flushBatchPkt(conn, pktBatches, static_cast<pge_network::PgeSendLane>(iLane));
+    }
+}
+
+std::string PgeGnsWrapper::getStringByMsgAppId(const pge_network::MsgApp::TMsgId& id) const
+{
+    const auto& it = m_mapMsgAppId2String.find(id);
+    if (it != m_mapMsgAppId2String.end())
+    {
+        return it->second;
+    }
+    return "UNKNOWN_MSG";
+}
+
+void PgeGnsWrapper::logMsgAppStats(const pge_network::PgeNetworkStats::Direction& dir, const char* szTitle) const
+{
+    CConsole::getConsoleInstance("PgeGnsWrapper").OLn("");
+    CConsole::getConsoleInstance("PgeGnsWrapper").OLnOI("%s", szTitle);
+    for (const auto& msgCount : m_stats.getMsgAppCountMap(dir))
+    {
+        CConsole::getConsoleInstance("PgeGnsWrapper").OLn("Id %u %s: %u", msgCount.first, getStringByMsgAppId(msgCount.first).c_str(), msgCount.second);
+    }
+    CConsole::getConsoleInstance("PgeGnsWrapper").OO();
+}
+
+std::string PgeGnsWrapper::getDetailedConnectionStatus(const HSteamNetConnection& connHandle) const
+{
+    if (!isInitialized() || (connHandle == k_HSteamNetConnection_Invalid))
+    {
+        CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s not connected or invalid connHandle: %u!", __func__, connHandle);
+        assert(false);
+        return "";
+    }
+
+    char szDetailedStatus[4096];
+    const int nRes = m_pInterface->GetDetailedConnectionStatus(connHandle, szDetailedStatus, sizeof(szDetailedStatus));
+    if (nRes == 0)
+    {
+        // only in this case szDetailedStatus is null-terminated and perfect!
+        return std::string(szDetailedStatus);
+        //const std::string sDetailedStatusWithUnixNewlines(szDetailedStatus);
+        //const size_t nNewlineCount = std::count(sDetailedStatusWithUnixNewlines.cbegin(), sDetailedStatusWithUnixNewlines.cend(), '\n');
+        //std::string sDetailedStatusWithWindowsNewlines;
+        //sDetailedStatusWithWindowsNewlines.reserve(sDetailedStatusWithUnixNewlines.size() + nNewlineCount);
+        //for (const auto& c : sDetailedStatusWithUnixNewlines)
+        //{
+        //    sDetailedStatusWithWindowsNewlines += c;
+        //    if (c == '\n')
+        //    {
+        //        sDetailedStatusWithWindowsNewlines += '\r';
+        //    }
+        //}
+        //return sDetailedStatusWithWindowsNewlines;
+    }
+    else
+    {
+        CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s GetDetailedConnectionStatus() returned %d!", __func__, nRes);
+        return "";
+    }
+}
+
+void PgeGnsWrapper::logDetailedConnectionStatus(const HSteamNetConnection& connHandle) const
+{
+    CConsole::getConsoleInstance("PgeGnsWrapper").OLn("Detailed Connection Status for connHandle %u: ", connHandle);
+
+    if (connHandle == k_HSteamNetConnection_Invalid)
+    {
+        CConsole::getConsoleInstance("PgeGnsWrapper").OLn("  Returning immediately, this is invalid handle (for server it is itself)!");
+        return;
+    }
+
+    // we need this line-by-line logging otherwise no paragraph breaks will be inserted into the html at each newline;
+    // note that this could be a feature of the logger lib in the future.
+    std::stringstream ssDetailedConnStatus(getDetailedConnectionStatus(connHandle));
+    while (ssDetailedConnStatus)
+    {
+        std::string sLine;
+        std::getline(ssDetailedConnStatus, sLine);
+        CConsole::getConsoleInstance("PgeGnsWrapper").OLn("%s", sLine.c_str());
+    }
+    CConsole::getConsoleInstance("PgeGnsWrapper").OLn("");
+}
+
+
+// ############################### PRIVATE ###############################
+
+
+/**
+* Moves incoming SteamNetworkingMessages from GameNetworkingSockets layer to the packet queue as PgePackets, or to the rx handoff queue
+* if invoked on the network I/O thread.
+* 
+* @return True if messages were received, false on error or if there was nothing to receive.
+*/
+bool PgeGnsWrapper::receiveIncomingMessages()
+{
+    static const int nIncomingMsgArraySize = 10;
+    ISteamNetworkingMessage* pIncomingGnsMsg[nIncomingMsgArraySize];
+
+    if (!isInitialized())
+    {
+        CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s not initialized!", __func__);
+        return false;
+    }
+
+    if (!isIoThreadRunning())
+    {
+        moveOverflowPktsToPacketQueue();
+    }
+
+    // Backpressure: we take from GNS only as many messages as we can surely store even if all of them are unpacked into the max number
+    // of pkts, the rest stays queued in GNS until app level makes room. We must not drop a message after taking it from GNS, since for a
+    // reliable message that would be a loss that GNS already acknowledged to the sender.
+    const int nGnsMsgsMax = static_cast<int>(
+        std::min(static_cast<std::size_t>(nIncomingMsgArraySize), getFreeRxPktSlotCount() / RX_MAX_UNPACKED_PKTS_PER_GNS_MSG));
+    if (nGnsMsgsMax == 0)
+    {
+        return false;
+    }
+
+    // numGnsMsgs is actually the number of received PgePackets, however GNS talks about SteamNetworkingMessage,
+    // but PGE puts a PgePacket into such message, and a PgePacket can contain multiple MsgApps, so pls don't
+    // mix the MsgApps with SteamNetworkingMessages, they are not the same messages.
+    const int numGnsMsgs = receiveMessages(pIncomingGnsMsg, nGnsMsgsMax);
+    if (numGnsMsgs == 0)
+    {
+        return false;
+    }
+
+    if (numGnsMsgs < 0)
+    {
+        // This case falling here would be normal when GNS instance is not connected, actually sometimes
+        // we do disconnect on purpose in different cases other than exiting the application.
+        // However, we still log this as error and expect the caller NOT invoke us when they know we are not connected.
+        CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: Error checking for messages!", __func__);
+        return false;
+    }
+
+    if (!pIncomingGnsMsg)
+    {
+        CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: pIncomingGnsMsg null!", __func__);
+        return false;
+    }
+
+    // 1 timestamp for all received messages is precise enough for stats, and saves us from querying the clock per message
+    const pge_network::PgeNetworkStats::TimePoint timeRx = std::chrono::steady_clock::now();
+    const SteamNetworkingMicroseconds usecNow = SteamNetworkingUtils()->GetLocalTimestamp();
+
+    for (int i = 0; i < numGnsMsgs; i++)
+    {
+        if (!validateSteamNetworkingMessage(pIncomingGnsMsg[i]->m_conn))
+        {
+            continue;
+        }
+
+        // PgePacket is a fixed-size memory area, during sending we truncate it to actual size, which is this size:
+        const int nActualPktSize = (pIncomingGnsMsg[i])->m_cbSize;
+        const SteamNetworkingMicroseconds usecTimeReceived = (pIncomingGnsMsg[i])->m_usecTimeReceived;
+
+        // We receive directly into the back slot of our packet queue so we don't need to copy again when we decide to keep the pkt.
+        // If we decide not to keep it, we simply don't commit the slot by endPushBack().
+        // Due to backpressure above the queue cannot be full here, still we need to receive into somewhere if that ever happens.
+        pge_network::PgePacket* const pPktSlot = beginPushBackRxPkt(usecTimeReceived, usecNow);
+        pge_network::PgePacket pktOverflow;
+        pge_network::PgePacket& pkt = pPktSlot ? *pPktSlot : pktOverflow;
+        assert(nActualPktSize <= sizeof(pkt));
+        assert(nActualPktSize > 0);
+        
+        memcpy(&pkt, (pIncomingGnsMsg[i])->m_pData, nActualPktSize);
+        updateIncomingPgePacket(pkt, pIncomingGnsMsg[i]->m_conn);
+        m_stats.addPkt(pge_network::PgeNetworkStats::Direction::Rx, pIncomingGnsMsg[i]->m_conn, static_cast<uint32_t>(nActualPktSize), timeRx);
+        m_capture.record(pge_network::PgeNetworkStats::Direction::Rx, pIncomingGnsMsg[i]->m_conn, pkt, static_cast<uint32_t>(nActualPktSize), timeRx);
+
+        // We don't need this anymore.
+        // Note that we could even push pIncomingGnsMsg to a queue, and process it later, and
+        // release it later, that could be a good speed optimization.
+        (pIncomingGnsMsg[i])->Release();
+
+        const pge_network::PgePacket& pktAsConst = pkt;  // from now on we use this const version
+
+        if (pge_network::PgePacket::getPacketId(pktAsConst) == pge_network::PgePktId::Application)
+        {
+            const uint8_t nMessageCount = pge_network::PgePacket::getMessageAppCount(pktAsConst);
+            if (nMessageCount == 0)
+            {
+                CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: app message pkt with msg count 0 from connection %u!",
+                    __func__, pge_network::PgePacket::getServerSideConnectionHandle(pktAsConst));
+                assert(false);
+                continue;
+            }
+
+            if (pge_network::PgePacket::getPktActualSizeBytes(pktAsConst) != static_cast<uint32_t>(nActualPktSize))
+            {
+                CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: app message pkt with invalid size %d from connection %u!",
+                    __func__, nActualPktSize, pge_network::PgePacket::getServerSideConnectionHandle(pktAsConst));
+                assert(false);
+                continue;
+            }
+
+            // Sender might have batched multiple app messages into this pkt (see batchPkt()), however application level
+            // expects exactly 1 app message per pkt in onPacketReceived(), so here we unpack them into separate pkts.
+            // Compressed app messages are also unpacked, since they are decompressed into separate pkts.
+            // Since unpacked pkts are written into the queue, starting from the same slot we received into, we need to
+            // unpack from a copy.
+            const bool bUnpack = (nMessageCount > 1) || pge_network::PgeMsgAppCompressor::hasCompressedMsgApp(pktAsConst);
+            pge_network::PgePacket pktBatched;
+            if (bUnpack)
+            {
+                pktBatched = pktAsConst;
+            }
+            const pge_network::PgePacket& pktSrc = bUnpack ? pktBatched : pktAsConst;
+
+            const pge_network::MsgApp* pMsgApp = pge_network::PgePacket::getMsgAppFromPkt(pktSrc);
+            assert(pMsgApp);  // never null since it points into pkt
+            pge_network::MsgApp msgAppDecompressed;
+            
+            uint8_t iAppMsg = 0;
+            for (; (iAppMsg < nMessageCount) && pMsgApp; iAppMsg++)
+            {
+                const pge_network::MsgApp* const pMsgAppRx = m_compressor.decompressMsgApp(*pMsgApp, msgAppDecompressed);
+                const pge_network::MsgApp::TMsgId msgAppId = pMsgAppRx ?
+                    pge_network::MsgApp::getMsgAppMsgId(*pMsgAppRx) :
+                    pge_network::PgeMsgAppCompressor::getUncompressedMsgAppId(pge_network::MsgApp::getMsgAppMsgId(*pMsgApp));
+                if (!pMsgAppRx)
+                {
+                    CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: malformed compressed app message %u received from connection %u!",
+                        __func__, msgAppId, pge_network::PgePacket::getServerSideConnectionHandle(pktAsConst));
+                    assert(false);
+                }
+                else if (!m_allowListedAppMessages.contains(msgAppId))
+                {
+                    CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: non-allowlisted app message received: %u from connection %u!",
+                        __func__, msgAppId, pge_network::PgePacket::getServerSideConnectionHandle(pktAsConst));
+                    assert(false);
+                }
+                else
+                {
+                    // we could also check if nMsgSize is non-zero, however we shouldnt: app is allowed to define zero-size AppMsg, it is
+                    // not our business here to judge.
+                    // Size is recorded as received, i.e. compressed size if compressed, same as on sender side.
+                    m_stats.addMsgApp(
+                        pge_network::PgeNetworkStats::Direction::Rx,
+                        msgAppId,
+                        pge_network::MsgApp::getMsgAppTotalActualSizeBytes(*pMsgApp),
+                        getSendLaneByMsgAppId(msgAppId),
+                        timeRx);
+
+                    if (!bUnpack)
+                    {
+                        // no need to unpack, pkt is already in its slot, just commit it
+                        if (pPktSlot)
+                        {
+                            endPushBackRxPkt(usecTimeReceived, usecNow);
+                        }
+                        else
+                        {
+                            CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: packet queue full, dropped app message %u from connection %u!",
+                                __func__, msgAppId, pge_network::PgePacket::getServerSideConnectionHandle(pktSrc));
+                        }
+                    }
+                    else
+                    {
+                        // for the 1st app message we already have the slot we received into, it is the same slot beginPushBack() would return
+                        pge_network::PgePacket* const pPktUnpacked = (iAppMsg == 0) ? pPktSlot : beginPushBackRxPkt(usecTimeReceived, usecNow);
+                        if (!pPktUnpacked)
+                        {
+                            CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: packet queue full, dropped app message %u from connection %u!",
+                                __func__, msgAppId, pge_network::PgePacket::getServerSideConnectionHandle(pktSrc));
+                        }
+                        else
+                        {
+                            pge_network::PgePacket::initPktMsgApp(
+                                *pPktUnpacked,
+                                pge_network::PgePacket::getServerSideConnectionHandle(pktSrc),
+                                pge_network::PgePacket::AutoFill::NONE);
+                            if (pge_network::PgePacket::addPktMsgApp(*pPktUnpacked, *pMsgAppRx))
+                            {
+                                endPushBackRxPkt(usecTimeReceived, usecNow);
+                            }
+                            else
+                            {
+                                CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: failed to unpack app message %u from connection %u!",
+                                    __func__, msgAppId, pge_network::PgePacket::getServerSideConnectionHandle(pktSrc));
+                                assert(false);
+                            }
+                        }
+                    }
+                }
+                pMsgApp = pge_network::PgePacket::getNextMsgAppFromPkt(pktSrc, *pMsgApp);
+            }
+
+            if ((iAppMsg != nMessageCount) || pMsgApp)
+            {
+                CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: app message pkt with inconsistent msg count %u from connection %u!",
+                    __func__, nMessageCount, pge_network::PgePacket::getServerSideConnectionHandle(pktSrc));
+                assert(false);
+            }
+
+            m_nRxByteCount += nActualPktSize;
+            continue;
+        }
+        
+        if (!m_allowListedPgeMessages.contains(pge_network::PgePacket::getPacketId(pktAsConst)))
+        {
+            CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: non-allowlisted pge message received: %u from connection %u!",
+                __func__, pge_network::PgePacket::getPacketId(pktAsConst), pge_network::PgePacket::getServerSideConnectionHandle(pktAsConst));
+            assert(false);
+            continue;
+        }
+
+        if (pgeMessageIsHandledAtGnsLevel(pktAsConst))
+        {
+            CConsole::getConsoleInstance("PgeGnsWrapper").OLn("%s: PGE message %u handled at GNS level without reaching PGE level, from connection %u!",
+                __func__, pge_network::PgePacket::getPacketId(pktAsConst), pge_network::PgePacket::getServerSideConnectionHandle(pktAsConst));
+            continue;
+        }
+
+        // TODO: m_nRxByteCount should be incremented earlier since there are cases in the loop where we continue to next pkt, or we should
+        // update the definition of m_nRxByteCount to counting only those pkts which are actually pushed into PGE queue!
+        m_nRxByteCount += nActualPktSize;
+        if (pPktSlot)
+        {
+            endPushBackRxPkt(usecTimeReceived, usecNow);
+        }
+        else
+        {
+            CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: packet queue full, dropped pge message %u from connection %u!",
+                __func__, pge_network::PgePacket::getPacketId(pktAsConst), pge_network::PgePacket::getServerSideConnectionHandle(pktAsConst));
+        }
+    } // for i
+
+    if (m_nRxPktCount == 0)
+    {
+        m_time1stRxPkt = timeRx;
+    }
+    m_nRxPktCount += numGnsMsgs;
+
+    return true;
+}
+
+/**
+* Gets the number of received packets that can be stored without dropping any.
+* On the application thread, this is the number of free slots of the packet queue, except the last RX_QUEUE_INJECT_HEADROOM slots
+* which are reserved for injected packets, and it is 0 while the overflow queue is not empty, so injected packets keep their order.
+* On the network I/O thread, the same applies to the rx handoff queue and its overflow queue.
+* 
+* @return The number of free slots for received packets.
+*/
+std::size_t PgeGnsWrapper::getFreeRxPktSlotCount() const
+{
+    if (isIoThreadRunning() && !needsHandoffToIoThread())
+    {
+        if (!m_queueIoThreadRxOverflow.empty())
+        {
+            return 0;
+        }
+
+        // size() is never less than the actual size on the producer side
+        const std::size_t nUsedIoThread = m_queueIoThreadRx.size() + RX_QUEUE_INJECT_HEADROOM;
+        return (nUsedIoThread < m_queueIoThreadRx.capacity()) ? (m_queueIoThreadRx.capacity() - nUsedIoThread) : 0;
+    }
+
+    if (!m_queuePktsOverflow.empty())
+    {
+        return 0;
+    }
+
+    const std::size_t nUsed = m_queuePackets.size() + RX_QUEUE_INJECT_HEADROOM;
+    return (nUsed < m_queuePackets.capacity()) ? (m_queuePackets.capacity() - nUsed) : 0;
+}
+
+/**
+* Gets the slot where the next received or injected packet is to be stored: the back slot of the rx handoff queue if invoked on the
+* network I/O thread, otherwise the back slot of the packet queue.
+* Must be followed by endPushBackRxPkt() if the slot is filled, otherwise the slot is abandoned.
+* 
+* @param usecTimeReceived The time GNS received the packet, 0 for injected packets.
+* @param usecNow          The current GNS local time, used only on the I/O thread.
+* 
+* @return The slot to be filled, or nullptr if there is no free slot.
+*/
+pge_network::PgePacket* PgeGnsWrapper::beginPushBackRxPkt(
+    const SteamNetworkingMicroseconds& usecTimeReceived,
+    const SteamNetworkingMicroseconds& usecNow)
+{
+    if (!isIoThreadRunning())
+    {
+        return m_queuePackets.beginPushBack();
+    }
+
+    RxHandoffPkt* const pHandoffPkt = m_queueIoThreadRx.beginPushBack();
+    if (!pHandoffPkt)
+    {
+        return nullptr;
+    }
+
+    pHandoffPkt->m_usecTimeReceived = usecTimeReceived;
+    pHandoffPkt->m_usecTimeHandedOver = usecNow;
+    return &(pHandoffPkt->m_pkt);
+}
+
+/**
+* Stores the packet filled after beginPushBackRxPkt().
+* If invoked on the application thread, the rx latency of received packets is also recorded.
+* 
+* @param usecTimeReceived The time GNS received the packet, 0 for injected packets.
+* @param usecNow          The current GNS local time.
+*/
+void PgeGnsWrapper::endPushBackRxPkt(
+    const SteamNetworkingMicroseconds& usecTimeReceived,
+    const SteamNetworkingMicroseconds& usecNow)
+{
+    if (isIoThreadRunning())
+    {
+        m_queueIoThreadRx.endPushBack();
+        return;
+    }
+
+    m_queuePackets.endPushBack();
+    if (usecTimeReceived != 0)
+    {
+        m_handoffStats.m_rxLatency.add(usecNow - usecTimeReceived);
+    }
+}
+
+/**
+* Main loop of the network I/O thread.
+* Executes the commands handed over by the application thread, runs the connection status changed callbacks, receives the messages,
+* and publishes the statistics, then waits a bit for more work. After stop is requested, the remaining commands are still executed.
+*/
+void PgeGnsWrapper::runIoThread()
+{
+    while (!m_bIoThreadStopRequested)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mtxIoThread);
+            executeTxCmds();
+            pollConnectionStateChanges();
+            moveIoThreadRxOverflowPkts();
+            while (canPollIncomingMessages() && receiveIncomingMessages())
+            {
+            }
+        }
+        publishStatsSnapshot();
+
+        std::unique_lock<std::mutex> lockWakeup(m_mtxIoThreadWakeup);
+        m_cvIoThreadWakeup.wait_for(lockWakeup, IO_THREAD_POLL_INTERVAL, [this]() {
+            return m_bIoThreadStopRequested || !m_queueIoThreadTx.empty();
+            });
+    }
+
+    std::lock_guard<std::mutex> lock(m_mtxIoThread);
+    executeTxCmds();
+}
+
+/**
+* Executes all commands handed over by the application thread so far.
+* To be invoked only on the network I/O thread.
+*/
+void PgeGnsWrapper::executeTxCmds()
+{
+    const TxCmd* pCmd;
+    while ((pCmd = m_queueIoThreadTx.front()) != nullptr)
+    {
+        executeTxCmd(*pCmd);
+        m_queueIoThreadTx.popFront();
+    }
+}
+
+/**
+* Moves as many packets from the overflow queue of the rx handoff queue to the rx handoff queue as fit.
+* To be invoked only on the network I/O thread.
+*/
+void PgeGnsWrapper::moveIoThreadRxOverflowPkts()
+{
+    while (!m_queueIoThreadRxOverflow.empty())
+    {
+        RxHandoffPkt* const pHandoffPkt = m_queueIoThreadRx.beginPushBack();
+        if (!pHandoffPkt)
+        {
+            return;
+        }
+
+        *pHandoffPkt = m_queueIoThreadRxOverflow.front();
+        m_queueIoThreadRx.endPushBack();
+        m_queueIoThreadRxOverflow.pop_front();
+    }
+}
+
+/**
+* Moves the packets handed over by the network I/O thread so far to the packet queue, and records their latencies.
+* Received packets are moved only as long as the packet queue has room for them besides the headroom for injected packets, injected
+* packets as long as the packet queue is not full. The rest waits in the rx handoff queue in the same order, so when that becomes full,
+* the I/O thread stops taking messages from GNS.
+* Also adopts the latest statistics published by the I/O thread.
+* To be invoked only on the application thread.
+*/
+void PgeGnsWrapper::handOverIoThreadRxPkts()
+{
+    moveOverflowPktsToPacketQueue();
+
+    if (!m_queueIoThreadRx.empty())
+    {
+        const SteamNetworkingMicroseconds usecNow = SteamNetworkingUtils()->GetLocalTimestamp();
+        const RxHandoffPkt* pHandoffPkt;
+        while ((pHandoffPkt = m_queueIoThreadRx.front()) != nullptr)
+        {
+            const bool bInjected = (pHandoffPkt->m_usecTimeReceived == 0);
+            if (bInjected ? (!m_queuePktsOverflow.empty() || m_queuePackets.full()) : (getFreeRxPktSlotCount() == 0))
+            {
+                break;
+            }
+
+            m_queuePackets.pushBack(pHandoffPkt->m_pkt);
+            if (!bInjected)
+            {
+                m_handoffStats.m_rxLatency.add(usecNow - pHandoffPkt->m_usecTimeReceived);
+            }
+            m_handoffStats.m_handoffLatency.add(usecNow - pHandoffPkt->m_usecTimeHandedOver);
+            m_queueIoThreadRx.popFront();
+        }
+    }
+
+    adoptStatsSnapshot();
+}
+
+/**
+* Samples the real-time status of all connections into the telemetry, if the sample interval has elapsed since the last sampling.
+* Invoked by pollConnectionStateChanges(), so on the network I/O thread if it is running, otherwise on the application thread.
+*/
+void PgeGnsWrapper::sampleTelemetry()
+{
+    const auto timeNow = std::chrono::steady_clock::now();
+    if (!m_telemetry.beginSampling(timeNow))
+    {
+        return;
+    }
+
+    m_vTelemetryConns.clear();
+    collectTelemetryConns(m_vTelemetryConns);
+    for (const auto& conn : m_vTelemetryConns)
+    {
+        SteamNetConnectionRealTimeStatus_t status;
+        if (m_pInterface->GetConnectionRealTimeStatus(conn, &status, 0, nullptr) != k_EResultOK)
+        {
+            continue;
+        }
+
+        typedef pge_network::PgeConnectionTelemetry::Metric Metric;
+        pge_network::PgeConnectionTelemetry::Sample sample;
+        sample.m_time = timeNow;
+        sample.m_fValues[static_cast<size_t>(Metric::Ping)] = static_cast<float>(status.m_nPing);
+        sample.m_fValues[static_cast<size_t>(Metric::QualityLocal)] = status.m_flConnectionQualityLocal;
+        sample.m_fValues[static_cast<size_t>(Metric::QualityRemote)] = status.m_flConnectionQualityRemote;
+        sample.m_fValues[static_cast<size_t>(Metric::RxBytesPerSec)] = status.m_flInBytesPerSec;
+        sample.m_fValues[static_cast<size_t>(Metric::TxBytesPerSec)] = status.m_flOutBytesPerSec;
+        sample.m_fValues[static_cast<size_t>(Metric::PendingUnreliableBytes)] = static_cast<float>(status.m_cbPendingUnreliable);
+        sample.m_fValues[static_cast<size_t>(Metric::PendingReliableBytes)] = static_cast<float>(status.m_cbPendingReliable);
+        sample.m_fValues[static_cast<size_t>(Metric::SentUnAckedReliableBytes)] = static_cast<float>(status.m_cbSentUnackedReliable);
+        sample.m_fValues[static_cast<size_t>(Metric::QueueTimeUSecs)] = static_cast<float>(status.m_usecQueueTime);
+        m_telemetry.addSample(conn, sample);
+    }
+}
+
+/**
+* Writes the telemetry to the file specified by CVAR_NET_TELEMETRY_FILE, and its per-second window statistics to the same file
+* with ".windows.csv" appended.
+* Does nothing if the CVAR is empty or no connection has been sampled.
+*/
+void PgeGnsWrapper::exportTelemetry() const
+{
+    const std::string sTelemetryFilename = m_cfgProfiles.getVars()[pge_network::PgeINetwork::CVAR_NET_TELEMETRY_FILE].getAsString();
+    if (sTelemetryFilename.empty() || m_telemetry.getConnectionHandles().empty())
+    {
+        return;
+    }
+
+    std::ofstream fSamples(sTelemetryFilename, std::ios::out | std::ios::trunc);
+    fSamples << m_telemetry.exportCsv();
+
+    std::ofstream fWindows(sTelemetryFilename + ".windows.csv", std::ios::out | std::ios::trunc);
+    fWindows << m_telemetry.exportWindowStatsCsv(TELEMETRY_EXPORT_WINDOW);
+
+    if (!fSamples || !fWindows)
+    {
+        CConsole::getConsoleInstance("PgeGnsWrapper").EOLn("%s: failed to write telemetry to %s!", __func__, sTelemetryFilename.c_str());
+        return;
+    }
+
+    CConsole::getConsoleInstance("PgeGnsWrapper").OLn("Telemetry of %u connections exported to: %s",
+        m_telemetry.getConnectionHandles().size(), sTelemetryFilename.c_str());
+}
+
+/**
+* @param snapshot Receives a copy of the current statistics.
+*/
+void PgeGnsWrapper::takeStatsSnapshot(StatsSnapshot& snapshot) const
+{
+    snapshot.m_nRxPktCount = m_nRxPktCount;
+    snapshot.m_nTxPktCount = m_nTxPktCount;
+    snapshot.m_nInjectPktCount = m_nInjectPktCount;
+    snapshot.m_time1stRxPkt = m_time1stRxPkt;
+    snapshot.m_time1stTxPkt = m_time1stTxPkt;
+    snapshot.m_time1stInjectPkt = m_time1stInjectPkt;
+    snapshot.m_nRxByteCount = m_nRxByteCount;
+    snapshot.m_nTxByteCount = m_nTxByteCount;
+    snapshot.m_nInjectByteCount = m_nInjectByteCount;
+    snapshot.m_stats = m_stats;
+}
+
+/**
+* Publishes the statistics for the application thread, if IO_THREAD_STATS_PUBLISH_INTERVAL elapsed since the last publish.
+* To be invoked only on the network I/O thread.
+*/
+void PgeGnsWrapper::publishStatsSnapshot()
+{
+    const auto timeNow = std::chrono::steady_clock::now();
+    if (timeNow - m_timeStatsPublished < IO_THREAD_STATS_PUBLISH_INTERVAL)
+    {
+        return;
+    }
+    m_timeStatsPublished = timeNow;
+
+    std::lock_guard<std::mutex> lock(m_mtxStatsPublished);
+    takeStatsSnapshot(m_statsPublished);
+    m_bStatsPublished = true;
+}
+
+/**
+* Copies the statistics last published by the network I/O thread to the snapshot read by the statistics getters.
+* Never blocks: if the I/O thread is just publishing, the statistics are adopted next time.
+* To be invoked only on the application thread.
+*/
+void PgeGnsWrapper::adoptStatsSnapshot()
+{
+    std::unique_lock<std::mutex> lock(m_mtxStatsPublished, std::try_to_lock);
+    if (lock.owns_lock() && m_bStatsPublished)
+    {
+        m_statsSnapshot = m_statsPublished;
+        m_bStatsPublished = false;
+    }
+}
+
+/**
+* Updates the tx statistics as the given packet was sent to the given connection.
+* App message statistics are recorded by the original app message id, with the size as sent, i.e. compressed size if compressed.
+* 
+* @param conn           The connection the given packet was sent to.
+* @param pkt            The sent packet, as sent, i.e. with compressed app messages.
+* @param nActualPktSize The actually used memory area of the sent packet in bytes.
+* @param lane           The send lane used for sending the packet.
+* @param timeTx         The time of sending.
+*/
+void PgeGnsWrapper::updateTxStats(
+    const HSteamNetConnection& conn,
+    const pge_network::PgePacket& pkt,
+    const uint32_t& nActualPktSize,
+    const pge_network::PgeSendLane& lane,
+    const pge_network::PgeNetworkStats::TimePoint& timeTx)
+{
+    if (m_nTxPktCount == 0)
+    {
+        m_time1stTxPkt = timeTx;
+    }
+    m_nTxPktCount++;
+    m_stats.addPkt(pge_network::PgeNetworkStats::Direction::Tx, conn, nActualPktSize, timeTx);
+    m_capture.record(pge_network::PgeNetworkStats::Direction::Tx, conn, pkt, nActualPktSize, timeTx);
+    if (pge_network::PgePacket::getPacketId(pkt) == pge_network::PgePktId::Application)
+    {
+        const pge_network::MsgApp* pMsgApp = pge_network::PgePacket::getMsgAppFromPkt(pkt);
+        const uint8_t nMessageCount = pge_network::PgePacket::getMessageAppCount(pkt);
+        for (uint8_t i = 0; (i < nMessageCount) && pMsgApp; i++)
+        {
+            m_stats.addMsgApp(
+                pge_network::PgeNetworkStats::Direction::Tx,
+                pge_network::PgeMsgAppCompressor::getUncompressedMsgAppId(pge_network::MsgApp::getMsgAppMsgId(*pMsgApp)),
+                pge_network::MsgApp::getMsgAppTotalActualSizeBytes(*pMsgApp),
+                lane,
+                timeTx);
+            pMsgApp = pge_network::PgePacket::getNextMsgAppFromPkt(pkt, *pMsgApp);
+        }
+    }
+    m_nTxByteCount += nActualPktSize;
+}
@@ -12,14 +12,26 @@
 
 #include "../PGEallHeaders.h"
 
+#include <array>
+#include <atomic>
 #include <chrono>  // requires cpp11
+#include <condition_variable>
 #include <cstdint>
 #include <deque>
-#include <set>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "../Config/PGEcfgProfiles.h"
+#include "PgeConnectionTelemetry.h"
+#include "PgeMsgAppCompressor.h"
+#include "PgeMsgIdAllowList.h"
+#include "PgeNetworkStats.h"
 #include "PgePacket.h"
+#include "PgePacketCapture.h"
+#include "PgePacketRing.h"
+#include "PgeSpscQueue.h"
 
 // this idea of building include paths is coming from:
 // https://stackoverflow.com/questions/32066204/construct-path-for-include-directive-with-macro
@@ -44,6 +56,20 @@ static_assert(
 
 /**
     PR00F's Game Engine's wrapper for GameNetworkingSockets library.
+
+    By default everything runs on the application thread that invokes pollIncomingMessages() and pollConnectionStateChanges().
+    If CVAR_NET_IO_THREAD is set, a dedicated network I/O thread is started when the derived class starts listening or connecting,
+    and from then on the I/O thread owns the GameNetworkingSockets interface, the connections, the batches and the statistics:
+     - it runs the connection status changed callbacks, receives the messages and sends the packets;
+     - received and injected packets are handed over to the application thread by a lock-free SPSC queue, from which
+       pollIncomingMessages() moves them to the packet queue;
+     - packets sent and flushed by the application thread are handed over to the I/O thread by another lock-free SPSC queue;
+     - statistics getters invoked on the application thread return a snapshot published by the I/O thread a few times per second;
+     - connection telemetry is sampled by the I/O thread, so getConnectionTelemetry() must be invoked while holding lockIoThread();
+     - app messages are compressed and decompressed by the I/O thread, so the statistics of getMsgAppCompressor() must be accessed
+       while holding lockIoThread();
+     - debug functions accessing the connections must be invoked while holding lockIoThread().
+    The derived class stops the I/O thread before closing connections, so these are always done on the application thread.
 */
 class PgeGnsWrapper
 {
@@ -84,18 +110,31 @@ public:
     
     /**
     * Moves incoming SteamNetworkingMessages from GameNetworkingSockets layer to m_queuePackets as PgePackets.
+    * If the network I/O thread is running, this instead moves the packets already received by the I/O thread to m_queuePackets.
     * 
-    * @return True on success, false on error.
+    * @return True if messages were received and there might be more to receive, false on error or if there is nothing more to receive.
     */
     bool pollIncomingMessages();
 
+    /**
+    * Runs the connection status changed callbacks.
+    * No effect if invoked on the application thread while the network I/O thread is running, since the I/O thread runs them.
+    */
     void pollConnectionStateChanges();
+
+    bool isIoThreadRunning() const;
+    std::unique_lock<std::mutex> lockIoThread() const;
+    pge_network::PgeHandoffStats getHandoffStats() const;
    
     std::size_t getPacketQueueSize() const;
     pge_network::PgePacket popFrontPacket() noexcept(false);
+    const pge_network::PgePacket& borrowFrontPacket() noexcept(false);
+    void releaseFrontPacket();
+    uint32_t getPacketQueueDroppedCount() const;
+    std::size_t getPacketQueueHighWaterMark() const;
 
-    std::set<pge_network::PgePktId>& getAllowListedPgeMessages();
-    std::set<pge_network::MsgApp::TMsgId>& getAllowListedAppMessages();
+    pge_network::PgePktIdAllowList& getAllowListedPgeMessages();
+    pge_network::MsgAppIdAllowList& getAllowListedAppMessages();
 
     uint32_t getRxPacketCount() const;
     uint32_t getTxPacketCount() const;
@@ -109,23 +148,65 @@ public:
     const std::map<pge_network::MsgApp::TMsgId, uint32_t>& getTxMsgCount() const;
     const std::map<pge_network::MsgApp::TMsgId, uint32_t>& getInjectMsgCount() const;
 
+    const std::map<pge_network::PgeSendLane, uint32_t>& getRxLaneMsgCount() const;
+    const std::map<pge_network::PgeSendLane, uint32_t>& getTxLaneMsgCount() const;
+
+    const pge_network::PgeNetworkStats& getNetworkStats() const;
+
     std::map<pge_network::MsgApp::TMsgId, std::string>& getMsgAppId2StringMap();
+    std::map<pge_network::MsgApp::TMsgId, pge_network::PgeSendLane>& getMsgAppId2SendLaneMap();
+    pge_network::PgeMsgAppCompressor& getMsgAppCompressor();
 
     uint32_t getRxByteCount() const;
     uint32_t getTxByteCount() const;
     uint32_t getInjectByteCount() const;
 
+    const pge_network::PgeConnectionTelemetry& getConnectionTelemetry() const;
+
 protected:
 
+    /** Batch packets of a connection, 1 per send lane, indexed by pge_network::PgeSendLane. */
+    typedef std::array<pge_network::PgePacket, pge_network::nSendLaneCount> SendLane2PktBatchArray;
+
+    /**
+        Packet referred by multiple outgoing GNS messages, so a packet sent to multiple connections is copied only once.
+        Deleted by the free callback of the last GNS message referring to it, which might be invoked on any thread.
+    */
+    struct SharedPkt
+    {
+        std::atomic<uint32_t> m_nRefCount;
+        pge_network::PgePacket m_pkt;
+    };
+
+    /**
+        Work item handed over by the application thread to the network I/O thread, executed by executeTxCmd().
+    */
+    struct TxCmd
+    {
+        enum class Type : uint8_t
+        {
+            Send = 0,          /**< Send m_pkt to m_conn, or to the server in case of client instance. */
+            SendToAllExcept,   /**< Send m_pkt to all clients except m_vExcepts, server instance only. */
+            Flush,             /**< Send out the batched packets. */
+            Inject             /**< m_pkt is already injected by the application thread, to be captured and counted by the I/O thread. */
+        };
+
+        Type m_type;
+        HSteamNetConnection m_conn;
+        std::vector<HSteamNetConnection> m_vExcepts;  /**< Sorted, slots are reused so this allocates only when growing. */
+        pge_network::PgePacket m_pkt;
+    };
+
     static PgeGnsWrapper* s_pCallbackInstance;
 
     PGEcfgProfiles& m_cfgProfiles;
     
     ISteamNetworkingSockets* m_pInterface;
 
-    std::deque<pge_network::PgePacket> m_queuePackets;
-    std::set<pge_network::PgePktId> m_allowListedPgeMessages;
-    std::set<pge_network::MsgApp::TMsgId> m_allowListedAppMessages;
+    pge_network::PgePacketRing m_queuePackets;  /**< Preallocated by reservePacketQueue(), packets are borrowed from here by app level. */
+    std::deque<pge_network::PgePacket> m_queuePktsOverflow;  /**< Injected packets and packets left by the stopped I/O thread, not fitting into m_queuePackets. Accessed only by the application thread. */
+    pge_network::PgePktIdAllowList m_allowListedPgeMessages;
+    pge_network::MsgAppIdAllowList m_allowListedAppMessages;
 
     uint32_t m_nRxPktCount;
     uint32_t m_nTxPktCount;
@@ -135,11 +216,11 @@ protected:
     std::chrono::time_point<std::chrono::steady_clock> m_time1stTxPkt;
     std::chrono::time_point<std::chrono::steady_clock> m_time1stInjectPkt;
 
-    std::map<pge_network::MsgApp::TMsgId, uint32_t> m_nRxMsgCount;
-    std::map<pge_network::MsgApp::TMsgId, uint32_t> m_nTxMsgCount;
-    std::map<pge_network::MsgApp::TMsgId, uint32_t> m_nInjectMsgCount;
+    pge_network::PgeNetworkStats m_stats;  /**< Per app message id and per connection statistics, no lookup or allocation per app message. */
 
     std::map<pge_network::MsgApp::TMsgId, std::string> m_mapMsgAppId2String;
+    std::map<pge_network::MsgApp::TMsgId, pge_network::PgeSendLane> m_mapMsgAppId2SendLane;
+    pge_network::PgeMsgAppCompressor m_compressor;  /**< Used by the network I/O thread while it is running. */
 
     uint32_t m_nRxByteCount;
     uint32_t m_nTxByteCount;
@@ -147,9 +228,20 @@ protected:
 
     std::string m_sAppVersion; /**< Expected client app version in case of server instance, or simply client app version in case of client instance. */
 
+    std::vector<SteamNetworkingMessage_t*> m_vTxGnsMsgs;  /**< Reused by sendPktToConnections(), so it doesn't allocate per call. */
+
+    pge_network::PgePacketCaptureWriter m_capture;  /**< Records all sent, received and injected packets when opened by startPacketCapture(). */
+
+    pge_network::PgeConnectionTelemetry m_telemetry;         /**< Owned by the network I/O thread while it is running. */
+    std::vector<HSteamNetConnection> m_vTelemetryConns;      /**< Reused by sampleTelemetry(), so it doesn't allocate per sampling. */
+
     // ---------------------------------------------------------------------------
 
     static void steamNetConnectionStatusChangedCallback(SteamNetConnectionStatusChangedCallback_t* pInfo);
+    static int getSteamNetworkingSendFlags(const pge_network::PgeSendLane& lane);
+    static const char* getSendLaneString(const pge_network::PgeSendLane& lane);
+    static void initPktBatches(SendLane2PktBatchArray& pktBatches);
+    static void freeSharedPkt(SteamNetworkingMessage_t* pGnsMsg);
 
     explicit PgeGnsWrapper(PGEcfgProfiles& cfgProfiles);
     PgeGnsWrapper(const PgeGnsWrapper&); 
@@ -160,8 +252,104 @@ protected:
     virtual bool validateSteamNetworkingMessage(const HSteamNetConnection& connHandle) const = 0;
     virtual void updateIncomingPgePacket(pge_network::PgePacket& pkt, const HSteamNetConnection& connHandle) const = 0;
     virtual void onSteamNetConnectionStatusChanged(SteamNetConnectionStatusChangedCallback_t* pInfo) = 0;
+    virtual bool canPollIncomingMessages() const = 0;
+    virtual void executeTxCmd(const TxCmd& cmd) = 0;
+    virtual void collectTelemetryConns(std::vector<HSteamNetConnection>& vConns) const = 0;
+
+    bool reservePacketQueue();
+    bool startPacketCapture();
+    bool startTelemetry();
+    void enqueuePkt(const pge_network::PgePacket& pkt);
+    void captureInjectedPkt(const pge_network::PgePacket& pkt);
+
+    void startIoThread();
+    void stopIoThread();
+    bool needsHandoffToIoThread() const;
+    TxCmd* beginTxCmd(const TxCmd::Type& type);
+    void endTxCmd(const TxCmd& cmd);
+
+    pge_network::PgeSendLane getSendLaneByMsgAppId(const pge_network::MsgApp::TMsgId& id) const;
+    void sendPkt(const HSteamNetConnection& conn, const pge_network::PgePacket& pkt, const pge_network::PgeSendLane& lane);
+    void sendPktToConnections(const std::vector<HSteamNetConnection>& vConns, const pge_network::PgePacket& pkt, const pge_network::PgeSendLane& lane);
+    void batchPkt(const HSteamNetConnection& conn, SendLane2PktBatchArray& pktBatches, const pge_network::PgePacket& pkt);
+    void flushBatchPkt(const HSteamNetConnection& conn, SendLane2PktBatchArray& pktBatches, const pge_network::PgeSendLane& lane);
+    void flushBatchPkts(const HSteamNetConnection& conn, SendLane2PktBatchArray& pktBatches);
 
     std::string getStringByMsgAppId(const pge_network::MsgApp::TMsgId& id) const;
+    void logMsgAppStats(const pge_network::PgeNetworkStats::Direction& dir, const char* szTitle) const;
     std::string getDetailedConnectionStatus(const HSteamNetConnection& connHandle) const;
     void logDetailedConnectionStatus(const HSteamNetConnection& connHandle) const;
+
+private:
+
+    /**
+        Received or injected packet handed over by the network I/O thread to the application thread.
+    */
+    struct RxHandoffPkt
+    {
+        pge_network::PgePacket m_pkt;
+        SteamNetworkingMicroseconds m_usecTimeReceived;    /**< 0 for injected packets. */
+        SteamNetworkingMicroseconds m_usecTimeHandedOver;
+    };
+
+    /**
+        Copy of the statistics owned by the network I/O thread, so the application thread can read them while the I/O thread is running.
+    */
+    struct StatsSnapshot
+    {
+        uint32_t m_nRxPktCount = 0;
+        uint32_t m_nTxPktCount = 0;
+        uint32_t m_nInjectPktCount = 0;
+        std::chrono::time_point<std::chrono::steady_clock> m_time1stRxPkt;
+        std::chrono::time_point<std::chrono::steady_clock> m_time1stTxPkt;
+        std::chrono::time_point<std::chrono::steady_clock> m_time1stInjectPkt;
+        uint32_t m_nRxByteCount = 0;
+        uint32_t m_nTxByteCount = 0;
+        uint32_t m_nInjectByteCount = 0;
+        pge_network::PgeNetworkStats m_stats;
+    };
+
+    std::thread m_ioThread;
+    bool m_bIoThreadRunning;                          /**< Written only by the application thread while the I/O thread is not running. */
+    std::atomic<bool> m_bIoThreadStopRequested;
+    mutable std::mutex m_mtxIoThread;                 /**< Held by the I/O thread while it accesses GNS and the connections. */
+    std::mutex m_mtxIoThreadWakeup;
+    std::condition_variable m_cvIoThreadWakeup;       /**< Notified by the application thread on flush and on stop. */
+    pge_network::PgeSpscQueue<RxHandoffPkt> m_queueIoThreadRx;  /**< Produced by the I/O thread, consumed by the application thread. */
+    std::deque<RxHandoffPkt> m_queueIoThreadRxOverflow;         /**< Packets injected by the I/O thread not fitting into m_queueIoThreadRx, accessed only by the I/O thread. */
+    pge_network::PgeSpscQueue<TxCmd> m_queueIoThreadTx;         /**< Produced by the application thread, consumed by the I/O thread. */
+    pge_network::PgeHandoffStats m_handoffStats;      /**< Latencies and tx wait count, accessed only by the application thread. */
+
+    std::mutex m_mtxStatsPublished;
+    StatsSnapshot m_statsPublished;                   /**< Written by the I/O thread, guarded by m_mtxStatsPublished. */
+    bool m_bStatsPublished;                           /**< Guarded by m_mtxStatsPublished. */
+    std::chrono::time_point<std::chrono::steady_clock> m_timeStatsPublished;  /**< Accessed only by the I/O thread. */
+    StatsSnapshot m_statsSnapshot;                    /**< Read by the statistics getters on the application thread while the I/O thread is running. */
+
+    // ---------------------------------------------------------------------------
+
+    bool receiveIncomingMessages();
+    std::size_t getFreeRxPktSlotCount() const;
+    void storeInjectedPkt(const pge_network::PgePacket& pkt);
+    void moveOverflowPktsToPacketQueue();
+    pge_network::PgePacket* beginPushBackRxPkt(const SteamNetworkingMicroseconds& usecTimeReceived, const SteamNetworkingMicroseconds& usecNow);
+    void endPushBackRxPkt(const SteamNetworkingMicroseconds& usecTimeReceived, const SteamNetworkingMicroseconds& usecNow);
+
+    void runIoThread();
+    void executeTxCmds();
+    void moveIoThreadRxOverflowPkts();
+    void handOverIoThreadRxPkts();
+
+    void sampleTelemetry();
+    void exportTelemetry() const;
+    void takeStatsSnapshot(StatsSnapshot& snapshot) const;
+    void publishStatsSnapshot();
+    void adoptStatsSnapshot();
+
+    void updateTxStats(
+        const HSteamNetConnection& conn,
+        const pge_network::PgePacket& pkt,
+        const uint32_t& nActualPktSize,
+        const pge_network::PgeSendLane& lane,
+        const pge_network::PgeNetworkStats::TimePoint& timeTx);
 }; // class PgeGnsWrapper
\ No newline at end of file
@@ -31,6 +31,12 @@ namespace pge_network
     public:
 
         static constexpr char* CVAR_NET_SERVER = "net_server";
+        static constexpr char* CVAR_NET_RX_QUEUE_CAPACITY = "net_rx_queue_capacity";      /**< Max number of received packets waiting for app level, rounded up to power of two. */
+        static constexpr char* CVAR_NET_CAPTURE_FILE = "net_capture_file";                  /**< If not empty, all sent, received and injected packets are captured to this file. */
+        static constexpr char* CVAR_NET_IO_THREAD = "net_io_thread";                        /**< If true, a dedicated thread does the network I/O, see PgeIServerClient. */
+        static constexpr char* CVAR_NET_TELEMETRY_INTERVAL_MS = "net_telemetry_interval_ms";  /**< If positive, status of all connections is sampled this often, see PgeConnectionTelemetry. */
+        static constexpr char* CVAR_NET_TELEMETRY_CAPACITY = "net_telemetry_capacity";        /**< Max number of telemetry samples kept per connection. */
+        static constexpr char* CVAR_NET_TELEMETRY_FILE = "net_telemetry_file";                /**< If not empty, telemetry is exported to this CSV file, and its window statistics to "<file>.windows.csv", at shutdown. */
 
         /**
             Returns the logger module name of this class.
@@ -10,6 +10,7 @@
     ###################################################################################
 */
 
+#include <set>
 #include <string>
 
 #include "../PGEallHeaders.h"
@@ -55,6 +56,7 @@ namespace pge_network
         /**
         * Sends the given packet to all client instances except the optionally specified client.
         * This function is never able to send to server, not even injecting, hence the name contains "Clients".
+        * The packet is copied only once for all clients, so this is much cheaper than invoking send() for each client.
         *
         * @param pkt              The packet to be sent.
         * @param exceptConnHandle The server-side connection of handle of a client to which we DO NOT want to send the packet.
@@ -67,6 +69,17 @@ namespace pge_network
             const pge_network::PgePacket& pkt,
             const pge_network::PgeNetworkConnectionHandle& exceptConnHandle = pge_network::ServerConnHandle) = 0;
 
+        /**
+        * Same as the other sendToAllClientsExcept(), but with multiple clients to which we DO NOT want to send the packet.
+        *
+        * @param pkt               The packet to be sent.
+        * @param exceptConnHandles The server-side connection handles of clients to which we DO NOT want to send the packet.
+        *                          Can be empty, in such case the packet is sent to all clients.
+        */
+        virtual void sendToAllClientsExcept(
+            const pge_network::PgePacket& pkt,
+            const std::set<pge_network::PgeNetworkConnectionHandle>& exceptConnHandles) = 0;
+
         /**
         * Sends the given packet to all known network instances, including the server itself (self).
         * Basically equals to:
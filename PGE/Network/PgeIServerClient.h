@@ -13,13 +13,16 @@
 #include <cstdint>
 #include <deque>
 #include <map>
-#include <set>
 #include <string>
 
 #include "../../../Console/CConsole/src/CConsole.h"
 
 #include "../PGEallHeaders.h"
 #include "../Config/PGEcfgProfiles.h"
+#include "PgeConnectionTelemetry.h"
+#include "PgeMsgAppCompressor.h"
+#include "PgeMsgIdAllowList.h"
+#include "PgeNetworkStats.h"
 #include "PgePacket.h"
 
 namespace pge_network
@@ -28,6 +31,21 @@ namespace pge_network
     /**
         PGE Network Client and Server Common Interface class.
         Let the application be either client or server, it is supposed to access functionality through this common interface.
+
+        Threading: all functions are expected to be invoked on the same application thread, typically by PGE::runGame().
+        If PgeINetwork::CVAR_NET_IO_THREAD is set, the server starts a dedicated network I/O thread when it starts listening, and the client
+        when it connects, and the thread is stopped when the server stops listening or the client disconnects. Meanwhile:
+         - received packets are moved by the I/O thread to a lock-free handoff queue, from where Update() and pollIncomingMessages() move
+           them to the packet queue, so the packet queue is still accessed only by the application thread; if the packet queue is full,
+           they wait in the handoff queue, and if that is full, the I/O thread stops taking messages from the network layer;
+         - packets sent by the application thread are handed over to the I/O thread by another lock-free queue, the I/O thread batches
+           and sends them; if that queue stays full for a while, the packet is dropped and counted, see getHandoffStats();
+         - packets injected by the application thread to itself are stored directly in the packet queue, so they are available in the
+           same frame as without the I/O thread;
+         - statistics getters return a snapshot refreshed by Update() and pollIncomingMessages() a few times per second;
+         - debug functions querying the connection status take a lock, so they should not be invoked frequently;
+         - allow lists and message id maps are read by the I/O thread, so they must be set up before listening or connecting.
+        See getHandoffStats() for the cost of the handoff.
     */
     class PgeIServerClient
     {
@@ -73,8 +91,67 @@ namespace pge_network
         virtual std::size_t getPacketQueueSize() const = 0;
         virtual pge_network::PgePacket popFrontPacket() noexcept(false) = 0;
 
-        virtual std::set<pge_network::PgePktId>& getAllowListedPgeMessages() = 0;
-        virtual std::set<pge_network::MsgApp::TMsgId>& getAllowListedAppMessages() = 0;
+        /**
+        * Gets the front packet of the packet queue without copying it.
+        * The returned reference is valid until releaseFrontPacket() is invoked, and the packet is not dropped meanwhile even if
+        * the queue becomes full, so it is safe to send packets to self while processing the borrowed packet.
+        * Throws exception if the packet queue is empty, so caller should check getPacketQueueSize() first.
+        *
+        * @return Const reference to the front packet stored in the packet queue.
+        */
+        virtual const pge_network::PgePacket& borrowFrontPacket() noexcept(false) = 0;
+
+        /**
+        * Removes the front packet from the packet queue, invalidating the reference returned by borrowFrontPacket().
+        */
+        virtual void releaseFrontPacket() = 0;
+
+        /**
+        * The packet queue has fixed capacity configured by PgeINetwork::CVAR_NET_RX_QUEUE_CAPACITY, and when it is full,
+        * no more packets are taken from the network layer until app level makes room, so packets are dropped only by implementations
+        * without such backpressure, e.g. the loopback transport.
+        *
+        * @return Number of packets dropped due to full packet queue.
+        */
+        virtual uint32_t getPacketQueueDroppedCount() const = 0;
+
+        /**
+        * @return Maximum number of packets stored in the packet queue at the same time.
+        */
+        virtual std::size_t getPacketQueueHighWaterMark() const = 0;
+
+        virtual pge_network::PgePktIdAllowList& getAllowListedPgeMessages() = 0;
+        virtual pge_network::MsgAppIdAllowList& getAllowListedAppMessages() = 0;
+
+        /**
+        * Gets the send lane configured per app message id.
+        * Packet sender functions select the send semantics of app messages based on this map, e.g. a high-rate state update
+        * can be sent on an unreliable lane so that a lost update does not delay newer updates because of retransmission.
+        * App messages not present in this map are sent on the Reliable lane.
+        * The receiver side also uses its own map for counting received app messages per lane, so it is recommended to
+        * configure the same lanes on both server and client sides.
+        * 
+        * @return Modifiable map of send lanes per app message id.
+        */
+        virtual std::map<pge_network::MsgApp::TMsgId, pge_network::PgeSendLane>& getMsgAppId2SendLaneMap() = 0;
+
+        /**
+        * Gets the compressor of app messages.
+        * App messages having their id in PgeMsgAppCompressor::getCompressedAppMessages() are compressed on sending, unless
+        * compression would not make them smaller. Received compressed app messages are always decompressed, so it is enough to
+        * enable compression on the sender side, however both sides must use the same dictionary, see PgeMsgAppCompressor::setDictionary().
+        * Expected to be configured before listening or connecting, since the network I/O thread might use it afterwards.
+        * 
+        * @return The compressor of app messages.
+        */
+        virtual pge_network::PgeMsgAppCompressor& getMsgAppCompressor() = 0;
+
+        /**
+        * Gets the compression statistics per app message id, safe to be invoked even while the network I/O thread is running.
+        * 
+        * @return Copy of PgeMsgAppCompressor::getStats() of getMsgAppCompressor().
+        */
+        virtual std::map<pge_network::MsgApp::TMsgId, pge_network::PgeMsgAppCompressor::MsgAppStats> getMsgAppCompressionStats() const = 0;
 
         /**
         * Sends the given packet to the network instance specified.
@@ -87,6 +164,15 @@ namespace pge_network
         */
         virtual void send(const pge_network::PgePacket& pkt, const pge_network::PgeNetworkConnectionHandle& connHandle = pge_network::ServerConnHandle) = 0;
 
+        /**
+        * Sends out all app messages batched since the last call to this function.
+        * Packet sender functions don't necessarily send out app messages immediately: app messages addressed to the same
+        * network instance are batched into as few packets as possible, and those packets are sent out by this function.
+        * The receiver side unpacks these packets transparently, so the application still receives 1 app message per packet.
+        * PGE invokes this function automatically once per frame in PGE::runGame(), after PGE::onGameRunning().
+        */
+        virtual void flushBatchedPackets() = 0;
+
         virtual uint32_t getRxPacketCount() const = 0;
         virtual uint32_t getTxPacketCount() const = 0;
         virtual uint32_t getInjectPacketCount() const = 0;
@@ -99,12 +185,45 @@ namespace pge_network
         virtual const std::map<pge_network::MsgApp::TMsgId, uint32_t>& getTxMsgCount() const = 0;
         virtual const std::map<pge_network::MsgApp::TMsgId, uint32_t>& getInjectMsgCount() const = 0;
 
+        virtual const std::map<pge_network::PgeSendLane, uint32_t>& getRxLaneMsgCount() const = 0;
+        virtual const std::map<pge_network::PgeSendLane, uint32_t>& getTxLaneMsgCount() const = 0;
+
+        /**
+        * Gets the detailed traffic statistics: count, bytes, per-second rates, size and inter-arrival time histograms,
+        * per app message id and per connection, for each direction (rx, tx, inject).
+        * Above map-returning getters of app message counts are built from these statistics on each call, so they should not
+        * be invoked frequently.
+        * Use PgeNetworkStats::exportCsv() or PgeNetworkStats::exportJson() to dump the statistics, or copy it to take a snapshot.
+        * 
+        * @return The traffic statistics collected since the network instance was started.
+        */
+        virtual const pge_network::PgeNetworkStats& getNetworkStats() const = 0;
+
         virtual std::map<pge_network::MsgApp::TMsgId, std::string>& getMsgAppId2StringMap() = 0;
 
         virtual uint32_t getRxByteCount() const = 0;
         virtual uint32_t getTxByteCount() const = 0;
         virtual uint32_t getInjectByteCount() const = 0;
 
+        /**
+        * Gets the latency of getting received packets into the packet queue, and if the network I/O thread is running, also the latency
+        * and fill levels of the handoff queues between the I/O thread and the application thread.
+        * Useful for comparing the I/O thread to polling on the application thread under the same load.
+        * 
+        * @return The handoff statistics collected since the I/O thread was last started, or since the network instance was started.
+        */
+        virtual pge_network::PgeHandoffStats getHandoffStats() const = 0;
+
+        /**
+        * Gets the history of ping, quality, byte rates, pending bytes and queue time of each connection, sampled every
+        * CVAR_NET_TELEMETRY_INTERVAL_MS milliseconds, if it is set.
+        * Use PgeConnectionTelemetry::getWindowStats() for min/avg/max/p99 of a time window, or PgeConnectionTelemetry::exportCsv()
+        * and PgeConnectionTelemetry::exportWindowStatsCsv() to dump it at match end.
+        * 
+        * @return Snapshot of the telemetry collected since the network instance was started.
+        */
+        virtual pge_network::PgeConnectionTelemetry getConnectionTelemetry() const = 0;
+
         virtual void WriteList() const = 0;    /**< Writes statistics to console. */
     }; // class PgeIServerClient
 
@@ -0,0 +1,408 @@
+/*
+    ###################################################################################
+    PgeInterestManager.cpp
+    This file is part of PGE.
+    PR00F's Game Engine server-side area-of-interest management
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgeInterestManager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace pge_network {
+
+    // cell coordinates are clamped to 21 bits each, so all 3 of them fit into a single 64-bit cell key
+    static constexpr int32_t nCellCoordBits = 21;
+    static constexpr int32_t nCellCoordMax = (1 << (nCellCoordBits - 1)) - 1;
+    static constexpr int32_t nCellCoordMin = -nCellCoordMax;
+
+    /**
+        @param fCellSize    Size of a grid cell, must be positive. Leave radius or a bit less is a good choice, so a client checks
+                            only a few cells around its viewpoint.
+        @param fEnterRadius Entity becomes relevant to a client within this distance from its viewpoint, must be positive.
+        @param fLeaveRadius Relevant entity stops being relevant beyond this distance, must not be less than fEnterRadius.
+
+        Throws std::runtime_error if any parameter is invalid.
+    */
+    PgeInterestManager::PgeInterestManager(
+        const float& fCellSize,
+        const float& fEnterRadius,
+        const float& fLeaveRadius) noexcept(false) :
+        m_fCellSize(fCellSize),
+        m_fEnterRadius(fEnterRadius),
+        m_fLeaveRadius(fLeaveRadius),
+        m_nLastUpdateCandidateCount(0)
+    {
+        if (!(fCellSize > 0.f) || !(fEnterRadius > 0.f) || !(fLeaveRadius >= fEnterRadius))
+        {
+            throw std::runtime_error("PgeInterestManager(): cell size and enter radius must be positive, leave radius must not be less than enter radius!");
+        }
+    }
+
+    const float& PgeInterestManager::getCellSize() const
+    {
+        return m_fCellSize;
+    }
+
+    const float& PgeInterestManager::getEnterRadius() const
+    {
+        return m_fEnterRadius;
+    }
+
+    const float& PgeInterestManager::getLeaveRadius() const
+    {
+        return m_fLeaveRadius;
+    }
+
+    /**
+        Adds the given entity or updates its position. Takes effect at next update().
+
+        @param entityId        The entity.
+        @param x               World-space position.
+        @param y               World-space position.
+        @param z               World-space position.
+        @param bAlwaysRelevant If true, the entity is relevant to all clients regardless of its position.
+    */
+    void PgeInterestManager::setEntity(const TEntityId& entityId, const float& x, const float& y, const float& z, const bool& bAlwaysRelevant)
+    {
+        auto it = findEntity(entityId);
+        if ((it == m_vEntities.end()) || (it->m_id != entityId))
+        {
+            it = m_vEntities.insert(it, Entity());
+            it->m_id = entityId;
+            it->m_cellKey = 0;
+        }
+        it->m_x = x;
+        it->m_y = y;
+        it->m_z = z;
+        it->m_bAlwaysRelevant = bAlwaysRelevant;
+    }
+
+    /**
+        Removes the given entity. At next update(), leave events are generated for the clients it was relevant to.
+
+        @return True if the entity was removed, false if it did not exist.
+    */
+    bool PgeInterestManager::removeEntity(const TEntityId& entityId)
+    {
+        const auto it = findEntity(entityId);
+        if ((it == m_vEntities.end()) || (it->m_id != entityId))
+        {
+            return false;
+        }
+        m_vEntities.erase(it);
+        return true;
+    }
+
+    bool PgeInterestManager::hasEntity(const TEntityId& entityId) const
+    {
+        const auto it = findEntity(entityId);
+        return (it != m_vEntities.end()) && (it->m_id == entityId);
+    }
+
+    std::size_t PgeInterestManager::getEntityCount() const
+    {
+        return m_vEntities.size();
+    }
+
+    /**
+        Adds the given client or updates the position of its viewpoint, e.g. the position of the player of the client.
+        Takes effect at next update(), until then nothing is relevant to a newly added client.
+
+        @param connHandle Server-side connection handle of the client.
+        @param x          World-space position.
+        @param y          World-space position.
+        @param z          World-space position.
+    */
+    void PgeInterestManager::setClient(const PgeNetworkConnectionHandle& connHandle, const float& x, const float& y, const float& z)
+    {
+        auto it = findClient(connHandle);
+        if ((it == m_vClients.end()) || (it->m_connHandle != connHandle))
+        {
+            it = m_vClients.insert(it, Client());
+            it->m_connHandle = connHandle;
+        }
+        it->m_x = x;
+        it->m_y = y;
+        it->m_z = z;
+    }
+
+    /**
+        Removes the given client, e.g. when it disconnects. No leave events are generated for the removed client.
+
+        @return True if the client was removed, false if it did not exist.
+    */
+    bool PgeInterestManager::removeClient(const PgeNetworkConnectionHandle& connHandle)
+    {
+        const auto it = findClient(connHandle);
+        if ((it == m_vClients.end()) || (it->m_connHandle != connHandle))
+        {
+            return false;
+        }
+        m_vClients.erase(it);
+        return true;
+    }
+
+    bool PgeInterestManager::hasClient(const PgeNetworkConnectionHandle& connHandle) const
+    {
+        const auto it = findClient(connHandle);
+        return (it != m_vClients.end()) && (it->m_connHandle == connHandle);
+    }
+
+    std::size_t PgeInterestManager::getClientCount() const
+    {
+        return m_vClients.size();
+    }
+
+    /**
+        Recomputes the relevant entities of all clients based on the current positions, and generates the enter and leave events.
+        Expected to be invoked once per tick, after setting the positions and before sending.
+    */
+    void PgeInterestManager::update()
+    {
+        m_vEvents.clear();
+        m_nLastUpdateCandidateCount = 0;
+        rebuildGrid();
+        for (auto& client : m_vClients)
+        {
+            updateClient(client);
+            addEvents(client);
+            client.m_vRelevant.swap(client.m_vRelevantNew);
+        }
+    }
+
+    /**
+        @return Enter and leave events generated by last update(), ordered by client and then by entity.
+    */
+    const std::vector<PgeInterestManager::Event>& PgeInterestManager::getEvents() const
+    {
+        return m_vEvents;
+    }
+
+    /**
+        @param connHandle Server-side connection handle of the client.
+
+        @return Sorted ids of the entities relevant to the given client as computed by last update(), or nullptr if the client is unknown,
+                meaning no filtering for the client. Can be passed to PgeSnapshotSender::sendSnapshot().
+    */
+    const std::vector<PgeInterestManager::TEntityId>* PgeInterestManager::getRelevantEntities(const PgeNetworkConnectionHandle& connHandle) const
+    {
+        const auto it = findClient(connHandle);
+        return ((it == m_vClients.end()) || (it->m_connHandle != connHandle)) ? nullptr : &(it->m_vRelevant);
+    }
+
+    /**
+        @return True if the given entity is relevant to the given client as computed by last update(), or the client is unknown.
+    */
+    bool PgeInterestManager::isRelevant(const PgeNetworkConnectionHandle& connHandle, const TEntityId& entityId) const
+    {
+        const std::vector<TEntityId>* const pvRelevant = getRelevantEntities(connHandle);
+        return !pvRelevant || std::binary_search(pvRelevant->begin(), pvRelevant->end(), entityId);
+    }
+
+    /**
+        @return Number of entities checked for distance by last update(), summed for all clients, for measuring the efficiency of the grid.
+    */
+    uint32_t PgeInterestManager::getLastUpdateCandidateCount() const
+    {
+        return m_nLastUpdateCandidateCount;
+    }
+
+    /**
+        Sends the given packet about the given entity to all clients to which the entity is relevant, and to unknown clients.
+        Uses PgeIServer::sendToAllClientsExcept(), so the packet is still copied only once for all receiving clients.
+
+        @param server   The server instance to be used for sending.
+        @param pkt      The packet to be sent.
+        @param entityId The entity the packet is about.
+    */
+    void PgeInterestManager::sendToRelevantClients(PgeIServer& server, const PgePacket& pkt, const TEntityId& entityId)
+    {
+        m_setExcepts.clear();
+        for (const auto& client : m_vClients)
+        {
+            if (!std::binary_search(client.m_vRelevant.begin(), client.m_vRelevant.end(), entityId))
+            {
+                m_setExcepts.insert(client.m_connHandle);
+            }
+        }
+
+        if (m_setExcepts.empty())
+        {
+            server.sendToAllClientsExcept(pkt);
+        }
+        else
+        {
+            server.sendToAllClientsExcept(pkt, m_setExcepts);
+        }
+    }
+
+
+    // ############################### PRIVATE ###############################
+
+
+    int32_t PgeInterestManager::getCellCoord(const float& fCoord, const float& fCellSize)
+    {
+        const float fCell = std::floor(fCoord / fCellSize);
+        if (!(fCell > static_cast<float>(nCellCoordMin)))
+        {
+            // also NaN ends up here
+            return nCellCoordMin;
+        }
+        if (fCell > static_cast<float>(nCellCoordMax))
+        {
+            return nCellCoordMax;
+        }
+        return static_cast<int32_t>(fCell);
+    }
+
+    /**
+        z is the lowest part of the key, so cells having the same x and y but consecutive z also have consecutive keys,
+        and they can be found by a single range search.
+    */
+    PgeInterestManager::TCellKey PgeInterestManager::getCellKey(const int32_t& cx, const int32_t& cy, const int32_t& cz)
+    {
+        return (static_cast<TCellKey>(cx - nCellCoordMin) << (2 * nCellCoordBits)) |
+            (static_cast<TCellKey>(cy - nCellCoordMin) << nCellCoordBits) |
+            static_cast<TCellKey>(cz - nCellCoordMin);
+    }
+
+    std::vector<PgeInterestManager::Entity>::iterator PgeInterestManager::findEntity(const TEntityId& entityId)
+    {
+        return std::lower_bound(m_vEntities.begin(), m_vEntities.end(), entityId,
+            [](const Entity& entity, const TEntityId& id) { return entity.m_id < id; });
+    }
+
+    std::vector<PgeInterestManager::Entity>::const_iterator PgeInterestManager::findEntity(const TEntityId& entityId) const
+    {
+        return std::lower_bound(m_vEntities.begin(), m_vEntities.end(), entityId,
+            [](const Entity& entity, const TEntityId& id) { return entity.m_id < id; });
+    }
+
+    std::vector<PgeInterestManager::Client>::iterator PgeInterestManager::findClient(const PgeNetworkConnectionHandle& connHandle)
+    {
+        return std::lower_bound(m_vClients.begin(), m_vClients.end(), connHandle,
+            [](const Client& client, const PgeNetworkConnectionHandle& conn) { return client.m_connHandle < conn; });
+    }
+
+    std::vector<PgeInterestManager::Client>::const_iterator PgeInterestManager::findClient(const PgeNetworkConnectionHandle& connHandle) const
+    {
+        return std::lower_bound(m_vClients.begin(), m_vClients.end(), connHandle,
+            [](const Client& client, const PgeNetworkConnectionHandle& conn) { return client.m_connHandle < conn; });
+    }
+
+    /**
+        Computes the cell key of each entity, and sorts the entities by their cell key into m_vCellOrder.
+        Always relevant entities are collected into m_vAlwaysRelevant instead.
+    */
+    void PgeInterestManager::rebuildGrid()
+    {
+        m_vCellOrder.clear();
+        m_vAlwaysRelevant.clear();
+        for (uint32_t i = 0; i < m_vEntities.size(); i++)
+        {
+            Entity& entity = m_vEntities[i];
+            if (entity.m_bAlwaysRelevant)
+            {
+                m_vAlwaysRelevant.push_back(i);
+                continue;
+            }
+            entity.m_cellKey = getCellKey(
+                getCellCoord(entity.m_x, m_fCellSize),
+                getCellCoord(entity.m_y, m_fCellSize),
+                getCellCoord(entity.m_z, m_fCellSize));
+            m_vCellOrder.push_back(i);
+        }
+
+        std::sort(m_vCellOrder.begin(), m_vCellOrder.end(), [this](const uint32_t& a, const uint32_t& b) {
+            return m_vEntities[a].m_cellKey < m_vEntities[b].m_cellKey;
+            });
+    }
+
+    /**
+        Builds client.m_vRelevantNew from the always relevant entities and the entities in the cells overlapping the leave radius
+        around the client's viewpoint, with hysteresis based on client.m_vRelevant.
+    */
+    void PgeInterestManager::updateClient(Client& client)
+    {
+        client.m_vRelevantNew.clear();
+        for (const auto& iEntity : m_vAlwaysRelevant)
+        {
+            client.m_vRelevantNew.push_back(m_vEntities[iEntity].m_id);
+        }
+
+        const float fEnterRadius2 = m_fEnterRadius * m_fEnterRadius;
+        const float fLeaveRadius2 = m_fLeaveRadius * m_fLeaveRadius;
+        const int32_t czMin = getCellCoord(client.m_z - m_fLeaveRadius, m_fCellSize);
+        const int32_t czMax = getCellCoord(client.m_z + m_fLeaveRadius, m_fCellSize);
+        const int32_t cyMin = getCellCoord(client.m_y - m_fLeaveRadius, m_fCellSize);
+        const int32_t cyMax = getCellCoord(client.m_y + m_fLeaveRadius, m_fCellSize);
+        const int32_t cxMin = getCellCoord(client.m_x - m_fLeaveRadius, m_fCellSize);
+        const int32_t cxMax = getCellCoord(client.m_x + m_fLeaveRadius, m_fCellSize);
+
+        const auto lessKey = [this](const uint32_t& iEntity, const TCellKey& key) { return m_vEntities[iEntity].m_cellKey < key; };
+        const auto keyLess = [this](const TCellKey& key, const uint32_t& iEntity) { return key < m_vEntities[iEntity].m_cellKey; };
+        for (int32_t cx = cxMin; cx <= cxMax; cx++)
+        {
+            for (int32_t cy = cyMin; cy <= cyMax; cy++)
+            {
+                const auto itBegin = std::lower_bound(m_vCellOrder.begin(), m_vCellOrder.end(), getCellKey(cx, cy, czMin), lessKey);
+                const auto itEnd = std::upper_bound(itBegin, m_vCellOrder.end(), getCellKey(cx, cy, czMax), keyLess);
+                for (auto it = itBegin; it != itEnd; ++it)
+                {
+                    const Entity& entity = m_vEntities[*it];
+                    const float dx = entity.m_x - client.m_x;
+                    const float dy = entity.m_y - client.m_y;
+                    const float dz = entity.m_z - client.m_z;
+                    const float fDist2 = dx * dx + dy * dy + dz * dz;
+                    ++m_nLastUpdateCandidateCount;
+
+                    if ((fDist2 <= fEnterRadius2) ||
+                        ((fDist2 <= fLeaveRadius2) && std::binary_search(client.m_vRelevant.begin(), client.m_vRelevant.end(), entity.m_id)))
+                    {
+                        client.m_vRelevantNew.push_back(entity.m_id);
+                    }
+                }
+            }
+        }
+
+        std::sort(client.m_vRelevantNew.begin(), client.m_vRelevantNew.end());
+    }
+
+    /**
+        Adds the enter and leave events of the given client, by comparing its old and new relevant entities.
+    */
+    void PgeInterestManager::addEvents(const Client& client)
+    {
+        // both vectors are sorted, so a single merge-like iteration finds the differences
+        const std::vector<TEntityId>& vOld = client.m_vRelevant;
+        const std::vector<TEntityId>& vNew = client.m_vRelevantNew;
+        std::size_t iOld = 0;
+        std::size_t iNew = 0;
+        while ((iOld < vOld.size()) || (iNew < vNew.size()))
+        {
+            if ((iOld == vOld.size()) || ((iNew < vNew.size()) && (vNew[iNew] < vOld[iOld])))
+            {
+                m_vEvents.push_back(Event{ Event::Type::Enter, client.m_connHandle, vNew[iNew] });
+                ++iNew;
+            }
+            else if ((iNew == vNew.size()) || (vOld[iOld] < vNew[iNew]))
+            {
+                m_vEvents.push_back(Event{ Event::Type::Leave, client.m_connHandle, vOld[iOld] });
+                ++iOld;
+            }
+            else
+            {
+                ++iOld;
+                ++iNew;
+            }
+        }
+    }
+
+} // namespace pge_network
@@ -0,0 +1,158 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeInterestManager.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine server-side area-of-interest management
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+#include "PgeIServer.h"
+#include "PgePacket.h"
+#include "PgeSnapshot.h"
+
+namespace pge_network
+{
+
+    /**
+        Server-side area-of-interest management: decides which replicated entities are relevant to which client, so that
+        updates of an entity are sent only to the clients that could see or hear it.
+
+        The application registers the replicated entities and the clients' viewpoints with their positions, typically every tick,
+        then invokes update(), which computes the set of relevant entities of each client:
+         - an entity becomes relevant to a client when it is within the enter radius of the client's viewpoint;
+         - a relevant entity stops being relevant when it gets farther than the leave radius.
+        Leave radius is not less than enter radius, so an entity moving around the border of the area does not flip in and out
+        of relevancy every tick. Entities can also be marked always relevant, e.g. game state or scoreboard entities.
+        Changes of relevancy are reported as enter and leave events by getEvents(), e.g. for spawning and despawning the entity
+        on the client side.
+
+        Entities are indexed by a uniform grid: update() sorts the entities by their cell, then each client checks only the
+        entities in the cells overlapping the leave radius around its viewpoint. Entity, cell and relevancy vectors are reused
+        between updates, so once the number of entities and clients settles, update() does not allocate.
+
+        Relevancy is used by:
+         - sendToRelevantClients(): sends a packet about an entity to relevant clients only;
+         - PgeSnapshotSender::sendSnapshot(): encodes only the relevant entities of the client, given by getRelevantEntities().
+        Clients not registered by setClient() are not filtered, they receive everything.
+
+        Entity ids are the same as in PgeSnapshot. Positions are in world space, for a 2D game z can be left 0.
+    */
+    class PgeInterestManager
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeInterestManager is included")
+#endif
+
+    public:
+
+        typedef PgeSnapshot::TEntityId TEntityId;
+
+        /**
+            Change of relevancy of an entity to a client, generated by update().
+        */
+        struct Event
+        {
+            enum class Type : uint8_t
+            {
+                Enter = 0,  /**< Entity became relevant to the client. */
+                Leave       /**< Entity stopped being relevant to the client, or it was removed. */
+            };
+
+            Type m_type;
+            PgeNetworkConnectionHandle m_connHandle;
+            TEntityId m_entityId;
+        };
+
+        // ---------------------------------------------------------------------------
+
+        PgeInterestManager(
+            const float& fCellSize,
+            const float& fEnterRadius,
+            const float& fLeaveRadius) noexcept(false);
+        ~PgeInterestManager() = default;
+
+        PgeInterestManager(const PgeInterestManager&) = delete;
+        PgeInterestManager& operator=(const PgeInterestManager&) = delete;
+        PgeInterestManager(PgeInterestManager&&) = delete;
+        PgeInterestManager& operator=(PgeInterestManager&&) = delete;
+
+        const float& getCellSize() const;
+        const float& getEnterRadius() const;
+        const float& getLeaveRadius() const;
+
+        void setEntity(const TEntityId& entityId, const float& x, const float& y, const float& z, const bool& bAlwaysRelevant = false);
+        bool removeEntity(const TEntityId& entityId);
+        bool hasEntity(const TEntityId& entityId) const;
+        std::size_t getEntityCount() const;
+
+        void setClient(const PgeNetworkConnectionHandle& connHandle, const float& x, const float& y, const float& z);
+        bool removeClient(const PgeNetworkConnectionHandle& connHandle);
+        bool hasClient(const PgeNetworkConnectionHandle& connHandle) const;
+        std::size_t getClientCount() const;
+
+        void update();
+
+        const std::vector<Event>& getEvents() const;
+        const std::vector<TEntityId>* getRelevantEntities(const PgeNetworkConnectionHandle& connHandle) const;
+        bool isRelevant(const PgeNetworkConnectionHandle& connHandle, const TEntityId& entityId) const;
+        uint32_t getLastUpdateCandidateCount() const;
+
+        void sendToRelevantClients(PgeIServer& server, const PgePacket& pkt, const TEntityId& entityId);
+
+    private:
+
+        typedef uint64_t TCellKey;
+
+        struct Entity
+        {
+            TEntityId m_id;
+            float m_x, m_y, m_z;
+            bool m_bAlwaysRelevant;
+            TCellKey m_cellKey;  /**< Valid only during update(). */
+        };
+
+        struct Client
+        {
+            PgeNetworkConnectionHandle m_connHandle;
+            float m_x, m_y, m_z;
+            std::vector<TEntityId> m_vRelevant;      /**< Sorted, result of last update(). */
+            std::vector<TEntityId> m_vRelevantNew;   /**< Sorted, being built by update(), then swapped with m_vRelevant. */
+        };
+
+        const float m_fCellSize;
+        const float m_fEnterRadius;
+        const float m_fLeaveRadius;
+
+        std::vector<Entity> m_vEntities;        /**< Sorted by id. */
+        std::vector<Client> m_vClients;         /**< Sorted by connection handle. */
+        std::vector<uint32_t> m_vCellOrder;     /**< Indices into m_vEntities, sorted by cell key, rebuilt by update(). */
+        std::vector<uint32_t> m_vAlwaysRelevant;  /**< Indices into m_vEntities of always relevant entities, rebuilt by update(). */
+        std::vector<Event> m_vEvents;           /**< Events of last update(). */
+        uint32_t m_nLastUpdateCandidateCount;
+        std::set<PgeNetworkConnectionHandle> m_setExcepts;  /**< Reused by sendToRelevantClients(). */
+
+        static int32_t getCellCoord(const float& fCoord, const float& fCellSize);
+        static TCellKey getCellKey(const int32_t& cx, const int32_t& cy, const int32_t& cz);
+
+        std::vector<Entity>::iterator findEntity(const TEntityId& entityId);
+        std::vector<Entity>::const_iterator findEntity(const TEntityId& entityId) const;
+        std::vector<Client>::iterator findClient(const PgeNetworkConnectionHandle& connHandle);
+        std::vector<Client>::const_iterator findClient(const PgeNetworkConnectionHandle& connHandle) const;
+
+        void rebuildGrid();
+        void updateClient(Client& client);
+        void addEvents(const Client& client);
+
+    }; // class PgeInterestManager
+
+} // namespace pge_network
@@ -0,0 +1,417 @@
+/*
+    ###################################################################################
+    PgeLagCompensation.cpp
+    This file is part of PGE.
+    PR00F's Game Engine server-side lag compensation history for hit validation
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgeLagCompensation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace pge_network
+{
+
+    PgeLagCompensation::PgeLagCompensation(
+        const std::size_t& nMaxPlayers,
+        const std::size_t& nHistoryTickCount) noexcept(false) :
+        m_nMaxPlayers(nMaxPlayers),
+        m_nHistoryTickCount(nHistoryTickCount),
+        m_iOldestTick(0),
+        m_nTickCount(0),
+        m_nQueryCount(0),
+        m_nClampedQueryCount(0)
+    {
+        if (nMaxPlayers == 0)
+        {
+            throw std::runtime_error("PgeLagCompensation::PgeLagCompensation(): zero nMaxPlayers!");
+        }
+        if (nHistoryTickCount < 2)
+        {
+            throw std::runtime_error("PgeLagCompensation::PgeLagCompensation(): nHistoryTickCount is less than 2!");
+        }
+        m_vTicks.resize(nHistoryTickCount);
+        m_vRecords.resize(nHistoryTickCount * nMaxPlayers);
+    }
+
+    const std::size_t& PgeLagCompensation::getMaxPlayers() const
+    {
+        return m_nMaxPlayers;
+    }
+
+    const std::size_t& PgeLagCompensation::getHistoryTickCount() const
+    {
+        return m_nHistoryTickCount;
+    }
+
+    /**
+        Starts recording a new tick, overwriting the oldest one if history is full.
+        Players are added to the new tick by addPlayer().
+
+        @return True on success, false if the given time is not newer than the time of the last recorded tick.
+    */
+    bool PgeLagCompensation::beginTick(const TTimeUSecs& nServerTimeUSecs)
+    {
+        if ((m_nTickCount > 0) && (nServerTimeUSecs <= getNewestTimeUSecs()))
+        {
+            return false;
+        }
+
+        if (m_nTickCount == m_nHistoryTickCount)
+        {
+            m_iOldestTick = (m_iOldestTick + 1) % m_nHistoryTickCount;
+            --m_nTickCount;
+        }
+        Tick& tick = m_vTicks[getTickIndex(m_nTickCount)];
+        tick.m_nTimeUSecs = nServerTimeUSecs;
+        tick.m_nRecordCount = 0;
+        ++m_nTickCount;
+        return true;
+    }
+
+    /**
+        Records the bounding box of the given player in the tick started by the last beginTick().
+
+        @return True on success, false if no tick was started or the tick already has the maximum number of players.
+    */
+    bool PgeLagCompensation::addPlayer(const TEntityId& entityId, const PureAxisAlignedBoundingBox& aabb)
+    {
+        if (m_nTickCount == 0)
+        {
+            return false;
+        }
+
+        const std::size_t iTick = getTickIndex(m_nTickCount - 1);
+        Tick& tick = m_vTicks[iTick];
+        if (tick.m_nRecordCount == m_nMaxPlayers)
+        {
+            return false;
+        }
+
+        Record& record = m_vRecords[iTick * m_nMaxPlayers + tick.m_nRecordCount];
+        record.m_id = entityId;
+        for (TPureByte i = 0; i < 3; i++)
+        {
+            const float fHalfSize = aabb.getSizeVec()[i] / 2.f;
+            record.m_min[i] = aabb.getPosVec()[i] - fHalfSize;
+            record.m_max[i] = aabb.getPosVec()[i] + fHalfSize;
+        }
+        ++tick.m_nRecordCount;
+        return true;
+    }
+
+    void PgeLagCompensation::clear()
+    {
+        m_iOldestTick = 0;
+        m_nTickCount = 0;
+    }
+
+    std::size_t PgeLagCompensation::getRecordedTickCount() const
+    {
+        return m_nTickCount;
+    }
+
+    /**
+        @return Time of the oldest recorded tick, 0 if no tick is recorded.
+    */
+    PgeLagCompensation::TTimeUSecs PgeLagCompensation::getOldestTimeUSecs() const
+    {
+        return (m_nTickCount == 0) ? 0 : m_vTicks[getTickIndex(0)].m_nTimeUSecs;
+    }
+
+    /**
+        @return Time of the newest recorded tick, 0 if no tick is recorded.
+    */
+    PgeLagCompensation::TTimeUSecs PgeLagCompensation::getNewestTimeUSecs() const
+    {
+        return (m_nTickCount == 0) ? 0 : m_vTicks[getTickIndex(m_nTickCount - 1)].m_nTimeUSecs;
+    }
+
+    /**
+        Gets the bounding box of the given player at the given time, interpolated between the recorded ticks around it.
+
+        @return True if the player was recorded at that time, false otherwise.
+    */
+    bool PgeLagCompensation::getPlayerBox(const TEntityId& entityId, const TTimeUSecs& nViewTimeUSecs, PureAxisAlignedBoundingBox& aabb) const
+    {
+        Span span;
+        if (!findSpan(nViewTimeUSecs, span))
+        {
+            return false;
+        }
+
+        const Record* const pRecordFrom = findRecord(span.m_iTickFrom, *span.m_pTickFrom, entityId);
+        if (!pRecordFrom)
+        {
+            return false;
+        }
+
+        Record record;
+        getRecordAt(span, *pRecordFrom, record);
+        aabb = PureAxisAlignedBoundingBox(
+            PureVector(
+                (record.m_min[0] + record.m_max[0]) / 2.f,
+                (record.m_min[1] + record.m_max[1]) / 2.f,
+                (record.m_min[2] + record.m_max[2]) / 2.f),
+            PureVector(
+                record.m_max[0] - record.m_min[0],
+                record.m_max[1] - record.m_min[1],
+                record.m_max[2] - record.m_min[2]));
+        return true;
+    }
+
+    /**
+        Finds the first player hit by the given segment at the given view time, e.g. the segment a bullet travels in a tick.
+        The shooter is ignored, so a shot starting inside its own box does not hit itself.
+
+        @return True if a player is hit, in which case hit is filled, false otherwise.
+    */
+    bool PgeLagCompensation::findHitBySegment(
+        const TTimeUSecs& nViewTimeUSecs,
+        const PureVector& vecStart,
+        const PureVector& vecEnd,
+        const TEntityId& shooterId,
+        Hit& hit) const
+    {
+        ++m_nQueryCount;
+        Span span;
+        if (!findSpan(nViewTimeUSecs, span))
+        {
+            return false;
+        }
+
+        const float start[3] = { vecStart.getX(), vecStart.getY(), vecStart.getZ() };
+        const float delta[3] = { vecEnd.getX() - start[0], vecEnd.getY() - start[1], vecEnd.getZ() - start[2] };
+        float invDelta[3];
+        for (int i = 0; i < 3; i++)
+        {
+            // 0 marks the segment being parallel to the slabs of this axis
+            invDelta[i] = (std::abs(delta[i]) < 1e-12f) ? 0.f : (1.f / delta[i]);
+        }
+        bool bHit = false;
+        float fHitFraction = 1.f;
+        const Record* const pRecordsFrom = &m_vRecords[span.m_iTickFrom * m_nMaxPlayers];
+        for (std::size_t i = 0; i < span.m_pTickFrom->m_nRecordCount; i++)
+        {
+            if (pRecordsFrom[i].m_id == shooterId)
+            {
+                continue;
+            }
+
+            Record record;
+            getRecordAt(span, pRecordsFrom[i], record);
+            float fFraction;
+            if (intersectSegment(start, invDelta, record.m_min, record.m_max, fFraction) && (!bHit || (fFraction < fHitFraction)))
+            {
+                bHit = true;
+                fHitFraction = fFraction;
+                hit.m_entityId = record.m_id;
+            }
+        }
+
+        if (bHit)
+        {
+            hit.m_fFraction = fHitFraction;
+            hit.m_pos.Set(
+                start[0] + delta[0] * fHitFraction,
+                start[1] + delta[1] * fHitFraction,
+                start[2] + delta[2] * fHitFraction);
+        }
+        return bHit;
+    }
+
+    /**
+        Same as findHitBySegment(), for a hitscan weapon: the segment starts at the given origin and goes in the given direction
+        up to the given distance. The direction does not need to be normalized.
+    */
+    bool PgeLagCompensation::findHitByRay(
+        const TTimeUSecs& nViewTimeUSecs,
+        const PureVector& vecOrigin,
+        const PureVector& vecDir,
+        const float& fMaxDistance,
+        const TEntityId& shooterId,
+        Hit& hit) const
+    {
+        const float fLength = vecDir.getLength();
+        if (fLength == 0.f)
+        {
+            ++m_nQueryCount;
+            return false;
+        }
+        return findHitBySegment(nViewTimeUSecs, vecOrigin, vecOrigin + vecDir * (fMaxDistance / fLength), shooterId, hit);
+    }
+
+    uint32_t PgeLagCompensation::getQueryCount() const
+    {
+        return m_nQueryCount;
+    }
+
+    /**
+        @return Number of queries with view time older than the oldest recorded tick, e.g. due to a client with too high latency.
+    */
+    uint32_t PgeLagCompensation::getClampedQueryCount() const
+    {
+        return m_nClampedQueryCount;
+    }
+
+
+    // ############################## PRIVATE ##############################
+
+
+    /**
+        Slab test of the segment start + fraction * delta, fraction in [0, 1], against the given box.
+        Inverse of delta is given so it is computed once per query instead of once per box, 0 means the segment is parallel to the axis.
+
+        @return True if the segment intersects the box, in which case fFraction is where it enters the box, 0 if it starts inside.
+    */
+    bool PgeLagCompensation::intersectSegment(
+        const float* const start,
+        const float* const invDelta,
+        const float* const boxMin,
+        const float* const boxMax,
+        float& fFraction)
+    {
+        float fEnter = 0.f;
+        float fExit = 1.f;
+        for (int i = 0; i < 3; i++)
+        {
+            if (invDelta[i] == 0.f)
+            {
+                // parallel to the slab
+                if ((start[i] < boxMin[i]) || (start[i] > boxMax[i]))
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            float fNear = (boxMin[i] - start[i]) * invDelta[i];
+            float fFar = (boxMax[i] - start[i]) * invDelta[i];
+            if (fNear > fFar)
+            {
+                std::swap(fNear, fFar);
+            }
+            fEnter = std::max(fEnter, fNear);
+            fExit = std::min(fExit, fFar);
+            if (fEnter > fExit)
+            {
+                return false;
+            }
+        }
+
+        fFraction = fEnter;
+        return true;
+    }
+
+    std::size_t PgeLagCompensation::getTickIndex(const std::size_t& i) const
+    {
+        return (m_iOldestTick + i) % m_nHistoryTickCount;
+    }
+
+    /**
+        Finds the 2 recorded ticks around the given view time, clamped to the recorded history.
+    */
+    bool PgeLagCompensation::findSpan(const TTimeUSecs& nViewTimeUSecs, Span& span) const
+    {
+        if (m_nTickCount == 0)
+        {
+            return false;
+        }
+
+        // binary search for the last tick not newer than view time
+        std::size_t iFrom = 0;
+        if (nViewTimeUSecs < getOldestTimeUSecs())
+        {
+            ++m_nClampedQueryCount;
+        }
+        else
+        {
+            std::size_t iLow = 0;
+            std::size_t iHigh = m_nTickCount - 1;
+            while (iLow < iHigh)
+            {
+                const std::size_t iMid = (iLow + iHigh + 1) / 2;
+                if (m_vTicks[getTickIndex(iMid)].m_nTimeUSecs <= nViewTimeUSecs)
+                {
+                    iLow = iMid;
+                }
+                else
+                {
+                    iHigh = iMid - 1;
+                }
+            }
+            iFrom = iLow;
+        }
+
+        span.m_iTickFrom = getTickIndex(iFrom);
+        span.m_pTickFrom = &m_vTicks[span.m_iTickFrom];
+        if ((iFrom + 1 == m_nTickCount) || (nViewTimeUSecs <= span.m_pTickFrom->m_nTimeUSecs))
+        {
+            span.m_iTickTo = span.m_iTickFrom;
+            span.m_pTickTo = span.m_pTickFrom;
+            span.m_t = 0.f;
+        }
+        else
+        {
+            span.m_iTickTo = getTickIndex(iFrom + 1);
+            span.m_pTickTo = &m_vTicks[span.m_iTickTo];
+            span.m_t = static_cast<float>(nViewTimeUSecs - span.m_pTickFrom->m_nTimeUSecs) /
+                static_cast<float>(span.m_pTickTo->m_nTimeUSecs - span.m_pTickFrom->m_nTimeUSecs);
+        }
+        return true;
+    }
+
+    const PgeLagCompensation::Record* PgeLagCompensation::findRecord(const std::size_t& iTick, const Tick& tick, const TEntityId& entityId) const
+    {
+        const Record* const pRecords = &m_vRecords[iTick * m_nMaxPlayers];
+        for (std::size_t i = 0; i < tick.m_nRecordCount; i++)
+        {
+            if (pRecords[i].m_id == entityId)
+            {
+                return &pRecords[i];
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+        Interpolates the given record of the older tick of the span towards the record of the same player in the newer tick.
+        A player missing from the newer tick, e.g. because it died, keeps its box of the older tick.
+
+        @return True if the player is in both ticks, false otherwise.
+    */
+    bool PgeLagCompensation::getRecordAt(const Span& span, const Record& recordFrom, Record& record) const
+    {
+        record = recordFrom;
+        if (span.m_pTickTo == span.m_pTickFrom)
+        {
+            return true;
+        }
+
+        // players are usually added in the same order every tick, so first check the same slot in the newer tick
+        const std::size_t iSlot = &recordFrom - &m_vRecords[span.m_iTickFrom * m_nMaxPlayers];
+        const Record* pRecordTo = &m_vRecords[span.m_iTickTo * m_nMaxPlayers + iSlot];
+        if ((iSlot >= span.m_pTickTo->m_nRecordCount) || (pRecordTo->m_id != recordFrom.m_id))
+        {
+            pRecordTo = findRecord(span.m_iTickTo, *span.m_pTickTo, recordFrom.m_id);
+            if (!pRecordTo)
+            {
+                return false;
+            }
+        }
+
+        for (int i = 0; i < 3; i++)
+        {
+            record.m_min[i] += (pRecordTo->m_min[i] - recordFrom.m_min[i]) * span.m_t;
+            record.m_max[i] += (pRecordTo->m_max[i] - recordFrom.m_max[i]) * span.m_t;
+        }
+        return true;
+    }
+
+} // namespace pge_network
@@ -0,0 +1,152 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeLagCompensation.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine server-side lag compensation history for hit validation
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "../Pure/include/internal/SpatialStructures/PureAxisAlignedBoundingBox.h"
+#include "PgeSnapshot.h"
+
+namespace pge_network
+{
+
+    /**
+        Server-side lag compensation: keeps the bounding boxes of players for the last ticks, so a shot can be validated against
+        where the players were when the shooter saw them, instead of where they are on the server now. With 50-150 ms ping the
+        difference is easily bigger than a player, so without rewinding, players either miss targets they aimed at properly, or
+        the server has to trust the hits reported by clients.
+
+        Every tick the application invokes beginTick() with the current server time, then addPlayer() for each player with its
+        current bounding box. When a player shoots, the server estimates the time the shooter was seeing, usually server time minus
+        the shooter's one-way latency and its interpolation delay, e.g. PgeSnapshotInterpolator::getRenderTimeUSecs() on the client,
+        then findHitBySegment() or findHitByRay() finds the first player hit at that time. Boxes are interpolated between the 2
+        recorded ticks around the view time. View times older than the oldest recorded tick are clamped to it, so how far a client
+        can rewind is bounded by the history length.
+
+        History is a fixed-size ring of ticks, and the boxes of each tick are stored contiguously in a single preallocated vector,
+        so a query is a linear scan over 2 short arrays, and recording does not allocate.
+
+        Entity ids are the same as in PgeSnapshot. Positions are in world space.
+    */
+    class PgeLagCompensation
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeLagCompensation is included")
+#endif
+
+    public:
+
+        typedef PgeSnapshot::TEntityId TEntityId;
+        typedef int64_t TTimeUSecs;
+
+        struct Hit
+        {
+            TEntityId m_entityId;
+            float m_fFraction;      /**< Position of the hit along the segment, 0 is the start, 1 is the end. */
+            PureVector m_pos;       /**< World-space position where the segment enters the box. */
+        };
+
+        // ---------------------------------------------------------------------------
+
+        PgeLagCompensation(
+            const std::size_t& nMaxPlayers,
+            const std::size_t& nHistoryTickCount) noexcept(false);
+        ~PgeLagCompensation() = default;
+
+        PgeLagCompensation(const PgeLagCompensation&) = delete;
+        PgeLagCompensation& operator=(const PgeLagCompensation&) = delete;
+        PgeLagCompensation(PgeLagCompensation&&) = delete;
+        PgeLagCompensation& operator=(PgeLagCompensation&&) = delete;
+
+        const std::size_t& getMaxPlayers() const;
+        const std::size_t& getHistoryTickCount() const;
+
+        bool beginTick(const TTimeUSecs& nServerTimeUSecs);
+        bool addPlayer(const TEntityId& entityId, const PureAxisAlignedBoundingBox& aabb);
+        void clear();
+
+        std::size_t getRecordedTickCount() const;
+        TTimeUSecs getOldestTimeUSecs() const;
+        TTimeUSecs getNewestTimeUSecs() const;
+
+        bool getPlayerBox(const TEntityId& entityId, const TTimeUSecs& nViewTimeUSecs, PureAxisAlignedBoundingBox& aabb) const;
+
+        bool findHitBySegment(
+            const TTimeUSecs& nViewTimeUSecs,
+            const PureVector& vecStart,
+            const PureVector& vecEnd,
+            const TEntityId& shooterId,
+            Hit& hit) const;
+        bool findHitByRay(
+            const TTimeUSecs& nViewTimeUSecs,
+            const PureVector& vecOrigin,
+            const PureVector& vecDir,
+            const float& fMaxDistance,
+            const TEntityId& shooterId,
+            Hit& hit) const;
+
+        uint32_t getQueryCount() const;
+        uint32_t getClampedQueryCount() const;
+
+    private:
+
+        /** Box stored as min and max corners, so the segment test does not need to compute them from center and size. */
+        struct Record
+        {
+            TEntityId m_id;
+            float m_min[3];
+            float m_max[3];
+        };
+
+        struct Tick
+        {
+            TTimeUSecs m_nTimeUSecs;
+            std::size_t m_nRecordCount;
+        };
+
+        /** The 2 recorded ticks to interpolate between for a view time. */
+        struct Span
+        {
+            const Tick* m_pTickFrom;
+            const Tick* m_pTickTo;
+            std::size_t m_iTickFrom;
+            std::size_t m_iTickTo;
+            float m_t;
+        };
+
+        const std::size_t m_nMaxPlayers;
+        const std::size_t m_nHistoryTickCount;
+
+        std::vector<Tick> m_vTicks;          /**< Ring buffer in increasing time order. */
+        std::vector<Record> m_vRecords;      /**< m_nMaxPlayers records for each tick, records of tick i start at i * m_nMaxPlayers. */
+        std::size_t m_iOldestTick;
+        std::size_t m_nTickCount;
+        mutable uint32_t m_nQueryCount;
+        mutable uint32_t m_nClampedQueryCount;
+
+        static bool intersectSegment(
+            const float* const start,
+            const float* const invDelta,
+            const float* const boxMin,
+            const float* const boxMax,
+            float& fFraction);
+
+        std::size_t getTickIndex(const std::size_t& i) const;
+        bool findSpan(const TTimeUSecs& nViewTimeUSecs, Span& span) const;
+        const Record* findRecord(const std::size_t& iTick, const Tick& tick, const TEntityId& entityId) const;
+        bool getRecordAt(const Span& span, const Record& recordFrom, Record& record) const;
+
+    }; // class PgeLagCompensation
+
+} // namespace pge_network
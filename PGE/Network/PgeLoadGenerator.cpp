@@ -0,0 +1,358 @@
+/*
+    ###################################################################################
+    PgeLoadGenerator.cpp
+    This file is part of PGE.
+    PR00F's Game Engine simulated client load generator
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgeLoadGenerator.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace pge_network {
+
+    /**
+        Server-side counterpart of the round-trip time probing: if the given packet is a probe sent by a PgeLoadGenerator client,
+        sends it back to the sender client together with the given server tick duration.
+        The sender client is identified by the server-side connection handle of the packet.
+
+        @param server           The server instance to be used for sending the reply.
+        @param pkt              The received packet.
+        @param msgIdProbe       App message id given to PgeLoadGenerator as probe message id.
+        @param nServerTickUSecs Duration of the last completed server tick.
+
+        @return True if the given packet is a probe, false otherwise.
+    */
+    bool PgeLoadGenerator::handleProbePkt(
+        PgeIServerClient& server,
+        const PgePacket& pkt,
+        const MsgApp::TMsgId& msgIdProbe,
+        const uint32_t& nServerTickUSecs)
+    {
+        if ((PgePacket::getPacketId(pkt) != PgePktId::Application) || (PgePacket::getMsgAppIdFromPkt(pkt) != msgIdProbe))
+        {
+            return false;
+        }
+
+        const MsgApp& msgApp = *PgePacket::getMsgAppFromPkt(pkt);
+        if (MsgApp::getMsgAppDataActualSizeBytes(msgApp) != sizeof(MsgLoadGenProbe))
+        {
+            CConsole::getConsoleInstance("PgeLoadGenerator").EOLn("%s: invalid probe size %u!", __func__, MsgApp::getMsgAppDataActualSizeBytes(msgApp));
+            return true;
+        }
+
+        MsgLoadGenProbe probe;
+        memcpy(&probe, MsgApp::getMsgAppData(msgApp), sizeof(probe));
+        probe.m_nServerTickUSecs = nServerTickUSecs;
+
+        PgePacket pktReply;
+        PgePacket::initPktMsgApp(pktReply, ServerConnHandle, PgePacket::AutoFill::NONE);
+        TByte* const pData = PgePacket::preparePktMsgAppFill(pktReply, msgIdProbe, sizeof(MsgLoadGenProbe));
+        if (!pData)
+        {
+            CConsole::getConsoleInstance("PgeLoadGenerator").EOLn("%s: preparePktMsgAppFill() failed!", __func__);
+            return true;
+        }
+        memcpy(pData, &probe, sizeof(probe));
+        server.send(pktReply, PgePacket::getServerSideConnectionHandle(pkt));
+        return true;
+    }
+
+    /**
+        @param msgIdInput      App message id to be used for sending MsgLoadGenInput.
+        @param msgIdProbe      App message id to be used for sending MsgLoadGenProbe.
+                               Throws std::runtime_error if equals to msgIdInput.
+        @param pattern         Input pattern of all clients.
+                               Throws std::runtime_error if weapon count or probe period is 0.
+        @param nTimeUSecs      Current time, statistics are collected from this moment.
+        @param nSeed           Seed of the phase offsets of clients.
+        @param nSampleCapacity Max number of most recent round-trip time and server tick samples kept for the report.
+                               Throws std::runtime_error if 0.
+    */
+    PgeLoadGenerator::PgeLoadGenerator(
+        const MsgApp::TMsgId& msgIdInput,
+        const MsgApp::TMsgId& msgIdProbe,
+        const Pattern& pattern,
+        const TTimeUSecs& nTimeUSecs,
+        const uint64_t& nSeed,
+        const std::size_t& nSampleCapacity) noexcept(false) :
+        m_msgIdInput(msgIdInput),
+        m_msgIdProbe(msgIdProbe),
+        m_pattern(pattern),
+        m_nSampleCapacity(nSampleCapacity),
+        m_nRandomState(nSeed),
+        m_nStatsStartUSecs(nTimeUSecs),
+        m_nTxMsgCount(0),
+        m_nRxMsgCount(0),
+        m_nDisconnectCount(0),
+        m_rttSamples{ {}, 0 },
+        m_serverTickSamples{ {}, 0 }
+    {
+        if (msgIdInput == msgIdProbe)
+        {
+            throw std::runtime_error("PgeLoadGenerator(): input and probe app message ids must differ!");
+        }
+        if ((pattern.m_nWeaponCount == 0) || (pattern.m_nProbePeriod == 0) || (nSampleCapacity == 0))
+        {
+            throw std::runtime_error("PgeLoadGenerator(): weapon count, probe period and sample capacity must be positive!");
+        }
+    }
+
+    const MsgApp::TMsgId& PgeLoadGenerator::getMsgIdInput() const
+    {
+        return m_msgIdInput;
+    }
+
+    const MsgApp::TMsgId& PgeLoadGenerator::getMsgIdProbe() const
+    {
+        return m_msgIdProbe;
+    }
+
+    const PgeLoadGenerator::Pattern& PgeLoadGenerator::getPattern() const
+    {
+        return m_pattern;
+    }
+
+    /**
+        Adds the given client to the simulated players.
+        The client is expected to be initialized, and connected or connecting to the server. It must outlive this instance.
+        The probe message id is allow-listed on the client.
+    */
+    void PgeLoadGenerator::addClient(PgeIClient& client)
+    {
+        client.getAllowListedAppMessages().insert(m_msgIdProbe);
+
+        Client c;
+        c.m_pClient = &client;
+        c.m_nTick = 0;
+        c.m_nPhase = static_cast<uint32_t>(nextRandom() % 65536u);
+        c.m_iWeapon = 0;
+        c.m_bJoined = false;
+        m_vClients.push_back(c);
+    }
+
+    std::size_t PgeLoadGenerator::getClientCount() const
+    {
+        return m_vClients.size();
+    }
+
+    std::size_t PgeLoadGenerator::getJoinedClientCount() const
+    {
+        return static_cast<std::size_t>(std::count_if(m_vClients.begin(), m_vClients.end(), [](const Client& c) { return c.m_bJoined; }));
+    }
+
+    /**
+        Executes an input tick of all clients: updates the client, processes received packets, sends input and probe if due,
+        then flushes the batched packets of the client.
+
+        @param nTimeUSecs Current time, used for measuring round-trip time.
+    */
+    void PgeLoadGenerator::update(const TTimeUSecs& nTimeUSecs)
+    {
+        for (auto& client : m_vClients)
+        {
+            client.m_pClient->Update();
+            drainPackets(client, nTimeUSecs);
+
+            ++client.m_nTick;
+            if (client.m_bJoined)
+            {
+                sendInput(client);
+            }
+            if (((client.m_nTick + client.m_nPhase) % m_pattern.m_nProbePeriod) == 0)
+            {
+                sendProbe(client, nTimeUSecs);
+            }
+
+            client.m_pClient->flushBatchedPackets();
+        }
+    }
+
+    /**
+        @param nTimeUSecs Current time, message rates are calculated until this moment.
+
+        @return Statistics collected since construction or last resetStats().
+    */
+    PgeLoadGenerator::Report PgeLoadGenerator::getReport(const TTimeUSecs& nTimeUSecs) const
+    {
+        Report report;
+        report.m_nClientCount = getClientCount();
+        report.m_nJoinedClientCount = getJoinedClientCount();
+        report.m_nDurationUSecs = nTimeUSecs - m_nStatsStartUSecs;
+        report.m_nTxMsgCount = m_nTxMsgCount;
+        report.m_nRxMsgCount = m_nRxMsgCount;
+        const float fDurationSecs = static_cast<float>(report.m_nDurationUSecs) / 1000000.f;
+        report.m_fTxMsgPerSec = (fDurationSecs > 0.f) ? (m_nTxMsgCount / fDurationSecs) : 0.f;
+        report.m_fRxMsgPerSec = (fDurationSecs > 0.f) ? (m_nRxMsgCount / fDurationSecs) : 0.f;
+        report.m_nDisconnectCount = m_nDisconnectCount;
+        report.m_rtt = m_rttSamples.getPercentiles(m_vScratch);
+        report.m_serverTick = m_serverTickSamples.getPercentiles(m_vScratch);
+        return report;
+    }
+
+    /**
+        Clears collected statistics, e.g. after a warm-up period. Does not affect clients.
+
+        @param nTimeUSecs Current time, statistics are collected from this moment.
+    */
+    void PgeLoadGenerator::resetStats(const TTimeUSecs& nTimeUSecs)
+    {
+        m_nStatsStartUSecs = nTimeUSecs;
+        m_nTxMsgCount = 0;
+        m_nRxMsgCount = 0;
+        m_nDisconnectCount = 0;
+        m_rttSamples.m_vSamples.clear();
+        m_rttSamples.m_iNext = 0;
+        m_serverTickSamples.m_vSamples.clear();
+        m_serverTickSamples.m_iNext = 0;
+    }
+
+
+    // ############################## PRIVATE ##############################
+
+
+    /**
+        @param nUSecs    The sample to be recorded, clamped into range [0, UINT32_MAX].
+        @param nCapacity When there are this many samples, the oldest one is overwritten.
+    */
+    void PgeLoadGenerator::Samples::add(const TTimeUSecs& nUSecs, const std::size_t& nCapacity)
+    {
+        const uint32_t nSample = static_cast<uint32_t>(std::clamp<TTimeUSecs>(nUSecs, 0, UINT32_MAX));
+        if (m_vSamples.size() < nCapacity)
+        {
+            m_vSamples.push_back(nSample);
+        }
+        else
+        {
+            m_vSamples[m_iNext] = nSample;
+            m_iNext = (m_iNext + 1) % nCapacity;
+        }
+    }
+
+    PgeLoadGenerator::Percentiles PgeLoadGenerator::Samples::getPercentiles(std::vector<uint32_t>& vScratch) const
+    {
+        Percentiles percentiles{};
+        if (m_vSamples.empty())
+        {
+            return percentiles;
+        }
+
+        vScratch.assign(m_vSamples.begin(), m_vSamples.end());
+        std::sort(vScratch.begin(), vScratch.end());
+
+        // nearest-rank: smallest value with at least p% of the values not greater than it
+        const auto getPercentile = [&vScratch](const std::size_t& nPercent) {
+            const std::size_t nRank = (vScratch.size() * nPercent + 99) / 100;
+            return vScratch[nRank - 1];
+        };
+
+        percentiles.m_nCount = static_cast<uint32_t>(vScratch.size());
+        percentiles.m_nP50 = getPercentile(50);
+        percentiles.m_nP90 = getPercentile(90);
+        percentiles.m_nP99 = getPercentile(99);
+        percentiles.m_nMax = vScratch.back();
+        return percentiles;
+    }
+
+    uint64_t PgeLoadGenerator::nextRandom()
+    {
+        uint64_t n = (m_nRandomState += 0x9E3779B97F4A7C15ull);
+        n = (n ^ (n >> 30)) * 0xBF58476D1CE4E5B9ull;
+        n = (n ^ (n >> 27)) * 0x94D049BB133111EBull;
+        return n ^ (n >> 31);
+    }
+
+    /**
+        Counts and drops all received packets of the given client, except probe replies which are recorded as samples.
+    */
+    void PgeLoadGenerator::drainPackets(Client& client, const TTimeUSecs& nTimeUSecs)
+    {
+        PgeIClient& pgeClient = *client.m_pClient;
+        while (pgeClient.getPacketQueueSize() > 0)
+        {
+            const PgePacket& pkt = pgeClient.borrowFrontPacket();
+            switch (PgePacket::getPacketId(pkt))
+            {
+            case PgePktId::UserDisconnectedFromServer:
+                // other handles are about other clients disconnecting
+                if (client.m_bJoined && (PgePacket::getServerSideConnectionHandle(pkt) == ServerConnHandle))
+                {
+                    client.m_bJoined = false;
+                    ++m_nDisconnectCount;
+                }
+                break;
+            case PgePktId::Application:
+            {
+                ++m_nRxMsgCount;
+                const MsgApp& msgApp = *PgePacket::getMsgAppFromPkt(pkt);
+                if ((MsgApp::getMsgAppMsgId(msgApp) == m_msgIdProbe) && (MsgApp::getMsgAppDataActualSizeBytes(msgApp) == sizeof(MsgLoadGenProbe)))
+                {
+                    MsgLoadGenProbe probe;
+                    memcpy(&probe, MsgApp::getMsgAppData(msgApp), sizeof(probe));
+                    m_rttSamples.add(nTimeUSecs - probe.m_nClientTimeUSecs, m_nSampleCapacity);
+                    m_serverTickSamples.add(probe.m_nServerTickUSecs, m_nSampleCapacity);
+                    client.m_bJoined = true;
+                }
+                break;
+            }
+            default:
+                break;
+            }
+            pgeClient.releaseFrontPacket();
+        }
+    }
+
+    void PgeLoadGenerator::sendInput(Client& client)
+    {
+        const uint32_t k = client.m_nTick + client.m_nPhase;
+
+        MsgLoadGenInput input;
+        input.m_nTick = client.m_nTick;
+        input.m_nStrafe = (m_pattern.m_nStrafePeriod == 0) ? 0 : ((((k / m_pattern.m_nStrafePeriod) % 2) == 0) ? -1 : 1);
+        input.m_bJump = (m_pattern.m_nJumpPeriod != 0) && ((k % m_pattern.m_nJumpPeriod) == 0);
+        input.m_bAttack = (m_pattern.m_nFirePeriod != 0) && ((k % m_pattern.m_nFirePeriod) < m_pattern.m_nFireBurstLength);
+        if ((m_pattern.m_nWeaponSwitchPeriod != 0) && ((k % m_pattern.m_nWeaponSwitchPeriod) == 0))
+        {
+            client.m_iWeapon = static_cast<uint8_t>((client.m_iWeapon + 1) % m_pattern.m_nWeaponCount);
+        }
+        input.m_iWeapon = client.m_iWeapon;
+        input.m_fAimAngle = static_cast<float>((k * 2u) % 360u);
+
+        PgePacket pkt;
+        PgePacket::initPktMsgApp(pkt, ServerConnHandle, PgePacket::AutoFill::NONE);
+        TByte* const pData = PgePacket::preparePktMsgAppFill(pkt, m_msgIdInput, sizeof(MsgLoadGenInput));
+        if (!pData)
+        {
+            CConsole::getConsoleInstance("PgeLoadGenerator").EOLn("%s: preparePktMsgAppFill() failed!", __func__);
+            return;
+        }
+        memcpy(pData, &input, sizeof(input));
+        client.m_pClient->send(pkt);
+        ++m_nTxMsgCount;
+    }
+
+    void PgeLoadGenerator::sendProbe(Client& client, const TTimeUSecs& nTimeUSecs)
+    {
+        MsgLoadGenProbe probe;
+        probe.m_nClientTimeUSecs = nTimeUSecs;
+        probe.m_nServerTickUSecs = 0;
+
+        PgePacket pkt;
+        PgePacket::initPktMsgApp(pkt, ServerConnHandle, PgePacket::AutoFill::NONE);
+        TByte* const pData = PgePacket::preparePktMsgAppFill(pkt, m_msgIdProbe, sizeof(MsgLoadGenProbe));
+        if (!pData)
+        {
+            CConsole::getConsoleInstance("PgeLoadGenerator").EOLn("%s: preparePktMsgAppFill() failed!", __func__);
+            return;
+        }
+        memcpy(pData, &probe, sizeof(probe));
+        client.m_pClient->send(pkt);
+        ++m_nTxMsgCount;
+    }
+
+} // namespace pge_network
@@ -0,0 +1,204 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeLoadGenerator.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine simulated client load generator
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "PgeIClient.h"
+#include "PgePacket.h"
+
+namespace pge_network
+{
+
+    /**
+        Drives any number of client instances with scripted player input, for measuring the capacity of a server.
+        Client instances are not owned, they can be PgeLoopbackClient instances connected to an in-process PgeLoopbackServer,
+        or a PgeClient connected to a real server.
+
+        Every invocation of update() is an input tick of all clients: each client is updated, its received packets are drained,
+        then it sends its input for the tick, following a deterministic pattern:
+         - strafing left and right, changing direction periodically, and jumping periodically;
+         - firing in bursts, with aim angle slowly rotating;
+         - switching to the next weapon periodically.
+        Each client starts the pattern at a different phase derived from the seed, so clients do not act in lock-step.
+
+        Round-trip time is measured at application level: each client periodically sends a probe carrying its send time, which
+        the server echoes back by handleProbePkt(), also telling the duration of its last tick. A client starts sending input only
+        after its first probe reply, i.e. when the server is ready to process its messages.
+        So the server application needs to allow-list both app message ids, and pass received packets to handleProbePkt().
+
+        Time is given by the caller, so the simulated time of PgeLoopbackTransport can be used for reproducible results.
+    */
+    class PgeLoadGenerator
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeLoadGenerator is included")
+#endif
+
+    public:
+
+        typedef int64_t TTimeUSecs;
+
+        static constexpr std::size_t nDefaultSampleCapacity = 1u << 16;
+
+        /**
+            Input pattern of the simulated players, all periods are in input ticks, 0 period disables the given action.
+        */
+        struct Pattern
+        {
+            uint32_t m_nStrafePeriod = 60;         /**< Strafing direction flips this often. */
+            uint32_t m_nJumpPeriod = 90;
+            uint32_t m_nFirePeriod = 30;           /**< A firing burst starts this often. */
+            uint32_t m_nFireBurstLength = 10;      /**< Ticks of firing in each burst. */
+            uint32_t m_nWeaponSwitchPeriod = 300;
+            uint8_t m_nWeaponCount = 3;            /**< Weapon slots cycled through by switching, must be positive. */
+            uint32_t m_nProbePeriod = 10;          /**< Round-trip time is probed this often, must be positive. */
+        };
+
+        /**
+            Distribution of recorded samples in microseconds, using the nearest-rank method.
+        */
+        struct Percentiles
+        {
+            uint32_t m_nCount;
+            uint32_t m_nP50;
+            uint32_t m_nP90;
+            uint32_t m_nP99;
+            uint32_t m_nMax;
+        };
+
+        struct Report
+        {
+            std::size_t m_nClientCount;
+            std::size_t m_nJoinedClientCount;     /**< Clients that already received a probe reply and are sending input. */
+            TTimeUSecs m_nDurationUSecs;          /**< Since construction or last resetStats(). */
+            uint64_t m_nTxMsgCount;               /**< App messages sent by all clients. */
+            uint64_t m_nRxMsgCount;               /**< App messages received by all clients. */
+            float m_fTxMsgPerSec;
+            float m_fRxMsgPerSec;
+            uint32_t m_nDisconnectCount;          /**< Times a joined client got disconnected. */
+            Percentiles m_rtt;                    /**< Client-observed round-trip time. */
+            Percentiles m_serverTick;             /**< Server tick duration, as reported in probe replies. */
+        };
+
+        // ---------------------------------------------------------------------------
+
+        static bool handleProbePkt(
+            PgeIServerClient& server,
+            const PgePacket& pkt,
+            const MsgApp::TMsgId& msgIdProbe,
+            const uint32_t& nServerTickUSecs);
+
+        PgeLoadGenerator(
+            const MsgApp::TMsgId& msgIdInput,
+            const MsgApp::TMsgId& msgIdProbe,
+            const Pattern& pattern,
+            const TTimeUSecs& nTimeUSecs,
+            const uint64_t& nSeed = 1,
+            const std::size_t& nSampleCapacity = nDefaultSampleCapacity) noexcept(false);
+        ~PgeLoadGenerator() = default;
+
+        PgeLoadGenerator(const PgeLoadGenerator&) = delete;
+        PgeLoadGenerator& operator=(const PgeLoadGenerator&) = delete;
+        PgeLoadGenerator(PgeLoadGenerator&&) = delete;
+        PgeLoadGenerator& operator=(PgeLoadGenerator&&) = delete;
+
+        const MsgApp::TMsgId& getMsgIdInput() const;
+        const MsgApp::TMsgId& getMsgIdProbe() const;
+        const Pattern& getPattern() const;
+
+        void addClient(PgeIClient& client);
+        std::size_t getClientCount() const;
+        std::size_t getJoinedClientCount() const;
+
+        void update(const TTimeUSecs& nTimeUSecs);
+
+        Report getReport(const TTimeUSecs& nTimeUSecs) const;
+        void resetStats(const TTimeUSecs& nTimeUSecs);
+
+    private:
+
+        struct Client
+        {
+            PgeIClient* m_pClient;
+            uint32_t m_nTick;
+            uint32_t m_nPhase;    /**< Offset of this client in the pattern. */
+            uint8_t m_iWeapon;
+            bool m_bJoined;
+        };
+
+        /**
+            Bounded sample storage, overwriting the oldest samples when full.
+        */
+        struct Samples
+        {
+            std::vector<uint32_t> m_vSamples;
+            std::size_t m_iNext;
+
+            void add(const TTimeUSecs& nUSecs, const std::size_t& nCapacity);
+            Percentiles getPercentiles(std::vector<uint32_t>& vScratch) const;
+        };
+
+        const MsgApp::TMsgId m_msgIdInput;
+        const MsgApp::TMsgId m_msgIdProbe;
+        const Pattern m_pattern;
+        const std::size_t m_nSampleCapacity;
+        uint64_t m_nRandomState;
+        std::vector<Client> m_vClients;
+        TTimeUSecs m_nStatsStartUSecs;
+        uint64_t m_nTxMsgCount;
+        uint64_t m_nRxMsgCount;
+        uint32_t m_nDisconnectCount;
+        Samples m_rttSamples;
+        Samples m_serverTickSamples;
+        mutable std::vector<uint32_t> m_vScratch;   /**< Reused by getReport() for sorting samples. */
+
+        uint64_t nextRandom();
+
+        void drainPackets(Client& client, const TTimeUSecs& nTimeUSecs);
+        void sendInput(Client& client);
+        void sendProbe(Client& client, const TTimeUSecs& nTimeUSecs);
+
+    }; // class PgeLoadGenerator
+
+    /**
+        App message sent by PgeLoadGenerator clients every input tick.
+        The server application is expected to apply it to the player of the sender client as its own player input message.
+    */
+    struct MsgLoadGenInput
+    {
+        uint32_t m_nTick;       /**< Input tick of the client, starting from 1. */
+        int8_t m_nStrafe;       /**< -1: left, 0: none, 1: right. */
+        uint8_t m_bJump;
+        uint8_t m_bAttack;
+        uint8_t m_iWeapon;      /**< Currently selected weapon slot, a change means weapon switching. */
+        float m_fAimAngle;      /**< Degrees in range [0, 360). */
+    };
+    static_assert(std::is_trivial_v<MsgLoadGenInput>);
+    static_assert(std::is_trivially_copyable_v<MsgLoadGenInput>);
+    static_assert(std::is_standard_layout_v<MsgLoadGenInput>);
+
+    /**
+        App message sent by PgeLoadGenerator clients periodically, and echoed back by the server by PgeLoadGenerator::handleProbePkt().
+    */
+    struct MsgLoadGenProbe
+    {
+        int64_t m_nClientTimeUSecs;   /**< Send time of the client, echoed back unchanged. */
+        uint32_t m_nServerTickUSecs;  /**< Set by the server in the reply: duration of its last completed tick. */
+    };
+    static_assert(std::is_trivial_v<MsgLoadGenProbe>);
+    static_assert(std::is_trivially_copyable_v<MsgLoadGenProbe>);
+    static_assert(std::is_standard_layout_v<MsgLoadGenProbe>);
+
+} // namespace pge_network
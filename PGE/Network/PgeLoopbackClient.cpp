@@ -0,0 +1,482 @@
+/*
+    ###################################################################################
+    PgeLoopbackClient.cpp
+    This file is part of PGE.
+    PR00F's Game Engine in-process loopback network client
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgeLoopbackClient.h"
+
+#include <sstream>
+
+namespace pge_network {
+
+    /**
+        @param transport        The medium to be used, must outlive this client.
+        @param nRxQueueCapacity Capacity of the packet queue.
+    */
+    PgeLoopbackClient::PgeLoopbackClient(PgeLoopbackTransport& transport, const std::size_t& nRxQueueCapacity) :
+        PgeLoopbackEndpoint(transport, PgeLoopbackTransport::Side::Client, getLoggerModuleName(), nRxQueueCapacity),
+        m_hConnection(0),
+        m_bAccepted(false)
+    {
+        // same as PgeClientImpl
+        m_allowListedPgeMessages.insert(MsgUserDisconnectedFromServer::id);
+        m_allowListedPgeMessages.insert(MsgApp::id);
+        initPktBatches(m_pktBatches);
+    }
+
+    PgeLoopbackClient::~PgeLoopbackClient()
+    {
+        shutdown();
+    }
+
+    bool PgeLoopbackClient::isConnected() const
+    {
+        return m_hConnection != 0;
+    }
+
+    /**
+        @return True if server has already accepted our connection, false otherwise.
+    */
+    bool PgeLoopbackClient::isAccepted() const
+    {
+        return m_bAccepted;
+    }
+
+    bool PgeLoopbackClient::initialize()
+    {
+        return initializeEndpoint();
+    }
+
+    bool PgeLoopbackClient::shutdown()
+    {
+        disconnect("shutdown");
+        shutdownEndpoint();
+        return true;
+    }
+
+    bool PgeLoopbackClient::isInitialized() const
+    {
+        return m_bInitialized;
+    }
+
+    /**
+        Same as PgeGnsClient::disconnectClient(), MsgUserDisconnectedFromServer is injected with ServerConnHandle.
+    */
+    void PgeLoopbackClient::disconnect(const std::string& sExtraDebugText)
+    {
+        if (!isConnected())
+        {
+            return;
+        }
+
+        CConsole::getConsoleInstance(getLoggerModuleName()).OLn(
+            "Client closing connection %u ... Reason: %s",
+            m_hConnection,
+            sExtraDebugText.empty() ? "unspecified" : sExtraDebugText.c_str());
+
+        PgePacket pkt;
+        PgePacket::initPktPgeMsgUserDisconnected(pkt, ServerConnHandle);
+        enqueuePkt(pkt);
+
+        // whatever app messages are still waiting in batches, we send them out before closing connection
+        flushBatchedPackets();
+        m_transport.close(m_hConnection, PgeLoopbackTransport::Side::Client);
+        resetConnection();
+    }
+
+    void PgeLoopbackClient::Update()
+    {
+        pollIncomingMessages();  // receives all packets due, no need to loop
+        pollConnectionStateChanges();
+    }
+
+    bool PgeLoopbackClient::pollIncomingMessages()
+    {
+        if (!isConnected())
+        {
+            return false;
+        }
+        return receivePkts(m_hConnection);
+    }
+
+    void PgeLoopbackClient::pollConnectionStateChanges()
+    {
+        if (!isConnected())
+        {
+            return;
+        }
+
+        PgeLoopbackTransport::ConnEvent connEvent;
+        while (isConnected() && m_transport.receiveConnEvent(m_hConnection, PgeLoopbackTransport::Side::Client, connEvent))
+        {
+            switch (connEvent.m_kind)
+            {
+            case PgeLoopbackTransport::ConnEventKind::Accepted:
+            {
+                m_bAccepted = true;
+
+                // server accepted our connection, now immediately send our app version, otherwise server app won't start talking to us.
+                PgePacket pktMsgClientAppVersion;
+                PgePacket::initPktPgeMsgClientAppVersionFromClient(pktMsgClientAppVersion, m_sAppVersion);
+                batchPkt(m_hConnection, m_pktBatches, pktMsgClientAppVersion);
+                break;
+            }
+            case PgeLoopbackTransport::ConnEventKind::Closed:
+            {
+                CConsole::getConsoleInstance(getLoggerModuleName()).OLn("%s: connection %u closed by server", __func__, m_hConnection);
+
+                // Unlike PgeGnsClient (see the TODO there), we inject MsgUserDisconnectedFromServer here, since there is no
+                // auto-reconnect logic at this level which could overwrite m_hConnection in the meantime.
+                PgePacket pkt;
+                PgePacket::initPktPgeMsgUserDisconnected(pkt, ServerConnHandle);
+                enqueuePkt(pkt);
+                resetConnection();
+                break;
+            }
+            default:
+                CConsole::getConsoleInstance(getLoggerModuleName()).EOLn("%s: unexpected event %u on connection %u!",
+                    __func__, static_cast<unsigned>(connEvent.m_kind), connEvent.m_connHandle);
+                break;
+            }
+        }
+    }
+
+    std::size_t PgeLoopbackClient::getPacketQueueSize() const
+    {
+        return m_queuePackets.size();
+    }
+
+    PgePacket PgeLoopbackClient::popFrontPacket() noexcept(false)
+    {
+        return PgeLoopbackEndpoint::popFrontPacket();
+    }
+
+    const PgePacket& PgeLoopbackClient::borrowFrontPacket() noexcept(false)
+    {
+        return m_queuePackets.borrowFront();
+    }
+
+    void PgeLoopbackClient::releaseFrontPacket()
+    {
+        m_queuePackets.releaseFront();
+    }
+
+    uint32_t PgeLoopbackClient::getPacketQueueDroppedCount() const
+    {
+        return m_queuePackets.getDroppedCount();
+    }
+
+    std::size_t PgeLoopbackClient::getPacketQueueHighWaterMark() const
+    {
+        return m_queuePackets.getHighWaterMark();
+    }
+
+    PgePktIdAllowList& PgeLoopbackClient::getAllowListedPgeMessages()
+    {
+        return m_allowListedPgeMessages;
+    }
+
+    MsgAppIdAllowList& PgeLoopbackClient::getAllowListedAppMessages()
+    {
+        return m_allowListedAppMessages;
+    }
+
+    std::map<MsgApp::TMsgId, PgeSendLane>& PgeLoopbackClient::getMsgAppId2SendLaneMap()
+    {
+        return m_mapMsgAppId2SendLane;
+    }
+
+    PgeMsgAppCompressor& PgeLoopbackClient::getMsgAppCompressor()
+    {
+        return m_compressor;
+    }
+
+    std::map<MsgApp::TMsgId, PgeMsgAppCompressor::MsgAppStats> PgeLoopbackClient::getMsgAppCompressionStats() const
+    {
+        return m_compressor.getStats();
+    }
+
+    void PgeLoopbackClient::send(const PgePacket& pkt, const PgeNetworkConnectionHandle& connHandle)
+    {
+        if (connHandle != ServerConnHandle)
+        {
+            CConsole::getConsoleInstance(getLoggerModuleName()).EOLn("%s: client can send only to server!", __func__);
+            return;
+        }
+
+        if (!isConnected())
+        {
+            CConsole::getConsoleInstance(getLoggerModuleName()).EOLn("%s: not connected!", __func__);
+            return;
+        }
+        batchPkt(m_hConnection, m_pktBatches, pkt);
+    }
+
+    /**
+        Batched app messages are kept until server accepts our connection.
+    */
+    void PgeLoopbackClient::flushBatchedPackets()
+    {
+        if (!m_bAccepted)
+        {
+            return;
+        }
+        flushBatchPkts(m_hConnection, m_pktBatches);
+    }
+
+    uint32_t PgeLoopbackClient::getRxPacketCount() const
+    {
+        return m_nRxPktCount;
+    }
+
+    uint32_t PgeLoopbackClient::getTxPacketCount() const
+    {
+        return m_nTxPktCount;
+    }
+
+    uint32_t PgeLoopbackClient::getInjectPacketCount() const
+    {
+        return m_nInjectPktCount;
+    }
+
+    uint32_t PgeLoopbackClient::getRxPacketPerSecondCount() const
+    {
+        return getPacketPerSecondCount(m_nRxPktCount, m_time1stRxPkt);
+    }
+
+    uint32_t PgeLoopbackClient::getTxPacketPerSecondCount() const
+    {
+        return getPacketPerSecondCount(m_nTxPktCount, m_time1stTxPkt);
+    }
+
+    uint32_t PgeLoopbackClient::getInjectPacketPerSecondCount() const
+    {
+        return getPacketPerSecondCount(m_nInjectPktCount, m_time1stInjectPkt);
+    }
+
+    const std::map<MsgApp::TMsgId, uint32_t>& PgeLoopbackClient::getRxMsgCount() const
+    {
+        return m_stats.getMsgAppCountMap(PgeNetworkStats::Direction::Rx);
+    }
+
+    const std::map<MsgApp::TMsgId, uint32_t>& PgeLoopbackClient::getTxMsgCount() const
+    {
+        return m_stats.getMsgAppCountMap(PgeNetworkStats::Direction::Tx);
+    }
+
+    const std::map<MsgApp::TMsgId, uint32_t>& PgeLoopbackClient::getInjectMsgCount() const
+    {
+        return m_stats.getMsgAppCountMap(PgeNetworkStats::Direction::Inject);
+    }
+
+    const std::map<PgeSendLane, uint32_t>& PgeLoopbackClient::getRxLaneMsgCount() const
+    {
+        return m_stats.getLaneMsgCountMap(PgeNetworkStats::Direction::Rx);
+    }
+
+    const std::map<PgeSendLane, uint32_t>& PgeLoopbackClient::getTxLaneMsgCount() const
+    {
+        return m_stats.getLaneMsgCountMap(PgeNetworkStats::Direction::Tx);
+    }
+
+    const PgeNetworkStats& PgeLoopbackClient::getNetworkStats() const
+    {
+        return m_stats;
+    }
+
+    std::map<MsgApp::TMsgId, std::string>& PgeLoopbackClient::getMsgAppId2StringMap()
+    {
+        return m_mapMsgAppId2String;
+    }
+
+    uint32_t PgeLoopbackClient::getRxByteCount() const
+    {
+        return m_nRxByteCount;
+    }
+
+    uint32_t PgeLoopbackClient::getTxByteCount() const
+    {
+        return m_nTxByteCount;
+    }
+
+    uint32_t PgeLoopbackClient::getInjectByteCount() const
+    {
+        return m_nInjectByteCount;
+    }
+
+    PgeHandoffStats PgeLoopbackClient::getHandoffStats() const
+    {
+        return PgeHandoffStats();
+    }
+
+    PgeConnectionTelemetry PgeLoopbackClient::getConnectionTelemetry() const
+    {
+        return PgeConnectionTelemetry();
+    }
+
+    void PgeLoopbackClient::WriteList() const
+    {
+        CConsole& con = CConsole::getConsoleInstance(getLoggerModuleName());
+        con.OLnOI("PgeLoopbackClient::WriteList() start");
+        if (isInitialized())
+        {
+            con.OLn("Role: Loopback Client, connHandle: %u, accepted: %b", m_hConnection, m_bAccepted);
+            logStats();
+        }
+        else
+        {
+            con.OLn("PgeLoopbackClient is NOT initialized!");
+        }
+        con.OOOLn("PgeLoopbackClient::WriteList() end");
+    }
+
+    /**
+        Same as PgeGnsClient::connectToServer(), MsgClientAppVersionFromClient is sent to server once the server accepted our connection.
+        @param sServerAddress Not used for connecting since there is only 1 server per transport, just stored for getServerAddress().
+    */
+    bool PgeLoopbackClient::connectToServer(const std::string& sServerAddress, const std::string& sAppVersion)
+    {
+        if (!isInitialized())
+        {
+            CConsole::getConsoleInstance(getLoggerModuleName()).EOLn("%s() ERROR: not initialized!", __func__);
+            return false;
+        }
+
+        if (isConnected())
+        {
+            CConsole::getConsoleInstance(getLoggerModuleName()).EOLn("%s() ERROR: already connected!", __func__);
+            return false;
+        }
+
+        const PgeNetworkConnectionHandle connHandle = m_transport.connect();
+        if (connHandle == 0)
+        {
+            CConsole::getConsoleInstance(getLoggerModuleName()).EOLn("%s() ERROR: server is not listening!", __func__);
+            return false;
+        }
+
+        m_hConnection = connHandle;
+        m_sServerAddress = sServerAddress;
+        m_sAppVersion = sAppVersion;
+
+        // batch might contain app messages from a previous connection
+        initPktBatches(m_pktBatches);
+        return true;
+    }
+
+    const PgeNetworkConnectionHandle& PgeLoopbackClient::getConnectionHandle() const
+    {
+        return m_hConnection;
+    }
+
+    const PgeNetworkConnectionHandle& PgeLoopbackClient::getConnectionHandleServerSide() const
+    {
+        return m_hConnection;
+    }
+
+    const char* PgeLoopbackClient::getServerAddress() const
+    {
+        return m_sServerAddress.c_str();
+    }
+
+    /**
+        @return Round-trip time in milliseconds, based on the configured latency and average jitter.
+    */
+    int PgeLoopbackClient::getPing(bool)
+    {
+        const PgeLoopbackTransport::LinkConfig& linkConfig = m_transport.getLinkConfig();
+        return static_cast<int>((2 * linkConfig.m_nLatencyUSecs + linkConfig.m_nJitterUSecs) / 1000);
+    }
+
+    float PgeLoopbackClient::getQualityLocal(bool)
+    {
+        return 1.f - m_transport.getLinkConfig().m_fLossRate;
+    }
+
+    float PgeLoopbackClient::getQualityRemote(bool)
+    {
+        return 1.f - m_transport.getLinkConfig().m_fLossRate;
+    }
+
+    float PgeLoopbackClient::getRxByteRate(bool)
+    {
+        const PgeNetworkStats::Record* const pRecord = m_stats.getConnectionRecord(PgeNetworkStats::Direction::Rx, m_hConnection);
+        return pRecord ? static_cast<float>(pRecord->getBytesPerSecond(std::chrono::steady_clock::now())) : 0.f;
+    }
+
+    float PgeLoopbackClient::getTxByteRate(bool)
+    {
+        const PgeNetworkStats::Record* const pRecord = m_stats.getConnectionRecord(PgeNetworkStats::Direction::Tx, m_hConnection);
+        return pRecord ? static_cast<float>(pRecord->getBytesPerSecond(std::chrono::steady_clock::now())) : 0.f;
+    }
+
+    int64_t PgeLoopbackClient::getPendingUnreliableBytes(bool)
+    {
+        return static_cast<int64_t>(m_transport.getInFlightBytes(m_hConnection, PgeLoopbackTransport::Side::Client, false));
+    }
+
+    int64_t PgeLoopbackClient::getPendingReliableBytes(bool)
+    {
+        return static_cast<int64_t>(m_transport.getInFlightBytes(m_hConnection, PgeLoopbackTransport::Side::Client, true));
+    }
+
+    /**
+        There are no acks in the loopback transport, reliable packets in flight are the unacked ones.
+    */
+    int64_t PgeLoopbackClient::getSentButUnAckedReliableBytes(bool bForceUpdate)
+    {
+        return getPendingReliableBytes(bForceUpdate);
+    }
+
+    int64_t PgeLoopbackClient::getInternalQueueTimeUSecs(bool)
+    {
+        return m_transport.getQueueTimeUSecs(m_hConnection, PgeLoopbackTransport::Side::Client);
+    }
+
+    std::string PgeLoopbackClient::getDetailedConnectionStatus() const
+    {
+        if (!isConnected())
+        {
+            return "";
+        }
+
+        const PgeLoopbackTransport::LinkConfig& linkConfig = m_transport.getLinkConfig();
+        std::stringstream ss;
+        ss << "Loopback connection " << m_hConnection << " to " << m_sServerAddress << (m_bAccepted ? " (accepted)\n" : " (connecting)\n")
+            << "Latency: " << linkConfig.m_nLatencyUSecs << " us, jitter: " << linkConfig.m_nJitterUSecs << " us, loss rate: "
+            << linkConfig.m_fLossRate << ", bandwidth: " << linkConfig.m_nBandwidthBytesPerSec << " bytes/s\n"
+            << "In flight to server: " << m_transport.getInFlightBytes(m_hConnection, PgeLoopbackTransport::Side::Client, true) << " reliable bytes, "
+            << m_transport.getInFlightBytes(m_hConnection, PgeLoopbackTransport::Side::Client, false) << " unreliable bytes\n";
+        return ss.str();
+    }
+
+    bool PgeLoopbackClient::pgeMessageIsHandledAtTransportLevel(const PgePacket&)
+    {
+        // same as PgeGnsClient: no PGE message is handled at this level on client side
+        return false;
+    }
+
+    bool PgeLoopbackClient::validateIncomingConnection(const PgeNetworkConnectionHandle&) const
+    {
+        // transport delivers to us only packets of our connection
+        return true;
+    }
+
+    void PgeLoopbackClient::updateIncomingPgePacket(PgePacket&, const PgeNetworkConnectionHandle&) const
+    {
+        // same as PgeGnsClient: server already put the proper connection handle into the packet
+    }
+
+    void PgeLoopbackClient::resetConnection()
+    {
+        m_hConnection = 0;
+        m_bAccepted = false;
+    }
+
+} // namespace pge_network
@@ -0,0 +1,154 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeLoopbackClient.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine in-process loopback network client
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <string>
+
+#include "PgeIClient.h"
+#include "PgeLoopbackEndpoint.h"
+#include "PgeLoopbackTransport.h"
+#include "PgePacket.h"
+
+namespace pge_network
+{
+
+    /**
+        Client instance communicating with a PgeLoopbackServer through a PgeLoopbackTransport, without any socket.
+        Behaves the same way as PgeClient at application level: it sends the client app version upon being accepted by the server,
+        batches app messages per send lane, and unpacks received batches.
+
+        Unlike PgeClient, any number of instances can be created, e.g. to simulate 128 clients in a single process.
+    */
+    class PgeLoopbackClient : public PgeIClient, protected PgeLoopbackEndpoint
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeLoopbackClient is included")
+#endif
+
+    public:
+
+        static const char* getLoggerModuleName()
+        {
+            return "PgeLoopbackClient";
+        }
+
+        // ---------------------------------------------------------------------------
+
+        explicit PgeLoopbackClient(PgeLoopbackTransport& transport, const std::size_t& nRxQueueCapacity = nDefaultRxQueueCapacity);
+        virtual ~PgeLoopbackClient();
+
+        PgeLoopbackClient(const PgeLoopbackClient&) = delete;
+        PgeLoopbackClient& operator=(const PgeLoopbackClient&) = delete;
+        PgeLoopbackClient(PgeLoopbackClient&&) = delete;
+        PgeLoopbackClient& operator=(PgeLoopbackClient&&) = delete;
+
+        using PgeLoopbackEndpoint::getTransport;
+
+        bool isConnected() const;
+        bool isAccepted() const;
+
+        /* implement stuff from PgeIServerClient start */
+
+        bool initialize() override;
+        bool shutdown() override;
+        bool isInitialized() const override;
+        void disconnect(const std::string& sExtraDebugText = "") override;
+
+        void Update() override;
+
+        bool pollIncomingMessages() override;
+        void pollConnectionStateChanges() override;
+
+        std::size_t getPacketQueueSize() const override;
+        PgePacket popFrontPacket() noexcept(false) override;
+        const PgePacket& borrowFrontPacket() noexcept(false) override;
+        void releaseFrontPacket() override;
+        uint32_t getPacketQueueDroppedCount() const override;
+        std::size_t getPacketQueueHighWaterMark() const override;
+
+        PgePktIdAllowList& getAllowListedPgeMessages() override;
+        MsgAppIdAllowList& getAllowListedAppMessages() override;
+        std::map<MsgApp::TMsgId, PgeSendLane>& getMsgAppId2SendLaneMap() override;
+        PgeMsgAppCompressor& getMsgAppCompressor() override;
+        std::map<MsgApp::TMsgId, PgeMsgAppCompressor::MsgAppStats> getMsgAppCompressionStats() const override;
+
+        void send(const PgePacket& pkt, const PgeNetworkConnectionHandle& connHandle = ServerConnHandle) override;
+        void flushBatchedPackets() override;
+
+        uint32_t getRxPacketCount() const override;
+        uint32_t getTxPacketCount() const override;
+        uint32_t getInjectPacketCount() const override;
+
+        uint32_t getRxPacketPerSecondCount() const override;
+        uint32_t getTxPacketPerSecondCount() const override;
+        uint32_t getInjectPacketPerSecondCount() const override;
+
+        const std::map<MsgApp::TMsgId, uint32_t>& getRxMsgCount() const override;
+        const std::map<MsgApp::TMsgId, uint32_t>& getTxMsgCount() const override;
+        const std::map<MsgApp::TMsgId, uint32_t>& getInjectMsgCount() const override;
+
+        const std::map<PgeSendLane, uint32_t>& getRxLaneMsgCount() const override;
+        const std::map<PgeSendLane, uint32_t>& getTxLaneMsgCount() const override;
+
+        const PgeNetworkStats& getNetworkStats() const override;
+
+        std::map<MsgApp::TMsgId, std::string>& getMsgAppId2StringMap() override;
+
+        uint32_t getRxByteCount() const override;
+        uint32_t getTxByteCount() const override;
+        uint32_t getInjectByteCount() const override;
+        PgeHandoffStats getHandoffStats() const override;  /**< Loopback has no handoff, always empty. */
+        PgeConnectionTelemetry getConnectionTelemetry() const override;  /**< Loopback has no connection status, always empty. */
+
+        void WriteList() const override;
+
+        /* implement stuff from PgeIServerClient end */
+
+        /* implement stuff from PgeIClient start */
+
+        bool connectToServer(const std::string& sServerAddress, const std::string& sAppVersion = "") override;
+        const PgeNetworkConnectionHandle& getConnectionHandle() const override;
+        const PgeNetworkConnectionHandle& getConnectionHandleServerSide() const override;
+        const char* getServerAddress() const override;
+
+        int getPing(bool bForceUpdate) override;
+        float getQualityLocal(bool bForceUpdate) override;
+        float getQualityRemote(bool bForceUpdate) override;
+        float getRxByteRate(bool bForceUpdate) override;
+        float getTxByteRate(bool bForceUpdate) override;
+        int64_t getPendingUnreliableBytes(bool bForceUpdate) override;
+        int64_t getPendingReliableBytes(bool bForceUpdate) override;
+        int64_t getSentButUnAckedReliableBytes(bool bForceUpdate) override;
+        int64_t getInternalQueueTimeUSecs(bool bForceUpdate) override;
+        std::string getDetailedConnectionStatus() const override;
+
+        /* implement stuff from PgeIClient end */
+
+    protected:
+
+        bool pgeMessageIsHandledAtTransportLevel(const PgePacket& pkt) override;
+        bool validateIncomingConnection(const PgeNetworkConnectionHandle& connHandle) const override;
+        void updateIncomingPgePacket(PgePacket& pkt, const PgeNetworkConnectionHandle& connHandle) const override;
+
+    private:
+
+        PgeNetworkConnectionHandle m_hConnection;  /**< The transport uses the same handle on both sides, so this is also the server-side handle. */
+        bool m_bAccepted;
+        std::string m_sServerAddress;
+        SendLane2PktBatchArray m_pktBatches;  /**< App messages sent to server are batched here per send lane until flushBatchedPackets(). */
+
+        void resetConnection();
+
+    }; // class PgeLoopbackClient
+
+} // namespace pge_network
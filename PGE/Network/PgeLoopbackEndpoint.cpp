@@ -0,0 +1,521 @@
+/*
+    ###################################################################################
+    PgeLoopbackEndpoint.cpp
+    This file is part of PGE.
+    PR00F's Game Engine in-process loopback network endpoint
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgeLoopbackEndpoint.h"
+
+#include <cassert>
+
+namespace pge_network {
+
+    PgeLoopbackTransport& PgeLoopbackEndpoint::getTransport()
+    {
+        return m_transport;
+    }
+
+    /**
+        Initializes all batch packets of a connection to empty app message packets.
+    */
+    void PgeLoopbackEndpoint::initPktBatches(SendLane2PktBatchArray& pktBatches)
+    {
+        for (auto& pktBatch : pktBatches)
+        {
+            PgePacket::initPktMsgApp(pktBatch, ServerConnHandle, PgePacket::AutoFill::NONE);
+        }
+    }
+
+    const char* PgeLoopbackEndpoint::getSendLaneString(const PgeSendLane& lane)
+    {
+        switch (lane)
+        {
+        case PgeSendLane::Reliable:
+            return "Reliable";
+        case PgeSendLane::ReliableNoNagle:
+            return "ReliableNoNagle";
+        case PgeSendLane::Unreliable:
+            return "Unreliable";
+        case PgeSendLane::UnreliableNoDelay:
+            return "UnreliableNoDelay";
+        default:
+            return "Unknown";
+        }
+    }
+
+    /**
+        @param transport          The medium to be used, must outlive this endpoint.
+        @param side               Side of this endpoint.
+        @param szLoggerModuleName Logger module name of the derived class.
+        @param nRxQueueCapacity   Capacity of the packet queue, the loopback counterpart of PgeINetwork::CVAR_NET_RX_QUEUE_CAPACITY.
+    */
+    PgeLoopbackEndpoint::PgeLoopbackEndpoint(
+        PgeLoopbackTransport& transport,
+        const PgeLoopbackTransport::Side& side,
+        const char* szLoggerModuleName,
+        const std::size_t& nRxQueueCapacity) :
+        m_transport(transport),
+        m_side(side),
+        m_szLoggerModuleName(szLoggerModuleName),
+        m_nRxQueueCapacity(nRxQueueCapacity),
+        m_bInitialized(false),
+        m_nRxPktCount(0),
+        m_nTxPktCount(0),
+        m_nInjectPktCount(0),
+        m_nRxByteCount(0),
+        m_nTxByteCount(0),
+        m_nInjectByteCount(0)
+    {
+    }
+
+    /**
+        Preallocates the packet queue, so no allocation happens later when packets are received.
+
+        @return True on success, false if already initialized or the capacity is invalid.
+    */
+    bool PgeLoopbackEndpoint::initializeEndpoint()
+    {
+        if (m_bInitialized)
+        {
+            CConsole::getConsoleInstance(m_szLoggerModuleName).EOLn("%s: already initialized!", __func__);
+            return false;
+        }
+
+        if ((m_nRxQueueCapacity == 0) || !m_queuePackets.reserve(m_nRxQueueCapacity))
+        {
+            CConsole::getConsoleInstance(m_szLoggerModuleName).EOLn("%s: failed to reserve rx queue with capacity %u, valid range is [1, %u]!",
+                __func__, m_nRxQueueCapacity, PgePacketRing::nMaxCapacity);
+            return false;
+        }
+
+        m_bInitialized = true;
+        return true;
+    }
+
+    void PgeLoopbackEndpoint::shutdownEndpoint()
+    {
+        if (!m_bInitialized)
+        {
+            return;
+        }
+
+        logStats();
+        m_bInitialized = false;
+        m_queuePackets.clear();
+    }
+
+    /**
+        Moves all packets due by the current time of the transport into the packet queue.
+        Batched app messages are unpacked, so application level receives exactly 1 app message per packet, as with PgeGnsWrapper.
+
+        @param connHandle Connection of the client, ignored in case of server.
+
+        @return True if any packet was received, false otherwise.
+    */
+    bool PgeLoopbackEndpoint::receivePkts(const PgeNetworkConnectionHandle& connHandle)
+    {
+        // 1 timestamp for all received packets is precise enough for stats
+        const PgeNetworkStats::TimePoint timeRx = std::chrono::steady_clock::now();
+        uint32_t nPktCount = 0;
+        while (true)
+        {
+            // receive directly into the back slot of our packet queue, committed only if we decide to keep the pkt
+            PgePacket* const pPktSlot = m_queuePackets.beginPushBack();
+            PgePacket pktOverflow;
+            PgePacket& pkt = pPktSlot ? *pPktSlot : pktOverflow;
+            uint32_t nActualPktSize = 0;
+            PgeNetworkConnectionHandle connHandleFrom = ServerConnHandle;
+            if (!m_transport.receive(connHandle, m_side, pkt, nActualPktSize, connHandleFrom))
+            {
+                break;
+            }
+
+            nPktCount++;
+            if (!validateIncomingConnection(connHandleFrom))
+            {
+                continue;
+            }
+            updateIncomingPgePacket(pkt, connHandleFrom);
+            m_stats.addPkt(PgeNetworkStats::Direction::Rx, connHandleFrom, nActualPktSize, timeRx);
+            receivePkt(pPktSlot, pkt, nActualPktSize, timeRx);
+        }
+
+        if (nPktCount == 0)
+        {
+            return false;
+        }
+
+        if (m_nRxPktCount == 0)
+        {
+            m_time1stRxPkt = timeRx;
+        }
+        m_nRxPktCount += nPktCount;
+        return true;
+    }
+
+    /**
+        Stores the given packet in the packet queue, so app level will receive it as it was received from network.
+    */
+    void PgeLoopbackEndpoint::enqueuePkt(const PgePacket& pkt)
+    {
+        if (!m_queuePackets.pushBack(pkt))
+        {
+            CConsole::getConsoleInstance(m_szLoggerModuleName).EOLn("%s: packet queue full, dropped pge message %u!",
+                __func__, PgePacket::getPacketId(pkt));
+        }
+    }
+
+    /**
+        Same as enqueuePkt(), also updating the inject statistics, used when app level sends to self.
+    */
+    void PgeLoopbackEndpoint::injectPkt(const PgePacket& pkt)
+    {
+        enqueuePkt(pkt);
+        const PgeNetworkStats::TimePoint timeInject = std::chrono::steady_clock::now();
+        if (m_nInjectPktCount == 0)
+        {
+            m_time1stInjectPkt = timeInject;
+        }
+        m_nInjectPktCount++;
+        const uint32_t nActualPktSize = PgePacket::getPktActualSizeBytes(pkt);
+        m_stats.addPkt(PgeNetworkStats::Direction::Inject, PgePacket::getServerSideConnectionHandle(pkt), nActualPktSize, timeInject);
+        if (PgePacket::getPacketId(pkt) == PgePktId::Application)
+        {
+            const MsgApp* pMsgApp = PgePacket::getMsgAppFromPkt(pkt);
+            const uint8_t nMessageCount = PgePacket::getMessageAppCount(pkt);
+            for (uint8_t i = 0; (i < nMessageCount) && pMsgApp; i++)
+            {
+                const MsgApp::TMsgId& msgAppId = MsgApp::getMsgAppMsgId(*pMsgApp);
+                m_stats.addMsgApp(
+                    PgeNetworkStats::Direction::Inject,
+                    msgAppId,
+                    MsgApp::getMsgAppTotalActualSizeBytes(*pMsgApp),
+                    getSendLaneByMsgAppId(msgAppId),
+                    timeInject);
+                pMsgApp = PgePacket::getNextMsgAppFromPkt(pkt, *pMsgApp);
+            }
+        }
+        m_nInjectByteCount += nActualPktSize;
+    }
+
+    /**
+        @return The send lane configured in m_mapMsgAppId2SendLane, or PgeSendLane::Reliable if not configured.
+    */
+    PgeSendLane PgeLoopbackEndpoint::getSendLaneByMsgAppId(const MsgApp::TMsgId& id) const
+    {
+        const auto it = m_mapMsgAppId2SendLane.find(id);
+        return (it == m_mapMsgAppId2SendLane.end()) ? PgeSendLane::Reliable : it->second;
+    }
+
+    /**
+        Sends the given packet to the given connection immediately, without batching.
+        App messages are compressed as configured in m_compressor, and only the actually used memory area of the packet is sent.
+    */
+    void PgeLoopbackEndpoint::sendPkt(const PgeNetworkConnectionHandle& conn, const PgePacket& pkt, const PgeSendLane& lane)
+    {
+        PgePacket pktCompressed;
+        const PgePacket& pktToSend = m_compressor.compressPkt(pkt, pktCompressed) ? pktCompressed : pkt;
+        const uint32_t nActualPktSize = PgePacket::getPktActualSizeBytes(pktToSend);
+        if (!m_transport.send(conn, m_side, pktToSend, nActualPktSize, lane))
+        {
+            CConsole::getConsoleInstance(m_szLoggerModuleName).EOLn("%s: failed to send to connection %u!", __func__, conn);
+            return;
+        }
+        updateTxStats(conn, pktToSend, nActualPktSize, lane, std::chrono::steady_clock::now());
+    }
+
+    /**
+        Batches the app message(s) of the given packet into the batch packets belonging to the given connection,
+        the same way as PgeGnsWrapper::batchPkt() does.
+    */
+    void PgeLoopbackEndpoint::batchPkt(const PgeNetworkConnectionHandle& conn, SendLane2PktBatchArray& pktBatches, const PgePacket& pkt)
+    {
+        if (PgePacket::getPacketId(pkt) != PgePktId::Application)
+        {
+            flushBatchPkts(conn, pktBatches);
+            sendPkt(conn, pkt, PgeSendLane::Reliable);
+            return;
+        }
+
+        const MsgApp* pMsgApp = PgePacket::getMsgAppFromPkt(pkt);
+        const uint8_t nMessageCount = PgePacket::getMessageAppCount(pkt);
+        for (uint8_t i = 0; (i < nMessageCount) && pMsgApp; i++)
+        {
+            const PgeSendLane lane = getSendLaneByMsgAppId(MsgApp::getMsgAppMsgId(*pMsgApp));
+            PgePacket& pktBatch = pktBatches[static_cast<size_t>(lane)];
+            const PgePacket& pktBatchAsConst = pktBatch;  // non-const getMessageAppCount() is private
+
+            if (PgePacket::getServerSideConnectionHandle(pkt) != PgePacket::getServerSideConnectionHandle(pktBatchAsConst))
+            {
+                // connection handle is per-packet, so we cannot mix app messages with different connection handle in the same packet
+                if (PgePacket::getMessageAppCount(pktBatchAsConst) > 0)
+                {
+                    sendPkt(conn, pktBatch, lane);
+                    PgePacket::initPktMsgApp(pktBatch, ServerConnHandle, PgePacket::AutoFill::NONE);
+                }
+                PgePacket::getServerSideConnectionHandle(pktBatch) = PgePacket::getServerSideConnectionHandle(pkt);
+            }
+
+            if (!PgePacket::addPktMsgApp(pktBatch, *pMsgApp))
+            {
+                // not enough space in the batch packet, send it out and retry with an empty batch packet
+                sendPkt(conn, pktBatch, lane);
+                PgePacket::initPktMsgApp(pktBatch, PgePacket::getServerSideConnectionHandle(pkt), PgePacket::AutoFill::NONE);
+                if (!PgePacket::addPktMsgApp(pktBatch, *pMsgApp))
+                {
+                    CConsole::getConsoleInstance(m_szLoggerModuleName).EOLn("%s: failed to batch app message %u to connection %u!",
+                        __func__, MsgApp::getMsgAppMsgId(*pMsgApp), conn);
+                    assert(false);
+                }
+            }
+            pMsgApp = PgePacket::getNextMsgAppFromPkt(pkt, *pMsgApp);
+        }
+    }
+
+    /**
+        Sends out the given batch packets to the given connection if they store any app message, and empties the batch packets.
+    */
+    void PgeLoopbackEndpoint::flushBatchPkts(const PgeNetworkConnectionHandle& conn, SendLane2PktBatchArray& pktBatches)
+    {
+        for (size_t iLane = 0; iLane < pktBatches.size(); iLane++)
+        {
+            PgePacket& pktBatch = pktBatches[iLane];
+            const PgePacket& pktBatchAsConst = pktBatch;  // non-const getMessageAppCount() is private
+            if (PgePacket::getMessageAppCount(pktBatchAsConst) == 0)
+            {
+                continue;
+            }
+
+            sendPkt(conn, pktBatch, static_cast<PgeSendLane>(iLane));
+            PgePacket::initPktMsgApp(pktBatch, PgePacket::getServerSideConnectionHandle(pktBatchAsConst), PgePacket::AutoFill::NONE);
+        }
+    }
+
+    PgePacket PgeLoopbackEndpoint::popFrontPacket() noexcept(false)
+    {
+        PgePacket pkt = m_queuePackets.borrowFront();
+        m_queuePackets.releaseFront();
+        return pkt;
+    }
+
+    uint32_t PgeLoopbackEndpoint::getPacketPerSecondCount(
+        const uint32_t& nPktCount,
+        const std::chrono::time_point<std::chrono::steady_clock>& time1stPkt) const
+    {
+        const auto nSecsSince1stPkt =
+            std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - time1stPkt).count();
+
+        return static_cast<uint32_t>(nSecsSince1stPkt != 0 ? (nPktCount / nSecsSince1stPkt) : 0);
+    }
+
+    std::string PgeLoopbackEndpoint::getStringByMsgAppId(const MsgApp::TMsgId& id) const
+    {
+        const auto it = m_mapMsgAppId2String.find(id);
+        if (it != m_mapMsgAppId2String.end())
+        {
+            return it->second;
+        }
+        return "UNKNOWN_MSG";
+    }
+
+    void PgeLoopbackEndpoint::logStats() const
+    {
+        CConsole& con = CConsole::getConsoleInstance(m_szLoggerModuleName);
+        con.OLn("");
+        con.OLn("Total Tx'd Pkt Count : %u, Bytes: %u", m_nTxPktCount, m_nTxByteCount);
+        con.OLn("Total Rx'd Pkt Count : %u, Bytes: %u", m_nRxPktCount, m_nRxByteCount);
+        con.OLn("Total Inj'd Pkt Count: %u, Bytes: %u", m_nInjectPktCount, m_nInjectByteCount);
+        con.OLn("Pkt Queue Capacity       : %u", m_queuePackets.capacity());
+        con.OLn("Pkt Queue High Water Mark: %u", m_queuePackets.getHighWaterMark());
+        con.OLn("Pkt Queue Dropped Count  : %u", m_queuePackets.getDroppedCount());
+
+        const PgeNetworkStats::Direction dirs[] = { PgeNetworkStats::Direction::Tx, PgeNetworkStats::Direction::Rx, PgeNetworkStats::Direction::Inject };
+        for (const auto& dir : dirs)
+        {
+            con.OLnOI("Total %s App Msg Count per AppMsgId:", PgeNetworkStats::getDirectionString(dir));
+            for (const auto& msgCount : m_stats.getMsgAppCountMap(dir))
+            {
+                con.OLn("Id %u %s: %u", msgCount.first, getStringByMsgAppId(msgCount.first).c_str(), msgCount.second);
+            }
+            con.OO();
+        }
+
+        for (const auto& dir : dirs)
+        {
+            con.OLnOI("Total %s App Msg Count per Send Lane:", PgeNetworkStats::getDirectionString(dir));
+            for (const auto& laneMsgCount : m_stats.getLaneMsgCountMap(dir))
+            {
+                con.OLn("%s: %u", getSendLaneString(laneMsgCount.first), laneMsgCount.second);
+            }
+            con.OO();
+        }
+    }
+
+    /**
+        Processes the just received packet the same way as PgeGnsWrapper::pollIncomingMessages() does.
+
+        @param pPktSlot       The back slot of the packet queue the packet was received into, nullptr if the queue is full.
+        @param pkt            The received packet, it is in pPktSlot if that is not nullptr.
+        @param nActualPktSize Received size of the packet.
+        @param timeRx         Time of receiving.
+    */
+    void PgeLoopbackEndpoint::receivePkt(
+        PgePacket* pPktSlot,
+        const PgePacket& pkt,
+        const uint32_t& nActualPktSize,
+        const PgeNetworkStats::TimePoint& timeRx)
+    {
+        if (PgePacket::getPacketId(pkt) == PgePktId::Application)
+        {
+            const uint8_t nMessageCount = PgePacket::getMessageAppCount(pkt);
+            if ((nMessageCount == 0) || (PgePacket::getPktActualSizeBytes(pkt) != nActualPktSize))
+            {
+                CConsole::getConsoleInstance(m_szLoggerModuleName).EOLn("%s: malformed app message pkt (count %u, size %u) from connection %u!",
+                    __func__, nMessageCount, nActualPktSize, PgePacket::getServerSideConnectionHandle(pkt));
+                assert(false);
+                return;
+            }
+
+            // unpacked pkts are written into the queue starting from the same slot we received into, so we unpack from a copy,
+            // compressed app messages are also unpacked, since they are decompressed into separate pkts
+            const bool bUnpack = (nMessageCount > 1) || PgeMsgAppCompressor::hasCompressedMsgApp(pkt);
+            PgePacket pktBatched;
+            if (bUnpack)
+            {
+                memcpy(&pktBatched, &pkt, nActualPktSize);
+            }
+            const PgePacket& pktSrc = bUnpack ? pktBatched : pkt;
+
+            const MsgApp* pMsgApp = PgePacket::getMsgAppFromPkt(pktSrc);
+            MsgApp msgAppDecompressed;
+            uint8_t iAppMsg = 0;
+            for (; (iAppMsg < nMessageCount) && pMsgApp; iAppMsg++)
+            {
+                const MsgApp* const pMsgAppRx = m_compressor.decompressMsgApp(*pMsgApp, msgAppDecompressed);
+                const MsgApp::TMsgId msgAppId = pMsgAppRx ?
+                    MsgApp::getMsgAppMsgId(*pMsgAppRx) :
+                    PgeMsgAppCompressor::getUncompressedMsgAppId(MsgApp::getMsgAppMsgId(*pMsgApp));
+                if (!pMsgAppRx)
+                {
+                    CConsole::getConsoleInstance(m_szLoggerModuleName).EOLn("%s: malformed compressed app message %u received from connection %u!",
+                        __func__, msgAppId, PgePacket::getServerSideConnectionHandle(pktSrc));
+                    assert(false);
+                }
+                else if (!m_allowListedAppMessages.contains(msgAppId))
+                {
+                    CConsole::getConsoleInstance(m_szLoggerModuleName).EOLn("%s: non-allowlisted app message received: %u from connection %u!",
+                        __func__, msgAppId, PgePacket::getServerSideConnectionHandle(pktSrc));
+                    assert(false);
+                }
+                else
+                {
+                    m_stats.addMsgApp(
+                        PgeNetworkStats::Direction::Rx,
+                        msgAppId,
+                        MsgApp::getMsgAppTotalActualSizeBytes(*pMsgApp),
+                        getSendLaneByMsgAppId(msgAppId),
+                        timeRx);
+
+                    // for the 1st app message we already have the slot we received into, it is the same slot beginPushBack() would return
+                    PgePacket* const pPktUnpacked = (iAppMsg == 0) ? pPktSlot : m_queuePackets.beginPushBack();
+                    if (!pPktUnpacked)
+                    {
+                        CConsole::getConsoleInstance(m_szLoggerModuleName).EOLn("%s: packet queue full, dropped app message %u from connection %u!",
+                            __func__, msgAppId, PgePacket::getServerSideConnectionHandle(pktSrc));
+                    }
+                    else if (!bUnpack)
+                    {
+                        // no need to unpack, pkt is already in its slot
+                        m_queuePackets.endPushBack();
+                    }
+                    else
+                    {
+                        PgePacket::initPktMsgApp(*pPktUnpacked, PgePacket::getServerSideConnectionHandle(pktSrc), PgePacket::AutoFill::NONE);
+                        if (PgePacket::addPktMsgApp(*pPktUnpacked, *pMsgAppRx))
+                        {
+                            m_queuePackets.endPushBack();
+                        }
+                        else
+                        {
+                            CConsole::getConsoleInstance(m_szLoggerModuleName).EOLn("%s: failed to unpack app message %u from connection %u!",
+                                __func__, msgAppId, PgePacket::getServerSideConnectionHandle(pktSrc));
+                            assert(false);
+                        }
+                    }
+                }
+                pMsgApp = PgePacket::getNextMsgAppFromPkt(pktSrc, *pMsgApp);
+            }
+
+            if ((iAppMsg != nMessageCount) || pMsgApp)
+            {
+                CConsole::getConsoleInstance(m_szLoggerModuleName).EOLn("%s: app message pkt with inconsistent msg count %u from connection %u!",
+                    __func__, nMessageCount, PgePacket::getServerSideConnectionHandle(pktSrc));
+                assert(false);
+            }
+
+            m_nRxByteCount += nActualPktSize;
+            return;
+        }
+
+        if (!m_allowListedPgeMessages.contains(PgePacket::getPacketId(pkt)))
+        {
+            CConsole::getConsoleInstance(m_szLoggerModuleName).EOLn("%s: non-allowlisted pge message received: %u from connection %u!",
+                __func__, PgePacket::getPacketId(pkt), PgePacket::getServerSideConnectionHandle(pkt));
+            assert(false);
+            return;
+        }
+
+        m_nRxByteCount += nActualPktSize;
+        if (pgeMessageIsHandledAtTransportLevel(pkt))
+        {
+            return;
+        }
+
+        if (pPktSlot)
+        {
+            m_queuePackets.endPushBack();
+        }
+        else
+        {
+            CConsole::getConsoleInstance(m_szLoggerModuleName).EOLn("%s: packet queue full, dropped pge message %u from connection %u!",
+                __func__, PgePacket::getPacketId(pkt), PgePacket::getServerSideConnectionHandle(pkt));
+        }
+    }
+
+    void PgeLoopbackEndpoint::updateTxStats(
+        const PgeNetworkConnectionHandle& conn,
+        const PgePacket& pkt,
+        const uint32_t& nActualPktSize,
+        const PgeSendLane& lane,
+        const PgeNetworkStats::TimePoint& timeTx)
+    {
+        if (m_nTxPktCount == 0)
+        {
+            m_time1stTxPkt = timeTx;
+        }
+        m_nTxPktCount++;
+        m_stats.addPkt(PgeNetworkStats::Direction::Tx, conn, nActualPktSize, timeTx);
+        if (PgePacket::getPacketId(pkt) == PgePktId::Application)
+        {
+            const MsgApp* pMsgApp = PgePacket::getMsgAppFromPkt(pkt);
+            const uint8_t nMessageCount = PgePacket::getMessageAppCount(pkt);
+            for (uint8_t i = 0; (i < nMessageCount) && pMsgApp; i++)
+            {
+                m_stats.addMsgApp(
+                    PgeNetworkStats::Direction::Tx,
+                    PgeMsgAppCompressor::getUncompressedMsgAppId(MsgApp::getMsgAppMsgId(*pMsgApp)),
+                    MsgApp::getMsgAppTotalActualSizeBytes(*pMsgApp),
+                    lane,
+                    timeTx);
+                pMsgApp = PgePacket::getNextMsgAppFromPkt(pkt, *pMsgApp);
+            }
+        }
+        m_nTxByteCount += nActualPktSize;
+    }
+
+} // namespace pge_network
@@ -0,0 +1,133 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeLoopbackEndpoint.h
+    This file is part of PGE.
+    Internal header.
+    PR00F's Game Engine in-process loopback network endpoint
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <array>
+#include <chrono>  // requires cpp11
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "PgeLoopbackTransport.h"
+#include "PgeMsgAppCompressor.h"
+#include "PgeMsgIdAllowList.h"
+#include "PgeNetworkStats.h"
+#include "PgePacket.h"
+#include "PgePacketRing.h"
+
+namespace pge_network
+{
+
+    /**
+        Functionality common to PgeLoopbackServer and PgeLoopbackClient, the loopback counterpart of PgeGnsWrapper:
+        packet queue, allowlists, app message batching per send lane, app message compression, unpacking of received batches, and statistics.
+    */
+    class PgeLoopbackEndpoint
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeLoopbackEndpoint is included")
+#endif
+
+    public:
+
+        static constexpr std::size_t nDefaultRxQueueCapacity = 1024;
+
+        // ---------------------------------------------------------------------------
+
+        virtual ~PgeLoopbackEndpoint() = default;
+
+        PgeLoopbackTransport& getTransport();
+
+    protected:
+
+        /** Batch packets of a connection, 1 per send lane, indexed by pge_network::PgeSendLane. */
+        typedef std::array<PgePacket, nSendLaneCount> SendLane2PktBatchArray;
+
+        PgeLoopbackTransport& m_transport;
+        const PgeLoopbackTransport::Side m_side;
+        const char* const m_szLoggerModuleName;
+        const std::size_t m_nRxQueueCapacity;
+        bool m_bInitialized;
+        PgePacketRing m_queuePackets;
+        PgePktIdAllowList m_allowListedPgeMessages;
+        MsgAppIdAllowList m_allowListedAppMessages;
+        uint32_t m_nRxPktCount;
+        uint32_t m_nTxPktCount;
+        uint32_t m_nInjectPktCount;
+        std::chrono::time_point<std::chrono::steady_clock> m_time1stRxPkt;
+        std::chrono::time_point<std::chrono::steady_clock> m_time1stTxPkt;
+        std::chrono::time_point<std::chrono::steady_clock> m_time1stInjectPkt;
+        PgeNetworkStats m_stats;
+        std::map<MsgApp::TMsgId, std::string> m_mapMsgAppId2String;
+        std::map<MsgApp::TMsgId, PgeSendLane> m_mapMsgAppId2SendLane;
+        PgeMsgAppCompressor m_compressor;
+        uint32_t m_nRxByteCount;
+        uint32_t m_nTxByteCount;
+        uint32_t m_nInjectByteCount;
+        std::string m_sAppVersion;  /**< Expected client app version in case of server instance, or simply client app version in case of client instance. */
+
+        // ---------------------------------------------------------------------------
+
+        static void initPktBatches(SendLane2PktBatchArray& pktBatches);
+        static const char* getSendLaneString(const PgeSendLane& lane);
+
+        PgeLoopbackEndpoint(
+            PgeLoopbackTransport& transport,
+            const PgeLoopbackTransport::Side& side,
+            const char* szLoggerModuleName,
+            const std::size_t& nRxQueueCapacity);
+
+        PgeLoopbackEndpoint(const PgeLoopbackEndpoint&) = delete;
+        PgeLoopbackEndpoint& operator=(const PgeLoopbackEndpoint&) = delete;
+        PgeLoopbackEndpoint(PgeLoopbackEndpoint&&) = delete;
+        PgeLoopbackEndpoint& operator=(PgeLoopbackEndpoint&&) = delete;
+
+        virtual bool pgeMessageIsHandledAtTransportLevel(const PgePacket& pkt) = 0;
+        virtual bool validateIncomingConnection(const PgeNetworkConnectionHandle& connHandle) const = 0;
+        virtual void updateIncomingPgePacket(PgePacket& pkt, const PgeNetworkConnectionHandle& connHandle) const = 0;
+
+        bool initializeEndpoint();
+        void shutdownEndpoint();
+
+        bool receivePkts(const PgeNetworkConnectionHandle& connHandle);
+        void enqueuePkt(const PgePacket& pkt);
+        void injectPkt(const PgePacket& pkt);
+
+        PgeSendLane getSendLaneByMsgAppId(const MsgApp::TMsgId& id) const;
+        void sendPkt(const PgeNetworkConnectionHandle& conn, const PgePacket& pkt, const PgeSendLane& lane);
+        void batchPkt(const PgeNetworkConnectionHandle& conn, SendLane2PktBatchArray& pktBatches, const PgePacket& pkt);
+        void flushBatchPkts(const PgeNetworkConnectionHandle& conn, SendLane2PktBatchArray& pktBatches);
+
+        PgePacket popFrontPacket() noexcept(false);
+        uint32_t getPacketPerSecondCount(const uint32_t& nPktCount, const std::chrono::time_point<std::chrono::steady_clock>& time1stPkt) const;
+
+        std::string getStringByMsgAppId(const MsgApp::TMsgId& id) const;
+        void logStats() const;
+
+    private:
+
+        void receivePkt(
+            PgePacket* pPktSlot,
+            const PgePacket& pkt,
+            const uint32_t& nActualPktSize,
+            const PgeNetworkStats::TimePoint& timeRx);
+        void updateTxStats(
+            const PgeNetworkConnectionHandle& conn,
+            const PgePacket& pkt,
+            const uint32_t& nActualPktSize,
+            const PgeSendLane& lane,
+            const PgeNetworkStats::TimePoint& timeTx);
+
+    }; // class PgeLoopbackEndpoint
+
+} // namespace pge_network
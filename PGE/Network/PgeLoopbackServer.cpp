@@ -0,0 +1,588 @@
+/*
+    ###################################################################################
+    PgeLoopbackServer.cpp
+    This file is part of PGE.
+    PR00F's Game Engine in-process loopback network server
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgeLoopbackServer.h"
+
+#include <cassert>
+#include <sstream>
+
+namespace pge_network {
+
+    /**
+        @param transport        The medium to be used, must outlive this server.
+        @param nRxQueueCapacity Capacity of the packet queue.
+    */
+    PgeLoopbackServer::PgeLoopbackServer(PgeLoopbackTransport& transport, const std::size_t& nRxQueueCapacity) :
+        PgeLoopbackEndpoint(transport, PgeLoopbackTransport::Side::Server, getLoggerModuleName(), nRxQueueCapacity)
+    {
+        // same as PgeServerImpl
+        m_allowListedPgeMessages.insert(MsgClientAppVersionFromClient::id);
+        m_allowListedPgeMessages.insert(MsgApp::id);
+    }
+
+    PgeLoopbackServer::~PgeLoopbackServer()
+    {
+        shutdown();
+    }
+
+    bool PgeLoopbackServer::isListening() const
+    {
+        return m_bInitialized && m_transport.isListening();
+    }
+
+    /**
+        @return Number of connected clients, including those not yet admitted by app version check.
+    */
+    std::size_t PgeLoopbackServer::getClientCount() const
+    {
+        return m_vClients.size();
+    }
+
+    bool PgeLoopbackServer::initialize()
+    {
+        return initializeEndpoint();
+    }
+
+    bool PgeLoopbackServer::shutdown()
+    {
+        disconnect("shutdown");
+        shutdownEndpoint();
+        return true;
+    }
+
+    bool PgeLoopbackServer::isInitialized() const
+    {
+        return m_bInitialized;
+    }
+
+    /**
+        Same as PgeGnsServer::stopListening(): all clients are notified about all other clients and the server disconnecting,
+        and MsgUserDisconnectedFromServer is injected with ServerConnHandle.
+    */
+    void PgeLoopbackServer::disconnect(const std::string& sExtraDebugText)
+    {
+        if (!isListening())
+        {
+            return;
+        }
+
+        // whatever app messages are still waiting in batches, we send them out before closing connections
+        flushBatchedPackets();
+
+        CConsole::getConsoleInstance(getLoggerModuleName()).OLn(
+            "Server closing connections for %u client(s) ... Reason: %s",
+            m_vClients.size(),
+            sExtraDebugText.empty() ? "unspecified" : sExtraDebugText.c_str());
+
+        PgePacket pkt;
+        PgePacket::initPktPgeMsgUserDisconnected(pkt, ServerConnHandle);
+        sendToAllClientsExcept(pkt);
+        for (const auto& client : m_vClients)
+        {
+            PgePacket::initPktPgeMsgUserDisconnected(pkt, client.m_hConn);
+            sendToAllClientsExcept(pkt, client.m_hConn);
+        }
+
+        // already sent packets are still delivered, as with lingering
+        m_transport.stopListening();
+        m_vClients.clear();
+
+        PgePacket::initPktPgeMsgUserDisconnected(pkt, ServerConnHandle);
+        enqueuePkt(pkt);
+    }
+
+    void PgeLoopbackServer::Update()
+    {
+        pollIncomingMessages();  // receives all packets due, no need to loop
+        pollConnectionStateChanges();
+    }
+
+    bool PgeLoopbackServer::pollIncomingMessages()
+    {
+        if (!isListening())
+        {
+            return false;
+        }
+        return receivePkts(ServerConnHandle);
+    }
+
+    void PgeLoopbackServer::pollConnectionStateChanges()
+    {
+        if (!isListening())
+        {
+            return;
+        }
+
+        PgeLoopbackTransport::ConnEvent connEvent;
+        while (m_transport.receiveConnEvent(ServerConnHandle, PgeLoopbackTransport::Side::Server, connEvent))
+        {
+            switch (connEvent.m_kind)
+            {
+            case PgeLoopbackTransport::ConnEventKind::Connecting:
+            {
+                assert(!findClient(connEvent.m_connHandle));
+                TClient& client = addClient(connEvent.m_connHandle);
+                snprintf(client.m_szAddr, sizeof(client.m_szAddr), "loopback:%u", connEvent.m_connHandle);
+                m_transport.accept(connEvent.m_connHandle);
+                // as with PgeGnsServer, MsgUserConnected is injected only after receiving matching MsgClientAppVersionFromClient
+                break;
+            }
+            case PgeLoopbackTransport::ConnEventKind::Closed:
+            {
+                if (!findClient(connEvent.m_connHandle))
+                {
+                    break;
+                }
+                removeClient(connEvent.m_connHandle);
+                m_stats.removeConnection(connEvent.m_connHandle);
+
+                PgePacket pkt;
+                PgePacket::initPktPgeMsgUserDisconnected(pkt, connEvent.m_connHandle);
+                enqueuePkt(pkt);
+                sendToAllClientsExcept(pkt);
+                break;
+            }
+            default:
+                CConsole::getConsoleInstance(getLoggerModuleName()).EOLn("%s: unexpected event %u from connection %u!",
+                    __func__, static_cast<unsigned>(connEvent.m_kind), connEvent.m_connHandle);
+                break;
+            }
+        }
+    }
+
+    std::size_t PgeLoopbackServer::getPacketQueueSize() const
+    {
+        return m_queuePackets.size();
+    }
+
+    PgePacket PgeLoopbackServer::popFrontPacket() noexcept(false)
+    {
+        return PgeLoopbackEndpoint::popFrontPacket();
+    }
+
+    const PgePacket& PgeLoopbackServer::borrowFrontPacket() noexcept(false)
+    {
+        return m_queuePackets.borrowFront();
+    }
+
+    void PgeLoopbackServer::releaseFrontPacket()
+    {
+        m_queuePackets.releaseFront();
+    }
+
+    uint32_t PgeLoopbackServer::getPacketQueueDroppedCount() const
+    {
+        return m_queuePackets.getDroppedCount();
+    }
+
+    std::size_t PgeLoopbackServer::getPacketQueueHighWaterMark() const
+    {
+        return m_queuePackets.getHighWaterMark();
+    }
+
+    PgePktIdAllowList& PgeLoopbackServer::getAllowListedPgeMessages()
+    {
+        return m_allowListedPgeMessages;
+    }
+
+    MsgAppIdAllowList& PgeLoopbackServer::getAllowListedAppMessages()
+    {
+        return m_allowListedAppMessages;
+    }
+
+    std::map<MsgApp::TMsgId, PgeSendLane>& PgeLoopbackServer::getMsgAppId2SendLaneMap()
+    {
+        return m_mapMsgAppId2SendLane;
+    }
+
+    PgeMsgAppCompressor& PgeLoopbackServer::getMsgAppCompressor()
+    {
+        return m_compressor;
+    }
+
+    std::map<MsgApp::TMsgId, PgeMsgAppCompressor::MsgAppStats> PgeLoopbackServer::getMsgAppCompressionStats() const
+    {
+        return m_compressor.getStats();
+    }
+
+    void PgeLoopbackServer::send(const PgePacket& pkt, const PgeNetworkConnectionHandle& connHandle)
+    {
+        if (connHandle == ServerConnHandle)
+        {
+            injectPkt(pkt);
+            return;
+        }
+
+        TClient* const pClient = findClient(connHandle);
+        if (!pClient)
+        {
+            CConsole::getConsoleInstance(getLoggerModuleName()).EOLn("%s: unknown connection %u!", __func__, connHandle);
+            return;
+        }
+        batchPkt(pClient->m_hConn, pClient->m_pktBatches, pkt);
+    }
+
+    void PgeLoopbackServer::flushBatchedPackets()
+    {
+        for (auto& client : m_vClients)
+        {
+            flushBatchPkts(client.m_hConn, client.m_pktBatches);
+        }
+    }
+
+    uint32_t PgeLoopbackServer::getRxPacketCount() const
+    {
+        return m_nRxPktCount;
+    }
+
+    uint32_t PgeLoopbackServer::getTxPacketCount() const
+    {
+        return m_nTxPktCount;
+    }
+
+    uint32_t PgeLoopbackServer::getInjectPacketCount() const
+    {
+        return m_nInjectPktCount;
+    }
+
+    uint32_t PgeLoopbackServer::getRxPacketPerSecondCount() const
+    {
+        return getPacketPerSecondCount(m_nRxPktCount, m_time1stRxPkt);
+    }
+
+    uint32_t PgeLoopbackServer::getTxPacketPerSecondCount() const
+    {
+        return getPacketPerSecondCount(m_nTxPktCount, m_time1stTxPkt);
+    }
+
+    uint32_t PgeLoopbackServer::getInjectPacketPerSecondCount() const
+    {
+        return getPacketPerSecondCount(m_nInjectPktCount, m_time1stInjectPkt);
+    }
+
+    const std::map<MsgApp::TMsgId, uint32_t>& PgeLoopbackServer::getRxMsgCount() const
+    {
+        return m_stats.getMsgAppCountMap(PgeNetworkStats::Direction::Rx);
+    }
+
+    const std::map<MsgApp::TMsgId, uint32_t>& PgeLoopbackServer::getTxMsgCount() const
+    {
+        return m_stats.getMsgAppCountMap(PgeNetworkStats::Direction::Tx);
+    }
+
+    const std::map<MsgApp::TMsgId, uint32_t>& PgeLoopbackServer::getInjectMsgCount() const
+    {
+        return m_stats.getMsgAppCountMap(PgeNetworkStats::Direction::Inject);
+    }
+
+    const std::map<PgeSendLane, uint32_t>& PgeLoopbackServer::getRxLaneMsgCount() const
+    {
+        return m_stats.getLaneMsgCountMap(PgeNetworkStats::Direction::Rx);
+    }
+
+    const std::map<PgeSendLane, uint32_t>& PgeLoopbackServer::getTxLaneMsgCount() const
+    {
+        return m_stats.getLaneMsgCountMap(PgeNetworkStats::Direction::Tx);
+    }
+
+    const PgeNetworkStats& PgeLoopbackServer::getNetworkStats() const
+    {
+        return m_stats;
+    }
+
+    std::map<MsgApp::TMsgId, std::string>& PgeLoopbackServer::getMsgAppId2StringMap()
+    {
+        return m_mapMsgAppId2String;
+    }
+
+    uint32_t PgeLoopbackServer::getRxByteCount() const
+    {
+        return m_nRxByteCount;
+    }
+
+    uint32_t PgeLoopbackServer::getTxByteCount() const
+    {
+        return m_nTxByteCount;
+    }
+
+    uint32_t PgeLoopbackServer::getInjectByteCount() const
+    {
+        return m_nInjectByteCount;
+    }
+
+    PgeHandoffStats PgeLoopbackServer::getHandoffStats() const
+    {
+        return PgeHandoffStats();
+    }
+
+    PgeConnectionTelemetry PgeLoopbackServer::getConnectionTelemetry() const
+    {
+        return PgeConnectionTelemetry();
+    }
+
+    void PgeLoopbackServer::WriteList() const
+    {
+        CConsole& con = CConsole::getConsoleInstance(getLoggerModuleName());
+        con.OLnOI("PgeLoopbackServer::WriteList() start");
+        if (isInitialized())
+        {
+            con.OLn("Role: Loopback Server, listening: %b", isListening());
+            con.OLnOI("Listing Clients:");
+            for (const auto& client : m_vClients)
+            {
+                con.OLn("connHandle: %u; Name: %s; Address: %s", client.m_hConn, client.m_sCustomName.c_str(), client.m_szAddr);
+            }
+            con.OO();
+            logStats();
+        }
+        else
+        {
+            con.OLn("PgeLoopbackServer is NOT initialized!");
+        }
+        con.OOOLn("PgeLoopbackServer::WriteList() end");
+    }
+
+    /**
+        Same as PgeGnsServer::startListening(), MsgUserConnectedServerSelf is injected with ServerConnHandle.
+    */
+    bool PgeLoopbackServer::startListening(const std::string& sAppVersion)
+    {
+        if (!isInitialized())
+        {
+            CConsole::getConsoleInstance(getLoggerModuleName()).EOLn("%s() ERROR: not initialized!", __func__);
+            return false;
+        }
+
+        if (!m_transport.listen())
+        {
+            CConsole::getConsoleInstance(getLoggerModuleName()).EOLn("%s() ERROR: transport is already listening!", __func__);
+            return false;
+        }
+
+        m_sAppVersion = sAppVersion;
+
+        PgePacket pktUserConnected;
+        PgePacket::initPktPgeMsgUserConnected(pktUserConnected, ServerConnHandle, true /* bCurrentClient */, "");
+        enqueuePkt(pktUserConnected);
+        return true;
+    }
+
+    void PgeLoopbackServer::sendToAllClientsExcept(const PgePacket& pkt, const PgeNetworkConnectionHandle& exceptConnHandle)
+    {
+        for (auto& client : m_vClients)
+        {
+            if (client.m_hConn != exceptConnHandle)
+            {
+                batchPkt(client.m_hConn, client.m_pktBatches, pkt);
+            }
+        }
+    }
+
+    void PgeLoopbackServer::sendToAllClientsExcept(const PgePacket& pkt, const std::set<PgeNetworkConnectionHandle>& exceptConnHandles)
+    {
+        for (auto& client : m_vClients)
+        {
+            if (exceptConnHandles.find(client.m_hConn) == exceptConnHandles.end())
+            {
+                batchPkt(client.m_hConn, client.m_pktBatches, pkt);
+            }
+        }
+    }
+
+    void PgeLoopbackServer::sendToAll(const PgePacket& pkt)
+    {
+        send(pkt);
+        sendToAllClientsExcept(pkt);
+    }
+
+    void PgeLoopbackServer::setDebugNickname(const PgeNetworkConnectionHandle& connHandle, const std::string& sNickname)
+    {
+        TClient* const pClient = findClient(connHandle);
+        if (!pClient)
+        {
+            CConsole::getConsoleInstance(getLoggerModuleName()).EOLn("%s: connHandle %u not valid!", __func__, connHandle);
+            return;
+        }
+        pClient->m_sCustomName = sNickname;
+    }
+
+    /**
+        @return Round-trip time in milliseconds, based on the configured latency and average jitter.
+    */
+    int PgeLoopbackServer::getPing(const PgeNetworkConnectionHandle&, bool)
+    {
+        const PgeLoopbackTransport::LinkConfig& linkConfig = m_transport.getLinkConfig();
+        return static_cast<int>((2 * linkConfig.m_nLatencyUSecs + linkConfig.m_nJitterUSecs) / 1000);
+    }
+
+    /**
+        @return Ratio of packets not lost on unreliable lanes, based on the configured loss rate.
+    */
+    float PgeLoopbackServer::getQualityLocal(const PgeNetworkConnectionHandle&, bool)
+    {
+        return 1.f - m_transport.getLinkConfig().m_fLossRate;
+    }
+
+    float PgeLoopbackServer::getQualityRemote(const PgeNetworkConnectionHandle&, bool)
+    {
+        return 1.f - m_transport.getLinkConfig().m_fLossRate;
+    }
+
+    float PgeLoopbackServer::getRxByteRate(const PgeNetworkConnectionHandle& connHandle, bool)
+    {
+        const PgeNetworkStats::Record* const pRecord = m_stats.getConnectionRecord(PgeNetworkStats::Direction::Rx, connHandle);
+        return pRecord ? static_cast<float>(pRecord->getBytesPerSecond(std::chrono::steady_clock::now())) : 0.f;
+    }
+
+    float PgeLoopbackServer::getTxByteRate(const PgeNetworkConnectionHandle& connHandle, bool)
+    {
+        const PgeNetworkStats::Record* const pRecord = m_stats.getConnectionRecord(PgeNetworkStats::Direction::Tx, connHandle);
+        return pRecord ? static_cast<float>(pRecord->getBytesPerSecond(std::chrono::steady_clock::now())) : 0.f;
+    }
+
+    int64_t PgeLoopbackServer::getPendingUnreliableBytes(const PgeNetworkConnectionHandle& connHandle, bool)
+    {
+        return static_cast<int64_t>(m_transport.getInFlightBytes(connHandle, PgeLoopbackTransport::Side::Server, false));
+    }
+
+    int64_t PgeLoopbackServer::getPendingReliableBytes(const PgeNetworkConnectionHandle& connHandle, bool)
+    {
+        return static_cast<int64_t>(m_transport.getInFlightBytes(connHandle, PgeLoopbackTransport::Side::Server, true));
+    }
+
+    /**
+        There are no acks in the loopback transport, reliable packets in flight are the unacked ones.
+    */
+    int64_t PgeLoopbackServer::getSentButUnAckedReliableBytes(const PgeNetworkConnectionHandle& connHandle, bool bForceUpdate)
+    {
+        return getPendingReliableBytes(connHandle, bForceUpdate);
+    }
+
+    int64_t PgeLoopbackServer::getInternalQueueTimeUSecs(const PgeNetworkConnectionHandle& connHandle, bool)
+    {
+        return m_transport.getQueueTimeUSecs(connHandle, PgeLoopbackTransport::Side::Server);
+    }
+
+    std::string PgeLoopbackServer::getDetailedConnectionStatus(const PgeNetworkConnectionHandle& connHandle) const
+    {
+        const TClient* const pClient = findClient(connHandle);
+        if (!pClient)
+        {
+            return "";
+        }
+
+        const PgeLoopbackTransport::LinkConfig& linkConfig = m_transport.getLinkConfig();
+        std::stringstream ss;
+        ss << "Loopback connection " << connHandle << " (" << pClient->m_sCustomName << ")\n"
+            << "Latency: " << linkConfig.m_nLatencyUSecs << " us, jitter: " << linkConfig.m_nJitterUSecs << " us, loss rate: "
+            << linkConfig.m_fLossRate << ", bandwidth: " << linkConfig.m_nBandwidthBytesPerSec << " bytes/s\n"
+            << "In flight to client: " << m_transport.getInFlightBytes(connHandle, PgeLoopbackTransport::Side::Server, true) << " reliable bytes, "
+            << m_transport.getInFlightBytes(connHandle, PgeLoopbackTransport::Side::Server, false) << " unreliable bytes\n"
+            << "In flight to server: " << m_transport.getInFlightBytes(connHandle, PgeLoopbackTransport::Side::Client, true) << " reliable bytes, "
+            << m_transport.getInFlightBytes(connHandle, PgeLoopbackTransport::Side::Client, false) << " unreliable bytes\n";
+        return ss.str();
+    }
+
+    /**
+        Same as PgeGnsServer::pgeMessageIsHandledAtGnsLevel(): checks the client app version, and either admits the client by
+        injecting MsgUserConnectedServerSelf, or disconnects the client.
+    */
+    bool PgeLoopbackServer::pgeMessageIsHandledAtTransportLevel(const PgePacket& pkt)
+    {
+        if (PgePacket::getPacketId(pkt) != MsgClientAppVersionFromClient::id)
+        {
+            return false;
+        }
+
+        const PgeNetworkConnectionHandle connHandle = PgePacket::getServerSideConnectionHandle(pkt);
+        const TClient* const pClient = findClient(connHandle);
+        if (!pClient)
+        {
+            // validateIncomingConnection() already filtered out unknown connections
+            assert(false);
+            return true;
+        }
+
+        const auto& msgClientAppVersion = PgePacket::getMessageAsClientAppVersionFromClient(pkt);
+        if (m_sAppVersion == msgClientAppVersion.m_szAppVersion)
+        {
+            PgePacket pktUserConnected;
+            PgePacket::initPktPgeMsgUserConnected(pktUserConnected, connHandle, false /* bCurrentClient */, pClient->m_szAddr);
+            enqueuePkt(pktUserConnected);
+        }
+        else
+        {
+            CConsole::getConsoleInstance(getLoggerModuleName()).EOLn("%s: client (%u) app version mismatching (%s), disconnecting client!",
+                __func__, connHandle, msgClientAppVersion.m_szAppVersion);
+            removeClient(connHandle);
+            m_transport.close(connHandle, PgeLoopbackTransport::Side::Server);
+        }
+        return true;
+    }
+
+    bool PgeLoopbackServer::validateIncomingConnection(const PgeNetworkConnectionHandle& connHandle) const
+    {
+        if (!findClient(connHandle))
+        {
+            CConsole::getConsoleInstance(getLoggerModuleName()).EOLn("%s: failed to find connection %u in m_vClients!", __func__, connHandle);
+            return false;
+        }
+        return true;
+    }
+
+    void PgeLoopbackServer::updateIncomingPgePacket(PgePacket& pkt, const PgeNetworkConnectionHandle& connHandle) const
+    {
+        PgePacket::getServerSideConnectionHandle(pkt) = connHandle;
+    }
+
+    const PgeLoopbackServer::TClient* PgeLoopbackServer::findClient(const PgeNetworkConnectionHandle& connHandle) const
+    {
+        for (const auto& client : m_vClients)
+        {
+            if (client.m_hConn == connHandle)
+            {
+                return &client;
+            }
+        }
+        return nullptr;
+    }
+
+    PgeLoopbackServer::TClient* PgeLoopbackServer::findClient(const PgeNetworkConnectionHandle& connHandle)
+    {
+        return const_cast<TClient*>(static_cast<const PgeLoopbackServer*>(this)->findClient(connHandle));
+    }
+
+    PgeLoopbackServer::TClient& PgeLoopbackServer::addClient(const PgeNetworkConnectionHandle& connHandle)
+    {
+        // value-initialization zeroes the address too
+        m_vClients.emplace_back();
+        TClient& client = m_vClients.back();
+        client.m_hConn = connHandle;
+        initPktBatches(client.m_pktBatches);
+        return client;
+    }
+
+    void PgeLoopbackServer::removeClient(const PgeNetworkConnectionHandle& connHandle)
+    {
+        TClient* const pClient = findClient(connHandle);
+        if (!pClient)
+        {
+            return;
+        }
+
+        if (pClient != &m_vClients.back())
+        {
+            *pClient = std::move(m_vClients.back());
+        }
+        m_vClients.pop_back();
+    }
+
+} // namespace pge_network
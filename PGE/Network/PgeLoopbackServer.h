@@ -0,0 +1,170 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeLoopbackServer.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine in-process loopback network server
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "PgeIServer.h"
+#include "PgeLoopbackEndpoint.h"
+#include "PgeLoopbackTransport.h"
+#include "PgePacket.h"
+
+namespace pge_network
+{
+
+    /**
+        Server instance communicating with PgeLoopbackClient instances through a PgeLoopbackTransport, without any socket.
+        Behaves the same way as PgeServer at application level: it injects the same PGE messages on the same events, checks the
+        client app version, batches app messages per connection and send lane, and unpacks received batches.
+
+        Unlike PgeServer, any number of instances can be created, and it doesn't need the rest of the engine, so it can be used
+        in headless benchmarks and tests.
+    */
+    class PgeLoopbackServer : public PgeIServer, protected PgeLoopbackEndpoint
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeLoopbackServer is included")
+#endif
+
+    public:
+
+        static const char* getLoggerModuleName()
+        {
+            return "PgeLoopbackServer";
+        }
+
+        // ---------------------------------------------------------------------------
+
+        explicit PgeLoopbackServer(PgeLoopbackTransport& transport, const std::size_t& nRxQueueCapacity = nDefaultRxQueueCapacity);
+        virtual ~PgeLoopbackServer();
+
+        PgeLoopbackServer(const PgeLoopbackServer&) = delete;
+        PgeLoopbackServer& operator=(const PgeLoopbackServer&) = delete;
+        PgeLoopbackServer(PgeLoopbackServer&&) = delete;
+        PgeLoopbackServer& operator=(PgeLoopbackServer&&) = delete;
+
+        using PgeLoopbackEndpoint::getTransport;
+
+        bool isListening() const;
+        std::size_t getClientCount() const;
+
+        /* implement stuff from PgeIServerClient start */
+
+        bool initialize() override;
+        bool shutdown() override;
+        bool isInitialized() const override;
+        void disconnect(const std::string& sExtraDebugText = "") override;
+
+        void Update() override;
+
+        bool pollIncomingMessages() override;
+        void pollConnectionStateChanges() override;
+
+        std::size_t getPacketQueueSize() const override;
+        PgePacket popFrontPacket() noexcept(false) override;
+        const PgePacket& borrowFrontPacket() noexcept(false) override;
+        void releaseFrontPacket() override;
+        uint32_t getPacketQueueDroppedCount() const override;
+        std::size_t getPacketQueueHighWaterMark() const override;
+
+        PgePktIdAllowList& getAllowListedPgeMessages() override;
+        MsgAppIdAllowList& getAllowListedAppMessages() override;
+        std::map<MsgApp::TMsgId, PgeSendLane>& getMsgAppId2SendLaneMap() override;
+        PgeMsgAppCompressor& getMsgAppCompressor() override;
+        std::map<MsgApp::TMsgId, PgeMsgAppCompressor::MsgAppStats> getMsgAppCompressionStats() const override;
+
+        void send(const PgePacket& pkt, const PgeNetworkConnectionHandle& connHandle = ServerConnHandle) override;
+        void flushBatchedPackets() override;
+
+        uint32_t getRxPacketCount() const override;
+        uint32_t getTxPacketCount() const override;
+        uint32_t getInjectPacketCount() const override;
+
+        uint32_t getRxPacketPerSecondCount() const override;
+        uint32_t getTxPacketPerSecondCount() const override;
+        uint32_t getInjectPacketPerSecondCount() const override;
+
+        const std::map<MsgApp::TMsgId, uint32_t>& getRxMsgCount() const override;
+        const std::map<MsgApp::TMsgId, uint32_t>& getTxMsgCount() const override;
+        const std::map<MsgApp::TMsgId, uint32_t>& getInjectMsgCount() const override;
+
+        const std::map<PgeSendLane, uint32_t>& getRxLaneMsgCount() const override;
+        const std::map<PgeSendLane, uint32_t>& getTxLaneMsgCount() const override;
+
+        const PgeNetworkStats& getNetworkStats() const override;
+
+        std::map<MsgApp::TMsgId, std::string>& getMsgAppId2StringMap() override;
+
+        uint32_t getRxByteCount() const override;
+        uint32_t getTxByteCount() const override;
+        uint32_t getInjectByteCount() const override;
+        PgeHandoffStats getHandoffStats() const override;  /**< Loopback has no handoff, always empty. */
+        PgeConnectionTelemetry getConnectionTelemetry() const override;  /**< Loopback has no connection status, always empty. */
+
+        void WriteList() const override;
+
+        /* implement stuff from PgeIServerClient end */
+
+        /* implement stuff from PgeIServer start */
+
+        bool startListening(const std::string& sAppVersion = "") override;
+
+        void sendToAllClientsExcept(const PgePacket& pkt, const PgeNetworkConnectionHandle& exceptConnHandle = ServerConnHandle) override;
+        void sendToAllClientsExcept(const PgePacket& pkt, const std::set<PgeNetworkConnectionHandle>& exceptConnHandles) override;
+        void sendToAll(const PgePacket& pkt) override;
+
+        void setDebugNickname(const PgeNetworkConnectionHandle& connHandle, const std::string& sNickname) override;
+
+        int getPing(const PgeNetworkConnectionHandle& connHandle, bool bForceUpdate) override;
+        float getQualityLocal(const PgeNetworkConnectionHandle& connHandle, bool bForceUpdate) override;
+        float getQualityRemote(const PgeNetworkConnectionHandle& connHandle, bool bForceUpdate) override;
+        float getRxByteRate(const PgeNetworkConnectionHandle& connHandle, bool bForceUpdate) override;
+        float getTxByteRate(const PgeNetworkConnectionHandle& connHandle, bool bForceUpdate) override;
+        int64_t getPendingUnreliableBytes(const PgeNetworkConnectionHandle& connHandle, bool bForceUpdate) override;
+        int64_t getPendingReliableBytes(const PgeNetworkConnectionHandle& connHandle, bool bForceUpdate) override;
+        int64_t getSentButUnAckedReliableBytes(const PgeNetworkConnectionHandle& connHandle, bool bForceUpdate) override;
+        int64_t getInternalQueueTimeUSecs(const PgeNetworkConnectionHandle& connHandle, bool bForceUpdate) override;
+        std::string getDetailedConnectionStatus(const PgeNetworkConnectionHandle& connHandle) const override;
+
+        /* implement stuff from PgeIServer end */
+
+    protected:
+
+        bool pgeMessageIsHandledAtTransportLevel(const PgePacket& pkt) override;
+        bool validateIncomingConnection(const PgeNetworkConnectionHandle& connHandle) const override;
+        void updateIncomingPgePacket(PgePacket& pkt, const PgeNetworkConnectionHandle& connHandle) const override;
+
+    private:
+
+        struct TClient
+        {
+            PgeNetworkConnectionHandle m_hConn;
+            std::string m_sCustomName;  /**< App level can set a custom name for client which is useful for debugging. */
+            char m_szAddr[MsgUserConnectedServerSelf::nIpAddressMaxLength];
+            SendLane2PktBatchArray m_pktBatches;  /**< App messages sent to this client are batched here per send lane until flushBatchedPackets(). */
+        };
+
+        std::vector<TClient> m_vClients;  /**< Unlike PgeGnsServer, the server itself is not stored here. */
+
+        // ---------------------------------------------------------------------------
+
+        const TClient* findClient(const PgeNetworkConnectionHandle& connHandle) const;
+        TClient* findClient(const PgeNetworkConnectionHandle& connHandle);
+        TClient& addClient(const PgeNetworkConnectionHandle& connHandle);
+        void removeClient(const PgeNetworkConnectionHandle& connHandle);
+
+    }; // class PgeLoopbackServer
+
+} // namespace pge_network
@@ -0,0 +1,564 @@
+/*
+    ###################################################################################
+    PgeLoopbackTransport.cpp
+    This file is part of PGE.
+    PR00F's Game Engine in-process loopback network medium
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgeLoopbackTransport.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace pge_network {
+
+    static PgeLoopbackTransport::Side getPeerSide(const PgeLoopbackTransport::Side& side)
+    {
+        return (side == PgeLoopbackTransport::Side::Server) ? PgeLoopbackTransport::Side::Client : PgeLoopbackTransport::Side::Server;
+    }
+
+    static std::size_t getSideIndex(const PgeLoopbackTransport::Side& side)
+    {
+        return static_cast<std::size_t>(side);
+    }
+
+    /**
+        Ideal link: no latency, no loss, unlimited bandwidth.
+    */
+    PgeLoopbackTransport::PgeLoopbackTransport() :
+        PgeLoopbackTransport(LinkConfig())
+    {
+    }
+
+    /**
+        @param linkConfig Properties of all connections, can be changed later by setLinkConfig().
+        @param nSeed      Seed of the pseudo-random generator used for jitter and loss.
+    */
+    PgeLoopbackTransport::PgeLoopbackTransport(const LinkConfig& linkConfig, const uint64_t& nSeed) :
+        m_linkConfig(linkConfig),
+        m_nRandomState(nSeed),
+        m_nTime(0),
+        m_nSeq(0),
+        m_bListening(false),
+        m_nSentCount(0),
+        m_nDeliveredCount(0),
+        m_nLostCount(0)
+    {
+        m_nInFlightCount.fill(0);
+        m_nInFlightHighWaterMark.fill(0);
+    }
+
+    const PgeLoopbackTransport::LinkConfig& PgeLoopbackTransport::getLinkConfig() const
+    {
+        return m_linkConfig;
+    }
+
+    /**
+        Packets already in flight are not affected.
+    */
+    void PgeLoopbackTransport::setLinkConfig(const LinkConfig& linkConfig)
+    {
+        m_linkConfig = linkConfig;
+    }
+
+    /**
+        @return Simulated time elapsed since construction, in microseconds.
+    */
+    const PgeLoopbackTransport::TTimeUSecs& PgeLoopbackTransport::getTime() const
+    {
+        return m_nTime;
+    }
+
+    /**
+        Advances the simulated time, so packets and connection state changes due by the new time become receivable.
+        Negative value is ignored.
+    */
+    void PgeLoopbackTransport::advanceTime(const TTimeUSecs& nUSecs)
+    {
+        if (nUSecs > 0)
+        {
+            m_nTime += nUSecs;
+        }
+    }
+
+    /**
+        Lets clients connect.
+
+        @return True on success, false if already listening.
+    */
+    bool PgeLoopbackTransport::listen()
+    {
+        if (m_bListening)
+        {
+            return false;
+        }
+        m_bListening = true;
+        return true;
+    }
+
+    /**
+        Closes all connections from server side, and discards everything on the way to the server.
+    */
+    void PgeLoopbackTransport::stopListening()
+    {
+        for (std::size_t i = 0; i < m_vConnections.size(); i++)
+        {
+            close(static_cast<PgeNetworkConnectionHandle>(i + 1), Side::Server);
+        }
+        discardInbox(m_inboxServer, Side::Client);
+        m_bListening = false;
+    }
+
+    bool PgeLoopbackTransport::isListening() const
+    {
+        return m_bListening;
+    }
+
+    /**
+        Opens a new connection from a client, server will receive ConnEventKind::Connecting for it.
+
+        @return Handle of the new connection, the same on both sides. ServerConnHandle if server is not listening.
+    */
+    PgeNetworkConnectionHandle PgeLoopbackTransport::connect()
+    {
+        if (!m_bListening)
+        {
+            return ServerConnHandle;
+        }
+
+        m_vConnections.emplace_back();
+        Connection& conn = m_vConnections.back();
+        conn.m_bAttached.fill(true);
+        conn.m_nTimeLinkFree.fill(m_nTime);
+        conn.m_nTimeLastReliable.fill(m_nTime);
+        conn.m_nInFlightBytesReliable.fill(0);
+        conn.m_nInFlightBytesUnreliable.fill(0);
+
+        const PgeNetworkConnectionHandle connHandle = static_cast<PgeNetworkConnectionHandle>(m_vConnections.size());
+        pushConnEvent(connHandle, conn, Side::Client, ConnEventKind::Connecting);
+        return connHandle;
+    }
+
+    /**
+        Invoked by server, client will receive ConnEventKind::Accepted.
+    */
+    void PgeLoopbackTransport::accept(const PgeNetworkConnectionHandle& connHandle)
+    {
+        Connection* const pConn = findConnection(connHandle);
+        if (!pConn || !pConn->m_bAttached[getSideIndex(Side::Server)])
+        {
+            return;
+        }
+        pushConnEvent(connHandle, *pConn, Side::Server, ConnEventKind::Accepted);
+    }
+
+    /**
+        Closes the given connection from the given side. Packets already sent by this side are still delivered, as with lingering,
+        then the other side receives ConnEventKind::Closed, and packets sent after that by the other side are discarded.
+        Everything not yet received by this side on this connection is discarded.
+    */
+    void PgeLoopbackTransport::close(const PgeNetworkConnectionHandle& connHandle, const Side& side)
+    {
+        Connection* const pConn = findConnection(connHandle);
+        if (!pConn || !pConn->m_bAttached[getSideIndex(side)])
+        {
+            return;
+        }
+
+        pConn->m_bAttached[getSideIndex(side)] = false;
+        if (side == Side::Client)
+        {
+            discardInbox(pConn->m_inboxClient, Side::Server);
+        }
+        // server inbox is shared by all connections, packets of this connection are discarded when reaching the front
+
+        if (pConn->m_bAttached[getSideIndex(getPeerSide(side))])
+        {
+            pushConnEvent(connHandle, *pConn, side, ConnEventKind::Closed);
+        }
+    }
+
+    /**
+        @return True if the given side can still send and receive on the given connection, false if it has closed the connection,
+                or has already received ConnEventKind::Closed, or the connection doesn't exist.
+    */
+    bool PgeLoopbackTransport::isAttached(const PgeNetworkConnectionHandle& connHandle, const Side& side) const
+    {
+        const Connection* const pConn = findConnection(connHandle);
+        return pConn && pConn->m_bAttached[getSideIndex(side)];
+    }
+
+    /**
+        Sends the first nSize bytes of the given packet over the given connection, simulating the configured link properties.
+
+        @return True if the packet was accepted for sending, even if it is lost on the way. False if the given side is not attached.
+    */
+    bool PgeLoopbackTransport::send(
+        const PgeNetworkConnectionHandle& connHandle,
+        const Side& side,
+        const PgePacket& pkt,
+        const uint32_t& nSize,
+        const PgeSendLane& lane)
+    {
+        Connection* const pConn = findConnection(connHandle);
+        if (!pConn || !pConn->m_bAttached[getSideIndex(side)] || (nSize > sizeof(PgePacket)))
+        {
+            return false;
+        }
+
+        m_nSentCount++;
+        const std::size_t iSide = getSideIndex(side);
+        if (!pConn->m_bAttached[getSideIndex(getPeerSide(side))])
+        {
+            // other side is gone, same as sending just before receiving its close
+            m_nLostCount++;
+            return true;
+        }
+
+        const TTimeUSecs nTimeStart = std::max(m_nTime, pConn->m_nTimeLinkFree[iSide]);
+        if ((lane == PgeSendLane::UnreliableNoDelay) && (nTimeStart > m_nTime))
+        {
+            m_nLostCount++;
+            return true;
+        }
+
+        if (m_linkConfig.m_nBandwidthBytesPerSec > 0)
+        {
+            // rounding up so that even tiny packets occupy the link for a while
+            pConn->m_nTimeLinkFree[iSide] =
+                nTimeStart + (static_cast<TTimeUSecs>(nSize) * 1000000 + m_linkConfig.m_nBandwidthBytesPerSec - 1) / m_linkConfig.m_nBandwidthBytesPerSec;
+        }
+        else
+        {
+            pConn->m_nTimeLinkFree[iSide] = nTimeStart;
+        }
+
+        const bool bReliable = (lane == PgeSendLane::Reliable) || (lane == PgeSendLane::ReliableNoNagle);
+        if (!bReliable && (m_linkConfig.m_fLossRate > 0.f) && (nextRandomUnit() < m_linkConfig.m_fLossRate))
+        {
+            m_nLostCount++;
+            return true;
+        }
+
+        TTimeUSecs nTimeDelivery = pConn->m_nTimeLinkFree[iSide] + m_linkConfig.m_nLatencyUSecs;
+        if (m_linkConfig.m_nJitterUSecs > 0)
+        {
+            nTimeDelivery += static_cast<TTimeUSecs>(nextRandom() % (static_cast<uint64_t>(m_linkConfig.m_nJitterUSecs) + 1));
+        }
+        if (bReliable)
+        {
+            // never overtake an earlier reliable packet
+            nTimeDelivery = std::max(nTimeDelivery, pConn->m_nTimeLastReliable[iSide]);
+            pConn->m_nTimeLastReliable[iSide] = nTimeDelivery;
+            pConn->m_nInFlightBytesReliable[iSide] += nSize;
+        }
+        else
+        {
+            pConn->m_nInFlightBytesUnreliable[iSide] += nSize;
+        }
+
+        Inbox& inbox = getPeerInbox(*pConn, side);
+        inbox.m_vDatagrams.emplace_back();
+        Datagram& datagram = inbox.m_vDatagrams.back();
+        datagram.m_nDeliveryTime = nTimeDelivery;
+        datagram.m_nSeq = m_nSeq++;
+        datagram.m_connHandle = connHandle;
+        datagram.m_nSize = nSize;
+        datagram.m_bReliable = bReliable;
+        memcpy(&(datagram.m_pkt), &pkt, nSize);
+        std::push_heap(inbox.m_vDatagrams.begin(), inbox.m_vDatagrams.end(), isLaterDatagram);
+
+        m_nInFlightCount[iSide]++;
+        m_nInFlightHighWaterMark[iSide] = std::max(m_nInFlightHighWaterMark[iSide], m_nInFlightCount[iSide]);
+        return true;
+    }
+
+    /**
+        Receives the next packet due by the current time.
+
+        @param connHandle     The connection of the client, ignored in case of server since server receives from all connections.
+        @param side           The receiving side.
+        @param pkt            Output, only the first nSize bytes are written.
+        @param nSize          Output, size of the received packet.
+        @param connHandleFrom Output, the connection the packet was received on.
+
+        @return True if a packet was received, false if there is no packet due.
+    */
+    bool PgeLoopbackTransport::receive(
+        const PgeNetworkConnectionHandle& connHandle,
+        const Side& side,
+        PgePacket& pkt,
+        uint32_t& nSize,
+        PgeNetworkConnectionHandle& connHandleFrom)
+    {
+        Inbox* const pInbox = findOwnInbox(connHandle, side);
+        if (!pInbox)
+        {
+            return false;
+        }
+
+        const std::size_t iSideSender = getSideIndex(getPeerSide(side));
+        while (!pInbox->m_vDatagrams.empty() && (pInbox->m_vDatagrams.front().m_nDeliveryTime <= m_nTime))
+        {
+            std::pop_heap(pInbox->m_vDatagrams.begin(), pInbox->m_vDatagrams.end(), isLaterDatagram);
+            const Datagram& datagram = pInbox->m_vDatagrams.back();
+            Connection& conn = m_vConnections[datagram.m_connHandle - 1];
+            m_nInFlightCount[iSideSender]--;
+            if (datagram.m_bReliable)
+            {
+                conn.m_nInFlightBytesReliable[iSideSender] -= datagram.m_nSize;
+            }
+            else
+            {
+                conn.m_nInFlightBytesUnreliable[iSideSender] -= datagram.m_nSize;
+            }
+
+            if (!conn.m_bAttached[getSideIndex(side)])
+            {
+                m_nLostCount++;
+                pInbox->m_vDatagrams.pop_back();
+                continue;
+            }
+
+            memcpy(&pkt, &(datagram.m_pkt), datagram.m_nSize);
+            nSize = datagram.m_nSize;
+            connHandleFrom = datagram.m_connHandle;
+            pInbox->m_vDatagrams.pop_back();
+            m_nDeliveredCount++;
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+        Receives the next connection state change due by the current time.
+        Receiving ConnEventKind::Closed detaches the receiving side from the connection.
+
+        @param connHandle The connection of the client, ignored in case of server since server receives from all connections.
+        @param side       The receiving side.
+        @param connEvent  Output, the received connection state change.
+
+        @return True if a connection state change was received, false if there is none due.
+    */
+    bool PgeLoopbackTransport::receiveConnEvent(const PgeNetworkConnectionHandle& connHandle, const Side& side, ConnEvent& connEvent)
+    {
+        Inbox* const pInbox = findOwnInbox(connHandle, side);
+        if (!pInbox)
+        {
+            return false;
+        }
+
+        while (!pInbox->m_vConnEvents.empty() && (pInbox->m_vConnEvents.front().m_nDeliveryTime <= m_nTime))
+        {
+            std::pop_heap(pInbox->m_vConnEvents.begin(), pInbox->m_vConnEvents.end(), isLaterConnEvent);
+            connEvent = pInbox->m_vConnEvents.back();
+            pInbox->m_vConnEvents.pop_back();
+
+            Connection& conn = m_vConnections[connEvent.m_connHandle - 1];
+            if (!conn.m_bAttached[getSideIndex(side)])
+            {
+                // e.g. server has closed the connection meanwhile
+                continue;
+            }
+
+            if (connEvent.m_kind == ConnEventKind::Closed)
+            {
+                conn.m_bAttached[getSideIndex(side)] = false;
+                if (side == Side::Client)
+                {
+                    discardInbox(conn.m_inboxClient, Side::Server);
+                }
+            }
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+        @return Number of packets sent by the given side, not yet received or discarded.
+    */
+    std::size_t PgeLoopbackTransport::getInFlightCount(const Side& side) const
+    {
+        return m_nInFlightCount[getSideIndex(side)];
+    }
+
+    /**
+        @return Maximum number of packets sent by the given side in flight at the same time.
+    */
+    std::size_t PgeLoopbackTransport::getInFlightHighWaterMark(const Side& side) const
+    {
+        return m_nInFlightHighWaterMark[getSideIndex(side)];
+    }
+
+    /**
+        @return Total size of packets sent by the given side on the given connection, on reliable or unreliable lanes,
+                not yet received or discarded.
+    */
+    uint64_t PgeLoopbackTransport::getInFlightBytes(const PgeNetworkConnectionHandle& connHandle, const Side& side, const bool& bReliable) const
+    {
+        const Connection* const pConn = findConnection(connHandle);
+        if (!pConn)
+        {
+            return 0;
+        }
+        return bReliable ? pConn->m_nInFlightBytesReliable[getSideIndex(side)] : pConn->m_nInFlightBytesUnreliable[getSideIndex(side)];
+    }
+
+    /**
+        @return How long a packet sent now by the given side on the given connection would wait for the link because of the bandwidth limit.
+    */
+    PgeLoopbackTransport::TTimeUSecs PgeLoopbackTransport::getQueueTimeUSecs(const PgeNetworkConnectionHandle& connHandle, const Side& side) const
+    {
+        const Connection* const pConn = findConnection(connHandle);
+        if (!pConn)
+        {
+            return 0;
+        }
+        return std::max(static_cast<TTimeUSecs>(0), pConn->m_nTimeLinkFree[getSideIndex(side)] - m_nTime);
+    }
+
+    /**
+        @return Number of packets sent by any side since construction or last resetCounters().
+    */
+    uint64_t PgeLoopbackTransport::getSentCount() const
+    {
+        return m_nSentCount;
+    }
+
+    /**
+        @return Number of packets received by any side since construction or last resetCounters().
+    */
+    uint64_t PgeLoopbackTransport::getDeliveredCount() const
+    {
+        return m_nDeliveredCount;
+    }
+
+    /**
+        @return Number of packets lost due to configured loss, full link or closed connection, since construction or last resetCounters().
+    */
+    uint64_t PgeLoopbackTransport::getLostCount() const
+    {
+        return m_nLostCount;
+    }
+
+    /**
+        Resets packet counters and in-flight high water marks, e.g. after warming up a benchmark.
+    */
+    void PgeLoopbackTransport::resetCounters()
+    {
+        m_nSentCount = 0;
+        m_nDeliveredCount = 0;
+        m_nLostCount = 0;
+        m_nInFlightHighWaterMark = m_nInFlightCount;
+    }
+
+    bool PgeLoopbackTransport::isLaterDatagram(const Datagram& a, const Datagram& b)
+    {
+        return (a.m_nDeliveryTime > b.m_nDeliveryTime) || ((a.m_nDeliveryTime == b.m_nDeliveryTime) && (a.m_nSeq > b.m_nSeq));
+    }
+
+    bool PgeLoopbackTransport::isLaterConnEvent(const ConnEvent& a, const ConnEvent& b)
+    {
+        return (a.m_nDeliveryTime > b.m_nDeliveryTime) || ((a.m_nDeliveryTime == b.m_nDeliveryTime) && (a.m_nSeq > b.m_nSeq));
+    }
+
+    /**
+        SplitMix64, so results don't depend on the standard library implementation.
+    */
+    uint64_t PgeLoopbackTransport::nextRandom()
+    {
+        uint64_t n = (m_nRandomState += 0x9E3779B97F4A7C15ull);
+        n = (n ^ (n >> 30)) * 0xBF58476D1CE4E5B9ull;
+        n = (n ^ (n >> 27)) * 0x94D049BB133111EBull;
+        return n ^ (n >> 31);
+    }
+
+    /**
+        @return Random number in range [0, 1).
+    */
+    float PgeLoopbackTransport::nextRandomUnit()
+    {
+        // 24 bits fit exactly into the mantissa of float
+        return static_cast<float>(nextRandom() >> 40) / static_cast<float>(1u << 24);
+    }
+
+    PgeLoopbackTransport::Connection* PgeLoopbackTransport::findConnection(const PgeNetworkConnectionHandle& connHandle)
+    {
+        if ((connHandle == ServerConnHandle) || (connHandle > m_vConnections.size()))
+        {
+            return nullptr;
+        }
+        return &(m_vConnections[connHandle - 1]);
+    }
+
+    const PgeLoopbackTransport::Connection* PgeLoopbackTransport::findConnection(const PgeNetworkConnectionHandle& connHandle) const
+    {
+        if ((connHandle == ServerConnHandle) || (connHandle > m_vConnections.size()))
+        {
+            return nullptr;
+        }
+        return &(m_vConnections[connHandle - 1]);
+    }
+
+    PgeLoopbackTransport::Inbox* PgeLoopbackTransport::findOwnInbox(const PgeNetworkConnectionHandle& connHandle, const Side& side)
+    {
+        if (side == Side::Server)
+        {
+            return &m_inboxServer;
+        }
+        Connection* const pConn = findConnection(connHandle);
+        return pConn ? &(pConn->m_inboxClient) : nullptr;
+    }
+
+    PgeLoopbackTransport::Inbox& PgeLoopbackTransport::getPeerInbox(Connection& conn, const Side& side)
+    {
+        return (side == Side::Server) ? conn.m_inboxClient : m_inboxServer;
+    }
+
+    /**
+        Connection state changes are delivered in order with the reliable packets sent by the same side.
+    */
+    void PgeLoopbackTransport::pushConnEvent(
+        const PgeNetworkConnectionHandle& connHandle,
+        Connection& conn,
+        const Side& side,
+        const ConnEventKind& kind)
+    {
+        const std::size_t iSide = getSideIndex(side);
+        const TTimeUSecs nTimeDelivery = std::max(m_nTime + m_linkConfig.m_nLatencyUSecs, conn.m_nTimeLastReliable[iSide]);
+        conn.m_nTimeLastReliable[iSide] = nTimeDelivery;
+
+        Inbox& inbox = getPeerInbox(conn, side);
+        inbox.m_vConnEvents.push_back(ConnEvent{ nTimeDelivery, m_nSeq++, connHandle, kind });
+        std::push_heap(inbox.m_vConnEvents.begin(), inbox.m_vConnEvents.end(), isLaterConnEvent);
+    }
+
+    void PgeLoopbackTransport::discardInbox(Inbox& inbox, const Side& sideSender)
+    {
+        const std::size_t iSideSender = getSideIndex(sideSender);
+        for (const auto& datagram : inbox.m_vDatagrams)
+        {
+            Connection& conn = m_vConnections[datagram.m_connHandle - 1];
+            if (datagram.m_bReliable)
+            {
+                conn.m_nInFlightBytesReliable[iSideSender] -= datagram.m_nSize;
+            }
+            else
+            {
+                conn.m_nInFlightBytesUnreliable[iSideSender] -= datagram.m_nSize;
+            }
+        }
+        assert(m_nInFlightCount[iSideSender] >= inbox.m_vDatagrams.size());
+        m_nInFlightCount[iSideSender] -= inbox.m_vDatagrams.size();
+        m_nLostCount += inbox.m_vDatagrams.size();
+        inbox.m_vDatagrams.clear();
+        inbox.m_vConnEvents.clear();
+    }
+
+} // namespace pge_network
@@ -0,0 +1,207 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeLoopbackTransport.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine in-process loopback network medium
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "PgePacket.h"
+
+namespace pge_network
+{
+
+    /**
+        In-process network medium connecting 1 PgeLoopbackServer to any number of PgeLoopbackClient instances via memory queues,
+        without any socket. Intended for reproducible headless benchmarks and tests of networking code.
+
+        Each connection has 2 directions (to server, to client), and each direction simulates the configured link properties:
+         - one-way latency plus random jitter;
+         - loss of packets sent on unreliable lanes, packets sent on reliable lanes are never lost and keep their order,
+           as if retransmission was instant;
+         - bandwidth limit, packets queue up behind each other, and a packet sent on PgeSendLane::UnreliableNoDelay is dropped
+           if it cannot be sent out immediately.
+        Connection state changes (connect, accept, close) are delivered with the same latency as reliable packets, but never lost.
+
+        Time does not pass by itself: caller advances the simulated time by advanceTime(), and packets become receivable when their
+        delivery time is reached. Together with the own pseudo-random generator seeded in the constructor, the same sequence
+        of calls always results in the same deliveries, on any platform.
+
+        Server and clients referring to the same transport must be driven from the same thread.
+    */
+    class PgeLoopbackTransport
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeLoopbackTransport is included")
+#endif
+
+    public:
+
+        typedef int64_t TTimeUSecs;
+
+        /**
+            Properties of a single direction of a connection, the same applies to all connections and both directions.
+        */
+        struct LinkConfig
+        {
+            TTimeUSecs m_nLatencyUSecs = 0;         /**< One-way latency. */
+            TTimeUSecs m_nJitterUSecs = 0;          /**< Random extra one-way latency, uniformly distributed in [0, m_nJitterUSecs]. */
+            float m_fLossRate = 0.f;                /**< Probability of losing a packet sent on an unreliable lane, in range [0, 1]. */
+            uint32_t m_nBandwidthBytesPerSec = 0;   /**< Maximum throughput, 0 means unlimited. */
+        };
+
+        /**
+            Identifies the endpoint calling the functions of the transport: all functions taking a Side expect the side of the caller,
+            e.g. send() with Side::Client means a client is sending to the server.
+        */
+        enum class Side : uint8_t
+        {
+            Server = 0,
+            Client
+        };
+
+        static constexpr std::size_t nSideCount = static_cast<std::size_t>(Side::Client) + 1;
+
+        enum class ConnEventKind : uint8_t
+        {
+            Connecting = 0,  /**< To server: a client wants to connect. */
+            Accepted,        /**< To client: server accepted the connection. */
+            Closed           /**< To either side: other side closed the connection. */
+        };
+
+        struct ConnEvent
+        {
+            TTimeUSecs m_nDeliveryTime;
+            uint64_t m_nSeq;
+            PgeNetworkConnectionHandle m_connHandle;
+            ConnEventKind m_kind;
+        };
+
+        // ---------------------------------------------------------------------------
+
+        PgeLoopbackTransport();
+        explicit PgeLoopbackTransport(const LinkConfig& linkConfig, const uint64_t& nSeed = 1);
+        ~PgeLoopbackTransport() = default;
+
+        PgeLoopbackTransport(const PgeLoopbackTransport&) = delete;
+        PgeLoopbackTransport& operator=(const PgeLoopbackTransport&) = delete;
+        PgeLoopbackTransport(PgeLoopbackTransport&&) = delete;
+        PgeLoopbackTransport& operator=(PgeLoopbackTransport&&) = delete;
+
+        const LinkConfig& getLinkConfig() const;
+        void setLinkConfig(const LinkConfig& linkConfig);
+
+        const TTimeUSecs& getTime() const;
+        void advanceTime(const TTimeUSecs& nUSecs);
+
+        bool listen();
+        void stopListening();
+        bool isListening() const;
+
+        PgeNetworkConnectionHandle connect();
+        void accept(const PgeNetworkConnectionHandle& connHandle);
+        void close(const PgeNetworkConnectionHandle& connHandle, const Side& side);
+        bool isAttached(const PgeNetworkConnectionHandle& connHandle, const Side& side) const;
+
+        bool send(
+            const PgeNetworkConnectionHandle& connHandle,
+            const Side& side,
+            const PgePacket& pkt,
+            const uint32_t& nSize,
+            const PgeSendLane& lane);
+        bool receive(
+            const PgeNetworkConnectionHandle& connHandle,
+            const Side& side,
+            PgePacket& pkt,
+            uint32_t& nSize,
+            PgeNetworkConnectionHandle& connHandleFrom);
+        bool receiveConnEvent(const PgeNetworkConnectionHandle& connHandle, const Side& side, ConnEvent& connEvent);
+
+        std::size_t getInFlightCount(const Side& side) const;
+        std::size_t getInFlightHighWaterMark(const Side& side) const;
+        uint64_t getInFlightBytes(const PgeNetworkConnectionHandle& connHandle, const Side& side, const bool& bReliable) const;
+        TTimeUSecs getQueueTimeUSecs(const PgeNetworkConnectionHandle& connHandle, const Side& side) const;
+        uint64_t getSentCount() const;
+        uint64_t getDeliveredCount() const;
+        uint64_t getLostCount() const;
+        void resetCounters();
+
+    private:
+
+        /**
+            A packet travelling in one direction, only the first m_nSize bytes of m_pkt are valid.
+        */
+        struct Datagram
+        {
+            TTimeUSecs m_nDeliveryTime;
+            uint64_t m_nSeq;                         /**< Tie-breaker for equal delivery times, so sending order is kept. */
+            PgeNetworkConnectionHandle m_connHandle;
+            uint32_t m_nSize;
+            bool m_bReliable;
+            PgePacket m_pkt;
+        };
+
+        /**
+            Packets and connection state changes arriving at the same endpoint, as min-heaps ordered by delivery time.
+            Vectors keep their capacity, so after warming up there is no allocation per packet.
+        */
+        struct Inbox
+        {
+            std::vector<Datagram> m_vDatagrams;
+            std::vector<ConnEvent> m_vConnEvents;
+        };
+
+        /**
+            Arrays are indexed by Side, per side values refer to packets sent by that side.
+        */
+        struct Connection
+        {
+            Inbox m_inboxClient;
+            std::array<bool, nSideCount> m_bAttached;                  /**< Side has neither closed nor learnt about closing. */
+            std::array<TTimeUSecs, nSideCount> m_nTimeLinkFree;        /**< When the link becomes free for the next packet. */
+            std::array<TTimeUSecs, nSideCount> m_nTimeLastReliable;    /**< Delivery time of the last reliable packet or event. */
+            std::array<uint64_t, nSideCount> m_nInFlightBytesReliable;
+            std::array<uint64_t, nSideCount> m_nInFlightBytesUnreliable;
+        };
+
+        LinkConfig m_linkConfig;
+        uint64_t m_nRandomState;
+        TTimeUSecs m_nTime;
+        uint64_t m_nSeq;
+        bool m_bListening;
+        Inbox m_inboxServer;
+        std::vector<Connection> m_vConnections;  /**< Indexed by connection handle - 1, handles are never reused. */
+        std::array<std::size_t, nSideCount> m_nInFlightCount;           /**< Indexed by sender Side. */
+        std::array<std::size_t, nSideCount> m_nInFlightHighWaterMark;   /**< Indexed by sender Side. */
+        uint64_t m_nSentCount;
+        uint64_t m_nDeliveredCount;
+        uint64_t m_nLostCount;
+
+        // ---------------------------------------------------------------------------
+
+        static bool isLaterDatagram(const Datagram& a, const Datagram& b);
+        static bool isLaterConnEvent(const ConnEvent& a, const ConnEvent& b);
+
+        uint64_t nextRandom();
+        float nextRandomUnit();
+
+        Connection* findConnection(const PgeNetworkConnectionHandle& connHandle);
+        const Connection* findConnection(const PgeNetworkConnectionHandle& connHandle) const;
+        Inbox* findOwnInbox(const PgeNetworkConnectionHandle& connHandle, const Side& side);
+        Inbox& getPeerInbox(Connection& conn, const Side& side);
+        void pushConnEvent(const PgeNetworkConnectionHandle& connHandle, Connection& conn, const Side& side, const ConnEventKind& kind);
+        void discardInbox(Inbox& inbox, const Side& sideSender);
+
+    }; // class PgeLoopbackTransport
+
+} // namespace pge_network
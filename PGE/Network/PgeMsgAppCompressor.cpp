@@ -0,0 +1,718 @@
+/*
+    ###################################################################################
+    PgeMsgAppCompressor.cpp
+    This file is part of PGE.
+    PR00F's Game Engine app message compression
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgeMsgAppCompressor.h"
+
+#include <algorithm>
+#include <chrono>  // requires cpp11
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace pge_network {
+
+    static constexpr uint32_t nHashMultiplier = 2654435761u;  // Knuth's multiplicative hash
+    static constexpr std::size_t nLengthNibbleMax = 15;
+    static constexpr std::size_t nTrainingGramLength = 8;
+
+    static uint32_t read32(const TByte* p)
+    {
+        uint32_t nValue;
+        memcpy(&nValue, p, sizeof(nValue));
+        return nValue;
+    }
+
+    static std::string escapeCsvString(const std::string& str)
+    {
+        std::string sEscaped = "\"";
+        for (const char c : str)
+        {
+            if (c == '"')
+            {
+                sEscaped += '"';
+            }
+            sEscaped += c;
+        }
+        return sEscaped + "\"";
+    }
+
+    /**
+        Writes the extension bytes of a length not fitting into its 4-bit field of the token.
+    */
+    static bool writeLengthExtension(TByte* pDst, const std::size_t& nDstCapacity, std::size_t& iDst, std::size_t nLength)
+    {
+        if (nLength < nLengthNibbleMax)
+        {
+            return true;
+        }
+        nLength -= nLengthNibbleMax;
+        while (true)
+        {
+            if (iDst >= nDstCapacity)
+            {
+                return false;
+            }
+            const TByte nByte = static_cast<TByte>(std::min<std::size_t>(nLength, 255));
+            pDst[iDst++] = nByte;
+            if (nByte != 255)
+            {
+                return true;
+            }
+            nLength -= 255;
+        }
+    }
+
+    static bool readLengthExtension(const TByte* pSrc, const std::size_t& nSrcSize, std::size_t& iSrc, std::size_t& nLength)
+    {
+        if (nLength < nLengthNibbleMax)
+        {
+            return true;
+        }
+        while (true)
+        {
+            if (iSrc >= nSrcSize)
+            {
+                return false;
+            }
+            const TByte nByte = pSrc[iSrc++];
+            nLength += nByte;
+            if (nByte != 255)
+            {
+                return true;
+            }
+        }
+    }
+
+    /**
+        Writes a sequence: token, literals, and back-reference unless nOffset is 0, which is the case only for the last sequence.
+
+        @return False if the sequence does not fit into the destination.
+    */
+    static bool writeSequence(
+        TByte* pDst,
+        const std::size_t& nDstCapacity,
+        std::size_t& iDst,
+        const TByte* pLiterals,
+        const std::size_t& nLiteralCount,
+        const std::size_t& nOffset,
+        const std::size_t& nMatchLength)
+    {
+        const std::size_t nMatchCode = (nOffset == 0) ? 0 : (nMatchLength - PgeMsgAppCompressor::nMinMatchLengthBytes);
+        if (iDst >= nDstCapacity)
+        {
+            return false;
+        }
+        pDst[iDst++] = static_cast<TByte>(
+            (std::min(nLiteralCount, nLengthNibbleMax) << 4) | std::min(nMatchCode, nLengthNibbleMax));
+
+        if (!writeLengthExtension(pDst, nDstCapacity, iDst, nLiteralCount) || (nDstCapacity - iDst < nLiteralCount))
+        {
+            return false;
+        }
+        memcpy(pDst + iDst, pLiterals, nLiteralCount);
+        iDst += nLiteralCount;
+
+        if (nOffset == 0)
+        {
+            return true;
+        }
+        if (nDstCapacity - iDst < 2)
+        {
+            return false;
+        }
+        pDst[iDst++] = static_cast<TByte>(nOffset & 0xFF);
+        pDst[iDst++] = static_cast<TByte>(nOffset >> 8);
+        return writeLengthExtension(pDst, nDstCapacity, iDst, nMatchCode);
+    }
+
+
+    // ############################### PUBLIC ################################
+
+
+    PgeMsgAppCompressor::MsgAppStats::MsgAppStats() :
+        m_nTxCount(0),
+        m_nTxCompressedCount(0),
+        m_nTxRawBytes(0),
+        m_nTxWireBytes(0),
+        m_nTxNanosecs(0),
+        m_nRxCount(0),
+        m_nRxFailedCount(0),
+        m_nRxRawBytes(0),
+        m_nRxWireBytes(0),
+        m_nRxNanosecs(0)
+    {
+    }
+
+    /**
+        @return Sent size as fraction of the original size, smaller is better, 1 if nothing was sent yet.
+    */
+    float PgeMsgAppCompressor::MsgAppStats::getTxRatio() const
+    {
+        return (m_nTxRawBytes == 0) ? 1.f : (static_cast<float>(m_nTxWireBytes) / static_cast<float>(m_nTxRawBytes));
+    }
+
+    /**
+        @return Received size as fraction of the decompressed size, smaller is better, 1 if nothing was received yet.
+    */
+    float PgeMsgAppCompressor::MsgAppStats::getRxRatio() const
+    {
+        return (m_nRxRawBytes == 0) ? 1.f : (static_cast<float>(m_nRxWireBytes) / static_cast<float>(m_nRxRawBytes));
+    }
+
+    uint64_t PgeMsgAppCompressor::MsgAppStats::getTxAvgNanosecs() const
+    {
+        return (m_nTxCount == 0) ? 0 : (m_nTxNanosecs / m_nTxCount);
+    }
+
+    uint64_t PgeMsgAppCompressor::MsgAppStats::getRxAvgNanosecs() const
+    {
+        return (m_nRxCount == 0) ? 0 : (m_nRxNanosecs / m_nRxCount);
+    }
+
+    /**
+        Gets the dictionary used by default, made of byte patterns frequent in small binary game messages: runs of zero and 0xFF bytes,
+        little-endian small integers and common float constants.
+        An application-specific dictionary made by trainDictionary() from real traffic is expected to give better ratio.
+    */
+    const std::vector<TByte>& PgeMsgAppCompressor::getDefaultDictionary()
+    {
+        static const std::vector<TByte> vDefaultDictionary = {
+            // 0xFF run, e.g. invalid ids and full masks
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            // float constants: 100, 2, 0.5, -1, 1
+            0x00, 0x00, 0xC8, 0x42, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x80, 0xBF, 0x00, 0x00, 0x80, 0x3F,
+            // float vectors: (1, 0, 0), (0, 1, 0), (0, 0, 1)
+            0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F,
+            // 32-bit little-endian integers 1 to 8
+            0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
+            0x05, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
+            // zero run, e.g. unused fields and zero-terminated string padding
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        };
+        return vDefaultDictionary;
+    }
+
+    /**
+        Builds a dictionary from sample app message data, e.g. collected from a packet capture of a typical session.
+        Byte sequences occurring in the most samples are concatenated, overlapping ones merged, until the dictionary is full.
+        Sequences occurring in only 1 sample are not used, so the dictionary might be smaller than requested.
+
+        @param vSamples             Data of sample app messages.
+        @param nDictionarySizeBytes Maximum size of the dictionary, must be positive and not greater than nMaxDictionarySizeBytes.
+
+        @return The dictionary to be passed to setDictionary() on both sides.
+    */
+    std::vector<TByte> PgeMsgAppCompressor::trainDictionary(
+        const std::vector<std::vector<TByte>>& vSamples,
+        const std::size_t& nDictionarySizeBytes) noexcept(false)
+    {
+        if ((nDictionarySizeBytes == 0) || (nDictionarySizeBytes > nMaxDictionarySizeBytes))
+        {
+            throw std::runtime_error("PgeMsgAppCompressor::trainDictionary(): invalid dictionary size!");
+        }
+
+        // number of samples each gram occurs in, a gram is stored in a 64-bit integer as is
+        static_assert(nTrainingGramLength == sizeof(uint64_t));
+        std::unordered_map<uint64_t, uint32_t> mapGramSampleCount;
+        std::unordered_set<uint64_t> setGramsOfSample;
+        for (const auto& vSample : vSamples)
+        {
+            setGramsOfSample.clear();
+            for (std::size_t i = 0; i + nTrainingGramLength <= vSample.size(); i++)
+            {
+                uint64_t nGram;
+                memcpy(&nGram, vSample.data() + i, sizeof(nGram));
+                if (setGramsOfSample.insert(nGram).second)
+                {
+                    mapGramSampleCount[nGram]++;
+                }
+            }
+        }
+
+        std::vector<std::pair<uint64_t, uint32_t>> vGrams;
+        for (const auto& gramCount : mapGramSampleCount)
+        {
+            if (gramCount.second >= 2)
+            {
+                vGrams.push_back(gramCount);
+            }
+        }
+        // gram as tie-breaker, so the result does not depend on the order of the hash map
+        std::sort(vGrams.begin(), vGrams.end(), [](const std::pair<uint64_t, uint32_t>& a, const std::pair<uint64_t, uint32_t>& b) {
+            return (a.second != b.second) ? (a.second > b.second) : (a.first < b.first);
+        });
+
+        std::vector<TByte> vDictionary;
+        vDictionary.reserve(nDictionarySizeBytes);
+        for (const auto& gramCount : vGrams)
+        {
+            TByte gram[nTrainingGramLength];
+            memcpy(gram, &gramCount.first, sizeof(gram));
+            if (std::search(vDictionary.begin(), vDictionary.end(), gram, gram + nTrainingGramLength) != vDictionary.end())
+            {
+                continue;
+            }
+
+            // longest suffix of the dictionary being a prefix of the gram is not appended again
+            std::size_t nOverlap = std::min(nTrainingGramLength - 1, vDictionary.size());
+            while ((nOverlap > 0) && !std::equal(gram, gram + nOverlap, vDictionary.end() - nOverlap))
+            {
+                nOverlap--;
+            }
+            if (vDictionary.size() + (nTrainingGramLength - nOverlap) > nDictionarySizeBytes)
+            {
+                continue;
+            }
+            vDictionary.insert(vDictionary.end(), gram + nOverlap, gram + nTrainingGramLength);
+        }
+
+        return vDictionary;
+    }
+
+    bool PgeMsgAppCompressor::isMsgAppCompressed(const MsgApp& msgApp)
+    {
+        return (MsgApp::getMsgAppMsgId(msgApp) & nCompressedMsgIdFlag) != 0;
+    }
+
+    /**
+        @return True if the given packet is an app message packet having at least 1 compressed app message.
+    */
+    bool PgeMsgAppCompressor::hasCompressedMsgApp(const PgePacket& pkt)
+    {
+        if (PgePacket::getPacketId(pkt) != PgePktId::Application)
+        {
+            return false;
+        }
+
+        const MsgApp* pMsgApp = PgePacket::getMsgAppFromPkt(pkt);
+        const uint8_t nMessageCount = PgePacket::getMessageAppCount(pkt);
+        for (uint8_t i = 0; (i < nMessageCount) && pMsgApp; i++)
+        {
+            if (isMsgAppCompressed(*pMsgApp))
+            {
+                return true;
+            }
+            pMsgApp = PgePacket::getNextMsgAppFromPkt(pkt, *pMsgApp);
+        }
+        return false;
+    }
+
+    /**
+        @return The given app message id as the application knows it, i.e. without nCompressedMsgIdFlag.
+    */
+    MsgApp::TMsgId PgeMsgAppCompressor::getUncompressedMsgAppId(const MsgApp::TMsgId& msgAppId)
+    {
+        return static_cast<MsgApp::TMsgId>(msgAppId & ~nCompressedMsgIdFlag);
+    }
+
+    /**
+        Creates a compressor with the default dictionary and compression disabled for all app message ids.
+    */
+    PgeMsgAppCompressor::PgeMsgAppCompressor()
+    {
+        setDictionary(getDefaultDictionary());
+    }
+
+    /**
+        @return App message ids to be compressed on sending, empty by default.
+                Ids having nCompressedMsgIdFlag set are never compressed.
+    */
+    std::set<MsgApp::TMsgId>& PgeMsgAppCompressor::getCompressedAppMessages()
+    {
+        return m_compressedAppMessages;
+    }
+
+    /**
+        Sets the preset dictionary, must be the same on both sides.
+        Allocates memory, so it is expected to be invoked only during initialization.
+
+        @param vDictionary The dictionary, can be empty, must not be longer than nMaxDictionarySizeBytes.
+    */
+    void PgeMsgAppCompressor::setDictionary(const std::vector<TByte>& vDictionary) noexcept(false)
+    {
+        if (vDictionary.size() > nMaxDictionarySizeBytes)
+        {
+            throw std::runtime_error("PgeMsgAppCompressor::setDictionary(): dictionary too long!");
+        }
+
+        m_vDictionary = vDictionary;
+        m_vDictHashTable.assign(std::size_t(1) << nDictHashBits, 0);
+        for (std::size_t i = 0; i + nMinMatchLengthBytes <= m_vDictionary.size(); i++)
+        {
+            // later positions overwrite earlier ones, being closer to the data does not matter with fixed size offsets
+            m_vDictHashTable[(read32(m_vDictionary.data() + i) * nHashMultiplier) >> (32 - nDictHashBits)] = static_cast<uint32_t>(i + 1);
+        }
+
+        // window is preallocated for app messages, bigger blocks make it grow
+        m_vWindow = m_vDictionary;
+        m_vWindow.resize(m_vDictionary.size() + MsgApp::nMaxMessageLengthBytes);
+    }
+
+    const std::vector<TByte>& PgeMsgAppCompressor::getDictionary() const
+    {
+        return m_vDictionary;
+    }
+
+    /**
+        Compresses the given data into a block, using the dictionary.
+        Back-references can point into the dictionary and into the already processed data, at most nMaxMatchOffset bytes back.
+        No allocation if nSrcSize is not greater than MsgApp::nMaxMessageLengthBytes.
+
+        @param pSrc         Data to be compressed.
+        @param nSrcSize     Size of data to be compressed.
+        @param pDst         Destination of the compressed block.
+        @param nDstCapacity Maximum size of the compressed block, compression is aborted if this is reached.
+
+        @return Size of the compressed block, or 0 if it does not fit into nDstCapacity.
+    */
+    std::size_t PgeMsgAppCompressor::compressBlock(const TByte* pSrc, const std::size_t& nSrcSize, TByte* pDst, const std::size_t& nDstCapacity)
+    {
+        const std::size_t nDictSize = m_vDictionary.size();
+        const std::size_t nWindowEnd = nDictSize + nSrcSize;
+        if (m_vWindow.size() < nWindowEnd)
+        {
+            m_vWindow.resize(nWindowEnd);
+        }
+        if (nSrcSize > 0)
+        {
+            memcpy(m_vWindow.data() + nDictSize, pSrc, nSrcSize);
+        }
+        const TByte* const pWindow = m_vWindow.data();
+
+        // table for the data is sized to the data, so clearing it is cheap for small messages
+        uint32_t nHashBits = 8;
+        while (((std::size_t(1) << nHashBits) < 2 * nSrcSize) && (nHashBits < 16))
+        {
+            nHashBits++;
+        }
+        const std::size_t nHashTableSize = std::size_t(1) << nHashBits;
+        if (m_vHashTable.size() < nHashTableSize)
+        {
+            m_vHashTable.resize(nHashTableSize);
+        }
+        std::fill(m_vHashTable.begin(), m_vHashTable.begin() + nHashTableSize, 0u);
+
+        std::size_t iDst = 0;
+        std::size_t iAnchor = nDictSize;   // start of pending literals in the window
+        std::size_t iPos = nDictSize;
+        while (iPos + nMinMatchLengthBytes <= nWindowEnd)
+        {
+            const uint32_t nHashProduct = read32(pWindow + iPos) * nHashMultiplier;
+            uint32_t& nHashSlot = m_vHashTable[nHashProduct >> (32 - nHashBits)];
+            const uint32_t nCandidates[] = { nHashSlot, m_vDictHashTable[nHashProduct >> (32 - nDictHashBits)] };
+            nHashSlot = static_cast<uint32_t>(iPos + 1);
+
+            std::size_t nBestLength = 0;
+            std::size_t iBestPos = 0;
+            for (const auto& nCandidate : nCandidates)
+            {
+                // both tables store positions before iPos only
+                if ((nCandidate == 0) || (iPos - (nCandidate - 1) > nMaxMatchOffset))
+                {
+                    continue;
+                }
+                const std::size_t iCandidate = nCandidate - 1;
+                std::size_t nLength = 0;
+                while ((iPos + nLength < nWindowEnd) && (pWindow[iCandidate + nLength] == pWindow[iPos + nLength]))
+                {
+                    nLength++;
+                }
+                if (nLength > nBestLength)
+                {
+                    nBestLength = nLength;
+                    iBestPos = iCandidate;
+                }
+            }
+
+            if (nBestLength < nMinMatchLengthBytes)
+            {
+                iPos++;
+                continue;
+            }
+
+            if (!writeSequence(pDst, nDstCapacity, iDst, pWindow + iAnchor, iPos - iAnchor, iPos - iBestPos, nBestLength))
+            {
+                return 0;
+            }
+            for (std::size_t i = iPos + 1; (i < iPos + nBestLength) && (i + nMinMatchLengthBytes <= nWindowEnd); i++)
+            {
+                m_vHashTable[(read32(pWindow + i) * nHashMultiplier) >> (32 - nHashBits)] = static_cast<uint32_t>(i + 1);
+            }
+            iPos += nBestLength;
+            iAnchor = iPos;
+        }
+
+        if (!writeSequence(pDst, nDstCapacity, iDst, pWindow + iAnchor, nWindowEnd - iAnchor, 0, 0))
+        {
+            return 0;
+        }
+        return iDst;
+    }
+
+    /**
+        Decompresses the given block created by compressBlock() with the same dictionary.
+        Malformed blocks are detected, never reading or writing out of the given buffers.
+
+        @param pSrc     The compressed block.
+        @param nSrcSize Size of the compressed block.
+        @param pDst     Destination of the decompressed data.
+        @param nDstSize Expected size of the decompressed data.
+
+        @return True if the block was decompressed to exactly nDstSize bytes, false if it is malformed.
+    */
+    bool PgeMsgAppCompressor::decompressBlock(const TByte* pSrc, const std::size_t& nSrcSize, TByte* pDst, const std::size_t& nDstSize) const
+    {
+        const std::size_t nDictSize = m_vDictionary.size();
+        std::size_t iSrc = 0;
+        std::size_t iDst = 0;
+        while (iSrc < nSrcSize)
+        {
+            const TByte nToken = pSrc[iSrc++];
+
+            std::size_t nLiteralCount = nToken >> 4;
+            if (!readLengthExtension(pSrc, nSrcSize, iSrc, nLiteralCount) ||
+                (nLiteralCount > nSrcSize - iSrc) || (nLiteralCount > nDstSize - iDst))
+            {
+                return false;
+            }
+            if (nLiteralCount > 0)
+            {
+                memcpy(pDst + iDst, pSrc + iSrc, nLiteralCount);
+            }
+            iSrc += nLiteralCount;
+            iDst += nLiteralCount;
+
+            if (iSrc == nSrcSize)
+            {
+                // last sequence has no back-reference
+                break;
+            }
+
+            if (nSrcSize - iSrc < 2)
+            {
+                return false;
+            }
+            const std::size_t nOffset = pSrc[iSrc] | (static_cast<std::size_t>(pSrc[iSrc + 1]) << 8);
+            iSrc += 2;
+            std::size_t nMatchLength = nToken & 0x0F;
+            if (!readLengthExtension(pSrc, nSrcSize, iSrc, nMatchLength))
+            {
+                return false;
+            }
+            nMatchLength += nMinMatchLengthBytes;
+            if ((nOffset == 0) || (nOffset > nDictSize + iDst) || (nMatchLength > nDstSize - iDst))
+            {
+                return false;
+            }
+
+            // back-reference might start in the dictionary and continue in the data, and might overlap itself
+            std::size_t iWindow = nDictSize + iDst - nOffset;
+            for (; (nMatchLength > 0) && (iWindow < nDictSize); nMatchLength--)
+            {
+                pDst[iDst++] = m_vDictionary[iWindow++];
+            }
+            const TByte* pFrom = pDst + (iWindow - nDictSize);
+            for (; nMatchLength > 0; nMatchLength--)
+            {
+                pDst[iDst++] = *pFrom++;
+            }
+        }
+
+        return iDst == nDstSize;
+    }
+
+    /**
+        Makes a copy of the given packet with app messages compressed according to getCompressedAppMessages(), updating the statistics.
+        App messages are kept in their original order.
+
+        @param pkt           Packet to be sent.
+        @param pktCompressed Receives the copy with compressed app messages, untouched if false is returned.
+
+        @return True if any app message got compressed, so pktCompressed is to be sent instead of pkt, false otherwise.
+    */
+    bool PgeMsgAppCompressor::compressPkt(const PgePacket& pkt, PgePacket& pktCompressed)
+    {
+        if (m_compressedAppMessages.empty() || (PgePacket::getPacketId(pkt) != PgePktId::Application))
+        {
+            return false;
+        }
+
+        const uint8_t nMessageCount = PgePacket::getMessageAppCount(pkt);
+        const MsgApp* pMsgApp = PgePacket::getMsgAppFromPkt(pkt);
+        bool bHasCompressionEnabled = false;
+        for (uint8_t i = 0; (i < nMessageCount) && pMsgApp && !bHasCompressionEnabled; i++)
+        {
+            bHasCompressionEnabled = (m_compressedAppMessages.find(MsgApp::getMsgAppMsgId(*pMsgApp)) != m_compressedAppMessages.end());
+            pMsgApp = PgePacket::getNextMsgAppFromPkt(pkt, *pMsgApp);
+        }
+        if (!bHasCompressionEnabled)
+        {
+            return false;
+        }
+
+        PgePacket::initPktMsgApp(pktCompressed, PgePacket::getServerSideConnectionHandle(pkt), PgePacket::AutoFill::NONE);
+        MsgApp msgAppCompressed;
+        bool bCompressed = false;
+        pMsgApp = PgePacket::getMsgAppFromPkt(pkt);
+        for (uint8_t i = 0; (i < nMessageCount) && pMsgApp; i++)
+        {
+            const MsgApp::TMsgId& msgAppId = MsgApp::getMsgAppMsgId(*pMsgApp);
+            const MsgApp* pMsgAppToSend = pMsgApp;
+            if (((msgAppId & nCompressedMsgIdFlag) == 0) && (m_compressedAppMessages.find(msgAppId) != m_compressedAppMessages.end()))
+            {
+                const auto timeStart = std::chrono::steady_clock::now();
+                const bool bMsgCompressed = compressMsgApp(*pMsgApp, msgAppCompressed);
+                const auto timeEnd = std::chrono::steady_clock::now();
+
+                if (bMsgCompressed)
+                {
+                    pMsgAppToSend = &msgAppCompressed;
+                    bCompressed = true;
+                }
+                MsgAppStats& stats = m_stats[msgAppId];
+                stats.m_nTxCount++;
+                stats.m_nTxCompressedCount += bMsgCompressed ? 1 : 0;
+                stats.m_nTxRawBytes += MsgApp::getMsgAppDataActualSizeBytes(*pMsgApp);
+                stats.m_nTxWireBytes += MsgApp::getMsgAppDataActualSizeBytes(*pMsgAppToSend);
+                stats.m_nTxNanosecs += std::chrono::duration_cast<std::chrono::nanoseconds>(timeEnd - timeStart).count();
+            }
+
+            // never fails since no app message got bigger
+            const bool bAdded = PgePacket::addPktMsgApp(pktCompressed, *pMsgAppToSend);
+            assert(bAdded);
+            (void)bAdded;
+            pMsgApp = PgePacket::getNextMsgAppFromPkt(pkt, *pMsgApp);
+        }
+
+        return bCompressed;
+    }
+
+    /**
+        Decompresses the given received app message if it is compressed, updating the statistics.
+
+        @param msgApp             The received app message.
+        @param msgAppDecompressed Receives the decompressed app message if msgApp is compressed.
+
+        @return &msgApp if it is not compressed, &msgAppDecompressed if it got decompressed, or nullptr if it is malformed.
+    */
+    const MsgApp* PgeMsgAppCompressor::decompressMsgApp(const MsgApp& msgApp, MsgApp& msgAppDecompressed)
+    {
+        if (!isMsgAppCompressed(msgApp))
+        {
+            return &msgApp;
+        }
+
+        const auto timeStart = std::chrono::steady_clock::now();
+        const MsgApp::TMsgId msgAppId = getUncompressedMsgAppId(MsgApp::getMsgAppMsgId(msgApp));
+        const TByte* const pData = MsgApp::getMsgAppData(msgApp);
+        const MsgApp::TMsgSize& nWireSize = MsgApp::getMsgAppDataActualSizeBytes(msgApp);
+        TByte data[MsgApp::nMaxMessageLengthBytes];
+        const bool bDecompressed =
+            (nWireSize >= 1) &&
+            (pData[0] <= MsgApp::nMaxMessageLengthBytes) &&
+            decompressBlock(pData + 1, nWireSize - 1u, data, pData[0]) &&
+            MsgApp::fillMsgApp(msgAppDecompressed, msgAppId, data, pData[0]);
+        const auto timeEnd = std::chrono::steady_clock::now();
+
+        MsgAppStats& stats = m_stats[msgAppId];
+        if (!bDecompressed)
+        {
+            stats.m_nRxFailedCount++;
+            return nullptr;
+        }
+        stats.m_nRxCount++;
+        stats.m_nRxRawBytes += pData[0];
+        stats.m_nRxWireBytes += nWireSize;
+        stats.m_nRxNanosecs += std::chrono::duration_cast<std::chrono::nanoseconds>(timeEnd - timeStart).count();
+        return &msgAppDecompressed;
+    }
+
+    /**
+        @return Statistics by app message id, only for ids sent with compression enabled or received compressed.
+    */
+    const std::map<MsgApp::TMsgId, PgeMsgAppCompressor::MsgAppStats>& PgeMsgAppCompressor::getStats() const
+    {
+        return m_stats;
+    }
+
+    void PgeMsgAppCompressor::clearStats()
+    {
+        m_stats.clear();
+    }
+
+    /**
+        Exports the statistics, 1 line per app message id.
+        Ratios are sent or received size as fraction of the original size, times are average nanoseconds per message.
+
+        @param mapMsgAppId2String Names of app messages by id.
+
+        @return The CSV text.
+    */
+    std::string PgeMsgAppCompressor::exportCsv(const std::map<MsgApp::TMsgId, std::string>& mapMsgAppId2String) const
+    {
+        std::stringstream ss;
+        ss << "id,name,tx_count,tx_compressed_count,tx_raw_bytes,tx_wire_bytes,tx_ratio,tx_avg_ns,"
+            "rx_count,rx_failed_count,rx_raw_bytes,rx_wire_bytes,rx_ratio,rx_avg_ns\n";
+        for (const auto& idStats : m_stats)
+        {
+            const auto itName = mapMsgAppId2String.find(idStats.first);
+            const MsgAppStats& stats = idStats.second;
+            ss << idStats.first << "," << escapeCsvString((itName == mapMsgAppId2String.end()) ? "" : itName->second)
+                << "," << stats.m_nTxCount << "," << stats.m_nTxCompressedCount
+                << "," << stats.m_nTxRawBytes << "," << stats.m_nTxWireBytes
+                << "," << stats.getTxRatio() << "," << stats.getTxAvgNanosecs()
+                << "," << stats.m_nRxCount << "," << stats.m_nRxFailedCount
+                << "," << stats.m_nRxRawBytes << "," << stats.m_nRxWireBytes
+                << "," << stats.getRxRatio() << "," << stats.getRxAvgNanosecs() << "\n";
+        }
+        return ss.str();
+    }
+
+
+    // ############################## PRIVATE ##############################
+
+
+    /**
+        Compresses the given app message into a compressed app message: id flagged with nCompressedMsgIdFlag, data being the
+        original data size in 1 byte followed by the compressed block.
+
+        @return True if the compressed app message is smaller than the given one, false otherwise, leaving msgAppCompressed in
+                undefined state.
+    */
+    bool PgeMsgAppCompressor::compressMsgApp(const MsgApp& msgApp, MsgApp& msgAppCompressed)
+    {
+        const MsgApp::TMsgSize& nSize = MsgApp::getMsgAppDataActualSizeBytes(msgApp);
+        if (nSize <= 2)
+        {
+            // 1 byte size and at least 1 byte block cannot be smaller
+            return false;
+        }
+
+        TByte data[MsgApp::nMaxMessageLengthBytes];
+        const std::size_t nBlockSize = compressBlock(MsgApp::getMsgAppData(msgApp), nSize, data + 1, nSize - 2u);
+        if (nBlockSize == 0)
+        {
+            return false;
+        }
+        data[0] = nSize;
+        return MsgApp::fillMsgApp(
+            msgAppCompressed,
+            static_cast<MsgApp::TMsgId>(MsgApp::getMsgAppMsgId(msgApp) | nCompressedMsgIdFlag),
+            data,
+            static_cast<MsgApp::TMsgSize>(nBlockSize + 1));
+    }
+
+} // namespace pge_network
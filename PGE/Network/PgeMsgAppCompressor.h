@@ -0,0 +1,137 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeMsgAppCompressor.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine app message compression
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "PgePacket.h"
+
+namespace pge_network
+{
+
+    /**
+        Opt-in compression of app messages, per app message id.
+
+        App messages having their id in getCompressedAppMessages() are compressed right before sending, after batching, so the
+        application still deals with uncompressed messages only. If compression does not make a message smaller, the message is
+        sent uncompressed (bypass), so enabling compression for a message id never increases its size on the wire.
+        A compressed app message is sent with nCompressedMsgIdFlag set in its id, and its data is the uncompressed data size
+        in 1 byte followed by a compressed block. Received compressed app messages are decompressed during unpacking, before
+        allowlist checks, regardless of getCompressedAppMessages() of the receiver, so it is enough to configure the sender.
+        Thus app message ids having nCompressedMsgIdFlag set are reserved.
+
+        The codec is a byte-oriented LZ77 variant in the spirit of LZ4: sequences of literals and back-references of at least
+        nMinMatchLengthBytes bytes, found by a single-entry hash table, so it is fast but gives moderate ratio.
+        Small messages have little redundancy within themselves, so back-references can also point into a preset dictionary
+        shared by both sides: by default getDefaultDictionary(), or the one set by setDictionary(), typically trained from
+        captured traffic of the application by trainDictionary(). Sender and receiver must use the same dictionary!
+
+        Statistics are recorded per app message id: ratio and CPU time of compression on sending, and of decompression on receiving,
+        so it can be decided based on real data which message ids are worth compressing.
+
+        Not thread-safe. When the network I/O thread is used, the I/O thread compresses and decompresses, so configure the compressor
+        before listening or connecting, and access its statistics only while holding PgeGnsWrapper::lockIoThread().
+    */
+    class PgeMsgAppCompressor
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeMsgAppCompressor is included")
+#endif
+
+    public:
+
+        static constexpr MsgApp::TMsgId nCompressedMsgIdFlag = 0x8000;
+        static constexpr std::size_t nMinMatchLengthBytes = 4;
+        static constexpr std::size_t nMaxMatchOffset = 0xFFFF;           /**< Back-references are stored in 2 bytes. */
+        static constexpr std::size_t nMaxDictionarySizeBytes = 4096;
+        static constexpr std::size_t nDefaultTrainedDictionarySizeBytes = 1024;
+
+        /**
+            Compression statistics of a single app message id.
+            Byte counts are app message data sizes, without the 3-byte app message header.
+        */
+        struct MsgAppStats
+        {
+            uint32_t m_nTxCount;            /**< Sent messages with compression enabled. */
+            uint32_t m_nTxCompressedCount;  /**< Sent messages actually compressed, the rest was bypassed. */
+            uint64_t m_nTxRawBytes;         /**< Data size of sent messages before compression. */
+            uint64_t m_nTxWireBytes;        /**< Data size of sent messages as sent, including bypassed messages. */
+            uint64_t m_nTxNanosecs;         /**< Time spent compressing, including bypassed attempts. */
+            uint32_t m_nRxCount;            /**< Received compressed messages. */
+            uint32_t m_nRxFailedCount;      /**< Received compressed messages failed to be decompressed. */
+            uint64_t m_nRxRawBytes;         /**< Data size of received compressed messages after decompression. */
+            uint64_t m_nRxWireBytes;        /**< Data size of received compressed messages as received. */
+            uint64_t m_nRxNanosecs;         /**< Time spent decompressing. */
+
+            MsgAppStats();
+
+            float getTxRatio() const;
+            float getRxRatio() const;
+            uint64_t getTxAvgNanosecs() const;
+            uint64_t getRxAvgNanosecs() const;
+        }; // struct MsgAppStats
+
+        // ---------------------------------------------------------------------------
+
+        static const std::vector<TByte>& getDefaultDictionary();
+        static std::vector<TByte> trainDictionary(
+            const std::vector<std::vector<TByte>>& vSamples,
+            const std::size_t& nDictionarySizeBytes = nDefaultTrainedDictionarySizeBytes) noexcept(false);
+
+        static bool isMsgAppCompressed(const MsgApp& msgApp);
+        static bool hasCompressedMsgApp(const PgePacket& pkt);
+        static MsgApp::TMsgId getUncompressedMsgAppId(const MsgApp::TMsgId& msgAppId);
+
+        PgeMsgAppCompressor();
+        ~PgeMsgAppCompressor() = default;
+
+        PgeMsgAppCompressor(const PgeMsgAppCompressor&) = delete;
+        PgeMsgAppCompressor& operator=(const PgeMsgAppCompressor&) = delete;
+        PgeMsgAppCompressor(PgeMsgAppCompressor&&) = delete;
+        PgeMsgAppCompressor& operator=(PgeMsgAppCompressor&&) = delete;
+
+        std::set<MsgApp::TMsgId>& getCompressedAppMessages();
+
+        void setDictionary(const std::vector<TByte>& vDictionary) noexcept(false);
+        const std::vector<TByte>& getDictionary() const;
+
+        std::size_t compressBlock(const TByte* pSrc, const std::size_t& nSrcSize, TByte* pDst, const std::size_t& nDstCapacity);
+        bool decompressBlock(const TByte* pSrc, const std::size_t& nSrcSize, TByte* pDst, const std::size_t& nDstSize) const;
+
+        bool compressPkt(const PgePacket& pkt, PgePacket& pktCompressed);
+        const MsgApp* decompressMsgApp(const MsgApp& msgApp, MsgApp& msgAppDecompressed);
+
+        const std::map<MsgApp::TMsgId, MsgAppStats>& getStats() const;
+        void clearStats();
+        std::string exportCsv(const std::map<MsgApp::TMsgId, std::string>& mapMsgAppId2String) const;
+
+    private:
+
+        static constexpr uint32_t nDictHashBits = 12;
+
+        std::set<MsgApp::TMsgId> m_compressedAppMessages;
+        std::vector<TByte> m_vDictionary;
+        std::vector<uint32_t> m_vDictHashTable;   /**< Dictionary position + 1 by hash, 0 if empty, built by setDictionary(). */
+        std::vector<uint32_t> m_vHashTable;       /**< Window position + 1 by hash, 0 if empty, cleared by each compressBlock(). */
+        std::vector<TByte> m_vWindow;             /**< Dictionary followed by the data being compressed, grows only. */
+        std::map<MsgApp::TMsgId, MsgAppStats> m_stats;
+
+        bool compressMsgApp(const MsgApp& msgApp, MsgApp& msgAppCompressed);
+
+    }; // class PgeMsgAppCompressor
+
+} // namespace pge_network
@@ -0,0 +1,268 @@
+/*
+    ###################################################################################
+    PgeMsgAppDispatcher.cpp
+    This file is part of PGE.
+    PR00F's Game Engine table-driven packet dispatcher
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgeMsgAppDispatcher.h"
+
+#include <algorithm>
+#include <chrono>  // requires cpp11
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace pge_network {
+
+    static std::string escapeCsvString(const std::string& str)
+    {
+        std::string sEscaped = "\"";
+        for (const char c : str)
+        {
+            if (c == '"')
+            {
+                sEscaped += '"';
+            }
+            sEscaped += c;
+        }
+        return sEscaped + "\"";
+    }
+
+    PgeMsgAppDispatcher::HandlerStats::HandlerStats() :
+        m_nCallCount(0),
+        m_nNanosecs(0),
+        m_nMaxNanosecs(0)
+    {
+    }
+
+    uint64_t PgeMsgAppDispatcher::HandlerStats::getAvgNanosecs() const
+    {
+        return (m_nCallCount == 0) ? 0 : (m_nNanosecs / m_nCallCount);
+    }
+
+    PgeMsgAppDispatcher::PgeMsgAppDispatcher() :
+        m_bTimingEnabled(true),
+        m_nUnhandledCount(0)
+    {
+        m_pktHandlerIndices.fill(nNoHandler);
+    }
+
+    /**
+        Registers the handler of the given app message id, expected to be done at startup.
+
+        @param msgAppId App message id to be handled. Throws std::runtime_error if already has a handler.
+        @param sName    Name of the handler or the message, used only for exporting statistics.
+        @param handler  The handler. Throws std::runtime_error if empty.
+    */
+    void PgeMsgAppDispatcher::registerMsgAppHandler(const MsgApp::TMsgId& msgAppId, const std::string& sName, const MsgAppHandler& handler) noexcept(false)
+    {
+        if (!handler)
+        {
+            throw std::runtime_error("PgeMsgAppDispatcher::registerMsgAppHandler(): empty handler!");
+        }
+        if (isMsgAppHandlerRegistered(msgAppId))
+        {
+            throw std::runtime_error("PgeMsgAppDispatcher::registerMsgAppHandler(): app message id " + std::to_string(msgAppId) + " already has a handler!");
+        }
+        if (m_vHandlers.size() >= std::numeric_limits<uint16_t>::max())
+        {
+            throw std::runtime_error("PgeMsgAppDispatcher::registerMsgAppHandler(): too many handlers!");
+        }
+
+        if (m_vMsgAppHandlerIndices.size() <= msgAppId)
+        {
+            m_vMsgAppHandlerIndices.resize(static_cast<std::size_t>(msgAppId) + 1, nNoHandler);
+        }
+
+        Handler newHandler;
+        newHandler.m_fnMsgApp = handler;
+        newHandler.m_nId = msgAppId;
+        newHandler.m_stats.m_sName = sName;
+        m_vHandlers.push_back(newHandler);
+        m_vMsgAppHandlerIndices[msgAppId] = static_cast<uint16_t>(m_vHandlers.size());
+    }
+
+    /**
+        Registers the handler of the given pge message id, expected to be done at startup.
+
+        @param pktId   Pge message id to be handled. Throws std::runtime_error if already has a handler, or if it is PgePktId::Application,
+                       since app messages are handled by handlers registered using registerMsgAppHandler().
+        @param sName   Name of the handler or the message, used only for exporting statistics.
+        @param handler The handler. Throws std::runtime_error if empty.
+    */
+    void PgeMsgAppDispatcher::registerPktHandler(const PgePktId& pktId, const std::string& sName, const PktHandler& handler) noexcept(false)
+    {
+        if (!handler)
+        {
+            throw std::runtime_error("PgeMsgAppDispatcher::registerPktHandler(): empty handler!");
+        }
+        if ((pktId == PgePktId::Application) || (static_cast<std::size_t>(pktId) >= nPktIdCount))
+        {
+            throw std::runtime_error("PgeMsgAppDispatcher::registerPktHandler(): invalid pge message id " + std::to_string(static_cast<uint32_t>(pktId)) + "!");
+        }
+        if (isPktHandlerRegistered(pktId))
+        {
+            throw std::runtime_error("PgeMsgAppDispatcher::registerPktHandler(): pge message id " + std::to_string(static_cast<uint32_t>(pktId)) + " already has a handler!");
+        }
+        if (m_vHandlers.size() >= std::numeric_limits<uint16_t>::max())
+        {
+            throw std::runtime_error("PgeMsgAppDispatcher::registerPktHandler(): too many handlers!");
+        }
+
+        Handler newHandler;
+        newHandler.m_fnPkt = handler;
+        newHandler.m_nId = static_cast<uint32_t>(pktId);
+        newHandler.m_stats.m_sName = sName;
+        m_vHandlers.push_back(newHandler);
+        m_pktHandlerIndices[static_cast<std::size_t>(pktId)] = static_cast<uint16_t>(m_vHandlers.size());
+    }
+
+    bool PgeMsgAppDispatcher::isMsgAppHandlerRegistered(const MsgApp::TMsgId& msgAppId) const
+    {
+        return (msgAppId < m_vMsgAppHandlerIndices.size()) && (m_vMsgAppHandlerIndices[msgAppId] != nNoHandler);
+    }
+
+    bool PgeMsgAppDispatcher::isPktHandlerRegistered(const PgePktId& pktId) const
+    {
+        return (static_cast<std::size_t>(pktId) < nPktIdCount) && (m_pktHandlerIndices[static_cast<std::size_t>(pktId)] != nNoHandler);
+    }
+
+    bool PgeMsgAppDispatcher::isTimingEnabled() const
+    {
+        return m_bTimingEnabled;
+    }
+
+    /**
+        Enables or disables measuring time spent in handlers. Invocations are counted even if disabled.
+        Enabled by default.
+    */
+    void PgeMsgAppDispatcher::setTimingEnabled(bool bEnabled)
+    {
+        m_bTimingEnabled = bEnabled;
+    }
+
+    /**
+        Invokes the handlers of the given packet: the handler of its pge message id for non-application packets, otherwise the handler
+        of each app message in the packet, in order.
+        Messages without registered handler are counted by getUnhandledCount() and logged, and dispatching continues.
+
+        @return False if a handler returned false, in that case the rest of the app messages are not dispatched, true otherwise.
+    */
+    bool PgeMsgAppDispatcher::dispatch(const PgePacket& pkt)
+    {
+        const PgePktId& pktId = PgePacket::getPacketId(pkt);
+        if (pktId != PgePktId::Application)
+        {
+            if (!isPktHandlerRegistered(pktId))
+            {
+                ++m_nUnhandledCount;
+                CConsole::getConsoleInstance("PgeMsgAppDispatcher").EOLn("%s: no handler for pge message %u!", __func__, pktId);
+                return true;
+            }
+            return invoke(m_vHandlers[m_pktHandlerIndices[static_cast<std::size_t>(pktId)] - 1], pkt, nullptr);
+        }
+
+        // Header is read only once: message count and area length bound the walk, instead of getNextMsgAppFromPkt()
+        // reading the area header again for each message.
+        const uint8_t nMessageCount = PgePacket::getMessageAppCount(pkt);
+        const TByte* pMsgAppBytes = reinterpret_cast<const TByte*>(PgePacket::getMsgAppFromPkt(pkt));
+        const TByte* const pMsgAppAreaEnd = pMsgAppBytes + PgePacket::getMessageAppsTotalActualLengthBytes(pkt);
+        for (uint8_t iMsgApp = 0; (iMsgApp < nMessageCount) && (pMsgAppBytes < pMsgAppAreaEnd); iMsgApp++)
+        {
+            const MsgApp& msgApp = *reinterpret_cast<const MsgApp*>(pMsgAppBytes);
+            const MsgApp::TMsgId msgAppId = MsgApp::getMsgAppMsgId(msgApp);
+            if (!isMsgAppHandlerRegistered(msgAppId))
+            {
+                ++m_nUnhandledCount;
+                CConsole::getConsoleInstance("PgeMsgAppDispatcher").EOLn("%s: no handler for app message %u!", __func__, msgAppId);
+            }
+            else if (!invoke(m_vHandlers[m_vMsgAppHandlerIndices[msgAppId] - 1], pkt, &msgApp))
+            {
+                return false;
+            }
+            pMsgAppBytes += MsgApp::getMsgAppTotalActualSizeBytes(msgApp);
+        }
+        return true;
+    }
+
+    /**
+        @return Statistics of the handler of the given app message id, or nullptr if there is no such handler.
+    */
+    const PgeMsgAppDispatcher::HandlerStats* PgeMsgAppDispatcher::getMsgAppHandlerStats(const MsgApp::TMsgId& msgAppId) const
+    {
+        return isMsgAppHandlerRegistered(msgAppId) ? &m_vHandlers[m_vMsgAppHandlerIndices[msgAppId] - 1].m_stats : nullptr;
+    }
+
+    /**
+        @return Statistics of the handler of the given pge message id, or nullptr if there is no such handler.
+    */
+    const PgeMsgAppDispatcher::HandlerStats* PgeMsgAppDispatcher::getPktHandlerStats(const PgePktId& pktId) const
+    {
+        return isPktHandlerRegistered(pktId) ? &m_vHandlers[m_pktHandlerIndices[static_cast<std::size_t>(pktId)] - 1].m_stats : nullptr;
+    }
+
+    /**
+        @return Number of messages dispatched without registered handler.
+    */
+    uint64_t PgeMsgAppDispatcher::getUnhandledCount() const
+    {
+        return m_nUnhandledCount;
+    }
+
+    /**
+        Clears the statistics of all handlers and the unhandled count, handlers stay registered.
+    */
+    void PgeMsgAppDispatcher::clearStats()
+    {
+        for (auto& handler : m_vHandlers)
+        {
+            handler.m_stats.m_nCallCount = 0;
+            handler.m_stats.m_nNanosecs = 0;
+            handler.m_stats.m_nMaxNanosecs = 0;
+        }
+        m_nUnhandledCount = 0;
+    }
+
+    /**
+        @return Statistics of all handlers in CSV format, 1 line per handler in order of registration.
+    */
+    std::string PgeMsgAppDispatcher::exportCsv() const
+    {
+        std::stringstream ss;
+        ss << "kind,id,name,call_count,total_ns,avg_ns,max_ns\n";
+        for (const auto& handler : m_vHandlers)
+        {
+            ss << (handler.m_fnMsgApp ? "app" : "pge") << "," << handler.m_nId << "," << escapeCsvString(handler.m_stats.m_sName)
+                << "," << handler.m_stats.m_nCallCount << "," << handler.m_stats.m_nNanosecs
+                << "," << handler.m_stats.getAvgNanosecs() << "," << handler.m_stats.m_nMaxNanosecs << "\n";
+        }
+        return ss.str();
+    }
+
+
+    // ############################## PRIVATE ##############################
+
+
+    bool PgeMsgAppDispatcher::invoke(Handler& handler, const PgePacket& pkt, const MsgApp* pMsgApp)
+    {
+        ++handler.m_stats.m_nCallCount;
+        if (!m_bTimingEnabled)
+        {
+            return pMsgApp ? handler.m_fnMsgApp(pkt, *pMsgApp) : handler.m_fnPkt(pkt);
+        }
+
+        const auto timeStart = std::chrono::steady_clock::now();
+        const bool bRet = pMsgApp ? handler.m_fnMsgApp(pkt, *pMsgApp) : handler.m_fnPkt(pkt);
+        const auto timeEnd = std::chrono::steady_clock::now();
+        const uint64_t nNanosecs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(timeEnd - timeStart).count());
+        handler.m_stats.m_nNanosecs += nNanosecs;
+        handler.m_stats.m_nMaxNanosecs = std::max(handler.m_stats.m_nMaxNanosecs, nNanosecs);
+        return bRet;
+    }
+
+} // namespace pge_network
@@ -0,0 +1,115 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeMsgAppDispatcher.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine table-driven packet dispatcher
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "PgePacket.h"
+
+namespace pge_network
+{
+
+    /**
+        Dispatches received packets to handlers registered per app message id and per pge message id, replacing big switch
+        statements in PGE::onPacketReceived(): the application registers its handlers at startup, then passes each received
+        packet to dispatch().
+
+        Handlers are found by indexing a dense table by message id, so dispatching costs the same for any number of handlers.
+        A packet carrying multiple batched app messages, e.g. a packet built by the application itself or replayed from a capture file,
+        is walked through in a single pass: the packet header is read once, and each app message is passed to its handler along with
+        the packet, so handlers can still get the connection handle from the packet.
+
+        Each handler has its own statistics: number of invocations and time spent in it, so the application can see which message
+        handlers are expensive without a profiler. Timing can be disabled by setTimingEnabled() if even the clock reads are too much.
+    */
+    class PgeMsgAppDispatcher
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeMsgAppDispatcher is included")
+#endif
+
+    public:
+
+        static constexpr std::size_t nPktIdCount = static_cast<std::size_t>(PgePktId::Application) + 1;
+
+        /** Invoked for each app message of a packet, returning false stops dispatching, same as PGE::onPacketReceived(). */
+        typedef std::function<bool(const PgePacket& pkt, const MsgApp& msgApp)> MsgAppHandler;
+
+        /** Invoked for non-application packets, returning false stops dispatching, same as PGE::onPacketReceived(). */
+        typedef std::function<bool(const PgePacket& pkt)> PktHandler;
+
+        struct HandlerStats
+        {
+            std::string m_sName;         /**< Given at registration, used for exporting. */
+            uint64_t m_nCallCount;
+            uint64_t m_nNanosecs;        /**< Total time spent in the handler, 0 if timing is disabled. */
+            uint64_t m_nMaxNanosecs;     /**< Longest single invocation. */
+
+            HandlerStats();
+
+            uint64_t getAvgNanosecs() const;
+        }; // struct HandlerStats
+
+        // ---------------------------------------------------------------------------
+
+        PgeMsgAppDispatcher();
+        ~PgeMsgAppDispatcher() = default;
+
+        PgeMsgAppDispatcher(const PgeMsgAppDispatcher&) = delete;
+        PgeMsgAppDispatcher& operator=(const PgeMsgAppDispatcher&) = delete;
+        PgeMsgAppDispatcher(PgeMsgAppDispatcher&&) = delete;
+        PgeMsgAppDispatcher& operator=(PgeMsgAppDispatcher&&) = delete;
+
+        void registerMsgAppHandler(const MsgApp::TMsgId& msgAppId, const std::string& sName, const MsgAppHandler& handler) noexcept(false);
+        void registerPktHandler(const PgePktId& pktId, const std::string& sName, const PktHandler& handler) noexcept(false);
+        bool isMsgAppHandlerRegistered(const MsgApp::TMsgId& msgAppId) const;
+        bool isPktHandlerRegistered(const PgePktId& pktId) const;
+
+        bool isTimingEnabled() const;
+        void setTimingEnabled(bool bEnabled);
+
+        bool dispatch(const PgePacket& pkt);
+
+        const HandlerStats* getMsgAppHandlerStats(const MsgApp::TMsgId& msgAppId) const;
+        const HandlerStats* getPktHandlerStats(const PgePktId& pktId) const;
+        uint64_t getUnhandledCount() const;
+        void clearStats();
+        std::string exportCsv() const;
+
+    private:
+
+        static constexpr uint16_t nNoHandler = 0;  /**< Value in the index tables for ids without handler, other values are index + 1. */
+
+        struct Handler
+        {
+            MsgAppHandler m_fnMsgApp;     /**< Set for app message handlers. */
+            PktHandler m_fnPkt;           /**< Set for pge message handlers. */
+            uint32_t m_nId;               /**< App message id or pge message id, depending on which function is set. */
+            HandlerStats m_stats;
+        };
+
+        std::vector<Handler> m_vHandlers;                           /**< In order of registration. */
+        std::vector<uint16_t> m_vMsgAppHandlerIndices;              /**< Indexed by app message id, as big as the biggest registered id + 1. */
+        std::array<uint16_t, nPktIdCount> m_pktHandlerIndices;      /**< Indexed by pge message id. */
+        bool m_bTimingEnabled;
+        uint64_t m_nUnhandledCount;
+
+        bool invoke(Handler& handler, const PgePacket& pkt, const MsgApp* pMsgApp);
+
+    }; // class PgeMsgAppDispatcher
+
+} // namespace pge_network
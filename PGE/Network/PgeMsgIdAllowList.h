@@ -0,0 +1,137 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeMsgIdAllowList.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine dense bitset of allowed message ids
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+
+#include "PgePacket.h"
+
+namespace pge_network
+{
+
+    /**
+        Set of allowed message ids, stored as a dense bitset indexed by id, so checking an id of a received message is a single
+        bit test instead of a tree lookup as with std::set.
+
+        Interface is a subset of std::set so code inserting and counting ids works the same way with either container.
+        Ids must be less than nIdCount, inserting a bigger id throws, looking it up returns as not allowed.
+        No memory is allocated: the whole bitset is a member, e.g. 8 KiB for all possible app message ids.
+    */
+    template <typename TId, std::size_t nIdCount>
+    class PgeMsgIdAllowList
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeMsgIdAllowList is included")
+#endif
+
+    public:
+
+        static constexpr std::size_t nMaxIdCount = nIdCount;
+
+        PgeMsgIdAllowList() :
+            m_nSize(0)
+        {
+            m_words.fill(0);
+        }
+
+        ~PgeMsgIdAllowList() = default;
+
+        PgeMsgIdAllowList(const PgeMsgIdAllowList&) = default;
+        PgeMsgIdAllowList& operator=(const PgeMsgIdAllowList&) = default;
+        PgeMsgIdAllowList(PgeMsgIdAllowList&&) = default;
+        PgeMsgIdAllowList& operator=(PgeMsgIdAllowList&&) = default;
+
+        /**
+            @return True if the given id was not yet in the list, false otherwise.
+        */
+        bool insert(const TId& id) noexcept(false)
+        {
+            const std::size_t i = static_cast<std::size_t>(id);
+            if (i >= nIdCount)
+            {
+                throw std::runtime_error("PgeMsgIdAllowList::insert(): id out of range!");
+            }
+            if (contains(id))
+            {
+                return false;
+            }
+            m_words[i / nBitsPerWord] |= getBit(i);
+            ++m_nSize;
+            return true;
+        }
+
+        /**
+            @return Number of removed ids: 1 if the given id was in the list, 0 otherwise.
+        */
+        std::size_t erase(const TId& id)
+        {
+            if (!contains(id))
+            {
+                return 0;
+            }
+            const std::size_t i = static_cast<std::size_t>(id);
+            m_words[i / nBitsPerWord] &= ~getBit(i);
+            --m_nSize;
+            return 1;
+        }
+
+        bool contains(const TId& id) const
+        {
+            const std::size_t i = static_cast<std::size_t>(id);
+            return (i < nIdCount) && ((m_words[i / nBitsPerWord] & getBit(i)) != 0);
+        }
+
+        std::size_t count(const TId& id) const
+        {
+            return contains(id) ? 1 : 0;
+        }
+
+        std::size_t size() const
+        {
+            return m_nSize;
+        }
+
+        bool empty() const
+        {
+            return m_nSize == 0;
+        }
+
+        void clear()
+        {
+            m_words.fill(0);
+            m_nSize = 0;
+        }
+
+    private:
+
+        static constexpr std::size_t nBitsPerWord = 64;
+
+        static constexpr uint64_t getBit(const std::size_t& i)
+        {
+            return static_cast<uint64_t>(1) << (i % nBitsPerWord);
+        }
+
+        std::array<uint64_t, (nIdCount + nBitsPerWord - 1) / nBitsPerWord> m_words;
+        std::size_t m_nSize;
+
+    }; // class PgeMsgIdAllowList
+
+    /** Allow list of pge messages, i.e. packet ids. */
+    typedef PgeMsgIdAllowList<PgePktId, static_cast<std::size_t>(PgePktId::Application) + 1> PgePktIdAllowList;
+
+    /** Allow list of app messages, covering all possible app message ids. */
+    typedef PgeMsgIdAllowList<MsgApp::TMsgId, static_cast<std::size_t>(std::numeric_limits<MsgApp::TMsgId>::max()) + 1> MsgAppIdAllowList;
+
+} // namespace pge_network
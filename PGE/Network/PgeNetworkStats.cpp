@@ -0,0 +1,595 @@
+/*
+    ###################################################################################
+    PgeNetworkStats.cpp
+    This file is part of PGE.
+    PR00F's Game Engine network traffic statistics
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgeNetworkStats.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace pge_network {
+
+    static std::string escapeCsvString(const std::string& str)
+    {
+        std::string sEscaped = "\"";
+        for (const char c : str)
+        {
+            if (c == '"')
+            {
+                sEscaped += '"';
+            }
+            sEscaped += c;
+        }
+        return sEscaped + "\"";
+    }
+
+    static std::string escapeJsonString(const std::string& str)
+    {
+        std::string sEscaped = "\"";
+        for (const char c : str)
+        {
+            if ((c == '"') || (c == '\\'))
+            {
+                sEscaped += '\\';
+                sEscaped += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                sEscaped += ' ';
+            }
+            else
+            {
+                sEscaped += c;
+            }
+        }
+        return sEscaped + "\"";
+    }
+
+    static std::string getMsgAppName(const std::map<MsgApp::TMsgId, std::string>& mapMsgAppId2String, const MsgApp::TMsgId& msgAppId)
+    {
+        const auto it = mapMsgAppId2String.find(msgAppId);
+        return (it == mapMsgAppId2String.end()) ? "" : it->second;
+    }
+
+    template <std::size_t N>
+    static void writeCsvHistogram(std::stringstream& ss, const std::array<uint32_t, N>& histogram)
+    {
+        for (const auto& nBucket : histogram)
+        {
+            ss << "," << nBucket;
+        }
+    }
+
+    template <std::size_t N>
+    static void writeJsonHistogram(std::stringstream& ss, const std::array<uint32_t, N>& histogram)
+    {
+        ss << "[";
+        for (std::size_t i = 0; i < N; i++)
+        {
+            ss << (i == 0 ? "" : ",") << histogram[i];
+        }
+        ss << "]";
+    }
+
+    static void writeCsvRecord(
+        std::stringstream& ss,
+        const char* szDirection,
+        const char* szScope,
+        const uint32_t& nId,
+        const std::string& sName,
+        const PgeNetworkStats::Record& record,
+        const PgeNetworkStats::TimePoint& timeNow)
+    {
+        ss << szDirection << "," << szScope << "," << nId << "," << escapeCsvString(sName) << ","
+            << record.m_nCount << "," << record.m_nBytes << ","
+            << record.getCountPerSecond(timeNow) << "," << record.getBytesPerSecond(timeNow);
+        writeCsvHistogram(ss, record.m_nSizeHistogram);
+        writeCsvHistogram(ss, record.m_nInterArrivalHistogram);
+        ss << "\n";
+    }
+
+    static void writeJsonRecord(
+        std::stringstream& ss,
+        const char* szDirection,
+        const uint32_t& nId,
+        const std::string* pName,
+        const PgeNetworkStats::Record& record,
+        const PgeNetworkStats::TimePoint& timeNow)
+    {
+        ss << "{\"direction\":\"" << szDirection << "\",\"id\":" << nId;
+        if (pName)
+        {
+            ss << ",\"name\":" << escapeJsonString(*pName);
+        }
+        ss << ",\"count\":" << record.m_nCount << ",\"bytes\":" << record.m_nBytes
+            << ",\"count_per_sec\":" << record.getCountPerSecond(timeNow) << ",\"bytes_per_sec\":" << record.getBytesPerSecond(timeNow)
+            << ",\"size_hist\":";
+        writeJsonHistogram(ss, record.m_nSizeHistogram);
+        ss << ",\"interarrival_us_hist\":";
+        writeJsonHistogram(ss, record.m_nInterArrivalHistogram);
+        ss << "}";
+    }
+
+    PgeNetworkStats::Record::Record() :
+        m_nCount(0),
+        m_nBytes(0),
+        m_nSizeHistogram{},
+        m_nInterArrivalHistogram{},
+        m_nRateWindowCount(0),
+        m_nRateWindowBytes(0),
+        m_nRateLastWindowCount(0),
+        m_nRateLastWindowBytes(0)
+    {
+    }
+
+    /**
+        Records a single app message or packet.
+        Per-second rates are maintained using 1-second windows: when a window is over, its count and bytes become the rate,
+        so no timestamps need to be stored per record.
+
+        @param nBytes Size of the recorded app message or packet.
+        @param time   Time of sending or receiving, expected to be not less than time of previous call.
+    */
+    void PgeNetworkStats::Record::add(const uint32_t& nBytes, const TimePoint& time)
+    {
+        if (m_nCount == 0)
+        {
+            m_time1st = time;
+            m_timeRateWindowStart = time;
+        }
+        else
+        {
+            const auto nMicrosSinceLast = std::chrono::duration_cast<std::chrono::microseconds>(time - m_timeLast).count();
+            ++m_nInterArrivalHistogram[getHistogramBucketIndex(nMicrosSinceLast > 0 ? nMicrosSinceLast : 0, nInterArrivalHistogramBucketCount)];
+
+            const auto durRateWindow = time - m_timeRateWindowStart;
+            if (durRateWindow >= std::chrono::seconds(1))
+            {
+                // if the window was over long ago, there was no traffic in the last second
+                const bool bLastWindowIsRecent = durRateWindow < std::chrono::seconds(2);
+                m_nRateLastWindowCount = bLastWindowIsRecent ? m_nRateWindowCount : 0;
+                m_nRateLastWindowBytes = bLastWindowIsRecent ? m_nRateWindowBytes : 0;
+                m_nRateWindowCount = 0;
+                m_nRateWindowBytes = 0;
+                m_timeRateWindowStart = time;
+            }
+        }
+
+        m_nCount++;
+        m_nBytes += nBytes;
+        m_timeLast = time;
+        ++m_nSizeHistogram[getHistogramBucketIndex(nBytes, nSizeHistogramBucketCount)];
+        m_nRateWindowCount++;
+        m_nRateWindowBytes += nBytes;
+    }
+
+    /**
+        @param timeNow Current time.
+
+        @return Number of records in the last completed 1-second window, 0 if there was no record in the last 2 seconds.
+    */
+    uint32_t PgeNetworkStats::Record::getCountPerSecond(const TimePoint& timeNow) const
+    {
+        if (m_nCount == 0)
+        {
+            return 0;
+        }
+
+        const auto durRateWindow = timeNow - m_timeRateWindowStart;
+        if (durRateWindow < std::chrono::seconds(1))
+        {
+            return m_nRateLastWindowCount;
+        }
+        return (durRateWindow < std::chrono::seconds(2)) ? m_nRateWindowCount : 0;
+    }
+
+    /**
+        @param timeNow Current time.
+
+        @return Number of bytes in the last completed 1-second window, 0 if there was no record in the last 2 seconds.
+    */
+    uint64_t PgeNetworkStats::Record::getBytesPerSecond(const TimePoint& timeNow) const
+    {
+        if (m_nCount == 0)
+        {
+            return 0;
+        }
+
+        const auto durRateWindow = timeNow - m_timeRateWindowStart;
+        if (durRateWindow < std::chrono::seconds(1))
+        {
+            return m_nRateLastWindowBytes;
+        }
+        return (durRateWindow < std::chrono::seconds(2)) ? m_nRateWindowBytes : 0;
+    }
+
+    /**
+        @param nValue       The value to be put into a histogram.
+        @param nBucketCount Number of buckets of the histogram, must be positive.
+
+        @return Index of log2 bucket for the given value: 0 for 0, otherwise the number of significant bits of the value,
+                clamped to the last bucket.
+    */
+    std::size_t PgeNetworkStats::getHistogramBucketIndex(const uint64_t& nValue, const std::size_t& nBucketCount)
+    {
+        std::size_t iBucket = 0;
+        uint64_t nRemaining = nValue;
+        while ((nRemaining != 0) && (iBucket < nBucketCount - 1))
+        {
+            nRemaining >>= 1;
+            iBucket++;
+        }
+        return iBucket;
+    }
+
+    const char* PgeNetworkStats::getDirectionString(const Direction& dir)
+    {
+        switch (dir)
+        {
+        case Direction::Rx:
+            return "Rx";
+        case Direction::Tx:
+            return "Tx";
+        case Direction::Inject:
+            return "Inject";
+        default:
+            return "Unknown";
+        }
+    }
+
+    /**
+        Preallocates all per app message id records.
+    */
+    PgeNetworkStats::PgeNetworkStats() :
+        m_nLaneMsgCount{}
+    {
+        for (auto& vRecords : m_vMsgAppRecords)
+        {
+            vRecords.resize(nMsgAppIdSlotCount);
+        }
+    }
+
+    /**
+        Records an app message.
+        Expected to be invoked for each app message of a packet, in addition to invoking addPkt() for the packet itself.
+
+        @param dir      Direction of the app message.
+        @param msgAppId Id of the app message. Ids not less than nMsgAppIdSlotCount - 1 are all recorded into the last slot.
+        @param nBytes   Total size of the app message, including its header.
+        @param lane     Send lane of the app message.
+        @param time     Time of sending or receiving.
+    */
+    void PgeNetworkStats::addMsgApp(
+        const Direction& dir,
+        const MsgApp::TMsgId& msgAppId,
+        const uint32_t& nBytes,
+        const PgeSendLane& lane,
+        const TimePoint& time)
+    {
+        const std::size_t iSlot = (msgAppId < nMsgAppIdSlotCount) ? msgAppId : (nMsgAppIdSlotCount - 1);
+        m_vMsgAppRecords[static_cast<std::size_t>(dir)][iSlot].add(nBytes, time);
+        ++m_nLaneMsgCount[static_cast<std::size_t>(dir)][static_cast<std::size_t>(lane)];
+    }
+
+    /**
+        Records a packet of a connection.
+        The first packet of a yet unknown connection allocates its records.
+
+        @param dir        Direction of the packet.
+        @param connHandle The connection the packet is sent to or received from.
+        @param nBytes     Size of the packet as sent on network.
+        @param time       Time of sending or receiving.
+    */
+    void PgeNetworkStats::addPkt(
+        const Direction& dir,
+        const PgeNetworkConnectionHandle& connHandle,
+        const uint32_t& nBytes,
+        const TimePoint& time)
+    {
+        ConnectionRecords* pConnRecords = findConnectionRecords(connHandle);
+        if (!pConnRecords)
+        {
+            m_vConnectionRecords.push_back(ConnectionRecords());
+            pConnRecords = &m_vConnectionRecords.back();
+            pConnRecords->m_connHandle = connHandle;
+        }
+        pConnRecords->m_records[static_cast<std::size_t>(dir)].add(nBytes, time);
+    }
+
+    /**
+        Deletes all records of the given connection, expected to be invoked when the connection is closed.
+        No effect if the connection is not recorded.
+
+        @param connHandle The closed connection.
+    */
+    void PgeNetworkStats::removeConnection(const PgeNetworkConnectionHandle& connHandle)
+    {
+        for (auto it = m_vConnectionRecords.begin(); it != m_vConnectionRecords.end(); ++it)
+        {
+            if (it->m_connHandle == connHandle)
+            {
+                m_vConnectionRecords.erase(it);
+                return;
+            }
+        }
+    }
+
+    /**
+        Resets all records, without releasing preallocated memory.
+    */
+    void PgeNetworkStats::clear()
+    {
+        for (auto& vRecords : m_vMsgAppRecords)
+        {
+            std::fill(vRecords.begin(), vRecords.end(), Record());
+        }
+        m_vConnectionRecords.clear();
+        m_nLaneMsgCount = {};
+    }
+
+    /**
+        @param dir      Direction.
+        @param msgAppId Id of the app message. Ids not less than nMsgAppIdSlotCount - 1 all give the record of the last slot.
+
+        @return Record of the given app message id in the given direction.
+    */
+    const PgeNetworkStats::Record& PgeNetworkStats::getMsgAppRecord(const Direction& dir, const MsgApp::TMsgId& msgAppId) const
+    {
+        const std::size_t iSlot = (msgAppId < nMsgAppIdSlotCount) ? msgAppId : (nMsgAppIdSlotCount - 1);
+        return m_vMsgAppRecords[static_cast<std::size_t>(dir)][iSlot];
+    }
+
+    /**
+        @param dir        Direction.
+        @param connHandle The connection.
+
+        @return Record of the given connection in the given direction, or nullptr if the connection is not recorded.
+                The returned pointer is invalidated by addPkt() with a new connection, removeConnection() and clear().
+    */
+    const PgeNetworkStats::Record* PgeNetworkStats::getConnectionRecord(const Direction& dir, const PgeNetworkConnectionHandle& connHandle) const
+    {
+        const ConnectionRecords* const pConnRecords = findConnectionRecords(connHandle);
+        return pConnRecords ? &(pConnRecords->m_records[static_cast<std::size_t>(dir)]) : nullptr;
+    }
+
+    /**
+        @return Handles of all recorded connections, in order of their first recorded packet.
+    */
+    std::vector<PgeNetworkConnectionHandle> PgeNetworkStats::getConnectionHandles() const
+    {
+        std::vector<PgeNetworkConnectionHandle> vConnHandles;
+        vConnHandles.reserve(m_vConnectionRecords.size());
+        for (const auto& connRecords : m_vConnectionRecords)
+        {
+            vConnHandles.push_back(connRecords.m_connHandle);
+        }
+        return vConnHandles;
+    }
+
+    uint32_t PgeNetworkStats::getLaneMsgCount(const Direction& dir, const PgeSendLane& lane) const
+    {
+        return m_nLaneMsgCount[static_cast<std::size_t>(dir)][static_cast<std::size_t>(lane)];
+    }
+
+    /**
+        Builds a map of app message counts per app message id, containing only the ids having non-zero count.
+        Since the map is rebuilt on each call, this should not be invoked frequently.
+
+        @param dir Direction.
+
+        @return Map of app message counts per app message id in the given direction, valid until the next call with the same direction.
+    */
+    const std::map<MsgApp::TMsgId, uint32_t>& PgeNetworkStats::getMsgAppCountMap(const Direction& dir) const
+    {
+        const std::vector<Record>& vRecords = m_vMsgAppRecords[static_cast<std::size_t>(dir)];
+        std::map<MsgApp::TMsgId, uint32_t>& mapMsgAppCount = m_mapMsgAppCount[static_cast<std::size_t>(dir)];
+        mapMsgAppCount.clear();
+        for (std::size_t i = 0; i < vRecords.size(); i++)
+        {
+            if (vRecords[i].m_nCount > 0)
+            {
+                mapMsgAppCount[static_cast<MsgApp::TMsgId>(i)] = vRecords[i].m_nCount;
+            }
+        }
+        return mapMsgAppCount;
+    }
+
+    /**
+        Builds a map of app message counts per send lane, containing only the lanes having non-zero count.
+        Since the map is rebuilt on each call, this should not be invoked frequently.
+
+        @param dir Direction.
+
+        @return Map of app message counts per send lane in the given direction, valid until the next call with the same direction.
+    */
+    const std::map<PgeSendLane, uint32_t>& PgeNetworkStats::getLaneMsgCountMap(const Direction& dir) const
+    {
+        std::map<PgeSendLane, uint32_t>& mapLaneMsgCount = m_mapLaneMsgCount[static_cast<std::size_t>(dir)];
+        mapLaneMsgCount.clear();
+        for (std::size_t iLane = 0; iLane < nSendLaneCount; iLane++)
+        {
+            const uint32_t nCount = m_nLaneMsgCount[static_cast<std::size_t>(dir)][iLane];
+            if (nCount > 0)
+            {
+                mapLaneMsgCount[static_cast<PgeSendLane>(iLane)] = nCount;
+            }
+        }
+        return mapLaneMsgCount;
+    }
+
+    /**
+        Exports all non-empty app message and connection records as CSV, 1 record per line, with a header line.
+        Columns: direction, scope ("msg" or "conn"), id (app message id or connection handle), name (app message name or empty),
+        count, bytes, count_per_sec, bytes_per_sec, size histogram buckets, inter-arrival histogram buckets.
+
+        @param mapMsgAppId2String Names of app messages by id.
+        @param timeNow            Current time, for per-second rates.
+
+        @return The CSV text.
+    */
+    std::string PgeNetworkStats::exportCsv(
+        const std::map<MsgApp::TMsgId, std::string>& mapMsgAppId2String,
+        const TimePoint& timeNow) const
+    {
+        std::stringstream ss;
+        ss << "direction,scope,id,name,count,bytes,count_per_sec,bytes_per_sec";
+        for (std::size_t i = 0; i < nSizeHistogramBucketCount; i++)
+        {
+            ss << ",size_hist_" << i;
+        }
+        for (std::size_t i = 0; i < nInterArrivalHistogramBucketCount; i++)
+        {
+            ss << ",interarrival_us_hist_" << i;
+        }
+        ss << "\n";
+
+        for (std::size_t iDir = 0; iDir < nDirectionCount; iDir++)
+        {
+            const char* const szDirection = getDirectionString(static_cast<Direction>(iDir));
+            for (std::size_t iSlot = 0; iSlot < m_vMsgAppRecords[iDir].size(); iSlot++)
+            {
+                const Record& record = m_vMsgAppRecords[iDir][iSlot];
+                if (record.m_nCount > 0)
+                {
+                    const MsgApp::TMsgId msgAppId = static_cast<MsgApp::TMsgId>(iSlot);
+                    writeCsvRecord(ss, szDirection, "msg", msgAppId, getMsgAppName(mapMsgAppId2String, msgAppId), record, timeNow);
+                }
+            }
+            for (const auto& connRecords : m_vConnectionRecords)
+            {
+                const Record& record = connRecords.m_records[iDir];
+                if (record.m_nCount > 0)
+                {
+                    writeCsvRecord(ss, szDirection, "conn", connRecords.m_connHandle, "", record, timeNow);
+                }
+            }
+        }
+
+        return ss.str();
+    }
+
+    /**
+        Exports all non-empty app message and connection records as a JSON object having 2 arrays: "msg" and "conn".
+        Each array element has the same fields as the CSV columns of exportCsv(), with histograms being arrays.
+
+        @param mapMsgAppId2String Names of app messages by id.
+        @param timeNow            Current time, for per-second rates.
+
+        @return The JSON text.
+    */
+    std::string PgeNetworkStats::exportJson(
+        const std::map<MsgApp::TMsgId, std::string>& mapMsgAppId2String,
+        const TimePoint& timeNow) const
+    {
+        std::stringstream ss;
+        bool bFirst = true;
+
+        ss << "{\"msg\":[";
+        for (std::size_t iDir = 0; iDir < nDirectionCount; iDir++)
+        {
+            for (std::size_t iSlot = 0; iSlot < m_vMsgAppRecords[iDir].size(); iSlot++)
+            {
+                const Record& record = m_vMsgAppRecords[iDir][iSlot];
+                if (record.m_nCount > 0)
+                {
+                    const MsgApp::TMsgId msgAppId = static_cast<MsgApp::TMsgId>(iSlot);
+                    const std::string sName = getMsgAppName(mapMsgAppId2String, msgAppId);
+                    ss << (bFirst ? "" : ",");
+                    writeJsonRecord(ss, getDirectionString(static_cast<Direction>(iDir)), msgAppId, &sName, record, timeNow);
+                    bFirst = false;
+                }
+            }
+        }
+
+        bFirst = true;
+        ss << "],\"conn\":[";
+        for (std::size_t iDir = 0; iDir < nDirectionCount; iDir++)
+        {
+            for (const auto& connRecords : m_vConnectionRecords)
+            {
+                const Record& record = connRecords.m_records[iDir];
+                if (record.m_nCount > 0)
+                {
+                    ss << (bFirst ? "" : ",");
+                    writeJsonRecord(ss, getDirectionString(static_cast<Direction>(iDir)), connRecords.m_connHandle, nullptr, record, timeNow);
+                    bFirst = false;
+                }
+            }
+        }
+        ss << "]}";
+
+        return ss.str();
+    }
+
+    PgeNetworkStats::ConnectionRecords* PgeNetworkStats::findConnectionRecords(const PgeNetworkConnectionHandle& connHandle)
+    {
+        for (auto& connRecords : m_vConnectionRecords)
+        {
+            if (connRecords.m_connHandle == connHandle)
+            {
+                return &connRecords;
+            }
+        }
+        return nullptr;
+    }
+
+    const PgeNetworkStats::ConnectionRecords* PgeNetworkStats::findConnectionRecords(const PgeNetworkConnectionHandle& connHandle) const
+    {
+        for (const auto& connRecords : m_vConnectionRecords)
+        {
+            if (connRecords.m_connHandle == connHandle)
+            {
+                return &connRecords;
+            }
+        }
+        return nullptr;
+    }
+
+    /*
+       PgeHandoffStats
+       ###########################################################################
+    */
+
+    PgeHandoffStats::Latency::Latency() :
+        m_nCount(0),
+        m_nSumUSecs(0),
+        m_nMaxUSecs(0)
+    {
+        m_nHistogram.fill(0);
+    }
+
+    /**
+        @param nUSecs The latency to be recorded, negative values are recorded as 0.
+    */
+    void PgeHandoffStats::Latency::add(const int64_t& nUSecs)
+    {
+        const uint64_t nUSecsClamped = (nUSecs > 0) ? static_cast<uint64_t>(nUSecs) : 0;
+        m_nCount++;
+        m_nSumUSecs += nUSecsClamped;
+        m_nMaxUSecs = std::max(m_nMaxUSecs, nUSecsClamped);
+        ++m_nHistogram[PgeNetworkStats::getHistogramBucketIndex(nUSecsClamped, nLatencyHistogramBucketCount)];
+    }
+
+    uint64_t PgeHandoffStats::Latency::getAvgUSecs() const
+    {
+        return (m_nCount == 0) ? 0 : (m_nSumUSecs / m_nCount);
+    }
+
+    PgeHandoffStats::PgeHandoffStats() :
+        m_bIoThread(false),
+        m_nRxQueueHighWaterMark(0),
+        m_nRxQueueFullCount(0),
+        m_nTxQueueHighWaterMark(0),
+        m_nTxQueueFullCount(0),
+        m_nTxCmdDroppedCount(0)
+    {
+    }
+
+} // namespace pge_network
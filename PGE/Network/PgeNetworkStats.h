@@ -0,0 +1,200 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeNetworkStats.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine network traffic statistics
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <array>
+#include <chrono>  // requires cpp11
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "PgePacket.h"
+
+namespace pge_network
+{
+
+    /**
+        Network traffic statistics per app message id and per connection.
+
+        Per app message id records are stored in a dense array indexed by the id itself, preallocated in the constructor,
+        so recording an app message is just an indexing and some increments, without any lookup or allocation.
+        App message ids not less than nMsgAppIdSlotCount - 1 are all recorded into the last slot.
+        Per connection records are stored in a small array with linear search, since there are only a few connections at a
+        time, and a connection is looked up once per packet, not once per app message. Memory is allocated only when a new
+        connection is recorded.
+
+        Each record stores count, bytes, approximate per-second rates, and log2-bucketed size and inter-arrival time histograms.
+        Histogram bucket 0 holds value 0, bucket i > 0 holds values in range [2^(i-1), 2^i), the last bucket also holds all
+        values above its range. Inter-arrival times are measured in microseconds.
+
+        The whole object is copyable, so a snapshot can be taken by simply copying it, e.g. for exporting from another thread later.
+        Not thread-safe.
+    */
+    class PgeNetworkStats
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeNetworkStats is included")
+#endif
+
+    public:
+
+        typedef std::chrono::time_point<std::chrono::steady_clock> TimePoint;
+
+        enum class Direction : uint8_t
+        {
+            Rx = 0,
+            Tx,
+            Inject
+        };
+
+        static constexpr std::size_t nDirectionCount = static_cast<std::size_t>(Direction::Inject) + 1;
+        static constexpr std::size_t nMsgAppIdSlotCount = 256;                  /**< Number of per app message id records. */
+        static constexpr std::size_t nSizeHistogramBucketCount = 16;            /**< Last bucket starts at 16 KiB. */
+        static constexpr std::size_t nInterArrivalHistogramBucketCount = 24;    /**< Last bucket starts at ~4.2 seconds. */
+
+        /**
+            Statistics of a single app message id or a single connection in a single direction.
+        */
+        struct Record
+        {
+            uint32_t m_nCount;
+            uint64_t m_nBytes;
+            TimePoint m_time1st;
+            TimePoint m_timeLast;
+            std::array<uint32_t, nSizeHistogramBucketCount> m_nSizeHistogram;                  /**< Size in bytes. */
+            std::array<uint32_t, nInterArrivalHistogramBucketCount> m_nInterArrivalHistogram;  /**< Time since previous in microseconds. */
+
+            TimePoint m_timeRateWindowStart;
+            uint32_t m_nRateWindowCount;
+            uint64_t m_nRateWindowBytes;
+            uint32_t m_nRateLastWindowCount;
+            uint64_t m_nRateLastWindowBytes;
+
+            Record();
+
+            void add(const uint32_t& nBytes, const TimePoint& time);
+            uint32_t getCountPerSecond(const TimePoint& timeNow) const;
+            uint64_t getBytesPerSecond(const TimePoint& timeNow) const;
+        }; // struct Record
+
+        static std::size_t getHistogramBucketIndex(const uint64_t& nValue, const std::size_t& nBucketCount);
+        static const char* getDirectionString(const Direction& dir);
+
+        // ---------------------------------------------------------------------------
+
+        PgeNetworkStats();
+        ~PgeNetworkStats() = default;
+
+        PgeNetworkStats(const PgeNetworkStats&) = default;
+        PgeNetworkStats& operator=(const PgeNetworkStats&) = default;
+        PgeNetworkStats(PgeNetworkStats&&) = default;
+        PgeNetworkStats& operator=(PgeNetworkStats&&) = default;
+
+        void addMsgApp(
+            const Direction& dir,
+            const MsgApp::TMsgId& msgAppId,
+            const uint32_t& nBytes,
+            const PgeSendLane& lane,
+            const TimePoint& time);
+        void addPkt(
+            const Direction& dir,
+            const PgeNetworkConnectionHandle& connHandle,
+            const uint32_t& nBytes,
+            const TimePoint& time);
+        void removeConnection(const PgeNetworkConnectionHandle& connHandle);
+        void clear();
+
+        const Record& getMsgAppRecord(const Direction& dir, const MsgApp::TMsgId& msgAppId) const;
+        const Record* getConnectionRecord(const Direction& dir, const PgeNetworkConnectionHandle& connHandle) const;
+        std::vector<PgeNetworkConnectionHandle> getConnectionHandles() const;
+        uint32_t getLaneMsgCount(const Direction& dir, const PgeSendLane& lane) const;
+
+        const std::map<MsgApp::TMsgId, uint32_t>& getMsgAppCountMap(const Direction& dir) const;
+        const std::map<PgeSendLane, uint32_t>& getLaneMsgCountMap(const Direction& dir) const;
+
+        std::string exportCsv(
+            const std::map<MsgApp::TMsgId, std::string>& mapMsgAppId2String,
+            const TimePoint& timeNow = std::chrono::steady_clock::now()) const;
+        std::string exportJson(
+            const std::map<MsgApp::TMsgId, std::string>& mapMsgAppId2String,
+            const TimePoint& timeNow = std::chrono::steady_clock::now()) const;
+
+    private:
+
+        /**
+            All records of a single connection, indexed by Direction.
+        */
+        struct ConnectionRecords
+        {
+            PgeNetworkConnectionHandle m_connHandle;
+            std::array<Record, nDirectionCount> m_records;
+        };
+
+        std::array<std::vector<Record>, nDirectionCount> m_vMsgAppRecords;  /**< Indexed by Direction, then by app message id. */
+        std::vector<ConnectionRecords> m_vConnectionRecords;
+        std::array<std::array<uint32_t, nSendLaneCount>, nDirectionCount> m_nLaneMsgCount;  /**< Indexed by Direction, then by PgeSendLane. */
+
+        // only for getMsgAppCountMap() and getLaneMsgCountMap(), rebuilt on each call
+        mutable std::array<std::map<MsgApp::TMsgId, uint32_t>, nDirectionCount> m_mapMsgAppCount;
+        mutable std::array<std::map<PgeSendLane, uint32_t>, nDirectionCount> m_mapLaneMsgCount;
+
+        ConnectionRecords* findConnectionRecords(const PgeNetworkConnectionHandle& connHandle);
+        const ConnectionRecords* findConnectionRecords(const PgeNetworkConnectionHandle& connHandle) const;
+
+    }; // class PgeNetworkStats
+
+    /**
+        Statistics of handing over received packets to the application, see PgeIServerClient::getHandoffStats().
+
+        Rx latency is measured from the moment the underlying network layer received a packet until the packet is stored in the
+        packet queue from where the application takes it, i.e. how long a received packet waits for being polled.
+        Handoff latency is measured only when the network I/O thread is used: from the moment the I/O thread has put a received or
+        injected packet into the handoff queue until the application thread has moved it to the packet queue.
+        Latency histograms use the same log2 buckets as PgeNetworkStats, in microseconds.
+
+        Handoff queue counters are valid only when the network I/O thread is used.
+    */
+    struct PgeHandoffStats
+    {
+        static constexpr std::size_t nLatencyHistogramBucketCount = 24;  /**< Last bucket starts at ~4.2 seconds. */
+
+        /**
+            Latency statistics of a single handoff stage.
+        */
+        struct Latency
+        {
+            uint32_t m_nCount;
+            uint64_t m_nSumUSecs;
+            uint64_t m_nMaxUSecs;
+            std::array<uint32_t, nLatencyHistogramBucketCount> m_nHistogram;
+
+            Latency();
+
+            void add(const int64_t& nUSecs);
+            uint64_t getAvgUSecs() const;
+        }; // struct Latency
+
+        bool m_bIoThread;                      /**< True if the network I/O thread is running. */
+        Latency m_rxLatency;
+        Latency m_handoffLatency;
+        std::size_t m_nRxQueueHighWaterMark;   /**< Max number of packets waiting in the rx handoff queue at the same time. */
+        uint32_t m_nRxQueueFullCount;          /**< Number of times the I/O thread found the rx handoff queue full, packets are not dropped then, they wait. */
+        std::size_t m_nTxQueueHighWaterMark;   /**< Max number of commands waiting in the tx handoff queue at the same time. */
+        uint32_t m_nTxQueueFullCount;          /**< Number of times the application thread had to wait for room in the tx handoff queue. */
+        uint32_t m_nTxCmdDroppedCount;         /**< Number of sends dropped since the tx handoff queue stayed full for too long. */
+
+        PgeHandoffStats();
+    }; // struct PgeHandoffStats
+
+} // namespace pge_network
@@ -163,6 +163,39 @@ namespace pge_network {
         return pge_network::MsgApp::getMsgAppMsgId(*pge_network::PgePacket::getMsgAppFromPkt(pkt));
     }
 
+    const pge_network::MsgApp* PgePacket::getNextMsgAppFromPkt(const pge_network::PgePacket& pkt, const pge_network::MsgApp& msgApp)
+    {
+        // We need to step in bytes since the actual size of a MsgApp is not sizeof(MsgApp).
+        const pge_network::TByte* const pNextMsgAppInByteSteps =
+            reinterpret_cast<const pge_network::TByte*>(&msgApp) + pge_network::MsgApp::getMsgAppTotalActualSizeBytes(msgApp);
+        const pge_network::TByte* const pMsgAppAreaEnd =
+            getMessageAppArea(pkt).m_cData + getMessageAppArea(pkt).m_nActualMessagesAreaLength;
+        
+        if (pNextMsgAppInByteSteps >= pMsgAppAreaEnd)
+        {
+            // the given msgApp was the last one in pkt
+            return nullptr;
+        }
+
+        return reinterpret_cast<const pge_network::MsgApp*>(pNextMsgAppInByteSteps);
+    }
+
+    uint32_t PgePacket::getPktActualSizeBytes(const pge_network::PgePacket& pkt)
+    {
+        if (pge_network::PgePacket::getPacketId(pkt) != MsgApp::id)
+        {
+            return static_cast<uint32_t>(sizeof(pkt));
+        }
+
+        // We need the real used memory size so we can truncate the sent pkt to that.
+        // m_nActualMessagesAreaLength already considers the actual sizes of all the stored app messages, and
+        // 'cData' is our point of view since from there we need to calculate.
+        return static_cast<uint32_t>(
+            offsetof(pge_network::PgePacket, m_msg.m_app) +
+            offsetof(pge_network::MsgAppArea, m_cData) +
+            getMessageAppArea(pkt).m_nActualMessagesAreaLength);
+    }
+
     void pge_network::PgePacket::initPktPgeMsgUserDisconnected(
         PgePacket& pkt,
         const PgeNetworkConnectionHandle& connHandleServerSide)
@@ -249,10 +282,7 @@ namespace pge_network {
             return false;
         }
 
-        // TODO: find location for next app msg (separate function)
-        // TODO: store the given app msg at the proper location
-
-        memcpy(pge_network::PgePacket::getMessageAppArea(pkt).m_cData, &msgApp, nActualTotalAppMsgSize);
+        memcpy(pge_network::PgePacket::getMsgAppFreeAreaFromPkt(pkt), &msgApp, nActualTotalAppMsgSize);
         pge_network::PgePacket::getMessageAppArea(pkt).m_nMessageCount++;
         pge_network::PgePacket::getMessageAppArea(pkt).m_nActualMessagesAreaLength += static_cast<MsgAppArea::TAreaLength>(nActualTotalAppMsgSize);
 
@@ -298,19 +328,25 @@ namespace pge_network {
             return nullptr;
         }
 
-        pge_network::PgePacket::getMessageAppArea(pkt).m_nMessageCount = 1; // TODO: increase
+        // need to get the free area before increasing the actual length of the messages area
+        pge_network::MsgApp* const pMsgApp = pge_network::PgePacket::getMsgAppFreeAreaFromPkt(pkt);
+        
+        pge_network::PgePacket::getMessageAppArea(pkt).m_nMessageCount++;
         pge_network::PgePacket::getMessageAppArea(pkt).m_nActualMessagesAreaLength += static_cast<MsgAppArea::TAreaLength>(nActualTotalAppMsgSize);
 
-        // TODO: find location for next app msg (separate function)
-        // TODO: store the given app msg at the proper location
-
-        pge_network::MsgApp* pMsgApp = reinterpret_cast<pge_network::MsgApp*>(pge_network::PgePacket::getMessageAppArea(pkt).m_cData);
         pge_network::MsgApp::getMsgAppMsgId(*pMsgApp) = static_cast<pge_network::MsgApp::TMsgId>(msgAppId);
         pge_network::MsgApp::getMsgAppDataActualSizeBytes(*pMsgApp) = nMsgAppDataSize;
 
         return pge_network::MsgApp::getMsgAppData(*pMsgApp);
     }
 
+    pge_network::MsgApp* PgePacket::getMsgAppFreeAreaFromPkt(pge_network::PgePacket& pkt)
+    {
+        // app messages are stored continuously, so the free area starts right after the actual length of the messages area
+        return reinterpret_cast<pge_network::MsgApp*>(
+            pge_network::PgePacket::getMessageAppArea(pkt).m_cData + pge_network::PgePacket::getMessageAppArea(pkt).m_nActualMessagesAreaLength);
+    }
+
     const MsgApp::TMsgId& MsgApp::getMsgAppMsgId(const MsgApp& msgApp)
     {
         return msgApp.m_msgId;
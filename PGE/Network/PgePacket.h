@@ -65,6 +65,20 @@ namespace pge_network
         Application
     };
 
+    // Send semantics of application messages, can be configured per MsgApp::TMsgId using PgeIServerClient::getMsgAppId2SendLaneMap().
+    // App messages without configured lane are sent on the Reliable lane.
+    // Non-application messages are always sent on the Reliable lane.
+    // Order of messages is kept only within the same lane, and in case of unreliable lanes messages might be lost or arrive out of order.
+    enum class PgeSendLane : uint8_t
+    {
+        Reliable = 0,       // reliable and ordered, small messages might be delayed a bit by Nagle's algorithm to be sent together
+        ReliableNoNagle,    // reliable and ordered, sent out without waiting for more messages, useful for latency-sensitive events
+        Unreliable,         // might be lost, useful for high-rate state updates where only the latest one matters
+        UnreliableNoDelay   // might be lost, also dropped if it cannot be sent out immediately, e.g. because of full send buffer
+    };
+
+    constexpr uint8_t nSendLaneCount = static_cast<uint8_t>(PgeSendLane::UnreliableNoDelay) + 1;
+
     // server -> self (injection)
     // PgeServer injects this message to the incoming packet queue so application level will receive it.
     // Server app will receive this message immediately after starting listening.
@@ -128,7 +142,7 @@ namespace pge_network
         friend struct PgePacket;     // PgePacket should have full r/w access since basically this is part of it
 
     public:
-        typedef uint32_t TMsgId;   // TODO: could be decreased to uint16_t
+        typedef uint16_t TMsgId;   // together with TMsgSize, the header of each app message is 3 bytes
         typedef uint8_t  TMsgSize;
 
         static const PgePktId id = PgePktId::Application;
@@ -242,6 +256,28 @@ namespace pge_network
 
         static const pge_network::MsgApp::TMsgId& getMsgAppIdFromPkt(const pge_network::PgePacket& pkt);
 
+        /**
+        * Returns the app message stored right after the given app message in the given packet.
+        * Useful for iterating over all app messages of a packet carrying multiple app messages, starting with getMsgAppFromPkt().
+        * 
+        * @param pkt    The packet storing the given msgApp.
+        * @param msgApp An app message stored in the given packet.
+        * 
+        * @return Pointer to the next app message within the given packet, or nullptr if the given msgApp is the last one.
+        */
+        static const pge_network::MsgApp* getNextMsgAppFromPkt(const pge_network::PgePacket& pkt, const pge_network::MsgApp& msgApp);
+
+        /**
+        * Returns the number of bytes actually used in the given packet.
+        * In case of app messages, this is less than sizeof(PgePacket) since only the actually used memory area of the
+        * app messages is counted, this is how many bytes we need to send over the network.
+        * 
+        * @param pkt The packet we are interested in.
+        * 
+        * @return Actually used memory area of the given packet in bytes.
+        */
+        static uint32_t getPktActualSizeBytes(const pge_network::PgePacket& pkt);
+
         /**
         * This convenient function is for the application: the custom application-defined message can
         * be easily extracted from the packet.
@@ -324,7 +360,7 @@ namespace pge_network
             const AutoFill& autoFill = AutoFill::ZERO);
 
         /*
-        * Copies the given msgApp into the given pkt.
+        * Copies the given msgApp into the given pkt, right after the app messages already stored in the packet.
         * Due to copying the given msgApp, from performance perspective try to avoid using this function and prefer preparePktMsgAppFill()!
         * Note that not the full MsgApp is copied, only the actually used memory area of the struct.
         * 
@@ -342,6 +378,8 @@ namespace pge_network
         * It checks if there is enough space available in the given packet for the app message data we are planning to write, and if so,
         * it sets the given app message id and app message data size at the proper location within the packet and returns a pointer pointing
         * to that memory area within the packet that can be directly written by the application to store the actual app message data.
+        * The proper location is right after the app messages already stored in the packet, so multiple app messages can be stored in
+        * the same packet by invoking this function multiple times.
         * 
         * From performance perspective using this function is preferred over addPktMsgApp() because in practice it results in less memory
         * copy operations since the caller can directly write its data instead of copying a MsgApp struct.
@@ -378,6 +416,8 @@ namespace pge_network
         static uint8_t& getMessageAppCount(pge_network::PgePacket& pkt);
         static MsgAppArea::TAreaLength& getMessageAppsTotalActualLengthBytes(pge_network::PgePacket& pkt);
 
+        static pge_network::MsgApp* getMsgAppFreeAreaFromPkt(pge_network::PgePacket& pkt);
+
         // private initializers 
 
         static void initPktBasic(
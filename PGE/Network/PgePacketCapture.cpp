@@ -0,0 +1,450 @@
+/*
+    ###################################################################################
+    PgePacketCapture.cpp
+    This file is part of PGE.
+    PR00F's Game Engine packet capture file writer and reader
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgePacketCapture.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace pge_network {
+
+    /**
+        Creates a closed writer, open() must be called before recording.
+    */
+    PgePacketCaptureWriter::PgePacketCaptureWriter() :
+        m_flushInterval(std::chrono::milliseconds(nDefaultFlushIntervalMillisecs)),
+        m_nFrontBufferSize(0),
+        m_nBackBufferSize(0),
+        m_bBackBufferPending(false),
+        m_bStopRequested(false),
+        m_bWriteFailed(false),
+        m_nWrittenByteCount(0),
+        m_nRecordCount(0),
+        m_nStallCount(0)
+    {
+    }
+
+    PgePacketCaptureWriter::~PgePacketCaptureWriter()
+    {
+        close();
+    }
+
+    /**
+        Creates the given capture file, writes the file header, allocates the buffers and starts the background flush thread.
+        Counters are reset.
+
+        @param sFilename               Name of the capture file to be created, overwritten if already exists.
+        @param nBufferSize             Size of each of the 2 buffers in bytes, must be able to store at least 1 record of any size.
+        @param nFlushIntervalMillisecs Records are handed over to the background thread at least this often, even if buffer is not full.
+
+        @return True on success, false if already open, buffer size is too small, or file cannot be created.
+    */
+    bool PgePacketCaptureWriter::open(
+        const std::string& sFilename,
+        const std::size_t& nBufferSize,
+        const uint32_t& nFlushIntervalMillisecs)
+    {
+        if (isOpen())
+        {
+            CConsole::getConsoleInstance("PgePacketCapture").EOLn("%s: already open: %s!", __func__, m_sFilename.c_str());
+            return false;
+        }
+
+        if (nBufferSize < (sizeof(PgePacketCaptureFormat::RecordHeader) + sizeof(PgePacket)))
+        {
+            CConsole::getConsoleInstance("PgePacketCapture").EOLn("%s: buffer size %u is too small!", __func__, nBufferSize);
+            return false;
+        }
+
+        m_file.open(sFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!m_file.is_open())
+        {
+            CConsole::getConsoleInstance("PgePacketCapture").EOLn("%s: failed to create file: %s!", __func__, sFilename.c_str());
+            return false;
+        }
+
+        PgePacketCaptureFormat::FileHeader header;
+        memcpy(header.m_cMagic, PgePacketCaptureFormat::szMagic, sizeof(header.m_cMagic));
+        header.m_nVersion = PgePacketCaptureFormat::nVersion;
+        header.m_nHeaderSize = static_cast<uint16_t>(sizeof(header));
+        header.m_nMaxPktSize = static_cast<uint32_t>(sizeof(PgePacket));
+        header.m_nReserved = 0;
+        m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (!m_file.good())
+        {
+            CConsole::getConsoleInstance("PgePacketCapture").EOLn("%s: failed to write file: %s!", __func__, sFilename.c_str());
+            m_file.close();
+            return false;
+        }
+
+        m_sFilename = sFilename;
+        m_flushInterval = std::chrono::milliseconds(nFlushIntervalMillisecs);
+        m_vFrontBuffer.resize(nBufferSize);
+        m_vBackBuffer.resize(nBufferSize);
+        m_nFrontBufferSize = 0;
+        m_nBackBufferSize = 0;
+        m_bBackBufferPending = false;
+        m_bStopRequested = false;
+        m_bWriteFailed = false;
+        m_nWrittenByteCount = sizeof(header);
+        m_nRecordCount = 0;
+        m_nStallCount = 0;
+
+        m_timeStart = std::chrono::steady_clock::now();
+        m_timeLastHandover = m_timeStart;
+        m_thread = std::thread(&PgePacketCaptureWriter::runFlushThread, this);
+
+        CConsole::getConsoleInstance("PgePacketCapture").OLn("%s: capturing packets to: %s", __func__, m_sFilename.c_str());
+        return true;
+    }
+
+    /**
+        Writes all recorded packets to the file, stops the background flush thread, closes the file and frees the buffers.
+        Does nothing if not open.
+    */
+    void PgePacketCaptureWriter::close()
+    {
+        if (!isOpen())
+        {
+            return;
+        }
+
+        handOverFrontBuffer(std::chrono::steady_clock::now());
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bStopRequested = true;
+        }
+        m_cv.notify_all();
+        m_thread.join();
+        m_file.close();
+
+        std::vector<uint8_t>().swap(m_vFrontBuffer);
+        std::vector<uint8_t>().swap(m_vBackBuffer);
+
+        CConsole::getConsoleInstance("PgePacketCapture").OLn("%s: captured %u packets, %u bytes, %u stalls to: %s",
+            __func__,
+            static_cast<uint32_t>(m_nRecordCount),
+            static_cast<uint32_t>(getWrittenByteCount()),
+            m_nStallCount,
+            m_sFilename.c_str());
+    }
+
+    bool PgePacketCaptureWriter::isOpen() const
+    {
+        return m_thread.joinable();
+    }
+
+    const std::string& PgePacketCaptureWriter::getFilename() const
+    {
+        return m_sFilename;
+    }
+
+    /**
+        Appends the given packet as a new record to the front buffer.
+        The front buffer is handed over to the background flush thread before appending if the record doesn't fit, or after
+        appending if the flush interval has elapsed since the last handover.
+        Does nothing if not open.
+
+        @param dir            Direction of the packet.
+        @param connHandle     The connection the packet was sent to or received from.
+        @param pkt            The packet to be recorded.
+        @param nActualPktSize The actually used memory area of the packet in bytes, this many bytes are recorded.
+        @param time           Time of sending, receiving or injecting the packet.
+    */
+    void PgePacketCaptureWriter::record(
+        const PgeNetworkStats::Direction& dir,
+        const PgeNetworkConnectionHandle& connHandle,
+        const PgePacket& pkt,
+        const uint32_t& nActualPktSize,
+        const PgeNetworkStats::TimePoint& time)
+    {
+        if (!isOpen())
+        {
+            return;
+        }
+
+        assert(nActualPktSize <= sizeof(PgePacket));
+        const std::size_t nRecordSize = sizeof(PgePacketCaptureFormat::RecordHeader) + nActualPktSize;
+        if (m_nFrontBufferSize + nRecordSize > m_vFrontBuffer.size())
+        {
+            handOverFrontBuffer(time);
+        }
+
+        PgePacketCaptureFormat::RecordHeader recHeader;
+        recHeader.m_nTimeUSecs = (time > m_timeStart) ?
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(time - m_timeStart).count()) :
+            0;
+        recHeader.m_connHandle = connHandle;
+        recHeader.m_nDirection = static_cast<uint8_t>(dir);
+        recHeader.m_nReserved = 0;
+        recHeader.m_nPktSize = static_cast<uint16_t>(nActualPktSize);
+
+        uint8_t* const pDst = m_vFrontBuffer.data() + m_nFrontBufferSize;
+        memcpy(pDst, &recHeader, sizeof(recHeader));
+        memcpy(pDst + sizeof(recHeader), &pkt, nActualPktSize);
+        m_nFrontBufferSize += nRecordSize;
+        m_nRecordCount++;
+
+        if (time - m_timeLastHandover >= m_flushInterval)
+        {
+            handOverFrontBuffer(time);
+        }
+    }
+
+    uint64_t PgePacketCaptureWriter::getRecordCount() const
+    {
+        return m_nRecordCount;
+    }
+
+    /**
+        @return Number of bytes written to the file so far, including the file header.
+                Records still in the buffers are not included.
+    */
+    uint64_t PgePacketCaptureWriter::getWrittenByteCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_nWrittenByteCount;
+    }
+
+    /**
+        @return Number of times recording had to wait for the background thread to finish writing the previous buffer.
+    */
+    uint32_t PgePacketCaptureWriter::getStallCount() const
+    {
+        return m_nStallCount;
+    }
+
+    bool PgePacketCaptureWriter::hasWriteFailed() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_bWriteFailed;
+    }
+
+    /**
+        Swaps the front and back buffers so the background thread writes the recorded packets to the file.
+        Waits if the background thread is still writing the previous back buffer.
+        Does nothing if the front buffer is empty.
+
+        @param time The current time, used for measuring the flush interval.
+    */
+    void PgePacketCaptureWriter::handOverFrontBuffer(const PgeNetworkStats::TimePoint& time)
+    {
+        m_timeLastHandover = time;
+        if (m_nFrontBufferSize == 0)
+        {
+            return;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_bBackBufferPending)
+            {
+                m_nStallCount++;
+                m_cv.wait(lock, [this] { return !m_bBackBufferPending; });
+            }
+            m_vFrontBuffer.swap(m_vBackBuffer);
+            m_nBackBufferSize = m_nFrontBufferSize;
+            m_bBackBufferPending = true;
+        }
+        m_cv.notify_all();
+        m_nFrontBufferSize = 0;
+    }
+
+    /**
+        Body of the background flush thread: writes the back buffer to the file whenever it is handed over, until stop is
+        requested and there is nothing left to write.
+    */
+    void PgePacketCaptureWriter::runFlushThread()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            m_cv.wait(lock, [this] { return m_bBackBufferPending || m_bStopRequested; });
+            if (!m_bBackBufferPending)
+            {
+                break;
+            }
+
+            // back buffer is not touched by the recording thread while pending, so we can write it without holding the lock
+            const std::size_t nSize = m_nBackBufferSize;
+            lock.unlock();
+            m_file.write(reinterpret_cast<const char*>(m_vBackBuffer.data()), nSize);
+            m_file.flush();
+            const bool bGood = m_file.good();
+            lock.lock();
+
+            m_nWrittenByteCount += bGood ? nSize : 0;
+            m_bWriteFailed = m_bWriteFailed || !bGood;
+            m_bBackBufferPending = false;
+            m_cv.notify_all();
+        }
+    }
+
+
+    /**
+        Creates a closed reader, open() must be called before reading.
+    */
+    PgePacketCaptureReader::PgePacketCaptureReader() :
+        m_nFirstRecordPos(0),
+        m_nPos(0),
+        m_bOpen(false),
+        m_bCorrupt(false),
+        m_nReadRecordCount(0)
+    {
+    }
+
+    /**
+        Loads the whole given capture file into memory and validates its file header.
+        The previously opened file, if any, is closed first.
+
+        @param sFilename Name of the capture file.
+
+        @return True on success, false if file cannot be read, or it is not a capture file, or its version is different.
+    */
+    bool PgePacketCaptureReader::open(const std::string& sFilename)
+    {
+        close();
+
+        std::ifstream f(sFilename, std::ios::in | std::ios::binary | std::ios::ate);
+        if (!f.is_open())
+        {
+            CConsole::getConsoleInstance("PgePacketCapture").EOLn("%s: failed to open file: %s!", __func__, sFilename.c_str());
+            return false;
+        }
+
+        const std::streamoff nFileSize = f.tellg();
+        if (nFileSize < static_cast<std::streamoff>(sizeof(PgePacketCaptureFormat::FileHeader)))
+        {
+            CConsole::getConsoleInstance("PgePacketCapture").EOLn("%s: file is too small: %s!", __func__, sFilename.c_str());
+            return false;
+        }
+
+        m_vData.resize(static_cast<std::size_t>(nFileSize));
+        f.seekg(0);
+        f.read(reinterpret_cast<char*>(m_vData.data()), nFileSize);
+        if (!f.good())
+        {
+            CConsole::getConsoleInstance("PgePacketCapture").EOLn("%s: failed to read file: %s!", __func__, sFilename.c_str());
+            close();
+            return false;
+        }
+
+        PgePacketCaptureFormat::FileHeader header;
+        memcpy(&header, m_vData.data(), sizeof(header));
+        if (memcmp(header.m_cMagic, PgePacketCaptureFormat::szMagic, sizeof(header.m_cMagic)) != 0)
+        {
+            CConsole::getConsoleInstance("PgePacketCapture").EOLn("%s: not a capture file: %s!", __func__, sFilename.c_str());
+            close();
+            return false;
+        }
+
+        if (header.m_nVersion != PgePacketCaptureFormat::nVersion)
+        {
+            CConsole::getConsoleInstance("PgePacketCapture").EOLn("%s: unsupported version %u, expected %u: %s!",
+                __func__, header.m_nVersion, PgePacketCaptureFormat::nVersion, sFilename.c_str());
+            close();
+            return false;
+        }
+
+        if ((header.m_nHeaderSize < sizeof(header)) || (header.m_nHeaderSize > m_vData.size()))
+        {
+            CConsole::getConsoleInstance("PgePacketCapture").EOLn("%s: invalid header size %u: %s!", __func__, header.m_nHeaderSize, sFilename.c_str());
+            close();
+            return false;
+        }
+
+        m_nFirstRecordPos = header.m_nHeaderSize;
+        m_nPos = m_nFirstRecordPos;
+        m_bOpen = true;
+        return true;
+    }
+
+    /**
+        Frees the loaded file content and resets the state.
+    */
+    void PgePacketCaptureReader::close()
+    {
+        std::vector<uint8_t>().swap(m_vData);
+        m_nFirstRecordPos = 0;
+        m_nPos = 0;
+        m_bOpen = false;
+        m_bCorrupt = false;
+        m_nReadRecordCount = 0;
+    }
+
+    bool PgePacketCaptureReader::isOpen() const
+    {
+        return m_bOpen;
+    }
+
+    /**
+        Reads the next record.
+        A truncated or invalid record makes the reader corrupt, no more records are read after it.
+
+        @param rec Where the record is read into, its packet is overwritten only up to the recorded packet size.
+
+        @return True if a record was read, false at the end of the file, or if not open or corrupt.
+    */
+    bool PgePacketCaptureReader::readNext(Record& rec)
+    {
+        if (!m_bOpen || m_bCorrupt || (m_nPos == m_vData.size()))
+        {
+            return false;
+        }
+
+        PgePacketCaptureFormat::RecordHeader recHeader;
+        if (m_vData.size() - m_nPos < sizeof(recHeader))
+        {
+            m_bCorrupt = true;
+            return false;
+        }
+        memcpy(&recHeader, m_vData.data() + m_nPos, sizeof(recHeader));
+
+        if ((recHeader.m_nPktSize > sizeof(PgePacket)) ||
+            (recHeader.m_nPktSize > m_vData.size() - m_nPos - sizeof(recHeader)) ||
+            (recHeader.m_nDirection >= PgeNetworkStats::nDirectionCount))
+        {
+            m_bCorrupt = true;
+            return false;
+        }
+
+        rec.m_nTimeUSecs = recHeader.m_nTimeUSecs;
+        rec.m_connHandle = recHeader.m_connHandle;
+        rec.m_dir = static_cast<PgeNetworkStats::Direction>(recHeader.m_nDirection);
+        rec.m_nPktSize = recHeader.m_nPktSize;
+        memcpy(&(rec.m_pkt), m_vData.data() + m_nPos + sizeof(recHeader), recHeader.m_nPktSize);
+
+        m_nPos += sizeof(recHeader) + recHeader.m_nPktSize;
+        m_nReadRecordCount++;
+        return true;
+    }
+
+    /**
+        Continues reading from the first record.
+    */
+    void PgePacketCaptureReader::rewind()
+    {
+        m_nPos = m_nFirstRecordPos;
+        m_bCorrupt = false;
+        m_nReadRecordCount = 0;
+    }
+
+    bool PgePacketCaptureReader::isCorrupt() const
+    {
+        return m_bCorrupt;
+    }
+
+    uint64_t PgePacketCaptureReader::getReadRecordCount() const
+    {
+        return m_nReadRecordCount;
+    }
+
+} // namespace pge_network
@@ -0,0 +1,203 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgePacketCapture.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine packet capture file writer and reader
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <chrono>  // requires cpp11
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PgeNetworkStats.h"
+#include "PgePacket.h"
+
+namespace pge_network
+{
+
+    /**
+        Layout of a packet capture file.
+
+        A capture file starts with a FileHeader, followed by any number of records.
+        A record is a RecordHeader followed by the actually used memory area of the captured packet, as returned by
+        PgePacket::getPktActualSizeBytes(), so a record is as small as the packet itself on the wire plus 16 bytes.
+        All integers are stored in little-endian byte order.
+
+        The version is increased whenever the layout changes in an incompatible way, readers refuse files of different version.
+        The layout is intentionally simple, so the standalone PgeCaptureDump tool can read it without depending on PGE.
+    */
+    namespace PgePacketCaptureFormat
+    {
+        static constexpr char     szMagic[] = "PGEC";      /**< First 4 bytes of a capture file, without the terminating zero. */
+        static constexpr uint16_t nVersion = 1;
+
+#pragma pack(push, 1)
+        struct FileHeader
+        {
+            char     m_cMagic[4];
+            uint16_t m_nVersion;
+            uint16_t m_nHeaderSize;        /**< sizeof(FileHeader), records start at this offset. */
+            uint32_t m_nMaxPktSize;        /**< sizeof(PgePacket) of the writer, no record is bigger than this. */
+            uint32_t m_nReserved;
+        };
+
+        struct RecordHeader
+        {
+            uint64_t m_nTimeUSecs;         /**< Microseconds elapsed since the capture was started. */
+            uint32_t m_connHandle;         /**< Connection the packet was sent to or received from, same as in PgeNetworkStats. */
+            uint8_t  m_nDirection;         /**< PgeNetworkStats::Direction. */
+            uint8_t  m_nReserved;
+            uint16_t m_nPktSize;           /**< Number of packet bytes following this header. */
+        };
+#pragma pack(pop)
+
+        static_assert(sizeof(FileHeader) == 16, "capture file header layout must not change without increasing nVersion");
+        static_assert(sizeof(RecordHeader) == 16, "capture record header layout must not change without increasing nVersion");
+        static_assert(sizeof(PgePacket) <= UINT16_MAX, "packet size must fit into RecordHeader::m_nPktSize");
+
+    } // namespace PgePacketCaptureFormat
+
+    /**
+        Writes packets into a capture file.
+
+        Records are appended to an in-memory buffer, which is handed over to a background thread for writing to the file when
+        it becomes full or when the flush interval has elapsed since the last handover. The buffers are allocated by open(),
+        so recording a packet is just a copy of at most sizeof(PgePacket) + 16 bytes, without any allocation or file access.
+        If the background thread is still writing the previous buffer when a new handover is needed, recording waits for it,
+        such waits are counted by getStallCount().
+
+        Recording is expected to happen on a single thread.
+    */
+    class PgePacketCaptureWriter
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgePacketCaptureWriter is included")
+#endif
+
+    public:
+
+        static constexpr std::size_t nDefaultBufferSize = 256 * 1024;
+        static constexpr uint32_t nDefaultFlushIntervalMillisecs = 1000;
+
+        PgePacketCaptureWriter();
+        ~PgePacketCaptureWriter();
+
+        PgePacketCaptureWriter(const PgePacketCaptureWriter&) = delete;
+        PgePacketCaptureWriter& operator=(const PgePacketCaptureWriter&) = delete;
+        PgePacketCaptureWriter(PgePacketCaptureWriter&&) = delete;
+        PgePacketCaptureWriter& operator=(PgePacketCaptureWriter&&) = delete;
+
+        bool open(
+            const std::string& sFilename,
+            const std::size_t& nBufferSize = nDefaultBufferSize,
+            const uint32_t& nFlushIntervalMillisecs = nDefaultFlushIntervalMillisecs);
+        void close();
+        bool isOpen() const;
+        const std::string& getFilename() const;
+
+        void record(
+            const PgeNetworkStats::Direction& dir,
+            const PgeNetworkConnectionHandle& connHandle,
+            const PgePacket& pkt,
+            const uint32_t& nActualPktSize,
+            const PgeNetworkStats::TimePoint& time);
+
+        uint64_t getRecordCount() const;
+        uint64_t getWrittenByteCount() const;
+        uint32_t getStallCount() const;
+        bool hasWriteFailed() const;
+
+    private:
+
+        std::string m_sFilename;
+        std::ofstream m_file;                    /**< Accessed only by the background thread while it is running. */
+        std::chrono::microseconds m_flushInterval;
+        PgeNetworkStats::TimePoint m_timeStart;
+        PgeNetworkStats::TimePoint m_timeLastHandover;
+
+        std::vector<uint8_t> m_vFrontBuffer;     /**< Records are appended to this, owned by the recording thread. */
+        std::size_t m_nFrontBufferSize;
+        std::vector<uint8_t> m_vBackBuffer;      /**< Being written to the file by the background thread. */
+        std::size_t m_nBackBufferSize;
+
+        std::thread m_thread;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cv;
+        bool m_bBackBufferPending;               /**< Guarded by m_mutex. */
+        bool m_bStopRequested;                   /**< Guarded by m_mutex. */
+        bool m_bWriteFailed;                     /**< Guarded by m_mutex. */
+        uint64_t m_nWrittenByteCount;            /**< Guarded by m_mutex. */
+
+        uint64_t m_nRecordCount;
+        uint32_t m_nStallCount;
+
+        void handOverFrontBuffer(const PgeNetworkStats::TimePoint& time);
+        void runFlushThread();
+    }; // class PgePacketCaptureWriter
+
+    /**
+        Reads packets from a capture file written by PgePacketCaptureWriter.
+
+        The whole file is loaded into memory by open(), so reading records is just parsing from memory, fast enough for
+        high-speed replay.
+    */
+    class PgePacketCaptureReader
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgePacketCaptureReader is included")
+#endif
+
+    public:
+
+        /**
+            A single captured packet.
+        */
+        struct Record
+        {
+            uint64_t m_nTimeUSecs;
+            PgeNetworkConnectionHandle m_connHandle;
+            PgeNetworkStats::Direction m_dir;
+            uint16_t m_nPktSize;
+            PgePacket m_pkt;               /**< Only the first m_nPktSize bytes are valid, the rest is left from the previous record. */
+        };
+
+        PgePacketCaptureReader();
+        ~PgePacketCaptureReader() = default;
+
+        PgePacketCaptureReader(const PgePacketCaptureReader&) = delete;
+        PgePacketCaptureReader& operator=(const PgePacketCaptureReader&) = delete;
+        PgePacketCaptureReader(PgePacketCaptureReader&&) = delete;
+        PgePacketCaptureReader& operator=(PgePacketCaptureReader&&) = delete;
+
+        bool open(const std::string& sFilename);
+        void close();
+        bool isOpen() const;
+
+        bool readNext(Record& rec);
+        void rewind();
+        bool isCorrupt() const;
+        uint64_t getReadRecordCount() const;
+
+    private:
+
+        std::vector<uint8_t> m_vData;
+        std::size_t m_nFirstRecordPos;
+        std::size_t m_nPos;
+        bool m_bOpen;
+        bool m_bCorrupt;
+        uint64_t m_nReadRecordCount;
+    }; // class PgePacketCaptureReader
+
+} // namespace pge_network
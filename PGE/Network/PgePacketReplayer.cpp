@@ -0,0 +1,195 @@
+/*
+    ###################################################################################
+    PgePacketReplayer.cpp
+    This file is part of PGE.
+    PR00F's Game Engine packet capture replayer
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgePacketReplayer.h"
+
+#include <chrono>  // requires cpp11
+#include <thread>
+
+namespace pge_network {
+
+    /**
+        Creates a replayer replaying received and injected packets.
+    */
+    PgePacketReplayer::PgePacketReplayer() :
+        m_pCompressor(nullptr),
+        m_nReplayedRecordCount(0),
+        m_nReplayedPktCount(0),
+        m_nSkippedRecordCount(0),
+        m_nReplayDurationUSecs(0)
+    {
+        m_bDirectionEnabled.fill(false);
+        setDirectionEnabled(PgeNetworkStats::Direction::Rx, true);
+        setDirectionEnabled(PgeNetworkStats::Direction::Inject, true);
+    }
+
+    void PgePacketReplayer::setDirectionEnabled(const PgeNetworkStats::Direction& dir, bool bEnabled)
+    {
+        m_bDirectionEnabled[static_cast<std::size_t>(dir)] = bEnabled;
+    }
+
+    bool PgePacketReplayer::isDirectionEnabled(const PgeNetworkStats::Direction& dir) const
+    {
+        return m_bDirectionEnabled[static_cast<std::size_t>(dir)];
+    }
+
+    /**
+        @param pCompressor Used for decompressing compressed app messages before replaying them, not owned, nullptr disables decompression.
+    */
+    void PgePacketReplayer::setMsgAppCompressor(PgeMsgAppCompressor* pCompressor)
+    {
+        m_pCompressor = pCompressor;
+    }
+
+    /**
+        Replays the records of the given reader from its current position until the end of the capture.
+        Records of disabled directions are not replayed, neither they are counted as skipped.
+        Counters are reset at the beginning.
+
+        @param reader The reader of an opened capture file.
+        @param cbPkt  Invoked for each replayed packet, with exactly 1 app message in case of app message packets.
+        @param pacing Defines when the packets are replayed. In case of recorded pacing, the first replayed record is replayed
+                      immediately, and the rest relative to it, so idle time at the beginning of the capture is not waited.
+
+        @return True if the end of the capture is reached, false if the reader is corrupt or the callback returned false.
+    */
+    bool PgePacketReplayer::replay(PgePacketCaptureReader& reader, const PktCallback& cbPkt, const Pacing& pacing)
+    {
+        m_nReplayedRecordCount = 0;
+        m_nReplayedPktCount = 0;
+        m_nSkippedRecordCount = 0;
+        m_nReplayDurationUSecs = 0;
+
+        const std::chrono::time_point<std::chrono::steady_clock> timeStart = std::chrono::steady_clock::now();
+        bool bFirstRecord = true;
+        uint64_t nFirstRecordTimeUSecs = 0;
+        bool bSuccess = true;
+
+        PgePacketCaptureReader::Record rec;
+        while (reader.readNext(rec))
+        {
+            if (!isDirectionEnabled(rec.m_dir))
+            {
+                continue;
+            }
+
+            if (pacing == Pacing::Recorded)
+            {
+                if (bFirstRecord)
+                {
+                    nFirstRecordTimeUSecs = rec.m_nTimeUSecs;
+                }
+                else if (rec.m_nTimeUSecs > nFirstRecordTimeUSecs)
+                {
+                    std::this_thread::sleep_until(timeStart + std::chrono::microseconds(rec.m_nTimeUSecs - nFirstRecordTimeUSecs));
+                }
+            }
+            bFirstRecord = false;
+
+            if (!replayRecord(rec, cbPkt))
+            {
+                bSuccess = false;
+                break;
+            }
+        }
+
+        m_nReplayDurationUSecs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - timeStart).count());
+
+        if (reader.isCorrupt())
+        {
+            CConsole::getConsoleInstance("PgePacketReplayer").EOLn("%s: capture is corrupt after %u records!",
+                __func__, static_cast<uint32_t>(reader.getReadRecordCount()));
+            bSuccess = false;
+        }
+
+        return bSuccess;
+    }
+
+    uint64_t PgePacketReplayer::getReplayedRecordCount() const
+    {
+        return m_nReplayedRecordCount;
+    }
+
+    /**
+        @return Number of packets passed to the callback during the last replay, can be more than the number of replayed
+                records due to unpacking batched app messages.
+    */
+    uint64_t PgePacketReplayer::getReplayedPktCount() const
+    {
+        return m_nReplayedPktCount;
+    }
+
+    /**
+        @return Number of records of enabled directions not replayed during the last replay due to being inconsistent app message packets.
+    */
+    uint64_t PgePacketReplayer::getSkippedRecordCount() const
+    {
+        return m_nSkippedRecordCount;
+    }
+
+    uint64_t PgePacketReplayer::getReplayDurationUSecs() const
+    {
+        return m_nReplayDurationUSecs;
+    }
+
+    /**
+        Passes the packet of the given record to the callback, unpacking batched app messages into separate packets
+        the same way as PgeGnsWrapper::pollIncomingMessages() does.
+        Compressed app messages are decompressed if there is a compressor set, malformed ones are not replayed.
+
+        @return False if the callback returned false, true otherwise.
+    */
+    bool PgePacketReplayer::replayRecord(const PgePacketCaptureReader::Record& rec, const PktCallback& cbPkt)
+    {
+        if (PgePacket::getPacketId(rec.m_pkt) != PgePktId::Application)
+        {
+            m_nReplayedRecordCount++;
+            m_nReplayedPktCount++;
+            return cbPkt(rec.m_pkt);
+        }
+
+        const uint8_t nMessageCount = PgePacket::getMessageAppCount(rec.m_pkt);
+        if ((nMessageCount == 0) || (PgePacket::getPktActualSizeBytes(rec.m_pkt) != rec.m_nPktSize))
+        {
+            m_nSkippedRecordCount++;
+            return true;
+        }
+
+        m_nReplayedRecordCount++;
+        const bool bDecompress = m_pCompressor && PgeMsgAppCompressor::hasCompressedMsgApp(rec.m_pkt);
+        if ((nMessageCount == 1) && !bDecompress)
+        {
+            m_nReplayedPktCount++;
+            return cbPkt(rec.m_pkt);
+        }
+
+        PgePacket pktUnpacked;
+        MsgApp msgAppDecompressed;
+        const MsgApp* pMsgApp = PgePacket::getMsgAppFromPkt(rec.m_pkt);
+        for (uint8_t iAppMsg = 0; (iAppMsg < nMessageCount) && pMsgApp; iAppMsg++)
+        {
+            const MsgApp* const pMsgAppToReplay = bDecompress ? m_pCompressor->decompressMsgApp(*pMsgApp, msgAppDecompressed) : pMsgApp;
+            PgePacket::initPktMsgApp(pktUnpacked, PgePacket::getServerSideConnectionHandle(rec.m_pkt), PgePacket::AutoFill::NONE);
+            if (pMsgAppToReplay && PgePacket::addPktMsgApp(pktUnpacked, *pMsgAppToReplay))
+            {
+                m_nReplayedPktCount++;
+                if (!cbPkt(pktUnpacked))
+                {
+                    return false;
+                }
+            }
+            pMsgApp = PgePacket::getNextMsgAppFromPkt(rec.m_pkt, *pMsgApp);
+        }
+        return true;
+    }
+
+} // namespace pge_network
@@ -0,0 +1,88 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgePacketReplayer.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine packet capture replayer
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+
+#include "PgeMsgAppCompressor.h"
+#include "PgeNetworkStats.h"
+#include "PgePacket.h"
+#include "PgePacketCapture.h"
+
+namespace pge_network
+{
+
+    /**
+        Feeds the packets of a capture file to a callback, the same way PGE::runGame() feeds received packets to PGE::onPacketReceived().
+
+        By default only received and injected packets are replayed, since these are the packets the application processed
+        when the capture was recorded. Received packets might carry multiple batched app messages, these are unpacked into
+        separate packets, so the callback gets exactly 1 app message per packet, as onPacketReceived() does.
+        Packets are captured as sent on the wire, so compressed app messages are replayed compressed, unless a compressor having
+        the same dictionary as the recording side is set by setMsgAppCompressor().
+
+        Packets are replayed either as fast as possible, e.g. for benchmarking the packet handling code of the application,
+        or at recorded pacing, e.g. for reproducing a session.
+    */
+    class PgePacketReplayer
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgePacketReplayer is included")
+#endif
+
+    public:
+
+        enum class Pacing : uint8_t
+        {
+            AsFastAsPossible = 0,
+            Recorded            /**< Each packet is replayed when as much time has elapsed since replay start as it was recorded. */
+        };
+
+        /** Same signature as PGE::onPacketReceived(), returning false stops the replay. */
+        typedef std::function<bool(const PgePacket&)> PktCallback;
+
+        PgePacketReplayer();
+        ~PgePacketReplayer() = default;
+
+        PgePacketReplayer(const PgePacketReplayer&) = delete;
+        PgePacketReplayer& operator=(const PgePacketReplayer&) = delete;
+        PgePacketReplayer(PgePacketReplayer&&) = delete;
+        PgePacketReplayer& operator=(PgePacketReplayer&&) = delete;
+
+        void setDirectionEnabled(const PgeNetworkStats::Direction& dir, bool bEnabled);
+        bool isDirectionEnabled(const PgeNetworkStats::Direction& dir) const;
+
+        void setMsgAppCompressor(PgeMsgAppCompressor* pCompressor);
+
+        bool replay(PgePacketCaptureReader& reader, const PktCallback& cbPkt, const Pacing& pacing);
+
+        uint64_t getReplayedRecordCount() const;
+        uint64_t getReplayedPktCount() const;
+        uint64_t getSkippedRecordCount() const;
+        uint64_t getReplayDurationUSecs() const;
+
+    private:
+
+        std::array<bool, PgeNetworkStats::nDirectionCount> m_bDirectionEnabled;
+        PgeMsgAppCompressor* m_pCompressor;
+        uint64_t m_nReplayedRecordCount;
+        uint64_t m_nReplayedPktCount;
+        uint64_t m_nSkippedRecordCount;
+        uint64_t m_nReplayDurationUSecs;
+
+        bool replayRecord(const PgePacketCaptureReader::Record& rec, const PktCallback& cbPkt);
+    }; // class PgePacketReplayer
+
+} // namespace pge_network
@@ -0,0 +1,240 @@
+/*
+    ###################################################################################
+    PgePacketRing.cpp
+    This file is part of PGE.
+    PR00F's Game Engine fixed-capacity ring buffer of packets
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgePacketRing.h"
+
+#include <stdexcept>
+
+namespace pge_network {
+
+    /**
+        Creates a ring with zero capacity, reserve() must be called before storing any packet.
+    */
+    PgePacketRing::PgePacketRing() :
+        m_nMask(0),
+        m_nHead(0),
+        m_nTail(0),
+        m_bFrontBorrowed(false),
+        m_bBackBegun(false),
+        m_nDroppedCount(0),
+        m_nHighWaterMark(0)
+    {
+    }
+
+    /**
+        Allocates memory for the given number of packets, rounded up to the next power of two.
+        If the resulting capacity equals to the current capacity, nothing happens and the stored packets are kept.
+        Otherwise the stored packets are dropped without being counted as dropped.
+        Counters are not reset.
+
+        @param nCapacity The minimum number of packets to be stored, must be in range [1, nMaxCapacity].
+
+        @return True on success, false if nCapacity is out of range or the front packet is borrowed while capacity would change.
+    */
+    bool PgePacketRing::reserve(const std::size_t& nCapacity)
+    {
+        if ((nCapacity == 0) || (nCapacity > nMaxCapacity))
+        {
+            return false;
+        }
+
+        std::size_t nPow2Capacity = 1;
+        while (nPow2Capacity < nCapacity)
+        {
+            nPow2Capacity <<= 1;
+        }
+
+        if (nPow2Capacity == capacity())
+        {
+            return true;
+        }
+
+        if (m_bFrontBorrowed)
+        {
+            return false;
+        }
+
+        m_vPackets = std::vector<PgePacket>(nPow2Capacity);
+        m_nMask = nPow2Capacity - 1;
+        m_nHead = 0;
+        m_nTail = 0;
+        m_bBackBegun = false;
+        return true;
+    }
+
+    /**
+        Drops all stored packets, without being counted as dropped.
+        Capacity and counters are kept.
+    */
+    void PgePacketRing::clear()
+    {
+        m_nHead = 0;
+        m_nTail = 0;
+        m_bFrontBorrowed = false;
+        m_bBackBegun = false;
+    }
+
+    /**
+        @return Maximum number of packets that can be stored, always zero or a power of two.
+    */
+    std::size_t PgePacketRing::capacity() const
+    {
+        return m_vPackets.size();
+    }
+
+    /**
+        @return Number of currently stored packets.
+    */
+    std::size_t PgePacketRing::size() const
+    {
+        return m_nTail - m_nHead;
+    }
+
+    bool PgePacketRing::empty() const
+    {
+        return m_nTail == m_nHead;
+    }
+
+    bool PgePacketRing::full() const
+    {
+        return size() == capacity();
+    }
+
+    /**
+        Gets the back slot to be filled in-place by the producer.
+        The packet becomes stored only when endPushBack() is called, so the producer can abandon the slot by simply not calling it,
+        e.g. when it turns out the packet should be ignored. The next call to this function will return the same slot.
+
+        If the ring is full, nullptr is returned and the dropped count is incremented.
+
+        @return The slot to be filled, or nullptr if there is no room for a new packet.
+    */
+    PgePacket* PgePacketRing::beginPushBack()
+    {
+        if (capacity() == 0)
+        {
+            ++m_nDroppedCount;
+            return nullptr;
+        }
+
+        if (!m_bBackBegun && full())
+        {
+            ++m_nDroppedCount;
+            return nullptr;
+        }
+
+        m_bBackBegun = true;
+        return &m_vPackets[m_nTail & m_nMask];
+    }
+
+    /**
+        Stores the packet filled in the slot returned by beginPushBack().
+        No effect if beginPushBack() was not called or returned nullptr.
+    */
+    void PgePacketRing::endPushBack()
+    {
+        if (!m_bBackBegun)
+        {
+            return;
+        }
+
+        m_bBackBegun = false;
+        ++m_nTail;
+        if (size() > m_nHighWaterMark)
+        {
+            m_nHighWaterMark = size();
+        }
+    }
+
+    /**
+        Copies the given packet into the back slot.
+        Convenience function for packets that are already available somewhere else, e.g. injected packets.
+
+        @param pkt The packet to be stored.
+
+        @return True if the packet is stored, false if it is dropped since the ring is full.
+    */
+    bool PgePacketRing::pushBack(const PgePacket& pkt)
+    {
+        PgePacket* const pSlot = beginPushBack();
+        if (!pSlot)
+        {
+            return false;
+        }
+
+        *pSlot = pkt;
+        endPushBack();
+        return true;
+    }
+
+    /**
+        Gets the front packet without copying it.
+        The returned reference stays valid until releaseFront(), reserve() or clear() is called, and the front packet is
+        never dropped meanwhile.
+
+        @return The front packet.
+        Throws std::runtime_error if the ring is empty.
+    */
+    const PgePacket& PgePacketRing::borrowFront() noexcept(false)
+    {
+        if (empty())
+        {
+            throw std::runtime_error("PgePacketRing::borrowFront(): ring is empty!");
+        }
+
+        m_bFrontBorrowed = true;
+        return m_vPackets[m_nHead & m_nMask];
+    }
+
+    /**
+        Removes the front packet, invalidating the reference returned by borrowFront().
+        Can be called also without borrowing, simply removing the front packet.
+        No effect if the ring is empty.
+    */
+    void PgePacketRing::releaseFront()
+    {
+        if (empty())
+        {
+            return;
+        }
+
+        m_bFrontBorrowed = false;
+        ++m_nHead;
+    }
+
+    bool PgePacketRing::isFrontBorrowed() const
+    {
+        return m_bFrontBorrowed;
+    }
+
+    /**
+        @return Number of packets dropped since the ring was full, since construction or last resetCounters().
+    */
+    uint32_t PgePacketRing::getDroppedCount() const
+    {
+        return m_nDroppedCount;
+    }
+
+    /**
+        @return Maximum number of packets stored at the same time, since construction or last resetCounters().
+    */
+    std::size_t PgePacketRing::getHighWaterMark() const
+    {
+        return m_nHighWaterMark;
+    }
+
+    void PgePacketRing::resetCounters()
+    {
+        m_nDroppedCount = 0;
+        m_nHighWaterMark = size();
+    }
+
+} // namespace pge_network
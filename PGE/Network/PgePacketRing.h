@@ -0,0 +1,91 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgePacketRing.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine fixed-capacity ring buffer of packets
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "PgePacket.h"
+
+namespace pge_network
+{
+
+    /**
+        Fixed-capacity FIFO ring buffer of PgePackets, used as queue of incoming packets.
+
+        Capacity is always a power of two so that index wrapping is just a bitwise and with a mask.
+        Memory is allocated only by reserve(), after that no allocation happens, and packets are not moved around in memory:
+         - producer side fills the back slot in-place using beginPushBack() and endPushBack(), or copies into it using pushBack();
+         - consumer side gets a const reference to the front slot using borrowFront(), and when done with it, calls releaseFront().
+        This way a received packet is copied only once: from the network layer into the ring.
+
+        When the ring is full, the new packet is dropped and counted, stored packets are never dropped. Producers that must not lose
+        packets are expected to check for free room before producing them, e.g. PGE applies backpressure on receiving instead.
+
+        Not thread-safe.
+    */
+    class PgePacketRing
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgePacketRing is included")
+#endif
+
+    public:
+
+        static constexpr std::size_t nMaxCapacity = 1u << 16;  /**< Maximum capacity that can be reserved. */
+
+        // ---------------------------------------------------------------------------
+
+        PgePacketRing();
+        ~PgePacketRing() = default;
+
+        PgePacketRing(const PgePacketRing&) = delete;
+        PgePacketRing& operator=(const PgePacketRing&) = delete;
+        PgePacketRing(PgePacketRing&&) = delete;
+        PgePacketRing& operator=(PgePacketRing&&) = delete;
+
+        bool reserve(const std::size_t& nCapacity);
+        void clear();
+
+        std::size_t capacity() const;
+        std::size_t size() const;
+        bool empty() const;
+        bool full() const;
+
+        PgePacket* beginPushBack();
+        void endPushBack();
+        bool pushBack(const PgePacket& pkt);
+
+        const PgePacket& borrowFront() noexcept(false);
+        void releaseFront();
+        bool isFrontBorrowed() const;
+
+        uint32_t getDroppedCount() const;
+        std::size_t getHighWaterMark() const;
+        void resetCounters();
+
+    private:
+
+        std::vector<PgePacket> m_vPackets;  /**< Preallocated slots, size is always capacity. */
+        std::size_t m_nMask;                /**< capacity - 1, valid only if capacity is non-zero. */
+        std::size_t m_nHead;                /**< Monotonically increasing index of front packet, to be masked before use. */
+        std::size_t m_nTail;                /**< Monotonically increasing index of slot after back packet, to be masked before use. */
+        bool m_bFrontBorrowed;
+        bool m_bBackBegun;
+
+        uint32_t m_nDroppedCount;
+        std::size_t m_nHighWaterMark;
+
+    }; // class PgePacketRing
+
+} // namespace pge_network
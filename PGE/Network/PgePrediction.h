@@ -0,0 +1,520 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgePrediction.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine client-side prediction and server reconciliation
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "PgePacket.h"
+
+namespace pge_network
+{
+
+    /** Sequence number of an input command, the first input of a client is 1, 0 means no input. */
+    typedef uint32_t TPredictionSequence;
+
+    /** App message data sent by client to server: an input command tagged with its sequence number. */
+    template <typename TInput>
+    struct MsgPredictedInput
+    {
+        TPredictionSequence m_nSequence;
+        TInput m_input;
+    };
+
+    /** App message data sent by server to a client: authoritative state after processing inputs up to the given sequence number. */
+    template <typename TState>
+    struct MsgPredictedState
+    {
+        TPredictionSequence m_nLastProcessedSequence;
+        TState m_state;
+    };
+
+    /**
+        Client side of prediction: the client does not wait a full round trip to see the result of its own input, instead it applies
+        each input command to its locally predicted state right away, and sends the command to the server tagged with a sequence number.
+        Commands not yet acknowledged by the server are kept in a ring buffer. When an authoritative state arrives from the server, the
+        predicted state is rewound to it, acknowledged commands are dropped and the remaining ones are replayed on top of it, so
+        mispredictions are corrected without losing the inputs in flight.
+
+        The step function is the application's fixed-delta physics step for a single input command, the same function must be used by
+        PgePredictionServer, with the same delta, so both sides get the same state from the same inputs.
+        TInput and TState are sent in app messages as they are, so they must be trivially copyable and small enough.
+
+        Typical use per physics tick: addInput(), then fillPktMsgAppInputs() into a packet initialized by PgePacket::initPktMsgApp()
+        and send it. Received state messages are passed to handleMsgApp(), e.g. by registering it to PgeMsgAppDispatcher.
+        Sending the last few pending inputs in every packet makes the unreliable lane tolerate packet loss, the server ignores duplicates.
+    */
+    template <typename TInput, typename TState>
+    class PgePredictionClient
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgePredictionClient is included")
+#endif
+
+    public:
+
+        typedef std::function<void(TState& state, const TInput& input)> StepFunction;
+
+        static_assert(std::is_trivially_copyable_v<TInput>);
+        static_assert(std::is_trivially_copyable_v<TState>);
+        static_assert(sizeof(MsgPredictedInput<TInput>) <= MsgApp::nMaxMessageLengthBytes, "Input does not fit into an app message!");
+        static_assert(sizeof(MsgPredictedState<TState>) <= MsgApp::nMaxMessageLengthBytes, "State does not fit into an app message!");
+
+        /**
+            @param msgAppIdInput     App message id of input commands, to be allowlisted by the server.
+            @param msgAppIdState     App message id of authoritative states, to be allowlisted by the client.
+            @param step              Fixed-delta physics step applying a single input command to a state.
+            @param initialState      Predicted and authoritative state until the first state arrives from the server.
+            @param nMaxPendingInputs Size of the ring buffer of unacknowledged inputs, should cover the longest expected round trip.
+        */
+        PgePredictionClient(
+            const MsgApp::TMsgId& msgAppIdInput,
+            const MsgApp::TMsgId& msgAppIdState,
+            const StepFunction& step,
+            const TState& initialState,
+            const std::size_t& nMaxPendingInputs = 64) noexcept(false) :
+            m_msgAppIdInput(msgAppIdInput),
+            m_msgAppIdState(msgAppIdState),
+            m_step(step),
+            m_vPendingInputs(nMaxPendingInputs)
+        {
+            if (msgAppIdInput == msgAppIdState)
+            {
+                throw std::runtime_error("PgePredictionClient::PgePredictionClient(): same msg id for input and state!");
+            }
+            if (!step)
+            {
+                throw std::runtime_error("PgePredictionClient::PgePredictionClient(): empty step function!");
+            }
+            if (nMaxPendingInputs == 0)
+            {
+                throw std::runtime_error("PgePredictionClient::PgePredictionClient(): zero nMaxPendingInputs!");
+            }
+            reset(initialState);
+        }
+
+        ~PgePredictionClient() = default;
+
+        PgePredictionClient(const PgePredictionClient&) = delete;
+        PgePredictionClient& operator=(const PgePredictionClient&) = delete;
+        PgePredictionClient(PgePredictionClient&&) = delete;
+        PgePredictionClient& operator=(PgePredictionClient&&) = delete;
+
+        /**
+            Forgets all inputs and restarts sequence numbering, e.g. when (re)connecting to a server, or the server respawns the player.
+        */
+        void reset(const TState& state)
+        {
+            m_predictedState = state;
+            m_authoritativeState = state;
+            m_nLastSequence = 0;
+            m_nLastAckedSequence = 0;
+            m_iOldestPending = 0;
+            m_nPendingCount = 0;
+            m_nReconcileCount = 0;
+            m_nReplayedInputCount = 0;
+            m_nOverflowCount = 0;
+        }
+
+        /**
+            Applies the given input command to the predicted state and stores it until the server acknowledges it.
+            If the ring buffer is full, the oldest pending input is forgotten: it cannot be replayed anymore, so prediction may be off
+            until the server catches up with it.
+
+            @return Sequence number assigned to the input.
+        */
+        TPredictionSequence addInput(const TInput& input)
+        {
+            if (m_nPendingCount == m_vPendingInputs.size())
+            {
+                m_iOldestPending = (m_iOldestPending + 1) % m_vPendingInputs.size();
+                --m_nPendingCount;
+                ++m_nOverflowCount;
+            }
+
+            MsgPredictedInput<TInput>& pending = m_vPendingInputs[(m_iOldestPending + m_nPendingCount) % m_vPendingInputs.size()];
+            pending.m_nSequence = ++m_nLastSequence;
+            pending.m_input = input;
+            ++m_nPendingCount;
+
+            m_step(m_predictedState, input);
+            return m_nLastSequence;
+        }
+
+        /**
+            Appends the newest pending inputs to the given packet as input messages, oldest first.
+            The packet must be initialized by PgePacket::initPktMsgApp() already.
+
+            @return Number of input messages appended, less than requested if there are not as many pending inputs or the packet got full.
+        */
+        std::size_t fillPktMsgAppInputs(PgePacket& pkt, const std::size_t& nMaxInputs = 1) const
+        {
+            const std::size_t nInputs = std::min(nMaxInputs, m_nPendingCount);
+            for (std::size_t i = m_nPendingCount - nInputs; i < m_nPendingCount; i++)
+            {
+                TByte* const pMsgAppData = PgePacket::preparePktMsgAppFill(
+                    pkt, m_msgAppIdInput, static_cast<MsgApp::TMsgSize>(sizeof(MsgPredictedInput<TInput>)));
+                if (!pMsgAppData)
+                {
+                    return i - (m_nPendingCount - nInputs);
+                }
+                std::memcpy(pMsgAppData, &getPendingInput(i), sizeof(MsgPredictedInput<TInput>));
+            }
+            return nInputs;
+        }
+
+        /**
+            Handler of the state app message, can be registered to PgeMsgAppDispatcher.
+
+            @return False if the given message is not a valid state message, true otherwise.
+        */
+        bool handleMsgApp(const PgePacket& /*pkt*/, const MsgApp& msgApp)
+        {
+            if ((MsgApp::getMsgAppMsgId(msgApp) != m_msgAppIdState) ||
+                (MsgApp::getMsgAppDataActualSizeBytes(msgApp) != sizeof(MsgPredictedState<TState>)))
+            {
+                return false;
+            }
+
+            // message data in the packet is not necessarily aligned for TState
+            MsgPredictedState<TState> msg;
+            std::memcpy(&msg, MsgApp::getMsgAppData(msgApp), sizeof(msg));
+            reconcile(msg.m_nLastProcessedSequence, msg.m_state);
+            return true;
+        }
+
+        /**
+            Rewinds the predicted state to the given authoritative state and replays inputs not yet processed by the server on top of it.
+            A state older than the last one received, e.g. arriving out of order on an unreliable lane, is ignored.
+        */
+        void reconcile(const TPredictionSequence& nLastProcessedSequence, const TState& state)
+        {
+            if ((nLastProcessedSequence < m_nLastAckedSequence) || (nLastProcessedSequence > m_nLastSequence))
+            {
+                return;
+            }
+
+            m_nLastAckedSequence = nLastProcessedSequence;
+            m_authoritativeState = state;
+            while ((m_nPendingCount > 0) && (getPendingInput(0).m_nSequence <= nLastProcessedSequence))
+            {
+                m_iOldestPending = (m_iOldestPending + 1) % m_vPendingInputs.size();
+                --m_nPendingCount;
+            }
+
+            m_predictedState = state;
+            for (std::size_t i = 0; i < m_nPendingCount; i++)
+            {
+                m_step(m_predictedState, getPendingInput(i).m_input);
+            }
+            ++m_nReconcileCount;
+            m_nReplayedInputCount += m_nPendingCount;
+        }
+
+        const MsgApp::TMsgId& getMsgAppIdInput() const
+        {
+            return m_msgAppIdInput;
+        }
+
+        const MsgApp::TMsgId& getMsgAppIdState() const
+        {
+            return m_msgAppIdState;
+        }
+
+        /** State including all inputs added so far, to be used for rendering the local player. */
+        const TState& getPredictedState() const
+        {
+            return m_predictedState;
+        }
+
+        /** Last state received from the server. */
+        const TState& getAuthoritativeState() const
+        {
+            return m_authoritativeState;
+        }
+
+        const TPredictionSequence& getLastSequence() const
+        {
+            return m_nLastSequence;
+        }
+
+        const TPredictionSequence& getLastAckedSequence() const
+        {
+            return m_nLastAckedSequence;
+        }
+
+        std::size_t getPendingInputCount() const
+        {
+            return m_nPendingCount;
+        }
+
+        std::size_t getMaxPendingInputCount() const
+        {
+            return m_vPendingInputs.size();
+        }
+
+        uint32_t getReconcileCount() const
+        {
+            return m_nReconcileCount;
+        }
+
+        /** Total number of inputs replayed by reconciliations, i.e. extra physics steps spent on prediction. */
+        uint64_t getReplayedInputCount() const
+        {
+            return m_nReplayedInputCount;
+        }
+
+        /** Number of pending inputs forgotten due to full ring buffer. */
+        uint32_t getOverflowCount() const
+        {
+            return m_nOverflowCount;
+        }
+
+    private:
+
+        const MsgApp::TMsgId m_msgAppIdInput;
+        const MsgApp::TMsgId m_msgAppIdState;
+        const StepFunction m_step;
+
+        std::vector<MsgPredictedInput<TInput>> m_vPendingInputs;  /**< Ring buffer of unacknowledged inputs in sequence order. */
+        std::size_t m_iOldestPending;
+        std::size_t m_nPendingCount;
+        TState m_predictedState;
+        TState m_authoritativeState;
+        TPredictionSequence m_nLastSequence;
+        TPredictionSequence m_nLastAckedSequence;
+        uint32_t m_nReconcileCount;
+        uint64_t m_nReplayedInputCount;
+        uint32_t m_nOverflowCount;
+
+        const MsgPredictedInput<TInput>& getPendingInput(const std::size_t& i) const
+        {
+            return m_vPendingInputs[(m_iOldestPending + i) % m_vPendingInputs.size()];
+        }
+
+    }; // class PgePredictionClient
+
+    /**
+        Server side of prediction: queues input commands received from each client, applies them to the authoritative state of the
+        client with the same step function as PgePredictionClient, and tells the client the sequence number of the last processed
+        input along with the resulting state, so the client can reconcile.
+
+        Received input messages are passed to handleMsgApp(), e.g. by registering it to PgeMsgAppDispatcher. Inputs with a sequence
+        number not newer than the last received one are duplicates or arrived out of order, they are ignored.
+        Then every physics tick the application invokes processInputs() for each client, and sends the state by fillPktMsgAppState().
+        The queue per client is bounded, so a client cannot make the server step its state arbitrarily many times.
+    */
+    template <typename TInput, typename TState>
+    class PgePredictionServer
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgePredictionServer is included")
+#endif
+
+    public:
+
+        typedef typename PgePredictionClient<TInput, TState>::StepFunction StepFunction;
+
+        /**
+            @param msgAppIdInput    App message id of input commands, to be allowlisted by the server.
+            @param msgAppIdState    App message id of authoritative states, to be allowlisted by the client.
+            @param step             Same fixed-delta physics step as given to PgePredictionClient.
+            @param nMaxQueuedInputs Maximum number of unprocessed inputs per client, oldest are dropped above this.
+        */
+        PgePredictionServer(
+            const MsgApp::TMsgId& msgAppIdInput,
+            const MsgApp::TMsgId& msgAppIdState,
+            const StepFunction& step,
+            const std::size_t& nMaxQueuedInputs = 64) noexcept(false) :
+            m_msgAppIdInput(msgAppIdInput),
+            m_msgAppIdState(msgAppIdState),
+            m_step(step),
+            m_nMaxQueuedInputs(nMaxQueuedInputs),
+            m_nDuplicateInputCount(0),
+            m_nDroppedInputCount(0)
+        {
+            if (msgAppIdInput == msgAppIdState)
+            {
+                throw std::runtime_error("PgePredictionServer::PgePredictionServer(): same msg id for input and state!");
+            }
+            if (!step)
+            {
+                throw std::runtime_error("PgePredictionServer::PgePredictionServer(): empty step function!");
+            }
+            if (nMaxQueuedInputs == 0)
+            {
+                throw std::runtime_error("PgePredictionServer::PgePredictionServer(): zero nMaxQueuedInputs!");
+            }
+        }
+
+        ~PgePredictionServer() = default;
+
+        PgePredictionServer(const PgePredictionServer&) = delete;
+        PgePredictionServer& operator=(const PgePredictionServer&) = delete;
+        PgePredictionServer(PgePredictionServer&&) = delete;
+        PgePredictionServer& operator=(PgePredictionServer&&) = delete;
+
+        /**
+            Handler of the input app message, can be registered to PgeMsgAppDispatcher.
+            The client is identified by the server-side connection handle of the given packet.
+
+            @return False if the given message is not a valid input message, true otherwise.
+        */
+        bool handleMsgApp(const PgePacket& pkt, const MsgApp& msgApp)
+        {
+            if ((MsgApp::getMsgAppMsgId(msgApp) != m_msgAppIdInput) ||
+                (MsgApp::getMsgAppDataActualSizeBytes(msgApp) != sizeof(MsgPredictedInput<TInput>)))
+            {
+                return false;
+            }
+
+            MsgPredictedInput<TInput> msg;
+            std::memcpy(&msg, MsgApp::getMsgAppData(msgApp), sizeof(msg));
+
+            Client& client = m_mapClients[PgePacket::getServerSideConnectionHandle(pkt)];
+            if (msg.m_nSequence <= client.m_nLastReceivedSequence)
+            {
+                ++m_nDuplicateInputCount;
+                return true;
+            }
+            client.m_nLastReceivedSequence = msg.m_nSequence;
+            if (client.m_queuedInputs.size() == m_nMaxQueuedInputs)
+            {
+                client.m_queuedInputs.pop_front();
+                ++m_nDroppedInputCount;
+            }
+            client.m_queuedInputs.push_back(msg);
+            return true;
+        }
+
+        /**
+            Applies queued inputs of the given client to the given state, in sequence order.
+            Inputs lost on the network are simply skipped, the client gets corrected by the next state sent to it.
+
+            @return Number of inputs applied.
+        */
+        std::size_t processInputs(
+            const PgeNetworkConnectionHandle& connHandleServerSide,
+            TState& state,
+            const std::size_t& nMaxInputs = std::numeric_limits<std::size_t>::max())
+        {
+            const auto it = m_mapClients.find(connHandleServerSide);
+            if (it == m_mapClients.end())
+            {
+                return 0;
+            }
+
+            Client& client = it->second;
+            std::size_t nProcessed = 0;
+            while ((nProcessed < nMaxInputs) && !client.m_queuedInputs.empty())
+            {
+                m_step(state, client.m_queuedInputs.front().m_input);
+                client.m_nLastProcessedSequence = client.m_queuedInputs.front().m_nSequence;
+                client.m_queuedInputs.pop_front();
+                ++nProcessed;
+            }
+            return nProcessed;
+        }
+
+        /**
+            Appends the state message for the given client to the given packet, acknowledging its last processed input.
+            The packet must be initialized by PgePacket::initPktMsgApp() already.
+
+            @return True on success, false if the packet is full.
+        */
+        bool fillPktMsgAppState(PgePacket& pkt, const PgeNetworkConnectionHandle& connHandleServerSide, const TState& state) const
+        {
+            TByte* const pMsgAppData = PgePacket::preparePktMsgAppFill(
+                pkt, m_msgAppIdState, static_cast<MsgApp::TMsgSize>(sizeof(MsgPredictedState<TState>)));
+            if (!pMsgAppData)
+            {
+                return false;
+            }
+
+            MsgPredictedState<TState> msg;
+            msg.m_nLastProcessedSequence = getLastProcessedSequence(connHandleServerSide);
+            msg.m_state = state;
+            std::memcpy(pMsgAppData, &msg, sizeof(msg));
+            return true;
+        }
+
+        /** To be invoked when the client disconnects, or its player is reset together with PgePredictionClient::reset(). */
+        bool removeClient(const PgeNetworkConnectionHandle& connHandleServerSide)
+        {
+            return m_mapClients.erase(connHandleServerSide) > 0;
+        }
+
+        bool hasClient(const PgeNetworkConnectionHandle& connHandleServerSide) const
+        {
+            return m_mapClients.find(connHandleServerSide) != m_mapClients.end();
+        }
+
+        TPredictionSequence getLastReceivedSequence(const PgeNetworkConnectionHandle& connHandleServerSide) const
+        {
+            const auto it = m_mapClients.find(connHandleServerSide);
+            return (it == m_mapClients.end()) ? 0 : it->second.m_nLastReceivedSequence;
+        }
+
+        TPredictionSequence getLastProcessedSequence(const PgeNetworkConnectionHandle& connHandleServerSide) const
+        {
+            const auto it = m_mapClients.find(connHandleServerSide);
+            return (it == m_mapClients.end()) ? 0 : it->second.m_nLastProcessedSequence;
+        }
+
+        std::size_t getQueuedInputCount(const PgeNetworkConnectionHandle& connHandleServerSide) const
+        {
+            const auto it = m_mapClients.find(connHandleServerSide);
+            return (it == m_mapClients.end()) ? 0 : it->second.m_queuedInputs.size();
+        }
+
+        /** Number of inputs ignored because an input with the same or newer sequence number was already received. */
+        uint32_t getDuplicateInputCount() const
+        {
+            return m_nDuplicateInputCount;
+        }
+
+        /** Number of inputs dropped due to full queue. */
+        uint32_t getDroppedInputCount() const
+        {
+            return m_nDroppedInputCount;
+        }
+
+    private:
+
+        struct Client
+        {
+            std::deque<MsgPredictedInput<TInput>> m_queuedInputs;
+            TPredictionSequence m_nLastReceivedSequence = 0;
+            TPredictionSequence m_nLastProcessedSequence = 0;
+        };
+
+        const MsgApp::TMsgId m_msgAppIdInput;
+        const MsgApp::TMsgId m_msgAppIdState;
+        const StepFunction m_step;
+        const std::size_t m_nMaxQueuedInputs;
+
+        std::map<PgeNetworkConnectionHandle, Client> m_mapClients;
+        uint32_t m_nDuplicateInputCount;
+        uint32_t m_nDroppedInputCount;
+
+    }; // class PgePredictionServer
+
+} // namespace pge_network
@@ -37,11 +37,19 @@ public:
 
     std::size_t getPacketQueueSize() const override;
     pge_network::PgePacket popFrontPacket() noexcept(false) override;
+    const pge_network::PgePacket& borrowFrontPacket() noexcept(false) override;
+    void releaseFrontPacket() override;
+    uint32_t getPacketQueueDroppedCount() const override;
+    std::size_t getPacketQueueHighWaterMark() const override;
 
-    std::set<pge_network::PgePktId>& getAllowListedPgeMessages() override;
-    std::set<pge_network::MsgApp::TMsgId>& getAllowListedAppMessages() override;
+    pge_network::PgePktIdAllowList& getAllowListedPgeMessages() override;
+    pge_network::MsgAppIdAllowList& getAllowListedAppMessages() override;
+    std::map<pge_network::MsgApp::TMsgId, pge_network::PgeSendLane>& getMsgAppId2SendLaneMap() override;
+    pge_network::PgeMsgAppCompressor& getMsgAppCompressor() override;
+    std::map<pge_network::MsgApp::TMsgId, pge_network::PgeMsgAppCompressor::MsgAppStats> getMsgAppCompressionStats() const override;
 
     void send(const pge_network::PgePacket& pkt, const pge_network::PgeNetworkConnectionHandle& connHandle = pge_network::ServerConnHandle) override;
+    void flushBatchedPackets() override;
 
     uint32_t getRxPacketCount() const override;
     uint32_t getTxPacketCount() const override;
@@ -55,11 +63,18 @@ public:
     const std::map<pge_network::MsgApp::TMsgId, uint32_t>& getTxMsgCount() const override;
     const std::map<pge_network::MsgApp::TMsgId, uint32_t>& getInjectMsgCount() const override;
 
+    const std::map<pge_network::PgeSendLane, uint32_t>& getRxLaneMsgCount() const override;
+    const std::map<pge_network::PgeSendLane, uint32_t>& getTxLaneMsgCount() const override;
+
+    const pge_network::PgeNetworkStats& getNetworkStats() const override;
+
     std::map<pge_network::MsgApp::TMsgId, std::string>& getMsgAppId2StringMap() override;
 
     uint32_t getRxByteCount() const override;
     uint32_t getTxByteCount() const override;
     uint32_t getInjectByteCount() const override;
+    pge_network::PgeHandoffStats getHandoffStats() const override;
+    pge_network::PgeConnectionTelemetry getConnectionTelemetry() const override;
 
     void WriteList() const override;
 
@@ -69,6 +84,7 @@ public:
 
     bool startListening(const std::string& sAppVersion = "") override;
     void sendToAllClientsExcept(const pge_network::PgePacket& pkt, const pge_network::PgeNetworkConnectionHandle& exceptConnHandle = 0) override;
+    void sendToAllClientsExcept(const pge_network::PgePacket& pkt, const std::set<pge_network::PgeNetworkConnectionHandle>& exceptConnHandles) override;
     void sendToAll(const pge_network::PgePacket& pkt) override;
 
     /* Debug functions. */
@@ -208,16 +224,52 @@ pge_network::PgePacket PgeServerImpl::popFrontPacket() noexcept(false)
     return m_gnsServer.popFrontPacket();
 }
 
-std::set<pge_network::PgePktId>& PgeServerImpl::getAllowListedPgeMessages()
+const pge_network::PgePacket& PgeServerImpl::borrowFrontPacket() noexcept(false)
+{
+    return m_gnsServer.borrowFrontPacket();
+}
+
+void PgeServerImpl::releaseFrontPacket()
+{
+    m_gnsServer.releaseFrontPacket();
+}
+
+uint32_t PgeServerImpl::getPacketQueueDroppedCount() const
+{
+    return m_gnsServer.getPacketQueueDroppedCount();
+}
+
+std::size_t PgeServerImpl::getPacketQueueHighWaterMark() const
+{
+    return m_gnsServer.getPacketQueueHighWaterMark();
+}
+
+pge_network::PgePktIdAllowList& PgeServerImpl::getAllowListedPgeMessages()
 {
     return m_gnsServer.getAllowListedPgeMessages();
 }
 
-std::set<pge_network::MsgApp::TMsgId>& PgeServerImpl::getAllowListedAppMessages()
+pge_network::MsgAppIdAllowList& PgeServerImpl::getAllowListedAppMessages()
 {
     return m_gnsServer.getAllowListedAppMessages();
 }
 
+std::map<pge_network::MsgApp::TMsgId, pge_network::PgeSendLane>& PgeServerImpl::getMsgAppId2SendLaneMap()
+{
+    return m_gnsServer.getMsgAppId2SendLaneMap();
+}
+
+pge_network::PgeMsgAppCompressor& PgeServerImpl::getMsgAppCompressor()
+{
+    return m_gnsServer.getMsgAppCompressor();
+}
+
+std::map<pge_network::MsgApp::TMsgId, pge_network::PgeMsgAppCompressor::MsgAppStats> PgeServerImpl::getMsgAppCompressionStats() const
+{
+    const auto lock = m_gnsServer.lockIoThread();
+    return m_gnsServer.getMsgAppCompressor().getStats();
+}
+
 void PgeServerImpl::send(const pge_network::PgePacket& pkt, const pge_network::PgeNetworkConnectionHandle& connHandle)
 {
     if (connHandle == pge_network::ServerConnHandle)
@@ -230,6 +282,11 @@ void PgeServerImpl::send(const pge_network::PgePacket& pkt, const pge_network::P
     }
 }
 
+void PgeServerImpl::flushBatchedPackets()
+{
+    m_gnsServer.flushBatchedPackets();
+}
+
 uint32_t PgeServerImpl::getRxPacketCount() const
 {
     return m_gnsServer.getRxPacketCount();
@@ -275,6 +332,21 @@ const std::map<pge_network::MsgApp::TMsgId, uint32_t>& PgeServerImpl::getInjectM
     return m_gnsServer.getInjectMsgCount();
 }
 
+const std::map<pge_network::PgeSendLane, uint32_t>& PgeServerImpl::getRxLaneMsgCount() const
+{
+    return m_gnsServer.getRxLaneMsgCount();
+}
+
+const std::map<pge_network::PgeSendLane, uint32_t>& PgeServerImpl::getTxLaneMsgCount() const
+{
+    return m_gnsServer.getTxLaneMsgCount();
+}
+
+const pge_network::PgeNetworkStats& PgeServerImpl::getNetworkStats() const
+{
+    return m_gnsServer.getNetworkStats();
+}
+
 std::map<pge_network::MsgApp::TMsgId, std::string>& PgeServerImpl::getMsgAppId2StringMap()
 {
     return m_gnsServer.getMsgAppId2StringMap();
@@ -295,6 +367,17 @@ uint32_t PgeServerImpl::getInjectByteCount() const
     return m_gnsServer.getInjectByteCount();
 }
 
+pge_network::PgeHandoffStats PgeServerImpl::getHandoffStats() const
+{
+    return m_gnsServer.getHandoffStats();
+}
+
+pge_network::PgeConnectionTelemetry PgeServerImpl::getConnectionTelemetry() const
+{
+    const auto lock = m_gnsServer.lockIoThread();
+    return m_gnsServer.getConnectionTelemetry();
+}
+
 void PgeServerImpl::WriteList() const
 {
     getConsole().OLnOI("PgeServer::WriteList() start");
@@ -303,6 +386,7 @@ void PgeServerImpl::WriteList() const
         getConsole().OLn("Role: Server");
         // TODO: PgeGnsWrapper will obviously use PgeGnsWrapper as module name when writing to console, so it is recommended now
         // to always turn on PgeGnsWrapper logging as well together with PgeServer
+        const auto lock = m_gnsServer.lockIoThread();
         m_gnsServer.WriteServerClientList();
     }
     else
@@ -323,6 +407,12 @@ void PgeServerImpl::sendToAllClientsExcept(const pge_network::PgePacket& pkt, co
     m_gnsServer.sendToAllClientsExcept(pkt, exceptConnHandle);
 }
 
+void PgeServerImpl::sendToAllClientsExcept(const pge_network::PgePacket& pkt, const std::set<pge_network::PgeNetworkConnectionHandle>& exceptConnHandles)
+{
+    static_assert(std::is_same_v<pge_network::PgeNetworkConnectionHandle, HSteamNetConnection>);
+    m_gnsServer.sendToAllClientsExcept(pkt, exceptConnHandles);
+}
+
 void PgeServerImpl::sendToAll(const pge_network::PgePacket& pkt)
 {
     send(pkt);
@@ -331,56 +421,67 @@ void PgeServerImpl::sendToAll(const pge_network::PgePacket& pkt)
 
 void PgeServerImpl::setDebugNickname(const pge_network::PgeNetworkConnectionHandle& connHandle, const std::string& sNickname)
 {
+    const auto lock = m_gnsServer.lockIoThread();
     m_gnsServer.setClientDebugName(connHandle, sNickname.c_str());
 }
 
 int PgeServerImpl::getPing(const pge_network::PgeNetworkConnectionHandle& connHandle, bool bForceUpdate)
 {
+    const auto lock = m_gnsServer.lockIoThread();
     return m_gnsServer.getRealTimeStatus(connHandle, bForceUpdate).m_nPing;
 }
 
 float PgeServerImpl::getQualityLocal(const pge_network::PgeNetworkConnectionHandle& connHandle, bool bForceUpdate)
 {
+    const auto lock = m_gnsServer.lockIoThread();
     return m_gnsServer.getRealTimeStatus(connHandle, bForceUpdate).m_flConnectionQualityLocal;
 }
 
 float PgeServerImpl::getQualityRemote(const pge_network::PgeNetworkConnectionHandle& connHandle, bool bForceUpdate)
 {
+    const auto lock = m_gnsServer.lockIoThread();
     return m_gnsServer.getRealTimeStatus(connHandle, bForceUpdate).m_flConnectionQualityRemote;
 }
 
 float PgeServerImpl::getRxByteRate(const pge_network::PgeNetworkConnectionHandle& connHandle, bool bForceUpdate)
 {
+    const auto lock = m_gnsServer.lockIoThread();
     return m_gnsServer.getRealTimeStatus(connHandle, bForceUpdate).m_flInBytesPerSec;
 }
 
 float PgeServerImpl::getTxByteRate(const pge_network::PgeNetworkConnectionHandle& connHandle, bool bForceUpdate)
 {
+    const auto lock = m_gnsServer.lockIoThread();
     return m_gnsServer.getRealTimeStatus(connHandle, bForceUpdate).m_flOutBytesPerSec;
 }
 
 int64_t PgeServerImpl::getPendingUnreliableBytes(const pge_network::PgeNetworkConnectionHandle& connHandle, bool bForceUpdate)
 {
+    const auto lock = m_gnsServer.lockIoThread();
     return m_gnsServer.getRealTimeStatus(connHandle, bForceUpdate).m_cbPendingUnreliable;
 }
 
 int64_t PgeServerImpl::getPendingReliableBytes(const pge_network::PgeNetworkConnectionHandle& connHandle, bool bForceUpdate)
 {
+    const auto lock = m_gnsServer.lockIoThread();
     return m_gnsServer.getRealTimeStatus(connHandle, bForceUpdate).m_cbPendingReliable;
 }
 
 int64_t PgeServerImpl::getSentButUnAckedReliableBytes(const pge_network::PgeNetworkConnectionHandle& connHandle, bool bForceUpdate)
 {
+    const auto lock = m_gnsServer.lockIoThread();
     return m_gnsServer.getRealTimeStatus(connHandle, bForceUpdate).m_cbSentUnackedReliable;
 }
 
 int64_t PgeServerImpl::getInternalQueueTimeUSecs(const pge_network::PgeNetworkConnectionHandle& connHandle, bool bForceUpdate)
 {
+    const auto lock = m_gnsServer.lockIoThread();
     return static_cast<int64_t>(m_gnsServer.getRealTimeStatus(connHandle, bForceUpdate).m_usecQueueTime);
 }
 
 std::string PgeServerImpl::getDetailedConnectionStatus(const pge_network::PgeNetworkConnectionHandle& connHandle) const
 {
+    const auto lock = m_gnsServer.lockIoThread();
     return m_gnsServer.getDetailedConnectionStatus(connHandle);
 }
 
@@ -0,0 +1,219 @@
+/*
+    ###################################################################################
+    PgeSnapshot.cpp
+    This file is part of PGE.
+    PR00F's Game Engine replicated state snapshot
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgeSnapshot.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace pge_network {
+
+    /**
+        Creates an empty snapshot with sequence number 0.
+
+        @param vFieldSizes Size of each field of entities in bytes, each must be in range [1, nMaxFieldSizeBytes].
+                           Number of fields must be in range [1, nMaxFieldCount].
+                           Throws std::runtime_error if any of these is violated.
+    */
+    PgeSnapshot::PgeSnapshot(const std::vector<uint8_t>& vFieldSizes) noexcept(false) :
+        m_nFieldSizes{},
+        m_nFieldCount(vFieldSizes.size()),
+        m_seq(0)
+    {
+        if ((m_nFieldCount == 0) || (m_nFieldCount > nMaxFieldCount))
+        {
+            throw std::runtime_error("PgeSnapshot(): invalid field count " + std::to_string(m_nFieldCount) + "!");
+        }
+
+        for (std::size_t i = 0; i < m_nFieldCount; i++)
+        {
+            if ((vFieldSizes[i] == 0) || (vFieldSizes[i] > nMaxFieldSizeBytes))
+            {
+                throw std::runtime_error("PgeSnapshot(): invalid size " + std::to_string(vFieldSizes[i]) + " of field " + std::to_string(i) + "!");
+            }
+            m_nFieldSizes[i] = vFieldSizes[i];
+        }
+    }
+
+    const PgeSnapshot::TSequence& PgeSnapshot::getSequence() const
+    {
+        return m_seq;
+    }
+
+    void PgeSnapshot::setSequence(const TSequence& seq)
+    {
+        m_seq = seq;
+    }
+
+    std::size_t PgeSnapshot::getFieldCount() const
+    {
+        return m_nFieldCount;
+    }
+
+    /**
+        @return Size of the given field in bytes, or 0 if field index is out of range.
+    */
+    uint8_t PgeSnapshot::getFieldSize(const std::size_t& iField) const
+    {
+        return (iField < m_nFieldCount) ? m_nFieldSizes[iField] : 0;
+    }
+
+    /**
+        @return Mask having the bits of all fields set.
+    */
+    PgeSnapshot::TFieldMask PgeSnapshot::getAllFieldsMask() const
+    {
+        return static_cast<TFieldMask>((1u << m_nFieldCount) - 1u);
+    }
+
+    bool PgeSnapshot::hasSameSchema(const PgeSnapshot& other) const
+    {
+        return (m_nFieldCount == other.m_nFieldCount) && (m_nFieldSizes == other.m_nFieldSizes);
+    }
+
+    bool PgeSnapshot::hasEntity(const TEntityId& entityId) const
+    {
+        return getEntity(entityId) != nullptr;
+    }
+
+    /**
+        @return True if the entity existed and is now removed, false if it did not exist.
+    */
+    bool PgeSnapshot::removeEntity(const TEntityId& entityId)
+    {
+        const auto it = std::lower_bound(
+            m_vEntities.begin(), m_vEntities.end(), entityId,
+            [](const Entity& entity, const TEntityId& id) { return entity.m_id < id; });
+        if ((it == m_vEntities.end()) || (it->m_id != entityId))
+        {
+            return false;
+        }
+
+        m_vEntities.erase(it);
+        return true;
+    }
+
+    /**
+        Removes all entities, without releasing memory. Schema and sequence number are kept.
+    */
+    void PgeSnapshot::clear()
+    {
+        m_vEntities.clear();
+    }
+
+    /**
+        @return All entities sorted by id.
+    */
+    const std::vector<PgeSnapshot::Entity>& PgeSnapshot::getEntities() const
+    {
+        return m_vEntities;
+    }
+
+    /**
+        @return The given entity, or nullptr if it does not exist. Invalidated when an entity is added or removed.
+    */
+    const PgeSnapshot::Entity* PgeSnapshot::getEntity(const TEntityId& entityId) const
+    {
+        const auto it = std::lower_bound(
+            m_vEntities.begin(), m_vEntities.end(), entityId,
+            [](const Entity& entity, const TEntityId& id) { return entity.m_id < id; });
+        return ((it == m_vEntities.end()) || (it->m_id != entityId)) ? nullptr : &(*it);
+    }
+
+    /**
+        @return The given entity, added with all fields being zero if it did not exist. Invalidated when an entity is added or removed.
+    */
+    PgeSnapshot::Entity& PgeSnapshot::getOrAddEntity(const TEntityId& entityId)
+    {
+        const auto it = std::lower_bound(
+            m_vEntities.begin(), m_vEntities.end(), entityId,
+            [](const Entity& entity, const TEntityId& id) { return entity.m_id < id; });
+        if ((it != m_vEntities.end()) && (it->m_id == entityId))
+        {
+            return *it;
+        }
+
+        Entity entity;
+        entity.m_id = entityId;
+        entity.m_fields.fill(0);
+        return *m_vEntities.insert(it, entity);
+    }
+
+    /**
+        @return Mask having the bits of fields set whose values differ in the 2 given entities.
+    */
+    PgeSnapshot::TFieldMask PgeSnapshot::getChangedFieldsMask(const Entity& entityOld, const Entity& entityNew) const
+    {
+        TFieldMask mask = 0;
+        for (std::size_t iField = 0; iField < m_nFieldCount; iField++)
+        {
+            if (0 != memcmp(
+                &(entityOld.m_fields[iField * nMaxFieldSizeBytes]),
+                &(entityNew.m_fields[iField * nMaxFieldSizeBytes]),
+                m_nFieldSizes[iField]))
+            {
+                mask |= static_cast<TFieldMask>(1u << iField);
+            }
+        }
+        return mask;
+    }
+
+    /**
+        @return True if schema, entity ids and all fields of all entities are the same in both snapshots, regardless of sequence number.
+    */
+    bool PgeSnapshot::isEqualState(const PgeSnapshot& other) const
+    {
+        if (!hasSameSchema(other) || (m_vEntities.size() != other.m_vEntities.size()))
+        {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < m_vEntities.size(); i++)
+        {
+            if ((m_vEntities[i].m_id != other.m_vEntities[i].m_id) || (getChangedFieldsMask(m_vEntities[i], other.m_vEntities[i]) != 0))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool PgeSnapshot::setFieldBytes(const TEntityId& entityId, const std::size_t& iField, const void* pValue, const std::size_t& nSize)
+    {
+        if ((iField >= m_nFieldCount) || (nSize != m_nFieldSizes[iField]))
+        {
+            return false;
+        }
+
+        Entity& entity = getOrAddEntity(entityId);
+        memcpy(&(entity.m_fields[iField * nMaxFieldSizeBytes]), pValue, nSize);
+        return true;
+    }
+
+    bool PgeSnapshot::getFieldBytes(const TEntityId& entityId, const std::size_t& iField, void* pValue, const std::size_t& nSize) const
+    {
+        if ((iField >= m_nFieldCount) || (nSize != m_nFieldSizes[iField]))
+        {
+            return false;
+        }
+
+        const Entity* const pEntity = getEntity(entityId);
+        if (!pEntity)
+        {
+            return false;
+        }
+
+        memcpy(pValue, &(pEntity->m_fields[iField * nMaxFieldSizeBytes]), nSize);
+        return true;
+    }
+
+} // namespace pge_network
@@ -0,0 +1,176 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeSnapshot.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine replicated state snapshot
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "../Config/PgeOldNewValue.h"
+#include "PgePacket.h"
+
+namespace pge_network
+{
+
+    /**
+        Replicated state of all entities at a given moment, as used by PgeSnapshotSender and PgeSnapshotReceiver.
+
+        An entity is anything identified by a TEntityId, e.g. a player identified by its connection handle.
+        Each entity has the same fields, defined by the field sizes given in the constructor: this is the schema of the snapshot,
+        and it must be the same on server and client sides.
+        A field is any trivially copyable value of exactly the size defined for the field, at most nMaxFieldSizeBytes.
+        The delta encoding compares fields bytewise, so a field is either changed or unchanged, no partial update of a field.
+
+        Entities are stored in a vector sorted by id, so 2 snapshots can be compared by a single merge-like iteration.
+    */
+    class PgeSnapshot
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeSnapshot is included")
+#endif
+
+    public:
+
+        typedef uint32_t TSequence;   /**< Snapshot sequence number, 0 means no snapshot. */
+        typedef uint32_t TEntityId;
+        typedef uint16_t TFieldMask;  /**< Bit i is set if field i is present. */
+
+        static constexpr std::size_t nMaxFieldCount = sizeof(TFieldMask) * 8;
+        static constexpr std::size_t nMaxFieldSizeBytes = 8;
+        static constexpr std::size_t nHistorySize = 32;  /**< Number of last snapshots remembered by sender and receiver, for delta encoding and decoding. */
+
+        /**
+            A single entity with all its fields. Field i is stored at offset i * nMaxFieldSizeBytes, unused bytes are always zero.
+        */
+        struct Entity
+        {
+            TEntityId m_id;
+            std::array<TByte, nMaxFieldCount * nMaxFieldSizeBytes> m_fields;
+        };
+
+        // ---------------------------------------------------------------------------
+
+        explicit PgeSnapshot(const std::vector<uint8_t>& vFieldSizes) noexcept(false);
+        ~PgeSnapshot() = default;
+
+        PgeSnapshot(const PgeSnapshot&) = default;
+        PgeSnapshot& operator=(const PgeSnapshot&) = default;
+        PgeSnapshot(PgeSnapshot&&) = default;
+        PgeSnapshot& operator=(PgeSnapshot&&) = default;
+
+        const TSequence& getSequence() const;
+        void setSequence(const TSequence& seq);
+
+        std::size_t getFieldCount() const;
+        uint8_t getFieldSize(const std::size_t& iField) const;
+        TFieldMask getAllFieldsMask() const;
+        bool hasSameSchema(const PgeSnapshot& other) const;
+
+        /**
+        * Sets the given field of the given entity. The entity is added with all fields being zero if it does not exist yet.
+        *
+        * @param entityId The entity.
+        * @param iField   Index of the field.
+        * @param value    The value, size of its type must be equal to the size defined for the field.
+        *
+        * @return True on success, false if field index is out of range or size of value type mismatches the field size.
+        */
+        template <typename T>
+        bool setField(const TEntityId& entityId, const std::size_t& iField, const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Snapshot field must be trivially copyable!");
+            return setFieldBytes(entityId, iField, &value, sizeof(T));
+        }
+
+        /**
+        * Sets the given field of the given entity to the new (current) value of the given PgeOldNewValue.
+        * Since fields keep their values until changed, it is enough to invoke this only if the given value isDirty().
+        */
+        template <typename T>
+        bool setField(const TEntityId& entityId, const std::size_t& iField, const PgeOldNewValue<T>& value)
+        {
+            return setField(entityId, iField, value.getNew());
+        }
+
+        /**
+        * Gets the given field of the given entity.
+        *
+        * @param entityId The entity.
+        * @param iField   Index of the field.
+        * @param value    Output, the value of the field, unchanged on failure.
+        *
+        * @return True on success, false if entity does not exist, field index is out of range or size of value type mismatches the field size.
+        */
+        template <typename T>
+        bool getField(const TEntityId& entityId, const std::size_t& iField, T& value) const
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Snapshot field must be trivially copyable!");
+            return getFieldBytes(entityId, iField, &value, sizeof(T));
+        }
+
+        bool hasEntity(const TEntityId& entityId) const;
+        bool removeEntity(const TEntityId& entityId);
+        void clear();
+
+        const std::vector<Entity>& getEntities() const;
+        const Entity* getEntity(const TEntityId& entityId) const;
+        Entity& getOrAddEntity(const TEntityId& entityId);
+
+        TFieldMask getChangedFieldsMask(const Entity& entityOld, const Entity& entityNew) const;
+        bool isEqualState(const PgeSnapshot& other) const;
+
+    private:
+
+        std::array<uint8_t, nMaxFieldCount> m_nFieldSizes;
+        std::size_t m_nFieldCount;
+        TSequence m_seq;
+        std::vector<Entity> m_vEntities;  /**< Sorted by id. */
+
+        bool setFieldBytes(const TEntityId& entityId, const std::size_t& iField, const void* pValue, const std::size_t& nSize);
+        bool getFieldBytes(const TEntityId& entityId, const std::size_t& iField, void* pValue, const std::size_t& nSize) const;
+
+    }; // class PgeSnapshot
+
+    /**
+        Header of each snapshot app message sent by PgeSnapshotSender.
+        A snapshot might not fit into a single app message, in such case it is split into multiple parts, each part
+        being a separate app message with this header, followed by entity records.
+
+        Entity record: TEntityId, TFieldMask, then the bytes of each field present in the mask, in order of field index.
+        An empty mask means the entity is removed since the baseline.
+    */
+    struct MsgSnapshotPartHeader
+    {
+        PgeSnapshot::TSequence m_seq;          /**< Sequence number of this snapshot. */
+        PgeSnapshot::TSequence m_seqBaseline;  /**< Sequence number of snapshot this is delta-encoded against, 0 means full snapshot. */
+        uint8_t m_iPart;
+        uint8_t m_nPartCount;
+    };
+    static_assert(std::is_trivial_v<MsgSnapshotPartHeader>);
+    static_assert(std::is_trivially_copyable_v<MsgSnapshotPartHeader>);
+    static_assert(std::is_standard_layout_v<MsgSnapshotPartHeader>);
+
+    /**
+        App message sent by PgeSnapshotReceiver when all parts of a snapshot have been received.
+    */
+    struct MsgSnapshotAck
+    {
+        PgeSnapshot::TSequence m_seq;
+    };
+    static_assert(std::is_trivial_v<MsgSnapshotAck>);
+    static_assert(std::is_trivially_copyable_v<MsgSnapshotAck>);
+    static_assert(std::is_standard_layout_v<MsgSnapshotAck>);
+
+} // namespace pge_network
@@ -0,0 +1,439 @@
+/*
+    ###################################################################################
+    PgeSnapshotInterpolator.cpp
+    This file is part of PGE.
+    PR00F's Game Engine client-side snapshot interpolation with adaptive jitter buffer
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgeSnapshotInterpolator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace pge_network {
+
+    static constexpr PgeSnapshotInterpolator::TTimeUSecs nUpdateIntervalSmoothingDivisor = 8;
+
+    static float lerp(const float& fFrom, const float& fTo, const float& t)
+    {
+        return fFrom + (fTo - fFrom) * t;
+    }
+
+    /**
+        @param nMinDelayUSecs         Interpolation delay never goes below this, must not be negative.
+        @param nMaxDelayUSecs         Interpolation delay never goes above this, must not be less than nMinDelayUSecs.
+                                      This bounds how much in the past entities are rendered even on a very bad network.
+        @param nMaxExtrapolationUSecs Entities are extrapolated at most this far after their last update, must not be negative.
+
+        Throws std::runtime_error if any parameter is invalid.
+    */
+    PgeSnapshotInterpolator::PgeSnapshotInterpolator(
+        const TTimeUSecs& nMinDelayUSecs,
+        const TTimeUSecs& nMaxDelayUSecs,
+        const TTimeUSecs& nMaxExtrapolationUSecs) noexcept(false) :
+        m_nMinDelayUSecs(nMinDelayUSecs),
+        m_nMaxDelayUSecs(nMaxDelayUSecs),
+        m_nMaxExtrapolationUSecs(nMaxExtrapolationUSecs),
+        m_nTransitCount(0),
+        m_iNextTransit(0),
+        m_nLastServerTimeUSecs(0),
+        m_nUpdateIntervalUSecs(0),
+        m_nOffsetUSecs(0),
+        m_nLastLocalTimeUSecs(0),
+        m_nRenderTimeUSecs(0),
+        m_bStarted(false),
+        m_nLateSnapshotCount(0)
+    {
+        if ((nMinDelayUSecs < 0) || (nMaxDelayUSecs < nMinDelayUSecs) || (nMaxExtrapolationUSecs < 0))
+        {
+            throw std::runtime_error("PgeSnapshotInterpolator(): delays and max extrapolation must not be negative, max delay must not be less than min delay!");
+        }
+        m_transits.fill(0);
+    }
+
+    const PgeSnapshotInterpolator::TTimeUSecs& PgeSnapshotInterpolator::getMinDelayUSecs() const
+    {
+        return m_nMinDelayUSecs;
+    }
+
+    const PgeSnapshotInterpolator::TTimeUSecs& PgeSnapshotInterpolator::getMaxDelayUSecs() const
+    {
+        return m_nMaxDelayUSecs;
+    }
+
+    const PgeSnapshotInterpolator::TTimeUSecs& PgeSnapshotInterpolator::getMaxExtrapolationUSecs() const
+    {
+        return m_nMaxExtrapolationUSecs;
+    }
+
+    /**
+        Registers the arrival of a server update, to be invoked once per received update, before or after setEntityState() of its entities.
+        Only timing is recorded here, used for measuring update interval and jitter.
+
+        @param nServerTimeUSecs Server-side time of the update, e.g. server tick multiplied by tick duration, sent in the update.
+        @param nLocalTimeUSecs  Local time when the update was received, same clock as given to update().
+    */
+    void PgeSnapshotInterpolator::addSnapshot(const TTimeUSecs& nServerTimeUSecs, const TTimeUSecs& nLocalTimeUSecs)
+    {
+        if (m_bStarted && (nServerTimeUSecs < m_nRenderTimeUSecs))
+        {
+            // arrived after it was needed, delay is too small for this network
+            ++m_nLateSnapshotCount;
+        }
+
+        if (m_nTransitCount > 0)
+        {
+            if (nServerTimeUSecs <= m_nLastServerTimeUSecs)
+            {
+                // duplicate or out of order, it would disturb interval measurement
+                return;
+            }
+
+            const TTimeUSecs nInterval = nServerTimeUSecs - m_nLastServerTimeUSecs;
+            m_nUpdateIntervalUSecs = (m_nUpdateIntervalUSecs == 0) ?
+                nInterval :
+                (m_nUpdateIntervalUSecs + (nInterval - m_nUpdateIntervalUSecs) / nUpdateIntervalSmoothingDivisor);
+        }
+
+        m_transits[m_iNextTransit] = nLocalTimeUSecs - nServerTimeUSecs;
+        m_iNextTransit = (m_iNextTransit + 1) % nJitterWindowSize;
+        m_nTransitCount = std::min(m_nTransitCount + 1, nJitterWindowSize);
+        m_nLastServerTimeUSecs = nServerTimeUSecs;
+    }
+
+    /**
+        Buffers the state of the given entity in a server update. The entity is added if not yet buffered.
+        States older than the newest buffered state of the entity are ignored, a state with the same time replaces it.
+
+        @param entityId         The entity.
+        @param nServerTimeUSecs Server-side time of the update, same as given to addSnapshot().
+        @param state            State of the entity in the update.
+        @param bTeleported      If true, earlier states of the entity are dropped, so it is not interpolated from its previous
+                                position, e.g. when respawning.
+    */
+    void PgeSnapshotInterpolator::setEntityState(
+        const TEntityId& entityId,
+        const TTimeUSecs& nServerTimeUSecs,
+        const EntityState& state,
+        const bool& bTeleported)
+    {
+        auto it = findEntity(entityId);
+        if ((it == m_vEntities.end()) || (it->m_id != entityId))
+        {
+            it = m_vEntities.insert(it, Entity());
+            it->m_id = entityId;
+            it->m_iOldest = 0;
+            it->m_nSampleCount = 0;
+        }
+
+        Entity& entity = *it;
+        if (bTeleported)
+        {
+            entity.m_iOldest = 0;
+            entity.m_nSampleCount = 0;
+        }
+
+        if (entity.m_nSampleCount > 0)
+        {
+            Sample& sampleNewest = entity.m_samples[(entity.m_iOldest + entity.m_nSampleCount - 1) % nMaxSamplesPerEntity];
+            if (nServerTimeUSecs < sampleNewest.m_nServerTimeUSecs)
+            {
+                return;
+            }
+            if (nServerTimeUSecs == sampleNewest.m_nServerTimeUSecs)
+            {
+                sampleNewest.m_state = state;
+                return;
+            }
+        }
+
+        std::size_t iSample;
+        if (entity.m_nSampleCount < nMaxSamplesPerEntity)
+        {
+            iSample = (entity.m_iOldest + entity.m_nSampleCount) % nMaxSamplesPerEntity;
+            ++entity.m_nSampleCount;
+        }
+        else
+        {
+            iSample = entity.m_iOldest;
+            entity.m_iOldest = (entity.m_iOldest + 1) % nMaxSamplesPerEntity;
+        }
+        entity.m_samples[iSample].m_nServerTimeUSecs = nServerTimeUSecs;
+        entity.m_samples[iSample].m_state = state;
+    }
+
+    /**
+        @return True if the entity was buffered, false otherwise.
+    */
+    bool PgeSnapshotInterpolator::removeEntity(const TEntityId& entityId)
+    {
+        const auto it = findEntity(entityId);
+        if ((it == m_vEntities.end()) || (it->m_id != entityId))
+        {
+            return false;
+        }
+        m_vEntities.erase(it);
+        return true;
+    }
+
+    bool PgeSnapshotInterpolator::hasEntity(const TEntityId& entityId) const
+    {
+        const auto it = findEntity(entityId);
+        return (it != m_vEntities.end()) && (it->m_id == entityId);
+    }
+
+    std::size_t PgeSnapshotInterpolator::getEntityCount() const
+    {
+        return m_vEntities.size();
+    }
+
+    /**
+        Drops all entities and timing measurements, e.g. when connecting to a server, so the buffer starts over.
+        Late snapshot count is kept.
+    */
+    void PgeSnapshotInterpolator::clear()
+    {
+        m_vEntities.clear();
+        m_transits.fill(0);
+        m_nTransitCount = 0;
+        m_iNextTransit = 0;
+        m_nLastServerTimeUSecs = 0;
+        m_nUpdateIntervalUSecs = 0;
+        m_nOffsetUSecs = 0;
+        m_nLastLocalTimeUSecs = 0;
+        m_nRenderTimeUSecs = 0;
+        m_bStarted = false;
+    }
+
+    /**
+        Advances render time, to be invoked every frame before getEntityState().
+        Does nothing until 2 server updates are added, since the update interval, thus the delay, is not known before.
+        At the first invocation the delay is set to its target right away, later it is adjusted gradually.
+
+        @param nLocalTimeUSecs Current local time, same clock as given to addSnapshot().
+    */
+    void PgeSnapshotInterpolator::update(const TTimeUSecs& nLocalTimeUSecs)
+    {
+        if (m_nTransitCount < 2)
+        {
+            return;
+        }
+
+        const TTimeUSecs nTargetOffsetUSecs = getFastestTransitUSecs() + getTargetDelayUSecs();
+        if (!m_bStarted)
+        {
+            m_nOffsetUSecs = nTargetOffsetUSecs;
+            m_bStarted = true;
+        }
+        else
+        {
+            const TTimeUSecs nMaxStepUSecs = std::max(static_cast<TTimeUSecs>(0), nLocalTimeUSecs - m_nLastLocalTimeUSecs) * nDelayAdjustPercent / 100;
+            m_nOffsetUSecs += std::clamp(nTargetOffsetUSecs - m_nOffsetUSecs, -nMaxStepUSecs, nMaxStepUSecs);
+        }
+        m_nLastLocalTimeUSecs = nLocalTimeUSecs;
+        m_nRenderTimeUSecs = nLocalTimeUSecs - m_nOffsetUSecs;
+    }
+
+    /**
+        Gets the state of the given entity at current render time.
+
+        @return How the state was computed. In case of Result::None, state is untouched.
+    */
+    PgeSnapshotInterpolator::Result PgeSnapshotInterpolator::getEntityState(const TEntityId& entityId, EntityState& state) const
+    {
+        const auto it = findEntity(entityId);
+        if ((it == m_vEntities.end()) || (it->m_id != entityId) || (it->m_nSampleCount == 0))
+        {
+            return Result::None;
+        }
+
+        const Entity& entity = *it;
+        const Sample& sampleOldest = getSample(entity, 0);
+        if (m_nRenderTimeUSecs < sampleOldest.m_nServerTimeUSecs)
+        {
+            state = sampleOldest.m_state;
+            return Result::Held;
+        }
+
+        const Sample* pSampleFrom;
+        const Sample* pSampleTo;
+        float t;
+        Result result = Result::Interpolated;
+        const Sample& sampleNewest = getSample(entity, entity.m_nSampleCount - 1);
+        if (m_nRenderTimeUSecs <= sampleNewest.m_nServerTimeUSecs)
+        {
+            if (entity.m_nSampleCount == 1)
+            {
+                // render time is exactly at the only sample
+                state = sampleNewest.m_state;
+                return Result::Interpolated;
+            }
+
+            // searching from the newest since render time is normally near the newest samples
+            std::size_t i = entity.m_nSampleCount - 1;
+            while (getSample(entity, i - 1).m_nServerTimeUSecs > m_nRenderTimeUSecs)
+            {
+                --i;
+            }
+            pSampleFrom = &getSample(entity, i - 1);
+            pSampleTo = &getSample(entity, i);
+            t = static_cast<float>(m_nRenderTimeUSecs - pSampleFrom->m_nServerTimeUSecs) /
+                static_cast<float>(pSampleTo->m_nServerTimeUSecs - pSampleFrom->m_nServerTimeUSecs);
+        }
+        else
+        {
+            TTimeUSecs nAheadUSecs = m_nRenderTimeUSecs - sampleNewest.m_nServerTimeUSecs;
+            if (nAheadUSecs > m_nMaxExtrapolationUSecs)
+            {
+                nAheadUSecs = m_nMaxExtrapolationUSecs;
+                result = Result::Held;
+            }
+            else
+            {
+                result = Result::Extrapolated;
+            }
+
+            if ((entity.m_nSampleCount < 2) || (nAheadUSecs == 0))
+            {
+                state = sampleNewest.m_state;
+                return (entity.m_nSampleCount < 2) ? Result::Held : result;
+            }
+
+            pSampleFrom = &getSample(entity, entity.m_nSampleCount - 2);
+            pSampleTo = &sampleNewest;
+            t = 1.f + static_cast<float>(nAheadUSecs) /
+                static_cast<float>(pSampleTo->m_nServerTimeUSecs - pSampleFrom->m_nServerTimeUSecs);
+        }
+
+        const EntityState& from = pSampleFrom->m_state;
+        const EntityState& to = pSampleTo->m_state;
+        state.m_x = lerp(from.m_x, to.m_x, t);
+        state.m_y = lerp(from.m_y, to.m_y, t);
+        state.m_z = lerp(from.m_z, to.m_z, t);
+        state.m_fAngleX = lerpAngle(from.m_fAngleX, to.m_fAngleX, t);
+        state.m_fAngleY = lerpAngle(from.m_fAngleY, to.m_fAngleY, t);
+        state.m_fAngleZ = lerpAngle(from.m_fAngleZ, to.m_fAngleZ, t);
+        return result;
+    }
+
+    /**
+        @return True if update() has been invoked since 2 server updates were added, i.e. render time is valid.
+    */
+    bool PgeSnapshotInterpolator::isReady() const
+    {
+        return m_bStarted;
+    }
+
+    /**
+        @return Server time at which entities are currently rendered.
+    */
+    PgeSnapshotInterpolator::TTimeUSecs PgeSnapshotInterpolator::getRenderTimeUSecs() const
+    {
+        return m_nRenderTimeUSecs;
+    }
+
+    /**
+        @return Current interpolation delay: how much render time is behind the server time of an update arriving with the fastest recent transit time.
+    */
+    PgeSnapshotInterpolator::TTimeUSecs PgeSnapshotInterpolator::getDelayUSecs() const
+    {
+        return m_bStarted ? (m_nOffsetUSecs - getFastestTransitUSecs()) : 0;
+    }
+
+    /**
+        @return Delay the current delay is being adjusted to: update interval plus jitter, clamped between minimum and maximum delay.
+    */
+    PgeSnapshotInterpolator::TTimeUSecs PgeSnapshotInterpolator::getTargetDelayUSecs() const
+    {
+        return std::clamp(m_nUpdateIntervalUSecs + getJitterUSecs(), m_nMinDelayUSecs, m_nMaxDelayUSecs);
+    }
+
+    /**
+        @return Difference between the slowest and fastest transit time of recent updates.
+    */
+    PgeSnapshotInterpolator::TTimeUSecs PgeSnapshotInterpolator::getJitterUSecs() const
+    {
+        if (m_nTransitCount == 0)
+        {
+            return 0;
+        }
+        const auto itBegin = m_transits.begin();
+        const auto itEnd = m_transits.begin() + m_nTransitCount;
+        return *std::max_element(itBegin, itEnd) - *std::min_element(itBegin, itEnd);
+    }
+
+    /**
+        @return Smoothed server time between consecutive updates, 0 until 2 updates are added.
+    */
+    PgeSnapshotInterpolator::TTimeUSecs PgeSnapshotInterpolator::getUpdateIntervalUSecs() const
+    {
+        return m_nUpdateIntervalUSecs;
+    }
+
+    /**
+        @return Number of updates arrived when render time was already past their server time. If this keeps increasing,
+                the maximum delay is too small for the network.
+    */
+    uint32_t PgeSnapshotInterpolator::getLateSnapshotCount() const
+    {
+        return m_nLateSnapshotCount;
+    }
+
+
+    // ############################## PRIVATE ##############################
+
+
+    /**
+        Interpolates along the shorter arc, t outside [0, 1] extrapolates. Result is in range [0, 360).
+    */
+    float PgeSnapshotInterpolator::lerpAngle(const float& fFrom, const float& fTo, const float& t)
+    {
+        float fDiff = std::fmod(fTo - fFrom, 360.f);
+        if (fDiff > 180.f)
+        {
+            fDiff -= 360.f;
+        }
+        else if (fDiff < -180.f)
+        {
+            fDiff += 360.f;
+        }
+
+        float fAngle = std::fmod(fFrom + fDiff * t, 360.f);
+        if (fAngle < 0.f)
+        {
+            fAngle += 360.f;
+        }
+        return fAngle;
+    }
+
+    std::vector<PgeSnapshotInterpolator::Entity>::iterator PgeSnapshotInterpolator::findEntity(const TEntityId& entityId)
+    {
+        return std::lower_bound(m_vEntities.begin(), m_vEntities.end(), entityId,
+            [](const Entity& entity, const TEntityId& id) { return entity.m_id < id; });
+    }
+
+    std::vector<PgeSnapshotInterpolator::Entity>::const_iterator PgeSnapshotInterpolator::findEntity(const TEntityId& entityId) const
+    {
+        return std::lower_bound(m_vEntities.begin(), m_vEntities.end(), entityId,
+            [](const Entity& entity, const TEntityId& id) { return entity.m_id < id; });
+    }
+
+    PgeSnapshotInterpolator::TTimeUSecs PgeSnapshotInterpolator::getFastestTransitUSecs() const
+    {
+        return *std::min_element(m_transits.begin(), m_transits.begin() + m_nTransitCount);
+    }
+
+    /**
+        @return The i-th buffered sample of the given entity, 0 being the oldest.
+    */
+    const PgeSnapshotInterpolator::Sample& PgeSnapshotInterpolator::getSample(const Entity& entity, const std::size_t& i) const
+    {
+        return entity.m_samples[(entity.m_iOldest + i) % nMaxSamplesPerEntity];
+    }
+
+} // namespace pge_network
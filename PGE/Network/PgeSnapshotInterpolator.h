@@ -0,0 +1,154 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeSnapshotInterpolator.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine client-side snapshot interpolation with adaptive jitter buffer
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "PgeSnapshot.h"
+
+namespace pge_network
+{
+
+    /**
+        Client-side jitter buffer for server updates: instead of applying each received update right away, the client renders
+        entities a bit in the past, interpolating between the 2 buffered updates around that moment, so motion stays smooth even with
+        low server update rate and irregular arrival of updates.
+
+        The application gives each received server update with its server-side timestamp and local receive time to addSnapshot(),
+        and the state of each entity in that update to setEntityState(). Then every frame it invokes update() with the local time, and
+        gets the state of each entity to be rendered by getEntityState(). Render time is available after 2 updates, see isReady().
+
+        Render time is server time delayed by the transit time of the fastest recent update plus the interpolation delay.
+        The delay adapts to the network: it targets the measured update interval plus jitter, i.e. the spread of transit times of
+        recent updates, so the next update is normally already buffered when it is needed, clamped between the configured minimum
+        and maximum delay. The delay changes gradually, render time always moves forward and at most a few percent faster or slower
+        than real time, so adapting is not visible as a jump.
+
+        When no newer update is buffered for an entity, its state is extrapolated from its last 2 updates, but not further than the
+        configured maximum extrapolation time, after that it is held at its extrapolated state.
+
+        Entity ids are the same as in PgeSnapshot. Positions are in world space, angles are in degrees, interpolated along the shorter
+        arc and returned in range [0, 360).
+    */
+    class PgeSnapshotInterpolator
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeSnapshotInterpolator is included")
+#endif
+
+    public:
+
+        typedef PgeSnapshot::TEntityId TEntityId;
+        typedef int64_t TTimeUSecs;
+
+        static constexpr std::size_t nMaxSamplesPerEntity = 16;   /**< Updates buffered per entity, oldest are overwritten. */
+        static constexpr std::size_t nJitterWindowSize = 32;      /**< Jitter and fastest transit time are measured over this many last updates. */
+        static constexpr TTimeUSecs nDelayAdjustPercent = 5;      /**< Render time runs at most this much faster or slower than real time. */
+
+        struct EntityState
+        {
+            float m_x, m_y, m_z;
+            float m_fAngleX, m_fAngleY, m_fAngleZ;
+        };
+
+        enum class Result : uint8_t
+        {
+            None = 0,       /**< No state of the entity is buffered. */
+            Interpolated,   /**< Render time is between 2 buffered updates. */
+            Extrapolated,   /**< Render time is after the last buffered update, within maximum extrapolation time. */
+            Held            /**< Render time is before the first or too far after the last buffered update, nearest state is returned. */
+        };
+
+        // ---------------------------------------------------------------------------
+
+        PgeSnapshotInterpolator(
+            const TTimeUSecs& nMinDelayUSecs,
+            const TTimeUSecs& nMaxDelayUSecs,
+            const TTimeUSecs& nMaxExtrapolationUSecs) noexcept(false);
+        ~PgeSnapshotInterpolator() = default;
+
+        PgeSnapshotInterpolator(const PgeSnapshotInterpolator&) = delete;
+        PgeSnapshotInterpolator& operator=(const PgeSnapshotInterpolator&) = delete;
+        PgeSnapshotInterpolator(PgeSnapshotInterpolator&&) = delete;
+        PgeSnapshotInterpolator& operator=(PgeSnapshotInterpolator&&) = delete;
+
+        const TTimeUSecs& getMinDelayUSecs() const;
+        const TTimeUSecs& getMaxDelayUSecs() const;
+        const TTimeUSecs& getMaxExtrapolationUSecs() const;
+
+        void addSnapshot(const TTimeUSecs& nServerTimeUSecs, const TTimeUSecs& nLocalTimeUSecs);
+        void setEntityState(
+            const TEntityId& entityId,
+            const TTimeUSecs& nServerTimeUSecs,
+            const EntityState& state,
+            const bool& bTeleported = false);
+        bool removeEntity(const TEntityId& entityId);
+        bool hasEntity(const TEntityId& entityId) const;
+        std::size_t getEntityCount() const;
+        void clear();
+
+        void update(const TTimeUSecs& nLocalTimeUSecs);
+        Result getEntityState(const TEntityId& entityId, EntityState& state) const;
+
+        bool isReady() const;
+        TTimeUSecs getRenderTimeUSecs() const;
+        TTimeUSecs getDelayUSecs() const;
+        TTimeUSecs getTargetDelayUSecs() const;
+        TTimeUSecs getJitterUSecs() const;
+        TTimeUSecs getUpdateIntervalUSecs() const;
+        uint32_t getLateSnapshotCount() const;
+
+    private:
+
+        struct Sample
+        {
+            TTimeUSecs m_nServerTimeUSecs;
+            EntityState m_state;
+        };
+
+        struct Entity
+        {
+            TEntityId m_id;
+            std::array<Sample, nMaxSamplesPerEntity> m_samples;  /**< Ring buffer in increasing server time order. */
+            std::size_t m_iOldest;
+            std::size_t m_nSampleCount;
+        };
+
+        const TTimeUSecs m_nMinDelayUSecs;
+        const TTimeUSecs m_nMaxDelayUSecs;
+        const TTimeUSecs m_nMaxExtrapolationUSecs;
+
+        std::vector<Entity> m_vEntities;                          /**< Sorted by id. */
+        std::array<TTimeUSecs, nJitterWindowSize> m_transits;     /**< Local receive time - server time of last updates, ring buffer. */
+        std::size_t m_nTransitCount;
+        std::size_t m_iNextTransit;
+        TTimeUSecs m_nLastServerTimeUSecs;                        /**< Of the newest update, valid if m_nTransitCount is positive. */
+        TTimeUSecs m_nUpdateIntervalUSecs;                        /**< Smoothed server time between updates. */
+        TTimeUSecs m_nOffsetUSecs;                                /**< Local time - render time, i.e. fastest transit time + delay. */
+        TTimeUSecs m_nLastLocalTimeUSecs;                         /**< Of last update(). */
+        TTimeUSecs m_nRenderTimeUSecs;
+        bool m_bStarted;                                          /**< update() has been invoked since 2 updates were added. */
+        uint32_t m_nLateSnapshotCount;
+
+        static float lerpAngle(const float& fFrom, const float& fTo, const float& t);
+
+        std::vector<Entity>::iterator findEntity(const TEntityId& entityId);
+        std::vector<Entity>::const_iterator findEntity(const TEntityId& entityId) const;
+        TTimeUSecs getFastestTransitUSecs() const;
+        const Sample& getSample(const Entity& entity, const std::size_t& i) const;
+
+    }; // class PgeSnapshotInterpolator
+
+} // namespace pge_network
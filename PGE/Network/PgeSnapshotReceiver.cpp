@@ -0,0 +1,287 @@
+/*
+    ###################################################################################
+    PgeSnapshotReceiver.cpp
+    This file is part of PGE.
+    PR00F's Game Engine delta-compressed snapshot receiver
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgeSnapshotReceiver.h"
+
+#include <stdexcept>
+
+namespace pge_network {
+
+    /**
+        @param vFieldSizes   Schema of the snapshot, see PgeSnapshot. Must be the same as given to PgeSnapshotSender on server side.
+        @param msgIdSnapshot App message id used by PgeSnapshotSender for sending snapshot parts.
+        @param msgIdAck      App message id to be used for sending acknowledgements.
+                             Throws std::runtime_error if equals to msgIdSnapshot.
+    */
+    PgeSnapshotReceiver::PgeSnapshotReceiver(
+        const std::vector<uint8_t>& vFieldSizes,
+        const MsgApp::TMsgId& msgIdSnapshot,
+        const MsgApp::TMsgId& msgIdAck) noexcept(false) :
+        m_msgIdSnapshot(msgIdSnapshot),
+        m_msgIdAck(msgIdAck),
+        m_vHistory(PgeSnapshot::nHistorySize, PgeSnapshot(vFieldSizes)),
+        m_seqLatest(0),
+        m_pending(vFieldSizes),
+        m_seqPendingBaseline(0),
+        m_nPendingPartCount(0),
+        m_nPendingPartsReceived(0),
+        m_seqUndecodable(0),
+        m_nDroppedSnapshotCount(0)
+    {
+        if (msgIdSnapshot == msgIdAck)
+        {
+            throw std::runtime_error("PgeSnapshotReceiver(): snapshot and ack app message ids must differ!");
+        }
+    }
+
+    const MsgApp::TMsgId& PgeSnapshotReceiver::getMsgIdSnapshot() const
+    {
+        return m_msgIdSnapshot;
+    }
+
+    const MsgApp::TMsgId& PgeSnapshotReceiver::getMsgIdAck() const
+    {
+        return m_msgIdAck;
+    }
+
+    /**
+        Processes the given packet if it carries a snapshot part sent by PgeSnapshotSender.
+        When the last missing part of a snapshot is processed, the snapshot becomes the latest snapshot and an acknowledgement is sent.
+
+        @param client The client instance to be used for sending the acknowledgement.
+        @param pkt    The received packet.
+
+        @return True if the given packet is a snapshot part, even if it is ignored, false otherwise.
+    */
+    bool PgeSnapshotReceiver::handleSnapshotPkt(PgeIServerClient& client, const PgePacket& pkt)
+    {
+        if ((PgePacket::getPacketId(pkt) != PgePktId::Application) || (PgePacket::getMsgAppIdFromPkt(pkt) != m_msgIdSnapshot))
+        {
+            return false;
+        }
+
+        const MsgApp& msgApp = *PgePacket::getMsgAppFromPkt(pkt);
+        const std::size_t nSize = MsgApp::getMsgAppDataActualSizeBytes(msgApp);
+        if (nSize < sizeof(MsgSnapshotPartHeader))
+        {
+            CConsole::getConsoleInstance("PgeSnapshotReceiver").EOLn("%s: invalid part size %u!", __func__, static_cast<unsigned>(nSize));
+            return true;
+        }
+
+        MsgSnapshotPartHeader header;
+        memcpy(&header, MsgApp::getMsgAppData(msgApp), sizeof(header));
+        if ((header.m_seq == 0) || (header.m_seqBaseline >= header.m_seq) || (header.m_iPart >= header.m_nPartCount))
+        {
+            CConsole::getConsoleInstance("PgeSnapshotReceiver").EOLn("%s: invalid part header!", __func__);
+            return true;
+        }
+
+        if ((header.m_seq <= m_seqLatest) || (header.m_seq <= m_seqUndecodable) || (header.m_seq < m_pending.getSequence()))
+        {
+            // older than what we already have or are assembling, or a duplicate
+            return true;
+        }
+
+        if (header.m_seq > m_pending.getSequence())
+        {
+            if (m_pending.getSequence() != 0)
+            {
+                abandonPending();
+            }
+            if (!beginPending(header))
+            {
+                // baseline is not in our history anymore, server will send a full snapshot when it learns our last ack is too old
+                m_seqUndecodable = header.m_seq;
+                ++m_nDroppedSnapshotCount;
+                return true;
+            }
+        }
+
+        if ((header.m_seqBaseline != m_seqPendingBaseline) || (header.m_nPartCount != m_nPendingPartCount))
+        {
+            CConsole::getConsoleInstance("PgeSnapshotReceiver").EOLn("%s: part header inconsistent with previous parts of snapshot %u!", __func__, header.m_seq);
+            m_seqUndecodable = header.m_seq;
+            abandonPending();
+            return true;
+        }
+
+        if (m_pendingPartsReceived.test(header.m_iPart))
+        {
+            return true;
+        }
+
+        if (!applyPart(MsgApp::getMsgAppData(msgApp) + sizeof(header), nSize - sizeof(header)))
+        {
+            CConsole::getConsoleInstance("PgeSnapshotReceiver").EOLn("%s: malformed part %u of snapshot %u!", __func__, header.m_iPart, header.m_seq);
+            m_seqUndecodable = header.m_seq;
+            abandonPending();
+            return true;
+        }
+
+        m_pendingPartsReceived.set(header.m_iPart);
+        ++m_nPendingPartsReceived;
+        if (m_nPendingPartsReceived == m_nPendingPartCount)
+        {
+            m_seqLatest = m_pending.getSequence();
+            m_vHistory[m_seqLatest % PgeSnapshot::nHistorySize] = m_pending;
+            m_pending.setSequence(0);
+            sendAck(client, m_seqLatest);
+        }
+
+        return true;
+    }
+
+    /**
+        @return The latest completely received snapshot. Its sequence number is 0 if no snapshot has been received yet.
+    */
+    const PgeSnapshot& PgeSnapshotReceiver::getLatestSnapshot() const
+    {
+        return m_vHistory[m_seqLatest % PgeSnapshot::nHistorySize];
+    }
+
+    /**
+        @return Sequence number of the latest completely received snapshot, 0 if none.
+    */
+    const PgeSnapshot::TSequence& PgeSnapshotReceiver::getLatestSequence() const
+    {
+        return m_seqLatest;
+    }
+
+    /**
+        @return Number of snapshots that could not be assembled, due to lost parts, missing baseline or malformed data.
+    */
+    uint32_t PgeSnapshotReceiver::getDroppedSnapshotCount() const
+    {
+        return m_nDroppedSnapshotCount;
+    }
+
+    /**
+        @return The snapshot with the given sequence number from the history, or nullptr if it is not there anymore.
+    */
+    const PgeSnapshot* PgeSnapshotReceiver::findHistorySnapshot(const PgeSnapshot::TSequence& seq) const
+    {
+        if (seq == 0)
+        {
+            return nullptr;
+        }
+
+        const PgeSnapshot& snapshot = m_vHistory[seq % PgeSnapshot::nHistorySize];
+        return (snapshot.getSequence() == seq) ? &snapshot : nullptr;
+    }
+
+    /**
+        Starts assembling the snapshot described by the given header, from its baseline or from scratch if it is a full snapshot.
+
+        @return True on success, false if the baseline is not available.
+    */
+    bool PgeSnapshotReceiver::beginPending(const MsgSnapshotPartHeader& header)
+    {
+        if (header.m_seqBaseline == 0)
+        {
+            m_pending.clear();
+        }
+        else
+        {
+            const PgeSnapshot* const pBaseline = findHistorySnapshot(header.m_seqBaseline);
+            if (!pBaseline)
+            {
+                return false;
+            }
+            // copy-assignment reuses the already allocated entity vector
+            m_pending = *pBaseline;
+        }
+
+        m_pending.setSequence(header.m_seq);
+        m_seqPendingBaseline = header.m_seqBaseline;
+        m_nPendingPartCount = header.m_nPartCount;
+        m_nPendingPartsReceived = 0;
+        m_pendingPartsReceived.reset();
+        return true;
+    }
+
+    void PgeSnapshotReceiver::abandonPending()
+    {
+        m_pending.setSequence(0);
+        ++m_nDroppedSnapshotCount;
+    }
+
+    /**
+        Applies the entity records of a single part to the pending snapshot.
+
+        @return True on success, false if the records are malformed.
+    */
+    bool PgeSnapshotReceiver::applyPart(const TByte* pData, std::size_t nSize)
+    {
+        const PgeSnapshot::TFieldMask maskAllFields = m_pending.getAllFieldsMask();
+        while (nSize > 0)
+        {
+            PgeSnapshot::TEntityId entityId;
+            PgeSnapshot::TFieldMask mask;
+            if (nSize < sizeof(entityId) + sizeof(mask))
+            {
+                return false;
+            }
+            memcpy(&entityId, pData, sizeof(entityId));
+            pData += sizeof(entityId);
+            memcpy(&mask, pData, sizeof(mask));
+            pData += sizeof(mask);
+            nSize -= sizeof(entityId) + sizeof(mask);
+
+            if (mask == 0)
+            {
+                m_pending.removeEntity(entityId);
+                continue;
+            }
+
+            if ((mask & ~maskAllFields) != 0)
+            {
+                return false;
+            }
+
+            PgeSnapshot::Entity& entity = m_pending.getOrAddEntity(entityId);
+            for (std::size_t iField = 0; iField < m_pending.getFieldCount(); iField++)
+            {
+                if (mask & (1u << iField))
+                {
+                    const std::size_t nFieldSize = m_pending.getFieldSize(iField);
+                    if (nSize < nFieldSize)
+                    {
+                        return false;
+                    }
+                    memcpy(&(entity.m_fields[iField * PgeSnapshot::nMaxFieldSizeBytes]), pData, nFieldSize);
+                    pData += nFieldSize;
+                    nSize -= nFieldSize;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    void PgeSnapshotReceiver::sendAck(PgeIServerClient& client, const PgeSnapshot::TSequence& seq) const
+    {
+        PgePacket pkt;
+        // server overwrites the connection handle with the actual handle of this client upon receiving
+        PgePacket::initPktMsgApp(pkt, ServerConnHandle, PgePacket::AutoFill::NONE);
+        TByte* const pData = PgePacket::preparePktMsgAppFill(pkt, m_msgIdAck, sizeof(MsgSnapshotAck));
+        if (!pData)
+        {
+            CConsole::getConsoleInstance("PgeSnapshotReceiver").EOLn("%s: preparePktMsgAppFill() failed!", __func__);
+            return;
+        }
+
+        MsgSnapshotAck ack;
+        ack.m_seq = seq;
+        memcpy(pData, &ack, sizeof(ack));
+        client.send(pkt);
+    }
+
+} // namespace pge_network
@@ -0,0 +1,83 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeSnapshotReceiver.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine delta-compressed snapshot receiver
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <bitset>
+#include <vector>
+
+#include "PgeIServerClient.h"
+#include "PgePacket.h"
+#include "PgeSnapshot.h"
+
+namespace pge_network
+{
+
+    /**
+        Client-side part of snapshot replication, the server-side counterpart is PgeSnapshotSender.
+
+        Reassembles snapshots from their parts, decodes them against the baseline snapshot they were encoded against,
+        and acknowledges each completely received snapshot to the server.
+        Only the newest snapshot is assembled at a time: parts of older snapshots are ignored, and an incomplete snapshot
+        is abandoned when a part of a newer snapshot arrives.
+    */
+    class PgeSnapshotReceiver
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeSnapshotReceiver is included")
+#endif
+
+    public:
+
+        PgeSnapshotReceiver(
+            const std::vector<uint8_t>& vFieldSizes,
+            const MsgApp::TMsgId& msgIdSnapshot,
+            const MsgApp::TMsgId& msgIdAck) noexcept(false);
+        ~PgeSnapshotReceiver() = default;
+
+        PgeSnapshotReceiver(const PgeSnapshotReceiver&) = delete;
+        PgeSnapshotReceiver& operator=(const PgeSnapshotReceiver&) = delete;
+        PgeSnapshotReceiver(PgeSnapshotReceiver&&) = delete;
+        PgeSnapshotReceiver& operator=(PgeSnapshotReceiver&&) = delete;
+
+        const MsgApp::TMsgId& getMsgIdSnapshot() const;
+        const MsgApp::TMsgId& getMsgIdAck() const;
+
+        bool handleSnapshotPkt(PgeIServerClient& client, const PgePacket& pkt);
+
+        const PgeSnapshot& getLatestSnapshot() const;
+        const PgeSnapshot::TSequence& getLatestSequence() const;
+        uint32_t getDroppedSnapshotCount() const;
+
+    private:
+
+        const MsgApp::TMsgId m_msgIdSnapshot;
+        const MsgApp::TMsgId m_msgIdAck;
+        std::vector<PgeSnapshot> m_vHistory;      /**< Completely received snapshots, indexed by sequence % nHistorySize. */
+        PgeSnapshot::TSequence m_seqLatest;
+        PgeSnapshot m_pending;                    /**< Snapshot being assembled, its sequence is 0 if none. */
+        PgeSnapshot::TSequence m_seqPendingBaseline;
+        uint8_t m_nPendingPartCount;
+        std::size_t m_nPendingPartsReceived;
+        std::bitset<256> m_pendingPartsReceived;
+        PgeSnapshot::TSequence m_seqUndecodable;  /**< Newest snapshot whose baseline is not available, its parts are ignored. */
+        uint32_t m_nDroppedSnapshotCount;
+
+        const PgeSnapshot* findHistorySnapshot(const PgeSnapshot::TSequence& seq) const;
+        bool beginPending(const MsgSnapshotPartHeader& header);
+        void abandonPending();
+        bool applyPart(const TByte* pData, std::size_t nSize);
+        void sendAck(PgeIServerClient& client, const PgeSnapshot::TSequence& seq) const;
+
+    }; // class PgeSnapshotReceiver
+
+} // namespace pge_network
@@ -0,0 +1,419 @@
+/*
+    ###################################################################################
+    PgeSnapshotSender.cpp
+    This file is part of PGE.
+    PR00F's Game Engine delta-compressed snapshot sender
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+
+#include "PgeSnapshotSender.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace pge_network {
+
+    // a record of an entity having all its fields must fit into a part along with the part header
+    static_assert(
+        sizeof(MsgSnapshotPartHeader) + sizeof(PgeSnapshot::TEntityId) + sizeof(PgeSnapshot::TFieldMask) +
+        PgeSnapshot::nMaxFieldCount * PgeSnapshot::nMaxFieldSizeBytes <= MsgApp::nMaxMessageLengthBytes);
+
+    /**
+        @param vFieldSizes   Schema of the snapshot, see PgeSnapshot. Must be the same as given to PgeSnapshotReceiver on client side.
+        @param msgIdSnapshot App message id to be used for sending snapshot parts.
+        @param msgIdAck      App message id to be used by PgeSnapshotReceiver for sending acknowledgements.
+                             Throws std::runtime_error if equals to msgIdSnapshot.
+    */
+    PgeSnapshotSender::PgeSnapshotSender(
+        const std::vector<uint8_t>& vFieldSizes,
+        const MsgApp::TMsgId& msgIdSnapshot,
+        const MsgApp::TMsgId& msgIdAck) noexcept(false) :
+        m_msgIdSnapshot(msgIdSnapshot),
+        m_msgIdAck(msgIdAck),
+        m_snapshot(vFieldSizes),
+        m_vHistory(PgeSnapshot::nHistorySize, m_snapshot),
+        m_seqLastCommitted(0),
+        m_nPartCount(0),
+        m_nFullSnapshotSentCount(0),
+        m_nDeltaSnapshotSentCount(0)
+    {
+        if (msgIdSnapshot == msgIdAck)
+        {
+            throw std::runtime_error("PgeSnapshotSender(): snapshot and ack app message ids must differ!");
+        }
+    }
+
+    const MsgApp::TMsgId& PgeSnapshotSender::getMsgIdSnapshot() const
+    {
+        return m_msgIdSnapshot;
+    }
+
+    const MsgApp::TMsgId& PgeSnapshotSender::getMsgIdAck() const
+    {
+        return m_msgIdAck;
+    }
+
+    /**
+        @return The working snapshot to be updated by the application before invoking commitSnapshot().
+                Its content is kept after committing.
+    */
+    PgeSnapshot& PgeSnapshotSender::getSnapshot()
+    {
+        return m_snapshot;
+    }
+
+    /**
+        Stores a copy of the current state of the working snapshot in the history with a new sequence number,
+        making it the snapshot to be sent by sendSnapshot().
+
+        @return Sequence number of the committed snapshot.
+    */
+    PgeSnapshot::TSequence PgeSnapshotSender::commitSnapshot()
+    {
+        ++m_seqLastCommitted;
+        m_snapshot.setSequence(m_seqLastCommitted);
+        // copy-assignment reuses the already allocated entity vector of the overwritten history slot
+        m_vHistory[m_seqLastCommitted % PgeSnapshot::nHistorySize] = m_snapshot;
+        return m_seqLastCommitted;
+    }
+
+    /**
+        @return Sequence number of the last committed snapshot, 0 if nothing has been committed yet.
+    */
+    const PgeSnapshot::TSequence& PgeSnapshotSender::getLastCommittedSequence() const
+    {
+        return m_seqLastCommitted;
+    }
+
+    /**
+        Sends the last committed snapshot to the given client, delta-encoded against the last snapshot acknowledged by the client,
+        or full snapshot if there is no such snapshot in the history.
+        The snapshot is sent in as many app messages as needed, even if nothing changed since the baseline, so the client can
+        still acknowledge it.
+
+        If relevant entities are given, only those are sent, and the entities relevant to the client in the baseline but not anymore
+        are removed on the client side. The same committed snapshot should not be sent to the same client with different relevant
+        entities, since the client might acknowledge either of them.
+
+        @param server             The server instance to be used for sending.
+        @param connHandle         The client to send to.
+        @param pvRelevantEntities Sorted ids of the entities relevant to the client, e.g. PgeInterestManager::getRelevantEntities(),
+                                  or nullptr to send all entities.
+
+        @return True on success, false if nothing has been committed yet or the snapshot does not fit into 255 parts.
+    */
+    bool PgeSnapshotSender::sendSnapshot(
+        PgeIServerClient& server,
+        const PgeNetworkConnectionHandle& connHandle,
+        const std::vector<PgeSnapshot::TEntityId>* pvRelevantEntities)
+    {
+        const PgeSnapshot* const pSnapshot = findHistorySnapshot(m_seqLastCommitted);
+        if (!pSnapshot)
+        {
+            CConsole::getConsoleInstance("PgeSnapshotSender").EOLn("%s: no committed snapshot!", __func__);
+            return false;
+        }
+
+        // baseline can be used only if we still know which entities were sent in it to this client
+        Client& client = m_mapClients[connHandle];
+        const PgeSnapshot* pBaseline = findHistorySnapshot(client.m_seqAcked);
+        const SentSnapshot& sentBaseline = client.m_sentSnapshots[client.m_seqAcked % PgeSnapshot::nHistorySize];
+        if (pBaseline && (sentBaseline.m_seq != client.m_seqAcked))
+        {
+            pBaseline = nullptr;
+        }
+
+        if (!encodeParts(
+            pBaseline,
+            (pBaseline && sentBaseline.m_bFiltered) ? &sentBaseline.m_vRelevantEntities : nullptr,
+            *pSnapshot,
+            pvRelevantEntities))
+        {
+            return false;
+        }
+
+        SentSnapshot& sent = client.m_sentSnapshots[pSnapshot->getSequence() % PgeSnapshot::nHistorySize];
+        sent.m_seq = pSnapshot->getSequence();
+        sent.m_bFiltered = (pvRelevantEntities != nullptr);
+        if (pvRelevantEntities)
+        {
+            // reuses the capacity of the slot
+            sent.m_vRelevantEntities.assign(pvRelevantEntities->begin(), pvRelevantEntities->end());
+        }
+
+        MsgSnapshotPartHeader header{};
+        header.m_seq = pSnapshot->getSequence();
+        header.m_seqBaseline = pBaseline ? pBaseline->getSequence() : 0;
+        header.m_nPartCount = static_cast<uint8_t>(m_nPartCount);
+
+        PgePacket pkt;
+        for (std::size_t iPart = 0; iPart < m_nPartCount; iPart++)
+        {
+            Part& part = m_vParts[iPart];
+            header.m_iPart = static_cast<uint8_t>(iPart);
+            memcpy(part.m_data.data(), &header, sizeof(header));
+
+            PgePacket::initPktMsgApp(pkt, ServerConnHandle, PgePacket::AutoFill::NONE);
+            TByte* const pData = PgePacket::preparePktMsgAppFill(pkt, m_msgIdSnapshot, static_cast<MsgApp::TMsgSize>(part.m_nSize));
+            if (!pData)
+            {
+                CConsole::getConsoleInstance("PgeSnapshotSender").EOLn("%s: preparePktMsgAppFill() failed!", __func__);
+                return false;
+            }
+            memcpy(pData, part.m_data.data(), part.m_nSize);
+            server.send(pkt, connHandle);
+        }
+
+        if (pBaseline)
+        {
+            ++m_nDeltaSnapshotSentCount;
+        }
+        else
+        {
+            ++m_nFullSnapshotSentCount;
+        }
+        return true;
+    }
+
+    /**
+        Processes the given packet if it carries an acknowledgement sent by PgeSnapshotReceiver.
+        The sender client is identified by the server-side connection handle of the packet.
+
+        @return True if the given packet is an acknowledgement, false otherwise.
+    */
+    bool PgeSnapshotSender::handleAckPkt(const PgePacket& pkt)
+    {
+        if ((PgePacket::getPacketId(pkt) != PgePktId::Application) || (PgePacket::getMsgAppIdFromPkt(pkt) != m_msgIdAck))
+        {
+            return false;
+        }
+
+        const MsgApp& msgApp = *PgePacket::getMsgAppFromPkt(pkt);
+        if (MsgApp::getMsgAppDataActualSizeBytes(msgApp) != sizeof(MsgSnapshotAck))
+        {
+            CConsole::getConsoleInstance("PgeSnapshotSender").EOLn("%s: invalid ack size %u!", __func__, MsgApp::getMsgAppDataActualSizeBytes(msgApp));
+            return true;
+        }
+
+        MsgSnapshotAck ack;
+        memcpy(&ack, MsgApp::getMsgAppData(msgApp), sizeof(ack));
+        if ((ack.m_seq == 0) || (ack.m_seq > m_seqLastCommitted))
+        {
+            CConsole::getConsoleInstance("PgeSnapshotSender").EOLn("%s: invalid acked sequence %u!", __func__, ack.m_seq);
+            return true;
+        }
+
+        // acks might arrive out of order, the newest one is the best baseline
+        PgeSnapshot::TSequence& seqAcked = m_mapClients[PgePacket::getServerSideConnectionHandle(pkt)].m_seqAcked;
+        if (ack.m_seq > seqAcked)
+        {
+            seqAcked = ack.m_seq;
+        }
+        return true;
+    }
+
+    /**
+        Forgets the acknowledged baseline of the given client, e.g. when it disconnects.
+        Next time a full snapshot will be sent to this client.
+    */
+    void PgeSnapshotSender::removeClient(const PgeNetworkConnectionHandle& connHandle)
+    {
+        m_mapClients.erase(connHandle);
+    }
+
+    /**
+        @return Sequence number of the last snapshot acknowledged by the given client, 0 if none.
+    */
+    PgeSnapshot::TSequence PgeSnapshotSender::getAckedSequence(const PgeNetworkConnectionHandle& connHandle) const
+    {
+        const auto it = m_mapClients.find(connHandle);
+        return (it == m_mapClients.end()) ? 0 : it->second.m_seqAcked;
+    }
+
+    uint32_t PgeSnapshotSender::getFullSnapshotSentCount() const
+    {
+        return m_nFullSnapshotSentCount;
+    }
+
+    uint32_t PgeSnapshotSender::getDeltaSnapshotSentCount() const
+    {
+        return m_nDeltaSnapshotSentCount;
+    }
+
+    /**
+        @return The snapshot with the given sequence number from the history, or nullptr if it is not there anymore.
+    */
+    const PgeSnapshot* PgeSnapshotSender::findHistorySnapshot(const PgeSnapshot::TSequence& seq) const
+    {
+        if (seq == 0)
+        {
+            return nullptr;
+        }
+
+        const PgeSnapshot& snapshot = m_vHistory[seq % PgeSnapshot::nHistorySize];
+        return (snapshot.getSequence() == seq) ? &snapshot : nullptr;
+    }
+
+    /**
+        Encodes the relevant entities of the given snapshot into m_vParts, against the relevant entities of the given baseline.
+        Part headers are left to be filled by the caller.
+
+        @param pBaseline                  Snapshot to encode against, nullptr for full snapshot.
+        @param pvBaselineRelevantEntities Sorted ids of the entities of the baseline known by the client, nullptr for all.
+        @param snapshot                   Snapshot to encode.
+        @param pvRelevantEntities         Sorted ids of the entities of the snapshot to be encoded, nullptr for all.
+
+        @return True on success, false if the snapshot does not fit into 255 parts.
+    */
+    bool PgeSnapshotSender::encodeParts(
+        const PgeSnapshot* pBaseline,
+        const std::vector<PgeSnapshot::TEntityId>* pvBaselineRelevantEntities,
+        const PgeSnapshot& snapshot,
+        const std::vector<PgeSnapshot::TEntityId>* pvRelevantEntities)
+    {
+        m_nPartCount = 0;
+        if (!beginPart())
+        {
+            return false;
+        }
+
+        const std::vector<PgeSnapshot::Entity> vNoEntities;
+        const std::vector<PgeSnapshot::Entity>& vOld = pBaseline ? pBaseline->getEntities() : vNoEntities;
+        const std::vector<PgeSnapshot::Entity>& vNew = snapshot.getEntities();
+
+        const auto isRelevant = [](const std::vector<PgeSnapshot::TEntityId>* pvRelevant, const PgeSnapshot::TEntityId& entityId) {
+            return !pvRelevant || std::binary_search(pvRelevant->begin(), pvRelevant->end(), entityId);
+        };
+
+        // both vectors are sorted by id, so a single merge-like iteration finds the added, removed and changed entities;
+        // entities not relevant to the client are skipped as if they were not in the snapshot
+        std::size_t iOld = 0;
+        std::size_t iNew = 0;
+        while (true)
+        {
+            while ((iOld < vOld.size()) && !isRelevant(pvBaselineRelevantEntities, vOld[iOld].m_id))
+            {
+                ++iOld;
+            }
+            while ((iNew < vNew.size()) && !isRelevant(pvRelevantEntities, vNew[iNew].m_id))
+            {
+                ++iNew;
+            }
+            if ((iOld == vOld.size()) && (iNew == vNew.size()))
+            {
+                break;
+            }
+
+            bool bSuccess = true;
+            if ((iOld == vOld.size()) || ((iNew < vNew.size()) && (vNew[iNew].m_id < vOld[iOld].m_id)))
+            {
+                // added since baseline, or became relevant
+                bSuccess = appendEntityRecord(snapshot, vNew[iNew].m_id, snapshot.getAllFieldsMask(), &vNew[iNew]);
+                ++iNew;
+            }
+            else if ((iNew == vNew.size()) || (vOld[iOld].m_id < vNew[iNew].m_id))
+            {
+                // removed since baseline, or not relevant anymore
+                bSuccess = appendEntityRecord(snapshot, vOld[iOld].m_id, 0, nullptr);
+                ++iOld;
+            }
+            else
+            {
+                const PgeSnapshot::TFieldMask mask = snapshot.getChangedFieldsMask(vOld[iOld], vNew[iNew]);
+                if (mask != 0)
+                {
+                    bSuccess = appendEntityRecord(snapshot, vNew[iNew].m_id, mask, &vNew[iNew]);
+                }
+                ++iOld;
+                ++iNew;
+            }
+
+            if (!bSuccess)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+        Appends an entity record to the last part, or to a new part if it does not fit into the last part.
+
+        @param snapshot The snapshot being encoded, for the field sizes.
+        @param entityId Id of the entity.
+        @param mask     Fields to be written, 0 means entity removal.
+        @param pEntity  The entity to read field values from, can be nullptr if mask is 0.
+
+        @return True on success, false if there would be too many parts.
+    */
+    bool PgeSnapshotSender::appendEntityRecord(
+        const PgeSnapshot& snapshot,
+        const PgeSnapshot::TEntityId& entityId,
+        const PgeSnapshot::TFieldMask& mask,
+        const PgeSnapshot::Entity* pEntity)
+    {
+        std::size_t nRecordSize = sizeof(entityId) + sizeof(mask);
+        for (std::size_t iField = 0; iField < snapshot.getFieldCount(); iField++)
+        {
+            if (mask & (1u << iField))
+            {
+                nRecordSize += snapshot.getFieldSize(iField);
+            }
+        }
+
+        if (m_vParts[m_nPartCount - 1].m_nSize + nRecordSize > MsgApp::nMaxMessageLengthBytes)
+        {
+            if (!beginPart())
+            {
+                return false;
+            }
+        }
+
+        Part& part = m_vParts[m_nPartCount - 1];
+        TByte* pData = part.m_data.data() + part.m_nSize;
+        memcpy(pData, &entityId, sizeof(entityId));
+        pData += sizeof(entityId);
+        memcpy(pData, &mask, sizeof(mask));
+        pData += sizeof(mask);
+        for (std::size_t iField = 0; iField < snapshot.getFieldCount(); iField++)
+        {
+            if (mask & (1u << iField))
+            {
+                memcpy(pData, &(pEntity->m_fields[iField * PgeSnapshot::nMaxFieldSizeBytes]), snapshot.getFieldSize(iField));
+                pData += snapshot.getFieldSize(iField);
+            }
+        }
+        part.m_nSize += nRecordSize;
+
+        return true;
+    }
+
+    /**
+        Starts a new empty part, having only room reserved for the header.
+        Parts are allocated only when more parts are needed than ever before.
+
+        @return True on success, false if there would be more than 255 parts.
+    */
+    bool PgeSnapshotSender::beginPart()
+    {
+        if (m_nPartCount == std::numeric_limits<uint8_t>::max())
+        {
+            CConsole::getConsoleInstance("PgeSnapshotSender").EOLn("%s: snapshot does not fit into %u parts!", __func__, static_cast<unsigned>(m_nPartCount));
+            return false;
+        }
+
+        if (m_nPartCount == m_vParts.size())
+        {
+            m_vParts.emplace_back();
+        }
+        m_vParts[m_nPartCount].m_nSize = sizeof(MsgSnapshotPartHeader);
+        ++m_nPartCount;
+        return true;
+    }
+
+} // namespace pge_network
@@ -0,0 +1,135 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeSnapshotSender.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine delta-compressed snapshot sender
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <array>
+#include <map>
+#include <vector>
+
+#include "PgeIServerClient.h"
+#include "PgePacket.h"
+#include "PgeSnapshot.h"
+
+namespace pge_network
+{
+
+    /**
+        Server-side part of snapshot replication, the client-side counterpart is PgeSnapshotReceiver.
+
+        The application updates the working snapshot returned by getSnapshot(), which keeps its state between commits, so
+        only changed fields need to be set, e.g. those PgeOldNewValue fields being dirty.
+        Then commitSnapshot() makes it the latest snapshot with a new sequence number, and sendSnapshot() sends it to a client.
+
+        For each client, the sequence number of the last snapshot acknowledged by the client is kept: this is the baseline.
+        If the baseline is still in the history, only the entities and fields changed since the baseline are sent, otherwise
+        a full snapshot is sent. So if snapshots or acknowledgements are lost, the next snapshot is still encoded against
+        the last snapshot known to be received, and if the client lags behind too much, it receives a full snapshot.
+        Snapshots should be sent on an unreliable lane, since a lost snapshot is never resent, a newer one is sent instead.
+
+        Optionally only the entities relevant to the client are sent, e.g. as decided by PgeInterestManager: the set of relevant
+        entities used for each sent snapshot is remembered per client, so the delta is encoded between the relevant entities of
+        the baseline and the currently relevant entities. Entities becoming relevant are sent with all their fields, and entities
+        no longer relevant are removed on the client side, exactly as if they were added to or removed from the snapshot.
+        So the encoding cost and size of a snapshot is proportional to the number of entities relevant to the client.
+    */
+    class PgeSnapshotSender
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeSnapshotSender is included")
+#endif
+
+    public:
+
+        PgeSnapshotSender(
+            const std::vector<uint8_t>& vFieldSizes,
+            const MsgApp::TMsgId& msgIdSnapshot,
+            const MsgApp::TMsgId& msgIdAck) noexcept(false);
+        ~PgeSnapshotSender() = default;
+
+        PgeSnapshotSender(const PgeSnapshotSender&) = delete;
+        PgeSnapshotSender& operator=(const PgeSnapshotSender&) = delete;
+        PgeSnapshotSender(PgeSnapshotSender&&) = delete;
+        PgeSnapshotSender& operator=(PgeSnapshotSender&&) = delete;
+
+        const MsgApp::TMsgId& getMsgIdSnapshot() const;
+        const MsgApp::TMsgId& getMsgIdAck() const;
+
+        PgeSnapshot& getSnapshot();
+        PgeSnapshot::TSequence commitSnapshot();
+        const PgeSnapshot::TSequence& getLastCommittedSequence() const;
+
+        bool sendSnapshot(
+            PgeIServerClient& server,
+            const PgeNetworkConnectionHandle& connHandle,
+            const std::vector<PgeSnapshot::TEntityId>* pvRelevantEntities = nullptr);
+        bool handleAckPkt(const PgePacket& pkt);
+
+        void removeClient(const PgeNetworkConnectionHandle& connHandle);
+        PgeSnapshot::TSequence getAckedSequence(const PgeNetworkConnectionHandle& connHandle) const;
+
+        uint32_t getFullSnapshotSentCount() const;
+        uint32_t getDeltaSnapshotSentCount() const;
+
+    private:
+
+        /**
+            A single part of the snapshot being sent, starting with MsgSnapshotPartHeader.
+        */
+        struct Part
+        {
+            std::array<TByte, MsgApp::nMaxMessageLengthBytes> m_data;
+            std::size_t m_nSize;
+        };
+
+        /**
+            Entities sent to a client in a given snapshot.
+        */
+        struct SentSnapshot
+        {
+            PgeSnapshot::TSequence m_seq;                  /**< 0 if this slot is unused. */
+            bool m_bFiltered;                              /**< If false, all entities were sent and m_vRelevantEntities is unused. */
+            std::vector<PgeSnapshot::TEntityId> m_vRelevantEntities;  /**< Sorted. */
+        };
+
+        /**
+            Per client state.
+        */
+        struct Client
+        {
+            PgeSnapshot::TSequence m_seqAcked = 0;
+            std::array<SentSnapshot, PgeSnapshot::nHistorySize> m_sentSnapshots{};  /**< Indexed by sequence % nHistorySize. */
+        };
+
+        const MsgApp::TMsgId m_msgIdSnapshot;
+        const MsgApp::TMsgId m_msgIdAck;
+        PgeSnapshot m_snapshot;                                                    /**< Working snapshot. */
+        std::vector<PgeSnapshot> m_vHistory;                                       /**< Committed snapshots, indexed by sequence % nHistorySize. */
+        PgeSnapshot::TSequence m_seqLastCommitted;
+        std::map<PgeNetworkConnectionHandle, Client> m_mapClients;
+        std::vector<Part> m_vParts;                                                /**< Reused between sendSnapshot() calls. */
+        std::size_t m_nPartCount;
+        uint32_t m_nFullSnapshotSentCount;
+        uint32_t m_nDeltaSnapshotSentCount;
+
+        const PgeSnapshot* findHistorySnapshot(const PgeSnapshot::TSequence& seq) const;
+        bool encodeParts(
+            const PgeSnapshot* pBaseline,
+            const std::vector<PgeSnapshot::TEntityId>* pvBaselineRelevantEntities,
+            const PgeSnapshot& snapshot,
+            const std::vector<PgeSnapshot::TEntityId>* pvRelevantEntities);
+        bool appendEntityRecord(const PgeSnapshot& snapshot, const PgeSnapshot::TEntityId& entityId, const PgeSnapshot::TFieldMask& mask, const PgeSnapshot::Entity* pEntity);
+        bool beginPart();
+
+    }; // class PgeSnapshotSender
+
+} // namespace pge_network
@@ -0,0 +1,302 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeSpscQueue.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine bounded lock-free single-producer single-consumer queue
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "../PGEallHeaders.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace pge_network
+{
+
+    /**
+        Bounded lock-free FIFO queue for handing over items between exactly 2 threads: a single producer and a single consumer thread.
+        Used for handing over packets between the network I/O thread and the application thread.
+
+        Capacity is always a power of two so that index wrapping is just a bitwise and with a mask.
+        Memory is allocated only by reserve(), after that no allocation happens, and items are not moved around in memory:
+         - producer side fills the back slot in-place using beginPushBack() and endPushBack(), or copies into it using pushBack();
+         - consumer side accesses the front slot in-place using front(), and when done with it, calls popFront().
+        Slots are reused, so members of T owning memory (e.g. a std::vector) keep their capacity across items.
+
+        Head index is written only by the consumer, tail index is written only by the producer, each is published with release
+        and read with acquire semantics, so the content of a slot is visible to the consumer when it sees the slot as stored, and
+        the slot is not overwritten by the producer before the consumer releases it. Both sides also keep a cached copy of the
+        other side's index, so the shared cache line of the other side is read only when the queue seems to be full or empty.
+
+        When the queue is full, beginPushBack() returns nullptr, it is up to the producer to drop the item or retry later.
+
+        reserve() and resetCounters() are not thread-safe: they must be invoked only while neither side is accessing the queue.
+        size(), empty(), getHighWaterMark() and getFullCount() can be invoked from any thread, but they are only approximate
+        while the other side is active.
+    */
+    template <typename T>
+    class PgeSpscQueue
+    {
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  PgeSpscQueue is included")
+#endif
+
+    public:
+
+        static constexpr std::size_t nMaxCapacity = 1u << 16;  /**< Maximum capacity that can be reserved. */
+
+        // ---------------------------------------------------------------------------
+
+        /**
+            Creates a queue with zero capacity, reserve() must be called before storing any item.
+        */
+        PgeSpscQueue() :
+            m_nMask(0),
+            m_nHead(0),
+            m_nTailCached(0),
+            m_nTail(0),
+            m_nHeadCached(0),
+            m_bBackBegun(false),
+            m_nHighWaterMark(0),
+            m_nFullCount(0)
+        {
+        }
+
+        ~PgeSpscQueue() = default;
+
+        PgeSpscQueue(const PgeSpscQueue&) = delete;
+        PgeSpscQueue& operator=(const PgeSpscQueue&) = delete;
+        PgeSpscQueue(PgeSpscQueue&&) = delete;
+        PgeSpscQueue& operator=(PgeSpscQueue&&) = delete;
+
+        /**
+            Allocates memory for the given number of items, rounded up to the next power of two.
+            If the resulting capacity equals to the current capacity, nothing happens and the stored items are kept.
+            Otherwise the stored items are dropped.
+            Not thread-safe.
+
+            @param nCapacity The minimum number of items to be stored, must be in range [1, nMaxCapacity].
+
+            @return True on success, false if nCapacity is out of range.
+        */
+        bool reserve(const std::size_t& nCapacity)
+        {
+            if ((nCapacity == 0) || (nCapacity > nMaxCapacity))
+            {
+                return false;
+            }
+
+            std::size_t nPow2Capacity = 1;
+            while (nPow2Capacity < nCapacity)
+            {
+                nPow2Capacity <<= 1;
+            }
+
+            if (nPow2Capacity == capacity())
+            {
+                return true;
+            }
+
+            m_vItems = std::vector<T>(nPow2Capacity);
+            m_nMask = nPow2Capacity - 1;
+            m_nHead.store(0, std::memory_order_relaxed);
+            m_nTailCached = 0;
+            m_nTail.store(0, std::memory_order_relaxed);
+            m_nHeadCached = 0;
+            m_bBackBegun = false;
+            return true;
+        }
+
+        /**
+            @return Maximum number of items that can be stored, always zero or a power of two.
+        */
+        std::size_t capacity() const
+        {
+            return m_vItems.size();
+        }
+
+        /**
+            @return Number of currently stored items, approximate if invoked while the other side is active.
+        */
+        std::size_t size() const
+        {
+            const std::size_t nHead = m_nHead.load(std::memory_order_acquire);
+            const std::size_t nTail = m_nTail.load(std::memory_order_acquire);
+            return (nTail >= nHead) ? (nTail - nHead) : 0;
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+        /**
+            Gets the back slot to be filled in-place by the producer.
+            The item becomes visible to the consumer only when endPushBack() is called, so the producer can abandon the slot by simply not
+            calling it. The next call to this function will return the same slot.
+            To be invoked only by the producer thread.
+
+            @return The slot to be filled, or nullptr if the queue is full, in which case the full count is incremented.
+        */
+        T* beginPushBack()
+        {
+            if (capacity() == 0)
+            {
+                m_nFullCount.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            const std::size_t nTail = m_nTail.load(std::memory_order_relaxed);
+            if (nTail - m_nHeadCached == capacity())
+            {
+                m_nHeadCached = m_nHead.load(std::memory_order_acquire);
+                if (nTail - m_nHeadCached == capacity())
+                {
+                    m_nFullCount.fetch_add(1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+            }
+
+            m_bBackBegun = true;
+            return &m_vItems[nTail & m_nMask];
+        }
+
+        /**
+            Makes the item filled in the slot returned by beginPushBack() visible to the consumer.
+            No effect if beginPushBack() was not called or returned nullptr.
+            To be invoked only by the producer thread.
+        */
+        void endPushBack()
+        {
+            if (!m_bBackBegun)
+            {
+                return;
+            }
+
+            m_bBackBegun = false;
+            const std::size_t nTail = m_nTail.load(std::memory_order_relaxed) + 1;
+            m_nTail.store(nTail, std::memory_order_release);
+
+            const std::size_t nSize = nTail - m_nHeadCached;  // might be more than actual size, but never less
+            if (nSize > m_nHighWaterMark.load(std::memory_order_relaxed))
+            {
+                m_nHeadCached = m_nHead.load(std::memory_order_acquire);
+                if (nTail - m_nHeadCached > m_nHighWaterMark.load(std::memory_order_relaxed))
+                {
+                    m_nHighWaterMark.store(nTail - m_nHeadCached, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+            Copies the given item into the back slot.
+            To be invoked only by the producer thread.
+
+            @param item The item to be stored.
+
+            @return True if the item is stored, false if the queue is full.
+        */
+        bool pushBack(const T& item)
+        {
+            T* const pSlot = beginPushBack();
+            if (!pSlot)
+            {
+                return false;
+            }
+
+            *pSlot = item;
+            endPushBack();
+            return true;
+        }
+
+        /**
+            Gets the front slot to be accessed in-place by the consumer.
+            The returned pointer stays valid until popFront() is called.
+            To be invoked only by the consumer thread.
+
+            @return The front item, or nullptr if the queue is empty.
+        */
+        T* front()
+        {
+            const std::size_t nHead = m_nHead.load(std::memory_order_relaxed);
+            if (nHead == m_nTailCached)
+            {
+                m_nTailCached = m_nTail.load(std::memory_order_acquire);
+                if (nHead == m_nTailCached)
+                {
+                    return nullptr;
+                }
+            }
+
+            return &m_vItems[nHead & m_nMask];
+        }
+
+        /**
+            Removes the front item, invalidating the pointer returned by front(), and making its slot available to the producer.
+            No effect if the queue is empty.
+            To be invoked only by the consumer thread.
+        */
+        void popFront()
+        {
+            if (!front())
+            {
+                return;
+            }
+
+            m_nHead.store(m_nHead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        /**
+            @return Maximum number of items stored at the same time, since construction or last resetCounters().
+        */
+        std::size_t getHighWaterMark() const
+        {
+            return m_nHighWaterMark.load(std::memory_order_relaxed);
+        }
+
+        /**
+            @return Number of times beginPushBack() found the queue full, since construction or last resetCounters().
+        */
+        uint32_t getFullCount() const
+        {
+            return m_nFullCount.load(std::memory_order_relaxed);
+        }
+
+        /**
+            Not thread-safe.
+        */
+        void resetCounters()
+        {
+            m_nHighWaterMark.store(size(), std::memory_order_relaxed);
+            m_nFullCount.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+
+        static constexpr std::size_t nCacheLineSize = 64;
+
+        std::vector<T> m_vItems;  /**< Preallocated slots, size is always capacity. */
+        std::size_t m_nMask;      /**< capacity - 1, valid only if capacity is non-zero. */
+
+        // indices are monotonically increasing, to be masked before use;
+        // consumer and producer side members are on separate cache lines, so the 2 threads don't invalidate each other's cache line
+
+        alignas(nCacheLineSize) std::atomic<std::size_t> m_nHead;  /**< Index of front item, written by consumer. */
+        std::size_t m_nTailCached;                                 /**< Consumer's copy of m_nTail. */
+
+        alignas(nCacheLineSize) std::atomic<std::size_t> m_nTail;  /**< Index of slot after back item, written by producer. */
+        std::size_t m_nHeadCached;                                 /**< Producer's copy of m_nHead. */
+        bool m_bBackBegun;
+
+        alignas(nCacheLineSize) std::atomic<std::size_t> m_nHighWaterMark;  /**< Written by producer. */
+        std::atomic<uint32_t> m_nFullCount;                                 /**< Written by producer. */
+
+    }; // class PgeSpscQueue
+
+} // namespace pge_network
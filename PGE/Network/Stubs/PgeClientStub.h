@@ -11,6 +11,10 @@
 */
 
 #include "../../PGEallHeaders.h"
+
+#include <utility>
+#include <vector>
+
 #include "../../Config/PGEcfgProfiles.h"
 #include "../PgeIClient.h"
 #include "../PgeIServerClient.h"
@@ -64,19 +68,58 @@ namespace pge_network
             throw std::exception("unimplemented");
         }
 
-        std::set<pge_network::PgePktId>& getAllowListedPgeMessages() override
+        const pge_network::PgePacket& borrowFrontPacket() noexcept(false) override
+        {
+            throw std::exception("unimplemented");
+        }
+
+        void releaseFrontPacket() override
+        {
+        }
+
+        uint32_t getPacketQueueDroppedCount() const override
+        {
+            return 0;
+        }
+
+        std::size_t getPacketQueueHighWaterMark() const override
+        {
+            return 0;
+        }
+
+        pge_network::PgePktIdAllowList& getAllowListedPgeMessages() override
+        {
+            throw std::exception("unimplemented");
+        }
+
+        pge_network::MsgAppIdAllowList& getAllowListedAppMessages() override
+        {
+            throw std::exception("unimplemented");
+        }
+
+        std::map<pge_network::MsgApp::TMsgId, pge_network::PgeSendLane>& getMsgAppId2SendLaneMap() override
         {
             throw std::exception("unimplemented");
         }
 
-        std::set<pge_network::MsgApp::TMsgId>& getAllowListedAppMessages() override
+        pge_network::PgeMsgAppCompressor& getMsgAppCompressor() override
         {
             throw std::exception("unimplemented");
         }
 
+        std::map<pge_network::MsgApp::TMsgId, pge_network::PgeMsgAppCompressor::MsgAppStats> getMsgAppCompressionStats() const override
+        {
+            return {};
+        }
+
         void send(
-            const pge_network::PgePacket& /*pkt*/,
-            const pge_network::PgeNetworkConnectionHandle& /*connHandle = pge_network::ServerConnHandle*/) override {}
+            const pge_network::PgePacket& pkt,
+            const pge_network::PgeNetworkConnectionHandle& connHandle = pge_network::ServerConnHandle) override
+        {
+            m_vTxPkts.push_back({ connHandle, pkt });
+        }
+
+        void flushBatchedPackets() override {}
 
         uint32_t getRxPacketCount() const override { return 0; }
         uint32_t getTxPacketCount() const override { return 0; }
@@ -90,11 +133,18 @@ namespace pge_network
         const std::map<pge_network::MsgApp::TMsgId, uint32_t>& getTxMsgCount() const override { throw std::exception("unimplemented"); }
         const std::map<pge_network::MsgApp::TMsgId, uint32_t>& getInjectMsgCount() const override { throw std::exception("unimplemented"); }
 
+        const std::map<pge_network::PgeSendLane, uint32_t>& getRxLaneMsgCount() const override { throw std::exception("unimplemented"); }
+        const std::map<pge_network::PgeSendLane, uint32_t>& getTxLaneMsgCount() const override { throw std::exception("unimplemented"); }
+
+        const pge_network::PgeNetworkStats& getNetworkStats() const override { throw std::exception("unimplemented"); }
+
         std::map<pge_network::MsgApp::TMsgId, std::string>& getMsgAppId2StringMap() override { throw std::exception("unimplemented"); }
 
         uint32_t getRxByteCount() const override { return 0; }
         uint32_t getTxByteCount() const override { return 0; }
         uint32_t getInjectByteCount() const override { return 0; }
+        pge_network::PgeHandoffStats getHandoffStats() const override { return pge_network::PgeHandoffStats(); }
+        pge_network::PgeConnectionTelemetry getConnectionTelemetry() const override { return pge_network::PgeConnectionTelemetry(); }
 
         void WriteList() const override {}
 
@@ -174,6 +224,21 @@ namespace pge_network
 
         /* implement stuff from PgeClient end */
 
+        /* Spy functions. */
+
+        /**
+        * @return All packets sent since construction or last clearTxPackets(), in order of sending, along with the destination connection handle.
+        */
+        const std::vector<std::pair<pge_network::PgeNetworkConnectionHandle, pge_network::PgePacket>>& getTxPackets() const
+        {
+            return m_vTxPkts;
+        }
+
+        void clearTxPackets()
+        {
+            m_vTxPkts.clear();
+        }
+
     private:
 
         // ---------------------------------------------------------------------------
@@ -181,6 +246,7 @@ namespace pge_network
         PGEcfgProfiles& m_cfgProfiles;
         pge_network::PgeNetworkConnectionHandle m_myClientSideConnectionHandle{ 0 };
         pge_network::PgeNetworkConnectionHandle m_myServerSideConnectionHandle{ 0 };
+        std::vector<std::pair<pge_network::PgeNetworkConnectionHandle, pge_network::PgePacket>> m_vTxPkts;
     };
 
 
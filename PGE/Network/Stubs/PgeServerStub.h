@@ -11,6 +11,11 @@
 */
 
 #include "../../PGEallHeaders.h"
+
+#include <set>
+#include <utility>
+#include <vector>
+
 #include "../../Config/PGEcfgProfiles.h"
 #include "../PgeIServer.h"
 #include "../PgeIServerClient.h"
@@ -66,6 +71,8 @@ namespace pge_network
             m_bInited = false;
             m_nPktCountTx = 0;
             m_mapTxMsgCount.clear();
+            m_mapTxLaneMsgCount.clear();
+            m_vTxPkts.clear();
 
             return true;
         }
@@ -100,19 +107,53 @@ namespace pge_network
             throw std::exception("unimplemented");
         }
 
-        std::set<pge_network::PgePktId>& getAllowListedPgeMessages() override
+        const pge_network::PgePacket& borrowFrontPacket() noexcept(false) override
+        {
+            throw std::exception("unimplemented");
+        }
+
+        void releaseFrontPacket() override
+        {
+        }
+
+        uint32_t getPacketQueueDroppedCount() const override
+        {
+            return 0;
+        }
+
+        std::size_t getPacketQueueHighWaterMark() const override
+        {
+            return 0;
+        }
+
+        pge_network::PgePktIdAllowList& getAllowListedPgeMessages() override
         { 
             throw std::exception("unimplemented");
         }
 
-        std::set<pge_network::MsgApp::TMsgId>& getAllowListedAppMessages() override
+        pge_network::MsgAppIdAllowList& getAllowListedAppMessages() override
         {
             throw std::exception("unimplemented");
         }
 
+        std::map<pge_network::MsgApp::TMsgId, pge_network::PgeSendLane>& getMsgAppId2SendLaneMap() override
+        {
+            return m_mapMsgAppId2SendLane;
+        }
+
+        pge_network::PgeMsgAppCompressor& getMsgAppCompressor() override
+        {
+            return m_compressor;
+        }
+
+        std::map<pge_network::MsgApp::TMsgId, pge_network::PgeMsgAppCompressor::MsgAppStats> getMsgAppCompressionStats() const override
+        {
+            return m_compressor.getStats();
+        }
+
         void send(
             const pge_network::PgePacket& pkt,
-            [[maybe_unused]] const pge_network::PgeNetworkConnectionHandle& connHandle = pge_network::ServerConnHandle) override
+            const pge_network::PgeNetworkConnectionHandle& connHandle = pge_network::ServerConnHandle) override
         {
             if (!isInitialized())
             {
@@ -120,6 +161,7 @@ namespace pge_network
             }
 
             ++m_nPktCountTx;
+            m_vTxPkts.push_back({ connHandle, pkt });
             if (pge_network::PgePacket::getPacketId(pkt) == pge_network::PgePktId::Application)
             {
                 const pge_network::MsgApp* pMsgApp = pge_network::PgePacket::getMsgAppFromPkt(pkt);
@@ -127,9 +169,17 @@ namespace pge_network
                 // for now there is always exactly 1 message in each PgePacket, otherwise in future we will need to iterate
                 assert(nMessageCount == 1);
                 ++m_mapTxMsgCount[pge_network::MsgApp::getMsgAppMsgId(*pMsgApp)];
+
+                const auto itLane = m_mapMsgAppId2SendLane.find(pge_network::MsgApp::getMsgAppMsgId(*pMsgApp));
+                ++m_mapTxLaneMsgCount[(itLane == m_mapMsgAppId2SendLane.end()) ? pge_network::PgeSendLane::Reliable : itLane->second];
             }
         }
 
+        void flushBatchedPackets() override
+        {
+            // send() counts each packet immediately, no batching in the stub
+        }
+
         uint32_t getRxPacketCount() const override { return 0; }
         uint32_t getTxPacketCount() const override { return m_nPktCountTx; }
         uint32_t getInjectPacketCount() const override { return 0; }
@@ -142,11 +192,18 @@ namespace pge_network
         const std::map<pge_network::MsgApp::TMsgId, uint32_t>& getTxMsgCount() const override { return m_mapTxMsgCount; }
         const std::map<pge_network::MsgApp::TMsgId, uint32_t>& getInjectMsgCount() const override { throw std::exception("unimplemented"); }
 
+        const std::map<pge_network::PgeSendLane, uint32_t>& getRxLaneMsgCount() const override { throw std::exception("unimplemented"); }
+        const std::map<pge_network::PgeSendLane, uint32_t>& getTxLaneMsgCount() const override { return m_mapTxLaneMsgCount; }
+
+        const pge_network::PgeNetworkStats& getNetworkStats() const override { throw std::exception("unimplemented"); }
+
         std::map<pge_network::MsgApp::TMsgId, std::string>& getMsgAppId2StringMap() override { throw std::exception("unimplemented"); }
 
         uint32_t getRxByteCount() const override { return 0; }
         uint32_t getTxByteCount() const override { return 0; }
         uint32_t getInjectByteCount() const override { return 0; }
+        pge_network::PgeHandoffStats getHandoffStats() const override { return pge_network::PgeHandoffStats(); }
+        pge_network::PgeConnectionTelemetry getConnectionTelemetry() const override { return pge_network::PgeConnectionTelemetry(); }
 
         void WriteList() const override {}
 
@@ -169,6 +226,19 @@ namespace pge_network
             send(pkt);
         }
 
+        void sendToAllClientsExcept(
+            const pge_network::PgePacket& pkt,
+            [[maybe_unused]] const std::set<pge_network::PgeNetworkConnectionHandle>& exceptConnHandles) override
+        {
+            if (!isInitialized())
+            {
+                return;
+            }
+
+            // we have 1 virtual client connected always
+            send(pkt);
+        }
+
         void sendToAll(const pge_network::PgePacket& pkt) override
         {
             if (!isInitialized())
@@ -255,6 +325,21 @@ namespace pge_network
 
         /* implement stuff from PgeServer end */
 
+        /* Spy functions. */
+
+        /**
+        * @return All packets sent since initialization or last clearTxPackets(), in order of sending, along with the destination connection handle.
+        */
+        const std::vector<std::pair<pge_network::PgeNetworkConnectionHandle, pge_network::PgePacket>>& getTxPackets() const
+        {
+            return m_vTxPkts;
+        }
+
+        void clearTxPackets()
+        {
+            m_vTxPkts.clear();
+        }
+
      private:
             PGEcfgProfiles& m_cfgProfiles;
 
@@ -262,6 +347,10 @@ namespace pge_network
 
             uint32_t m_nPktCountTx{ 0 };
             std::map<pge_network::MsgApp::TMsgId, uint32_t> m_mapTxMsgCount;
+            std::map<pge_network::PgeSendLane, uint32_t> m_mapTxLaneMsgCount;
+            std::map<pge_network::MsgApp::TMsgId, pge_network::PgeSendLane> m_mapMsgAppId2SendLane;
+            pge_network::PgeMsgAppCompressor m_compressor;  /**< Only configured, packets are recorded uncompressed. */
+            std::vector<std::pair<pge_network::PgeNetworkConnectionHandle, pge_network::PgePacket>> m_vTxPkts;
 
     }; // class PgeServerStub
 
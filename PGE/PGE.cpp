@@ -30,6 +30,9 @@ static constexpr char* CVAR_CL_EXTRA_RENDER_DELAY = "cl_extra_render_delay";
 static constexpr char* CVAR_SV_EXTRA_RENDER_DELAY = "sv_extra_render_delay";
 static constexpr int   CVAR_EXTRA_RENDER_DELAY_MAX = 2000;
 
+static constexpr unsigned int HEADLESS_DEFAULT_GAME_LOOP_FREQ = 60;
+static constexpr unsigned int HEADLESS_TICK_BUSY_WAIT_MILLISECS = 2;
+
 /*
    PGE::PGEimpl
    ###########################################################################
@@ -111,6 +114,7 @@ private:
     std::string m_sGameTitle;             /**< Simplified name of the game, used in paths too, so can't contain joker chars. */
     int         m_nInactiveSleep;         /**< Amount of sleep in millisecs when inactive, 0 means no sleep. */
     bool        m_bInactiveLikeActive;    /**< If true, runGame() will act the same way in inactive state as in active state. */
+    bool        m_bHeadless;              /**< If true, window, graphics, audio and input are not initialized. */
 
     int         m_nCookie;                /**< A custom cookie for arbitrary use by the application. */
 
@@ -126,6 +130,8 @@ private:
         std::chrono::time_point<std::chrono::steady_clock>& timeNow,
         std::chrono::time_point<std::chrono::steady_clock>& timeLastTime);
 
+    void tickLimit(std::chrono::time_point<std::chrono::steady_clock>& timeNextTick);
+
     void updateMinFrameTime(unsigned int nTargetGameLoopFreq, unsigned int nMillisecs);
 
     friend class PGE;
@@ -262,10 +268,14 @@ int PGE::PGEimpl::destroyGame()
     // first things to shutdown are instances that are NOT even initialized by initializeGame(), such as m_wpnMgr
     m_world.Shutdown();
     // m_inputHandler doesnt have any shutdown
-    m_sysGFX.destroySysGFX();
+    if (!m_bHeadless)
+    {
+        m_sysGFX.destroySysGFX();
+    }
     m_audio.shutdown();
     getNetwork().shutdown();
     m_cfgProfiles.shutdown();
+    m_bHeadless = false;
 
     getConsole().Deinitialize();
 
@@ -336,6 +346,7 @@ PGE::PGEimpl::PGEimpl(const char* gameTitle) :
     m_sGameTitle(gameTitle),
     m_nInactiveSleep(PGE_INACTIVE_SLEEP),
     m_bInactiveLikeActive(PGE_INACTIVE_AS_ACTIVE),
+    m_bHeadless(false),
     m_nCookie(0),
     m_nTargetGameLoopFreq(0),
     m_minFrameTimeMicrosecs(0.0),
@@ -378,6 +389,41 @@ void PGE::PGEimpl::frameLimit(
     timeLastTime = std::chrono::steady_clock::now();
 }
 
+/**
+    Waits until the next tick of the main game engine loop in headless mode.
+    Ticks are scheduled relative to the previous tick instead of the end of the previous frame, so the tick rate doesn't
+    drift even if frame durations vary. If we fall behind by more than a whole tick, we don't try to catch up by running
+    a burst of frames, instead the schedule is restarted from now.
+*/
+void PGE::PGEimpl::tickLimit(std::chrono::time_point<std::chrono::steady_clock>& timeNextTick)
+{
+    const unsigned int nFreq = (m_nTargetGameLoopFreq > 0) ? m_nTargetGameLoopFreq : HEADLESS_DEFAULT_GAME_LOOP_FREQ;
+    const std::chrono::nanoseconds durTick(1000000000ll / nFreq);
+    timeNextTick += durTick;
+
+    const std::chrono::time_point<std::chrono::steady_clock> timeNow = std::chrono::steady_clock::now();
+    if (timeNow >= timeNextTick)
+    {
+        if (timeNow - timeNextTick > durTick)
+        {
+            timeNextTick = timeNow;
+        }
+        return;
+    }
+
+    // unlike frameLimit(), we sleep most of the remaining time so a dedicated server doesn't keep a core busy, and busy wait
+    // only at the end for precision. Sleep is precise enough for this since GameNetworkingSockets sets 1 ms timer resolution.
+    const std::chrono::time_point<std::chrono::steady_clock> timeWakeUp =
+        timeNextTick - std::chrono::milliseconds(HEADLESS_TICK_BUSY_WAIT_MILLISECS);
+    if (timeNow < timeWakeUp)
+    {
+        std::this_thread::sleep_until(timeWakeUp);
+    }
+    while (std::chrono::steady_clock::now() < timeNextTick)
+    {
+    }
+}
+
 void PGE::PGEimpl::updateMinFrameTime(unsigned int nTargetGameLoopFreq, unsigned int nMillisecs)
 {
     m_nTargetGameLoopFreq = nTargetGameLoopFreq;
@@ -764,104 +810,121 @@ int PGE::initializeGame(const char* szCmdLine)
     } 
     getConsole().L();
         
-    getConsole().L();
-    getConsole().OLnOI("Initializing Audio ...");
-    if ( !(p->m_audio.initialize()) )
-    {
-        getConsole().EOLnOO("Failed!");
-        getConsole().OLn("");
-        /*return 1;*/
-    }
-    else
+    p->m_bHeadless = false;
+    if (getConfigProfiles().getVars()[CVAR_SV_HEADLESS].getAsBool())
     {
-        getConsole().SOLnOO("Done!");
-        getConsole().OLn("");
+        if (getNetwork().isServer())
+        {
+            p->m_bHeadless = true;
+            getConsole().OLn("Headless mode from config, skipping Audio, Graphics and Input!");
+        }
+        else
+        {
+            getConsole().EOLn("ERROR: Ignoring Headless mode in config, only server can run headless!");
+        }
     }
-    getConsole().L();
 
-    getConsole().L();
-    getConsole().OLnOI("Initializing Graphics ...");
-    bool bGFXinit;
-    bool bFullScreen;
-
-    if (getConfigProfiles().getVars()[CVAR_GFX_WINDOWED].getAsString().empty())
-    {
-        bFullScreen = MessageBox(0, "Fullscreen?", ":)", MB_YESNO | MB_ICONQUESTION | MB_SETFOREGROUND) == IDYES;
-        getConsole().OLn("Full screen override: %b", bFullScreen);
-    }
-    else
+    if (!p->m_bHeadless)
     {
-        bFullScreen = !getConfigProfiles().getVars()[CVAR_GFX_WINDOWED].getAsBool();
-        getConsole().OLn("Full screen from config: %b", bFullScreen);
-    }
-
-    if ( bFullScreen )
-        bGFXinit = p->m_sysGFX.initSysGFX(0, 0, PURE_FULLSCREEN, 0, 32, 24, 0, 0);
-    else
-        bGFXinit = p->m_sysGFX.initSysGFX(1024, 768, PURE_WINDOWED, 0, 32, 24, 0, 0);
+        getConsole().L();
+        getConsole().OLnOI("Initializing Audio ...");
+        if ( !(p->m_audio.initialize()) )
+        {
+            getConsole().EOLnOO("Failed!");
+            getConsole().OLn("");
+            /*return 1;*/
+        }
+        else
+        {
+            getConsole().SOLnOO("Done!");
+            getConsole().OLn("");
+        }
+        getConsole().L();
 
-    if ( !bGFXinit )
-    {
-        getConsole().EOLnOO("Failed!");
-        getConsole().OLnOO("");
-        return 1;
-    }
-    else
-    {
-        getConsole().SOLnOO("Done!");
-        getConsole().OLn("");
-    }
-    getConsole().L();
+        getConsole().L();
+        getConsole().OLnOI("Initializing Graphics ...");
+        bool bGFXinit;
+        bool bFullScreen;
 
-    if (getNetwork().isServer() && !getConfigProfiles().getVars()[CVAR_SV_EXTRA_RENDER_DELAY].getAsString().empty())
-    {
-        if ((getConfigProfiles().getVars()[CVAR_SV_EXTRA_RENDER_DELAY].getAsInt() > 0) &&
-            (getConfigProfiles().getVars()[CVAR_SV_EXTRA_RENDER_DELAY].getAsInt() <= CVAR_EXTRA_RENDER_DELAY_MAX))
+        if (getConfigProfiles().getVars()[CVAR_GFX_WINDOWED].getAsString().empty())
         {
-            getConsole().OLn("Server Extra Render Delay from config: %u ms", getConfigProfiles().getVars()[CVAR_SV_EXTRA_RENDER_DELAY].getAsUInt());
-            setRenderExtraDelayMillisecs(getConfigProfiles().getVars()[CVAR_SV_EXTRA_RENDER_DELAY].getAsUInt());
+            bFullScreen = MessageBox(0, "Fullscreen?", ":)", MB_YESNO | MB_ICONQUESTION | MB_SETFOREGROUND) == IDYES;
+            getConsole().OLn("Full screen override: %b", bFullScreen);
         }
         else
         {
-            getConsole().EOLn("ERROR: Ignoring Invalid Server Extra Render Delay in config: %s ms",
-                getConfigProfiles().getVars()[CVAR_SV_EXTRA_RENDER_DELAY].getAsString().c_str());
+            bFullScreen = !getConfigProfiles().getVars()[CVAR_GFX_WINDOWED].getAsBool();
+            getConsole().OLn("Full screen from config: %b", bFullScreen);
         }
-    }
-    else if (!getNetwork().isServer() && !getConfigProfiles().getVars()[CVAR_CL_EXTRA_RENDER_DELAY].getAsString().empty())
-    {
-        if ((getConfigProfiles().getVars()[CVAR_CL_EXTRA_RENDER_DELAY].getAsInt() > 0) &&
-            (getConfigProfiles().getVars()[CVAR_CL_EXTRA_RENDER_DELAY].getAsInt() <= CVAR_EXTRA_RENDER_DELAY_MAX))
+
+        if ( bFullScreen )
+            bGFXinit = p->m_sysGFX.initSysGFX(0, 0, PURE_FULLSCREEN, 0, 32, 24, 0, 0);
+        else
+            bGFXinit = p->m_sysGFX.initSysGFX(1024, 768, PURE_WINDOWED, 0, 32, 24, 0, 0);
+
+        if ( !bGFXinit )
         {
-            getConsole().OLn("Client Extra Render Delay from config: %u ms", getConfigProfiles().getVars()[CVAR_CL_EXTRA_RENDER_DELAY].getAsUInt());
-            setRenderExtraDelayMillisecs(getConfigProfiles().getVars()[CVAR_CL_EXTRA_RENDER_DELAY].getAsUInt());
+            getConsole().EOLnOO("Failed!");
+            getConsole().OLnOO("");
+            return 1;
         }
         else
         {
-            getConsole().EOLn("ERROR: Ignoring Invalid Client Extra Render Delay in config: %s ms",
-                getConfigProfiles().getVars()[CVAR_CL_EXTRA_RENDER_DELAY].getAsString().c_str());
+            getConsole().SOLnOO("Done!");
+            getConsole().OLn("");
         }
-    }
+        getConsole().L();
 
-    PureWindow& window = p->m_gfx.getWindow();
-    window.SetAutoCleanupOnQuitOn(false);
-    window.SetCaption( p->m_sGameTitle );
-    window.ShowFull();
-    window.WriteSettings();
-    //window.SetCursorVisible(false);
+        if (getNetwork().isServer() && !getConfigProfiles().getVars()[CVAR_SV_EXTRA_RENDER_DELAY].getAsString().empty())
+        {
+            if ((getConfigProfiles().getVars()[CVAR_SV_EXTRA_RENDER_DELAY].getAsInt() > 0) &&
+                (getConfigProfiles().getVars()[CVAR_SV_EXTRA_RENDER_DELAY].getAsInt() <= CVAR_EXTRA_RENDER_DELAY_MAX))
+            {
+                getConsole().OLn("Server Extra Render Delay from config: %u ms", getConfigProfiles().getVars()[CVAR_SV_EXTRA_RENDER_DELAY].getAsUInt());
+                setRenderExtraDelayMillisecs(getConfigProfiles().getVars()[CVAR_SV_EXTRA_RENDER_DELAY].getAsUInt());
+            }
+            else
+            {
+                getConsole().EOLn("ERROR: Ignoring Invalid Server Extra Render Delay in config: %s ms",
+                    getConfigProfiles().getVars()[CVAR_SV_EXTRA_RENDER_DELAY].getAsString().c_str());
+            }
+        }
+        else if (!getNetwork().isServer() && !getConfigProfiles().getVars()[CVAR_CL_EXTRA_RENDER_DELAY].getAsString().empty())
+        {
+            if ((getConfigProfiles().getVars()[CVAR_CL_EXTRA_RENDER_DELAY].getAsInt() > 0) &&
+                (getConfigProfiles().getVars()[CVAR_CL_EXTRA_RENDER_DELAY].getAsInt() <= CVAR_EXTRA_RENDER_DELAY_MAX))
+            {
+                getConsole().OLn("Client Extra Render Delay from config: %u ms", getConfigProfiles().getVars()[CVAR_CL_EXTRA_RENDER_DELAY].getAsUInt());
+                setRenderExtraDelayMillisecs(getConfigProfiles().getVars()[CVAR_CL_EXTRA_RENDER_DELAY].getAsUInt());
+            }
+            else
+            {
+                getConsole().EOLn("ERROR: Ignoring Invalid Client Extra Render Delay in config: %s ms",
+                    getConfigProfiles().getVars()[CVAR_CL_EXTRA_RENDER_DELAY].getAsString().c_str());
+            }
+        }
 
-    getConsole().L();
-    getConsole().OLnOI("Initializing Input ...");
-    if ( p->m_inputHandler.initialize( window.getWndHandle() ) )
-    {
-        getConsole().SOLnOO("Done!");
-        getConsole().OLn("");
-    }
-    else
-    {
-        getConsole().EOLnOO("Failed!");
-        getConsole().OLn("");
+        PureWindow& window = p->m_gfx.getWindow();
+        window.SetAutoCleanupOnQuitOn(false);
+        window.SetCaption( p->m_sGameTitle );
+        window.ShowFull();
+        window.WriteSettings();
+        //window.SetCursorVisible(false);
+
+        getConsole().L();
+        getConsole().OLnOI("Initializing Input ...");
+        if ( p->m_inputHandler.initialize( window.getWndHandle() ) )
+        {
+            getConsole().SOLnOO("Done!");
+            getConsole().OLn("");
+        }
+        else
+        {
+            getConsole().EOLnOO("Failed!");
+            getConsole().OLn("");
+        }
+        getConsole().L();
     }
-    getConsole().L();
 
     getConsole().L();
     getConsole().OLnOI("Initializing World ...");
@@ -893,11 +956,17 @@ int PGE::initializeGame(const char* szCmdLine)
 
 /**
     Runs the game.
+    In headless mode, there is no window, so runGame() returns only after stopGame() is invoked or onPacketReceived() failed.
 
     @return A custom cookie value as returned by getCookie().
 */
 int PGE::runGame()
 {
+    if (isHeadless())
+    {
+        return runGameHeadless();
+    }
+
     std::chrono::time_point<std::chrono::steady_clock> timeNow = std::chrono::steady_clock::now();
     std::chrono::time_point<std::chrono::steady_clock> timeLastTime = timeNow;
 
@@ -910,18 +979,16 @@ int PGE::runGame()
         onGameFrameBegin();
         
         window.ProcessMessages();
-        p->m_bIsGameRunning = !window.hasCloseRequest();
+        if (window.hasCloseRequest())
+        {
+            p->m_bIsGameRunning = false;
+        }
 
         getNetwork().Update();  // this may also inject packet(s) to SysNET.queuePackets
-        while (getNetwork().getServerClientInstance()->getPacketQueueSize() > 0)
+        if (!processReceivedPackets())
         {
-            // as far as we check for packet queue size before pop, exception won't be thrown
-            if (!onPacketReceived(getNetwork().getServerClientInstance()->popFrontPacket()))
-            {
-                getConsole().EOLn("ERROR: onPacketReceived() failed, closing window ...");
-                window.Close();
-                break;
-            }
+            getConsole().EOLn("ERROR: onPacketReceived() failed, closing window ...");
+            window.Close();
         }
 
         // TODO: on the long run, bullet movement and collision handling could be put here ...       
@@ -948,6 +1015,9 @@ int PGE::runGame()
         //    // in inactive state, even though RenderScene() doesn't get called from here,
         //    // the scene may be re-rendered from WndProc(), if wnd repaint is needed ...
         //}
+
+        // app messages sent by onPacketReceived() and onGameRunning() are batched, we send them out once per frame
+        getNetwork().getServerClientInstance()->flushBatchedPackets();
     }
 
     return getCookie();
@@ -965,6 +1035,20 @@ bool PGE::isGameRunning() const
 } // isGameRunning()
 
 
+/**
+    Makes runGame() return after the current frame.
+    Expected to be invoked from the thread running runGame(), e.g. from onGameRunning() or onPacketReceived().
+    Useful in headless mode where there is no window to be closed.
+*/
+void PGE::stopGame()
+{
+    if (p)
+    {
+        p->m_bIsGameRunning = false;
+    }
+}
+
+
 /**
     Destroys the game engine.
     The game engine can be initialized again after this call.
@@ -981,6 +1065,19 @@ int PGE::destroyGame()
     return 0;
 } // destroyGameEngine()
 
+/**
+    Gets whether the engine runs without window, graphics, audio and input.
+    This is a dedicated server mode enabled by setting CVAR_SV_HEADLESS, only the config, network, world and weapons are available.
+    In this mode getPure() returns a non-initialized graphics engine, and weapons and bullets don't have any graphical object entity.
+    Valid after initializeGame().
+
+    @return True if the engine runs in headless mode, false otherwise.
+*/
+bool PGE::isHeadless() const
+{
+    return p ? p->m_bHeadless : false;
+}
+
 /**
     Gets the frequency for the main game engine loop.
     This controls how many times onGameRunning() will be invoked in each second by the game engine.
@@ -989,6 +1086,7 @@ int PGE::destroyGame()
 
     Note that even if this value is 0, maximum FPS might be limited by the current V-Sync setting.
     V-Sync is controlled by PureScreen::setVSyncEnabled().
+    In headless mode, 0 means the default 60 Hz tick rate, since a dedicated server should not run as fast as possible.
 */
 unsigned int PGE::getGameRunningFrequency() const
 {
@@ -1019,6 +1117,40 @@ void PGE::setRenderExtraDelayMillisecs(unsigned int nMillisecs)
     p->updateMinFrameTime(p->m_nTargetGameLoopFreq, nMillisecs);
 }
 
+/**
+    Feeds the received and injected packets of the given capture file to onPacketReceived(), exactly as runGame() would do
+    when they are received from network.
+    The capture file is expected to be recorded by setting PgeINetwork::CVAR_NET_CAPTURE_FILE.
+    Useful for reproducing a session or benchmarking the packet handling of the application without any network activity.
+
+    @param sFilename Name of the capture file.
+    @param pacing    Replay the packets as fast as possible, or with the same timing as they were recorded.
+
+    @return True if all packets are replayed, false if capture file cannot be read or onPacketReceived() failed.
+*/
+bool PGE::replayPacketCapture(const std::string& sFilename, const pge_network::PgePacketReplayer::Pacing& pacing)
+{
+    pge_network::PgePacketCaptureReader reader;
+    if (!reader.open(sFilename))
+    {
+        getConsole().EOLn("%s() ERROR: failed to open capture file: %s!", __func__, sFilename.c_str());
+        return false;
+    }
+
+    pge_network::PgePacketReplayer replayer;
+    const bool bSuccess = replayer.replay(
+        reader,
+        [this](const pge_network::PgePacket& pkt) { return onPacketReceived(pkt); },
+        pacing);
+
+    getConsole().OLn("%s() replayed %u packets from %u records in %u usecs",
+        __func__,
+        static_cast<uint32_t>(replayer.getReplayedPktCount()),
+        static_cast<uint32_t>(replayer.getReplayedRecordCount()),
+        static_cast<uint32_t>(replayer.getReplayDurationUSecs()));
+    return bSuccess;
+}
+
 
 // ############################## PROTECTED ##############################
 
@@ -1048,5 +1180,58 @@ PGE::~PGE()
 // ############################### PRIVATE ###############################
 
 
+/**
+    The main game engine loop in headless mode: no window messages, no input, no rendering.
+    onGameRunning() is invoked at the rate of getGameRunningFrequency(), scheduled by tickLimit().
+*/
+int PGE::runGameHeadless()
+{
+    getConsole().OLn("PGE::%s(): tick rate: %u Hz",
+        __func__, (getGameRunningFrequency() > 0) ? getGameRunningFrequency() : HEADLESS_DEFAULT_GAME_LOOP_FREQ);
 
+    std::chrono::time_point<std::chrono::steady_clock> timeNextTick = std::chrono::steady_clock::now();
 
+    while ( isGameRunning() )
+    {
+        onGameFrameBegin();
+
+        getNetwork().Update();  // this may also inject packet(s) to SysNET.queuePackets
+        if (!processReceivedPackets())
+        {
+            getConsole().EOLn("ERROR: onPacketReceived() failed, stopping game ...");
+            stopGame();
+        }
+
+        // there is no window that could be inactive
+        onGameRunning();
+
+        // app messages sent by onPacketReceived() and onGameRunning() are batched, we send them out once per frame
+        getNetwork().getServerClientInstance()->flushBatchedPackets();
+
+        p->tickLimit(timeNextTick);
+    }
+
+    return getCookie();
+} // runGameHeadless()
+
+
+/**
+    Passes all received and injected packets to onPacketReceived().
+
+    @return False if onPacketReceived() failed, true otherwise.
+*/
+bool PGE::processReceivedPackets()
+{
+    while (getNetwork().getServerClientInstance()->getPacketQueueSize() > 0)
+    {
+        // as far as we check for packet queue size before borrow, exception won't be thrown;
+        // the borrowed packet stays in the queue while being processed, so we don't copy it
+        const bool bPacketProcessed = onPacketReceived(getNetwork().getServerClientInstance()->borrowFrontPacket());
+        getNetwork().getServerClientInstance()->releaseFrontPacket();
+        if (!bPacketProcessed)
+        {
+            return false;
+        }
+    }
+    return true;
+} // processReceivedPackets()
@@ -23,6 +23,7 @@
 #include "Audio/PgeAudio.h"
 
 #include "Network/PgeNetwork.h"
+#include "Network/PgePacketReplayer.h"
 
 #include "PURE/include/external/PR00FsUltimateRenderingEngine.h"
 
@@ -61,6 +62,7 @@ class PGE
 public:
 
     static constexpr char* CVAR_GFX_WINDOWED = "gfx_windowed";  // TODO: Move this into PURE
+    static constexpr char* CVAR_SV_HEADLESS = "sv_headless";
 
     static const char* getVersionString();
 
@@ -102,7 +104,13 @@ public:
     int  initializeGame(const char* szCmdLine);  /**< Initializes the game engine. */
     int  runGame();                              /**< Runs the game. */
     bool isGameRunning() const;                  /**< Gets the running state of the game. */
+    void stopGame();                             /**< Makes runGame() return after the current frame. */
     int  destroyGame();                          /**< Destroys the game engine. */
+    bool isHeadless() const;                     /**< Gets whether the engine runs without window, graphics, audio and input. */
+
+    bool replayPacketCapture(
+        const std::string& sFilename,
+        const pge_network::PgePacketReplayer::Pacing& pacing);  /**< Feeds the received and injected packets of a capture file to onPacketReceived(). */
 
     unsigned int getGameRunningFrequency() const;      /**< Gets the frequency for the main game engine loop. */
     void setGameRunningFrequency(unsigned int freq);   /**< Sets the frequency for the main game engine loop. */
@@ -141,5 +149,8 @@ private:
     class PGEimpl;
     PGEimpl* p;
 
+    int  runGameHeadless();
+    bool processReceivedPackets();
+
 }; // class PGE
 
@@ -0,0 +1,208 @@
+/*
+    ###################################################################################
+    PgeCaptureDump.cpp
+    This file is part of PGE.
+    Prints the content of a packet capture file written by PgePacketCaptureWriter.
+    Made by PR00F88
+    ###################################################################################
+*/
+
+/*
+    Intentionally depends only on the standard library, so it can be built and used anywhere a capture file needs to be
+    inspected. The capture file layout is described in PGE/Network/PgePacketCapture.h, the packet layout is described in
+    PGE/Network/PgePacket.h, keep this in sync with them.
+
+    Usage: PgeCaptureDump <capture file> [--summary]
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+static constexpr char     szMagic[] = "PGEC";
+static constexpr uint16_t nSupportedVersion = 1;
+static constexpr size_t   nFileHeaderSize = 16;
+static constexpr size_t   nRecordHeaderSize = 16;
+
+// PgePacket: uint32_t pktId, uint32_t connHandleServerSide, then the message; app message area: uint8_t msgCount, uint8_t areaLength,
+// then the app messages, each being uint16_t msgId, uint8_t msgSize, then msgSize bytes of data.
+static constexpr size_t   nPktHeaderSize = 8;
+static constexpr size_t   nMsgAppAreaHeaderSize = 2;
+static constexpr size_t   nMsgAppHeaderSize = 3;
+static constexpr uint32_t nPktIdApplication = 3;
+
+static const char* const szDirections[] = { "Rx", "Tx", "Inject" };
+static const char* const szPktIds[] = { "UserConnectedServerSelf", "UserDisconnectedFromServer", "ClientAppVersion", "Application" };
+
+template <typename T>
+static T readLE(const uint8_t* pData)
+{
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); i++)
+    {
+        value |= static_cast<T>(static_cast<T>(pData[i]) << (8 * i));
+    }
+    return value;
+}
+
+struct DirectionSummary
+{
+    uint64_t m_nPktCount = 0;
+    uint64_t m_nPktBytes = 0;
+    std::map<uint16_t, uint64_t> m_mapMsgAppCount;
+};
+
+/**
+    Prints the app messages of the given app message packet, and counts them into the given summary.
+
+    @return False if the app message area is inconsistent, true otherwise.
+*/
+static bool dumpMsgApps(const uint8_t* pPkt, size_t nPktSize, DirectionSummary& summary, bool bPrint)
+{
+    if (nPktSize < nPktHeaderSize + nMsgAppAreaHeaderSize)
+    {
+        return false;
+    }
+
+    const uint8_t nMsgCount = pPkt[nPktHeaderSize];
+    size_t nPos = nPktHeaderSize + nMsgAppAreaHeaderSize;
+    if (bPrint)
+    {
+        printf(" msgs=%u [", nMsgCount);
+    }
+    for (uint8_t i = 0; i < nMsgCount; i++)
+    {
+        if (nPos + nMsgAppHeaderSize > nPktSize)
+        {
+            return false;
+        }
+        const uint16_t nMsgId = readLE<uint16_t>(pPkt + nPos);
+        const uint8_t nMsgSize = pPkt[nPos + 2];
+        if (bPrint)
+        {
+            printf("%sid=%u size=%u", (i == 0) ? "" : ", ", nMsgId, nMsgSize);
+        }
+        summary.m_mapMsgAppCount[nMsgId]++;
+        nPos += nMsgAppHeaderSize + nMsgSize;
+    }
+    if (bPrint)
+    {
+        printf("]");
+    }
+    return nPos <= nPktSize;
+}
+
+int main(int argc, char* argv[])
+{
+    if ((argc < 2) || (argc > 3) || ((argc == 3) && (strcmp(argv[2], "--summary") != 0)))
+    {
+        fprintf(stderr, "Usage: %s <capture file> [--summary]\n", argv[0]);
+        return 1;
+    }
+    const bool bPrintRecords = (argc == 2);
+
+    std::ifstream f(argv[1], std::ios::in | std::ios::binary);
+    if (!f.is_open())
+    {
+        fprintf(stderr, "Failed to open file: %s\n", argv[1]);
+        return 1;
+    }
+    const std::vector<uint8_t> vData((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+    if ((vData.size() < nFileHeaderSize) || (memcmp(vData.data(), szMagic, 4) != 0))
+    {
+        fprintf(stderr, "Not a capture file: %s\n", argv[1]);
+        return 1;
+    }
+
+    const uint16_t nVersion = readLE<uint16_t>(&vData[4]);
+    const uint16_t nHeaderSize = readLE<uint16_t>(&vData[6]);
+    const uint32_t nMaxPktSize = readLE<uint32_t>(&vData[8]);
+    printf("Capture file: %s, version: %u, max pkt size: %u, file size: %zu\n", argv[1], nVersion, nMaxPktSize, vData.size());
+    if (nVersion != nSupportedVersion)
+    {
+        fprintf(stderr, "Unsupported version %u, expected %u\n", nVersion, nSupportedVersion);
+        return 1;
+    }
+    if ((nHeaderSize < nFileHeaderSize) || (nHeaderSize > vData.size()))
+    {
+        fprintf(stderr, "Invalid header size: %u\n", nHeaderSize);
+        return 1;
+    }
+
+    if (bPrintRecords)
+    {
+        printf("%10s %14s %10s %-6s %5s  %s\n", "#", "time [us]", "conn", "dir", "size", "pkt");
+    }
+
+    DirectionSummary summaries[3];
+    uint64_t nRecordCount = 0;
+    uint64_t nLastTimeUSecs = 0;
+    size_t nPos = nHeaderSize;
+    while (nPos < vData.size())
+    {
+        if (vData.size() - nPos < nRecordHeaderSize)
+        {
+            fprintf(stderr, "Truncated record header at offset %zu\n", nPos);
+            return 1;
+        }
+
+        const uint8_t* const pRec = &vData[nPos];
+        const uint64_t nTimeUSecs = readLE<uint64_t>(pRec);
+        const uint32_t connHandle = readLE<uint32_t>(pRec + 8);
+        const uint8_t nDirection = pRec[12];
+        const uint16_t nPktSize = readLE<uint16_t>(pRec + 14);
+        if ((nDirection >= 3) || (nPktSize > nMaxPktSize) || (nPktSize > vData.size() - nPos - nRecordHeaderSize))
+        {
+            fprintf(stderr, "Invalid record at offset %zu\n", nPos);
+            return 1;
+        }
+
+        const uint8_t* const pPkt = pRec + nRecordHeaderSize;
+        const uint32_t nPktId = (nPktSize >= 4) ? readLE<uint32_t>(pPkt) : UINT32_MAX;
+        DirectionSummary& summary = summaries[nDirection];
+        summary.m_nPktCount++;
+        summary.m_nPktBytes += nPktSize;
+
+        if (bPrintRecords)
+        {
+            printf("%10llu %14llu %10u %-6s %5u  %s",
+                static_cast<unsigned long long>(nRecordCount),
+                static_cast<unsigned long long>(nTimeUSecs),
+                connHandle,
+                szDirections[nDirection],
+                nPktSize,
+                (nPktId <= nPktIdApplication) ? szPktIds[nPktId] : "Unknown");
+        }
+        const bool bConsistent = (nPktId != nPktIdApplication) || dumpMsgApps(pPkt, nPktSize, summary, bPrintRecords);
+        if (bPrintRecords)
+        {
+            printf(bConsistent ? "\n" : " (inconsistent)\n");
+        }
+
+        nLastTimeUSecs = nTimeUSecs;
+        nRecordCount++;
+        nPos += nRecordHeaderSize + nPktSize;
+    }
+
+    printf("\nRecords: %llu, duration: %llu us\n",
+        static_cast<unsigned long long>(nRecordCount), static_cast<unsigned long long>(nLastTimeUSecs));
+    for (size_t iDir = 0; iDir < 3; iDir++)
+    {
+        printf("%-6s pkts: %llu, bytes: %llu\n",
+            szDirections[iDir],
+            static_cast<unsigned long long>(summaries[iDir].m_nPktCount),
+            static_cast<unsigned long long>(summaries[iDir].m_nPktBytes));
+        for (const auto& msgAppCount : summaries[iDir].m_mapMsgAppCount)
+        {
+            printf("       app msg id %5u: %llu\n", msgAppCount.first, static_cast<unsigned long long>(msgAppCount.second));
+        }
+    }
+
+    return 0;
+}
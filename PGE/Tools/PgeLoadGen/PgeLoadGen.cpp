@@ -0,0 +1,382 @@
+/*
+    ###################################################################################
+    PgeLoadGen.cpp
+    This file is part of PGE.
+    Simulated client load generator for server capacity testing.
+    Made by PR00F88
+    ###################################################################################
+*/
+
+/*
+    Headless console tool driving simulated players by PgeLoadGenerator, without window, graphics, audio or input.
+
+    Loopback mode (default): runs an in-process PgeLoopbackServer with a reference server tick, and N PgeLoopbackClient instances
+    on a simulated link. Simulated time advances 1 tick per iteration as fast as possible, so the measured server tick duration
+    is pure CPU time, and results are reproducible for the same seed.
+    The reference server tick applies the input of each player, echoes probes, and sends the state of each player to all
+    clients, as a typical game server would do.
+
+    Remote mode (--connect): connects a PgeClient to a real server, running in real time at the given tick rate.
+    The server application needs to allow-list the input and probe app messages, and pass received packets to
+    PgeLoadGenerator::handleProbePkt(). Since PgeClient is a singleton, 1 process simulates 1 player, start multiple
+    instances for more players.
+
+    Usage: PgeLoadGen [--clients N] [--seconds S] [--warmup S] [--tickrate HZ] [--latency-ms L] [--jitter-ms J] [--loss P]
+                      [--bandwidth BYTESPERSEC] [--seed N] [--connect ADDRESS] [--appversion VERSION]
+*/
+
+#include "../../Config/PGEcfgProfiles.h"
+#include "../../Network/PgeClient.h"
+#include "../../Network/PgeLoadGenerator.h"
+#include "../../Network/PgeLoopbackClient.h"
+#include "../../Network/PgeLoopbackServer.h"
+#include "../../Network/PgeLoopbackTransport.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+static constexpr pge_network::MsgApp::TMsgId msgIdInput = 1;
+static constexpr pge_network::MsgApp::TMsgId msgIdProbe = 2;
+static constexpr pge_network::MsgApp::TMsgId msgIdPlayerState = 3;
+
+/**
+    Sent by the reference server to all clients about each player every tick.
+*/
+struct MsgPlayerState
+{
+    pge_network::PgeNetworkConnectionHandle m_connHandle;
+    float m_fPosX;
+    float m_fPosY;
+    float m_fAimAngle;
+    uint32_t m_nShotCount;
+    uint8_t m_iWeapon;
+};
+
+struct Options
+{
+    uint32_t m_nClients = 64;
+    uint32_t m_nSeconds = 30;
+    uint32_t m_nWarmupSeconds = 2;
+    uint32_t m_nTickRate = 60;
+    uint32_t m_nLatencyMs = 25;
+    uint32_t m_nJitterMs = 5;
+    float m_fLossRate = 0.f;
+    uint32_t m_nBandwidthBytesPerSec = 0;
+    uint64_t m_nSeed = 1;
+    std::string m_sConnectAddress;
+    std::string m_sAppVersion;
+};
+
+static bool parseOptions(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char* const szArg = argv[i];
+        if (i + 1 >= argc)
+        {
+            return false;
+        }
+        const char* const szValue = argv[++i];
+
+        if (strcmp(szArg, "--clients") == 0)
+        {
+            options.m_nClients = static_cast<uint32_t>(strtoul(szValue, nullptr, 10));
+        }
+        else if (strcmp(szArg, "--seconds") == 0)
+        {
+            options.m_nSeconds = static_cast<uint32_t>(strtoul(szValue, nullptr, 10));
+        }
+        else if (strcmp(szArg, "--warmup") == 0)
+        {
+            options.m_nWarmupSeconds = static_cast<uint32_t>(strtoul(szValue, nullptr, 10));
+        }
+        else if (strcmp(szArg, "--tickrate") == 0)
+        {
+            options.m_nTickRate = static_cast<uint32_t>(strtoul(szValue, nullptr, 10));
+        }
+        else if (strcmp(szArg, "--latency-ms") == 0)
+        {
+            options.m_nLatencyMs = static_cast<uint32_t>(strtoul(szValue, nullptr, 10));
+        }
+        else if (strcmp(szArg, "--jitter-ms") == 0)
+        {
+            options.m_nJitterMs = static_cast<uint32_t>(strtoul(szValue, nullptr, 10));
+        }
+        else if (strcmp(szArg, "--loss") == 0)
+        {
+            options.m_fLossRate = strtof(szValue, nullptr);
+        }
+        else if (strcmp(szArg, "--bandwidth") == 0)
+        {
+            options.m_nBandwidthBytesPerSec = static_cast<uint32_t>(strtoul(szValue, nullptr, 10));
+        }
+        else if (strcmp(szArg, "--seed") == 0)
+        {
+            options.m_nSeed = strtoull(szValue, nullptr, 10);
+        }
+        else if (strcmp(szArg, "--connect") == 0)
+        {
+            options.m_sConnectAddress = szValue;
+        }
+        else if (strcmp(szArg, "--appversion") == 0)
+        {
+            options.m_sAppVersion = szValue;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return (options.m_nClients > 0) && (options.m_nSeconds > 0) && (options.m_nTickRate > 0) &&
+        (options.m_fLossRate >= 0.f) && (options.m_fLossRate <= 1.f);
+}
+
+static void printPercentiles(const char* szName, const pge_network::PgeLoadGenerator::Percentiles& percentiles)
+{
+    printf("%-12s samples: %8u  p50: %8.3f ms  p90: %8.3f ms  p99: %8.3f ms  max: %8.3f ms\n",
+        szName, percentiles.m_nCount,
+        percentiles.m_nP50 / 1000.f, percentiles.m_nP90 / 1000.f, percentiles.m_nP99 / 1000.f, percentiles.m_nMax / 1000.f);
+}
+
+static void printReport(const pge_network::PgeLoadGenerator::Report& report)
+{
+    printf("Clients: %zu, joined: %zu, disconnected: %u, measured: %.1f s\n",
+        report.m_nClientCount, report.m_nJoinedClientCount, report.m_nDisconnectCount, report.m_nDurationUSecs / 1000000.f);
+    printf("Client msgs  tx: %10llu (%10.1f /s)  rx: %10llu (%10.1f /s)\n",
+        static_cast<unsigned long long>(report.m_nTxMsgCount), report.m_fTxMsgPerSec,
+        static_cast<unsigned long long>(report.m_nRxMsgCount), report.m_fRxMsgPerSec);
+    printPercentiles("RTT", report.m_rtt);
+    printPercentiles("Server tick", report.m_serverTick);
+}
+
+/**
+    Reference server tick: applies received input to players, echoes probes, then sends the state of each player to all clients.
+*/
+class ReferenceServer
+{
+public:
+
+    explicit ReferenceServer(pge_network::PgeLoopbackServer& server) :
+        m_server(server),
+        m_nLastTickUSecs(0)
+    {
+    }
+
+    void tick()
+    {
+        const auto timeStart = std::chrono::steady_clock::now();
+
+        m_server.Update();
+        while (m_server.getPacketQueueSize() > 0)
+        {
+            const pge_network::PgePacket& pkt = m_server.borrowFrontPacket();
+            const pge_network::PgeNetworkConnectionHandle connHandle = pge_network::PgePacket::getServerSideConnectionHandle(pkt);
+            switch (pge_network::PgePacket::getPacketId(pkt))
+            {
+            case pge_network::PgePktId::UserConnectedServerSelf:
+                if (connHandle != pge_network::ServerConnHandle)
+                {
+                    m_mapPlayers[connHandle] = MsgPlayerState{ connHandle, 0.f, 0.f, 0.f, 0, 0 };
+                }
+                break;
+            case pge_network::PgePktId::UserDisconnectedFromServer:
+                m_mapPlayers.erase(connHandle);
+                break;
+            case pge_network::PgePktId::Application:
+                if (!pge_network::PgeLoadGenerator::handleProbePkt(m_server, pkt, msgIdProbe, m_nLastTickUSecs) &&
+                    (pge_network::PgePacket::getMsgAppIdFromPkt(pkt) == msgIdInput))
+                {
+                    applyInput(connHandle, pge_network::PgePacket::getMsgAppDataFromPkt<pge_network::MsgLoadGenInput>(pkt));
+                }
+                break;
+            default:
+                break;
+            }
+            m_server.releaseFrontPacket();
+        }
+
+        for (const auto& connHandleAndPlayer : m_mapPlayers)
+        {
+            pge_network::PgePacket pkt;
+            pge_network::PgePacket::initPktMsgApp(pkt, pge_network::ServerConnHandle, pge_network::PgePacket::AutoFill::NONE);
+            pge_network::TByte* const pData = pge_network::PgePacket::preparePktMsgAppFill(pkt, msgIdPlayerState, sizeof(MsgPlayerState));
+            if (pData)
+            {
+                memcpy(pData, &connHandleAndPlayer.second, sizeof(MsgPlayerState));
+                m_server.sendToAllClientsExcept(pkt);
+            }
+        }
+        m_server.flushBatchedPackets();
+
+        m_nLastTickUSecs = static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - timeStart).count());
+    }
+
+private:
+
+    pge_network::PgeLoopbackServer& m_server;
+    std::map<pge_network::PgeNetworkConnectionHandle, MsgPlayerState> m_mapPlayers;
+    uint32_t m_nLastTickUSecs;
+
+    void applyInput(const pge_network::PgeNetworkConnectionHandle& connHandle, const pge_network::MsgLoadGenInput& input)
+    {
+        const auto it = m_mapPlayers.find(connHandle);
+        if (it == m_mapPlayers.end())
+        {
+            return;
+        }
+        MsgPlayerState& player = it->second;
+        player.m_fPosX = std::clamp(player.m_fPosX + input.m_nStrafe * 0.1f, -50.f, 50.f);
+        player.m_fPosY = input.m_bJump ? 1.f : std::max(0.f, player.m_fPosY - 0.05f);
+        player.m_fAimAngle = input.m_fAimAngle;
+        player.m_nShotCount += input.m_bAttack ? 1 : 0;
+        player.m_iWeapon = input.m_iWeapon;
+    }
+};
+
+static int runLoopback(const Options& options)
+{
+    pge_network::PgeLoopbackTransport::LinkConfig linkConfig;
+    linkConfig.m_nLatencyUSecs = options.m_nLatencyMs * 1000;
+    linkConfig.m_nJitterUSecs = options.m_nJitterMs * 1000;
+    linkConfig.m_fLossRate = options.m_fLossRate;
+    linkConfig.m_nBandwidthBytesPerSec = options.m_nBandwidthBytesPerSec;
+    pge_network::PgeLoopbackTransport transport(linkConfig, options.m_nSeed);
+
+    pge_network::PgeLoopbackServer server(transport);
+    if (!server.initialize())
+    {
+        fprintf(stderr, "Failed to initialize server!\n");
+        return 1;
+    }
+    server.getAllowListedAppMessages().insert(msgIdInput);
+    server.getAllowListedAppMessages().insert(msgIdProbe);
+    server.getMsgAppId2SendLaneMap()[msgIdInput] = pge_network::PgeSendLane::UnreliableNoDelay;
+    server.getMsgAppId2SendLaneMap()[msgIdPlayerState] = pge_network::PgeSendLane::Unreliable;
+    if (!server.startListening(options.m_sAppVersion))
+    {
+        fprintf(stderr, "Failed to start listening!\n");
+        return 1;
+    }
+    ReferenceServer refServer(server);
+
+    pge_network::PgeLoadGenerator loadGen(msgIdInput, msgIdProbe, pge_network::PgeLoadGenerator::Pattern(), transport.getTime(), options.m_nSeed);
+    std::vector<std::unique_ptr<pge_network::PgeLoopbackClient>> vClients;
+    for (uint32_t i = 0; i < options.m_nClients; i++)
+    {
+        vClients.push_back(std::make_unique<pge_network::PgeLoopbackClient>(transport));
+        pge_network::PgeLoopbackClient& client = *vClients.back();
+        client.getAllowListedAppMessages().insert(msgIdPlayerState);
+        client.getMsgAppId2SendLaneMap()[msgIdInput] = pge_network::PgeSendLane::UnreliableNoDelay;
+        if (!client.initialize() || !client.connectToServer("127.0.0.1", options.m_sAppVersion))
+        {
+            fprintf(stderr, "Failed to connect client %u!\n", i);
+            return 1;
+        }
+        loadGen.addClient(client);
+    }
+
+    printf("Loopback: %u clients, %u Hz, latency %u ms, jitter %u ms, loss %.3f, bandwidth %u bytes/s, %u s + %u s warm-up\n",
+        options.m_nClients, options.m_nTickRate, options.m_nLatencyMs, options.m_nJitterMs, options.m_fLossRate,
+        options.m_nBandwidthBytesPerSec, options.m_nSeconds, options.m_nWarmupSeconds);
+
+    const pge_network::PgeLoopbackTransport::TTimeUSecs nTickUSecs = 1000000 / options.m_nTickRate;
+    const uint64_t nWarmupTicks = static_cast<uint64_t>(options.m_nWarmupSeconds) * options.m_nTickRate;
+    const uint64_t nTicks = nWarmupTicks + static_cast<uint64_t>(options.m_nSeconds) * options.m_nTickRate;
+    const auto timeStart = std::chrono::steady_clock::now();
+    for (uint64_t iTick = 0; iTick < nTicks; iTick++)
+    {
+        if (iTick == nWarmupTicks)
+        {
+            loadGen.resetStats(transport.getTime());
+            transport.resetCounters();
+        }
+        transport.advanceTime(nTickUSecs);
+        refServer.tick();
+        loadGen.update(transport.getTime());
+    }
+    const auto durWall = std::chrono::steady_clock::now() - timeStart;
+
+    printReport(loadGen.getReport(transport.getTime()));
+    printf("Transport    sent: %llu  delivered: %llu  lost: %llu\n",
+        static_cast<unsigned long long>(transport.getSentCount()),
+        static_cast<unsigned long long>(transport.getDeliveredCount()),
+        static_cast<unsigned long long>(transport.getLostCount()));
+    printf("Wall time: %.3f s for %.1f s simulated\n",
+        std::chrono::duration_cast<std::chrono::milliseconds>(durWall).count() / 1000.f,
+        (nTicks * nTickUSecs) / 1000000.f);
+
+    server.shutdown();
+    return 0;
+}
+
+static int runRemote(const Options& options)
+{
+    if (options.m_nClients != 1)
+    {
+        fprintf(stderr, "PgeClient is a singleton, remote mode simulates 1 client per process, start multiple instances for more clients!\n");
+        return 1;
+    }
+
+    PGEcfgProfiles cfgProfiles;
+    pge_network::PgeIClient& client = pge_network::PgeClient::createAndGet(cfgProfiles);
+    client.getMsgAppId2SendLaneMap()[msgIdInput] = pge_network::PgeSendLane::UnreliableNoDelay;
+    if (!client.initialize() || !client.connectToServer(options.m_sConnectAddress, options.m_sAppVersion))
+    {
+        fprintf(stderr, "Failed to connect to %s!\n", options.m_sConnectAddress.c_str());
+        return 1;
+    }
+
+    const auto timeStart = std::chrono::steady_clock::now();
+    const auto getTimeUSecs = [&timeStart]() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - timeStart).count();
+    };
+
+    pge_network::PgeLoadGenerator loadGen(msgIdInput, msgIdProbe, pge_network::PgeLoadGenerator::Pattern(), getTimeUSecs(), options.m_nSeed);
+    loadGen.addClient(client);
+
+    printf("Remote: %s, %u Hz, %u s + %u s warm-up\n",
+        options.m_sConnectAddress.c_str(), options.m_nTickRate, options.m_nSeconds, options.m_nWarmupSeconds);
+
+    const std::chrono::microseconds durTick(1000000 / options.m_nTickRate);
+    const uint64_t nWarmupTicks = static_cast<uint64_t>(options.m_nWarmupSeconds) * options.m_nTickRate;
+    const uint64_t nTicks = nWarmupTicks + static_cast<uint64_t>(options.m_nSeconds) * options.m_nTickRate;
+    auto timeNextTick = timeStart;
+    for (uint64_t iTick = 0; iTick < nTicks; iTick++)
+    {
+        if (iTick == nWarmupTicks)
+        {
+            loadGen.resetStats(getTimeUSecs());
+        }
+        loadGen.update(getTimeUSecs());
+        timeNextTick += durTick;
+        std::this_thread::sleep_until(timeNextTick);
+    }
+
+    printReport(loadGen.getReport(getTimeUSecs()));
+    client.shutdown();
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        fprintf(stderr,
+            "Usage: %s [--clients N] [--seconds S] [--warmup S] [--tickrate HZ] [--latency-ms L] [--jitter-ms J] [--loss P]\n"
+            "          [--bandwidth BYTESPERSEC] [--seed N] [--connect ADDRESS] [--appversion VERSION]\n",
+            argv[0]);
+        return 1;
+    }
+
+    return options.m_sConnectAddress.empty() ? runLoopback(options) : runRemote(options);
+}
@@ -0,0 +1,540 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeBitStreamTest.h
+    Unit test for PgeFloatQuantizer, PgeBitWriter and PgeBitReader.
+    Made by PR00F88, West Whiskhyll Entertainment
+    2026
+    ###################################################################################
+*/
+
+#include "UnitTest.h"  // PCH
+
+#include "../Network/PgeBitStream.h"
+
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+class PgeBitStreamTest :
+    public UnitTest
+{
+public:
+
+    PgeBitStreamTest() :
+        UnitTest(__FILE__)
+    {
+    }
+
+protected:
+
+    virtual void initialize() override
+    {
+        addSubTest("test_quantizer_ctor_Bad", (PFNUNITSUBTEST)&PgeBitStreamTest::test_quantizer_ctor_Bad);
+        addSubTest("test_quantizer_getBits", (PFNUNITSUBTEST)&PgeBitStreamTest::test_quantizer_getBits);
+        addSubTest("test_quantizer_roundTrip", (PFNUNITSUBTEST)&PgeBitStreamTest::test_quantizer_roundTrip);
+        addSubTest("test_quantizer_clamps", (PFNUNITSUBTEST)&PgeBitStreamTest::test_quantizer_clamps);
+        addSubTest("test_writeBits_readBits", (PFNUNITSUBTEST)&PgeBitStreamTest::test_writeBits_readBits);
+        addSubTest("test_writeBits_Bad", (PFNUNITSUBTEST)&PgeBitStreamTest::test_writeBits_Bad);
+        addSubTest("test_writeBool_readBool", (PFNUNITSUBTEST)&PgeBitStreamTest::test_writeBool_readBool);
+        addSubTest("test_writeVarUInt_readVarUInt", (PFNUNITSUBTEST)&PgeBitStreamTest::test_writeVarUInt_readVarUInt);
+        addSubTest("test_readVarUInt_Malformed", (PFNUNITSUBTEST)&PgeBitStreamTest::test_readVarUInt_Malformed);
+        addSubTest("test_writeVarInt_readVarInt", (PFNUNITSUBTEST)&PgeBitStreamTest::test_writeVarInt_readVarInt);
+        addSubTest("test_writeFloat_readFloat", (PFNUNITSUBTEST)&PgeBitStreamTest::test_writeFloat_readFloat);
+        addSubTest("test_writer_overflow", (PFNUNITSUBTEST)&PgeBitStreamTest::test_writer_overflow);
+        addSubTest("test_reader_overflow", (PFNUNITSUBTEST)&PgeBitStreamTest::test_reader_overflow);
+        addSubTest("test_writer_reset", (PFNUNITSUBTEST)&PgeBitStreamTest::test_writer_reset);
+        addSubTest("test_msgApp_compactHeader", (PFNUNITSUBTEST)&PgeBitStreamTest::test_msgApp_compactHeader);
+        addSubTest("test_playerUpdate_roundTrip_viaPkt", (PFNUNITSUBTEST)&PgeBitStreamTest::test_playerUpdate_roundTrip_viaPkt);
+        addSubTest("test_benchmark_playerUpdate_encodeDecode", (PFNUNITSUBTEST)&PgeBitStreamTest::test_benchmark_playerUpdate_encodeDecode);
+    }
+
+private:
+
+    /**
+        A typical player update, as an application would send it as a raw struct.
+    */
+    struct MsgPlayerUpdate
+    {
+        float m_pos[3];
+        float m_angleY;
+        float m_angleZ;
+        int32_t m_nHealth;
+        int32_t m_nArmor;
+        uint32_t m_nWpnId;
+        bool m_bCrouching;
+        bool m_bJumping;
+        bool m_bAttacking;
+    };
+
+    const pge_network::PgeFloatQuantizer quantizerPos{ -1000.f, 1000.f, 0.01f };
+    const pge_network::PgeFloatQuantizer quantizerAngle{ 0.f, 360.f, 0.1f };
+
+    // ---------------------------------------------------------------------------
+
+    PgeBitStreamTest(const PgeBitStreamTest&)
+    {};
+
+    PgeBitStreamTest& operator=(const PgeBitStreamTest&)
+    {
+        return *this;
+    };
+
+    bool writePlayerUpdate(pge_network::PgeBitWriter& writer, const MsgPlayerUpdate& msg) const
+    {
+        for (const float& f : msg.m_pos)
+        {
+            writer.writeQuantizedFloat(f, quantizerPos);
+        }
+        writer.writeQuantizedFloat(msg.m_angleY, quantizerAngle);
+        writer.writeQuantizedFloat(msg.m_angleZ, quantizerAngle);
+        writer.writeVarInt(msg.m_nHealth);
+        writer.writeVarInt(msg.m_nArmor);
+        writer.writeVarUInt(msg.m_nWpnId);
+        writer.writeBool(msg.m_bCrouching);
+        writer.writeBool(msg.m_bJumping);
+        writer.writeBool(msg.m_bAttacking);
+        return !writer.isOverflowed();
+    }
+
+    bool readPlayerUpdate(pge_network::PgeBitReader& reader, MsgPlayerUpdate& msg) const
+    {
+        for (float& f : msg.m_pos)
+        {
+            reader.readQuantizedFloat(f, quantizerPos);
+        }
+        reader.readQuantizedFloat(msg.m_angleY, quantizerAngle);
+        reader.readQuantizedFloat(msg.m_angleZ, quantizerAngle);
+        reader.readVarInt(msg.m_nHealth);
+        reader.readVarInt(msg.m_nArmor);
+        reader.readVarUInt(msg.m_nWpnId);
+        reader.readBool(msg.m_bCrouching);
+        reader.readBool(msg.m_bJumping);
+        reader.readBool(msg.m_bAttacking);
+        return !reader.isOverflowed();
+    }
+
+    static MsgPlayerUpdate makePlayerUpdate(const uint32_t& i)
+    {
+        MsgPlayerUpdate msg{};
+        msg.m_pos[0] = -500.f + (i % 1000) * 0.37f;
+        msg.m_pos[1] = 10.f + (i % 50) * 0.5f;
+        msg.m_pos[2] = 999.99f - (i % 10);
+        msg.m_angleY = static_cast<float>(i % 360);
+        msg.m_angleZ = (i % 90) * 0.25f;
+        msg.m_nHealth = 100 - static_cast<int32_t>(i % 101);
+        msg.m_nArmor = static_cast<int32_t>(i % 50);
+        msg.m_nWpnId = i % 8;
+        msg.m_bCrouching = (i % 2) == 0;
+        msg.m_bJumping = (i % 3) == 0;
+        msg.m_bAttacking = (i % 5) == 0;
+        return msg;
+    }
+
+    bool assertPlayerUpdateEquals(const MsgPlayerUpdate& expected, const MsgPlayerUpdate& actual, const std::string& sText)
+    {
+        bool b = true;
+        for (std::size_t i = 0; i < 3; i++)
+        {
+            b &= assertTrue(std::abs(expected.m_pos[i] - actual.m_pos[i]) <= 0.005f + 0.0001f, (sText + " pos " + std::to_string(i)).c_str());
+        }
+        b &= assertTrue(std::abs(expected.m_angleY - actual.m_angleY) <= 0.05f + 0.0001f, (sText + " angleY").c_str());
+        b &= assertTrue(std::abs(expected.m_angleZ - actual.m_angleZ) <= 0.05f + 0.0001f, (sText + " angleZ").c_str());
+        b &= assertEquals(expected.m_nHealth, actual.m_nHealth, (sText + " health").c_str());
+        b &= assertEquals(expected.m_nArmor, actual.m_nArmor, (sText + " armor").c_str());
+        b &= assertEquals(expected.m_nWpnId, actual.m_nWpnId, (sText + " wpnId").c_str());
+        b &= assertEquals(expected.m_bCrouching, actual.m_bCrouching, (sText + " crouching").c_str());
+        b &= assertEquals(expected.m_bJumping, actual.m_bJumping, (sText + " jumping").c_str());
+        b &= assertEquals(expected.m_bAttacking, actual.m_bAttacking, (sText + " attacking").c_str());
+        return b;
+    }
+
+    bool test_quantizer_ctor_Bad()
+    {
+        bool b = true;
+        const float fBadParams[][3] = {
+            { 1.f, 1.f, 0.1f },
+            { 2.f, 1.f, 0.1f },
+            { 0.f, 1.f, 0.f },
+            { 0.f, 1.f, -0.1f },
+            { 0.f, std::numeric_limits<float>::infinity(), 0.1f },
+            { std::numeric_limits<float>::quiet_NaN(), 1.f, 0.1f },
+            { -1e30f, 1e30f, 1e-10f }
+        };
+
+        for (const auto& params : fBadParams)
+        {
+            try
+            {
+                const pge_network::PgeFloatQuantizer quantizer(params[0], params[1], params[2]);
+                b = assertTrue(false, (std::string("no exception ") + std::to_string(params[0])).c_str()) & b;
+            }
+            catch (const std::exception&)
+            {
+            }
+        }
+
+        return b;
+    }
+
+    bool test_quantizer_getBits()
+    {
+        bool b = assertEquals(18u, quantizerPos.getBits(), "pos");  // 200000 steps
+        b &= assertEquals(12u, quantizerAngle.getBits(), "angle");  // 3600 steps
+        b &= assertEquals(1u, pge_network::PgeFloatQuantizer(0.f, 1.f, 1.f).getBits(), "1 step");
+        b &= assertEquals(8u, pge_network::PgeFloatQuantizer(0.f, 255.f, 1.f).getBits(), "255 steps");
+        b &= assertEquals(9u, pge_network::PgeFloatQuantizer(0.f, 256.f, 1.f).getBits(), "256 steps");
+        b &= assertEquals(-1000.f, quantizerPos.getMin(), "min");
+        b &= assertEquals(1000.f, quantizerPos.getMax(), "max");
+        return b;
+    }
+
+    bool test_quantizer_roundTrip()
+    {
+        bool b = true;
+        for (int i = -100000; i <= 100000; i += 37)
+        {
+            const float f = i * 0.01f + 0.003f;
+            const float fRoundTrip = quantizerPos.dequantize(quantizerPos.quantize(f));
+            b &= assertTrue(std::abs(f - fRoundTrip) <= 0.005f + 0.0001f, ("pos " + std::to_string(f)).c_str());
+        }
+        b &= assertEquals(0u, quantizerPos.quantize(-1000.f), "min quantized");
+        b &= assertEquals(200000u, quantizerPos.quantize(1000.f), "max quantized");
+        b &= assertEquals(-1000.f, quantizerPos.dequantize(0), "min dequantized");
+        b &= assertEquals(1000.f, quantizerPos.dequantize(200000u), "max dequantized");
+        return b;
+    }
+
+    bool test_quantizer_clamps()
+    {
+        bool b = assertEquals(0u, quantizerAngle.quantize(-1.f), "below");
+        b &= assertEquals(3600u, quantizerAngle.quantize(361.f), "above");
+        b &= assertEquals(3600u, quantizerAngle.quantize(std::numeric_limits<float>::infinity()), "inf");
+        b &= assertEquals(0u, quantizerAngle.quantize(std::numeric_limits<float>::quiet_NaN()), "nan");
+        b &= assertEquals(360.f, quantizerAngle.dequantize(100000u), "dequantize above");
+        return b;
+    }
+
+    bool test_writeBits_readBits()
+    {
+        pge_network::TByte buffer[80]{};
+        pge_network::PgeBitWriter writer(buffer, sizeof(buffer));
+
+        // every width from 1 to 32, so values cross byte boundaries at every possible offset
+        bool b = true;
+        std::size_t nExpectedBits = 0;
+        for (std::size_t nBits = 1; nBits <= 32; nBits++)
+        {
+            const uint32_t nValue = (nBits == 32) ? 0xDEADBEEFu : (0xA5A5A5A5u & ((1u << nBits) - 1u));
+            b &= assertTrue(writer.writeBits(nValue | (nBits == 32 ? 0u : (1u << nBits))  /* bits above nBits are ignored */, nBits), ("write " + std::to_string(nBits)).c_str());
+            nExpectedBits += nBits;
+        }
+        b &= assertEquals(nExpectedBits, writer.getSizeBits(), "size bits");
+        b &= assertEquals((nExpectedBits + 7) / 8, writer.getSizeBytes(), "size bytes");
+        b &= assertFalse(writer.isOverflowed(), "writer overflowed");
+
+        pge_network::PgeBitReader reader(buffer, writer.getSizeBytes());
+        for (std::size_t nBits = 1; nBits <= 32; nBits++)
+        {
+            const uint32_t nExpected = (nBits == 32) ? 0xDEADBEEFu : (0xA5A5A5A5u & ((1u << nBits) - 1u));
+            uint32_t nValue = 0;
+            b &= assertTrue(reader.readBits(nValue, nBits), ("read " + std::to_string(nBits)).c_str());
+            b &= assertEquals(nExpected, nValue, ("value " + std::to_string(nBits)).c_str());
+        }
+        b &= assertEquals(nExpectedBits, reader.getReadBits(), "read bits");
+        b &= assertEquals(writer.getSizeBytes() * 8 - nExpectedBits, reader.getRemainingBits(), "remaining bits");
+        b &= assertFalse(reader.isOverflowed(), "reader overflowed");
+
+        return b;
+    }
+
+    bool test_writeBits_Bad()
+    {
+        pge_network::TByte buffer[8]{};
+        pge_network::PgeBitWriter writer(buffer, sizeof(buffer));
+        bool b = assertFalse(writer.writeBits(1, 0), "0 bits");
+        b &= assertTrue(writer.isOverflowed(), "overflowed 1");
+
+        pge_network::PgeBitWriter writer2(buffer, sizeof(buffer));
+        b &= assertFalse(writer2.writeBits(1, 33), "33 bits");
+        b &= assertTrue(writer2.isOverflowed(), "overflowed 2");
+
+        pge_network::PgeBitReader reader(buffer, sizeof(buffer));
+        uint32_t nValue = 5;
+        b &= assertFalse(reader.readBits(nValue, 0), "read 0 bits");
+        b &= assertEquals(5u, nValue, "value unchanged");
+        b &= assertTrue(reader.isOverflowed(), "reader overflowed");
+
+        return b;
+    }
+
+    bool test_writeBool_readBool()
+    {
+        pge_network::TByte buffer[2]{};
+        pge_network::PgeBitWriter writer(buffer, sizeof(buffer));
+        const bool bValues[] = { true, false, false, true, true, true, false, true, false, true };
+        bool b = true;
+        for (const bool& bValue : bValues)
+        {
+            b &= assertTrue(writer.writeBool(bValue), "write");
+        }
+        b &= assertEquals(10u, writer.getSizeBits(), "size bits");
+        b &= assertEquals(2u, writer.getSizeBytes(), "size bytes");
+
+        pge_network::PgeBitReader reader(buffer, writer.getSizeBytes());
+        for (std::size_t i = 0; i < sizeof(bValues); i++)
+        {
+            bool bValue = !bValues[i];
+            b &= assertTrue(reader.readBool(bValue), ("read " + std::to_string(i)).c_str());
+            b &= assertEquals(bValues[i], bValue, ("value " + std::to_string(i)).c_str());
+        }
+        return b;
+    }
+
+    bool test_writeVarUInt_readVarUInt()
+    {
+        const std::pair<uint32_t, std::size_t> values[] = {
+            { 0u, 8u },
+            { 1u, 8u },
+            { 127u, 8u },
+            { 128u, 16u },
+            { 16383u, 16u },
+            { 16384u, 24u },
+            { 2097151u, 24u },
+            { 2097152u, 32u },
+            { 268435455u, 32u },
+            { 268435456u, 40u },
+            { std::numeric_limits<uint32_t>::max(), 40u }
+        };
+
+        bool b = true;
+        for (const auto& value : values)
+        {
+            pge_network::TByte buffer[8]{};
+            pge_network::PgeBitWriter writer(buffer, sizeof(buffer));
+            b &= assertTrue(writer.writeBool(true), ("write misalign " + std::to_string(value.first)).c_str());
+            b &= assertTrue(writer.writeVarUInt(value.first), ("write " + std::to_string(value.first)).c_str());
+            b &= assertEquals(1u + value.second, writer.getSizeBits(), ("size " + std::to_string(value.first)).c_str());
+
+            pge_network::PgeBitReader reader(buffer, writer.getSizeBytes());
+            bool bMisalign = false;
+            uint32_t nValue = 0;
+            b &= assertTrue(reader.readBool(bMisalign), ("read misalign " + std::to_string(value.first)).c_str());
+            b &= assertTrue(reader.readVarUInt(nValue), ("read " + std::to_string(value.first)).c_str());
+            b &= assertEquals(value.first, nValue, ("value " + std::to_string(value.first)).c_str());
+        }
+        return b;
+    }
+
+    bool test_readVarUInt_Malformed()
+    {
+        // continuation bit set in all groups
+        pge_network::TByte buffer[8];
+        memset(buffer, 0xFF, sizeof(buffer));
+        pge_network::PgeBitReader reader(buffer, sizeof(buffer));
+        uint32_t nValue = 5;
+        bool b = assertFalse(reader.readVarUInt(nValue), "too many groups");
+        b &= assertEquals(5u, nValue, "value unchanged 1");
+        b &= assertTrue(reader.isOverflowed(), "overflowed 1");
+
+        // 5th group has more bits than 32 - 4 * 7
+        const pge_network::TByte buffer2[5] = { 0x80, 0x80, 0x80, 0x80, 0x10 };
+        pge_network::PgeBitReader reader2(buffer2, sizeof(buffer2));
+        b &= assertFalse(reader2.readVarUInt(nValue), "too big value");
+        b &= assertEquals(5u, nValue, "value unchanged 2");
+        b &= assertTrue(reader2.isOverflowed(), "overflowed 2");
+
+        return b;
+    }
+
+    bool test_writeVarInt_readVarInt()
+    {
+        const std::pair<int32_t, std::size_t> values[] = {
+            { 0, 8u },
+            { -1, 8u },
+            { 1, 8u },
+            { -64, 8u },
+            { 63, 8u },
+            { -65, 16u },
+            { 64, 16u },
+            { std::numeric_limits<int32_t>::min(), 40u },
+            { std::numeric_limits<int32_t>::max(), 40u }
+        };
+
+        bool b = true;
+        for (const auto& value : values)
+        {
+            pge_network::TByte buffer[8]{};
+            pge_network::PgeBitWriter writer(buffer, sizeof(buffer));
+            b &= assertTrue(writer.writeVarInt(value.first), ("write " + std::to_string(value.first)).c_str());
+            b &= assertEquals(value.second, writer.getSizeBits(), ("size " + std::to_string(value.first)).c_str());
+
+            pge_network::PgeBitReader reader(buffer, writer.getSizeBytes());
+            int32_t nValue = 0;
+            b &= assertTrue(reader.readVarInt(nValue), ("read " + std::to_string(value.first)).c_str());
+            b &= assertEquals(value.first, nValue, ("value " + std::to_string(value.first)).c_str());
+        }
+        return b;
+    }
+
+    bool test_writeFloat_readFloat()
+    {
+        const float values[] = { 0.f, -0.f, 1.5f, -123456.789f, std::numeric_limits<float>::max(), std::numeric_limits<float>::infinity() };
+
+        pge_network::TByte buffer[32]{};
+        pge_network::PgeBitWriter writer(buffer, sizeof(buffer));
+        bool b = assertTrue(writer.writeBool(true), "write misalign");
+        for (const float& f : values)
+        {
+            b &= assertTrue(writer.writeFloat(f), ("write " + std::to_string(f)).c_str());
+        }
+        b &= assertEquals(1u + 32u * (sizeof(values) / sizeof(values[0])), writer.getSizeBits(), "size bits");
+
+        pge_network::PgeBitReader reader(buffer, writer.getSizeBytes());
+        bool bMisalign = false;
+        b &= assertTrue(reader.readBool(bMisalign), "read misalign");
+        for (const float& f : values)
+        {
+            float fValue = 0.f;
+            b &= assertTrue(reader.readFloat(fValue), ("read " + std::to_string(f)).c_str());
+            b &= assertEquals(0, memcmp(&f, &fValue, sizeof(f)), ("value " + std::to_string(f)).c_str());
+        }
+        return b;
+    }
+
+    bool test_writer_overflow()
+    {
+        pge_network::TByte buffer[3] = { 0, 0, 0xCC };
+        pge_network::PgeBitWriter writer(buffer, 2);
+        bool b = assertTrue(writer.writeBits(0x3FFF, 14), "write 14");
+        b &= assertFalse(writer.writeBits(0x7, 3), "write 3");
+        b &= assertTrue(writer.isOverflowed(), "overflowed");
+        b &= assertFalse(writer.writeBool(true), "write 1 after overflow");
+        b &= assertEquals(14u, writer.getSizeBits(), "size bits");
+        b &= assertEquals(0xCCu, static_cast<unsigned>(buffer[2]), "no write beyond capacity");
+        return b;
+    }
+
+    bool test_reader_overflow()
+    {
+        const pge_network::TByte buffer[2] = { 0xFF, 0xFF };
+        pge_network::PgeBitReader reader(buffer, sizeof(buffer));
+        uint32_t nValue = 0;
+        bool b = assertTrue(reader.readBits(nValue, 14), "read 14");
+        nValue = 5;
+        b &= assertFalse(reader.readBits(nValue, 3), "read 3");
+        b &= assertEquals(5u, nValue, "value unchanged");
+        b &= assertTrue(reader.isOverflowed(), "overflowed");
+        bool bValue = false;
+        b &= assertFalse(reader.readBool(bValue), "read 1 after overflow");
+        b &= assertEquals(14u, reader.getReadBits(), "read bits");
+        return b;
+    }
+
+    bool test_writer_reset()
+    {
+        pge_network::TByte buffer[1]{};
+        pge_network::PgeBitWriter writer(buffer, sizeof(buffer));
+        writer.writeBits(0xFF, 8);
+        writer.writeBool(true);
+        bool b = assertTrue(writer.isOverflowed(), "overflowed");
+
+        writer.reset();
+        b &= assertFalse(writer.isOverflowed(), "not overflowed");
+        b &= assertEquals(0u, writer.getSizeBits(), "size bits");
+        b &= assertTrue(writer.writeBits(0x01, 2), "write after reset");
+        b &= assertEquals(0x01u, static_cast<unsigned>(buffer[0]), "previously written byte is overwritten");
+        return b;
+    }
+
+    bool test_msgApp_compactHeader()
+    {
+        pge_network::PgePacket pkt;
+        pge_network::PgePacket::initPktMsgApp(pkt, 0);
+        pge_network::TByte* const pData = pge_network::PgePacket::preparePktMsgAppFill(pkt, 1, 1);
+        bool b = assertNotNull(pData, "prepare");
+        if (b)
+        {
+            b &= assertEquals(
+                4u,
+                static_cast<unsigned>(pge_network::MsgApp::getMsgAppTotalActualSizeBytes(*pge_network::PgePacket::getMsgAppFromPkt(pkt))),
+                "3 bytes header + 1 byte data");
+        }
+        return b;
+    }
+
+    bool test_playerUpdate_roundTrip_viaPkt()
+    {
+        const MsgPlayerUpdate msg = makePlayerUpdate(12345);
+
+        pge_network::TByte buffer[pge_network::MsgApp::nMaxMessageLengthBytes];
+        pge_network::PgeBitWriter writer(buffer, sizeof(buffer));
+        bool b = assertTrue(writePlayerUpdate(writer, msg), "write");
+        b &= assertLess(writer.getSizeBytes() * 2, sizeof(MsgPlayerUpdate), "at least half size of raw struct");
+
+        pge_network::PgePacket pkt;
+        pge_network::PgePacket::initPktMsgApp(pkt, 0);
+        pge_network::TByte* const pData = pge_network::PgePacket::preparePktMsgAppFill(
+            pkt, 1, static_cast<pge_network::MsgApp::TMsgSize>(writer.getSizeBytes()));
+        b &= assertNotNull(pData, "prepare");
+        if (!b)
+        {
+            return false;
+        }
+        memcpy(pData, buffer, writer.getSizeBytes());
+
+        const pge_network::MsgApp& msgApp = *pge_network::PgePacket::getMsgAppFromPkt(pkt);
+        pge_network::PgeBitReader reader(pge_network::MsgApp::getMsgAppData(msgApp), pge_network::MsgApp::getMsgAppDataActualSizeBytes(msgApp));
+        MsgPlayerUpdate msgRead{};
+        b &= assertTrue(readPlayerUpdate(reader, msgRead), "read");
+        b &= assertPlayerUpdateEquals(msg, msgRead, "msg");
+        b &= assertLess(reader.getRemainingBits(), 8u, "all read");
+
+        return b;
+    }
+
+    bool test_benchmark_playerUpdate_encodeDecode()
+    {
+        constexpr uint32_t nMessageCount = 200000;
+
+        pge_network::TByte buffer[pge_network::MsgApp::nMaxMessageLengthBytes];
+        bool b = true;
+        std::size_t nTotalBytes = 0;
+        const auto timeStart = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < nMessageCount; i++)
+        {
+            const MsgPlayerUpdate msg = makePlayerUpdate(i);
+            pge_network::PgeBitWriter writer(buffer, sizeof(buffer));
+            writePlayerUpdate(writer, msg);
+            nTotalBytes += writer.getSizeBytes();
+
+            pge_network::PgeBitReader reader(buffer, writer.getSizeBytes());
+            MsgPlayerUpdate msgRead{};
+            readPlayerUpdate(reader, msgRead);
+            // checking all fields would dominate the measurement, so check only some of them
+            if ((msgRead.m_nHealth != msg.m_nHealth) || (msgRead.m_nWpnId != msg.m_nWpnId) || (msgRead.m_bAttacking != msg.m_bAttacking))
+            {
+                b &= assertPlayerUpdateEquals(msg, msgRead, "msg " + std::to_string(i));
+                break;
+            }
+        }
+        const auto timeEnd = std::chrono::steady_clock::now();
+
+        const auto nDurationUSecs = std::chrono::duration_cast<std::chrono::microseconds>(timeEnd - timeStart).count();
+        const double fMsgsPerSec = (nDurationUSecs > 0) ? (nMessageCount * 1000000.0 / nDurationUSecs) : 0.0;
+        CConsole::getConsoleInstance().OLn(
+            "PgeBitStreamTest::%s(): %u msgs encoded+decoded in %d us, %.0f msgs/sec, avg size: %.2f bytes (raw struct: %u bytes)",
+            __func__,
+            nMessageCount,
+            static_cast<int>(nDurationUSecs),
+            fMsgsPerSec,
+            static_cast<double>(nTotalBytes) / nMessageCount,
+            static_cast<unsigned>(sizeof(MsgPlayerUpdate)));
+
+        b &= assertLess(nTotalBytes, nMessageCount * sizeof(MsgPlayerUpdate), "total size");
+        return b;
+    }
+
+}; // class PgeBitStreamTest
@@ -0,0 +1,647 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeBulkTransferTest.h
+    Unit test for PgeBulkTransfer, PgeBulkSender and PgeBulkReceiver.
+    Made by PR00F88, West Whiskhyll Entertainment
+    2026
+    ###################################################################################
+*/
+
+#include "UnitTest.h"  // PCH
+
+#include "../Network/PgeBulkReceiver.h"
+#include "../Network/PgeBulkSender.h"
+#include "../Network/PgeBulkTransfer.h"
+#include "../Network/Stubs/PgeClientStub.h"
+#include "../Network/Stubs/PgeServerStub.h"
+
+#include <memory>
+#include <stdexcept>
+
+class PgeBulkTransferTest :
+    public UnitTest
+{
+public:
+
+    PgeBulkTransferTest() :
+        UnitTest(__FILE__)
+    {
+    }
+
+protected:
+
+    virtual void initialize() override
+    {
+        addSubTest("test_ctor_Bad", (PFNUNITSUBTEST)&PgeBulkTransferTest::test_ctor_Bad);
+        addSubTest("test_ctor", (PFNUNITSUBTEST)&PgeBulkTransferTest::test_ctor);
+        addSubTest("test_setters_Bad", (PFNUNITSUBTEST)&PgeBulkTransferTest::test_setters_Bad);
+        addSubTest("test_startTransfer_Bad", (PFNUNITSUBTEST)&PgeBulkTransferTest::test_startTransfer_Bad);
+        addSubTest("test_transfer", (PFNUNITSUBTEST)&PgeBulkTransferTest::test_transfer);
+        addSubTest("test_transfer_ClientToServer", (PFNUNITSUBTEST)&PgeBulkTransferTest::test_transfer_ClientToServer);
+        addSubTest("test_bandwidthBudget", (PFNUNITSUBTEST)&PgeBulkTransferTest::test_bandwidthBudget);
+        addSubTest("test_maxBytesInFlight", (PFNUNITSUBTEST)&PgeBulkTransferTest::test_maxBytesInFlight);
+        addSubTest("test_roundRobin", (PFNUNITSUBTEST)&PgeBulkTransferTest::test_roundRobin);
+        addSubTest("test_resume_AfterReconnect", (PFNUNITSUBTEST)&PgeBulkTransferTest::test_resume_AfterReconnect);
+        addSubTest("test_resume_AlreadyComplete", (PFNUNITSUBTEST)&PgeBulkTransferTest::test_resume_AlreadyComplete);
+        addSubTest("test_checksumMismatch_ReceivedAgain", (PFNUNITSUBTEST)&PgeBulkTransferTest::test_checksumMismatch_ReceivedAgain);
+        addSubTest("test_blobChanged_Replaced", (PFNUNITSUBTEST)&PgeBulkTransferTest::test_blobChanged_Replaced);
+        addSubTest("test_cancelTransfer", (PFNUNITSUBTEST)&PgeBulkTransferTest::test_cancelTransfer);
+        addSubTest("test_receiver_IgnoresBadAndUnknown", (PFNUNITSUBTEST)&PgeBulkTransferTest::test_receiver_IgnoresBadAndUnknown);
+    }
+
+private:
+
+    static constexpr pge_network::MsgApp::TMsgId msgIdChunk = 20;
+    static constexpr pge_network::MsgApp::TMsgId msgIdAck = 21;
+    static constexpr pge_network::PgeNetworkConnectionHandle connHandleClient = 5;
+    static constexpr pge_network::PgeNetworkConnectionHandle connHandleClientReconnected = 6;
+    static constexpr pge_network::PgeBulkTransfer::TTimeUSecs nTickUSecs = 10000;
+    static constexpr uint32_t nMaxBlobSizeBytes = 1024 * 1024;
+
+    PGEcfgProfiles cfgProfiles;
+
+    // ---------------------------------------------------------------------------
+
+    PgeBulkTransferTest(const PgeBulkTransferTest&)
+    {};
+
+    PgeBulkTransferTest& operator=(const PgeBulkTransferTest&)
+    {
+        return *this;
+    };
+
+    static std::shared_ptr<const std::vector<pge_network::TByte>> makeBlob(const std::size_t& nSize, const uint32_t& nSeed)
+    {
+        auto pBlob = std::make_shared<std::vector<pge_network::TByte>>(nSize);
+        uint32_t nState = nSeed;
+        for (auto& byte : *pBlob)
+        {
+            nState = nState * 1664525u + 1013904223u;
+            byte = static_cast<pge_network::TByte>(nState >> 24);
+        }
+        return pBlob;
+    }
+
+    static const pge_network::MsgBulkChunkHeader& getTxChunkHeader(const pge_network::PgePacket& pkt)
+    {
+        return pge_network::PgePacket::getMsgAppDataFromPkt<pge_network::MsgBulkChunkHeader>(pkt);
+    }
+
+    /**
+        Delivers the packets sent by server to the receiver on client side.
+        Server tx packets are cleared.
+    */
+    static void deliverToClient(
+        pge_network::PgeServerStub& server,
+        pge_network::PgeClientStub& client,
+        pge_network::PgeBulkReceiver& receiver)
+    {
+        for (const auto& connHandleAndPkt : server.getTxPackets())
+        {
+            receiver.handleChunkPkt(client, connHandleAndPkt.second);
+        }
+        server.clearTxPackets();
+    }
+
+    /**
+        Delivers the acks sent by client to the sender on server side, as sent from the given connection.
+        Client tx packets are cleared.
+    */
+    static void deliverToServer(
+        pge_network::PgeClientStub& client,
+        pge_network::PgeBulkSender& sender,
+        const pge_network::PgeNetworkConnectionHandle& connHandle = connHandleClient)
+    {
+        for (const auto& connHandleAndPkt : client.getTxPackets())
+        {
+            pge_network::PgePacket pkt = connHandleAndPkt.second;
+            // as done by PgeGnsServer::updateIncomingPgePacket()
+            pge_network::PgePacket::getServerSideConnectionHandle(pkt) = connHandle;
+            sender.handleAckPkt(pkt);
+        }
+        client.clearTxPackets();
+    }
+
+    /**
+        Runs ticks of server-to-client bulk transfer until the sender has no active transfer or the given number of ticks elapse.
+
+        @return Number of ticks run.
+    */
+    static uint32_t runTicks(
+        pge_network::PgeServerStub& server,
+        pge_network::PgeClientStub& client,
+        pge_network::PgeBulkSender& sender,
+        pge_network::PgeBulkReceiver& receiver,
+        pge_network::PgeBulkTransfer::TTimeUSecs& nTimeUSecs,
+        const uint32_t& nMaxTicks,
+        const pge_network::PgeNetworkConnectionHandle& connHandle = connHandleClient)
+    {
+        uint32_t nTicks = 0;
+        while ((nTicks < nMaxTicks) && (sender.getActiveTransferCount() > 0))
+        {
+            sender.update(server, nTimeUSecs);
+            deliverToClient(server, client, receiver);
+            deliverToServer(client, sender, connHandle);
+            nTimeUSecs += nTickUSecs;
+            ++nTicks;
+        }
+        return nTicks;
+    }
+
+    bool test_ctor_Bad()
+    {
+        bool b = true;
+        try
+        {
+            const pge_network::PgeBulkSender sender(msgIdChunk, msgIdChunk);
+            b = assertTrue(false, "sender no exception");
+        }
+        catch (const std::exception&)
+        {
+        }
+
+        try
+        {
+            const pge_network::PgeBulkReceiver receiver(msgIdAck, msgIdAck, nMaxBlobSizeBytes);
+            b = assertTrue(false, "receiver no exception 1") & b;
+        }
+        catch (const std::exception&)
+        {
+        }
+
+        try
+        {
+            const pge_network::PgeBulkReceiver receiver(msgIdChunk, msgIdAck, 0);
+            b = assertTrue(false, "receiver no exception 2") & b;
+        }
+        catch (const std::exception&)
+        {
+        }
+
+        return b;
+    }
+
+    bool test_ctor()
+    {
+        const pge_network::PgeBulkSender sender(msgIdChunk, msgIdAck);
+        const pge_network::PgeBulkReceiver receiver(msgIdChunk, msgIdAck, nMaxBlobSizeBytes);
+        pge_network::PgeBulkTransfer::Progress progress;
+
+        return assertEquals(msgIdChunk, sender.getMsgIdChunk(), "sender msgIdChunk") &
+            assertEquals(msgIdAck, sender.getMsgIdAck(), "sender msgIdAck") &
+            assertEquals(pge_network::PgeBulkSender::nDefaultBytesPerSecond, sender.getBytesPerSecond(), "sender bytes per sec") &
+            assertEquals(pge_network::PgeBulkSender::nDefaultMaxBytesInFlight, sender.getMaxBytesInFlight(), "sender max bytes in flight") &
+            assertEquals(0u, sender.getActiveTransferCount(), "sender active") &
+            assertEquals(0u, sender.getCompletedTransferCount(), "sender completed") &
+            assertEquals(0u, sender.getSentChunkDataBytes(), "sender sent bytes") &
+            assertFalse(sender.getProgress(connHandleClient, 1, progress), "sender progress") &
+            assertEquals(msgIdChunk, receiver.getMsgIdChunk(), "receiver msgIdChunk") &
+            assertEquals(msgIdAck, receiver.getMsgIdAck(), "receiver msgIdAck") &
+            assertEquals(nMaxBlobSizeBytes, receiver.getMaxBlobSizeBytes(), "receiver max blob size") &
+            assertEquals(0u, receiver.getCompletedBlobCount(), "receiver completed") &
+            assertEquals(0u, receiver.getFailedBlobCount(), "receiver failed") &
+            assertFalse(receiver.getProgress(1, progress), "receiver progress") &
+            assertNull(receiver.getBlob(1), "receiver blob");
+    }
+
+    bool test_setters_Bad()
+    {
+        pge_network::PgeBulkSender sender(msgIdChunk, msgIdAck);
+        bool b = true;
+        try
+        {
+            sender.setBytesPerSecond(0);
+            b = assertTrue(false, "bytes per sec no exception");
+        }
+        catch (const std::exception&)
+        {
+        }
+
+        try
+        {
+            sender.setMaxBytesInFlight(pge_network::PgeBulkSender::nMinMaxBytesInFlight - 1);
+            b = assertTrue(false, "max bytes in flight no exception") & b;
+        }
+        catch (const std::exception&)
+        {
+        }
+
+        sender.setBytesPerSecond(1000);
+        sender.setMaxBytesInFlight(pge_network::PgeBulkSender::nMinMaxBytesInFlight);
+        return b & assertEquals(1000u, sender.getBytesPerSecond(), "bytes per sec") &
+            assertEquals(pge_network::PgeBulkSender::nMinMaxBytesInFlight, sender.getMaxBytesInFlight(), "max bytes in flight");
+    }
+
+    bool test_startTransfer_Bad()
+    {
+        pge_network::PgeBulkSender sender(msgIdChunk, msgIdAck);
+        bool b = assertFalse(sender.startTransfer(connHandleClient, 1, nullptr), "null");
+        b &= assertFalse(sender.startTransfer(connHandleClient, 1, makeBlob(0, 1)), "empty");
+        b &= assertTrue(sender.startTransfer(connHandleClient, 1, makeBlob(100, 1)), "valid");
+        b &= assertFalse(sender.startTransfer(connHandleClient, 1, makeBlob(100, 1)), "duplicate");
+        b &= assertTrue(sender.startTransfer(connHandleClientReconnected, 1, makeBlob(100, 1)), "other conn");
+        return b & assertEquals(2u, sender.getActiveTransferCount(), "active");
+    }
+
+    bool test_transfer()
+    {
+        pge_network::PgeServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeClientStub client(cfgProfiles);
+        pge_network::PgeBulkSender sender(msgIdChunk, msgIdAck);
+        pge_network::PgeBulkReceiver receiver(msgIdChunk, msgIdAck, nMaxBlobSizeBytes);
+
+        const auto pBlob = makeBlob(100000, 1);
+        bool b = assertTrue(sender.startTransfer(connHandleClient, 7, pBlob), "start");
+
+        // first tick: chunks fill the initial budget, each in a separate packet, on the reliable lane as no lane is configured
+        pge_network::PgeBulkTransfer::TTimeUSecs nTimeUSecs = 0;
+        sender.update(server, nTimeUSecs);
+        b &= assertFalse(server.getTxPackets().empty(), "tx 1");
+        if (!b)
+        {
+            return false;
+        }
+        b &= assertEquals(connHandleClient, server.getTxPackets()[0].first, "tx 1 conn");
+        b &= assertEquals(7u, getTxChunkHeader(server.getTxPackets()[0].second).m_blobId, "tx 1 blob id");
+        b &= assertEquals(100000u, getTxChunkHeader(server.getTxPackets()[0].second).m_nBlobSizeBytes, "tx 1 blob size");
+        b &= assertEquals(0u, getTxChunkHeader(server.getTxPackets()[0].second).m_nOffset, "tx 1 offset");
+        b &= assertEquals(
+            static_cast<uint32_t>(pge_network::PgeBulkTransfer::nMaxChunkDataSizeBytes),
+            getTxChunkHeader(server.getTxPackets()[1].second).m_nOffset, "tx 2 offset");
+        b &= assertEquals(
+            static_cast<uint32_t>(server.getTxPackets().size()),
+            server.getTxLaneMsgCount().at(pge_network::PgeSendLane::Reliable), "tx lane");
+
+        pge_network::PgeBulkTransfer::Progress progress;
+        b &= assertTrue(sender.getProgress(connHandleClient, 7, progress), "sender progress 1");
+        b &= assertEquals(0u, progress.m_nDoneBytes, "sender progress 1 done");
+        deliverToClient(server, client, receiver);
+        b &= assertTrue(receiver.getProgress(7, progress), "receiver progress 1");
+        b &= assertEquals(100000u, progress.m_nBlobSizeBytes, "receiver progress 1 size");
+        b &= assertLess(0u, progress.m_nDoneBytes, "receiver progress 1 done");
+        b &= assertFalse(progress.m_bComplete, "receiver progress 1 complete");
+        b &= assertNull(receiver.getBlob(7), "receiver blob 1");
+        deliverToServer(client, sender);
+        b &= assertTrue(sender.getProgress(connHandleClient, 7, progress), "sender progress 2");
+        b &= assertLess(0u, progress.m_nDoneBytes, "sender progress 2 done");
+        nTimeUSecs += nTickUSecs;
+
+        runTicks(server, client, sender, receiver, nTimeUSecs, 1000);
+        b &= assertEquals(0u, sender.getActiveTransferCount(), "sender active");
+        b &= assertEquals(1u, sender.getCompletedTransferCount(), "sender completed");
+        b &= assertEquals(100000u, sender.getSentChunkDataBytes(), "sender sent bytes");
+        b &= assertTrue(sender.getProgress(connHandleClient, 7, progress), "sender progress 3");
+        b &= assertTrue(progress.m_bComplete, "sender progress 3 complete");
+        b &= assertEquals(1.f, progress.getRatio(), "sender progress 3 ratio");
+        b &= assertEquals(1u, receiver.getCompletedBlobCount(), "receiver completed");
+        b &= assertNotNull(receiver.getBlob(7), "receiver blob 2");
+        if (b)
+        {
+            b &= assertTrue(*pBlob == *receiver.getBlob(7), "receiver blob 2 data");
+        }
+
+        b &= assertTrue(receiver.removeBlob(7), "remove 1");
+        b &= assertFalse(receiver.removeBlob(7), "remove 2");
+        return b & assertNull(receiver.getBlob(7), "receiver blob 3");
+    }
+
+    bool test_transfer_ClientToServer()
+    {
+        pge_network::PgeServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeClientStub client(cfgProfiles);
+        pge_network::PgeBulkSender sender(msgIdChunk, msgIdAck);
+        pge_network::PgeBulkReceiver receiver(msgIdChunk, msgIdAck, nMaxBlobSizeBytes);
+
+        const auto pBlob = makeBlob(10000, 2);
+        bool b = assertTrue(sender.startTransfer(pge_network::ServerConnHandle, 3, pBlob), "start");
+        pge_network::PgeBulkTransfer::TTimeUSecs nTimeUSecs = 0;
+        for (int i = 0; (i < 100) && (sender.getActiveTransferCount() > 0); i++)
+        {
+            sender.update(client, nTimeUSecs);
+            for (const auto& connHandleAndPkt : client.getTxPackets())
+            {
+                b &= assertEquals(pge_network::ServerConnHandle, connHandleAndPkt.first, "chunk conn");
+                pge_network::PgePacket pkt = connHandleAndPkt.second;
+                pge_network::PgePacket::getServerSideConnectionHandle(pkt) = connHandleClient;
+                receiver.handleChunkPkt(server, pkt);
+            }
+            client.clearTxPackets();
+            for (const auto& connHandleAndPkt : server.getTxPackets())
+            {
+                b &= assertEquals(connHandleClient, connHandleAndPkt.first, "ack conn");
+                sender.handleAckPkt(connHandleAndPkt.second);
+            }
+            server.clearTxPackets();
+            nTimeUSecs += nTickUSecs;
+        }
+
+        b &= assertEquals(1u, sender.getCompletedTransferCount(), "sender completed");
+        b &= assertNotNull(receiver.getBlob(3), "receiver blob");
+        return b && assertTrue(*pBlob == *receiver.getBlob(3), "receiver blob data");
+    }
+
+    bool test_bandwidthBudget()
+    {
+        pge_network::PgeServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeClientStub client(cfgProfiles);
+        pge_network::PgeBulkSender sender(msgIdChunk, msgIdAck);
+        pge_network::PgeBulkReceiver receiver(msgIdChunk, msgIdAck, nMaxBlobSizeBytes);
+        sender.setBytesPerSecond(20000);
+
+        bool b = assertTrue(sender.startTransfer(connHandleClient, 1, makeBlob(200000, 3)), "start");
+        pge_network::PgeBulkTransfer::TTimeUSecs nTimeUSecs = 0;
+        std::size_t nMaxBytesPerTick = 0;
+        std::size_t nTotalBytes = 0;
+        // 2 seconds
+        for (int i = 0; i < 200; i++)
+        {
+            sender.update(server, nTimeUSecs);
+            std::size_t nTickBytes = 0;
+            for (const auto& connHandleAndPkt : server.getTxPackets())
+            {
+                nTickBytes += pge_network::MsgApp::getMsgAppDataActualSizeBytes(*pge_network::PgePacket::getMsgAppFromPkt(connHandleAndPkt.second));
+            }
+            if (i > 0)
+            {
+                nMaxBytesPerTick = std::max(nMaxBytesPerTick, nTickBytes);
+            }
+            nTotalBytes += nTickBytes;
+            deliverToClient(server, client, receiver);
+            deliverToServer(client, sender);
+            nTimeUSecs += nTickUSecs;
+        }
+
+        // initial budget is 100 ms worth, then 200 bytes per tick, so a full chunk goes out every few ticks
+        b &= assertLequals(nMaxBytesPerTick, static_cast<std::size_t>(pge_network::MsgApp::nMaxMessageLengthBytes), "max per tick");
+        b &= assertLequals(nTotalBytes, static_cast<std::size_t>(2000 + 2 * 20000), "total upper");
+        b &= assertLequals(static_cast<std::size_t>(2000 + 2 * 20000 - 2 * pge_network::MsgApp::nMaxMessageLengthBytes), nTotalBytes, "total lower");
+
+        // long pause does not result in a burst bigger than 100 ms worth
+        nTimeUSecs += 10 * 1000000;
+        sender.update(server, nTimeUSecs);
+        std::size_t nBurstBytes = 0;
+        for (const auto& connHandleAndPkt : server.getTxPackets())
+        {
+            nBurstBytes += pge_network::MsgApp::getMsgAppDataActualSizeBytes(*pge_network::PgePacket::getMsgAppFromPkt(connHandleAndPkt.second));
+        }
+        return b & assertLequals(nBurstBytes, static_cast<std::size_t>(2000), "burst");
+    }
+
+    bool test_maxBytesInFlight()
+    {
+        pge_network::PgeServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeClientStub client(cfgProfiles);
+        pge_network::PgeBulkSender sender(msgIdChunk, msgIdAck);
+        pge_network::PgeBulkReceiver receiver(msgIdChunk, msgIdAck, nMaxBlobSizeBytes);
+        sender.setBytesPerSecond(10 * 1024 * 1024);
+
+        bool b = assertTrue(sender.startTransfer(connHandleClient, 1, makeBlob(200000, 4)), "start");
+        pge_network::PgeBulkTransfer::TTimeUSecs nTimeUSecs = 0;
+        for (int i = 0; i < 10; i++)
+        {
+            sender.update(server, nTimeUSecs);
+            nTimeUSecs += nTickUSecs;
+        }
+        // acks not delivered yet
+        b &= assertLequals(static_cast<uint64_t>(sender.getMaxBytesInFlight()), sender.getSentChunkDataBytes(), "sent lower");
+        b &= assertLess(sender.getSentChunkDataBytes(), static_cast<uint64_t>(sender.getMaxBytesInFlight() + pge_network::PgeBulkTransfer::nMaxChunkDataSizeBytes), "sent upper");
+
+        const uint64_t nSentBytes = sender.getSentChunkDataBytes();
+        deliverToClient(server, client, receiver);
+        deliverToServer(client, sender);
+        sender.update(server, nTimeUSecs);
+        b &= assertLess(nSentBytes, sender.getSentChunkDataBytes(), "sent after ack");
+
+        runTicks(server, client, sender, receiver, nTimeUSecs, 1000);
+        return b & assertEquals(1u, receiver.getCompletedBlobCount(), "completed");
+    }
+
+    bool test_roundRobin()
+    {
+        pge_network::PgeServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeClientStub client(cfgProfiles);
+        pge_network::PgeBulkSender sender(msgIdChunk, msgIdAck);
+        pge_network::PgeBulkReceiver receiver(msgIdChunk, msgIdAck, nMaxBlobSizeBytes);
+
+        const auto pBlob1 = makeBlob(3000, 5);
+        const auto pBlob2 = makeBlob(3000, 6);
+        bool b = assertTrue(sender.startTransfer(connHandleClient, 1, pBlob1), "start 1");
+        b &= assertTrue(sender.startTransfer(connHandleClient, 2, pBlob2), "start 2");
+        sender.update(server, 0);
+        b &= assertLequals(static_cast<std::size_t>(4), server.getTxPackets().size(), "tx");
+        if (!b)
+        {
+            return false;
+        }
+        for (std::size_t i = 0; i < 4; i++)
+        {
+            b &= assertEquals(static_cast<uint32_t>(1 + i % 2), getTxChunkHeader(server.getTxPackets()[i].second).m_blobId, ("tx blob id " + std::to_string(i)).c_str());
+        }
+
+        pge_network::PgeBulkTransfer::TTimeUSecs nTimeUSecs = nTickUSecs;
+        deliverToClient(server, client, receiver);
+        deliverToServer(client, sender);
+        runTicks(server, client, sender, receiver, nTimeUSecs, 1000);
+        b &= assertEquals(2u, receiver.getCompletedBlobCount(), "completed");
+        return b && assertTrue((*pBlob1 == *receiver.getBlob(1)) && (*pBlob2 == *receiver.getBlob(2)), "data");
+    }
+
+    bool test_resume_AfterReconnect()
+    {
+        pge_network::PgeServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeClientStub client(cfgProfiles);
+        pge_network::PgeBulkSender sender(msgIdChunk, msgIdAck);
+        pge_network::PgeBulkReceiver receiver(msgIdChunk, msgIdAck, nMaxBlobSizeBytes);
+
+        const auto pBlob = makeBlob(200000, 7);
+        bool b = assertTrue(sender.startTransfer(connHandleClient, 1, pBlob), "start 1");
+        pge_network::PgeBulkTransfer::TTimeUSecs nTimeUSecs = 0;
+        runTicks(server, client, sender, receiver, nTimeUSecs, 30);
+
+        // connection lost with chunks in flight
+        sender.update(server, nTimeUSecs);
+        server.clearTxPackets();
+        sender.removeClient(connHandleClient);
+        pge_network::PgeBulkTransfer::Progress progress;
+        b &= assertTrue(receiver.getProgress(1, progress), "receiver progress 1");
+        const uint32_t nReceivedBeforeReconnect = progress.m_nDoneBytes;
+        b &= assertLess(0u, nReceivedBeforeReconnect, "received before reconnect");
+        b &= assertLess(nReceivedBeforeReconnect, 200000u, "incomplete before reconnect");
+        const uint64_t nSentBeforeReconnect = sender.getSentChunkDataBytes();
+
+        // reconnected: sender starts from the beginning, receiver makes it continue from where it stopped
+        b &= assertTrue(sender.startTransfer(connHandleClientReconnected, 1, pBlob), "start 2");
+        runTicks(server, client, sender, receiver, nTimeUSecs, 1000, connHandleClientReconnected);
+        b &= assertEquals(1u, sender.getCompletedTransferCount(), "sender completed");
+        b &= assertEquals(1u, receiver.getCompletedBlobCount(), "receiver completed");
+        b &= assertNotNull(receiver.getBlob(1), "receiver blob");
+        if (b)
+        {
+            b &= assertTrue(*pBlob == *receiver.getBlob(1), "receiver blob data");
+        }
+
+        const uint64_t nSentAfterReconnect = sender.getSentChunkDataBytes() - nSentBeforeReconnect;
+        return b & assertLess(nSentAfterReconnect, static_cast<uint64_t>(200000 - nReceivedBeforeReconnect + sender.getMaxBytesInFlight() + 1), "sent after reconnect");
+    }
+
+    bool test_resume_AlreadyComplete()
+    {
+        pge_network::PgeServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeClientStub client(cfgProfiles);
+        pge_network::PgeBulkSender sender(msgIdChunk, msgIdAck);
+        pge_network::PgeBulkReceiver receiver(msgIdChunk, msgIdAck, nMaxBlobSizeBytes);
+
+        const auto pBlob = makeBlob(5000, 8);
+        bool b = assertTrue(sender.startTransfer(connHandleClient, 1, pBlob), "start 1");
+        pge_network::PgeBulkTransfer::TTimeUSecs nTimeUSecs = 0;
+        runTicks(server, client, sender, receiver, nTimeUSecs, 1000);
+        b &= assertEquals(1u, sender.getCompletedTransferCount(), "completed 1");
+
+        // restarted transfer of the same blob completes after the first round trip
+        b &= assertTrue(sender.startTransfer(connHandleClient, 1, pBlob), "start 2");
+        b &= assertEquals(1u, sender.getActiveTransferCount(), "active");
+        b &= assertEquals(1u, runTicks(server, client, sender, receiver, nTimeUSecs, 1000), "ticks");
+        b &= assertEquals(2u, sender.getCompletedTransferCount(), "completed 2");
+        return b & assertEquals(1u, receiver.getCompletedBlobCount(), "receiver completed");
+    }
+
+    bool test_checksumMismatch_ReceivedAgain()
+    {
+        pge_network::PgeServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeClientStub client(cfgProfiles);
+        pge_network::PgeBulkSender sender(msgIdChunk, msgIdAck);
+        pge_network::PgeBulkReceiver receiver(msgIdChunk, msgIdAck, nMaxBlobSizeBytes);
+
+        const auto pBlob = makeBlob(1000, 9);
+        bool b = assertTrue(sender.startTransfer(connHandleClient, 1, pBlob), "start");
+        sender.update(server, 0);
+        b &= assertLess(static_cast<std::size_t>(1), server.getTxPackets().size(), "tx");
+        if (!b)
+        {
+            return false;
+        }
+
+        // corrupted data of the 2nd chunk
+        pge_network::PgePacket pktCorrupted = server.getTxPackets()[1].second;
+        pge_network::MsgApp::getMsgAppData(*pge_network::PgePacket::getMsgAppFromPkt(pktCorrupted))[sizeof(pge_network::MsgBulkChunkHeader)] ^= 0xFF;
+        receiver.handleChunkPkt(client, server.getTxPackets()[0].second);
+        receiver.handleChunkPkt(client, pktCorrupted);
+        for (std::size_t i = 2; i < server.getTxPackets().size(); i++)
+        {
+            receiver.handleChunkPkt(client, server.getTxPackets()[i].second);
+        }
+        server.clearTxPackets();
+        b &= assertEquals(1u, receiver.getFailedBlobCount(), "failed");
+        b &= assertNull(receiver.getBlob(1), "blob 1");
+        deliverToServer(client, sender);
+
+        pge_network::PgeBulkTransfer::TTimeUSecs nTimeUSecs = nTickUSecs;
+        runTicks(server, client, sender, receiver, nTimeUSecs, 1000);
+        b &= assertEquals(1u, receiver.getCompletedBlobCount(), "completed");
+        b &= assertEquals(2000u, sender.getSentChunkDataBytes(), "sent bytes");
+        b &= assertNotNull(receiver.getBlob(1), "blob 2");
+        return b && assertTrue(*pBlob == *receiver.getBlob(1), "blob 2 data");
+    }
+
+    bool test_blobChanged_Replaced()
+    {
+        pge_network::PgeServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeClientStub client(cfgProfiles);
+        pge_network::PgeBulkSender sender(msgIdChunk, msgIdAck);
+        pge_network::PgeBulkReceiver receiver(msgIdChunk, msgIdAck, nMaxBlobSizeBytes);
+
+        pge_network::PgeBulkTransfer::TTimeUSecs nTimeUSecs = 0;
+        bool b = assertTrue(sender.startTransfer(connHandleClient, 1, makeBlob(3000, 10)), "start 1");
+        runTicks(server, client, sender, receiver, nTimeUSecs, 1000);
+
+        const auto pBlob = makeBlob(5000, 11);
+        b &= assertTrue(sender.startTransfer(connHandleClient, 1, pBlob), "start 2");
+        runTicks(server, client, sender, receiver, nTimeUSecs, 1000);
+        b &= assertEquals(2u, receiver.getCompletedBlobCount(), "completed");
+        b &= assertNotNull(receiver.getBlob(1), "blob");
+        return b && assertTrue(*pBlob == *receiver.getBlob(1), "blob data");
+    }
+
+    bool test_cancelTransfer()
+    {
+        pge_network::PgeServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeBulkSender sender(msgIdChunk, msgIdAck);
+
+        bool b = assertTrue(sender.startTransfer(connHandleClient, 1, makeBlob(100000, 12)), "start");
+        b &= assertFalse(sender.cancelTransfer(connHandleClient, 2), "cancel other blob");
+        b &= assertFalse(sender.cancelTransfer(connHandleClientReconnected, 1), "cancel other conn");
+        b &= assertTrue(sender.cancelTransfer(connHandleClient, 1), "cancel");
+        b &= assertEquals(0u, sender.getActiveTransferCount(), "active");
+
+        pge_network::PgeBulkTransfer::Progress progress;
+        b &= assertFalse(sender.getProgress(connHandleClient, 1, progress), "progress");
+        sender.update(server, 0);
+        return b & assertTrue(server.getTxPackets().empty(), "tx");
+    }
+
+    bool test_receiver_IgnoresBadAndUnknown()
+    {
+        pge_network::PgeClientStub client(cfgProfiles);
+        pge_network::PgeBulkReceiver receiver(msgIdChunk, msgIdAck, 1000);
+
+        const auto makeChunk = [](const pge_network::MsgApp::TMsgId& msgId, const pge_network::MsgBulkChunkHeader& header, const std::size_t& nDataSize)
+        {
+            std::vector<pge_network::TByte> vData(sizeof(header) + nDataSize);
+            memcpy(vData.data(), &header, sizeof(header));
+            pge_network::PgePacket pkt;
+            pge_network::PgePacket::initPktMsgApp(pkt, pge_network::ServerConnHandle);
+            pge_network::TByte* const pData = pge_network::PgePacket::preparePktMsgAppFill(pkt, msgId, static_cast<pge_network::MsgApp::TMsgSize>(vData.size()));
+            memcpy(pData, vData.data(), vData.size());
+            return pkt;
+        };
+
+        pge_network::PgePacket pktNonApp;
+        pge_network::PgePacket::initPktPgeMsgUserDisconnected(pktNonApp, connHandleClient);
+        bool b = assertFalse(receiver.handleChunkPkt(client, pktNonApp), "non-app");
+
+        pge_network::MsgBulkChunkHeader header{};
+        header.m_blobId = 1;
+        header.m_nBlobSizeBytes = 100;
+        b &= assertFalse(receiver.handleChunkPkt(client, makeChunk(msgIdAck, header, 10)), "other msg id");
+        b &= assertTrue(receiver.handleChunkPkt(client, makeChunk(msgIdChunk, header, 0)), "no data");
+
+        header.m_nBlobSizeBytes = 1001;
+        b &= assertTrue(receiver.handleChunkPkt(client, makeChunk(msgIdChunk, header, 10)), "too big blob");
+        header.m_nBlobSizeBytes = 100;
+        header.m_nOffset = 95;
+        b &= assertTrue(receiver.handleChunkPkt(client, makeChunk(msgIdChunk, header, 10)), "beyond blob end");
+
+        pge_network::PgeBulkTransfer::Progress progress;
+        b &= assertFalse(receiver.getProgress(1, progress), "progress");
+        b &= assertTrue(client.getTxPackets().empty(), "no ack");
+
+        // out of order chunk: receiver tells to continue from 0, once
+        header.m_nOffset = 10;
+        b &= assertTrue(receiver.handleChunkPkt(client, makeChunk(msgIdChunk, header, 10)), "out of order 1");
+        header.m_nOffset = 20;
+        b &= assertTrue(receiver.handleChunkPkt(client, makeChunk(msgIdChunk, header, 10)), "out of order 2");
+        b &= assertEquals(1u, client.getTxPackets().size(), "resume ack");
+        if (b)
+        {
+            const pge_network::MsgBulkAck& ack = pge_network::PgePacket::getMsgAppDataFromPkt<pge_network::MsgBulkAck>(client.getTxPackets()[0].second);
+            b &= assertEquals(1u, ack.m_blobId, "resume ack blob id");
+            b &= assertEquals(0u, ack.m_nReceivedBytes, "resume ack received");
+            b &= assertTrue(ack.m_bResume, "resume ack resume");
+        }
+        b &= assertTrue(receiver.getProgress(1, progress), "progress 2");
+        return b & assertEquals(0u, progress.m_nDoneBytes, "progress 2 done");
+    }
+
+}; // class PgeBulkTransferTest
@@ -0,0 +1,558 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeBulletCollisionTest.h
+    Unit test for BulletCollision.
+    Made by PR00F88, West Whiskhyll Entertainment
+    2026
+    ###################################################################################
+*/
+
+#include "UnitTest.h"  // PCH
+
+#include "../Weapons/BulletCollision.h"
+
+#include <chrono>
+#include <random>
+#include <stdexcept>
+
+class PgeBulletCollisionTest :
+    public UnitTest
+{
+public:
+
+    PgeBulletCollisionTest() :
+        UnitTest(__FILE__)
+    {
+    }
+
+protected:
+
+    virtual void initialize() override
+    {
+        addSubTest("test_ctor", (PFNUNITSUBTEST)&PgeBulletCollisionTest::test_ctor);
+        addSubTest("test_ctor_InvalidArgs", (PFNUNITSUBTEST)&PgeBulletCollisionTest::test_ctor_InvalidArgs);
+        addSubTest("test_addWorldBox_buildWorld_clearWorld", (PFNUNITSUBTEST)&PgeBulletCollisionTest::test_addWorldBox_buildWorld_clearWorld);
+        addSubTest("test_findFirstHit_Empty", (PFNUNITSUBTEST)&PgeBulletCollisionTest::test_findFirstHit_Empty);
+        addSubTest("test_findFirstHit_World_Normals", (PFNUNITSUBTEST)&PgeBulletCollisionTest::test_findFirstHit_World_Normals);
+        addSubTest("test_findFirstHit_World_Earliest", (PFNUNITSUBTEST)&PgeBulletCollisionTest::test_findFirstHit_World_Earliest);
+        addSubTest("test_findFirstHit_World_BoxSpanningCells", (PFNUNITSUBTEST)&PgeBulletCollisionTest::test_findFirstHit_World_BoxSpanningCells);
+        addSubTest("test_findFirstHit_World_NoTunneling", (PFNUNITSUBTEST)&PgeBulletCollisionTest::test_findFirstHit_World_NoTunneling);
+        addSubTest("test_findFirstHit_World_OutsideGrid", (PFNUNITSUBTEST)&PgeBulletCollisionTest::test_findFirstHit_World_OutsideGrid);
+        addSubTest("test_findFirstHit_World_NotBuilt", (PFNUNITSUBTEST)&PgeBulletCollisionTest::test_findFirstHit_World_NotBuilt);
+        addSubTest("test_findFirstHit_StartInside", (PFNUNITSUBTEST)&PgeBulletCollisionTest::test_findFirstHit_StartInside);
+        addSubTest("test_findFirstHit_EndTouching", (PFNUNITSUBTEST)&PgeBulletCollisionTest::test_findFirstHit_EndTouching);
+        addSubTest("test_findFirstHit_Player", (PFNUNITSUBTEST)&PgeBulletCollisionTest::test_findFirstHit_Player);
+        addSubTest("test_findFirstHit_IgnoresPlayer", (PFNUNITSUBTEST)&PgeBulletCollisionTest::test_findFirstHit_IgnoresPlayer);
+        addSubTest("test_findFirstHit_SameAsBruteForce", (PFNUNITSUBTEST)&PgeBulletCollisionTest::test_findFirstHit_SameAsBruteForce);
+        addSubTest("test_findFirstHits", (PFNUNITSUBTEST)&PgeBulletCollisionTest::test_findFirstHits);
+        addSubTest("test_benchmark_findFirstHits", (PFNUNITSUBTEST)&PgeBulletCollisionTest::test_benchmark_findFirstHits);
+    }
+
+private:
+
+    static constexpr pge_network::PgeNetworkConnectionHandle nShooter = 100;
+
+    // ---------------------------------------------------------------------------
+
+    PgeBulletCollisionTest(const PgeBulletCollisionTest&)
+    {};
+
+    PgeBulletCollisionTest& operator=(const PgeBulletCollisionTest&)
+    {
+        return *this;
+    };
+
+    static PureAxisAlignedBoundingBox makeBlock(const float& x, const float& y, const float& z)
+    {
+        // map block sized box
+        return PureAxisAlignedBoundingBox(PureVector(x, y, z), PureVector(1.f, 1.f, 1.f));
+    }
+
+    static PureAxisAlignedBoundingBox makePlayer(const float& x, const float& y, const float& z)
+    {
+        // player-sized box
+        return PureAxisAlignedBoundingBox(PureVector(x, y, z), PureVector(1.f, 2.f, 1.f));
+    }
+
+    static BulletCollision::Segment makeSegment(const PureVector& start, const PureVector& end)
+    {
+        return BulletCollision::Segment{ start, end, nShooter };
+    }
+
+    /**
+        Map-like world: a floor, a ceiling and randomly placed blocks between them, in the XY plane as in a 2.5D game.
+    */
+    static void buildMap(BulletCollision& coll, std::vector<PureAxisAlignedBoundingBox>& vBoxes, const int& nWidth, const int& nHeight)
+    {
+        std::mt19937 rng(1234u);
+        std::uniform_real_distribution<float> dist01(0.f, 1.f);
+        for (int y = 0; y < nHeight; y++)
+        {
+            for (int x = 0; x < nWidth; x++)
+            {
+                if ((y == 0) || (y == nHeight - 1) || (dist01(rng) < 0.15f))
+                {
+                    vBoxes.push_back(makeBlock(static_cast<float>(x), static_cast<float>(y), 0.f));
+                    coll.addWorldBox(vBoxes.back());
+                }
+            }
+        }
+        coll.buildWorld();
+    }
+
+    static std::vector<BulletCollision::Segment> makeBulletSegments(const std::size_t& nCount, const int& nWidth, const int& nHeight)
+    {
+        std::mt19937 rng(5678u);
+        std::uniform_real_distribution<float> distX(0.f, static_cast<float>(nWidth));
+        std::uniform_real_distribution<float> distY(0.f, static_cast<float>(nHeight));
+        std::uniform_real_distribution<float> distAngle(0.f, 6.2831853f);
+        std::uniform_real_distribution<float> distLength(0.5f, 4.f);
+        std::vector<BulletCollision::Segment> vSegments;
+        vSegments.reserve(nCount);
+        for (std::size_t i = 0; i < nCount; i++)
+        {
+            const PureVector start(distX(rng), distY(rng), 0.f);
+            const float fAngle = distAngle(rng);
+            const float fLength = distLength(rng);
+            vSegments.push_back(makeSegment(start, start + PureVector(std::cos(fAngle), std::sin(fAngle), 0.f) * fLength));
+        }
+        return vSegments;
+    }
+
+    /**
+        Reference implementation: tests the segment against every box.
+    */
+    static bool findFirstHitBruteForce(const std::vector<PureAxisAlignedBoundingBox>& vBoxes, const BulletCollision::Segment& segment, uint32_t& iBox, float& fFraction)
+    {
+        bool bHit = false;
+        const PureVector delta = segment.m_end - segment.m_start;
+        for (uint32_t i = 0; i < vBoxes.size(); i++)
+        {
+            float fEnter = 0.f;
+            float fExit = 1.f;
+            bool bMiss = false;
+            for (TPureByte a = 0; (a < 3) && !bMiss; a++)
+            {
+                const float fMin = vBoxes[i].getPosVec()[a] - vBoxes[i].getSizeVec()[a] / 2.f;
+                const float fMax = vBoxes[i].getPosVec()[a] + vBoxes[i].getSizeVec()[a] / 2.f;
+                if (delta[a] == 0.f)
+                {
+                    bMiss = (segment.m_start[a] < fMin) || (segment.m_start[a] > fMax);
+                    continue;
+                }
+                float fNear = (fMin - segment.m_start[a]) / delta[a];
+                float fFar = (fMax - segment.m_start[a]) / delta[a];
+                if (fNear > fFar)
+                {
+                    std::swap(fNear, fFar);
+                }
+                fEnter = std::max(fEnter, fNear);
+                fExit = std::min(fExit, fFar);
+                bMiss = fEnter > fExit;
+            }
+            if (!bMiss && (!bHit || (fEnter < fFraction)))
+            {
+                bHit = true;
+                fFraction = fEnter;
+                iBox = i;
+            }
+        }
+        return bHit;
+    }
+
+    bool assertVecEquals(const PureVector& expected, const PureVector& actual, const std::string& sMsg)
+    {
+        return (assertEquals(expected.getX(), actual.getX(), 0.0001f, (sMsg + " x").c_str()) &
+            assertEquals(expected.getY(), actual.getY(), 0.0001f, (sMsg + " y").c_str()) &
+            assertEquals(expected.getZ(), actual.getZ(), 0.0001f, (sMsg + " z").c_str())) != 0;
+    }
+
+    bool test_ctor()
+    {
+        const BulletCollision coll(2.f);
+        return (assertEquals(2.f, coll.getCellSize(), "cell size") &
+            assertEquals(0u, coll.getWorldBoxCount(), "world boxes") &
+            assertFalse(coll.isWorldBuilt(), "built") &
+            assertEquals(0u, coll.getPlayerCount(), "players")) != 0;
+    }
+
+    bool test_ctor_InvalidArgs()
+    {
+        bool b = true;
+        try
+        {
+            const BulletCollision coll(0.f);
+            b &= assertTrue(false, "zero cell size");
+        }
+        catch (const std::exception&) {}
+        try
+        {
+            const BulletCollision coll(-1.f);
+            b &= assertTrue(false, "negative cell size");
+        }
+        catch (const std::exception&) {}
+        return b;
+    }
+
+    bool test_addWorldBox_buildWorld_clearWorld()
+    {
+        BulletCollision coll(2.f);
+        bool b = assertEquals(0u, coll.addWorldBox(makeBlock(0.f, 0.f, 0.f)), "id 1");
+        b &= assertEquals(1u, coll.addWorldBox(makeBlock(5.f, 0.f, 0.f)), "id 2");
+        b &= assertEquals(2u, coll.getWorldBoxCount(), "count 1");
+        b &= assertFalse(coll.isWorldBuilt(), "built 1");
+
+        coll.buildWorld();
+        b &= assertTrue(coll.isWorldBuilt(), "built 2");
+
+        coll.addWorldBox(makeBlock(10.f, 0.f, 0.f));
+        b &= assertFalse(coll.isWorldBuilt(), "built 3");
+
+        coll.clearWorld();
+        b &= assertEquals(0u, coll.getWorldBoxCount(), "count 2");
+        b &= assertTrue(coll.isWorldBuilt(), "built 4");
+
+        BulletCollision::Hit hit;
+        b &= assertFalse(coll.findFirstHit(makeSegment(PureVector(-5.f, 0.f, 0.f), PureVector(15.f, 0.f, 0.f)), hit), "hit");
+        b &= assertTrue(BulletCollision::HitType::None == hit.m_type, "hit type");
+        return b;
+    }
+
+    bool test_findFirstHit_Empty()
+    {
+        BulletCollision coll(2.f);
+        coll.buildWorld();
+
+        BulletCollision::Hit hit;
+        return (assertFalse(coll.findFirstHit(makeSegment(PureVector(0.f, 0.f, 0.f), PureVector(10.f, 0.f, 0.f)), hit), "hit") &
+            assertTrue(BulletCollision::HitType::None == hit.m_type, "hit type")) != 0;
+    }
+
+    bool test_findFirstHit_World_Normals()
+    {
+        BulletCollision coll(2.f);
+        coll.addWorldBox(makeBlock(0.f, 0.f, 0.f));
+        coll.buildWorld();
+
+        bool b = true;
+        BulletCollision::Hit hit;
+        b &= assertTrue(coll.findFirstHit(makeSegment(PureVector(-2.5f, 0.f, 0.f), PureVector(2.5f, 0.f, 0.f)), hit), "hit +x");
+        b &= assertTrue(BulletCollision::HitType::World == hit.m_type, "hit type");
+        b &= assertEquals(0u, hit.m_id, "id");
+        b &= assertEquals(0.4f, hit.m_fFraction, 0.0001f, "fraction +x");
+        b &= assertVecEquals(PureVector(-0.5f, 0.f, 0.f), hit.m_pos, "pos +x");
+        b &= assertVecEquals(PureVector(-1.f, 0.f, 0.f), hit.m_normal, "normal +x");
+
+        b &= assertTrue(coll.findFirstHit(makeSegment(PureVector(2.f, 0.2f, 0.f), PureVector(0.f, 0.2f, 0.f)), hit), "hit -x");
+        b &= assertEquals(0.75f, hit.m_fFraction, 0.0001f, "fraction -x");
+        b &= assertVecEquals(PureVector(1.f, 0.f, 0.f), hit.m_normal, "normal -x");
+
+        b &= assertTrue(coll.findFirstHit(makeSegment(PureVector(0.f, 3.f, 0.f), PureVector(0.f, -3.f, 0.f)), hit), "hit -y");
+        b &= assertVecEquals(PureVector(0.f, 0.5f, 0.f), hit.m_pos, "pos -y");
+        b &= assertVecEquals(PureVector(0.f, 1.f, 0.f), hit.m_normal, "normal -y");
+
+        b &= assertTrue(coll.findFirstHit(makeSegment(PureVector(0.f, 0.f, -1.f), PureVector(0.f, 0.f, 1.f)), hit), "hit +z");
+        b &= assertVecEquals(PureVector(0.f, 0.f, -1.f), hit.m_normal, "normal +z");
+
+        // diagonal, entering through the face hit last by the slabs
+        b &= assertTrue(coll.findFirstHit(makeSegment(PureVector(-1.5f, -1.f, 0.f), PureVector(0.5f, 1.f, 0.f)), hit), "hit diagonal");
+        b &= assertEquals(0.5f, hit.m_fFraction, 0.0001f, "fraction diagonal");
+        b &= assertVecEquals(PureVector(-1.f, 0.f, 0.f), hit.m_normal, "normal diagonal");
+
+        b &= assertFalse(coll.findFirstHit(makeSegment(PureVector(-2.5f, 0.6f, 0.f), PureVector(2.5f, 0.6f, 0.f)), hit), "miss");
+        return b;
+    }
+
+    bool test_findFirstHit_World_Earliest()
+    {
+        BulletCollision coll(2.f);
+        // added in reverse order, so the earliest hit is not the first tested box in insertion order
+        coll.addWorldBox(makeBlock(20.f, 0.f, 0.f));
+        coll.addWorldBox(makeBlock(10.f, 0.f, 0.f));
+        coll.addWorldBox(makeBlock(5.f, 0.f, 0.f));
+        coll.addWorldBox(makeBlock(5.f, 10.f, 0.f));
+        coll.buildWorld();
+
+        bool b = true;
+        BulletCollision::Hit hit;
+        b &= assertTrue(coll.findFirstHit(makeSegment(PureVector(0.f, 0.f, 0.f), PureVector(30.f, 0.f, 0.f)), hit), "hit forward");
+        b &= assertEquals(2u, hit.m_id, "id forward");
+        b &= assertVecEquals(PureVector(4.5f, 0.f, 0.f), hit.m_pos, "pos forward");
+
+        b &= assertTrue(coll.findFirstHit(makeSegment(PureVector(30.f, 0.f, 0.f), PureVector(0.f, 0.f, 0.f)), hit), "hit backward");
+        b &= assertEquals(0u, hit.m_id, "id backward");
+        b &= assertVecEquals(PureVector(20.5f, 0.f, 0.f), hit.m_pos, "pos backward");
+
+        b &= assertTrue(coll.findFirstHit(makeSegment(PureVector(7.f, 0.f, 0.f), PureVector(15.f, 0.f, 0.f)), hit), "hit from between");
+        b &= assertEquals(1u, hit.m_id, "id from between");
+        return b;
+    }
+
+    bool test_findFirstHit_World_BoxSpanningCells()
+    {
+        BulletCollision coll(1.f);
+        // long wall spanning many cells, and a small block behind its far end
+        coll.addWorldBox(PureAxisAlignedBoundingBox(PureVector(0.f, 0.f, 0.f), PureVector(10.f, 1.f, 1.f)));
+        coll.addWorldBox(makeBlock(3.f, 2.f, 0.f));
+        coll.buildWorld();
+
+        bool b = true;
+        BulletCollision::Hit hit;
+        // segment runs along the wall inside it, wall is entered first
+        b &= assertTrue(coll.findFirstHit(makeSegment(PureVector(-8.f, 0.f, 0.f), PureVector(8.f, 0.f, 0.f)), hit), "hit along");
+        b &= assertEquals(0u, hit.m_id, "id along");
+        b &= assertVecEquals(PureVector(-5.f, 0.f, 0.f), hit.m_pos, "pos along");
+
+        // segment reaches the wall only in a later cell than where it starts
+        b &= assertTrue(coll.findFirstHit(makeSegment(PureVector(3.f, 4.f, 0.f), PureVector(3.f, -4.f, 0.f)), hit), "hit through block");
+        b &= assertEquals(1u, hit.m_id, "id through block");
+        b &= assertTrue(coll.findFirstHit(makeSegment(PureVector(-3.f, 4.f, 0.f), PureVector(-3.f, -4.f, 0.f)), hit), "hit wall");
+        b &= assertEquals(0u, hit.m_id, "id wall");
+        b &= assertVecEquals(PureVector(-3.f, 0.5f, 0.f), hit.m_pos, "pos wall");
+        return b;
+    }
+
+    bool test_findFirstHit_World_NoTunneling()
+    {
+        BulletCollision coll(4.f);
+        // thin wall, much thinner than the distance the bullet covers in a tick
+        coll.addWorldBox(PureAxisAlignedBoundingBox(PureVector(0.f, 0.f, 0.f), PureVector(0.05f, 10.f, 10.f)));
+        coll.buildWorld();
+
+        BulletCollision::Hit hit;
+        // neither the start nor the end position of the bullet is in the wall
+        return (assertTrue(coll.findFirstHit(makeSegment(PureVector(-20.f, 1.f, 0.f), PureVector(30.f, 1.f, 0.f)), hit), "hit") &
+            assertEquals(0.4f - 0.025f / 50.f, hit.m_fFraction, 0.0001f, "fraction") &
+            assertVecEquals(PureVector(-1.f, 0.f, 0.f), hit.m_normal, "normal")) != 0;
+    }
+
+    bool test_findFirstHit_World_OutsideGrid()
+    {
+        BulletCollision coll(2.f);
+        coll.addWorldBox(makeBlock(0.f, 0.f, 0.f));
+        coll.addWorldBox(makeBlock(10.f, 10.f, 0.f));
+        coll.buildWorld();
+
+        bool b = true;
+        BulletCollision::Hit hit;
+        b &= assertFalse(coll.findFirstHit(makeSegment(PureVector(-10.f, -10.f, 0.f), PureVector(-5.f, -10.f, 0.f)), hit), "miss outside");
+        b &= assertFalse(coll.findFirstHit(makeSegment(PureVector(-10.f, 5.f, 0.f), PureVector(20.f, 5.f, 0.f)), hit), "miss crossing");
+        b &= assertTrue(coll.findFirstHit(makeSegment(PureVector(-10.f, -10.f, 0.f), PureVector(20.f, 20.f, 0.f)), hit), "hit from outside");
+        b &= assertEquals(0u, hit.m_id, "id from outside");
+        b &= assertTrue(coll.findFirstHit(makeSegment(PureVector(30.f, 30.f, 0.f), PureVector(5.f, 5.f, 0.f)), hit), "hit from outside backward");
+        b &= assertEquals(1u, hit.m_id, "id from outside backward");
+        return b;
+    }
+
+    bool test_findFirstHit_World_NotBuilt()
+    {
+        BulletCollision coll(2.f);
+        coll.addWorldBox(makeBlock(0.f, 0.f, 0.f));
+
+        BulletCollision::Hit hit;
+        bool b = assertFalse(coll.findFirstHit(makeSegment(PureVector(-5.f, 0.f, 0.f), PureVector(5.f, 0.f, 0.f)), hit), "not built");
+        coll.buildWorld();
+        b &= assertTrue(coll.findFirstHit(makeSegment(PureVector(-5.f, 0.f, 0.f), PureVector(5.f, 0.f, 0.f)), hit), "built");
+        return b;
+    }
+
+    bool test_findFirstHit_StartInside()
+    {
+        BulletCollision coll(2.f);
+        coll.addWorldBox(makeBlock(0.f, 0.f, 0.f));
+        coll.buildWorld();
+
+        BulletCollision::Hit hit;
+        bool b = assertTrue(coll.findFirstHit(makeSegment(PureVector(0.1f, 0.f, 0.f), PureVector(5.f, 0.f, 0.f)), hit), "hit");
+        b &= assertEquals(0.f, hit.m_fFraction, "fraction");
+        b &= assertVecEquals(PureVector(0.1f, 0.f, 0.f), hit.m_pos, "pos");
+        b &= assertVecEquals(PureVector(0.f, 0.f, 0.f), hit.m_normal, "normal");
+
+        // zero-length segment
+        b &= assertTrue(coll.findFirstHit(makeSegment(PureVector(0.1f, 0.f, 0.f), PureVector(0.1f, 0.f, 0.f)), hit), "hit zero length");
+        b &= assertFalse(coll.findFirstHit(makeSegment(PureVector(3.f, 0.f, 0.f), PureVector(3.f, 0.f, 0.f)), hit), "miss zero length");
+        return b;
+    }
+
+    bool test_findFirstHit_EndTouching()
+    {
+        BulletCollision coll(2.f);
+        coll.addWorldBox(makeBlock(0.f, 0.f, 0.f));
+        coll.buildWorld();
+        coll.addPlayer(1, makePlayer(10.f, 0.f, 0.f));
+
+        BulletCollision::Hit hit;
+        bool b = assertTrue(coll.findFirstHit(makeSegment(PureVector(-5.f, 0.f, 0.f), PureVector(-0.5f, 0.f, 0.f)), hit), "hit world");
+        b &= assertEquals(1.f, hit.m_fFraction, "fraction world");
+        b &= assertTrue(coll.findFirstHit(makeSegment(PureVector(5.f, 0.f, 0.f), PureVector(9.5f, 0.f, 0.f)), hit), "hit player");
+        b &= assertTrue(BulletCollision::HitType::Player == hit.m_type, "hit type player");
+        b &= assertEquals(1.f, hit.m_fFraction, "fraction player");
+        return b;
+    }
+
+    bool test_findFirstHit_Player()
+    {
+        BulletCollision coll(2.f);
+        coll.addWorldBox(makeBlock(10.f, 0.f, 0.f));
+        coll.buildWorld();
+        coll.addPlayer(1, makePlayer(5.f, 0.f, 0.f));
+        coll.addPlayer(2, makePlayer(15.f, 0.f, 0.f));
+        coll.addPlayer(3, makePlayer(3.f, 0.f, 0.f));
+
+        bool b = assertEquals(3u, coll.getPlayerCount(), "count");
+
+        BulletCollision::Hit hit;
+        b &= assertTrue(coll.findFirstHit(makeSegment(PureVector(7.f, 0.f, 0.f), PureVector(20.f, 0.f, 0.f)), hit), "world before player");
+        b &= assertTrue(BulletCollision::HitType::World == hit.m_type, "hit type world");
+        b &= assertEquals(0u, hit.m_id, "id world");
+
+        b &= assertTrue(coll.findFirstHit(makeSegment(PureVector(20.f, 0.f, 0.f), PureVector(0.f, 0.f, 0.f)), hit), "player before world");
+        b &= assertTrue(BulletCollision::HitType::Player == hit.m_type, "hit type player");
+        b &= assertEquals(2u, hit.m_id, "id player");
+        b &= assertVecEquals(PureVector(15.5f, 0.f, 0.f), hit.m_pos, "pos player");
+        b &= assertVecEquals(PureVector(1.f, 0.f, 0.f), hit.m_normal, "normal player");
+
+        b &= assertTrue(coll.findFirstHit(makeSegment(PureVector(0.f, 0.f, 0.f), PureVector(9.f, 0.f, 0.f)), hit), "nearest player");
+        b &= assertEquals(3u, hit.m_id, "id nearest player");
+
+        coll.clearPlayers();
+        b &= assertEquals(0u, coll.getPlayerCount(), "count cleared");
+        b &= assertFalse(coll.findFirstHit(makeSegment(PureVector(0.f, 0.f, 0.f), PureVector(9.f, 0.f, 0.f)), hit), "cleared");
+        return b;
+    }
+
+    bool test_findFirstHit_IgnoresPlayer()
+    {
+        BulletCollision coll(2.f);
+        coll.buildWorld();
+        coll.addPlayer(nShooter, makePlayer(0.f, 0.f, 0.f));
+        coll.addPlayer(1, makePlayer(5.f, 0.f, 0.f));
+
+        BulletCollision::Hit hit;
+        return (assertTrue(coll.findFirstHit(makeSegment(PureVector(0.f, 0.f, 0.f), PureVector(10.f, 0.f, 0.f)), hit), "hit") &
+            assertEquals(1u, hit.m_id, "id")) != 0;
+    }
+
+    bool test_findFirstHit_SameAsBruteForce()
+    {
+        constexpr int nWidth = 60;
+        constexpr int nHeight = 30;
+
+        BulletCollision coll(2.f);
+        std::vector<PureAxisAlignedBoundingBox> vBoxes;
+        buildMap(coll, vBoxes, nWidth, nHeight);
+
+        bool b = true;
+        const std::vector<BulletCollision::Segment> vSegments = makeBulletSegments(2000, nWidth, nHeight);
+        std::size_t nHits = 0;
+        for (const auto& segment : vSegments)
+        {
+            BulletCollision::Hit hit;
+            uint32_t iBoxExpected = 0;
+            float fFractionExpected = 0.f;
+            const bool bHitExpected = findFirstHitBruteForce(vBoxes, segment, iBoxExpected, fFractionExpected);
+            const bool bHit = coll.findFirstHit(segment, hit);
+            b &= assertEquals(bHitExpected, bHit, "hit");
+            if (bHit && bHitExpected)
+            {
+                ++nHits;
+                // different boxes can be hit at the same fraction, e.g. at the common edge of 2 blocks
+                b &= assertEquals(fFractionExpected, hit.m_fFraction, 0.0001f, "fraction");
+            }
+        }
+        b &= assertGreater(nHits, 0u, "some hits");
+        b &= assertLess(nHits, vSegments.size(), "some misses");
+        return b;
+    }
+
+    bool test_findFirstHits()
+    {
+        BulletCollision coll(2.f);
+        coll.addWorldBox(makeBlock(5.f, 0.f, 0.f));
+        coll.buildWorld();
+        coll.addPlayer(1, makePlayer(0.f, 5.f, 0.f));
+
+        const std::vector<BulletCollision::Segment> vSegments = {
+            makeSegment(PureVector(0.f, 0.f, 0.f), PureVector(10.f, 0.f, 0.f)),
+            makeSegment(PureVector(0.f, 0.f, 0.f), PureVector(-10.f, 0.f, 0.f)),
+            makeSegment(PureVector(0.f, 0.f, 0.f), PureVector(0.f, 10.f, 0.f))
+        };
+        std::vector<BulletCollision::Hit> vHits(10);
+
+        bool b = assertEquals(2u, coll.findFirstHits(vSegments, vHits), "hits");
+        b &= assertEquals(vSegments.size(), vHits.size(), "size");
+        if (b)
+        {
+            b &= assertTrue(BulletCollision::HitType::World == vHits[0].m_type, "hit 0");
+            b &= assertTrue(BulletCollision::HitType::None == vHits[1].m_type, "hit 1");
+            b &= assertTrue(BulletCollision::HitType::Player == vHits[2].m_type, "hit 2");
+            b &= assertEquals(1u, vHits[2].m_id, "id 2");
+        }
+
+        std::vector<BulletCollision::Hit> vNoHits;
+        b &= assertEquals(0u, coll.findFirstHits(std::vector<BulletCollision::Segment>(), vNoHits), "no segments");
+        b &= assertTrue(vNoHits.empty(), "no hits");
+        return b;
+    }
+
+    bool test_benchmark_findFirstHits()
+    {
+        constexpr int nWidth = 200;
+        constexpr int nHeight = 60;
+        constexpr int nIterations = 20;
+
+        BulletCollision coll(2.f);
+        std::vector<PureAxisAlignedBoundingBox> vBoxes;
+        buildMap(coll, vBoxes, nWidth, nHeight);
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            coll.addPlayer(i, makePlayer(static_cast<float>(i * 20 + 10), 10.f, 0.f));
+        }
+
+        bool b = true;
+        for (const std::size_t nBullets : { static_cast<std::size_t>(1000), static_cast<std::size_t>(10000) })
+        {
+            const std::vector<BulletCollision::Segment> vSegments = makeBulletSegments(nBullets, nWidth, nHeight);
+            std::vector<BulletCollision::Hit> vHits;
+
+            std::size_t nHits = 0;
+            const auto timeStart = std::chrono::steady_clock::now();
+            for (int iIter = 0; iIter < nIterations; iIter++)
+            {
+                nHits = coll.findFirstHits(vSegments, vHits);
+            }
+            const auto nDurationUSecs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - timeStart).count();
+
+            // brute force for comparison, only for 1 iteration since it is way slower
+            std::size_t nHitsBruteForce = 0;
+            const auto timeStartBruteForce = std::chrono::steady_clock::now();
+            for (const auto& segment : vSegments)
+            {
+                uint32_t iBox;
+                float fFraction;
+                if (findFirstHitBruteForce(vBoxes, segment, iBox, fFraction))
+                {
+                    ++nHitsBruteForce;
+                }
+            }
+            const auto nDurationBruteForceUSecs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - timeStartBruteForce).count();
+
+            b &= assertGequals(nHits, nHitsBruteForce, "hits");
+
+            const double fQueries = static_cast<double>(nBullets) * nIterations;
+            CConsole::getConsoleInstance().OLn(
+                "PgeBulletCollisionTest::%s(): %u bullets, %u world boxes: grid: %.3f ms/tick (%.0f bullets/ms), brute force world only: %.3f ms/tick",
+                __func__,
+                static_cast<unsigned>(nBullets),
+                static_cast<unsigned>(vBoxes.size()),
+                nDurationUSecs / 1000.0 / nIterations,
+                (nDurationUSecs > 0) ? (fQueries * 1000.0 / nDurationUSecs) : 0.0,
+                nDurationBruteForceUSecs / 1000.0);
+        }
+
+        return b;
+    }
+
+}; // class PgeBulletCollisionTest
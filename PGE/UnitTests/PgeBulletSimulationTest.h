@@ -0,0 +1,447 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeBulletSimulationTest.h
+    Unit test for BulletSimulation.
+    Made by PR00F88, West Whiskhyll Entertainment
+    2026
+    ###################################################################################
+*/
+
+#include "UnitTest.h"  // PCH
+
+#include "../Weapons/BulletSimulation.h"
+
+#include <chrono>
+#include <cmath>
+
+class PgeBulletSimulationTest :
+    public UnitTest
+{
+public:
+
+    PgeBulletSimulationTest() :
+        UnitTest(__FILE__)
+    {
+        engine = NULL;
+    }
+
+    PgeBulletSimulationTest(const PgeBulletSimulationTest&) = delete;
+    PgeBulletSimulationTest& operator=(const PgeBulletSimulationTest&) = delete;
+    PgeBulletSimulationTest(PgeBulletSimulationTest&&) = delete;
+    PgeBulletSimulationTest&& operator=(PgeBulletSimulationTest&&) = delete;
+
+protected:
+
+    virtual void initialize() override
+    {
+        PGEInputHandler& inputHandler = PGEInputHandler::createAndGet(cfgProfiles);
+
+        // graphics is intentionally not initialized, same as in headless mode of PGE: bullets do not have 3D objects
+        engine = &PR00FsUltimateRenderingEngine::createAndGet(cfgProfiles, inputHandler);
+
+        Bullet::resetGlobalBulletId();
+
+        addSubTest("test_initially_empty", (PFNUNITSUBTEST)&PgeBulletSimulationTest::test_initially_empty);
+        addSubTest("test_update_without_gravity_and_drag_same_as_bullet_update", (PFNUNITSUBTEST)&PgeBulletSimulationTest::test_update_without_gravity_and_drag_same_as_bullet_update);
+        addSubTest("test_update_applies_gravity", (PFNUNITSUBTEST)&PgeBulletSimulationTest::test_update_applies_gravity);
+        addSubTest("test_update_applies_drag", (PFNUNITSUBTEST)&PgeBulletSimulationTest::test_update_applies_drag);
+        addSubTest("test_update_drops_removed_bullets", (PFNUNITSUBTEST)&PgeBulletSimulationTest::test_update_drops_removed_bullets);
+        addSubTest("test_update_loads_bullet_reusing_slot", (PFNUNITSUBTEST)&PgeBulletSimulationTest::test_update_loads_bullet_reusing_slot);
+        addSubTest("test_update_zero_factor_does_nothing", (PFNUNITSUBTEST)&PgeBulletSimulationTest::test_update_zero_factor_does_nothing);
+        addSubTest("test_update_follows_pool_reserve", (PFNUNITSUBTEST)&PgeBulletSimulationTest::test_update_follows_pool_reserve);
+        addSubTest("test_resize_keeps_bullets_in_flight", (PFNUNITSUBTEST)&PgeBulletSimulationTest::test_resize_keeps_bullets_in_flight);
+        addSubTest("test_benchmark_update", (PFNUNITSUBTEST)&PgeBulletSimulationTest::test_benchmark_update);
+    }
+
+    virtual bool setUp() override
+    {
+        return assertTrue(engine && !engine->isInitialized());
+    }
+
+    virtual void tearDown() override
+    {
+        Bullet::resetGlobalBulletId();
+    }
+
+    virtual void finalize() override
+    {
+        Bullet::destroyReferenceObject();
+        if (engine)
+        {
+            engine->shutdown();
+            engine = NULL;
+        }
+    }
+
+private:
+
+    PR00FsUltimateRenderingEngine* engine;
+    PGEcfgProfiles cfgProfiles;
+
+    // ---------------------------------------------------------------------------
+
+    PooledBullet* createBullet(
+        PgeObjectPool<PooledBullet>& bullets,
+        const PureVector& pos,
+        float fAngleZ,
+        float fSpeed,
+        float fGravity,
+        float fDrag)
+    {
+        return bullets.create(
+            static_cast<WeaponId>(123u),
+            *engine,
+            static_cast<pge_network::PgeNetworkConnectionHandle>(0u),
+            pos.getX(), pos.getY(), pos.getZ(),
+            0.f, 90.f, fAngleZ,
+            false /* visible */,
+            1.f, 1.f, 1.f,
+            fSpeed, fGravity, fDrag, false /* fragile */,
+            0.f /* fDistMax */,
+            Bullet::ParticleType::None,
+            5 /* AP */, 10 /* HP */,
+            0.f, Bullet::DamageAreaEffect::Constant, 0.f);
+    }
+
+    bool assertVecEquals(const PureVector& expected, const PureVector& actual, float fEps, const std::string& sMsg)
+    {
+        return (assertEquals(expected.getX(), actual.getX(), fEps, (sMsg + " x").c_str()) &
+            assertEquals(expected.getY(), actual.getY(), fEps, (sMsg + " y").c_str()) &
+            assertEquals(expected.getZ(), actual.getZ(), fEps, (sMsg + " z").c_str())) != 0;
+    }
+
+    bool test_initially_empty()
+    {
+        PgeObjectPool<PooledBullet> bullets("pool", 10, *engine);
+        BulletSimulation sim(bullets);
+
+        bool b = assertEquals(static_cast<std::size_t>(0), sim.getActiveCount(), "active 1");
+        sim.Update(1);
+        b &= assertEquals(static_cast<std::size_t>(0), sim.getActiveCount(), "active 2");
+
+        return b;
+    }
+
+    bool test_update_without_gravity_and_drag_same_as_bullet_update()
+    {
+        constexpr unsigned int nFactor = 2;
+        constexpr float fSpeed = 60.f;
+
+        PgeObjectPool<PooledBullet> bullets("pool", 10, *engine);
+        BulletSimulation sim(bullets);
+
+        PooledBullet* const pBullet = createBullet(bullets, PureVector(1.f, 2.f, 3.f), 30.f, fSpeed, 0.f, 0.f);
+        bool b = assertNotNull(pBullet, "create");
+        if (!b)
+        {
+            return false;
+        }
+
+        Bullet bulletRef(
+            static_cast<WeaponId>(123u),
+            *engine,
+            0, 1.f, 2.f, 3.f,
+            0.f, 90.f, 30.f,
+            false /* visible */,
+            1.f, 1.f, 1.f,
+            fSpeed, 0.f, 0.f, false,
+            0.f /* fDistMax */,
+            Bullet::ParticleType::None,
+            5 /* AP */, 10 /* HP */,
+            0.f, Bullet::DamageAreaEffect::Constant, 0.f);
+
+        for (int i = 0; i < 10; i++)
+        {
+            sim.Update(nFactor);
+            bulletRef.Update(nFactor);
+
+            const std::string sIter = "iter " + std::to_string(i);
+            b &= assertVecEquals(bulletRef.getPut().getPosVec(), pBullet->getPut().getPosVec(), 0.001f, sIter + " pos");
+            b &= assertVecEquals(bulletRef.getPut().getTargetVec(), pBullet->getPut().getTargetVec(), 0.001f, sIter + " target");
+            b &= assertEquals(bulletRef.getTravelledDistance(), pBullet->getTravelledDistance(), 0.001f, (sIter + " dist").c_str());
+        }
+        b &= assertEquals(static_cast<std::size_t>(1), sim.getActiveCount(), "active");
+        b &= assertEquals(5.f, sim.getLifetime(*pBullet), 0.0001f, "lifetime");
+
+        return b;
+    }
+
+    bool test_update_applies_gravity()
+    {
+        PgeObjectPool<PooledBullet> bullets("pool", 10, *engine);
+        BulletSimulation sim(bullets);
+
+        PooledBullet* const pBullet = createBullet(bullets, PureVector(5.f, 0.f, 0.f), 0.f, 0.f /* speed */, 1.f /* gravity */, 0.f);
+        bool b = assertNotNull(pBullet, "create");
+        if (!b)
+        {
+            return false;
+        }
+
+        // semi-implicit Euler: after n iterations vy = -n and y = -(1 + 2 + ... + n)
+        float fExpectedY = 0.f;
+        for (int i = 1; i <= 5; i++)
+        {
+            sim.Update(1);
+            fExpectedY -= static_cast<float>(i);
+
+            const std::string sIter = "iter " + std::to_string(i);
+            b &= assertVecEquals(PureVector(5.f, fExpectedY, 0.f), pBullet->getPut().getPosVec(), 0.0001f, sIter + " pos");
+            b &= assertVecEquals(PureVector(0.f, -static_cast<float>(i), 0.f), sim.getVelocity(*pBullet), 0.0001f, sIter + " velocity");
+            b &= assertEquals(-fExpectedY, pBullet->getTravelledDistance(), 0.0001f, (sIter + " dist").c_str());
+        }
+
+        // PUT target follows the velocity
+        b &= assertVecEquals(PureVector(5.f, fExpectedY - 1.f, 0.f), pBullet->getPut().getTargetVec(), 0.0001f, "target");
+
+        return b;
+    }
+
+    bool test_update_applies_drag()
+    {
+        PgeObjectPool<PooledBullet> bullets("pool", 10, *engine);
+        BulletSimulation sim(bullets);
+
+        PooledBullet* const pBulletHalf = createBullet(bullets, PureVector(0.f, 0.f, 0.f), 0.f, 10.f, 0.f, 0.5f /* drag */);
+        PooledBullet* const pBulletStop = createBullet(bullets, PureVector(0.f, 0.f, 0.f), 0.f, 10.f, 0.f, 1.f /* drag */);
+        bool b = assertNotNull(pBulletHalf, "create 1") & assertNotNull(pBulletStop, "create 2");
+        if (!b)
+        {
+            return false;
+        }
+
+        const PureVector vecDirStop = pBulletStop->getPut().getTargetVec() - pBulletStop->getPut().getPosVec();
+
+        sim.Update(1);
+        b &= assertEquals(5.f, sim.getVelocity(*pBulletHalf).getLength(), 0.0001f, "speed 1");
+        b &= assertEquals(5.f, pBulletHalf->getTravelledDistance(), 0.0001f, "dist 1");
+        sim.Update(1);
+        b &= assertEquals(2.5f, sim.getVelocity(*pBulletHalf).getLength(), 0.0001f, "speed 2");
+        b &= assertEquals(7.5f, pBulletHalf->getTravelledDistance(), 0.0001f, "dist 2");
+
+        // stopped by drag: does not move, but keeps its direction
+        b &= assertEquals(0.f, pBulletStop->getTravelledDistance(), "dist stop");
+        b &= assertVecEquals(PureVector(0.f, 0.f, 0.f), pBulletStop->getPut().getPosVec(), 0.0001f, "pos stop");
+        b &= assertVecEquals(vecDirStop, pBulletStop->getPut().getTargetVec() - pBulletStop->getPut().getPosVec(), 0.0001f, "dir stop");
+
+        return b;
+    }
+
+    bool test_update_drops_removed_bullets()
+    {
+        PgeObjectPool<PooledBullet> bullets("pool", 10, *engine);
+        BulletSimulation sim(bullets);
+
+        PooledBullet* const pBullet1 = createBullet(bullets, PureVector(0.f, 0.f, 0.f), 0.f, 10.f, 0.f, 0.f);
+        PooledBullet* const pBullet2 = createBullet(bullets, PureVector(0.f, 10.f, 0.f), 0.f, 10.f, 0.f, 0.f);
+        PooledBullet* const pBullet3 = createBullet(bullets, PureVector(0.f, 20.f, 0.f), 0.f, 10.f, 0.f, 0.f);
+        bool b = assertNotNull(pBullet1, "create 1") & assertNotNull(pBullet2, "create 2") & assertNotNull(pBullet3, "create 3");
+        if (!b)
+        {
+            return false;
+        }
+
+        sim.Update(1);
+        b &= assertEquals(static_cast<std::size_t>(3), sim.getActiveCount(), "active 1");
+
+        bullets.remove(*pBullet2);
+        const PureVector vecPosRemoved = pBullet2->getPut().getPosVec();
+        const PureVector vecPos3 = pBullet3->getPut().getPosVec();
+
+        sim.Update(1);
+        b &= assertEquals(static_cast<std::size_t>(2), sim.getActiveCount(), "active 2");
+        b &= assertTrue(vecPosRemoved == pBullet2->getPut().getPosVec(), "removed pos");
+        b &= assertEquals(0.f, sim.getLifetime(*pBullet2), "removed lifetime");
+        b &= assertTrue(vecPos3 != pBullet3->getPut().getPosVec(), "pos 3");
+        b &= assertEquals(20.f, pBullet3->getTravelledDistance(), 0.0001f, "dist 3");
+
+        bullets.clear();
+        sim.Update(1);
+        b &= assertEquals(static_cast<std::size_t>(0), sim.getActiveCount(), "active 3");
+
+        return b;
+    }
+
+    bool test_update_loads_bullet_reusing_slot()
+    {
+        PgeObjectPool<PooledBullet> bullets("pool", 10, *engine);
+        BulletSimulation sim(bullets);
+
+        PooledBullet* const pBulletOld = createBullet(bullets, PureVector(0.f, 0.f, 0.f), 0.f, 10.f, 0.f, 0.f);
+        bool b = assertNotNull(pBulletOld, "create 1");
+        if (!b)
+        {
+            return false;
+        }
+
+        sim.Update(1);
+        sim.Update(1);
+
+        // removed and created again between 2 updates, the pool gives back the same object
+        bullets.remove(*pBulletOld);
+        PooledBullet* const pBulletNew = createBullet(bullets, PureVector(100.f, 0.f, 0.f), 0.f, 1.f, 0.f, 0.f);
+        b &= assertTrue(pBulletNew == pBulletOld, "same slot");
+
+        sim.Update(1);
+        b &= assertEquals(static_cast<std::size_t>(1), sim.getActiveCount(), "active");
+        b &= assertEquals(1.f, pBulletNew->getTravelledDistance(), 0.0001f, "dist");
+        b &= assertEquals(1.f, sim.getLifetime(*pBulletNew), 0.0001f, "lifetime");
+        b &= assertEquals(1.f, (pBulletNew->getPut().getPosVec() - PureVector(100.f, 0.f, 0.f)).getLength(), 0.0001f, "moved from new pos");
+
+        return b;
+    }
+
+    bool test_update_zero_factor_does_nothing()
+    {
+        PgeObjectPool<PooledBullet> bullets("pool", 10, *engine);
+        BulletSimulation sim(bullets);
+
+        PooledBullet* const pBullet = createBullet(bullets, PureVector(1.f, 2.f, 3.f), 0.f, 10.f, 1.f, 0.f);
+        bool b = assertNotNull(pBullet, "create");
+        if (!b)
+        {
+            return false;
+        }
+
+        sim.Update(0);
+        b &= assertEquals(static_cast<std::size_t>(0), sim.getActiveCount(), "active");
+        b &= assertTrue(PureVector(1.f, 2.f, 3.f) == pBullet->getPut().getPosVec(), "pos");
+        b &= assertEquals(0.f, pBullet->getTravelledDistance(), "dist");
+
+        return b;
+    }
+
+    bool test_update_follows_pool_reserve()
+    {
+        PgeObjectPool<PooledBullet> bullets;
+        BulletSimulation sim(bullets);
+
+        sim.Update(1);
+        bool b = assertEquals(static_cast<std::size_t>(0), sim.getActiveCount(), "active 1");
+
+        bullets.reserve("pool", 6, *engine);
+        for (int i = 0; i < 6; i++)
+        {
+            b &= assertNotNull(createBullet(bullets, PureVector(0.f, 0.f, 0.f), 0.f, 10.f, 0.f, 0.f), ("create " + std::to_string(i)).c_str());
+        }
+
+        sim.Update(1);
+        b &= assertEquals(static_cast<std::size_t>(6), sim.getActiveCount(), "active 2");
+        for (const auto& bullet : bullets)
+        {
+            b &= assertEquals(10.f, bullet.getTravelledDistance(), 0.0001f, "dist");
+        }
+
+        return b;
+    }
+
+    bool test_resize_keeps_bullets_in_flight()
+    {
+        PgeObjectPool<PooledBullet> bulletsRef("pool ref", 6, *engine);
+        PgeObjectPool<PooledBullet> bullets("pool", 6, *engine);
+        BulletSimulation simRef(bulletsRef);
+        BulletSimulation sim(bullets);
+
+        bool b = true;
+        for (int i = 0; i < 5; i++)
+        {
+            const PureVector pos(static_cast<float>(i), 0.f, 0.f);
+            b &= assertNotNull(createBullet(bulletsRef, pos, 10.f * i, 20.f, 0.5f /* gravity */, 0.02f /* drag */), ("create ref " + std::to_string(i)).c_str());
+            b &= assertNotNull(createBullet(bullets, pos, 10.f * i, 20.f, 0.5f /* gravity */, 0.02f /* drag */), ("create " + std::to_string(i)).c_str());
+        }
+        if (!b)
+        {
+            return false;
+        }
+
+        for (int i = 0; i < 5; i++)
+        {
+            simRef.Update(2);
+            sim.Update(2);
+        }
+
+        // grow mid-flight, then the next Update() shrinks back to the capacity of the pool
+        sim.resize(16);
+        for (int i = 0; i < 5; i++)
+        {
+            simRef.Update(2);
+            sim.Update(2);
+        }
+        b &= assertEquals(simRef.getActiveCount(), sim.getActiveCount(), "active");
+
+        // same operations on the same values, so results are expected to be exactly the same as without resize
+        auto itRef = bulletsRef.begin();
+        for (auto it = bullets.begin(); it != bullets.end(); ++it, ++itRef)
+        {
+            b &= assertEquals(itRef->used(), it->used(), "used");
+            if (!it->used())
+            {
+                continue;
+            }
+            b &= assertVecEquals(itRef->getPut().getPosVec(), it->getPut().getPosVec(), 0.f, "pos");
+            b &= assertVecEquals(simRef.getVelocity(*itRef), sim.getVelocity(*it), 0.f, "velocity");
+            b &= assertEquals(itRef->getTravelledDistance(), it->getTravelledDistance(), 0.f, "dist");
+            b &= assertEquals(simRef.getLifetime(*itRef), sim.getLifetime(*it), 0.f, "lifetime");
+        }
+
+        return b;
+    }
+
+    bool test_benchmark_update()
+    {
+        constexpr std::size_t nBulletCount = 4096;
+        constexpr int nIterations = 200;
+
+        PgeObjectPool<PooledBullet> bullets("pool", nBulletCount, *engine);
+        BulletSimulation sim(bullets);
+
+        bool b = true;
+        for (std::size_t i = 0; i < nBulletCount; i++)
+        {
+            b &= (createBullet(bullets, PureVector(0.f, 0.f, 0.f), static_cast<float>(i % 360), 20.f, 0.5f, 0.01f) != nullptr);
+        }
+        b &= assertTrue(b, "create");
+
+        // Bullet::Update() one by one, as games did so far (without gravity and drag) ...
+        auto timeStart = std::chrono::steady_clock::now();
+        for (int iIter = 0; iIter < nIterations; iIter++)
+        {
+            for (auto& bullet : bullets)
+            {
+                if (bullet.used())
+                {
+                    bullet.Update(1);
+                }
+            }
+        }
+        const auto nDurationPerBulletUSecs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - timeStart).count();
+
+        // ... and all together (with gravity and drag)
+        timeStart = std::chrono::steady_clock::now();
+        for (int iIter = 0; iIter < nIterations; iIter++)
+        {
+            sim.Update(1);
+        }
+        const auto nDurationBatchedUSecs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - timeStart).count();
+
+        b &= assertEquals(nBulletCount, sim.getActiveCount(), "active");
+        for (const auto& bullet : bullets)
+        {
+            b &= assertTrue(std::isfinite(bullet.getPut().getPosVec().getY()), "finite pos");
+        }
+
+        const double fBulletUpdates = static_cast<double>(nBulletCount) * nIterations;
+        CConsole::getConsoleInstance().OLn(
+            "PgeBulletSimulationTest::%s(): %u bullets x %d iterations: Bullet::Update(): %.0f bullets/ms, BulletSimulation::Update(): %.0f bullets/ms",
+            __func__,
+            static_cast<unsigned>(nBulletCount),
+            nIterations,
+            (nDurationPerBulletUSecs > 0) ? (fBulletUpdates * 1000.0 / nDurationPerBulletUSecs) : 0.0,
+            (nDurationBatchedUSecs > 0) ? (fBulletUpdates * 1000.0 / nDurationBatchedUSecs) : 0.0);
+
+        return b;
+    }
+
+}; // class PgeBulletSimulationTest
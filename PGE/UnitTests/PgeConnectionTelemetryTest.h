@@ -0,0 +1,278 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeConnectionTelemetryTest.h
+    Unit test for PgeConnectionTelemetry.
+    Made by PR00F88, West Whiskhyll Entertainment
+    2026
+    ###################################################################################
+*/
+
+#include "UnitTest.h"  // PCH
+
+#include "../Network/PgeConnectionTelemetry.h"
+
+#include <string>
+
+class PgeConnectionTelemetryTest :
+    public UnitTest
+{
+public:
+
+    PgeConnectionTelemetryTest() :
+        UnitTest(__FILE__)
+    {
+    }
+
+protected:
+
+    virtual void initialize() override
+    {
+        addSubTest("test_ctor", (PFNUNITSUBTEST)&PgeConnectionTelemetryTest::test_ctor);
+        addSubTest("test_reserve", (PFNUNITSUBTEST)&PgeConnectionTelemetryTest::test_reserve);
+        addSubTest("test_beginSampling", (PFNUNITSUBTEST)&PgeConnectionTelemetryTest::test_beginSampling);
+        addSubTest("test_addSample_and_getSample", (PFNUNITSUBTEST)&PgeConnectionTelemetryTest::test_addSample_and_getSample);
+        addSubTest("test_addSample_Overwrites_Oldest", (PFNUNITSUBTEST)&PgeConnectionTelemetryTest::test_addSample_Overwrites_Oldest);
+        addSubTest("test_addSample_Max_Connections", (PFNUNITSUBTEST)&PgeConnectionTelemetryTest::test_addSample_Max_Connections);
+        addSubTest("test_getWindowStats", (PFNUNITSUBTEST)&PgeConnectionTelemetryTest::test_getWindowStats);
+        addSubTest("test_exportCsv", (PFNUNITSUBTEST)&PgeConnectionTelemetryTest::test_exportCsv);
+        addSubTest("test_exportWindowStatsCsv", (PFNUNITSUBTEST)&PgeConnectionTelemetryTest::test_exportWindowStatsCsv);
+    }
+
+private:
+
+    typedef pge_network::PgeConnectionTelemetry Telemetry;
+
+    // ---------------------------------------------------------------------------
+
+    PgeConnectionTelemetryTest(const PgeConnectionTelemetryTest&)
+    {};
+
+    PgeConnectionTelemetryTest& operator=(const PgeConnectionTelemetryTest&)
+    {
+        return *this;
+    };
+
+    static Telemetry::Sample makeSample(const Telemetry::TimePoint& time, const float& fPing)
+    {
+        Telemetry::Sample sample;
+        sample.m_time = time;
+        sample.m_fValues[static_cast<std::size_t>(Telemetry::Metric::Ping)] = fPing;
+        sample.m_fValues[static_cast<std::size_t>(Telemetry::Metric::QualityLocal)] = 1.f;
+        return sample;
+    }
+
+    bool test_ctor()
+    {
+        Telemetry telemetry;
+
+        return assertEquals(0u, telemetry.capacity(), "capacity") &
+            assertEquals(0, telemetry.getSampleInterval().count(), "interval") &
+            assertFalse(telemetry.isEnabled(), "enabled") &
+            assertTrue(telemetry.getConnectionHandles().empty(), "connections") &
+            assertEquals(0u, telemetry.getDroppedSampleCount(), "dropped") &
+            assertFalse(telemetry.addSample(1, makeSample(Telemetry::TimePoint(), 1.f)), "addSample without capacity") &
+            assertEquals(1u, telemetry.getDroppedSampleCount(), "dropped 2");
+    }
+
+    bool test_reserve()
+    {
+        Telemetry telemetry;
+
+        bool b = assertFalse(telemetry.reserve(0), "reserve 0") &
+            assertFalse(telemetry.reserve(Telemetry::nMaxCapacity + 1), "reserve too big") &
+            assertEquals(0u, telemetry.capacity(), "capacity 0");
+
+        b &= assertTrue(telemetry.reserve(4), "reserve 4") & assertEquals(4u, telemetry.capacity(), "capacity 4");
+        b &= assertTrue(telemetry.addSample(1, makeSample(Telemetry::TimePoint(), 1.f)), "addSample");
+        b &= assertTrue(telemetry.reserve(4), "reserve 4 again") &
+            assertEquals(1u, telemetry.getSampleCount(1), "samples kept with same capacity");
+        b &= assertTrue(telemetry.reserve(8), "reserve 8") &
+            assertEquals(8u, telemetry.capacity(), "capacity 8") &
+            assertEquals(0u, telemetry.getSampleCount(1), "samples cleared with new capacity");
+
+        return b;
+    }
+
+    bool test_beginSampling()
+    {
+        Telemetry telemetry;
+        const Telemetry::TimePoint t0 = std::chrono::steady_clock::now();
+
+        bool b = assertFalse(telemetry.beginSampling(t0), "disabled");
+        telemetry.setSampleInterval(std::chrono::milliseconds(100));
+        b &= assertFalse(telemetry.beginSampling(t0), "no capacity");
+        b &= assertTrue(telemetry.reserve(4), "reserve") & assertTrue(telemetry.isEnabled(), "enabled");
+
+        b &= assertTrue(telemetry.beginSampling(t0), "first");
+        b &= assertFalse(telemetry.beginSampling(t0 + std::chrono::milliseconds(99)), "too early");
+        b &= assertTrue(telemetry.beginSampling(t0 + std::chrono::milliseconds(100)), "due");
+        b &= assertFalse(telemetry.beginSampling(t0 + std::chrono::milliseconds(150)), "too early 2");
+
+        telemetry.setSampleInterval(std::chrono::milliseconds(0));
+        b &= assertFalse(telemetry.beginSampling(t0 + std::chrono::milliseconds(1000)), "disabled again");
+
+        return b;
+    }
+
+    bool test_addSample_and_getSample()
+    {
+        Telemetry telemetry;
+        const Telemetry::TimePoint t0 = std::chrono::steady_clock::now();
+        bool b = assertTrue(telemetry.reserve(4), "reserve");
+
+        b &= assertTrue(telemetry.addSample(7, makeSample(t0, 10.f)), "add 7/1");
+        b &= assertTrue(telemetry.addSample(3, makeSample(t0, 20.f)), "add 3/1");
+        b &= assertTrue(telemetry.addSample(7, makeSample(t0 + std::chrono::milliseconds(10), 11.f)), "add 7/2");
+
+        const auto vConnHandles = telemetry.getConnectionHandles();
+        b &= assertEquals(2u, vConnHandles.size(), "conn count");
+        if (!b)
+        {
+            return false;
+        }
+        b &= assertEquals(7u, vConnHandles[0], "conn 0") & assertEquals(3u, vConnHandles[1], "conn 1");
+
+        b &= assertEquals(2u, telemetry.getSampleCount(7), "sample count 7") &
+            assertEquals(1u, telemetry.getSampleCount(3), "sample count 3") &
+            assertEquals(0u, telemetry.getSampleCount(5), "sample count 5") &
+            assertNull(telemetry.getSample(7, 2), "sample out of range") &
+            assertNull(telemetry.getSample(5, 0), "sample of unknown conn");
+
+        const Telemetry::Sample* const pSample = telemetry.getSample(7, 1);
+        b &= assertNotNull(pSample, "sample 7/2");
+        if (!b)
+        {
+            return false;
+        }
+        b &= assertEquals(11.f, pSample->m_fValues[static_cast<std::size_t>(Telemetry::Metric::Ping)], "ping") &
+            assertEquals(0.f, pSample->m_fValues[static_cast<std::size_t>(Telemetry::Metric::TxBytesPerSec)], "tx");
+
+        telemetry.clear();
+        b &= assertTrue(telemetry.getConnectionHandles().empty(), "cleared") &
+            assertEquals(4u, telemetry.capacity(), "capacity kept");
+
+        return b;
+    }
+
+    bool test_addSample_Overwrites_Oldest()
+    {
+        Telemetry telemetry;
+        const Telemetry::TimePoint t0 = std::chrono::steady_clock::now();
+        bool b = assertTrue(telemetry.reserve(3), "reserve");
+
+        for (int i = 0; i < 10; i++)
+        {
+            b &= assertTrue(telemetry.addSample(1, makeSample(t0 + std::chrono::milliseconds(i), static_cast<float>(i))), "add");
+        }
+
+        b &= assertEquals(3u, telemetry.getSampleCount(1), "sample count");
+        for (std::size_t i = 0; i < 3; i++)
+        {
+            const Telemetry::Sample* const pSample = telemetry.getSample(1, i);
+            b &= assertNotNull(pSample, ("sample " + std::to_string(i)).c_str()) &&
+                assertEquals(static_cast<float>(7 + i), pSample->m_fValues[0], ("ping " + std::to_string(i)).c_str());
+        }
+
+        return b;
+    }
+
+    bool test_addSample_Max_Connections()
+    {
+        Telemetry telemetry;
+        bool b = assertTrue(telemetry.reserve(1), "reserve");
+
+        for (pge_network::PgeNetworkConnectionHandle i = 0; i < Telemetry::nMaxConnectionCount; i++)
+        {
+            b &= assertTrue(telemetry.addSample(i, makeSample(Telemetry::TimePoint(), 1.f)), "add");
+        }
+
+        return b & assertFalse(telemetry.addSample(1000, makeSample(Telemetry::TimePoint(), 1.f)), "add too many") &
+            assertTrue(telemetry.addSample(0, makeSample(Telemetry::TimePoint(), 2.f)), "add to known") &
+            assertEquals(1u, telemetry.getDroppedSampleCount(), "dropped") &
+            assertEquals(Telemetry::nMaxConnectionCount, telemetry.getConnectionHandles().size(), "conn count");
+    }
+
+    bool test_getWindowStats()
+    {
+        Telemetry telemetry;
+        const Telemetry::TimePoint t0 = std::chrono::steady_clock::now();
+        bool b = assertTrue(telemetry.reserve(200), "reserve");
+
+        // ping 1..100 in the first second, then a single sample in the next second
+        for (int i = 0; i < 100; i++)
+        {
+            b &= assertTrue(telemetry.addSample(1, makeSample(t0 + std::chrono::milliseconds(i * 10), static_cast<float>(100 - i))), "add");
+        }
+        b &= assertTrue(telemetry.addSample(1, makeSample(t0 + std::chrono::milliseconds(1000), 500.f)), "add last");
+
+        const Telemetry::WindowStats stats =
+            telemetry.getWindowStats(1, Telemetry::Metric::Ping, t0, t0 + std::chrono::milliseconds(1000));
+        b &= assertEquals(100u, stats.m_nCount, "count") &
+            assertEquals(1.f, stats.m_fMin, "min") &
+            assertEquals(50.5f, stats.m_fAvg, "avg") &
+            assertEquals(100.f, stats.m_fMax, "max") &
+            assertEquals(99.f, stats.m_fP99, "p99");
+
+        const Telemetry::WindowStats statsLast =
+            telemetry.getWindowStats(1, Telemetry::Metric::Ping, t0 + std::chrono::milliseconds(1000), t0 + std::chrono::milliseconds(2000));
+        b &= assertEquals(1u, statsLast.m_nCount, "count last") &
+            assertEquals(500.f, statsLast.m_fMin, "min last") &
+            assertEquals(500.f, statsLast.m_fP99, "p99 last");
+
+        const Telemetry::WindowStats statsQuality =
+            telemetry.getWindowStats(1, Telemetry::Metric::QualityLocal, t0, t0 + std::chrono::milliseconds(2000));
+        b &= assertEquals(101u, statsQuality.m_nCount, "count quality") &
+            assertEquals(1.f, statsQuality.m_fAvg, "avg quality");
+
+        const Telemetry::WindowStats statsEmpty =
+            telemetry.getWindowStats(2, Telemetry::Metric::Ping, t0, t0 + std::chrono::milliseconds(2000));
+        b &= assertEquals(0u, statsEmpty.m_nCount, "count unknown conn") &
+            assertEquals(0.f, statsEmpty.m_fMax, "max unknown conn");
+
+        return b;
+    }
+
+    bool test_exportCsv()
+    {
+        Telemetry telemetry;
+        const Telemetry::TimePoint t0 = std::chrono::steady_clock::now();
+        bool b = assertTrue(telemetry.reserve(4), "reserve");
+
+        b &= assertTrue(telemetry.addSample(5, makeSample(t0, 12.f)), "add 1");
+        b &= assertTrue(telemetry.addSample(5, makeSample(t0 + std::chrono::milliseconds(250), 14.f)), "add 2");
+
+        const std::string sCsv = telemetry.exportCsv();
+        const std::string sHeader =
+            "conn,time_ms,ping_ms,quality_local,quality_remote,rx_bytes_per_sec,tx_bytes_per_sec,"
+            "pending_unreliable_bytes,pending_reliable_bytes,sent_unacked_reliable_bytes,queue_time_us\n";
+
+        return b & assertEquals(sHeader + "5,0,12,1,0,0,0,0,0,0,0\n5,250,14,1,0,0,0,0,0,0,0\n", sCsv, "csv");
+    }
+
+    bool test_exportWindowStatsCsv()
+    {
+        Telemetry telemetry;
+        const Telemetry::TimePoint t0 = std::chrono::steady_clock::now();
+        bool b = assertTrue(telemetry.reserve(4), "reserve");
+
+        b &= assertTrue(telemetry.addSample(5, makeSample(t0, 10.f)), "add 1");
+        b &= assertTrue(telemetry.addSample(5, makeSample(t0 + std::chrono::milliseconds(500), 20.f)), "add 2");
+        b &= assertTrue(telemetry.addSample(5, makeSample(t0 + std::chrono::milliseconds(2500), 30.f)), "add 3");
+
+        const std::string sCsv = telemetry.exportWindowStatsCsv(std::chrono::milliseconds(1000));
+        const std::string sHeader = "conn,window_start_ms,metric,count,min,avg,max,p99\n";
+
+        // window [1000, 2000) is empty so skipped
+        b &= assertEquals(0u, sCsv.find(sHeader), "header") &
+            assertTrue(sCsv.find("5,0,ping_ms,2,10,15,20,20\n") != std::string::npos, "window 0 ping") &
+            assertTrue(sCsv.find("5,0,quality_local,2,1,1,1,1\n") != std::string::npos, "window 0 quality") &
+            assertTrue(sCsv.find("5,1000,") == std::string::npos, "window 1 skipped") &
+            assertTrue(sCsv.find("5,2000,ping_ms,1,30,30,30,30\n") != std::string::npos, "window 2 ping") &
+            assertEquals(sHeader, telemetry.exportWindowStatsCsv(std::chrono::milliseconds(0)), "zero window");
+
+        return b;
+    }
+
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeCounterRandomTest.h
+    Unit test for CounterRandom.
+    Made by PR00F88, West Whiskhyll Entertainment
+    2026
+    ###################################################################################
+*/
+
+#include "UnitTest.h"  // PCH
+
+#include "../Weapons/CounterRandom.h"
+
+#include <set>
+
+class PgeCounterRandomTest :
+    public UnitTest
+{
+public:
+
+    PgeCounterRandomTest() :
+        UnitTest(__FILE__)
+    {
+    }
+
+protected:
+
+    virtual void initialize() override
+    {
+        addSubTest("test_get_is_deterministic", (PFNUNITSUBTEST)&PgeCounterRandomTest::test_get_is_deterministic);
+        addSubTest("test_get_differs_by_key_and_counter", (PFNUNITSUBTEST)&PgeCounterRandomTest::test_get_differs_by_key_and_counter);
+        addSubTest("test_makeKey_is_order_dependent", (PFNUNITSUBTEST)&PgeCounterRandomTest::test_makeKey_is_order_dependent);
+        addSubTest("test_getUnit_getSigned_range", (PFNUNITSUBTEST)&PgeCounterRandomTest::test_getUnit_getSigned_range);
+        addSubTest("test_getUnit_is_uniform", (PFNUNITSUBTEST)&PgeCounterRandomTest::test_getUnit_is_uniform);
+    }
+
+private:
+
+    PgeCounterRandomTest(const PgeCounterRandomTest&)
+    {};
+
+    PgeCounterRandomTest& operator=(const PgeCounterRandomTest&)
+    {
+        return *this;
+    };
+
+    bool test_get_is_deterministic()
+    {
+        const uint64_t nKey = CounterRandom::makeKey(52u, 1234u);
+        bool b = assertEquals(nKey, CounterRandom::makeKey(52u, 1234u), "key");
+
+        // evaluation order does not matter since there is no generator state
+        for (uint64_t i = 0; b && (i < 1000); i++)
+        {
+            const uint64_t nCounter = 999u - i;
+            b &= assertEquals(CounterRandom::get(nKey, nCounter), CounterRandom::get(nKey, nCounter), "get");
+            b &= assertEquals(CounterRandom::getSigned(nKey, nCounter), CounterRandom::getSigned(nKey, nCounter), "getSigned");
+        }
+
+        return b;
+    }
+
+    bool test_get_differs_by_key_and_counter()
+    {
+        const uint64_t nKey = CounterRandom::makeKey(52u, 1234u);
+        std::set<uint32_t> values;
+        for (uint64_t i = 0; i < 1000; i++)
+        {
+            values.insert(CounterRandom::get(nKey, i));
+            values.insert(CounterRandom::get(CounterRandom::makeKey(53u, 1234u), i));
+            values.insert(CounterRandom::get(CounterRandom::makeKey(52u, 1235u), i));
+        }
+
+        // 3000 32-bit values, a few collisions are still possible but not more
+        return assertLequals(2990u, static_cast<unsigned int>(values.size()), "distinct values");
+    }
+
+    bool test_makeKey_is_order_dependent()
+    {
+        return assertNotEquals(CounterRandom::makeKey(1u, 2u), CounterRandom::makeKey(2u, 1u), "swapped") &
+            assertNotEquals(CounterRandom::makeKey(0u, 0u), CounterRandom::makeKey(0u, 1u), "zero");
+    }
+
+    bool test_getUnit_getSigned_range()
+    {
+        bool b = true;
+        for (uint64_t nKey = 0; b && (nKey < 10); nKey++)
+        {
+            for (uint64_t i = 0; b && (i < 10000); i++)
+            {
+                const float fUnit = CounterRandom::getUnit(nKey, i);
+                const float fSigned = CounterRandom::getSigned(nKey, i);
+                b &= assertTrue((fUnit >= 0.f) && (fUnit < 1.f), "unit");
+                b &= assertTrue((fSigned >= -1.f) && (fSigned < 1.f), "signed");
+            }
+        }
+
+        return b;
+    }
+
+    bool test_getUnit_is_uniform()
+    {
+        constexpr int nBuckets = 10;
+        constexpr int nSamples = 100000;
+        int buckets[nBuckets] = {};
+        const uint64_t nKey = CounterRandom::makeKey(52u, 1234u);
+        for (int i = 0; i < nSamples; i++)
+        {
+            buckets[static_cast<int>(CounterRandom::getUnit(nKey, static_cast<uint64_t>(i)) * nBuckets)]++;
+        }
+
+        // expected 10000 per bucket, 5% tolerance is way above the statistical deviation
+        bool b = true;
+        for (int i = 0; i < nBuckets; i++)
+        {
+            b &= assertTrue((buckets[i] > 9500) && (buckets[i] < 10500), ("bucket " + std::to_string(i)).c_str());
+        }
+
+        return b;
+    }
+
+}; // class PgeCounterRandomTest
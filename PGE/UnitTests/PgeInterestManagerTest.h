@@ -0,0 +1,445 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeInterestManagerTest.h
+    Unit test for PgeInterestManager.
+    Made by PR00F88, West Whiskhyll Entertainment
+    2026
+    ###################################################################################
+*/
+
+#include "UnitTest.h"  // PCH
+
+#include "../Network/PgeInterestManager.h"
+#include "../Network/Stubs/PgeServerStub.h"
+
+#include <array>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class PgeInterestManagerTest :
+    public UnitTest
+{
+public:
+
+    PgeInterestManagerTest() :
+        UnitTest(__FILE__)
+    {
+    }
+
+protected:
+
+    virtual void initialize() override
+    {
+        addSubTest("test_ctor", (PFNUNITSUBTEST)&PgeInterestManagerTest::test_ctor);
+        addSubTest("test_ctor_Bad", (PFNUNITSUBTEST)&PgeInterestManagerTest::test_ctor_Bad);
+        addSubTest("test_setEntity_and_removeEntity", (PFNUNITSUBTEST)&PgeInterestManagerTest::test_setEntity_and_removeEntity);
+        addSubTest("test_setClient_and_removeClient", (PFNUNITSUBTEST)&PgeInterestManagerTest::test_setClient_and_removeClient);
+        addSubTest("test_update_EnterRadius", (PFNUNITSUBTEST)&PgeInterestManagerTest::test_update_EnterRadius);
+        addSubTest("test_update_Hysteresis", (PFNUNITSUBTEST)&PgeInterestManagerTest::test_update_Hysteresis);
+        addSubTest("test_update_AlwaysRelevant", (PFNUNITSUBTEST)&PgeInterestManagerTest::test_update_AlwaysRelevant);
+        addSubTest("test_update_RemovedEntityLeaves", (PFNUNITSUBTEST)&PgeInterestManagerTest::test_update_RemovedEntityLeaves);
+        addSubTest("test_update_NegativeAndFarCoords", (PFNUNITSUBTEST)&PgeInterestManagerTest::test_update_NegativeAndFarCoords);
+        addSubTest("test_update_GridLimitsCandidates", (PFNUNITSUBTEST)&PgeInterestManagerTest::test_update_GridLimitsCandidates);
+        addSubTest("test_update_MatchesBruteForce", (PFNUNITSUBTEST)&PgeInterestManagerTest::test_update_MatchesBruteForce);
+        addSubTest("test_sendToRelevantClients", (PFNUNITSUBTEST)&PgeInterestManagerTest::test_sendToRelevantClients);
+    }
+
+private:
+
+    typedef pge_network::PgeInterestManager::Event Event;
+
+    /**
+        Records the except set of the last sendToAllClientsExcept(), since PgeServerStub ignores it.
+    */
+    class ExceptRecordingServerStub : public pge_network::PgeServerStub
+    {
+    public:
+
+        std::set<pge_network::PgeNetworkConnectionHandle> m_setLastExcepts;
+
+        explicit ExceptRecordingServerStub(PGEcfgProfiles& cfgProfiles) :
+            pge_network::PgeServerStub(cfgProfiles)
+        {
+        }
+
+        void sendToAllClientsExcept(
+            const pge_network::PgePacket& pkt,
+            const pge_network::PgeNetworkConnectionHandle& exceptConnHandle = 0) override
+        {
+            m_setLastExcepts.clear();
+            if (exceptConnHandle != 0)
+            {
+                m_setLastExcepts.insert(exceptConnHandle);
+            }
+            pge_network::PgeServerStub::sendToAllClientsExcept(pkt, exceptConnHandle);
+        }
+
+        void sendToAllClientsExcept(
+            const pge_network::PgePacket& pkt,
+            const std::set<pge_network::PgeNetworkConnectionHandle>& exceptConnHandles) override
+        {
+            m_setLastExcepts = exceptConnHandles;
+            pge_network::PgeServerStub::sendToAllClientsExcept(pkt, exceptConnHandles);
+        }
+    };
+
+    PGEcfgProfiles cfgProfiles;
+
+    // ---------------------------------------------------------------------------
+
+    PgeInterestManagerTest(const PgeInterestManagerTest&)
+    {};
+
+    PgeInterestManagerTest& operator=(const PgeInterestManagerTest&)
+    {
+        return *this;
+    };
+
+    bool assertEvent(
+        const pge_network::PgeInterestManager& im,
+        const std::size_t& iEvent,
+        const Event::Type& type,
+        const pge_network::PgeNetworkConnectionHandle& connHandle,
+        const pge_network::PgeInterestManager::TEntityId& entityId,
+        const char* szText)
+    {
+        if (!assertLess(iEvent, im.getEvents().size(), (std::string("event index, ") + szText).c_str()))
+        {
+            return false;
+        }
+        const Event& event = im.getEvents()[iEvent];
+        return assertTrue(type == event.m_type, (std::string("event type, ") + szText).c_str()) &
+            assertEquals(connHandle, event.m_connHandle, (std::string("event conn, ") + szText).c_str()) &
+            assertEquals(entityId, event.m_entityId, (std::string("event entity, ") + szText).c_str());
+    }
+
+    bool test_ctor()
+    {
+        const pge_network::PgeInterestManager im(10.f, 20.f, 25.f);
+
+        return assertEquals(10.f, im.getCellSize(), "cell size") &
+            assertEquals(20.f, im.getEnterRadius(), "enter radius") &
+            assertEquals(25.f, im.getLeaveRadius(), "leave radius") &
+            assertEquals(0u, im.getEntityCount(), "entity count") &
+            assertEquals(0u, im.getClientCount(), "client count") &
+            assertTrue(im.getEvents().empty(), "events") &
+            assertNull(im.getRelevantEntities(1), "relevant of unknown client") &
+            assertTrue(im.isRelevant(1, 1), "unknown client is not filtered");
+    }
+
+    bool test_ctor_Bad()
+    {
+        bool b = true;
+        const float fBads[][3] = { { 0.f, 1.f, 1.f }, { 1.f, 0.f, 1.f }, { 1.f, 2.f, 1.f }, { -1.f, 1.f, 1.f } };
+        for (const auto& fBad : fBads)
+        {
+            try
+            {
+                const pge_network::PgeInterestManager im(fBad[0], fBad[1], fBad[2]);
+                b &= assertTrue(false, "no exception");
+            }
+            catch (const std::exception&)
+            {
+            }
+        }
+
+        // leave radius equal to enter radius means no hysteresis
+        try
+        {
+            const pge_network::PgeInterestManager im(1.f, 2.f, 2.f);
+        }
+        catch (const std::exception&)
+        {
+            b &= assertTrue(false, "exception for equal radii");
+        }
+
+        return b;
+    }
+
+    bool test_setEntity_and_removeEntity()
+    {
+        pge_network::PgeInterestManager im(10.f, 20.f, 25.f);
+
+        im.setEntity(5, 1.f, 2.f, 3.f);
+        im.setEntity(2, 1.f, 2.f, 3.f);
+        im.setEntity(5, 4.f, 5.f, 6.f);
+        bool b = assertEquals(2u, im.getEntityCount(), "entity count") &
+            assertTrue(im.hasEntity(2), "has 2") &
+            assertTrue(im.hasEntity(5), "has 5") &
+            assertFalse(im.hasEntity(3), "has 3");
+
+        b &= assertTrue(im.removeEntity(5), "remove 5") &
+            assertFalse(im.removeEntity(5), "remove 5 again") &
+            assertFalse(im.hasEntity(5), "has 5 after remove") &
+            assertEquals(1u, im.getEntityCount(), "entity count after remove");
+
+        return b;
+    }
+
+    bool test_setClient_and_removeClient()
+    {
+        pge_network::PgeInterestManager im(10.f, 20.f, 25.f);
+
+        im.setClient(7, 0.f, 0.f, 0.f);
+        im.setClient(3, 0.f, 0.f, 0.f);
+        bool b = assertEquals(2u, im.getClientCount(), "client count") &
+            assertTrue(im.hasClient(3), "has 3") &
+            assertNotNull(im.getRelevantEntities(7), "relevant of 7") &
+            assertTrue(im.getRelevantEntities(7)->empty(), "nothing relevant before update");
+
+        b &= assertTrue(im.removeClient(7), "remove 7") &
+            assertFalse(im.removeClient(7), "remove 7 again") &
+            assertNull(im.getRelevantEntities(7), "relevant of removed") &
+            assertEquals(1u, im.getClientCount(), "client count after remove");
+
+        return b;
+    }
+
+    bool test_update_EnterRadius()
+    {
+        pge_network::PgeInterestManager im(10.f, 20.f, 30.f);
+        im.setClient(1, 0.f, 0.f, 0.f);
+        im.setClient(2, 100.f, 0.f, 0.f);
+        im.setEntity(10, 19.f, 0.f, 0.f);   // near client 1
+        im.setEntity(11, 0.f, 21.f, 0.f);   // too far from both
+        im.setEntity(12, 90.f, 5.f, 5.f);   // near client 2
+        im.setEntity(13, 50.f, 0.f, 0.f);   // between them, too far from both
+        im.update();
+
+        const std::vector<pge_network::PgeInterestManager::TEntityId> vExpected1{ 10 };
+        const std::vector<pge_network::PgeInterestManager::TEntityId> vExpected2{ 12 };
+        bool b = assertTrue(vExpected1 == *im.getRelevantEntities(1), "relevant 1") &
+            assertTrue(vExpected2 == *im.getRelevantEntities(2), "relevant 2") &
+            assertTrue(im.isRelevant(1, 10), "1 sees 10") &
+            assertFalse(im.isRelevant(1, 12), "1 does not see 12") &
+            assertEquals(2u, im.getEvents().size(), "event count");
+        b &= assertEvent(im, 0, Event::Type::Enter, 1, 10, "enter 1/10");
+        b &= assertEvent(im, 1, Event::Type::Enter, 2, 12, "enter 2/12");
+
+        // no change, no event
+        im.update();
+        b &= assertTrue(im.getEvents().empty(), "no events");
+
+        return b;
+    }
+
+    bool test_update_Hysteresis()
+    {
+        pge_network::PgeInterestManager im(10.f, 20.f, 30.f);
+        im.setClient(1, 0.f, 0.f, 0.f);
+
+        // between enter and leave radii, not relevant yet
+        im.setEntity(10, 25.f, 0.f, 0.f);
+        im.update();
+        bool b = assertFalse(im.isRelevant(1, 10), "not entered at 25") & assertTrue(im.getEvents().empty(), "no events at 25");
+
+        im.setEntity(10, 20.f, 0.f, 0.f);
+        im.update();
+        b &= assertTrue(im.isRelevant(1, 10), "entered at 20") & assertEvent(im, 0, Event::Type::Enter, 1, 10, "enter");
+
+        // between enter and leave radii again, still relevant
+        im.setEntity(10, 29.f, 0.f, 0.f);
+        im.update();
+        b &= assertTrue(im.isRelevant(1, 10), "still relevant at 29") & assertTrue(im.getEvents().empty(), "no events at 29");
+
+        im.setEntity(10, 31.f, 0.f, 0.f);
+        im.update();
+        b &= assertFalse(im.isRelevant(1, 10), "left at 31") & assertEvent(im, 0, Event::Type::Leave, 1, 10, "leave");
+
+        im.setEntity(10, 29.f, 0.f, 0.f);
+        im.update();
+        b &= assertFalse(im.isRelevant(1, 10), "not entered at 29") & assertTrue(im.getEvents().empty(), "no events at 29 again");
+
+        // client moving has the same effect as entity moving
+        im.setClient(1, 10.f, 0.f, 0.f);
+        im.update();
+        b &= assertTrue(im.isRelevant(1, 10), "entered by client move");
+
+        return b;
+    }
+
+    bool test_update_AlwaysRelevant()
+    {
+        pge_network::PgeInterestManager im(10.f, 20.f, 30.f);
+        im.setClient(1, 0.f, 0.f, 0.f);
+        im.setClient(2, 1000.f, 1000.f, 0.f);
+        im.setEntity(10, 5000.f, 0.f, 0.f, true);
+        im.setEntity(11, 5.f, 0.f, 0.f, true);
+        im.update();
+
+        const std::vector<pge_network::PgeInterestManager::TEntityId> vExpected{ 10, 11 };
+        bool b = assertTrue(vExpected == *im.getRelevantEntities(1), "relevant 1") &
+            assertTrue(vExpected == *im.getRelevantEntities(2), "relevant 2") &
+            assertEquals(4u, im.getEvents().size(), "event count");
+
+        // no longer always relevant
+        im.setEntity(10, 5000.f, 0.f, 0.f, false);
+        im.update();
+        b &= assertFalse(im.isRelevant(1, 10), "1 does not see 10") &
+            assertFalse(im.isRelevant(2, 10), "2 does not see 10") &
+            assertEquals(2u, im.getEvents().size(), "event count 2");
+
+        return b;
+    }
+
+    bool test_update_RemovedEntityLeaves()
+    {
+        pge_network::PgeInterestManager im(10.f, 20.f, 30.f);
+        im.setClient(1, 0.f, 0.f, 0.f);
+        im.setEntity(10, 1.f, 1.f, 1.f);
+        im.setEntity(11, 2.f, 2.f, 2.f);
+        im.update();
+
+        im.removeEntity(10);
+        im.update();
+        bool b = assertEquals(1u, im.getEvents().size(), "event count") &
+            assertEvent(im, 0, Event::Type::Leave, 1, 10, "leave 10") &
+            assertFalse(im.isRelevant(1, 10), "1 does not see 10") &
+            assertTrue(im.isRelevant(1, 11), "1 sees 11");
+
+        // removed client does not get leave events
+        im.removeClient(1);
+        im.update();
+        b &= assertTrue(im.getEvents().empty(), "no events after client removal");
+
+        return b;
+    }
+
+    bool test_update_NegativeAndFarCoords()
+    {
+        pge_network::PgeInterestManager im(10.f, 20.f, 30.f);
+        im.setClient(1, -5.f, -5.f, -5.f);
+        im.setEntity(10, 5.f, 5.f, 5.f);        // other side of the origin, different cells
+        im.setEntity(11, 1e30f, 0.f, 0.f);      // beyond the grid, clamped to the border cell
+        im.setClient(2, 1e30f, 0.f, 0.f);
+        im.update();
+
+        return assertTrue(im.isRelevant(1, 10), "1 sees 10 across origin") &
+            assertFalse(im.isRelevant(1, 11), "1 does not see 11") &
+            assertTrue(im.isRelevant(2, 11), "2 sees 11") &
+            assertFalse(im.isRelevant(2, 10), "2 does not see 10");
+    }
+
+    bool test_update_GridLimitsCandidates()
+    {
+        // 100x100 entities on a 10 unit spaced grid, client sees only its surroundings
+        pge_network::PgeInterestManager im(30.f, 25.f, 30.f);
+        pge_network::PgeInterestManager::TEntityId entityId = 0;
+        for (int x = 0; x < 100; x++)
+        {
+            for (int y = 0; y < 100; y++)
+            {
+                im.setEntity(entityId++, x * 10.f, y * 10.f, 0.f);
+            }
+        }
+        im.setClient(1, 500.f, 500.f, 0.f);
+        im.update();
+
+        // entities within radius 25: 21 grid points (x,y offsets with x^2+y^2 <= 6.25)
+        return assertEquals(21u, im.getRelevantEntities(1)->size(), "relevant count") &
+            assertLess(im.getLastUpdateCandidateCount(), 200u, "candidate count") &
+            assertEquals(21u, im.getEvents().size(), "event count");
+    }
+
+    bool test_update_MatchesBruteForce()
+    {
+        // entities and clients wander around, relevancy is checked against a brute force reference with the same hysteresis
+        pge_network::PgeInterestManager im(15.f, 20.f, 28.f);
+        static constexpr int nEntityCount = 300;
+        static constexpr pge_network::PgeNetworkConnectionHandle nClientCount = 8;
+        uint32_t nRandom = 12345;
+        const auto random = [&nRandom](const float& fMax) {
+            nRandom = nRandom * 1664525u + 1013904223u;
+            return (nRandom >> 8) / static_cast<float>(1u << 24) * fMax;
+        };
+
+        std::vector<std::array<float, 3>> vEntityPos(nEntityCount);
+        std::vector<std::array<float, 3>> vClientPos(nClientCount);
+        std::vector<std::set<pge_network::PgeInterestManager::TEntityId>> vExpected(nClientCount);
+
+        bool b = true;
+        for (int iTick = 0; iTick < 50; iTick++)
+        {
+            for (int i = 0; i < nEntityCount; i++)
+            {
+                vEntityPos[i] = iTick == 0 ?
+                    std::array<float, 3>{ random(200.f) - 100.f, random(200.f) - 100.f, random(20.f) } :
+                    std::array<float, 3>{ vEntityPos[i][0] + random(10.f) - 5.f, vEntityPos[i][1] + random(10.f) - 5.f, vEntityPos[i][2] };
+                im.setEntity(i, vEntityPos[i][0], vEntityPos[i][1], vEntityPos[i][2]);
+            }
+            for (pge_network::PgeNetworkConnectionHandle iClient = 0; iClient < nClientCount; iClient++)
+            {
+                vClientPos[iClient] = { random(200.f) - 100.f, random(200.f) - 100.f, random(20.f) };
+                im.setClient(iClient, vClientPos[iClient][0], vClientPos[iClient][1], vClientPos[iClient][2]);
+            }
+            im.update();
+
+            std::size_t nExpectedEventCount = 0;
+            for (pge_network::PgeNetworkConnectionHandle iClient = 0; iClient < nClientCount; iClient++)
+            {
+                std::set<pge_network::PgeInterestManager::TEntityId> setNew;
+                for (int i = 0; i < nEntityCount; i++)
+                {
+                    const float dx = vEntityPos[i][0] - vClientPos[iClient][0];
+                    const float dy = vEntityPos[i][1] - vClientPos[iClient][1];
+                    const float dz = vEntityPos[i][2] - vClientPos[iClient][2];
+                    const float fDist2 = dx * dx + dy * dy + dz * dz;
+                    if ((fDist2 <= 20.f * 20.f) || ((fDist2 <= 28.f * 28.f) && (vExpected[iClient].count(i) > 0)))
+                    {
+                        setNew.insert(i);
+                    }
+                }
+                for (const auto& id : setNew)
+                {
+                    nExpectedEventCount += vExpected[iClient].count(id) ? 0 : 1;
+                }
+                for (const auto& id : vExpected[iClient])
+                {
+                    nExpectedEventCount += setNew.count(id) ? 0 : 1;
+                }
+                vExpected[iClient] = setNew;
+
+                const std::vector<pge_network::PgeInterestManager::TEntityId>& vActual = *im.getRelevantEntities(iClient);
+                b &= assertTrue(
+                    std::vector<pge_network::PgeInterestManager::TEntityId>(setNew.begin(), setNew.end()) == vActual,
+                    ("relevant, tick " + std::to_string(iTick) + ", client " + std::to_string(iClient)).c_str());
+            }
+            b &= assertEquals(nExpectedEventCount, im.getEvents().size(), ("event count, tick " + std::to_string(iTick)).c_str());
+        }
+
+        return b;
+    }
+
+    bool test_sendToRelevantClients()
+    {
+        ExceptRecordingServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeInterestManager im(10.f, 20.f, 30.f);
+        im.setClient(1, 0.f, 0.f, 0.f);
+        im.setClient(2, 100.f, 0.f, 0.f);
+        im.setClient(3, 5.f, 0.f, 0.f);
+        im.setEntity(10, 1.f, 0.f, 0.f);
+        im.setEntity(11, 1000.f, 0.f, 0.f, true);
+        im.update();
+
+        pge_network::PgePacket pkt;
+        pge_network::PgePacket::initPktMsgApp(pkt, pge_network::ServerConnHandle);
+        bool b = assertNotNull(pge_network::PgePacket::preparePktMsgAppFill(pkt, 1, 1), "prepare");
+
+        im.sendToRelevantClients(server, pkt, 10);
+        const std::set<pge_network::PgeNetworkConnectionHandle> setExpected{ 2 };
+        b &= assertTrue(setExpected == server.m_setLastExcepts, "excepts for 10") &
+            assertEquals(1u, server.getTxPackets().size(), "tx count 1");
+
+        im.sendToRelevantClients(server, pkt, 11);
+        b &= assertTrue(server.m_setLastExcepts.empty(), "no excepts for always relevant") &
+            assertEquals(2u, server.getTxPackets().size(), "tx count 2");
+
+        return b;
+    }
+
+};
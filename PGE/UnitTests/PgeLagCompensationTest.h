@@ -0,0 +1,355 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeLagCompensationTest.h
+    Unit test for PgeLagCompensation.
+    Made by PR00F88, West Whiskhyll Entertainment
+    2026
+    ###################################################################################
+*/
+
+#include "UnitTest.h"  // PCH
+
+#include "../Network/PgeLagCompensation.h"
+
+#include <chrono>
+#include <stdexcept>
+
+class PgeLagCompensationTest :
+    public UnitTest
+{
+public:
+
+    PgeLagCompensationTest() :
+        UnitTest(__FILE__)
+    {
+    }
+
+protected:
+
+    virtual void initialize() override
+    {
+        addSubTest("test_ctor", (PFNUNITSUBTEST)&PgeLagCompensationTest::test_ctor);
+        addSubTest("test_ctor_InvalidArgs", (PFNUNITSUBTEST)&PgeLagCompensationTest::test_ctor_InvalidArgs);
+        addSubTest("test_beginTick_addPlayer", (PFNUNITSUBTEST)&PgeLagCompensationTest::test_beginTick_addPlayer);
+        addSubTest("test_history_Overwrite", (PFNUNITSUBTEST)&PgeLagCompensationTest::test_history_Overwrite);
+        addSubTest("test_getPlayerBox_Interpolated", (PFNUNITSUBTEST)&PgeLagCompensationTest::test_getPlayerBox_Interpolated);
+        addSubTest("test_getPlayerBox_Clamped", (PFNUNITSUBTEST)&PgeLagCompensationTest::test_getPlayerBox_Clamped);
+        addSubTest("test_getPlayerBox_MissingInNewerTick", (PFNUNITSUBTEST)&PgeLagCompensationTest::test_getPlayerBox_MissingInNewerTick);
+        addSubTest("test_findHitBySegment_Rewound", (PFNUNITSUBTEST)&PgeLagCompensationTest::test_findHitBySegment_Rewound);
+        addSubTest("test_findHitBySegment_Nearest", (PFNUNITSUBTEST)&PgeLagCompensationTest::test_findHitBySegment_Nearest);
+        addSubTest("test_findHitBySegment_IgnoresShooter", (PFNUNITSUBTEST)&PgeLagCompensationTest::test_findHitBySegment_IgnoresShooter);
+        addSubTest("test_findHitBySegment_Miss", (PFNUNITSUBTEST)&PgeLagCompensationTest::test_findHitBySegment_Miss);
+        addSubTest("test_findHitByRay", (PFNUNITSUBTEST)&PgeLagCompensationTest::test_findHitByRay);
+        addSubTest("test_benchmark_findHitBySegment", (PFNUNITSUBTEST)&PgeLagCompensationTest::test_benchmark_findHitBySegment);
+    }
+
+private:
+
+    static constexpr pge_network::PgeLagCompensation::TTimeUSecs nTickUSecs = 16000;
+
+    // ---------------------------------------------------------------------------
+
+    PgeLagCompensationTest(const PgeLagCompensationTest&)
+    {};
+
+    PgeLagCompensationTest& operator=(const PgeLagCompensationTest&)
+    {
+        return *this;
+    };
+
+    static PureAxisAlignedBoundingBox makeBox(const float& x, const float& y, const float& z)
+    {
+        // player-sized box
+        return PureAxisAlignedBoundingBox(PureVector(x, y, z), PureVector(1.f, 2.f, 1.f));
+    }
+
+    /**
+        Records nTicks ticks of 2 players: player 1 standing at origin, player 2 moving along X by 1 unit per tick starting at x = 10.
+    */
+    static void recordMovingPlayers(pge_network::PgeLagCompensation& lagComp, const uint32_t& nTicks)
+    {
+        for (uint32_t iTick = 0; iTick < nTicks; iTick++)
+        {
+            lagComp.beginTick(iTick * nTickUSecs);
+            lagComp.addPlayer(1, makeBox(0.f, 0.f, 0.f));
+            lagComp.addPlayer(2, makeBox(10.f + iTick, 0.f, 0.f));
+        }
+    }
+
+    bool assertBoxEquals(const PureAxisAlignedBoundingBox& expected, const PureAxisAlignedBoundingBox& actual, const std::string& sName)
+    {
+        bool b = true;
+        for (TPureByte i = 0; i < 3; i++)
+        {
+            b &= assertEquals(expected.getPosVec()[i], actual.getPosVec()[i], 0.0001f, sName + " pos " + std::to_string(i));
+            b &= assertEquals(expected.getSizeVec()[i], actual.getSizeVec()[i], 0.0001f, sName + " size " + std::to_string(i));
+        }
+        return b;
+    }
+
+    bool test_ctor()
+    {
+        const pge_network::PgeLagCompensation lagComp(32, 64);
+
+        return (assertEquals(32u, lagComp.getMaxPlayers(), "max players") &
+            assertEquals(64u, lagComp.getHistoryTickCount(), "history tick count") &
+            assertEquals(0u, lagComp.getRecordedTickCount(), "recorded tick count") &
+            assertEquals(0, lagComp.getOldestTimeUSecs(), "oldest") &
+            assertEquals(0, lagComp.getNewestTimeUSecs(), "newest") &
+            assertEquals(0u, lagComp.getQueryCount(), "query count") &
+            assertEquals(0u, lagComp.getClampedQueryCount(), "clamped query count")) != 0;
+    }
+
+    bool test_ctor_InvalidArgs()
+    {
+        const auto throws = [](const std::size_t& nMaxPlayers, const std::size_t& nHistoryTickCount)
+        {
+            try
+            {
+                const pge_network::PgeLagCompensation lagComp(nMaxPlayers, nHistoryTickCount);
+            }
+            catch (const std::exception&)
+            {
+                return true;
+            }
+            return false;
+        };
+
+        return (assertTrue(throws(0, 64), "zero players") &
+            assertTrue(throws(32, 0), "zero ticks") &
+            assertTrue(throws(32, 1), "1 tick") &
+            assertFalse(throws(1, 2), "valid")) != 0;
+    }
+
+    bool test_beginTick_addPlayer()
+    {
+        pge_network::PgeLagCompensation lagComp(2, 4);
+
+        bool b = assertFalse(lagComp.addPlayer(1, makeBox(0.f, 0.f, 0.f)), "add before tick");
+        b &= assertTrue(lagComp.beginTick(1000), "begin 1");
+        b &= assertFalse(lagComp.beginTick(1000), "begin same time");
+        b &= assertFalse(lagComp.beginTick(500), "begin older");
+        b &= assertTrue(lagComp.addPlayer(1, makeBox(0.f, 0.f, 0.f)), "add 1");
+        b &= assertTrue(lagComp.addPlayer(2, makeBox(5.f, 0.f, 0.f)), "add 2");
+        b &= assertFalse(lagComp.addPlayer(3, makeBox(9.f, 0.f, 0.f)), "add 3 over max");
+
+        PureAxisAlignedBoundingBox aabb;
+        return (b &
+            assertEquals(1u, lagComp.getRecordedTickCount(), "recorded tick count") &
+            assertEquals(1000, lagComp.getOldestTimeUSecs(), "oldest") &
+            assertEquals(1000, lagComp.getNewestTimeUSecs(), "newest") &
+            assertTrue(lagComp.getPlayerBox(2, 1000, aabb), "get 2") &
+            assertBoxEquals(makeBox(5.f, 0.f, 0.f), aabb, "box 2") &
+            assertFalse(lagComp.getPlayerBox(3, 1000, aabb), "get 3")) != 0;
+    }
+
+    bool test_history_Overwrite()
+    {
+        pge_network::PgeLagCompensation lagComp(2, 4);
+        recordMovingPlayers(lagComp, 10);
+
+        PureAxisAlignedBoundingBox aabb;
+        bool b = assertEquals(4u, lagComp.getRecordedTickCount(), "recorded tick count");
+        b &= assertEquals(6 * nTickUSecs, lagComp.getOldestTimeUSecs(), "oldest");
+        b &= assertEquals(9 * nTickUSecs, lagComp.getNewestTimeUSecs(), "newest");
+        b &= assertTrue(lagComp.getPlayerBox(2, 7 * nTickUSecs, aabb), "get");
+        b &= assertBoxEquals(makeBox(17.f, 0.f, 0.f), aabb, "box");
+
+        lagComp.clear();
+        return (b &
+            assertEquals(0u, lagComp.getRecordedTickCount(), "recorded tick count after clear") &
+            assertFalse(lagComp.getPlayerBox(2, 7 * nTickUSecs, aabb), "get after clear") &
+            assertTrue(lagComp.beginTick(0), "begin after clear")) != 0;
+    }
+
+    bool test_getPlayerBox_Interpolated()
+    {
+        pge_network::PgeLagCompensation lagComp(2, 16);
+        recordMovingPlayers(lagComp, 10);
+
+        PureAxisAlignedBoundingBox aabb1;
+        PureAxisAlignedBoundingBox aabb2;
+        return (assertTrue(lagComp.getPlayerBox(2, 3 * nTickUSecs + nTickUSecs / 4, aabb1), "get 1") &
+            assertBoxEquals(makeBox(13.25f, 0.f, 0.f), aabb1, "box 1") &
+            assertTrue(lagComp.getPlayerBox(1, 3 * nTickUSecs + nTickUSecs / 4, aabb2), "get 2") &
+            assertBoxEquals(makeBox(0.f, 0.f, 0.f), aabb2, "box 2") &
+            assertEquals(0u, lagComp.getClampedQueryCount(), "clamped query count")) != 0;
+    }
+
+    bool test_getPlayerBox_Clamped()
+    {
+        pge_network::PgeLagCompensation lagComp(2, 4);
+        recordMovingPlayers(lagComp, 10);
+
+        PureAxisAlignedBoundingBox aabbOld;
+        PureAxisAlignedBoundingBox aabbNew;
+        return (assertTrue(lagComp.getPlayerBox(2, 0, aabbOld), "get old") &
+            assertBoxEquals(makeBox(16.f, 0.f, 0.f), aabbOld, "box old") &
+            assertEquals(1u, lagComp.getClampedQueryCount(), "clamped query count") &
+            assertTrue(lagComp.getPlayerBox(2, 100 * nTickUSecs, aabbNew), "get new") &
+            assertBoxEquals(makeBox(19.f, 0.f, 0.f), aabbNew, "box new") &
+            assertEquals(1u, lagComp.getClampedQueryCount(), "clamped query count 2")) != 0;
+    }
+
+    bool test_getPlayerBox_MissingInNewerTick()
+    {
+        pge_network::PgeLagCompensation lagComp(4, 4);
+        lagComp.beginTick(0);
+        lagComp.addPlayer(1, makeBox(0.f, 0.f, 0.f));
+        lagComp.addPlayer(2, makeBox(4.f, 0.f, 0.f));
+        lagComp.beginTick(nTickUSecs);
+        // player 1 left, player 3 joined, player 2 moved to a different slot
+        lagComp.addPlayer(3, makeBox(8.f, 0.f, 0.f));
+        lagComp.addPlayer(2, makeBox(6.f, 0.f, 0.f));
+
+        PureAxisAlignedBoundingBox aabb1;
+        PureAxisAlignedBoundingBox aabb2;
+        PureAxisAlignedBoundingBox aabb3;
+        return (assertTrue(lagComp.getPlayerBox(1, nTickUSecs / 2, aabb1), "get 1") &
+            assertBoxEquals(makeBox(0.f, 0.f, 0.f), aabb1, "box 1") &
+            assertTrue(lagComp.getPlayerBox(2, nTickUSecs / 2, aabb2), "get 2") &
+            assertBoxEquals(makeBox(5.f, 0.f, 0.f), aabb2, "box 2") &
+            assertFalse(lagComp.getPlayerBox(3, nTickUSecs / 2, aabb3), "get 3") &
+            assertTrue(lagComp.getPlayerBox(3, nTickUSecs, aabb3), "get 3 later")) != 0;
+    }
+
+    bool test_findHitBySegment_Rewound()
+    {
+        pge_network::PgeLagCompensation lagComp(2, 16);
+        recordMovingPlayers(lagComp, 10);
+
+        // shooter aimed at where player 2 was at tick 3, by now player 2 moved away
+        pge_network::PgeLagCompensation::Hit hit;
+        const PureVector vecStart(13.f, 0.f, -10.f);
+        const PureVector vecEnd(13.f, 0.f, 10.f);
+        const bool bHitNow = lagComp.findHitBySegment(lagComp.getNewestTimeUSecs(), vecStart, vecEnd, 99, hit);
+        const bool bHitRewound = lagComp.findHitBySegment(3 * nTickUSecs, vecStart, vecEnd, 99, hit);
+
+        return (assertFalse(bHitNow, "hit now") &
+            assertTrue(bHitRewound, "hit rewound") &
+            assertEquals(2u, hit.m_entityId, "entity") &
+            assertEquals(0.475f, hit.m_fFraction, 0.0001f, "fraction") &
+            assertEquals(13.f, hit.m_pos.getX(), 0.0001f, "pos x") &
+            assertEquals(-0.5f, hit.m_pos.getZ(), 0.0001f, "pos z") &
+            assertEquals(2u, lagComp.getQueryCount(), "query count")) != 0;
+    }
+
+    bool test_findHitBySegment_Nearest()
+    {
+        pge_network::PgeLagCompensation lagComp(4, 4);
+        lagComp.beginTick(0);
+        lagComp.addPlayer(1, makeBox(20.f, 0.f, 0.f));
+        lagComp.addPlayer(2, makeBox(10.f, 0.f, 0.f));
+        lagComp.addPlayer(3, makeBox(30.f, 0.f, 0.f));
+
+        pge_network::PgeLagCompensation::Hit hitForward;
+        pge_network::PgeLagCompensation::Hit hitBackward;
+        return (assertTrue(lagComp.findHitBySegment(0, PureVector(0.f, 0.5f, 0.f), PureVector(40.f, 0.5f, 0.f), 0, hitForward), "hit forward") &
+            assertEquals(2u, hitForward.m_entityId, "entity forward") &
+            assertEquals(9.5f, hitForward.m_pos.getX(), 0.0001f, "pos forward") &
+            assertTrue(lagComp.findHitBySegment(0, PureVector(40.f, 0.5f, 0.f), PureVector(0.f, 0.5f, 0.f), 0, hitBackward), "hit backward") &
+            assertEquals(3u, hitBackward.m_entityId, "entity backward") &
+            assertEquals(30.5f, hitBackward.m_pos.getX(), 0.0001f, "pos backward")) != 0;
+    }
+
+    bool test_findHitBySegment_IgnoresShooter()
+    {
+        pge_network::PgeLagCompensation lagComp(4, 4);
+        lagComp.beginTick(0);
+        lagComp.addPlayer(1, makeBox(0.f, 0.f, 0.f));
+        lagComp.addPlayer(2, makeBox(5.f, 0.f, 0.f));
+
+        // shot starts inside the shooter's own box
+        pge_network::PgeLagCompensation::Hit hit;
+        bool b = assertTrue(lagComp.findHitBySegment(0, PureVector(0.f, 0.f, 0.f), PureVector(10.f, 0.f, 0.f), 1, hit), "hit");
+        b &= assertEquals(2u, hit.m_entityId, "entity");
+
+        // without ignoring, the shooter itself would be hit right at the start
+        b &= assertTrue(lagComp.findHitBySegment(0, PureVector(0.f, 0.f, 0.f), PureVector(10.f, 0.f, 0.f), 99, hit), "hit self");
+        b &= assertEquals(1u, hit.m_entityId, "entity self");
+        b &= assertEquals(0.f, hit.m_fFraction, "fraction self");
+        return b;
+    }
+
+    bool test_findHitBySegment_Miss()
+    {
+        pge_network::PgeLagCompensation lagComp(4, 4);
+        pge_network::PgeLagCompensation::Hit hit;
+        bool b = assertFalse(lagComp.findHitBySegment(0, PureVector(0.f, 0.f, 0.f), PureVector(10.f, 0.f, 0.f), 0, hit), "no history");
+
+        lagComp.beginTick(0);
+        lagComp.addPlayer(1, makeBox(5.f, 0.f, 0.f));
+
+        return (b &
+            assertFalse(lagComp.findHitBySegment(0, PureVector(0.f, 0.f, 0.f), PureVector(4.f, 0.f, 0.f), 0, hit), "too short") &
+            assertFalse(lagComp.findHitBySegment(0, PureVector(0.f, 1.5f, 0.f), PureVector(10.f, 1.5f, 0.f), 0, hit), "parallel above") &
+            assertFalse(lagComp.findHitBySegment(0, PureVector(0.f, 0.f, 0.f), PureVector(-10.f, 0.f, 0.f), 0, hit), "opposite") &
+            assertFalse(lagComp.findHitBySegment(0, PureVector(0.f, 0.f, 5.f), PureVector(10.f, 0.f, 2.f), 0, hit), "diagonal") &
+            assertTrue(lagComp.findHitBySegment(0, PureVector(0.f, 0.f, 5.f), PureVector(10.f, 0.f, -5.f), 0, hit), "diagonal hit")) != 0;
+    }
+
+    bool test_findHitByRay()
+    {
+        pge_network::PgeLagCompensation lagComp(4, 4);
+        lagComp.beginTick(0);
+        lagComp.addPlayer(1, makeBox(0.f, 0.f, 20.f));
+
+        pge_network::PgeLagCompensation::Hit hit;
+        return (assertTrue(lagComp.findHitByRay(0, PureVector(0.f, 0.f, 0.f), PureVector(0.f, 0.f, 3.f), 100.f, 0, hit), "hit") &
+            assertEquals(1u, hit.m_entityId, "entity") &
+            assertEquals(19.5f, hit.m_pos.getZ(), 0.0001f, "pos") &
+            assertEquals(0.195f, hit.m_fFraction, 0.0001f, "fraction") &
+            assertFalse(lagComp.findHitByRay(0, PureVector(0.f, 0.f, 0.f), PureVector(0.f, 0.f, 1.f), 10.f, 0, hit), "too short") &
+            assertFalse(lagComp.findHitByRay(0, PureVector(0.f, 0.f, 0.f), PureVector(0.f, 0.f, 0.f), 100.f, 0, hit), "zero dir")) != 0;
+    }
+
+    bool test_benchmark_findHitBySegment()
+    {
+        constexpr uint32_t nPlayers = 32;
+        constexpr uint32_t nHistoryTicks = 64;   // 1 sec at 64 Hz tickrate
+        constexpr uint32_t nQueries = 200000;
+
+        pge_network::PgeLagCompensation lagComp(nPlayers, nHistoryTicks);
+        for (uint32_t iTick = 0; iTick < nHistoryTicks; iTick++)
+        {
+            lagComp.beginTick(iTick * nTickUSecs);
+            for (uint32_t iPlayer = 0; iPlayer < nPlayers; iPlayer++)
+            {
+                lagComp.addPlayer(iPlayer, makeBox((iPlayer % 8) * 4.f + iTick * 0.1f, 0.f, (iPlayer / 8) * 4.f));
+            }
+        }
+
+        uint32_t nHits = 0;
+        pge_network::PgeLagCompensation::Hit hit;
+        const auto timeStart = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < nQueries; i++)
+        {
+            // shots from various players to various directions, rewinding up to the whole history
+            const pge_network::PgeLagCompensation::TTimeUSecs nViewTimeUSecs = (i * 7919) % (nHistoryTicks * nTickUSecs);
+            const float fTargetX = static_cast<float>(i % 40);
+            const float fTargetZ = static_cast<float>((i / 40) % 16);
+            if (lagComp.findHitBySegment(nViewTimeUSecs, PureVector(-5.f, 0.f, -5.f), PureVector(fTargetX, 0.f, fTargetZ), i % nPlayers, hit))
+            {
+                ++nHits;
+            }
+        }
+        const auto timeEnd = std::chrono::steady_clock::now();
+
+        const auto nDurationNanosecs = std::chrono::duration_cast<std::chrono::nanoseconds>(timeEnd - timeStart).count();
+        CConsole::getConsoleInstance().OLn(
+            "PgeLagCompensationTest::%s(): %u queries against %u players in %d us, %.1f ns/query, hits: %u",
+            __func__,
+            nQueries,
+            nPlayers,
+            static_cast<int>(nDurationNanosecs / 1000),
+            static_cast<double>(nDurationNanosecs) / nQueries,
+            nHits);
+
+        return (assertLess(0u, nHits, "hits") &
+            assertLess(nHits, nQueries, "misses") &
+            assertEquals(nQueries, lagComp.getQueryCount(), "query count")) != 0;
+    }
+
+}; // class PgeLagCompensationTest
@@ -0,0 +1,394 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeLoadGeneratorTest.h
+    Unit test for PgeLoadGenerator.
+    Made by PR00F88, West Whiskhyll Entertainment
+    2026
+    ###################################################################################
+*/
+
+#include "UnitTest.h"  // PCH
+
+#include "../Network/PgeLoadGenerator.h"
+#include "../Network/PgeLoopbackClient.h"
+#include "../Network/PgeLoopbackServer.h"
+#include "../Network/PgeLoopbackTransport.h"
+
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class PgeLoadGeneratorTest :
+    public UnitTest
+{
+public:
+
+    PgeLoadGeneratorTest() :
+        UnitTest(__FILE__)
+    {
+    }
+
+protected:
+
+    virtual void initialize() override
+    {
+        addSubTest("test_ctor", (PFNUNITSUBTEST)&PgeLoadGeneratorTest::test_ctor);
+        addSubTest("test_ctor_Bad", (PFNUNITSUBTEST)&PgeLoadGeneratorTest::test_ctor_Bad);
+        addSubTest("test_addClient_AllowListsProbe", (PFNUNITSUBTEST)&PgeLoadGeneratorTest::test_addClient_AllowListsProbe);
+        addSubTest("test_update_JoinAfterProbeReply", (PFNUNITSUBTEST)&PgeLoadGeneratorTest::test_update_JoinAfterProbeReply);
+        addSubTest("test_update_InputPattern", (PFNUNITSUBTEST)&PgeLoadGeneratorTest::test_update_InputPattern);
+        addSubTest("test_report_RttAndServerTick", (PFNUNITSUBTEST)&PgeLoadGeneratorTest::test_report_RttAndServerTick);
+        addSubTest("test_report_SampleCapacity", (PFNUNITSUBTEST)&PgeLoadGeneratorTest::test_report_SampleCapacity);
+        addSubTest("test_resetStats", (PFNUNITSUBTEST)&PgeLoadGeneratorTest::test_resetStats);
+        addSubTest("test_serverDisconnect", (PFNUNITSUBTEST)&PgeLoadGeneratorTest::test_serverDisconnect);
+        addSubTest("test_handleProbePkt_Bad", (PFNUNITSUBTEST)&PgeLoadGeneratorTest::test_handleProbePkt_Bad);
+    }
+
+private:
+
+    static constexpr pge_network::MsgApp::TMsgId msgIdInput = 20;
+    static constexpr pge_network::MsgApp::TMsgId msgIdProbe = 21;
+    static constexpr pge_network::PgeLoopbackTransport::TTimeUSecs nTickUSecs = 10000;
+    static constexpr uint32_t nServerTickUSecs = 1234;
+
+    /**
+        1 server and N clients on the same transport, the server echoing probes and recording inputs.
+    */
+    struct Harness
+    {
+        pge_network::PgeLoopbackTransport m_transport;
+        pge_network::PgeLoopbackServer m_server;
+        std::vector<std::unique_ptr<pge_network::PgeLoopbackClient>> m_vClients;
+        std::vector<pge_network::MsgLoadGenInput> m_vInputs;  /**< Inputs received from any client. */
+        std::set<pge_network::PgeNetworkConnectionHandle> m_setInputSenders;
+
+        explicit Harness(const pge_network::PgeLoopbackTransport::TTimeUSecs& nLatencyUSecs)
+            : m_transport(makeLinkConfig(nLatencyUSecs)),
+            m_server(m_transport)
+        {
+        }
+    };
+
+    // ---------------------------------------------------------------------------
+
+    PgeLoadGeneratorTest(const PgeLoadGeneratorTest&)
+    {};
+
+    PgeLoadGeneratorTest& operator=(const PgeLoadGeneratorTest&)
+    {
+        return *this;
+    };
+
+    static pge_network::PgeLoopbackTransport::LinkConfig makeLinkConfig(const pge_network::PgeLoopbackTransport::TTimeUSecs& nLatencyUSecs)
+    {
+        pge_network::PgeLoopbackTransport::LinkConfig linkConfig;
+        linkConfig.m_nLatencyUSecs = nLatencyUSecs;
+        return linkConfig;
+    }
+
+    bool startHarness(Harness& harness, pge_network::PgeLoadGenerator& loadGen, const std::size_t& nClients)
+    {
+        bool b = assertTrue(harness.m_server.initialize(), "server init");
+        harness.m_server.getAllowListedAppMessages().insert(msgIdInput);
+        harness.m_server.getAllowListedAppMessages().insert(msgIdProbe);
+        b &= assertTrue(harness.m_server.startListening(), "server listen");
+        for (std::size_t i = 0; i < nClients; i++)
+        {
+            harness.m_vClients.push_back(std::make_unique<pge_network::PgeLoopbackClient>(harness.m_transport));
+            pge_network::PgeLoopbackClient& client = *harness.m_vClients.back();
+            b &= assertTrue(client.initialize(), ("client init " + std::to_string(i)).c_str());
+            b &= assertTrue(client.connectToServer("127.0.0.1"), ("client connect " + std::to_string(i)).c_str());
+            loadGen.addClient(client);
+        }
+        return b;
+    }
+
+    /**
+        Advances time by 1 tick, then executes a server tick and a load generator tick.
+    */
+    static void tick(Harness& harness, pge_network::PgeLoadGenerator& loadGen)
+    {
+        harness.m_transport.advanceTime(nTickUSecs);
+
+        harness.m_server.Update();
+        while (harness.m_server.getPacketQueueSize() > 0)
+        {
+            const pge_network::PgePacket& pkt = harness.m_server.borrowFrontPacket();
+            if (!pge_network::PgeLoadGenerator::handleProbePkt(harness.m_server, pkt, msgIdProbe, nServerTickUSecs) &&
+                (pge_network::PgePacket::getPacketId(pkt) == pge_network::PgePktId::Application) &&
+                (pge_network::PgePacket::getMsgAppIdFromPkt(pkt) == msgIdInput))
+            {
+                harness.m_vInputs.push_back(pge_network::PgePacket::getMsgAppDataFromPkt<pge_network::MsgLoadGenInput>(pkt));
+                harness.m_setInputSenders.insert(pge_network::PgePacket::getServerSideConnectionHandle(pkt));
+            }
+            harness.m_server.releaseFrontPacket();
+        }
+        harness.m_server.flushBatchedPackets();
+
+        loadGen.update(harness.m_transport.getTime());
+    }
+
+    static void tick(Harness& harness, pge_network::PgeLoadGenerator& loadGen, const uint32_t& nTicks)
+    {
+        for (uint32_t i = 0; i < nTicks; i++)
+        {
+            tick(harness, loadGen);
+        }
+    }
+
+    static pge_network::PgeLoadGenerator::Pattern makeProbeOnlyPattern(const uint32_t& nProbePeriod)
+    {
+        pge_network::PgeLoadGenerator::Pattern pattern;
+        pattern.m_nProbePeriod = nProbePeriod;
+        return pattern;
+    }
+
+    bool test_ctor()
+    {
+        const pge_network::PgeLoadGenerator::Pattern pattern;
+        const pge_network::PgeLoadGenerator loadGen(msgIdInput, msgIdProbe, pattern, 0);
+        const pge_network::PgeLoadGenerator::Report report = loadGen.getReport(1000000);
+
+        return assertEquals(msgIdInput, loadGen.getMsgIdInput(), "msg id input") &
+            assertEquals(msgIdProbe, loadGen.getMsgIdProbe(), "msg id probe") &
+            assertEquals(pattern.m_nWeaponCount, loadGen.getPattern().m_nWeaponCount, "pattern") &
+            assertEquals(0u, loadGen.getClientCount(), "client count") &
+            assertEquals(0u, loadGen.getJoinedClientCount(), "joined count") &
+            assertEquals(1000000, report.m_nDurationUSecs, "duration") &
+            assertEquals(0u, report.m_nTxMsgCount, "tx") &
+            assertEquals(0u, report.m_nRxMsgCount, "rx") &
+            assertEquals(0u, report.m_rtt.m_nCount, "rtt count") &
+            assertEquals(0u, report.m_serverTick.m_nCount, "server tick count");
+    }
+
+    bool test_ctor_Bad()
+    {
+        pge_network::PgeLoadGenerator::Pattern patternNoWeapon;
+        patternNoWeapon.m_nWeaponCount = 0;
+
+        bool b = true;
+        try
+        {
+            const pge_network::PgeLoadGenerator loadGen(msgIdInput, msgIdInput, pge_network::PgeLoadGenerator::Pattern(), 0);
+            b = assertTrue(false, "same msg ids");
+        }
+        catch (const std::exception&) {}
+        try
+        {
+            const pge_network::PgeLoadGenerator loadGen(msgIdInput, msgIdProbe, patternNoWeapon, 0);
+            b &= assertTrue(false, "no weapon");
+        }
+        catch (const std::exception&) {}
+        try
+        {
+            const pge_network::PgeLoadGenerator loadGen(msgIdInput, msgIdProbe, makeProbeOnlyPattern(0), 0);
+            b &= assertTrue(false, "no probe period");
+        }
+        catch (const std::exception&) {}
+        try
+        {
+            const pge_network::PgeLoadGenerator loadGen(msgIdInput, msgIdProbe, pge_network::PgeLoadGenerator::Pattern(), 0, 1, 0);
+            b &= assertTrue(false, "no sample capacity");
+        }
+        catch (const std::exception&) {}
+
+        return b;
+    }
+
+    bool test_addClient_AllowListsProbe()
+    {
+        pge_network::PgeLoopbackTransport transport;
+        pge_network::PgeLoopbackClient client(transport);
+        pge_network::PgeLoadGenerator loadGen(msgIdInput, msgIdProbe, pge_network::PgeLoadGenerator::Pattern(), 0);
+        loadGen.addClient(client);
+
+        return assertEquals(1u, loadGen.getClientCount(), "client count") &
+            assertEquals(0u, loadGen.getJoinedClientCount(), "joined count") &
+            assertTrue(client.getAllowListedAppMessages().count(msgIdProbe) == 1, "allow-listed");
+    }
+
+    bool test_update_JoinAfterProbeReply()
+    {
+        Harness harness(5000);
+        pge_network::PgeLoadGenerator loadGen(msgIdInput, msgIdProbe, makeProbeOnlyPattern(5), 0);
+        bool b = startHarness(harness, loadGen, 4);
+
+        // connecting takes a few ticks, then the first probe of each client is sent within 5 ticks and replied within 1 tick
+        tick(harness, loadGen, 2);
+        b &= assertEquals(0u, loadGen.getJoinedClientCount(), "joined count early");
+        b &= assertTrue(harness.m_vInputs.empty(), "no input before joining");
+
+        tick(harness, loadGen, 10);
+        b &= assertEquals(4u, loadGen.getJoinedClientCount(), "joined count");
+        tick(harness, loadGen, 2);
+        b &= assertFalse(harness.m_vInputs.empty(), "inputs after joining");
+        b &= assertEquals(4u, harness.m_setInputSenders.size(), "input senders");
+
+        return b;
+    }
+
+    bool test_update_InputPattern()
+    {
+        pge_network::PgeLoadGenerator::Pattern pattern;
+        pattern.m_nStrafePeriod = 10;
+        pattern.m_nJumpPeriod = 25;
+        pattern.m_nFirePeriod = 20;
+        pattern.m_nFireBurstLength = 5;
+        pattern.m_nWeaponSwitchPeriod = 50;
+        pattern.m_nWeaponCount = 3;
+        pattern.m_nProbePeriod = 1;
+
+        Harness harness(0);
+        pge_network::PgeLoadGenerator loadGen(msgIdInput, msgIdProbe, pattern, 0, 7);
+        bool b = startHarness(harness, loadGen, 1);
+        tick(harness, loadGen, 1000);
+
+        // 1 client only, every tick of the pattern is seen in order
+        const std::vector<pge_network::MsgLoadGenInput>& vInputs = harness.m_vInputs;
+        b &= assertLess(500u, vInputs.size(), "input count");
+        if (!b)
+        {
+            return false;
+        }
+
+        const std::size_t nPeriods = 10;
+        const std::size_t nTicks = nPeriods * 100;  // common multiple of all periods
+        uint32_t nStrafeFlips = 0;
+        uint32_t nJumps = 0;
+        uint32_t nAttacks = 0;
+        uint32_t nWeaponSwitches = 0;
+        std::set<uint8_t> setWeapons;
+        std::size_t iFirst = 0;
+        for (std::size_t i = 1; (i < vInputs.size()) && (i - iFirst < nTicks); i++)
+        {
+            b &= assertEquals(vInputs[i - 1].m_nTick + 1, vInputs[i].m_nTick, "consecutive ticks");
+            nStrafeFlips += (vInputs[i].m_nStrafe != vInputs[i - 1].m_nStrafe) ? 1 : 0;
+            nJumps += vInputs[i].m_bJump ? 1 : 0;
+            nAttacks += vInputs[i].m_bAttack ? 1 : 0;
+            nWeaponSwitches += (vInputs[i].m_iWeapon != vInputs[i - 1].m_iWeapon) ? 1 : 0;
+            setWeapons.insert(vInputs[i].m_iWeapon);
+            b &= assertTrue((vInputs[i].m_fAimAngle >= 0.f) && (vInputs[i].m_fAimAngle < 360.f), "aim angle");
+            b &= assertTrue((vInputs[i].m_nStrafe == -1) || (vInputs[i].m_nStrafe == 1), "strafe");
+        }
+
+        // counting starts from the 2nd input, so each count might be 1 less than exact
+        b &= assertLequals(nTicks / 10 - 1, nStrafeFlips, "strafe flips") & assertLequals(nStrafeFlips, nTicks / 10, "strafe flips 2");
+        b &= assertLequals(nTicks / 25 - 1, nJumps, "jumps") & assertLequals(nJumps, nTicks / 25, "jumps 2");
+        b &= assertLequals(nTicks / 20 * 5 - 5, nAttacks, "attacks") & assertLequals(nAttacks, nTicks / 20 * 5, "attacks 2");
+        b &= assertLequals(nTicks / 50 - 1, nWeaponSwitches, "weapon switches") & assertLequals(nWeaponSwitches, nTicks / 50, "weapon switches 2");
+        b &= assertEquals(3u, setWeapons.size(), "weapons");
+        b &= assertTrue(*setWeapons.rbegin() < 3, "weapon slot");
+
+        return b;
+    }
+
+    bool test_report_RttAndServerTick()
+    {
+        // probe travels 20 ms to server, replied in the same tick, travels 20 ms back
+        Harness harness(20000);
+        pge_network::PgeLoadGenerator loadGen(msgIdInput, msgIdProbe, makeProbeOnlyPattern(4), 0);
+        bool b = startHarness(harness, loadGen, 8);
+
+        // probes sent while connecting wait for the connection, so they are excluded by a warm-up period
+        tick(harness, loadGen, 20);
+        loadGen.resetStats(harness.m_transport.getTime());
+        tick(harness, loadGen, 100);
+
+        const pge_network::PgeLoadGenerator::Report report = loadGen.getReport(harness.m_transport.getTime());
+        b &= assertEquals(8u, report.m_nClientCount, "client count");
+        b &= assertEquals(8u, report.m_nJoinedClientCount, "joined count");
+        b &= assertEquals(100 * nTickUSecs, report.m_nDurationUSecs, "duration");
+        b &= assertLess(0u, report.m_rtt.m_nCount, "rtt count");
+        b &= assertEquals(40000u, report.m_rtt.m_nP50, "rtt p50");
+        b &= assertEquals(40000u, report.m_rtt.m_nP99, "rtt p99");
+        b &= assertEquals(40000u, report.m_rtt.m_nMax, "rtt max");
+        b &= assertEquals(report.m_rtt.m_nCount, report.m_serverTick.m_nCount, "server tick count");
+        b &= assertEquals(nServerTickUSecs, report.m_serverTick.m_nP50, "server tick p50");
+        b &= assertEquals(nServerTickUSecs, report.m_serverTick.m_nMax, "server tick max");
+        b &= assertLess(0u, report.m_nTxMsgCount, "tx");
+        b &= assertEquals(static_cast<uint64_t>(report.m_rtt.m_nCount), report.m_nRxMsgCount, "rx is only probe replies");
+        b &= assertTrue(report.m_fTxMsgPerSec > 0.f, "tx rate");
+        b &= assertTrue(report.m_fRxMsgPerSec > 0.f, "rx rate");
+        b &= assertEquals(0u, report.m_nDisconnectCount, "disconnect count");
+
+        return b;
+    }
+
+    bool test_report_SampleCapacity()
+    {
+        Harness harness(0);
+        pge_network::PgeLoadGenerator loadGen(msgIdInput, msgIdProbe, makeProbeOnlyPattern(1), 0, 1, 4);
+        bool b = startHarness(harness, loadGen, 2);
+        tick(harness, loadGen, 50);
+
+        const pge_network::PgeLoadGenerator::Report report = loadGen.getReport(harness.m_transport.getTime());
+        b &= assertEquals(4u, report.m_rtt.m_nCount, "rtt count");
+        b &= assertEquals(4u, report.m_serverTick.m_nCount, "server tick count");
+        b &= assertLess(4u, static_cast<uint32_t>(report.m_nRxMsgCount), "rx");
+
+        return b;
+    }
+
+    bool test_resetStats()
+    {
+        Harness harness(0);
+        pge_network::PgeLoadGenerator loadGen(msgIdInput, msgIdProbe, makeProbeOnlyPattern(1), 0);
+        bool b = startHarness(harness, loadGen, 2);
+        tick(harness, loadGen, 20);
+
+        loadGen.resetStats(harness.m_transport.getTime());
+        pge_network::PgeLoadGenerator::Report report = loadGen.getReport(harness.m_transport.getTime());
+        b &= assertEquals(0, report.m_nDurationUSecs, "duration");
+        b &= assertEquals(0u, report.m_nTxMsgCount, "tx");
+        b &= assertEquals(0u, report.m_nRxMsgCount, "rx");
+        b &= assertEquals(0u, report.m_rtt.m_nCount, "rtt count");
+        b &= assertEquals(2u, report.m_nJoinedClientCount, "joined count kept");
+
+        tick(harness, loadGen, 10);
+        report = loadGen.getReport(harness.m_transport.getTime());
+        b &= assertEquals(10 * nTickUSecs, report.m_nDurationUSecs, "duration 2");
+        b &= assertLess(0u, report.m_rtt.m_nCount, "rtt count 2");
+
+        return b;
+    }
+
+    bool test_serverDisconnect()
+    {
+        Harness harness(0);
+        pge_network::PgeLoadGenerator loadGen(msgIdInput, msgIdProbe, makeProbeOnlyPattern(1), 0);
+        bool b = startHarness(harness, loadGen, 3);
+        tick(harness, loadGen, 10);
+        b &= assertEquals(3u, loadGen.getJoinedClientCount(), "joined count");
+
+        harness.m_server.disconnect("test");
+        tick(harness, loadGen, 5);
+        b &= assertEquals(0u, loadGen.getJoinedClientCount(), "joined count after disconnect");
+        b &= assertEquals(3u, loadGen.getReport(harness.m_transport.getTime()).m_nDisconnectCount, "disconnect count");
+
+        return b;
+    }
+
+    bool test_handleProbePkt_Bad()
+    {
+        Harness harness(0);
+        bool b = assertTrue(harness.m_server.initialize(), "server init");
+
+        pge_network::PgePacket pktOther;
+        pge_network::PgePacket::initPktMsgApp(pktOther, 1);
+        b &= assertNotNull(pge_network::PgePacket::preparePktMsgAppFill(pktOther, msgIdInput, sizeof(pge_network::MsgLoadGenInput)), "prepare other");
+        b &= assertFalse(pge_network::PgeLoadGenerator::handleProbePkt(harness.m_server, pktOther, msgIdProbe, 0), "other msg");
+
+        pge_network::PgePacket pktBadSize;
+        pge_network::PgePacket::initPktMsgApp(pktBadSize, 1);
+        b &= assertNotNull(pge_network::PgePacket::preparePktMsgAppFill(pktBadSize, msgIdProbe, 1), "prepare bad size");
+        b &= assertTrue(pge_network::PgeLoadGenerator::handleProbePkt(harness.m_server, pktBadSize, msgIdProbe, 0), "bad size");
+        b &= assertEquals(0u, harness.m_server.getTxPacketCount(), "nothing sent");
+
+        return b;
+    }
+
+};
@@ -0,0 +1,555 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeLoopbackTransportTest.h
+    Unit test for PgeLoopbackTransport, PgeLoopbackServer and PgeLoopbackClient.
+    Made by PR00F88, West Whiskhyll Entertainment
+    2026
+    ###################################################################################
+*/
+
+#include "UnitTest.h"  // PCH
+
+#include "../Network/PgeLoopbackClient.h"
+#include "../Network/PgeLoopbackServer.h"
+#include "../Network/PgeLoopbackTransport.h"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+class PgeLoopbackTransportTest :
+    public UnitTest
+{
+public:
+
+    PgeLoopbackTransportTest() :
+        UnitTest(__FILE__)
+    {
+    }
+
+protected:
+
+    virtual void initialize() override
+    {
+        addSubTest("test_ctor", (PFNUNITSUBTEST)&PgeLoopbackTransportTest::test_ctor);
+        addSubTest("test_connect_NotListening", (PFNUNITSUBTEST)&PgeLoopbackTransportTest::test_connect_NotListening);
+        addSubTest("test_send_receive_Latency", (PFNUNITSUBTEST)&PgeLoopbackTransportTest::test_send_receive_Latency);
+        addSubTest("test_send_Reliable_KeepsOrderWithJitter", (PFNUNITSUBTEST)&PgeLoopbackTransportTest::test_send_Reliable_KeepsOrderWithJitter);
+        addSubTest("test_send_Unreliable_Loss_IsDeterministic", (PFNUNITSUBTEST)&PgeLoopbackTransportTest::test_send_Unreliable_Loss_IsDeterministic);
+        addSubTest("test_send_Bandwidth", (PFNUNITSUBTEST)&PgeLoopbackTransportTest::test_send_Bandwidth);
+        addSubTest("test_close", (PFNUNITSUBTEST)&PgeLoopbackTransportTest::test_close);
+        addSubTest("test_server_client_connect", (PFNUNITSUBTEST)&PgeLoopbackTransportTest::test_server_client_connect);
+        addSubTest("test_server_client_connect_AppVersionMismatch", (PFNUNITSUBTEST)&PgeLoopbackTransportTest::test_server_client_connect_AppVersionMismatch);
+        addSubTest("test_server_client_msgApp_batched", (PFNUNITSUBTEST)&PgeLoopbackTransportTest::test_server_client_msgApp_batched);
+        addSubTest("test_server_disconnect", (PFNUNITSUBTEST)&PgeLoopbackTransportTest::test_server_disconnect);
+        addSubTest("test_benchmark_serverTick", (PFNUNITSUBTEST)&PgeLoopbackTransportTest::test_benchmark_serverTick);
+    }
+
+private:
+
+    static constexpr pge_network::MsgApp::TMsgId nMsgIdInput = 1u;
+    static constexpr pge_network::MsgApp::TMsgId nMsgIdUpdate = 2u;
+    static constexpr pge_network::MsgApp::TMsgId nMsgIdEvent = 3u;
+
+    /**
+        1 server and N clients on the same transport, all initialized, server listening.
+    */
+    struct Harness
+    {
+        pge_network::PgeLoopbackTransport m_transport;
+        pge_network::PgeLoopbackServer m_server;
+        std::vector<std::unique_ptr<pge_network::PgeLoopbackClient>> m_vClients;
+
+        explicit Harness(const pge_network::PgeLoopbackTransport::LinkConfig& linkConfig, const uint64_t& nSeed = 1) :
+            m_transport(linkConfig, nSeed),
+            m_server(m_transport)
+        {
+        }
+    };
+
+    // ---------------------------------------------------------------------------
+
+    PgeLoopbackTransportTest(const PgeLoopbackTransportTest&)
+    {};
+
+    PgeLoopbackTransportTest& operator=(const PgeLoopbackTransportTest&)
+    {
+        return *this;
+    };
+
+    static pge_network::PgeLoopbackTransport::LinkConfig makeLinkConfig(
+        const pge_network::PgeLoopbackTransport::TTimeUSecs& nLatencyUSecs,
+        const pge_network::PgeLoopbackTransport::TTimeUSecs& nJitterUSecs,
+        const float& fLossRate,
+        const uint32_t& nBandwidthBytesPerSec)
+    {
+        pge_network::PgeLoopbackTransport::LinkConfig linkConfig;
+        linkConfig.m_nLatencyUSecs = nLatencyUSecs;
+        linkConfig.m_nJitterUSecs = nJitterUSecs;
+        linkConfig.m_fLossRate = fLossRate;
+        linkConfig.m_nBandwidthBytesPerSec = nBandwidthBytesPerSec;
+        return linkConfig;
+    }
+
+    static pge_network::PgePacket makePkt(const pge_network::PgeNetworkConnectionHandle& connHandle)
+    {
+        pge_network::PgePacket pkt;
+        pge_network::PgePacket::initPktPgeMsgUserDisconnected(pkt, connHandle);
+        return pkt;
+    }
+
+    static pge_network::PgePacket makePktMsgApp(const pge_network::MsgApp::TMsgId& msgAppId, const uint32_t& nValue)
+    {
+        pge_network::PgePacket pkt;
+        pge_network::PgePacket::initPktMsgApp(pkt, pge_network::ServerConnHandle);
+        pge_network::TByte* const pData = pge_network::PgePacket::preparePktMsgAppFill(pkt, msgAppId, sizeof(nValue));
+        if (pData)
+        {
+            memcpy(pData, &nValue, sizeof(nValue));
+        }
+        return pkt;
+    }
+
+    static uint32_t getMsgAppValue(const pge_network::PgePacket& pkt)
+    {
+        uint32_t nValue = 0;
+        memcpy(&nValue, pge_network::MsgApp::getMsgAppData(*pge_network::PgePacket::getMsgAppFromPkt(pkt)), sizeof(nValue));
+        return nValue;
+    }
+
+    static void allowListAppMessages(pge_network::PgeIServerClient& serverClient)
+    {
+        serverClient.getAllowListedAppMessages().insert(nMsgIdInput);
+        serverClient.getAllowListedAppMessages().insert(nMsgIdUpdate);
+        serverClient.getAllowListedAppMessages().insert(nMsgIdEvent);
+        serverClient.getMsgAppId2SendLaneMap()[nMsgIdInput] = pge_network::PgeSendLane::Unreliable;
+        serverClient.getMsgAppId2SendLaneMap()[nMsgIdUpdate] = pge_network::PgeSendLane::Unreliable;
+    }
+
+    static uint32_t countAndDropPkts(pge_network::PgeIServerClient& serverClient, const pge_network::PgePktId& pktId)
+    {
+        uint32_t nCount = 0;
+        while (serverClient.getPacketQueueSize() > 0)
+        {
+            if (pge_network::PgePacket::getPacketId(serverClient.borrowFrontPacket()) == pktId)
+            {
+                nCount++;
+            }
+            serverClient.releaseFrontPacket();
+        }
+        return nCount;
+    }
+
+    /**
+        Delivers everything in flight: advances time in steps, polling and flushing all endpoints after each step.
+    */
+    static void pump(Harness& harness, const uint32_t& nSteps, const pge_network::PgeLoopbackTransport::TTimeUSecs& nStepUSecs)
+    {
+        for (uint32_t i = 0; i < nSteps; i++)
+        {
+            harness.m_transport.advanceTime(nStepUSecs);
+            harness.m_server.Update();
+            harness.m_server.flushBatchedPackets();
+            for (auto& pClient : harness.m_vClients)
+            {
+                pClient->Update();
+                pClient->flushBatchedPackets();
+            }
+        }
+    }
+
+    bool startHarness(Harness& harness, const size_t& nClients, const std::string& sServerAppVersion, const std::string& sClientAppVersion)
+    {
+        bool b = assertTrue(harness.m_server.initialize(), "server init");
+        allowListAppMessages(harness.m_server);
+        b &= assertTrue(harness.m_server.startListening(sServerAppVersion), "server listen");
+        for (size_t i = 0; i < nClients; i++)
+        {
+            harness.m_vClients.push_back(std::make_unique<pge_network::PgeLoopbackClient>(harness.m_transport));
+            pge_network::PgeLoopbackClient& client = *harness.m_vClients.back();
+            b &= assertTrue(client.initialize(), ("client init " + std::to_string(i)).c_str());
+            allowListAppMessages(client);
+            b &= assertTrue(client.connectToServer("127.0.0.1", sClientAppVersion), ("client connect " + std::to_string(i)).c_str());
+        }
+        pump(harness, 4, harness.m_transport.getLinkConfig().m_nLatencyUSecs + 1);
+        return b;
+    }
+
+    bool test_ctor()
+    {
+        pge_network::PgeLoopbackTransport transport;
+
+        return assertEquals(0, transport.getTime(), "time") &
+            assertEquals(0, transport.getLinkConfig().m_nLatencyUSecs, "latency") &
+            assertEquals(0u, transport.getLinkConfig().m_nBandwidthBytesPerSec, "bandwidth") &
+            assertFalse(transport.isListening(), "listening") &
+            assertEquals(0u, transport.getInFlightCount(pge_network::PgeLoopbackTransport::Side::Server), "in flight") &
+            assertEquals(0u, transport.getSentCount(), "sent") &
+            assertEquals(0u, transport.getDeliveredCount(), "delivered") &
+            assertEquals(0u, transport.getLostCount(), "lost");
+    }
+
+    bool test_connect_NotListening()
+    {
+        pge_network::PgeLoopbackTransport transport;
+
+        bool b = assertEquals(pge_network::ServerConnHandle, transport.connect(), "connect 1");
+        b &= assertTrue(transport.listen(), "listen 1") & assertFalse(transport.listen(), "listen 2");
+        b &= assertEquals(1u, transport.connect(), "connect 2");
+        b &= assertEquals(2u, transport.connect(), "connect 3");
+        transport.stopListening();
+        return b & assertFalse(transport.isListening(), "listening") &
+            assertEquals(pge_network::ServerConnHandle, transport.connect(), "connect 4");
+    }
+
+    bool test_send_receive_Latency()
+    {
+        using Side = pge_network::PgeLoopbackTransport::Side;
+        pge_network::PgeLoopbackTransport transport(makeLinkConfig(1000, 0, 0.f, 0));
+        transport.listen();
+        const pge_network::PgeNetworkConnectionHandle connHandle = transport.connect();
+
+        const pge_network::PgePacket pktSent = makePkt(5);
+        const uint32_t nSize = pge_network::PgePacket::getPktActualSizeBytes(pktSent);
+        bool b = assertTrue(transport.send(connHandle, Side::Client, pktSent, nSize, pge_network::PgeSendLane::Reliable), "send");
+        b &= assertEquals(1u, transport.getInFlightCount(Side::Client), "in flight 1");
+        b &= assertEquals(static_cast<uint64_t>(nSize), transport.getInFlightBytes(connHandle, Side::Client, true), "in flight bytes 1");
+
+        pge_network::PgePacket pkt;
+        uint32_t nSizeRx = 0;
+        pge_network::PgeNetworkConnectionHandle connHandleFrom = 0;
+        transport.advanceTime(999);
+        b &= assertFalse(transport.receive(0, Side::Server, pkt, nSizeRx, connHandleFrom), "receive too early");
+        transport.advanceTime(1);
+        b &= assertTrue(transport.receive(0, Side::Server, pkt, nSizeRx, connHandleFrom), "receive");
+        b &= assertEquals(nSize, nSizeRx, "size") & assertEquals(connHandle, connHandleFrom, "from");
+        b &= assertEquals(5u, pge_network::PgePacket::getServerSideConnectionHandle(pkt), "content");
+        b &= assertFalse(transport.receive(0, Side::Server, pkt, nSizeRx, connHandleFrom), "receive again");
+
+        pge_network::PgeLoopbackTransport::ConnEvent connEvent;
+        b &= assertTrue(transport.receiveConnEvent(0, Side::Server, connEvent), "conn event");
+        b &= assertTrue(connEvent.m_kind == pge_network::PgeLoopbackTransport::ConnEventKind::Connecting, "conn event kind");
+
+        return b & assertEquals(0u, transport.getInFlightCount(Side::Client), "in flight 2") &
+            assertEquals(0u, transport.getInFlightBytes(connHandle, Side::Client, true), "in flight bytes 2") &
+            assertEquals(1u, transport.getInFlightHighWaterMark(Side::Client), "high water mark") &
+            assertEquals(1u, transport.getDeliveredCount(), "delivered");
+    }
+
+    bool test_send_Reliable_KeepsOrderWithJitter()
+    {
+        using Side = pge_network::PgeLoopbackTransport::Side;
+        pge_network::PgeLoopbackTransport transport(makeLinkConfig(1000, 5000, 0.f, 0), 42);
+        transport.listen();
+        const pge_network::PgeNetworkConnectionHandle connHandle = transport.connect();
+
+        constexpr uint32_t nPktCount = 100;
+        bool b = true;
+        for (uint32_t i = 0; i < nPktCount; i++)
+        {
+            const pge_network::PgePacket pktSent = makePkt(i);
+            b &= assertTrue(
+                transport.send(connHandle, Side::Server, pktSent, pge_network::PgePacket::getPktActualSizeBytes(pktSent), pge_network::PgeSendLane::Reliable),
+                ("send " + std::to_string(i)).c_str());
+        }
+
+        transport.advanceTime(6000);
+        pge_network::PgePacket pkt;
+        uint32_t nSizeRx = 0;
+        pge_network::PgeNetworkConnectionHandle connHandleFrom = 0;
+        uint32_t nReceived = 0;
+        while (transport.receive(connHandle, Side::Client, pkt, nSizeRx, connHandleFrom))
+        {
+            b &= assertEquals(nReceived, pge_network::PgePacket::getServerSideConnectionHandle(pkt), ("order " + std::to_string(nReceived)).c_str());
+            nReceived++;
+        }
+
+        return b & assertEquals(nPktCount, nReceived, "received");
+    }
+
+    uint32_t getDeliveredUnreliableChecksum(const uint64_t& nSeed, const uint32_t& nPktCount)
+    {
+        using Side = pge_network::PgeLoopbackTransport::Side;
+        pge_network::PgeLoopbackTransport transport(makeLinkConfig(0, 0, 0.25f, 0), nSeed);
+        transport.listen();
+        const pge_network::PgeNetworkConnectionHandle connHandle = transport.connect();
+
+        uint32_t nDelivered = 0;
+        for (uint32_t i = 0; i < nPktCount; i++)
+        {
+            const pge_network::PgePacket pktSent = makePkt(i);
+            transport.send(connHandle, Side::Client, pktSent, pge_network::PgePacket::getPktActualSizeBytes(pktSent), pge_network::PgeSendLane::Unreliable);
+        }
+
+        pge_network::PgePacket pkt;
+        uint32_t nSizeRx = 0;
+        pge_network::PgeNetworkConnectionHandle connHandleFrom = 0;
+        uint32_t nChecksum = 0;
+        while (transport.receive(0, Side::Server, pkt, nSizeRx, connHandleFrom))
+        {
+            // order-sensitive checksum of the delivered packets, so the same seed must give exactly the same deliveries
+            nChecksum = nChecksum * 31u + pge_network::PgePacket::getServerSideConnectionHandle(pkt) + 1u;
+            nDelivered++;
+        }
+        return (transport.getLostCount() + nDelivered == nPktCount) ? nChecksum : 0;
+    }
+
+    bool test_send_Unreliable_Loss_IsDeterministic()
+    {
+        constexpr uint32_t nPktCount = 1000;
+        const uint32_t nChecksum1 = getDeliveredUnreliableChecksum(7, nPktCount);
+        const uint32_t nChecksum2 = getDeliveredUnreliableChecksum(7, nPktCount);
+        const uint32_t nChecksum3 = getDeliveredUnreliableChecksum(8, nPktCount);
+
+        using Side = pge_network::PgeLoopbackTransport::Side;
+        pge_network::PgeLoopbackTransport transport(makeLinkConfig(0, 0, 0.25f, 0), 7);
+        transport.listen();
+        const pge_network::PgeNetworkConnectionHandle connHandle = transport.connect();
+        for (uint32_t i = 0; i < nPktCount; i++)
+        {
+            const pge_network::PgePacket pktSent = makePkt(i);
+            transport.send(connHandle, Side::Client, pktSent, pge_network::PgePacket::getPktActualSizeBytes(pktSent),
+                (i % 2 == 0) ? pge_network::PgeSendLane::Reliable : pge_network::PgeSendLane::Unreliable);
+        }
+
+        return assertNotEquals(0u, nChecksum1, "checksum 1") &
+            assertEquals(nChecksum1, nChecksum2, "same seed") &
+            assertNotEquals(nChecksum1, nChecksum3, "different seed") &
+            assertLess(transport.getLostCount(), static_cast<uint64_t>(nPktCount / 2), "reliable never lost") &
+            assertGreater(transport.getLostCount(), static_cast<uint64_t>(nPktCount / 20), "unreliable lost");
+    }
+
+    bool test_send_Bandwidth()
+    {
+        using Side = pge_network::PgeLoopbackTransport::Side;
+        // 1 byte per millisecond
+        pge_network::PgeLoopbackTransport transport(makeLinkConfig(0, 0, 0.f, 1000), 1);
+        transport.listen();
+        const pge_network::PgeNetworkConnectionHandle connHandle = transport.connect();
+
+        const pge_network::PgePacket pktSent = makePkt(1);
+        constexpr uint32_t nSize = 100;
+        bool b = assertTrue(transport.send(connHandle, Side::Server, pktSent, nSize, pge_network::PgeSendLane::Unreliable), "send 1");
+        b &= assertTrue(transport.send(connHandle, Side::Server, pktSent, nSize, pge_network::PgeSendLane::Unreliable), "send 2");
+        b &= assertEquals(200000, transport.getQueueTimeUSecs(connHandle, Side::Server), "queue time");
+        b &= assertTrue(transport.send(connHandle, Side::Server, pktSent, nSize, pge_network::PgeSendLane::UnreliableNoDelay), "send no delay");
+        b &= assertEquals(1u, transport.getLostCount(), "no delay dropped on busy link");
+
+        pge_network::PgePacket pkt;
+        uint32_t nSizeRx = 0;
+        pge_network::PgeNetworkConnectionHandle connHandleFrom = 0;
+        transport.advanceTime(100000);
+        b &= assertTrue(transport.receive(connHandle, Side::Client, pkt, nSizeRx, connHandleFrom), "receive 1");
+        b &= assertFalse(transport.receive(connHandle, Side::Client, pkt, nSizeRx, connHandleFrom), "receive 2 too early");
+        transport.advanceTime(100000);
+        b &= assertTrue(transport.receive(connHandle, Side::Client, pkt, nSizeRx, connHandleFrom), "receive 2");
+
+        return b & assertEquals(0, transport.getQueueTimeUSecs(connHandle, Side::Server), "queue time empty");
+    }
+
+    bool test_close()
+    {
+        using Side = pge_network::PgeLoopbackTransport::Side;
+        pge_network::PgeLoopbackTransport transport(makeLinkConfig(1000, 0, 0.f, 0), 1);
+        transport.listen();
+        const pge_network::PgeNetworkConnectionHandle connHandle = transport.connect();
+
+        const pge_network::PgePacket pktSent = makePkt(1);
+        const uint32_t nSize = pge_network::PgePacket::getPktActualSizeBytes(pktSent);
+        bool b = assertTrue(transport.send(connHandle, Side::Client, pktSent, nSize, pge_network::PgeSendLane::Reliable), "send client");
+        b &= assertTrue(transport.send(connHandle, Side::Server, pktSent, nSize, pge_network::PgeSendLane::Reliable), "send server");
+        transport.close(connHandle, Side::Client);
+        b &= assertFalse(transport.isAttached(connHandle, Side::Client), "client detached");
+        b &= assertTrue(transport.isAttached(connHandle, Side::Server), "server attached");
+        b &= assertFalse(transport.send(connHandle, Side::Client, pktSent, nSize, pge_network::PgeSendLane::Reliable), "send after close");
+        b &= assertEquals(1u, transport.getInFlightCount(Side::Client), "in flight client");
+        b &= assertEquals(0u, transport.getInFlightCount(Side::Server), "in flight server discarded");
+
+        transport.advanceTime(1000);
+        pge_network::PgePacket pkt;
+        uint32_t nSizeRx = 0;
+        pge_network::PgeNetworkConnectionHandle connHandleFrom = 0;
+        b &= assertTrue(transport.receive(0, Side::Server, pkt, nSizeRx, connHandleFrom), "lingering pkt received");
+
+        pge_network::PgeLoopbackTransport::ConnEvent connEvent;
+        b &= assertTrue(transport.receiveConnEvent(0, Side::Server, connEvent), "conn event 1");
+        b &= assertTrue(connEvent.m_kind == pge_network::PgeLoopbackTransport::ConnEventKind::Connecting, "conn event kind 1");
+        b &= assertTrue(transport.receiveConnEvent(0, Side::Server, connEvent), "conn event 2");
+        b &= assertTrue(connEvent.m_kind == pge_network::PgeLoopbackTransport::ConnEventKind::Closed, "conn event kind 2");
+
+        return b & assertFalse(transport.isAttached(connHandle, Side::Server), "server detached");
+    }
+
+    bool test_server_client_connect()
+    {
+        Harness harness(makeLinkConfig(2000, 0, 0.f, 0));
+        bool b = startHarness(harness, 2, "v1", "v1");
+
+        b &= assertEquals(2u, harness.m_server.getClientCount(), "client count");
+        b &= assertEquals(3u, countAndDropPkts(harness.m_server, pge_network::MsgUserConnectedServerSelf::id), "user connected pkts");
+        for (const auto& pClient : harness.m_vClients)
+        {
+            b &= assertTrue(pClient->isAccepted(), "accepted");
+            b &= assertEquals(pClient->getConnectionHandle(), pClient->getConnectionHandleServerSide(), "conn handles");
+            b &= assertEquals(0u, pClient->getPacketQueueSize(), "client pkt queue");
+        }
+        return b;
+    }
+
+    bool test_server_client_connect_AppVersionMismatch()
+    {
+        Harness harness(makeLinkConfig(2000, 0, 0.f, 0));
+        bool b = startHarness(harness, 1, "v1", "v2");
+
+        b &= assertEquals(0u, harness.m_server.getClientCount(), "client count");
+        b &= assertEquals(1u, countAndDropPkts(harness.m_server, pge_network::MsgUserConnectedServerSelf::id), "only server connected");
+        b &= assertFalse(harness.m_vClients[0]->isConnected(), "client disconnected");
+        return b & assertEquals(1u, countAndDropPkts(*harness.m_vClients[0], pge_network::MsgUserDisconnectedFromServer::id), "client notified");
+    }
+
+    bool test_server_client_msgApp_batched()
+    {
+        Harness harness(makeLinkConfig(2000, 0, 0.f, 0));
+        bool b = startHarness(harness, 2, "", "");
+        countAndDropPkts(harness.m_server, pge_network::PgePktId::Application);
+
+        pge_network::PgeLoopbackClient& client0 = *harness.m_vClients[0];
+        const uint32_t nTxPktCountClient = client0.getTxPacketCount();
+        client0.send(makePktMsgApp(nMsgIdEvent, 10));
+        client0.send(makePktMsgApp(nMsgIdEvent, 11));
+        client0.flushBatchedPackets();
+        b &= assertEquals(nTxPktCountClient + 1, client0.getTxPacketCount(), "client batched 2 msgs into 1 pkt");
+
+        harness.m_server.sendToAllClientsExcept(makePktMsgApp(nMsgIdEvent, 20), client0.getConnectionHandleServerSide());
+        harness.m_server.sendToAll(makePktMsgApp(nMsgIdEvent, 21));
+        b &= assertEquals(1u, harness.m_server.getPacketQueueSize(), "server pkt queue 1");
+        pump(harness, 1, 2000);
+
+        b &= assertEquals(3u, harness.m_server.getPacketQueueSize(), "server pkt queue 2");
+        if (b)
+        {
+            b &= assertEquals(21u, getMsgAppValue(harness.m_server.borrowFrontPacket()), "server injected");
+            harness.m_server.releaseFrontPacket();
+            const pge_network::PgePacket& pkt = harness.m_server.borrowFrontPacket();
+            b &= assertEquals(10u, getMsgAppValue(pkt), "server rx 1");
+            b &= assertEquals(client0.getConnectionHandleServerSide(), pge_network::PgePacket::getServerSideConnectionHandle(pkt), "server rx conn");
+            harness.m_server.releaseFrontPacket();
+            b &= assertEquals(11u, getMsgAppValue(harness.m_server.borrowFrontPacket()), "server rx 2");
+            harness.m_server.releaseFrontPacket();
+        }
+
+        // server flushed its batches in the previous step
+        pump(harness, 1, 2000);
+        b &= assertEquals(1u, client0.getPacketQueueSize(), "client 0 pkt queue");
+        b &= assertEquals(2u, harness.m_vClients[1]->getPacketQueueSize(), "client 1 pkt queue");
+        if (b)
+        {
+            b &= assertEquals(20u, getMsgAppValue(harness.m_vClients[1]->borrowFrontPacket()), "client 1 rx 1");
+            harness.m_vClients[1]->releaseFrontPacket();
+            b &= assertEquals(21u, getMsgAppValue(harness.m_vClients[1]->borrowFrontPacket()), "client 1 rx 2");
+            harness.m_vClients[1]->releaseFrontPacket();
+        }
+        return b;
+    }
+
+    bool test_server_disconnect()
+    {
+        Harness harness(makeLinkConfig(2000, 0, 0.f, 0));
+        bool b = startHarness(harness, 3, "", "");
+        countAndDropPkts(harness.m_server, pge_network::PgePktId::Application);
+
+        harness.m_server.disconnect("test");
+        b &= assertFalse(harness.m_server.isListening(), "listening");
+        b &= assertEquals(0u, harness.m_server.getClientCount(), "client count");
+        b &= assertEquals(1u, countAndDropPkts(harness.m_server, pge_network::MsgUserDisconnectedFromServer::id), "server self");
+
+        pump(harness, 2, 2000);
+        for (const auto& pClient : harness.m_vClients)
+        {
+            b &= assertFalse(pClient->isConnected(), "client connected");
+            // 1 for the server, 2 for the other clients, 1 injected upon connection closed
+            b &= assertEquals(4u, countAndDropPkts(*pClient, pge_network::MsgUserDisconnectedFromServer::id), "client notified");
+        }
+        return b;
+    }
+
+    bool runServerTickBenchmark(const size_t& nClients, const uint32_t& nTicks)
+    {
+        constexpr pge_network::PgeLoopbackTransport::TTimeUSecs nTickUSecs = 16667;
+        Harness harness(makeLinkConfig(25000, 5000, 0.f, 0), nClients);
+        bool b = startHarness(harness, nClients, "", "");
+        b &= assertEquals(nClients, harness.m_server.getClientCount(), "client count");
+        if (!b)
+        {
+            return false;
+        }
+        countAndDropPkts(harness.m_server, pge_network::PgePktId::Application);
+        harness.m_transport.resetCounters();
+
+        uint32_t nServerRxMsgCount = 0;
+        uint32_t nClientRxMsgCount = 0;
+        std::chrono::steady_clock::duration durServer{};
+        for (uint32_t iTick = 0; iTick < nTicks; iTick++)
+        {
+            harness.m_transport.advanceTime(nTickUSecs);
+            for (auto& pClient : harness.m_vClients)
+            {
+                pClient->Update();
+                while (pClient->getPacketQueueSize() > 0)
+                {
+                    nClientRxMsgCount++;
+                    pClient->releaseFrontPacket();
+                }
+                pClient->send(makePktMsgApp(nMsgIdInput, iTick));
+                pClient->flushBatchedPackets();
+            }
+
+            // server tick: receive inputs, then send each client its own update and broadcast an event
+            const auto timeStart = std::chrono::steady_clock::now();
+            harness.m_server.Update();
+            while (harness.m_server.getPacketQueueSize() > 0)
+            {
+                nServerRxMsgCount++;
+                harness.m_server.releaseFrontPacket();
+            }
+            for (const auto& pClient : harness.m_vClients)
+            {
+                harness.m_server.send(makePktMsgApp(nMsgIdUpdate, iTick), pClient->getConnectionHandleServerSide());
+            }
+            harness.m_server.sendToAllClientsExcept(makePktMsgApp(nMsgIdEvent, iTick));
+            harness.m_server.flushBatchedPackets();
+            durServer += std::chrono::steady_clock::now() - timeStart;
+        }
+
+        const auto nServerUSecs = std::chrono::duration_cast<std::chrono::microseconds>(durServer).count();
+        CConsole::getConsoleInstance().OLn(
+            "PgeLoopbackTransportTest::%s(): %u clients, %u ticks: avg server tick: %.2f us, server rx msgs: %u, client rx msgs: %u, "
+            "server queue high water mark: %u, in flight high water mark: %u to server, %u to clients",
+            __func__,
+            static_cast<unsigned>(nClients),
+            nTicks,
+            static_cast<double>(nServerUSecs) / nTicks,
+            nServerRxMsgCount,
+            nClientRxMsgCount,
+            static_cast<unsigned>(harness.m_server.getPacketQueueHighWaterMark()),
+            static_cast<unsigned>(harness.m_transport.getInFlightHighWaterMark(pge_network::PgeLoopbackTransport::Side::Client)),
+            static_cast<unsigned>(harness.m_transport.getInFlightHighWaterMark(pge_network::PgeLoopbackTransport::Side::Server)));
+
+        // with 25-30 ms latency, messages of the last 2 ticks might be still in flight
+        b &= assertGreater(nServerRxMsgCount, static_cast<uint32_t>(nClients * (nTicks - 3)), "server rx msgs");
+        b &= assertGreater(nClientRxMsgCount, static_cast<uint32_t>(2 * nClients * (nTicks - 3)), "client rx msgs");
+        b &= assertEquals(0u, harness.m_server.getPacketQueueDroppedCount(), "server queue dropped");
+        return b & assertEquals(0u, harness.m_transport.getLostCount(), "lost");
+    }
+
+    bool test_benchmark_serverTick()
+    {
+        constexpr uint32_t nTicks = 300;
+        return runServerTickBenchmark(8, nTicks) &
+            runServerTickBenchmark(32, nTicks) &
+            runServerTickBenchmark(128, nTicks);
+    }
+
+}; // class PgeLoopbackTransportTest
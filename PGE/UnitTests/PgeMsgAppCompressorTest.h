@@ -0,0 +1,514 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeMsgAppCompressorTest.h
+    Unit test for PgeMsgAppCompressor.
+    Made by PR00F88, West Whiskhyll Entertainment
+    2026
+    ###################################################################################
+*/
+
+#include "UnitTest.h"  // PCH
+
+#include "../Network/PgeLoopbackClient.h"
+#include "../Network/PgeLoopbackServer.h"
+#include "../Network/PgeLoopbackTransport.h"
+#include "../Network/PgeMsgAppCompressor.h"
+
+#include <stdexcept>
+#include <vector>
+
+class PgeMsgAppCompressorTest :
+    public UnitTest
+{
+public:
+
+    PgeMsgAppCompressorTest() :
+        UnitTest(__FILE__)
+    {
+    }
+
+protected:
+
+    virtual void initialize() override
+    {
+        addSubTest("test_ctor", (PFNUNITSUBTEST)&PgeMsgAppCompressorTest::test_ctor);
+        addSubTest("test_setDictionary", (PFNUNITSUBTEST)&PgeMsgAppCompressorTest::test_setDictionary);
+        addSubTest("test_block_RoundTrip", (PFNUNITSUBTEST)&PgeMsgAppCompressorTest::test_block_RoundTrip);
+        addSubTest("test_block_UsesDictionary", (PFNUNITSUBTEST)&PgeMsgAppCompressorTest::test_block_UsesDictionary);
+        addSubTest("test_block_DstTooSmall", (PFNUNITSUBTEST)&PgeMsgAppCompressorTest::test_block_DstTooSmall);
+        addSubTest("test_decompressBlock_Malformed", (PFNUNITSUBTEST)&PgeMsgAppCompressorTest::test_decompressBlock_Malformed);
+        addSubTest("test_compressPkt_NotEnabled", (PFNUNITSUBTEST)&PgeMsgAppCompressorTest::test_compressPkt_NotEnabled);
+        addSubTest("test_compressPkt_Bypass", (PFNUNITSUBTEST)&PgeMsgAppCompressorTest::test_compressPkt_Bypass);
+        addSubTest("test_compressPkt_decompressMsgApp", (PFNUNITSUBTEST)&PgeMsgAppCompressorTest::test_compressPkt_decompressMsgApp);
+        addSubTest("test_decompressMsgApp_Malformed", (PFNUNITSUBTEST)&PgeMsgAppCompressorTest::test_decompressMsgApp_Malformed);
+        addSubTest("test_trainDictionary", (PFNUNITSUBTEST)&PgeMsgAppCompressorTest::test_trainDictionary);
+        addSubTest("test_exportCsv", (PFNUNITSUBTEST)&PgeMsgAppCompressorTest::test_exportCsv);
+        addSubTest("test_loopback_Compressed", (PFNUNITSUBTEST)&PgeMsgAppCompressorTest::test_loopback_Compressed);
+    }
+
+private:
+
+    static constexpr pge_network::MsgApp::TMsgId nMsgIdScoreboard = 1u;
+    static constexpr pge_network::MsgApp::TMsgId nMsgIdInput = 2u;
+
+    // ---------------------------------------------------------------------------
+
+    PgeMsgAppCompressorTest(const PgeMsgAppCompressorTest&)
+    {};
+
+    PgeMsgAppCompressorTest& operator=(const PgeMsgAppCompressorTest&)
+    {
+        return *this;
+    };
+
+    static uint64_t nextRandom(uint64_t& nState)
+    {
+        // splitmix64, same as PgeLoopbackTransport uses
+        uint64_t z = (nState += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    static std::vector<pge_network::TByte> makeRandomData(const std::size_t& nSize, uint64_t nSeed)
+    {
+        std::vector<pge_network::TByte> vData(nSize);
+        for (auto& byte : vData)
+        {
+            byte = static_cast<pge_network::TByte>(nextRandom(nSeed));
+        }
+        return vData;
+    }
+
+    /**
+        Scoreboard-like data: fixed size rows of a zero-padded name, and small integers.
+    */
+    static std::vector<pge_network::TByte> makeScoreboardData(const uint32_t& nRowCount, const uint32_t& nSalt)
+    {
+        std::vector<pge_network::TByte> vData;
+        for (uint32_t iRow = 0; iRow < nRowCount; iRow++)
+        {
+            const std::string sName = "Player" + std::to_string(iRow);
+            for (std::size_t i = 0; i < 16; i++)
+            {
+                vData.push_back(i < sName.size() ? static_cast<pge_network::TByte>(sName[i]) : 0);
+            }
+            const uint32_t nFrags = (iRow * 7 + nSalt) % 50;
+            const uint32_t nDeaths = (iRow * 3 + nSalt) % 20;
+            for (const uint32_t nValue : { nFrags, nDeaths })
+            {
+                for (std::size_t i = 0; i < sizeof(nValue); i++)
+                {
+                    vData.push_back(static_cast<pge_network::TByte>(nValue >> (8 * i)));
+                }
+            }
+        }
+        return vData;
+    }
+
+    static void addMsgApp(pge_network::PgePacket& pkt, const pge_network::MsgApp::TMsgId& msgAppId, const std::vector<pge_network::TByte>& vData)
+    {
+        pge_network::MsgApp msgApp;
+        pge_network::MsgApp::fillMsgApp(msgApp, msgAppId, vData.data(), static_cast<pge_network::MsgApp::TMsgSize>(vData.size()));
+        pge_network::PgePacket::addPktMsgApp(pkt, msgApp);
+    }
+
+    static pge_network::PgePacket makePktMsgApp(const pge_network::MsgApp::TMsgId& msgAppId, const std::vector<pge_network::TByte>& vData)
+    {
+        pge_network::PgePacket pkt;
+        pge_network::PgePacket::initPktMsgApp(pkt, pge_network::ServerConnHandle, pge_network::PgePacket::AutoFill::NONE);
+        addMsgApp(pkt, msgAppId, vData);
+        return pkt;
+    }
+
+    static std::vector<pge_network::TByte> getMsgAppData(const pge_network::MsgApp& msgApp)
+    {
+        const pge_network::TByte* const pData = pge_network::MsgApp::getMsgAppData(msgApp);
+        return std::vector<pge_network::TByte>(pData, pData + pge_network::MsgApp::getMsgAppDataActualSizeBytes(msgApp));
+    }
+
+    std::size_t getCompressedSize(pge_network::PgeMsgAppCompressor& compressor, const std::vector<pge_network::TByte>& vData)
+    {
+        std::vector<pge_network::TByte> vCompressed(vData.size() * 2 + 16);
+        return compressor.compressBlock(vData.data(), vData.size(), vCompressed.data(), vCompressed.size());
+    }
+
+    bool roundTrip(pge_network::PgeMsgAppCompressor& compressor, const std::vector<pge_network::TByte>& vData, const std::string& sName)
+    {
+        std::vector<pge_network::TByte> vCompressed(vData.size() * 2 + 16);
+        const std::size_t nCompressedSize = compressor.compressBlock(vData.data(), vData.size(), vCompressed.data(), vCompressed.size());
+        std::vector<pge_network::TByte> vDecompressed(vData.size());
+        return assertLess(0u, nCompressedSize, (sName + " compress").c_str()) &
+            assertTrue(compressor.decompressBlock(vCompressed.data(), nCompressedSize, vDecompressed.data(), vDecompressed.size()), (sName + " decompress").c_str()) &
+            assertTrue(vData == vDecompressed, (sName + " data").c_str());
+    }
+
+    bool test_ctor()
+    {
+        pge_network::PgeMsgAppCompressor compressor;
+
+        return assertTrue(compressor.getDictionary() == pge_network::PgeMsgAppCompressor::getDefaultDictionary(), "dictionary") &
+            assertFalse(compressor.getDictionary().empty(), "default dictionary") &
+            assertTrue(compressor.getCompressedAppMessages().empty(), "compressed app messages") &
+            assertTrue(compressor.getStats().empty(), "stats");
+    }
+
+    bool test_setDictionary()
+    {
+        pge_network::PgeMsgAppCompressor compressor;
+
+        compressor.setDictionary({});
+        bool b = assertTrue(compressor.getDictionary().empty(), "empty");
+
+        const std::vector<pge_network::TByte> vDictionary = makeRandomData(pge_network::PgeMsgAppCompressor::nMaxDictionarySizeBytes, 1);
+        compressor.setDictionary(vDictionary);
+        b &= assertTrue(vDictionary == compressor.getDictionary(), "max size");
+
+        try
+        {
+            compressor.setDictionary(makeRandomData(pge_network::PgeMsgAppCompressor::nMaxDictionarySizeBytes + 1, 1));
+            b &= assertTrue(false, "no exception");
+        }
+        catch (const std::exception&)
+        {
+            b &= assertTrue(vDictionary == compressor.getDictionary(), "kept on exception");
+        }
+        return b;
+    }
+
+    bool test_block_RoundTrip()
+    {
+        pge_network::PgeMsgAppCompressor compressor;
+        bool b = true;
+
+        // same inputs with and without dictionary
+        for (int iDictionary = 0; iDictionary < 2; iDictionary++)
+        {
+            if (iDictionary == 1)
+            {
+                compressor.setDictionary({});
+            }
+            const std::string sPrefix = (iDictionary == 0) ? "dict " : "no dict ";
+            b &= roundTrip(compressor, {}, sPrefix + "empty");
+            b &= roundTrip(compressor, { 42 }, sPrefix + "1 byte");
+            b &= roundTrip(compressor, std::vector<pge_network::TByte>(240, 0), sPrefix + "zeros");
+            b &= roundTrip(compressor, makeRandomData(240, 3), sPrefix + "random");
+            b &= roundTrip(compressor, makeScoreboardData(8, 1), sPrefix + "scoreboard");
+            // long literal and match runs need length extension bytes, big data needs growing the window
+            std::vector<pge_network::TByte> vLong = makeRandomData(1000, 4);
+            vLong.resize(6000, 7);
+            const std::vector<pge_network::TByte> vRandom = makeRandomData(1000, 4);
+            vLong.insert(vLong.end(), vRandom.begin(), vRandom.end());
+            b &= roundTrip(compressor, vLong, sPrefix + "long");
+        }
+
+        b &= assertLess(getCompressedSize(compressor, std::vector<pge_network::TByte>(240, 0)), static_cast<std::size_t>(10), "zeros ratio");
+        b &= assertLess(static_cast<std::size_t>(240), getCompressedSize(compressor, makeRandomData(240, 3)), "random expands");
+        return b;
+    }
+
+    bool test_block_UsesDictionary()
+    {
+        const std::vector<pge_network::TByte> vDictionary = makeScoreboardData(8, 1);
+        const std::vector<pge_network::TByte> vData(vDictionary.begin() + 24, vDictionary.begin() + 72);
+
+        pge_network::PgeMsgAppCompressor compressor;
+        compressor.setDictionary({});
+        const std::size_t nSizeNoDictionary = getCompressedSize(compressor, vData);
+        compressor.setDictionary(vDictionary);
+        const std::size_t nSizeDictionary = getCompressedSize(compressor, vData);
+
+        return assertLess(nSizeDictionary, nSizeNoDictionary, "smaller with dictionary") &
+            assertLess(nSizeDictionary, vData.size() / 4, "mostly from dictionary") &
+            roundTrip(compressor, vData, "dictionary");
+    }
+
+    bool test_block_DstTooSmall()
+    {
+        pge_network::PgeMsgAppCompressor compressor;
+        const std::vector<pge_network::TByte> vData = makeScoreboardData(4, 1);
+        const std::size_t nSize = getCompressedSize(compressor, vData);
+
+        std::vector<pge_network::TByte> vCompressed(nSize);
+        return assertLess(0u, nSize, "size") &
+            assertEquals(nSize, compressor.compressBlock(vData.data(), vData.size(), vCompressed.data(), nSize), "exact fit") &
+            assertEquals(0u, compressor.compressBlock(vData.data(), vData.size(), vCompressed.data(), nSize - 1), "too small") &
+            assertEquals(0u, compressor.compressBlock(vData.data(), vData.size(), vCompressed.data(), 0), "zero");
+    }
+
+    bool test_decompressBlock_Malformed()
+    {
+        pge_network::PgeMsgAppCompressor compressor;
+        const std::vector<pge_network::TByte> vData = makeScoreboardData(4, 1);
+        std::vector<pge_network::TByte> vCompressed(vData.size() * 2);
+        const std::size_t nSize = compressor.compressBlock(vData.data(), vData.size(), vCompressed.data(), vCompressed.size());
+        std::vector<pge_network::TByte> vDecompressed(vData.size() + 1);
+
+        bool b = assertTrue(compressor.decompressBlock(vCompressed.data(), nSize, vDecompressed.data(), vData.size()), "valid");
+        b &= assertFalse(compressor.decompressBlock(vCompressed.data(), nSize, vDecompressed.data(), vData.size() - 1), "expected size smaller");
+        b &= assertFalse(compressor.decompressBlock(vCompressed.data(), nSize, vDecompressed.data(), vData.size() + 1), "expected size bigger");
+        b &= assertFalse(compressor.decompressBlock(vCompressed.data(), nSize - 1, vDecompressed.data(), vData.size()), "truncated");
+
+        // 4 literals then back-reference beyond the start of dictionary
+        const std::size_t nTooBigOffset = compressor.getDictionary().size() + 5;
+        const pge_network::TByte invalidOffset[] = {
+            0x40, 1, 2, 3, 4, static_cast<pge_network::TByte>(nTooBigOffset & 0xFF), static_cast<pge_network::TByte>(nTooBigOffset >> 8) };
+        b &= assertFalse(compressor.decompressBlock(invalidOffset, sizeof(invalidOffset), vDecompressed.data(), 8), "offset too big");
+        const pge_network::TByte zeroOffset[] = { 0x40, 1, 2, 3, 4, 0, 0 };
+        b &= assertFalse(compressor.decompressBlock(zeroOffset, sizeof(zeroOffset), vDecompressed.data(), 8), "offset zero");
+
+        // garbage must never be read or written out of bounds
+        for (uint64_t nSeed = 1; nSeed <= 200; nSeed++)
+        {
+            const std::vector<pge_network::TByte> vGarbage = makeRandomData(1 + nSeed % 64, nSeed);
+            compressor.decompressBlock(vGarbage.data(), vGarbage.size(), vDecompressed.data(), vDecompressed.size());
+        }
+        return b;
+    }
+
+    bool test_compressPkt_NotEnabled()
+    {
+        pge_network::PgeMsgAppCompressor compressor;
+        pge_network::PgePacket pktCompressed;
+
+        bool b = assertFalse(compressor.compressPkt(makePktMsgApp(nMsgIdScoreboard, makeScoreboardData(4, 1)), pktCompressed), "none enabled");
+
+        compressor.getCompressedAppMessages().insert(nMsgIdScoreboard);
+        b &= assertFalse(compressor.compressPkt(makePktMsgApp(nMsgIdInput, makeScoreboardData(4, 1)), pktCompressed), "other enabled");
+
+        pge_network::PgePacket pktNonApp;
+        pge_network::PgePacket::initPktPgeMsgUserDisconnected(pktNonApp, 1);
+        b &= assertFalse(compressor.compressPkt(pktNonApp, pktCompressed), "non-app pkt");
+
+        return b & assertTrue(compressor.getStats().empty(), "stats");
+    }
+
+    bool test_compressPkt_Bypass()
+    {
+        pge_network::PgeMsgAppCompressor compressor;
+        compressor.getCompressedAppMessages().insert(nMsgIdInput);
+        pge_network::PgePacket pktCompressed;
+
+        bool b = assertFalse(compressor.compressPkt(makePktMsgApp(nMsgIdInput, makeRandomData(16, 5)), pktCompressed), "random");
+        b &= assertFalse(compressor.compressPkt(makePktMsgApp(nMsgIdInput, { 0, 0 }), pktCompressed), "tiny");
+
+        const auto it = compressor.getStats().find(nMsgIdInput);
+        b &= assertTrue(it != compressor.getStats().end(), "stats");
+        if (b)
+        {
+            b &= assertEquals(2u, it->second.m_nTxCount, "tx count") &
+                assertEquals(0u, it->second.m_nTxCompressedCount, "tx compressed count") &
+                assertEquals(18u, it->second.m_nTxRawBytes, "tx raw bytes") &
+                assertEquals(18u, it->second.m_nTxWireBytes, "tx wire bytes") &
+                assertEquals(1.f, it->second.getTxRatio(), "tx ratio");
+        }
+        return b;
+    }
+
+    bool test_compressPkt_decompressMsgApp()
+    {
+        pge_network::PgeMsgAppCompressor compressor;
+        compressor.getCompressedAppMessages().insert(nMsgIdScoreboard);
+
+        const std::vector<pge_network::TByte> vScoreboard = makeScoreboardData(5, 2);
+        const std::vector<pge_network::TByte> vInput = { 1, 2, 3, 4 };
+        pge_network::PgePacket pkt = makePktMsgApp(nMsgIdInput, vInput);
+        addMsgApp(pkt, nMsgIdScoreboard, vScoreboard);
+        addMsgApp(pkt, nMsgIdInput, vInput);
+        pge_network::PgePacket::getServerSideConnectionHandle(pkt) = 3;
+
+        pge_network::PgePacket pktCompressed;
+        bool b = assertTrue(compressor.compressPkt(pkt, pktCompressed), "compressed");
+        b &= assertEquals(3u, static_cast<uint32_t>(pge_network::PgePacket::getMessageAppCount(static_cast<const pge_network::PgePacket&>(pktCompressed))), "msg count");
+        b &= assertEquals(3u, pge_network::PgePacket::getServerSideConnectionHandle(pktCompressed), "conn handle");
+        b &= assertLess(pge_network::PgePacket::getPktActualSizeBytes(pktCompressed), pge_network::PgePacket::getPktActualSizeBytes(pkt), "pkt size");
+        b &= assertTrue(pge_network::PgeMsgAppCompressor::hasCompressedMsgApp(pktCompressed), "has compressed");
+        b &= assertFalse(pge_network::PgeMsgAppCompressor::hasCompressedMsgApp(pkt), "original has no compressed");
+        if (!b)
+        {
+            return false;
+        }
+
+        // order kept, only the enabled one compressed
+        pge_network::PgeMsgAppCompressor decompressor;
+        pge_network::MsgApp msgAppDecompressed;
+        const pge_network::MsgApp* pMsgApp = pge_network::PgePacket::getMsgAppFromPkt(pktCompressed);
+        b &= assertFalse(pge_network::PgeMsgAppCompressor::isMsgAppCompressed(*pMsgApp), "msg 1 not compressed");
+        b &= assertTrue(pMsgApp == decompressor.decompressMsgApp(*pMsgApp, msgAppDecompressed), "msg 1 as is");
+
+        pMsgApp = pge_network::PgePacket::getNextMsgAppFromPkt(pktCompressed, *pMsgApp);
+        b &= assertTrue(pge_network::PgeMsgAppCompressor::isMsgAppCompressed(*pMsgApp), "msg 2 compressed");
+        b &= assertEquals(
+            static_cast<uint32_t>(nMsgIdScoreboard | pge_network::PgeMsgAppCompressor::nCompressedMsgIdFlag),
+            static_cast<uint32_t>(pge_network::MsgApp::getMsgAppMsgId(*pMsgApp)), "msg 2 wire id");
+        const uint32_t nWireSize = pge_network::MsgApp::getMsgAppDataActualSizeBytes(*pMsgApp);
+        const pge_network::MsgApp* const pMsgAppDecompressed = decompressor.decompressMsgApp(*pMsgApp, msgAppDecompressed);
+        if (!assertTrue(pMsgAppDecompressed == &msgAppDecompressed, "msg 2 decompressed"))
+        {
+            return false;
+        }
+        b &= assertEquals(static_cast<uint32_t>(nMsgIdScoreboard), static_cast<uint32_t>(pge_network::MsgApp::getMsgAppMsgId(*pMsgAppDecompressed)), "msg 2 id");
+        b &= assertTrue(vScoreboard == getMsgAppData(*pMsgAppDecompressed), "msg 2 data");
+
+        pMsgApp = pge_network::PgePacket::getNextMsgAppFromPkt(pktCompressed, *pMsgApp);
+        b &= assertEquals(static_cast<uint32_t>(nMsgIdInput), static_cast<uint32_t>(pge_network::MsgApp::getMsgAppMsgId(*pMsgApp)), "msg 3 id");
+        b &= assertTrue(vInput == getMsgAppData(*pMsgApp), "msg 3 data");
+
+        const pge_network::PgeMsgAppCompressor::MsgAppStats& txStats = compressor.getStats().at(nMsgIdScoreboard);
+        const pge_network::PgeMsgAppCompressor::MsgAppStats& rxStats = decompressor.getStats().at(nMsgIdScoreboard);
+        return b & assertEquals(1u, compressor.getStats().size(), "tx stats size") &
+            assertEquals(1u, txStats.m_nTxCount, "tx count") &
+            assertEquals(1u, txStats.m_nTxCompressedCount, "tx compressed count") &
+            assertEquals(static_cast<uint64_t>(vScoreboard.size()), txStats.m_nTxRawBytes, "tx raw bytes") &
+            assertEquals(static_cast<uint64_t>(nWireSize), txStats.m_nTxWireBytes, "tx wire bytes") &
+            assertLess(txStats.getTxRatio(), 0.8f, "tx ratio") &
+            assertEquals(1u, decompressor.getStats().size(), "rx stats size") &
+            assertEquals(1u, rxStats.m_nRxCount, "rx count") &
+            assertEquals(0u, rxStats.m_nRxFailedCount, "rx failed count") &
+            assertEquals(static_cast<uint64_t>(vScoreboard.size()), rxStats.m_nRxRawBytes, "rx raw bytes") &
+            assertEquals(static_cast<uint64_t>(nWireSize), rxStats.m_nRxWireBytes, "rx wire bytes");
+    }
+
+    bool test_decompressMsgApp_Malformed()
+    {
+        pge_network::PgeMsgAppCompressor compressor;
+        pge_network::MsgApp msgApp;
+        pge_network::MsgApp msgAppDecompressed;
+        const pge_network::MsgApp::TMsgId msgAppIdWire = nMsgIdInput | pge_network::PgeMsgAppCompressor::nCompressedMsgIdFlag;
+
+        pge_network::MsgApp::fillMsgApp(msgApp, msgAppIdWire, nullptr, 0);
+        bool b = assertNull(compressor.decompressMsgApp(msgApp, msgAppDecompressed), "empty");
+
+        const pge_network::TByte tooBig[] = { pge_network::MsgApp::nMaxMessageLengthBytes + 1, 0 };
+        pge_network::MsgApp::fillMsgApp(msgApp, msgAppIdWire, tooBig, sizeof(tooBig));
+        b &= assertNull(compressor.decompressMsgApp(msgApp, msgAppDecompressed), "too big");
+
+        const pge_network::TByte sizeMismatch[] = { 5, 0x30, 1, 2, 3 };
+        pge_network::MsgApp::fillMsgApp(msgApp, msgAppIdWire, sizeMismatch, sizeof(sizeMismatch));
+        b &= assertNull(compressor.decompressMsgApp(msgApp, msgAppDecompressed), "size mismatch");
+
+        const auto it = compressor.getStats().find(nMsgIdInput);
+        b &= assertTrue(it != compressor.getStats().end(), "stats");
+        return b && (assertEquals(3u, it->second.m_nRxFailedCount, "rx failed count") & assertEquals(0u, it->second.m_nRxCount, "rx count"));
+    }
+
+    bool test_trainDictionary()
+    {
+        std::vector<std::vector<pge_network::TByte>> vSamples;
+        for (uint32_t i = 0; i < 20; i++)
+        {
+            vSamples.push_back(makeScoreboardData(4 + i % 4, i));
+        }
+
+        const std::vector<pge_network::TByte> vDictionary = pge_network::PgeMsgAppCompressor::trainDictionary(vSamples, 256);
+        bool b = assertFalse(vDictionary.empty(), "not empty");
+        b &= assertLequals(vDictionary.size(), static_cast<std::size_t>(256), "size");
+        b &= assertTrue(vDictionary == pge_network::PgeMsgAppCompressor::trainDictionary(vSamples, 256), "deterministic");
+        b &= assertTrue(pge_network::PgeMsgAppCompressor::trainDictionary({ makeRandomData(100, 1) }, 256).empty(), "single sample");
+
+        // trained on other salts than the test data
+        const std::vector<pge_network::TByte> vData = makeScoreboardData(6, 100);
+        pge_network::PgeMsgAppCompressor compressor;
+        const std::size_t nSizeDefault = getCompressedSize(compressor, vData);
+        compressor.setDictionary(vDictionary);
+        const std::size_t nSizeTrained = getCompressedSize(compressor, vData);
+        b &= assertLess(nSizeTrained, nSizeDefault, "trained better than default");
+        b &= roundTrip(compressor, vData, "trained");
+
+        for (const std::size_t nInvalidSize : { static_cast<std::size_t>(0), pge_network::PgeMsgAppCompressor::nMaxDictionarySizeBytes + 1 })
+        {
+            try
+            {
+                pge_network::PgeMsgAppCompressor::trainDictionary(vSamples, nInvalidSize);
+                b &= assertTrue(false, ("no exception " + std::to_string(nInvalidSize)).c_str());
+            }
+            catch (const std::exception&)
+            {
+            }
+        }
+        return b;
+    }
+
+    bool test_exportCsv()
+    {
+        pge_network::PgeMsgAppCompressor compressor;
+        compressor.getCompressedAppMessages().insert(nMsgIdScoreboard);
+        pge_network::PgePacket pktCompressed;
+        compressor.compressPkt(makePktMsgApp(nMsgIdScoreboard, std::vector<pge_network::TByte>(100, 0)), pktCompressed);
+
+        const std::string sCsv = compressor.exportCsv({ { nMsgIdScoreboard, "Scoreboard" } });
+        bool b = assertEquals(0u, sCsv.find("id,name,tx_count,tx_compressed_count,tx_raw_bytes,tx_wire_bytes,tx_ratio,tx_avg_ns,"), "header");
+        b &= assertNotEquals(std::string::npos, sCsv.find("\n1,\"Scoreboard\",1,1,100,"), "line");
+
+        compressor.clearStats();
+        return b & assertTrue(compressor.getStats().empty(), "cleared");
+    }
+
+    bool test_loopback_Compressed()
+    {
+        pge_network::PgeLoopbackTransport::LinkConfig linkConfig;
+        linkConfig.m_nLatencyUSecs = 1000;
+        pge_network::PgeLoopbackTransport transport(linkConfig, 1);
+        pge_network::PgeLoopbackServer server(transport);
+        pge_network::PgeLoopbackClient client(transport);
+
+        bool b = assertTrue(server.initialize(), "server init") & assertTrue(client.initialize(), "client init");
+        server.getAllowListedAppMessages().insert(nMsgIdInput);
+        client.getAllowListedAppMessages().insert(nMsgIdScoreboard);
+        client.getAllowListedAppMessages().insert(nMsgIdInput);
+        server.getMsgAppCompressor().getCompressedAppMessages().insert(nMsgIdScoreboard);
+        b &= assertTrue(server.startListening(""), "listen") & assertTrue(client.connectToServer("127.0.0.1", ""), "connect");
+        for (int i = 0; i < 4; i++)
+        {
+            transport.advanceTime(linkConfig.m_nLatencyUSecs + 1);
+            server.Update();
+            server.flushBatchedPackets();
+            client.Update();
+            client.flushBatchedPackets();
+        }
+        b &= assertTrue(client.isConnected(), "connected");
+        while (client.getPacketQueueSize() > 0)
+        {
+            client.releaseFrontPacket();
+        }
+        if (!b)
+        {
+            return false;
+        }
+
+        const std::vector<pge_network::TByte> vScoreboard = makeScoreboardData(8, 3);
+        const std::vector<pge_network::TByte> vInput = makeRandomData(8, 2);
+        const uint32_t nTxByteCount = server.getTxByteCount();
+        server.send(makePktMsgApp(nMsgIdScoreboard, vScoreboard), client.getConnectionHandleServerSide());
+        server.send(makePktMsgApp(nMsgIdInput, vInput), client.getConnectionHandleServerSide());
+        server.flushBatchedPackets();
+        const uint32_t nPktHeaderSize = pge_network::PgePacket::getPktActualSizeBytes(makePktMsgApp(nMsgIdInput, {}));
+        b &= assertLess(server.getTxByteCount() - nTxByteCount, static_cast<uint32_t>(nPktHeaderSize + vScoreboard.size() + vInput.size()), "tx bytes");
+
+        transport.advanceTime(linkConfig.m_nLatencyUSecs + 1);
+        client.Update();
+        b &= assertEquals(2u, client.getPacketQueueSize(), "client pkt queue");
+        if (!b)
+        {
+            return false;
+        }
+        const pge_network::PgePacket& pkt1 = client.borrowFrontPacket();
+        b &= assertEquals(static_cast<uint32_t>(nMsgIdScoreboard), static_cast<uint32_t>(pge_network::MsgApp::getMsgAppMsgId(*pge_network::PgePacket::getMsgAppFromPkt(pkt1))), "rx 1 id");
+        b &= assertTrue(vScoreboard == getMsgAppData(*pge_network::PgePacket::getMsgAppFromPkt(pkt1)), "rx 1 data");
+        client.releaseFrontPacket();
+        const pge_network::PgePacket& pkt2 = client.borrowFrontPacket();
+        b &= assertTrue(vInput == getMsgAppData(*pge_network::PgePacket::getMsgAppFromPkt(pkt2)), "rx 2 data");
+        client.releaseFrontPacket();
+
+        // network statistics use the app message id known by the application
+        const std::map<pge_network::MsgApp::TMsgId, pge_network::PgeMsgAppCompressor::MsgAppStats> rxStats = client.getMsgAppCompressionStats();
+        return b & assertEquals(1u, server.getTxMsgCount().at(nMsgIdScoreboard), "tx msg count") &
+            assertEquals(1u, client.getRxMsgCount().at(nMsgIdScoreboard), "rx msg count") &
+            assertEquals(1u, server.getMsgAppCompressionStats().at(nMsgIdScoreboard).m_nTxCompressedCount, "tx compressed count") &
+            assertEquals(1u, rxStats.size(), "rx stats size") &
+            assertEquals(1u, rxStats.at(nMsgIdScoreboard).m_nRxCount, "rx count");
+    }
+
+}; // class PgeMsgAppCompressorTest
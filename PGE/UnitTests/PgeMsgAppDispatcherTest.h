@@ -0,0 +1,374 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeMsgAppDispatcherTest.h
+    Unit test for PgeMsgAppDispatcher.
+    Made by PR00F88, West Whiskhyll Entertainment
+    2026
+    ###################################################################################
+*/
+
+#include "UnitTest.h"  // PCH
+
+#include "../Network/PgeMsgAppDispatcher.h"
+
+#include <chrono>  // requires cpp11
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+class PgeMsgAppDispatcherTest :
+    public UnitTest
+{
+public:
+
+    PgeMsgAppDispatcherTest() :
+        UnitTest(__FILE__)
+    {
+    }
+
+protected:
+
+    virtual void initialize() override
+    {
+        addSubTest("test_ctor", (PFNUNITSUBTEST)&PgeMsgAppDispatcherTest::test_ctor);
+        addSubTest("test_register_Bad", (PFNUNITSUBTEST)&PgeMsgAppDispatcherTest::test_register_Bad);
+        addSubTest("test_dispatch_MsgApp", (PFNUNITSUBTEST)&PgeMsgAppDispatcherTest::test_dispatch_MsgApp);
+        addSubTest("test_dispatch_Batched", (PFNUNITSUBTEST)&PgeMsgAppDispatcherTest::test_dispatch_Batched);
+        addSubTest("test_dispatch_Pkt", (PFNUNITSUBTEST)&PgeMsgAppDispatcherTest::test_dispatch_Pkt);
+        addSubTest("test_dispatch_Unhandled", (PFNUNITSUBTEST)&PgeMsgAppDispatcherTest::test_dispatch_Unhandled);
+        addSubTest("test_dispatch_HandlerFails", (PFNUNITSUBTEST)&PgeMsgAppDispatcherTest::test_dispatch_HandlerFails);
+        addSubTest("test_stats_Timing", (PFNUNITSUBTEST)&PgeMsgAppDispatcherTest::test_stats_Timing);
+        addSubTest("test_clearStats", (PFNUNITSUBTEST)&PgeMsgAppDispatcherTest::test_clearStats);
+        addSubTest("test_exportCsv", (PFNUNITSUBTEST)&PgeMsgAppDispatcherTest::test_exportCsv);
+    }
+
+private:
+
+    static constexpr pge_network::MsgApp::TMsgId msgIdMove = 3;
+    static constexpr pge_network::MsgApp::TMsgId msgIdShoot = 7;
+    static constexpr pge_network::MsgApp::TMsgId msgIdChat = 300;
+    static constexpr pge_network::PgeNetworkConnectionHandle connHandleClient = 5;
+
+    // ---------------------------------------------------------------------------
+
+    PgeMsgAppDispatcherTest(const PgeMsgAppDispatcherTest&)
+    {};
+
+    PgeMsgAppDispatcherTest& operator=(const PgeMsgAppDispatcherTest&)
+    {
+        return *this;
+    };
+
+    /**
+        Adds an app message with 1 byte data to the given packet, already initialized by initPktMsgApp().
+    */
+    static bool addMsgApp(pge_network::PgePacket& pkt, const pge_network::MsgApp::TMsgId& msgAppId, const pge_network::TByte& data)
+    {
+        pge_network::TByte* const pData = pge_network::PgePacket::preparePktMsgAppFill(pkt, msgAppId, 1);
+        if (!pData)
+        {
+            return false;
+        }
+        *pData = data;
+        return true;
+    }
+
+    /**
+        Registers handlers recording the id, data and connection handle of each dispatched app message into the given vector.
+    */
+    static void registerRecordingHandlers(
+        pge_network::PgeMsgAppDispatcher& dispatcher,
+        std::vector<std::pair<pge_network::MsgApp::TMsgId, uint32_t>>& vDispatched)
+    {
+        for (const auto msgAppId : { msgIdMove, msgIdShoot, msgIdChat })
+        {
+            dispatcher.registerMsgAppHandler(
+                msgAppId,
+                "recorder " + std::to_string(msgAppId),
+                [&vDispatched](const pge_network::PgePacket& pkt, const pge_network::MsgApp& msgApp)
+                {
+                    vDispatched.push_back({
+                        pge_network::MsgApp::getMsgAppMsgId(msgApp),
+                        *pge_network::MsgApp::getMsgAppData(msgApp) + 1000u * pge_network::PgePacket::getServerSideConnectionHandle(pkt) });
+                    return true;
+                });
+        }
+    }
+
+    bool test_ctor()
+    {
+        const pge_network::PgeMsgAppDispatcher dispatcher;
+
+        return (assertTrue(dispatcher.isTimingEnabled(), "timing") &
+            assertFalse(dispatcher.isMsgAppHandlerRegistered(msgIdMove), "msgapp registered") &
+            assertFalse(dispatcher.isPktHandlerRegistered(pge_network::PgePktId::UserDisconnectedFromServer), "pkt registered") &
+            assertNull(dispatcher.getMsgAppHandlerStats(msgIdMove), "msgapp stats") &
+            assertNull(dispatcher.getPktHandlerStats(pge_network::PgePktId::UserDisconnectedFromServer), "pkt stats") &
+            assertEquals(0u, dispatcher.getUnhandledCount(), "unhandled") &
+            assertEquals(std::string("kind,id,name,call_count,total_ns,avg_ns,max_ns\n"), dispatcher.exportCsv(), "csv")) != 0;
+    }
+
+    bool test_register_Bad()
+    {
+        pge_network::PgeMsgAppDispatcher dispatcher;
+        const auto fnMsgApp = [](const pge_network::PgePacket&, const pge_network::MsgApp&) { return true; };
+        const auto fnPkt = [](const pge_network::PgePacket&) { return true; };
+        dispatcher.registerMsgAppHandler(msgIdMove, "move", fnMsgApp);
+        dispatcher.registerPktHandler(pge_network::PgePktId::UserDisconnectedFromServer, "disconnected", fnPkt);
+
+        int nExceptions = 0;
+        try
+        {
+            dispatcher.registerMsgAppHandler(msgIdMove, "move again", fnMsgApp);
+        }
+        catch (const std::exception&)
+        {
+            nExceptions++;
+        }
+        try
+        {
+            dispatcher.registerMsgAppHandler(msgIdShoot, "empty", pge_network::PgeMsgAppDispatcher::MsgAppHandler());
+        }
+        catch (const std::exception&)
+        {
+            nExceptions++;
+        }
+        try
+        {
+            dispatcher.registerPktHandler(pge_network::PgePktId::UserDisconnectedFromServer, "disconnected again", fnPkt);
+        }
+        catch (const std::exception&)
+        {
+            nExceptions++;
+        }
+        try
+        {
+            dispatcher.registerPktHandler(pge_network::PgePktId::Application, "app", fnPkt);
+        }
+        catch (const std::exception&)
+        {
+            nExceptions++;
+        }
+        try
+        {
+            dispatcher.registerPktHandler(pge_network::PgePktId::ClientAppVersion, "empty", pge_network::PgeMsgAppDispatcher::PktHandler());
+        }
+        catch (const std::exception&)
+        {
+            nExceptions++;
+        }
+
+        return (assertEquals(5, nExceptions, "exceptions") &
+            assertTrue(dispatcher.isMsgAppHandlerRegistered(msgIdMove), "move registered") &
+            assertFalse(dispatcher.isMsgAppHandlerRegistered(msgIdShoot), "shoot registered") &
+            assertFalse(dispatcher.isPktHandlerRegistered(pge_network::PgePktId::Application), "app registered") &
+            assertFalse(dispatcher.isPktHandlerRegistered(pge_network::PgePktId::ClientAppVersion), "version registered")) != 0;
+    }
+
+    bool test_dispatch_MsgApp()
+    {
+        pge_network::PgeMsgAppDispatcher dispatcher;
+        std::vector<std::pair<pge_network::MsgApp::TMsgId, uint32_t>> vDispatched;
+        registerRecordingHandlers(dispatcher, vDispatched);
+
+        pge_network::PgePacket pkt;
+        pge_network::PgePacket::initPktMsgApp(pkt, connHandleClient, pge_network::PgePacket::AutoFill::NONE);
+        bool b = assertTrue(addMsgApp(pkt, msgIdChat, 42), "add");
+        b &= assertTrue(dispatcher.dispatch(pkt), "dispatch");
+
+        const pge_network::PgeMsgAppDispatcher::HandlerStats* const pStatsChat = dispatcher.getMsgAppHandlerStats(msgIdChat);
+        const pge_network::PgeMsgAppDispatcher::HandlerStats* const pStatsMove = dispatcher.getMsgAppHandlerStats(msgIdMove);
+        b &= assertNotNull(pStatsChat, "stats chat") & assertNotNull(pStatsMove, "stats move");
+        if (!b)
+        {
+            return false;
+        }
+
+        return (assertEquals(1u, vDispatched.size(), "dispatched") &&
+            assertEquals(msgIdChat, vDispatched[0].first, "id") &
+            assertEquals(5042u, vDispatched[0].second, "data and conn handle") &
+            assertEquals(1u, pStatsChat->m_nCallCount, "chat call count") &
+            assertEquals(std::string("recorder 300"), pStatsChat->m_sName, "chat name") &
+            assertEquals(0u, pStatsMove->m_nCallCount, "move call count") &
+            assertEquals(0u, dispatcher.getUnhandledCount(), "unhandled")) != 0;
+    }
+
+    bool test_dispatch_Batched()
+    {
+        pge_network::PgeMsgAppDispatcher dispatcher;
+        std::vector<std::pair<pge_network::MsgApp::TMsgId, uint32_t>> vDispatched;
+        registerRecordingHandlers(dispatcher, vDispatched);
+
+        pge_network::PgePacket pkt;
+        pge_network::PgePacket::initPktMsgApp(pkt, connHandleClient, pge_network::PgePacket::AutoFill::NONE);
+        bool b = assertTrue(addMsgApp(pkt, msgIdMove, 1), "add 1");
+        b &= assertTrue(addMsgApp(pkt, msgIdShoot, 2), "add 2");
+        b &= assertTrue(addMsgApp(pkt, msgIdMove, 3), "add 3");
+        b &= assertTrue(addMsgApp(pkt, msgIdChat, 4), "add 4");
+        b &= assertTrue(dispatcher.dispatch(pkt), "dispatch");
+
+        const std::vector<std::pair<pge_network::MsgApp::TMsgId, uint32_t>> vExpected = {
+            { msgIdMove, 5001u }, { msgIdShoot, 5002u }, { msgIdMove, 5003u }, { msgIdChat, 5004u } };
+
+        return (b &
+            assertTrue(vExpected == vDispatched, "dispatched in order") &
+            assertEquals(2u, dispatcher.getMsgAppHandlerStats(msgIdMove)->m_nCallCount, "move call count") &
+            assertEquals(1u, dispatcher.getMsgAppHandlerStats(msgIdShoot)->m_nCallCount, "shoot call count") &
+            assertEquals(1u, dispatcher.getMsgAppHandlerStats(msgIdChat)->m_nCallCount, "chat call count")) != 0;
+    }
+
+    bool test_dispatch_Pkt()
+    {
+        pge_network::PgeMsgAppDispatcher dispatcher;
+        std::vector<std::pair<pge_network::MsgApp::TMsgId, uint32_t>> vDispatched;
+        registerRecordingHandlers(dispatcher, vDispatched);
+
+        pge_network::PgeNetworkConnectionHandle connHandleDisconnected = 0;
+        dispatcher.registerPktHandler(
+            pge_network::PgePktId::UserDisconnectedFromServer,
+            "disconnected",
+            [&connHandleDisconnected](const pge_network::PgePacket& pkt)
+            {
+                connHandleDisconnected = pge_network::PgePacket::getServerSideConnectionHandle(pkt);
+                return true;
+            });
+
+        pge_network::PgePacket pkt;
+        pge_network::PgePacket::initPktPgeMsgUserDisconnected(pkt, connHandleClient);
+
+        return (assertTrue(dispatcher.dispatch(pkt), "dispatch") &
+            assertEquals(connHandleClient, connHandleDisconnected, "conn handle") &
+            assertTrue(vDispatched.empty(), "no app message dispatched") &
+            assertEquals(1u, dispatcher.getPktHandlerStats(pge_network::PgePktId::UserDisconnectedFromServer)->m_nCallCount, "call count")) != 0;
+    }
+
+    bool test_dispatch_Unhandled()
+    {
+        pge_network::PgeMsgAppDispatcher dispatcher;
+        std::vector<std::pair<pge_network::MsgApp::TMsgId, uint32_t>> vDispatched;
+        registerRecordingHandlers(dispatcher, vDispatched);
+
+        pge_network::PgePacket pkt;
+        pge_network::PgePacket::initPktMsgApp(pkt, connHandleClient, pge_network::PgePacket::AutoFill::NONE);
+        bool b = assertTrue(addMsgApp(pkt, 1000 /* beyond the table */, 1), "add 1");
+        b &= assertTrue(addMsgApp(pkt, 4 /* in the table without handler */, 2), "add 2");
+        b &= assertTrue(addMsgApp(pkt, msgIdShoot, 3), "add 3");
+        b &= assertTrue(dispatcher.dispatch(pkt), "dispatch");
+
+        pge_network::PgePacket pktDisconnected;
+        pge_network::PgePacket::initPktPgeMsgUserDisconnected(pktDisconnected, connHandleClient);
+        b &= assertTrue(dispatcher.dispatch(pktDisconnected), "dispatch disconnected");
+
+        return (b &
+            assertEquals(1u, vDispatched.size(), "dispatched") &
+            assertEquals(3u, dispatcher.getUnhandledCount(), "unhandled")) != 0;
+    }
+
+    bool test_dispatch_HandlerFails()
+    {
+        pge_network::PgeMsgAppDispatcher dispatcher;
+        std::vector<std::pair<pge_network::MsgApp::TMsgId, uint32_t>> vDispatched;
+        registerRecordingHandlers(dispatcher, vDispatched);
+        dispatcher.registerMsgAppHandler(
+            4,
+            "failing",
+            [](const pge_network::PgePacket&, const pge_network::MsgApp&) { return false; });
+
+        pge_network::PgePacket pkt;
+        pge_network::PgePacket::initPktMsgApp(pkt, connHandleClient, pge_network::PgePacket::AutoFill::NONE);
+        bool b = assertTrue(addMsgApp(pkt, msgIdMove, 1), "add 1");
+        b &= assertTrue(addMsgApp(pkt, 4, 2), "add 2");
+        b &= assertTrue(addMsgApp(pkt, msgIdShoot, 3), "add 3");
+
+        return (b &
+            assertFalse(dispatcher.dispatch(pkt), "dispatch") &
+            assertEquals(1u, vDispatched.size(), "dispatched before failing") &
+            assertEquals(1u, dispatcher.getMsgAppHandlerStats(4)->m_nCallCount, "failing call count") &
+            assertEquals(0u, dispatcher.getMsgAppHandlerStats(msgIdShoot)->m_nCallCount, "shoot call count")) != 0;
+    }
+
+    bool test_stats_Timing()
+    {
+        pge_network::PgeMsgAppDispatcher dispatcher;
+        dispatcher.registerMsgAppHandler(
+            msgIdMove,
+            "slow",
+            [](const pge_network::PgePacket&, const pge_network::MsgApp&)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                return true;
+            });
+
+        pge_network::PgePacket pkt;
+        pge_network::PgePacket::initPktMsgApp(pkt, connHandleClient, pge_network::PgePacket::AutoFill::NONE);
+        bool b = assertTrue(addMsgApp(pkt, msgIdMove, 1), "add");
+        b &= assertTrue(dispatcher.dispatch(pkt), "dispatch 1");
+        b &= assertTrue(dispatcher.dispatch(pkt), "dispatch 2");
+
+        const pge_network::PgeMsgAppDispatcher::HandlerStats statsTimed = *dispatcher.getMsgAppHandlerStats(msgIdMove);
+        b &= assertEquals(2u, statsTimed.m_nCallCount, "call count") &
+            assertLequals(2u * 2000000u, statsTimed.m_nNanosecs, "total") &
+            assertLequals(2000000u, statsTimed.m_nMaxNanosecs, "max") &
+            assertEquals(statsTimed.m_nNanosecs / 2, statsTimed.getAvgNanosecs(), "avg");
+
+        dispatcher.setTimingEnabled(false);
+        b &= assertFalse(dispatcher.isTimingEnabled(), "timing");
+        b &= assertTrue(dispatcher.dispatch(pkt), "dispatch 3");
+
+        const pge_network::PgeMsgAppDispatcher::HandlerStats& statsUntimed = *dispatcher.getMsgAppHandlerStats(msgIdMove);
+        return (b &
+            assertEquals(3u, statsUntimed.m_nCallCount, "call count untimed") &
+            assertEquals(statsTimed.m_nNanosecs, statsUntimed.m_nNanosecs, "total untimed")) != 0;
+    }
+
+    bool test_clearStats()
+    {
+        pge_network::PgeMsgAppDispatcher dispatcher;
+        std::vector<std::pair<pge_network::MsgApp::TMsgId, uint32_t>> vDispatched;
+        registerRecordingHandlers(dispatcher, vDispatched);
+
+        pge_network::PgePacket pkt;
+        pge_network::PgePacket::initPktMsgApp(pkt, connHandleClient, pge_network::PgePacket::AutoFill::NONE);
+        bool b = assertTrue(addMsgApp(pkt, msgIdMove, 1), "add 1");
+        b &= assertTrue(addMsgApp(pkt, 4, 2), "add 2");
+        b &= assertTrue(dispatcher.dispatch(pkt), "dispatch");
+        dispatcher.clearStats();
+
+        return (b &
+            assertTrue(dispatcher.isMsgAppHandlerRegistered(msgIdMove), "registered") &
+            assertEquals(0u, dispatcher.getMsgAppHandlerStats(msgIdMove)->m_nCallCount, "call count") &
+            assertEquals(0u, dispatcher.getMsgAppHandlerStats(msgIdMove)->m_nNanosecs, "total") &
+            assertEquals(0u, dispatcher.getMsgAppHandlerStats(msgIdMove)->m_nMaxNanosecs, "max") &
+            assertEquals(0u, dispatcher.getUnhandledCount(), "unhandled")) != 0;
+    }
+
+    bool test_exportCsv()
+    {
+        pge_network::PgeMsgAppDispatcher dispatcher;
+        dispatcher.setTimingEnabled(false);
+        dispatcher.registerMsgAppHandler(
+            msgIdChat,
+            "chat \"all\"",
+            [](const pge_network::PgePacket&, const pge_network::MsgApp&) { return true; });
+        dispatcher.registerPktHandler(
+            pge_network::PgePktId::UserDisconnectedFromServer,
+            "disconnected",
+            [](const pge_network::PgePacket&) { return true; });
+
+        pge_network::PgePacket pkt;
+        pge_network::PgePacket::initPktMsgApp(pkt, connHandleClient, pge_network::PgePacket::AutoFill::NONE);
+        bool b = assertTrue(addMsgApp(pkt, msgIdChat, 1), "add");
+        b &= assertTrue(dispatcher.dispatch(pkt), "dispatch");
+
+        return (b &
+            assertEquals(
+                std::string("kind,id,name,call_count,total_ns,avg_ns,max_ns\n"
+                    "app,300,\"chat \"\"all\"\"\",1,0,0,0\n"
+                    "pge,1,\"disconnected\",0,0,0,0\n"),
+                dispatcher.exportCsv(),
+                "csv")) != 0;
+    }
+
+}; // class PgeMsgAppDispatcherTest
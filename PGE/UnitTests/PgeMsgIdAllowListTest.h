@@ -0,0 +1,159 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeMsgIdAllowListTest.h
+    Unit test for PgeMsgIdAllowList.
+    Made by PR00F88, West Whiskhyll Entertainment
+    2026
+    ###################################################################################
+*/
+
+#include "UnitTest.h"  // PCH
+
+#include "../Network/PgeMsgIdAllowList.h"
+
+#include <stdexcept>
+
+class PgeMsgIdAllowListTest :
+    public UnitTest
+{
+public:
+
+    PgeMsgIdAllowListTest() :
+        UnitTest(__FILE__)
+    {
+    }
+
+protected:
+
+    virtual void initialize() override
+    {
+        addSubTest("test_ctor", (PFNUNITSUBTEST)&PgeMsgIdAllowListTest::test_ctor);
+        addSubTest("test_insert", (PFNUNITSUBTEST)&PgeMsgIdAllowListTest::test_insert);
+        addSubTest("test_insert_OutOfRange", (PFNUNITSUBTEST)&PgeMsgIdAllowListTest::test_insert_OutOfRange);
+        addSubTest("test_erase", (PFNUNITSUBTEST)&PgeMsgIdAllowListTest::test_erase);
+        addSubTest("test_clear", (PFNUNITSUBTEST)&PgeMsgIdAllowListTest::test_clear);
+        addSubTest("test_msgAppIdAllowList_AllIds", (PFNUNITSUBTEST)&PgeMsgIdAllowListTest::test_msgAppIdAllowList_AllIds);
+    }
+
+private:
+
+    // ---------------------------------------------------------------------------
+
+    PgeMsgIdAllowListTest(const PgeMsgIdAllowListTest&)
+    {};
+
+    PgeMsgIdAllowListTest& operator=(const PgeMsgIdAllowListTest&)
+    {
+        return *this;
+    };
+
+    bool test_ctor()
+    {
+        const pge_network::PgePktIdAllowList allowListPkt;
+        const pge_network::MsgAppIdAllowList allowListMsgApp;
+
+        return (assertTrue(allowListPkt.empty(), "pkt empty") &
+            assertEquals(0u, allowListPkt.size(), "pkt size") &
+            assertFalse(allowListPkt.contains(pge_network::PgePktId::Application), "pkt contains") &
+            assertTrue(allowListMsgApp.empty(), "app empty") &
+            assertEquals(0u, allowListMsgApp.size(), "app size") &
+            assertEquals(0u, allowListMsgApp.count(0), "app count") &
+            assertEquals(static_cast<std::size_t>(65536), pge_network::MsgAppIdAllowList::nMaxIdCount, "app max id count")) != 0;
+    }
+
+    bool test_insert()
+    {
+        pge_network::PgePktIdAllowList allowList;
+
+        bool b = assertTrue(allowList.insert(pge_network::PgePktId::Application), "insert 1");
+        b &= assertFalse(allowList.insert(pge_network::PgePktId::Application), "insert 1 again");
+        b &= assertTrue(allowList.insert(pge_network::PgePktId::UserDisconnectedFromServer), "insert 2");
+
+        return (b &
+            assertFalse(allowList.empty(), "empty") &
+            assertEquals(2u, allowList.size(), "size") &
+            assertTrue(allowList.contains(pge_network::PgePktId::Application), "contains 1") &
+            assertTrue(allowList.contains(pge_network::PgePktId::UserDisconnectedFromServer), "contains 2") &
+            assertFalse(allowList.contains(pge_network::PgePktId::UserConnectedServerSelf), "not contains 1") &
+            assertFalse(allowList.contains(pge_network::PgePktId::ClientAppVersion), "not contains 2") &
+            assertEquals(1u, allowList.count(pge_network::PgePktId::Application), "count")) != 0;
+    }
+
+    bool test_insert_OutOfRange()
+    {
+        pge_network::PgePktIdAllowList allowList;
+        const pge_network::PgePktId pktIdOutOfRange = static_cast<pge_network::PgePktId>(pge_network::PgePktIdAllowList::nMaxIdCount);
+
+        bool b = false;
+        try
+        {
+            allowList.insert(pktIdOutOfRange);
+        }
+        catch (const std::exception&)
+        {
+            b = true;
+        }
+
+        return (assertTrue(b, "exception") &
+            assertTrue(allowList.empty(), "empty") &
+            assertFalse(allowList.contains(pktIdOutOfRange), "contains") &
+            assertFalse(allowList.contains(static_cast<pge_network::PgePktId>(1000000)), "contains far")) != 0;
+    }
+
+    bool test_erase()
+    {
+        pge_network::MsgAppIdAllowList allowList;
+        allowList.insert(5);
+        allowList.insert(64);
+
+        return (assertEquals(1u, allowList.erase(5), "erase 1") &
+            assertEquals(0u, allowList.erase(5), "erase 1 again") &
+            assertEquals(0u, allowList.erase(63), "erase not inserted") &
+            assertEquals(1u, allowList.size(), "size") &
+            assertFalse(allowList.contains(5), "contains 1") &
+            assertTrue(allowList.contains(64), "contains 2")) != 0;
+    }
+
+    bool test_clear()
+    {
+        pge_network::MsgAppIdAllowList allowList;
+        allowList.insert(1);
+        allowList.insert(1000);
+        allowList.clear();
+
+        return (assertTrue(allowList.empty(), "empty") &
+            assertFalse(allowList.contains(1), "contains 1") &
+            assertFalse(allowList.contains(1000), "contains 2") &
+            assertTrue(allowList.insert(1000), "insert again")) != 0;
+    }
+
+    bool test_msgAppIdAllowList_AllIds()
+    {
+        pge_network::MsgAppIdAllowList allowList;
+
+        // every 3rd id, including both ends of the id range and word boundaries in between
+        bool bInserted = true;
+        for (uint32_t i = 0; i <= 0xFFFFu; i += 3)
+        {
+            bInserted &= allowList.insert(static_cast<pge_network::MsgApp::TMsgId>(i));
+        }
+
+        uint32_t nContained = 0;
+        bool bMatch = true;
+        for (uint32_t i = 0; i <= 0xFFFFu; i++)
+        {
+            const bool bContains = allowList.contains(static_cast<pge_network::MsgApp::TMsgId>(i));
+            bMatch &= (bContains == (i % 3 == 0));
+            nContained += bContains ? 1 : 0;
+        }
+
+        return (assertTrue(bInserted, "insert") &
+            assertTrue(bMatch, "match") &
+            assertEquals(21846u, nContained, "contained") &
+            assertEquals(21846u, allowList.size(), "size") &
+            assertTrue(allowList.contains(0xFFFF), "contains last")) != 0;
+    }
+
+}; // class PgeMsgIdAllowListTest
@@ -0,0 +1,326 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeNetworkStatsTest.h
+    Unit test for PgeNetworkStats.
+    Made by PR00F88, West Whiskhyll Entertainment
+    2026
+    ###################################################################################
+*/
+
+#include "UnitTest.h"  // PCH
+
+#include "../Network/PgeNetworkStats.h"
+
+#include <algorithm>
+
+class PgeNetworkStatsTest :
+    public UnitTest
+{
+public:
+
+    PgeNetworkStatsTest() :
+        UnitTest(__FILE__)
+    {
+    }
+
+protected:
+
+    virtual void initialize() override
+    {
+        addSubTest("test_ctor", (PFNUNITSUBTEST)&PgeNetworkStatsTest::test_ctor);
+        addSubTest("test_getHistogramBucketIndex", (PFNUNITSUBTEST)&PgeNetworkStatsTest::test_getHistogramBucketIndex);
+        addSubTest("test_addMsgApp", (PFNUNITSUBTEST)&PgeNetworkStatsTest::test_addMsgApp);
+        addSubTest("test_addMsgApp_IdOutOfRange", (PFNUNITSUBTEST)&PgeNetworkStatsTest::test_addMsgApp_IdOutOfRange);
+        addSubTest("test_addPkt_and_removeConnection", (PFNUNITSUBTEST)&PgeNetworkStatsTest::test_addPkt_and_removeConnection);
+        addSubTest("test_perSecondRates", (PFNUNITSUBTEST)&PgeNetworkStatsTest::test_perSecondRates);
+        addSubTest("test_getMsgAppCountMap_and_getLaneMsgCountMap", (PFNUNITSUBTEST)&PgeNetworkStatsTest::test_getMsgAppCountMap_and_getLaneMsgCountMap);
+        addSubTest("test_clear", (PFNUNITSUBTEST)&PgeNetworkStatsTest::test_clear);
+        addSubTest("test_exportCsv", (PFNUNITSUBTEST)&PgeNetworkStatsTest::test_exportCsv);
+        addSubTest("test_exportJson", (PFNUNITSUBTEST)&PgeNetworkStatsTest::test_exportJson);
+        addSubTest("test_handoffStats_latency", (PFNUNITSUBTEST)&PgeNetworkStatsTest::test_handoffStats_latency);
+    }
+
+private:
+
+    typedef pge_network::PgeNetworkStats::Direction Direction;
+
+    // ---------------------------------------------------------------------------
+
+    PgeNetworkStatsTest(const PgeNetworkStatsTest&)
+    {};
+
+    PgeNetworkStatsTest& operator=(const PgeNetworkStatsTest&)
+    {
+        return *this;
+    };
+
+    static pge_network::PgeNetworkStats::TimePoint atMillis(const int nMillis)
+    {
+        return pge_network::PgeNetworkStats::TimePoint() + std::chrono::milliseconds(nMillis);
+    }
+
+    static std::string getCsvZeros(const size_t nCount)
+    {
+        std::string sZeros;
+        for (size_t i = 0; i < nCount; i++)
+        {
+            sZeros += ",0";
+        }
+        return sZeros;
+    }
+
+    bool test_ctor()
+    {
+        const pge_network::PgeNetworkStats stats;
+
+        bool b = true;
+        for (size_t iDir = 0; iDir < pge_network::PgeNetworkStats::nDirectionCount; iDir++)
+        {
+            const Direction dir = static_cast<Direction>(iDir);
+            b &= assertEquals(0u, stats.getMsgAppRecord(dir, 0).m_nCount, "msg count 0");
+            b &= assertEquals(0u, stats.getMsgAppRecord(dir, pge_network::PgeNetworkStats::nMsgAppIdSlotCount - 1).m_nCount, "msg count last");
+            b &= assertEquals(0u, stats.getLaneMsgCount(dir, pge_network::PgeSendLane::Reliable), "lane count");
+            b &= assertTrue(stats.getMsgAppCountMap(dir).empty(), "msg count map");
+            b &= assertTrue(stats.getLaneMsgCountMap(dir).empty(), "lane count map");
+        }
+
+        return b & assertTrue(stats.getConnectionHandles().empty(), "connections") &
+            assertNull(stats.getConnectionRecord(Direction::Rx, 0), "connection record");
+    }
+
+    bool test_getHistogramBucketIndex()
+    {
+        return assertEquals(0u, pge_network::PgeNetworkStats::getHistogramBucketIndex(0, 16), "0") &
+            assertEquals(1u, pge_network::PgeNetworkStats::getHistogramBucketIndex(1, 16), "1") &
+            assertEquals(2u, pge_network::PgeNetworkStats::getHistogramBucketIndex(2, 16), "2") &
+            assertEquals(2u, pge_network::PgeNetworkStats::getHistogramBucketIndex(3, 16), "3") &
+            assertEquals(3u, pge_network::PgeNetworkStats::getHistogramBucketIndex(4, 16), "4") &
+            assertEquals(9u, pge_network::PgeNetworkStats::getHistogramBucketIndex(511, 16), "511") &
+            assertEquals(10u, pge_network::PgeNetworkStats::getHistogramBucketIndex(512, 16), "512") &
+            assertEquals(15u, pge_network::PgeNetworkStats::getHistogramBucketIndex(1u << 14, 16), "2^14") &
+            assertEquals(15u, pge_network::PgeNetworkStats::getHistogramBucketIndex(1u << 20, 16), "2^20 clamped") &
+            assertEquals(0u, pge_network::PgeNetworkStats::getHistogramBucketIndex(1u << 20, 1), "single bucket");
+    }
+
+    bool test_addMsgApp()
+    {
+        pge_network::PgeNetworkStats stats;
+        stats.addMsgApp(Direction::Tx, 5, 10, pge_network::PgeSendLane::Unreliable, atMillis(0));
+        stats.addMsgApp(Direction::Tx, 5, 100, pge_network::PgeSendLane::Unreliable, atMillis(1));
+        stats.addMsgApp(Direction::Tx, 5, 100, pge_network::PgeSendLane::Unreliable, atMillis(3));
+        stats.addMsgApp(Direction::Rx, 5, 10, pge_network::PgeSendLane::Reliable, atMillis(3));
+
+        const pge_network::PgeNetworkStats::Record& record = stats.getMsgAppRecord(Direction::Tx, 5);
+
+        return assertEquals(3u, record.m_nCount, "count") &
+            assertEquals(210u, static_cast<uint32_t>(record.m_nBytes), "bytes") &
+            assertTrue(record.m_time1st == atMillis(0), "time 1st") &
+            assertTrue(record.m_timeLast == atMillis(3), "time last") &
+            assertEquals(1u, record.m_nSizeHistogram[4], "size hist 10") &
+            assertEquals(2u, record.m_nSizeHistogram[7], "size hist 100") &
+            assertEquals(1u, record.m_nInterArrivalHistogram[10], "inter-arrival hist 1000 us") &
+            assertEquals(1u, record.m_nInterArrivalHistogram[11], "inter-arrival hist 2000 us") &
+            assertEquals(3u, stats.getLaneMsgCount(Direction::Tx, pge_network::PgeSendLane::Unreliable), "tx lane count") &
+            assertEquals(0u, stats.getLaneMsgCount(Direction::Tx, pge_network::PgeSendLane::Reliable), "tx lane count reliable") &
+            assertEquals(1u, stats.getMsgAppRecord(Direction::Rx, 5).m_nCount, "rx count") &
+            assertEquals(1u, stats.getLaneMsgCount(Direction::Rx, pge_network::PgeSendLane::Reliable), "rx lane count") &
+            assertEquals(0u, stats.getMsgAppRecord(Direction::Inject, 5).m_nCount, "inject count") &
+            assertEquals(0u, stats.getMsgAppRecord(Direction::Tx, 4).m_nCount, "other id count") &
+            assertTrue(stats.getConnectionHandles().empty(), "connections");
+    }
+
+    bool test_addMsgApp_IdOutOfRange()
+    {
+        pge_network::PgeNetworkStats stats;
+        const pge_network::MsgApp::TMsgId idLast = pge_network::PgeNetworkStats::nMsgAppIdSlotCount - 1;
+        stats.addMsgApp(Direction::Rx, idLast, 10, pge_network::PgeSendLane::Reliable, atMillis(0));
+        stats.addMsgApp(Direction::Rx, idLast + 1, 10, pge_network::PgeSendLane::Reliable, atMillis(0));
+        stats.addMsgApp(Direction::Rx, 100000, 10, pge_network::PgeSendLane::Reliable, atMillis(0));
+
+        return assertEquals(3u, stats.getMsgAppRecord(Direction::Rx, idLast).m_nCount, "last slot") &
+            assertEquals(3u, stats.getMsgAppRecord(Direction::Rx, 100000).m_nCount, "out of range gives last slot") &
+            assertEquals(1u, stats.getMsgAppCountMap(Direction::Rx).size(), "msg count map size");
+    }
+
+    bool test_addPkt_and_removeConnection()
+    {
+        pge_network::PgeNetworkStats stats;
+        stats.addPkt(Direction::Rx, 20, 50, atMillis(0));
+        stats.addPkt(Direction::Tx, 10, 60, atMillis(0));
+        stats.addPkt(Direction::Rx, 20, 70, atMillis(5));
+
+        bool b = assertEquals(2u, stats.getConnectionHandles().size(), "connections 1");
+        if (!b)
+        {
+            return false;
+        }
+
+        b &= assertEquals(20u, stats.getConnectionHandles()[0], "connection 0");
+        b &= assertEquals(10u, stats.getConnectionHandles()[1], "connection 1");
+
+        const pge_network::PgeNetworkStats::Record* pRecord = stats.getConnectionRecord(Direction::Rx, 20);
+        b &= assertNotNull(pRecord, "record rx 20");
+        if (!b)
+        {
+            return false;
+        }
+
+        b &= assertEquals(2u, pRecord->m_nCount, "count rx 20");
+        b &= assertEquals(120u, static_cast<uint32_t>(pRecord->m_nBytes), "bytes rx 20");
+        b &= assertEquals(1u, pRecord->m_nInterArrivalHistogram[13], "inter-arrival hist 5000 us");
+        b &= assertEquals(0u, stats.getConnectionRecord(Direction::Tx, 20)->m_nCount, "count tx 20");
+        b &= assertEquals(1u, stats.getConnectionRecord(Direction::Tx, 10)->m_nCount, "count tx 10");
+        b &= assertNull(stats.getConnectionRecord(Direction::Rx, 30), "record rx 30");
+
+        stats.removeConnection(20);
+        stats.removeConnection(30);  // no effect
+
+        return b & assertEquals(1u, stats.getConnectionHandles().size(), "connections 2") &
+            assertNull(stats.getConnectionRecord(Direction::Rx, 20), "record rx 20 removed") &
+            assertNotNull(stats.getConnectionRecord(Direction::Tx, 10), "record tx 10 kept");
+    }
+
+    bool test_perSecondRates()
+    {
+        pge_network::PgeNetworkStats stats;
+        for (int i = 0; i < 10; i++)
+        {
+            stats.addMsgApp(Direction::Tx, 1, 20, pge_network::PgeSendLane::Reliable, atMillis(i * 100));
+        }
+        const pge_network::PgeNetworkStats::Record& record = stats.getMsgAppRecord(Direction::Tx, 1);
+
+        // 1st window is not completed yet
+        bool b = assertEquals(0u, record.getCountPerSecond(atMillis(950)), "count/s 1");
+
+        // 1st window is completed but not yet closed by a new record
+        b &= assertEquals(10u, record.getCountPerSecond(atMillis(1500)), "count/s 2");
+        b &= assertEquals(200u, static_cast<uint32_t>(record.getBytesPerSecond(atMillis(1500))), "bytes/s 2");
+
+        // new record closes the 1st window
+        stats.addMsgApp(Direction::Tx, 1, 20, pge_network::PgeSendLane::Reliable, atMillis(1500));
+        b &= assertEquals(10u, record.getCountPerSecond(atMillis(1600)), "count/s 3");
+        b &= assertEquals(200u, static_cast<uint32_t>(record.getBytesPerSecond(atMillis(1600))), "bytes/s 3");
+
+        // no traffic for a long time
+        b &= assertEquals(0u, record.getCountPerSecond(atMillis(5000)), "count/s 4");
+        b &= assertEquals(0u, static_cast<uint32_t>(record.getBytesPerSecond(atMillis(5000))), "bytes/s 4");
+
+        // new record after a long time closes the old window as outdated
+        stats.addMsgApp(Direction::Tx, 1, 20, pge_network::PgeSendLane::Reliable, atMillis(5000));
+        return b & assertEquals(0u, record.getCountPerSecond(atMillis(5100)), "count/s 5") &
+            assertEquals(1u, record.getCountPerSecond(atMillis(6100)), "count/s 6");
+    }
+
+    bool test_getMsgAppCountMap_and_getLaneMsgCountMap()
+    {
+        pge_network::PgeNetworkStats stats;
+        stats.addMsgApp(Direction::Inject, 3, 10, pge_network::PgeSendLane::Reliable, atMillis(0));
+        stats.addMsgApp(Direction::Inject, 7, 10, pge_network::PgeSendLane::UnreliableNoDelay, atMillis(0));
+        stats.addMsgApp(Direction::Inject, 7, 10, pge_network::PgeSendLane::UnreliableNoDelay, atMillis(0));
+
+        const std::map<pge_network::MsgApp::TMsgId, uint32_t>& mapMsgAppCount = stats.getMsgAppCountMap(Direction::Inject);
+        const std::map<pge_network::PgeSendLane, uint32_t>& mapLaneMsgCount = stats.getLaneMsgCountMap(Direction::Inject);
+
+        bool b = assertEquals(2u, mapMsgAppCount.size(), "msg count map size") &
+            assertEquals(2u, mapLaneMsgCount.size(), "lane count map size");
+        if (!b)
+        {
+            return false;
+        }
+
+        b &= assertEquals(1u, mapMsgAppCount.at(3), "msg count 3");
+        b &= assertEquals(2u, mapMsgAppCount.at(7), "msg count 7");
+        b &= assertEquals(1u, mapLaneMsgCount.at(pge_network::PgeSendLane::Reliable), "lane count reliable");
+        b &= assertEquals(2u, mapLaneMsgCount.at(pge_network::PgeSendLane::UnreliableNoDelay), "lane count unreliable no delay");
+
+        // maps are rebuilt on each call
+        stats.addMsgApp(Direction::Inject, 3, 10, pge_network::PgeSendLane::Reliable, atMillis(0));
+        return b & assertEquals(2u, stats.getMsgAppCountMap(Direction::Inject).at(3), "msg count 3 again") &
+            assertTrue(stats.getMsgAppCountMap(Direction::Rx).empty(), "rx msg count map");
+    }
+
+    bool test_clear()
+    {
+        pge_network::PgeNetworkStats stats;
+        stats.addMsgApp(Direction::Rx, 3, 10, pge_network::PgeSendLane::Reliable, atMillis(0));
+        stats.addPkt(Direction::Rx, 20, 50, atMillis(0));
+        stats.clear();
+
+        return assertEquals(0u, stats.getMsgAppRecord(Direction::Rx, 3).m_nCount, "msg count") &
+            assertEquals(0u, static_cast<uint32_t>(stats.getMsgAppRecord(Direction::Rx, 3).m_nBytes), "msg bytes") &
+            assertEquals(0u, stats.getMsgAppRecord(Direction::Rx, 3).m_nSizeHistogram[4], "msg size hist") &
+            assertEquals(0u, stats.getLaneMsgCount(Direction::Rx, pge_network::PgeSendLane::Reliable), "lane count") &
+            assertTrue(stats.getConnectionHandles().empty(), "connections");
+    }
+
+    bool test_exportCsv()
+    {
+        pge_network::PgeNetworkStats stats;
+        stats.addMsgApp(Direction::Tx, 3, 10, pge_network::PgeSendLane::Reliable, atMillis(0));
+        stats.addPkt(Direction::Rx, 20, 50, atMillis(0));
+
+        const std::map<pge_network::MsgApp::TMsgId, std::string> mapMsgAppId2String = { {3, "Msg\"Three\""} };
+        const std::string sCsv = stats.exportCsv(mapMsgAppId2String, atMillis(100));
+
+        // size 10 is in bucket 4, size 50 is in bucket 6, no inter-arrival for single records
+        const std::string sExpectedRowMsg = "Tx,msg,3,\"Msg\"\"Three\"\"\",1,10,0,0" +
+            getCsvZeros(4) + ",1" + getCsvZeros(11) + getCsvZeros(24) + "\n";
+        const std::string sExpectedRowConn = "Rx,conn,20,\"\",1,50,0,0" +
+            getCsvZeros(6) + ",1" + getCsvZeros(9) + getCsvZeros(24) + "\n";
+
+        return assertTrue(sCsv.find("direction,scope,id,name,count,bytes,count_per_sec,bytes_per_sec,size_hist_0,") == 0, "header") &
+            assertTrue(sCsv.find(",interarrival_us_hist_23\n") != std::string::npos, "header end") &
+            assertTrue(sCsv.find(sExpectedRowMsg) != std::string::npos, "msg row") &
+            assertTrue(sCsv.find(sExpectedRowConn) != std::string::npos, "conn row") &
+            assertTrue(sCsv.find(sExpectedRowConn) < sCsv.find(sExpectedRowMsg), "rx before tx") &
+            assertEquals(3u, static_cast<size_t>(std::count(sCsv.begin(), sCsv.end(), '\n')), "line count");
+    }
+
+    bool test_exportJson()
+    {
+        pge_network::PgeNetworkStats stats;
+        const std::map<pge_network::MsgApp::TMsgId, std::string> mapMsgAppId2String = { {3, "Msg\\Three"} };
+
+        bool b = assertEquals(std::string("{\"msg\":[],\"conn\":[]}"), stats.exportJson(mapMsgAppId2String, atMillis(0)), "empty");
+
+        stats.addMsgApp(Direction::Tx, 3, 10, pge_network::PgeSendLane::Reliable, atMillis(0));
+        stats.addMsgApp(Direction::Rx, 4, 10, pge_network::PgeSendLane::Reliable, atMillis(0));
+        stats.addPkt(Direction::Rx, 20, 50, atMillis(0));
+        const std::string sJson = stats.exportJson(mapMsgAppId2String, atMillis(100));
+
+        return b & assertTrue(sJson.find("{\"msg\":[{\"direction\":\"Rx\",\"id\":4,\"name\":\"\",\"count\":1,\"bytes\":10,\"count_per_sec\":0,\"bytes_per_sec\":0,\"size_hist\":[0,0,0,0,1,") == 0, "msg rx") &
+            assertTrue(sJson.find("},{\"direction\":\"Tx\",\"id\":3,\"name\":\"Msg\\\\Three\",\"count\":1,") != std::string::npos, "msg tx") &
+            assertTrue(sJson.find("],\"conn\":[{\"direction\":\"Rx\",\"id\":20,\"count\":1,\"bytes\":50,") != std::string::npos, "conn rx") &
+            assertTrue(sJson.find(",\"interarrival_us_hist\":[0,") != std::string::npos, "inter-arrival hist") &
+            assertTrue(sJson.find("]}]}") == sJson.size() - 4, "end");
+    }
+
+    bool test_handoffStats_latency()
+    {
+        pge_network::PgeHandoffStats stats;
+        bool b = assertFalse(stats.m_bIoThread, "io thread") &
+            assertEquals(0u, stats.m_rxLatency.m_nCount, "count 0") &
+            assertEquals(0u, stats.m_rxLatency.getAvgUSecs(), "avg 0") &
+            assertEquals(0u, stats.m_handoffLatency.m_nCount, "handoff count 0") &
+            assertEquals(0u, stats.m_nRxQueueHighWaterMark, "rx hwm") &
+            assertEquals(0u, stats.m_nTxQueueFullCount, "tx full") &
+            assertEquals(0u, stats.m_nTxCmdDroppedCount, "tx dropped");
+
+        // negative latency might happen due to clock granularity, recorded as 0
+        stats.m_rxLatency.add(-5);
+        stats.m_rxLatency.add(3);
+        stats.m_rxLatency.add(1000);
+
+        return b & assertEquals(3u, stats.m_rxLatency.m_nCount, "count") &
+            assertEquals(1003u, stats.m_rxLatency.m_nSumUSecs, "sum") &
+            assertEquals(1000u, stats.m_rxLatency.m_nMaxUSecs, "max") &
+            assertEquals(334u, stats.m_rxLatency.getAvgUSecs(), "avg") &
+            assertEquals(1u, stats.m_rxLatency.m_nHistogram[0], "bucket 0") &
+            assertEquals(1u, stats.m_rxLatency.m_nHistogram[2], "bucket 2") &
+            assertEquals(1u, stats.m_rxLatency.m_nHistogram[10], "bucket 10") &
+            assertEquals(0u, stats.m_handoffLatency.m_nCount, "handoff count unaffected");
+    }
+
+};
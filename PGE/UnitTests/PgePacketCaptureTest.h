@@ -0,0 +1,486 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgePacketCaptureTest.h
+    Unit test for PgePacketCaptureWriter, PgePacketCaptureReader and PgePacketReplayer.
+    Made by PR00F88, West Whiskhyll Entertainment
+    2026
+    ###################################################################################
+*/
+
+#include "UnitTest.h"  // PCH
+
+#include "../Network/PgePacketCapture.h"
+#include "../Network/PgePacketReplayer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+class PgePacketCaptureTest :
+    public UnitTest
+{
+public:
+
+    PgePacketCaptureTest() :
+        UnitTest(__FILE__)
+    {
+    }
+
+    ~PgePacketCaptureTest()
+    {
+        std::remove(szCaptureFilename);
+    }
+
+protected:
+
+    virtual void initialize() override
+    {
+        addSubTest("test_writer_ctor", (PFNUNITSUBTEST)&PgePacketCaptureTest::test_writer_ctor);
+        addSubTest("test_writer_open", (PFNUNITSUBTEST)&PgePacketCaptureTest::test_writer_open);
+        addSubTest("test_write_read", (PFNUNITSUBTEST)&PgePacketCaptureTest::test_write_read);
+        addSubTest("test_write_read_SmallBuffer", (PFNUNITSUBTEST)&PgePacketCaptureTest::test_write_read_SmallBuffer);
+        addSubTest("test_write_FlushInterval", (PFNUNITSUBTEST)&PgePacketCaptureTest::test_write_FlushInterval);
+        addSubTest("test_reader_open_Invalid", (PFNUNITSUBTEST)&PgePacketCaptureTest::test_reader_open_Invalid);
+        addSubTest("test_reader_Truncated", (PFNUNITSUBTEST)&PgePacketCaptureTest::test_reader_Truncated);
+        addSubTest("test_replay_UnpacksBatchedMsgApps", (PFNUNITSUBTEST)&PgePacketCaptureTest::test_replay_UnpacksBatchedMsgApps);
+        addSubTest("test_replay_Directions", (PFNUNITSUBTEST)&PgePacketCaptureTest::test_replay_Directions);
+        addSubTest("test_replay_CallbackFails", (PFNUNITSUBTEST)&PgePacketCaptureTest::test_replay_CallbackFails);
+        addSubTest("test_replay_RecordedPacing", (PFNUNITSUBTEST)&PgePacketCaptureTest::test_replay_RecordedPacing);
+        addSubTest("test_benchmark_record_replay", (PFNUNITSUBTEST)&PgePacketCaptureTest::test_benchmark_record_replay);
+    }
+
+private:
+
+    static constexpr char* szCaptureFilename = "PgePacketCaptureTest.pgecap";
+
+    static constexpr pge_network::MsgApp::TMsgId nMsgIdInput = 1u;
+    static constexpr pge_network::MsgApp::TMsgId nMsgIdUpdate = 2u;
+
+    // ---------------------------------------------------------------------------
+
+    PgePacketCaptureTest(const PgePacketCaptureTest&)
+    {};
+
+    PgePacketCaptureTest& operator=(const PgePacketCaptureTest&)
+    {
+        return *this;
+    };
+
+    static pge_network::PgePacket makePktMsgApp(
+        const pge_network::PgeNetworkConnectionHandle& connHandle,
+        const std::vector<pge_network::MsgApp::TMsgId>& vMsgAppIds,
+        const uint32_t& nValue)
+    {
+        pge_network::PgePacket pkt;
+        pge_network::PgePacket::initPktMsgApp(pkt, connHandle);
+        for (const auto& msgAppId : vMsgAppIds)
+        {
+            pge_network::TByte* const pData = pge_network::PgePacket::preparePktMsgAppFill(pkt, msgAppId, sizeof(nValue));
+            if (pData)
+            {
+                memcpy(pData, &nValue, sizeof(nValue));
+            }
+        }
+        return pkt;
+    }
+
+    static uint32_t getMsgAppValue(const pge_network::PgePacket& pkt)
+    {
+        uint32_t nValue = 0;
+        memcpy(&nValue, pge_network::MsgApp::getMsgAppData(*pge_network::PgePacket::getMsgAppFromPkt(pkt)), sizeof(nValue));
+        return nValue;
+    }
+
+    static void recordPkt(
+        pge_network::PgePacketCaptureWriter& writer,
+        const pge_network::PgeNetworkStats::Direction& dir,
+        const pge_network::PgePacket& pkt,
+        const pge_network::PgeNetworkStats::TimePoint& time)
+    {
+        writer.record(
+            dir,
+            pge_network::PgePacket::getServerSideConnectionHandle(pkt),
+            pkt,
+            pge_network::PgePacket::getPktActualSizeBytes(pkt),
+            time);
+    }
+
+    /**
+        Writes a capture with: an injected user connected pkt, a received pkt with 3 batched app messages, a sent pkt with 1 app
+        message, and a received pkt with 1 app message, 10 ms apart from each other.
+    */
+    bool writeSampleCapture()
+    {
+        pge_network::PgePacketCaptureWriter writer;
+        bool b = assertTrue(writer.open(szCaptureFilename), "open");
+
+        pge_network::PgePacket pktUserConnected;
+        pge_network::PgePacket::initPktPgeMsgUserConnected(pktUserConnected, 5, false, "192.168.1.5");
+
+        const pge_network::PgeNetworkStats::TimePoint timeStart = std::chrono::steady_clock::now();
+        recordPkt(writer, pge_network::PgeNetworkStats::Direction::Inject, pktUserConnected, timeStart);
+        recordPkt(writer, pge_network::PgeNetworkStats::Direction::Rx, makePktMsgApp(5, { nMsgIdInput, nMsgIdInput, nMsgIdUpdate }, 10),
+            timeStart + std::chrono::milliseconds(10));
+        recordPkt(writer, pge_network::PgeNetworkStats::Direction::Tx, makePktMsgApp(0, { nMsgIdUpdate }, 20),
+            timeStart + std::chrono::milliseconds(20));
+        recordPkt(writer, pge_network::PgeNetworkStats::Direction::Rx, makePktMsgApp(5, { nMsgIdInput }, 30),
+            timeStart + std::chrono::milliseconds(30));
+
+        b &= assertEquals(4u, static_cast<uint32_t>(writer.getRecordCount()), "record count");
+        writer.close();
+        return b & assertFalse(writer.isOpen(), "open after close") & assertFalse(writer.hasWriteFailed(), "write failed");
+    }
+
+    bool test_writer_ctor()
+    {
+        pge_network::PgePacketCaptureWriter writer;
+
+        return assertFalse(writer.isOpen(), "open") &
+            assertTrue(writer.getFilename().empty(), "filename") &
+            assertEquals(0u, static_cast<uint32_t>(writer.getRecordCount()), "record count") &
+            assertEquals(0u, static_cast<uint32_t>(writer.getWrittenByteCount()), "written bytes") &
+            assertEquals(0u, writer.getStallCount(), "stall count") &
+            assertFalse(writer.hasWriteFailed(), "write failed");
+    }
+
+    bool test_writer_open()
+    {
+        pge_network::PgePacketCaptureWriter writer;
+
+        bool b = assertFalse(writer.open(szCaptureFilename, sizeof(pge_network::PgePacket)), "open small buffer");
+        b &= assertFalse(writer.isOpen(), "open 1");
+        b &= assertTrue(writer.open(szCaptureFilename), "open");
+        b &= assertTrue(writer.isOpen(), "open 2");
+        b &= assertEquals(std::string(szCaptureFilename), writer.getFilename(), "filename");
+        b &= assertFalse(writer.open(szCaptureFilename), "open again");
+        b &= assertEquals(
+            static_cast<uint32_t>(sizeof(pge_network::PgePacketCaptureFormat::FileHeader)),
+            static_cast<uint32_t>(writer.getWrittenByteCount()),
+            "written bytes");
+
+        writer.close();
+        b &= assertFalse(writer.isOpen(), "open 3");
+
+        // record() on closed writer does nothing
+        recordPkt(writer, pge_network::PgeNetworkStats::Direction::Rx, makePktMsgApp(1, { nMsgIdInput }, 1), std::chrono::steady_clock::now());
+        return b & assertEquals(0u, static_cast<uint32_t>(writer.getRecordCount()), "record count");
+    }
+
+    bool test_write_read()
+    {
+        bool b = writeSampleCapture();
+
+        pge_network::PgePacketCaptureReader reader;
+        b &= assertTrue(reader.open(szCaptureFilename), "open");
+
+        pge_network::PgePacketCaptureReader::Record rec;
+        const pge_network::PgePacket& pkt = rec.m_pkt;
+        b &= assertTrue(reader.readNext(rec), "read 1");
+        b &= assertEquals(0u, static_cast<uint32_t>(rec.m_nTimeUSecs / 1000), "time 1");
+        b &= assertEquals(5u, rec.m_connHandle, "conn 1");
+        b &= assertTrue(rec.m_dir == pge_network::PgeNetworkStats::Direction::Inject, "dir 1");
+        b &= assertTrue(pge_network::PgePktId::UserConnectedServerSelf == pge_network::PgePacket::getPacketId(pkt), "pkt id 1");
+        b &= assertEquals(std::string("192.168.1.5"),
+            std::string(pge_network::PgePacket::getMessageAsUserConnected(pkt).m_szIpAddress), "ip 1");
+
+        b &= assertTrue(reader.readNext(rec), "read 2");
+        b &= assertEquals(10u, static_cast<uint32_t>(rec.m_nTimeUSecs / 1000), "time 2");
+        b &= assertTrue(rec.m_dir == pge_network::PgeNetworkStats::Direction::Rx, "dir 2");
+        b &= assertEquals(3u, static_cast<uint32_t>(pge_network::PgePacket::getMessageAppCount(pkt)), "msg count 2");
+        b &= assertEquals(pge_network::PgePacket::getPktActualSizeBytes(pkt), static_cast<uint32_t>(rec.m_nPktSize), "size 2");
+
+        b &= assertTrue(reader.readNext(rec), "read 3");
+        b &= assertEquals(20u, static_cast<uint32_t>(rec.m_nTimeUSecs / 1000), "time 3");
+        b &= assertEquals(0u, rec.m_connHandle, "conn 3");
+        b &= assertTrue(rec.m_dir == pge_network::PgeNetworkStats::Direction::Tx, "dir 3");
+        b &= assertEquals(20u, getMsgAppValue(rec.m_pkt), "value 3");
+
+        b &= assertTrue(reader.readNext(rec), "read 4");
+        b &= assertEquals(30u, static_cast<uint32_t>(rec.m_nTimeUSecs / 1000), "time 4");
+        b &= assertEquals(30u, getMsgAppValue(rec.m_pkt), "value 4");
+
+        b &= assertFalse(reader.readNext(rec), "read 5");
+        b &= assertFalse(reader.isCorrupt(), "corrupt");
+        b &= assertEquals(4u, static_cast<uint32_t>(reader.getReadRecordCount()), "read count");
+
+        reader.rewind();
+        b &= assertTrue(reader.readNext(rec), "read 1 again");
+        b &= assertTrue(rec.m_dir == pge_network::PgeNetworkStats::Direction::Inject, "dir 1 again");
+        b &= assertEquals(1u, static_cast<uint32_t>(reader.getReadRecordCount()), "read count again");
+
+        reader.close();
+        return b & assertFalse(reader.isOpen(), "open after close") & assertFalse(reader.readNext(rec), "read after close");
+    }
+
+    bool test_write_read_SmallBuffer()
+    {
+        // buffer can hold only a few records, so buffers are handed over to the flush thread many times
+        constexpr uint32_t nRecords = 1000;
+        pge_network::PgePacketCaptureWriter writer;
+        bool b = assertTrue(writer.open(szCaptureFilename, 3 * sizeof(pge_network::PgePacket)), "open");
+
+        const pge_network::PgeNetworkStats::TimePoint timeStart = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < nRecords; i++)
+        {
+            recordPkt(writer, pge_network::PgeNetworkStats::Direction::Rx, makePktMsgApp(i, { nMsgIdInput }, i),
+                timeStart + std::chrono::microseconds(i));
+        }
+        writer.close();
+        b &= assertFalse(writer.hasWriteFailed(), "write failed");
+
+        pge_network::PgePacketCaptureReader reader;
+        b &= assertTrue(reader.open(szCaptureFilename), "reader open");
+        pge_network::PgePacketCaptureReader::Record rec;
+        uint32_t nRead = 0;
+        uint64_t nFirstTimeUSecs = 0;
+        bool bValuesOk = true;
+        while (reader.readNext(rec))
+        {
+            if (nRead == 0)
+            {
+                nFirstTimeUSecs = rec.m_nTimeUSecs;
+            }
+            bValuesOk &= (getMsgAppValue(rec.m_pkt) == nRead) && (rec.m_connHandle == nRead) && (rec.m_nTimeUSecs - nFirstTimeUSecs == nRead);
+            nRead++;
+        }
+
+        return b & assertEquals(nRecords, nRead, "read count") &
+            assertTrue(bValuesOk, "values") &
+            assertFalse(reader.isCorrupt(), "corrupt");
+    }
+
+    bool test_write_FlushInterval()
+    {
+        pge_network::PgePacketCaptureWriter writer;
+        bool b = assertTrue(writer.open(szCaptureFilename, pge_network::PgePacketCaptureWriter::nDefaultBufferSize, 10), "open");
+
+        const pge_network::PgeNetworkStats::TimePoint timeStart = std::chrono::steady_clock::now();
+        recordPkt(writer, pge_network::PgeNetworkStats::Direction::Rx, makePktMsgApp(1, { nMsgIdInput }, 1), timeStart);
+        const uint32_t nHeaderSize = static_cast<uint32_t>(sizeof(pge_network::PgePacketCaptureFormat::FileHeader));
+        b &= assertEquals(nHeaderSize, static_cast<uint32_t>(writer.getWrittenByteCount()), "written bytes 1");
+
+        // flush interval elapsed since open, so the buffer is handed over without being full
+        recordPkt(writer, pge_network::PgeNetworkStats::Direction::Rx, makePktMsgApp(1, { nMsgIdInput }, 2),
+            timeStart + std::chrono::milliseconds(20));
+        for (int i = 0; (i < 200) && (writer.getWrittenByteCount() == nHeaderSize); i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        b &= assertLess(nHeaderSize, static_cast<uint32_t>(writer.getWrittenByteCount()), "written bytes 2");
+
+        writer.close();
+        return b;
+    }
+
+    bool test_reader_open_Invalid()
+    {
+        pge_network::PgePacketCaptureReader reader;
+        std::remove(szCaptureFilename);
+        bool b = assertFalse(reader.open(szCaptureFilename), "open missing");
+
+        {
+            std::ofstream f(szCaptureFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+            f << "this is not a capture file at all";
+        }
+        b &= assertFalse(reader.open(szCaptureFilename), "open not capture");
+
+        b &= writeSampleCapture();
+        {
+            std::fstream f(szCaptureFilename, std::ios::in | std::ios::out | std::ios::binary);
+            const uint16_t nVersion = pge_network::PgePacketCaptureFormat::nVersion + 1;
+            f.seekp(4);
+            f.write(reinterpret_cast<const char*>(&nVersion), sizeof(nVersion));
+        }
+        b &= assertFalse(reader.open(szCaptureFilename), "open other version");
+
+        return b & assertFalse(reader.isOpen(), "is open");
+    }
+
+    bool test_reader_Truncated()
+    {
+        bool b = writeSampleCapture();
+
+        std::vector<char> vData;
+        {
+            std::ifstream f(szCaptureFilename, std::ios::in | std::ios::binary);
+            vData.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        }
+        {
+            std::ofstream f(szCaptureFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+            f.write(vData.data(), vData.size() - 3);
+        }
+
+        pge_network::PgePacketCaptureReader reader;
+        b &= assertTrue(reader.open(szCaptureFilename), "open");
+        pge_network::PgePacketCaptureReader::Record rec;
+        uint32_t nRead = 0;
+        while (reader.readNext(rec))
+        {
+            nRead++;
+        }
+
+        return b & assertEquals(3u, nRead, "read count") & assertTrue(reader.isCorrupt(), "corrupt");
+    }
+
+    bool test_replay_UnpacksBatchedMsgApps()
+    {
+        bool b = writeSampleCapture();
+
+        pge_network::PgePacketCaptureReader reader;
+        b &= assertTrue(reader.open(szCaptureFilename), "open");
+
+        std::vector<pge_network::PgePacket> vReplayed;
+        pge_network::PgePacketReplayer replayer;
+        b &= assertTrue(replayer.replay(
+            reader,
+            [&vReplayed](const pge_network::PgePacket& pkt) { vReplayed.push_back(pkt); return true; },
+            pge_network::PgePacketReplayer::Pacing::AsFastAsPossible),
+            "replay");
+
+        // inject + 3 unpacked + 1, tx is not replayed by default
+        b &= assertEquals(5u, static_cast<uint32_t>(vReplayed.size()), "replayed size");
+        b &= assertEquals(5u, static_cast<uint32_t>(replayer.getReplayedPktCount()), "replayed pkt count");
+        b &= assertEquals(3u, static_cast<uint32_t>(replayer.getReplayedRecordCount()), "replayed record count");
+        b &= assertEquals(0u, static_cast<uint32_t>(replayer.getSkippedRecordCount()), "skipped record count");
+        if (!b)
+        {
+            return false;
+        }
+
+        b &= assertTrue(pge_network::PgePktId::UserConnectedServerSelf == pge_network::PgePacket::getPacketId(vReplayed[0]), "pkt id 0");
+        const pge_network::MsgApp::TMsgId expectedMsgIds[] = { nMsgIdInput, nMsgIdInput, nMsgIdUpdate, nMsgIdInput };
+        const uint32_t expectedValues[] = { 10, 10, 10, 30 };
+        for (size_t i = 1; i < vReplayed.size(); i++)
+        {
+            const pge_network::PgePacket& pkt = vReplayed[i];
+            b &= assertEquals(1u, static_cast<uint32_t>(pge_network::PgePacket::getMessageAppCount(pkt)), "msg count");
+            b &= assertEquals(5u, pge_network::PgePacket::getServerSideConnectionHandle(pkt), "conn");
+            b &= assertEquals(static_cast<uint32_t>(expectedMsgIds[i - 1]),
+                static_cast<uint32_t>(pge_network::MsgApp::getMsgAppMsgId(*pge_network::PgePacket::getMsgAppFromPkt(pkt))), "msg id");
+            b &= assertEquals(expectedValues[i - 1], getMsgAppValue(pkt), "value");
+        }
+        return b;
+    }
+
+    bool test_replay_Directions()
+    {
+        bool b = writeSampleCapture();
+
+        pge_network::PgePacketCaptureReader reader;
+        b &= assertTrue(reader.open(szCaptureFilename), "open");
+
+        pge_network::PgePacketReplayer replayer;
+        b &= assertTrue(replayer.isDirectionEnabled(pge_network::PgeNetworkStats::Direction::Rx), "rx enabled");
+        b &= assertFalse(replayer.isDirectionEnabled(pge_network::PgeNetworkStats::Direction::Tx), "tx enabled");
+        b &= assertTrue(replayer.isDirectionEnabled(pge_network::PgeNetworkStats::Direction::Inject), "inject enabled");
+
+        replayer.setDirectionEnabled(pge_network::PgeNetworkStats::Direction::Rx, false);
+        replayer.setDirectionEnabled(pge_network::PgeNetworkStats::Direction::Tx, true);
+        replayer.setDirectionEnabled(pge_network::PgeNetworkStats::Direction::Inject, false);
+
+        uint32_t nValueSum = 0;
+        b &= assertTrue(replayer.replay(
+            reader,
+            [&nValueSum](const pge_network::PgePacket& pkt) { nValueSum += getMsgAppValue(pkt); return true; },
+            pge_network::PgePacketReplayer::Pacing::AsFastAsPossible),
+            "replay");
+
+        return b & assertEquals(1u, static_cast<uint32_t>(replayer.getReplayedPktCount()), "replayed pkt count") &
+            assertEquals(20u, nValueSum, "value sum");
+    }
+
+    bool test_replay_CallbackFails()
+    {
+        bool b = writeSampleCapture();
+
+        pge_network::PgePacketCaptureReader reader;
+        b &= assertTrue(reader.open(szCaptureFilename), "open");
+
+        uint32_t nCalls = 0;
+        pge_network::PgePacketReplayer replayer;
+        b &= assertFalse(replayer.replay(
+            reader,
+            [&nCalls](const pge_network::PgePacket&) { return ++nCalls < 3; },
+            pge_network::PgePacketReplayer::Pacing::AsFastAsPossible),
+            "replay");
+
+        return b & assertEquals(3u, nCalls, "calls");
+    }
+
+    bool test_replay_RecordedPacing()
+    {
+        bool b = writeSampleCapture();
+
+        pge_network::PgePacketCaptureReader reader;
+        b &= assertTrue(reader.open(szCaptureFilename), "open");
+
+        pge_network::PgePacketReplayer replayer;
+        std::vector<std::chrono::time_point<std::chrono::steady_clock>> vTimes;
+        b &= assertTrue(replayer.replay(
+            reader,
+            [&vTimes](const pge_network::PgePacket&) { vTimes.push_back(std::chrono::steady_clock::now()); return true; },
+            pge_network::PgePacketReplayer::Pacing::Recorded),
+            "replay");
+        if (!assertEquals(5u, static_cast<uint32_t>(vTimes.size()), "replayed size"))
+        {
+            return false;
+        }
+
+        // replayed records were recorded at 0, 10 and 30 ms
+        const auto nMillisecs2nd = std::chrono::duration_cast<std::chrono::milliseconds>(vTimes[1] - vTimes[0]).count();
+        const auto nMillisecsLast = std::chrono::duration_cast<std::chrono::milliseconds>(vTimes[4] - vTimes[0]).count();
+        return b & assertLequals(10, static_cast<int>(nMillisecs2nd), "2nd pkt time") &
+            assertLequals(30, static_cast<int>(nMillisecsLast), "last pkt time") &
+            assertLequals(30u, static_cast<uint32_t>(replayer.getReplayDurationUSecs() / 1000), "duration");
+    }
+
+    bool test_benchmark_record_replay()
+    {
+        constexpr uint32_t nPkts = 200000;
+        const pge_network::PgePacket pkt = makePktMsgApp(1, { nMsgIdInput, nMsgIdUpdate, nMsgIdUpdate, nMsgIdInput }, 42);
+        const uint32_t nPktSize = pge_network::PgePacket::getPktActualSizeBytes(pkt);
+
+        pge_network::PgePacketCaptureWriter writer;
+        bool b = assertTrue(writer.open(szCaptureFilename), "open");
+        const std::chrono::time_point<std::chrono::steady_clock> timeRecordStart = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < nPkts; i++)
+        {
+            writer.record(pge_network::PgeNetworkStats::Direction::Rx, 1, pkt, nPktSize, timeRecordStart + std::chrono::microseconds(i));
+        }
+        const auto durRecord = std::chrono::steady_clock::now() - timeRecordStart;
+        const uint32_t nStallCount = writer.getStallCount();
+        writer.close();
+
+        pge_network::PgePacketCaptureReader reader;
+        b &= assertTrue(reader.open(szCaptureFilename), "reader open");
+
+        uint32_t nMsgCount = 0;
+        pge_network::PgePacketReplayer replayer;
+        b &= assertTrue(replayer.replay(
+            reader,
+            [&nMsgCount](const pge_network::PgePacket&) { nMsgCount++; return true; },
+            pge_network::PgePacketReplayer::Pacing::AsFastAsPossible),
+            "replay");
+        b &= assertEquals(4 * nPkts, nMsgCount, "msg count");
+
+        const auto nRecordUSecs = std::chrono::duration_cast<std::chrono::microseconds>(durRecord).count();
+        const uint64_t nReplayUSecs = replayer.getReplayDurationUSecs();
+        CConsole::getConsoleInstance().OLn(
+            "PgePacketCaptureTest::%s(): %u pkts of %u bytes: record: %.2f Mpkt/s, %u stalls, replay: %.2f Mpkt/s, %.2f Mmsg/s",
+            __func__,
+            nPkts,
+            nPktSize,
+            (nRecordUSecs > 0) ? (nPkts / static_cast<double>(nRecordUSecs)) : 0.0,
+            nStallCount,
+            (nReplayUSecs > 0) ? (nPkts / static_cast<double>(nReplayUSecs)) : 0.0,
+            (nReplayUSecs > 0) ? (nMsgCount / static_cast<double>(nReplayUSecs)) : 0.0);
+
+        return b;
+    }
+
+}; // class PgePacketCaptureTest
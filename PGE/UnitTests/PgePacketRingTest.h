@@ -0,0 +1,264 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgePacketRingTest.h
+    Unit test for PgePacketRing.
+    Made by PR00F88, West Whiskhyll Entertainment
+    2026
+    ###################################################################################
+*/
+
+#include "UnitTest.h"  // PCH
+
+#include "../Network/PgePacketRing.h"
+
+#include <stdexcept>
+
+class PgePacketRingTest :
+    public UnitTest
+{
+public:
+
+    PgePacketRingTest() :
+        UnitTest(__FILE__)
+    {
+    }
+
+protected:
+
+    virtual void initialize() override
+    {
+        addSubTest("test_ctor", (PFNUNITSUBTEST)&PgePacketRingTest::test_ctor);
+        addSubTest("test_reserve_Bad", (PFNUNITSUBTEST)&PgePacketRingTest::test_reserve_Bad);
+        addSubTest("test_reserve_RoundsUpToPowerOfTwo", (PFNUNITSUBTEST)&PgePacketRingTest::test_reserve_RoundsUpToPowerOfTwo);
+        addSubTest("test_reserve_SameCapacityKeepsPackets", (PFNUNITSUBTEST)&PgePacketRingTest::test_reserve_SameCapacityKeepsPackets);
+        addSubTest("test_pushBack_and_borrowFront_and_releaseFront", (PFNUNITSUBTEST)&PgePacketRingTest::test_pushBack_and_borrowFront_and_releaseFront);
+        addSubTest("test_borrowFront_Empty", (PFNUNITSUBTEST)&PgePacketRingTest::test_borrowFront_Empty);
+        addSubTest("test_beginPushBack_without_endPushBack", (PFNUNITSUBTEST)&PgePacketRingTest::test_beginPushBack_without_endPushBack);
+        addSubTest("test_wrapAround", (PFNUNITSUBTEST)&PgePacketRingTest::test_wrapAround);
+        addSubTest("test_overflow", (PFNUNITSUBTEST)&PgePacketRingTest::test_overflow);
+        addSubTest("test_clear", (PFNUNITSUBTEST)&PgePacketRingTest::test_clear);
+        addSubTest("test_resetCounters", (PFNUNITSUBTEST)&PgePacketRingTest::test_resetCounters);
+    }
+
+private:
+
+    // ---------------------------------------------------------------------------
+
+    PgePacketRingTest(const PgePacketRingTest&)
+    {};
+
+    PgePacketRingTest& operator=(const PgePacketRingTest&)
+    {
+        return *this;
+    };
+
+    static pge_network::PgePacket makePkt(const pge_network::PgeNetworkConnectionHandle& connHandle)
+    {
+        pge_network::PgePacket pkt;
+        pge_network::PgePacket::initPktPgeMsgUserDisconnected(pkt, connHandle);
+        return pkt;
+    }
+
+    bool pushBackPkts(pge_network::PgePacketRing& ring, const pge_network::PgeNetworkConnectionHandle& connHandleFirst, size_t nCount)
+    {
+        bool b = true;
+        for (size_t i = 0; i < nCount; i++)
+        {
+            b &= assertTrue(
+                ring.pushBack(makePkt(connHandleFirst + static_cast<pge_network::PgeNetworkConnectionHandle>(i))),
+                ("pushBack " + std::to_string(i)).c_str());
+        }
+        return b;
+    }
+
+    bool assertFrontAndRelease(pge_network::PgePacketRing& ring, const pge_network::PgeNetworkConnectionHandle& connHandleExpected, const char* szText)
+    {
+        bool b = assertFalse(ring.empty(), (std::string("not empty, ") + szText).c_str());
+        if (b)
+        {
+            b &= assertEquals(
+                connHandleExpected,
+                pge_network::PgePacket::getServerSideConnectionHandle(ring.borrowFront()),
+                (std::string("front, ") + szText).c_str());
+            ring.releaseFront();
+        }
+        return b;
+    }
+
+    bool test_ctor()
+    {
+        pge_network::PgePacketRing ring;
+
+        return assertEquals(0u, ring.capacity(), "capacity") &
+            assertEquals(0u, ring.size(), "size") &
+            assertTrue(ring.empty(), "empty") &
+            assertTrue(ring.full(), "full") &
+            assertFalse(ring.isFrontBorrowed(), "borrowed") &
+            assertEquals(0u, ring.getDroppedCount(), "dropped") &
+            assertEquals(0u, ring.getHighWaterMark(), "high water mark") &
+            assertNull(ring.beginPushBack(), "beginPushBack") &
+            assertEquals(1u, ring.getDroppedCount(), "dropped 2");
+    }
+
+    bool test_reserve_Bad()
+    {
+        pge_network::PgePacketRing ring;
+
+        return assertFalse(ring.reserve(0), "reserve 0") &
+            assertFalse(ring.reserve(pge_network::PgePacketRing::nMaxCapacity + 1), "reserve too big") &
+            assertEquals(0u, ring.capacity(), "capacity");
+    }
+
+    bool test_reserve_RoundsUpToPowerOfTwo()
+    {
+        pge_network::PgePacketRing ring;
+
+        bool b = assertTrue(ring.reserve(1), "reserve 1") & assertEquals(1u, ring.capacity(), "capacity 1");
+        b &= assertTrue(ring.reserve(5), "reserve 5") & assertEquals(8u, ring.capacity(), "capacity 8");
+        b &= assertTrue(ring.reserve(16), "reserve 16") & assertEquals(16u, ring.capacity(), "capacity 16");
+        b &= assertTrue(ring.reserve(pge_network::PgePacketRing::nMaxCapacity), "reserve max") &
+            assertEquals(pge_network::PgePacketRing::nMaxCapacity, ring.capacity(), "capacity max");
+
+        return b & assertTrue(ring.empty(), "empty");
+    }
+
+    bool test_reserve_SameCapacityKeepsPackets()
+    {
+        pge_network::PgePacketRing ring;
+
+        bool b = assertTrue(ring.reserve(4), "reserve 4");
+        b &= pushBackPkts(ring, 10, 3);
+        b &= assertTrue(ring.reserve(3), "reserve 3") & assertEquals(3u, ring.size(), "size after same capacity");
+        b &= assertTrue(ring.reserve(5), "reserve 5") & assertEquals(0u, ring.size(), "size after different capacity");
+
+        b &= pushBackPkts(ring, 10, 1);
+        ring.borrowFront();
+        return b & assertFalse(ring.reserve(16), "reserve while borrowed") & assertEquals(8u, ring.capacity(), "capacity");
+    }
+
+    bool test_pushBack_and_borrowFront_and_releaseFront()
+    {
+        pge_network::PgePacketRing ring;
+
+        bool b = assertTrue(ring.reserve(4), "reserve");
+        b &= pushBackPkts(ring, 10, 3);
+        b &= assertEquals(3u, ring.size(), "size 1") & assertEquals(3u, ring.getHighWaterMark(), "high water mark 1");
+
+        const pge_network::PgePacket& pkt = ring.borrowFront();
+        b &= assertTrue(ring.isFrontBorrowed(), "borrowed 1");
+        b &= assertEquals(&pkt, &ring.borrowFront(), "borrow again gives same pkt");
+        b &= assertFrontAndRelease(ring, 10, "1");
+        b &= assertFalse(ring.isFrontBorrowed(), "borrowed 2");
+        b &= assertFrontAndRelease(ring, 11, "2");
+        b &= assertFrontAndRelease(ring, 12, "3");
+
+        ring.releaseFront();  // no effect on empty ring
+        return b & assertTrue(ring.empty(), "empty") & assertEquals(3u, ring.getHighWaterMark(), "high water mark 2");
+    }
+
+    bool test_borrowFront_Empty()
+    {
+        pge_network::PgePacketRing ring;
+        ring.reserve(4);
+
+        try
+        {
+            ring.borrowFront();
+        }
+        catch (const std::runtime_error&)
+        {
+            return assertFalse(ring.isFrontBorrowed(), "borrowed");
+        }
+
+        return assertFalse(true, "no exception");
+    }
+
+    bool test_beginPushBack_without_endPushBack()
+    {
+        pge_network::PgePacketRing ring;
+
+        bool b = assertTrue(ring.reserve(4), "reserve");
+        pge_network::PgePacket* const pSlot = ring.beginPushBack();
+        b &= assertNotNull(pSlot, "slot 1");
+        if (!b)
+        {
+            return false;
+        }
+
+        *pSlot = makePkt(10);
+        b &= assertEquals(0u, ring.size(), "size 1");
+        b &= assertEquals(pSlot, ring.beginPushBack(), "abandoned slot is returned again");
+
+        *pSlot = makePkt(11);
+        ring.endPushBack();
+        ring.endPushBack();  // no effect without beginPushBack()
+        b &= assertEquals(1u, ring.size(), "size 2");
+
+        return b & assertFrontAndRelease(ring, 11, "1");
+    }
+
+    bool test_wrapAround()
+    {
+        pge_network::PgePacketRing ring;
+
+        bool b = assertTrue(ring.reserve(4), "reserve");
+        for (pge_network::PgeNetworkConnectionHandle i = 0; i < 10; i++)
+        {
+            b &= pushBackPkts(ring, i * 10, 3);
+            b &= assertFrontAndRelease(ring, i * 10, ("round " + std::to_string(i) + " 1").c_str());
+            b &= assertFrontAndRelease(ring, i * 10 + 1, ("round " + std::to_string(i) + " 2").c_str());
+            b &= assertFrontAndRelease(ring, i * 10 + 2, ("round " + std::to_string(i) + " 3").c_str());
+        }
+
+        return b & assertTrue(ring.empty(), "empty") & assertEquals(0u, ring.getDroppedCount(), "dropped");
+    }
+
+    bool test_overflow()
+    {
+        pge_network::PgePacketRing ring;
+
+        bool b = assertTrue(ring.reserve(2), "reserve");
+        b &= pushBackPkts(ring, 10, 2);
+        b &= assertTrue(ring.full(), "full");
+        b &= assertFalse(ring.pushBack(makePkt(12)), "pushBack when full");
+        b &= assertNull(ring.beginPushBack(), "beginPushBack when full");
+        b &= assertEquals(2u, ring.getDroppedCount(), "dropped");
+        b &= assertEquals(2u, ring.size(), "size");
+
+        return b & assertFrontAndRelease(ring, 10, "1") & assertFrontAndRelease(ring, 11, "2");
+    }
+
+    bool test_clear()
+    {
+        pge_network::PgePacketRing ring;
+
+        bool b = assertTrue(ring.reserve(2), "reserve");
+        b &= pushBackPkts(ring, 10, 2);
+        ring.pushBack(makePkt(12));
+        ring.borrowFront();
+        ring.clear();
+
+        return b & assertTrue(ring.empty(), "empty") &
+            assertFalse(ring.isFrontBorrowed(), "borrowed") &
+            assertEquals(2u, ring.capacity(), "capacity") &
+            assertEquals(1u, ring.getDroppedCount(), "dropped") &
+            assertEquals(2u, ring.getHighWaterMark(), "high water mark");
+    }
+
+    bool test_resetCounters()
+    {
+        pge_network::PgePacketRing ring;
+
+        bool b = assertTrue(ring.reserve(2), "reserve");
+        b &= pushBackPkts(ring, 10, 2);
+        ring.pushBack(makePkt(12));
+        ring.releaseFront();
+        ring.resetCounters();
+
+        return b & assertEquals(0u, ring.getDroppedCount(), "dropped") &
+            assertEquals(1u, ring.getHighWaterMark(), "high water mark");
+    }
+
+};
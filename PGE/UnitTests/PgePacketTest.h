@@ -59,6 +59,10 @@ protected:
         addSubTest(
             "test_preparePktMsgAppFill_Bad_MaxMessageCountReached",
             (PFNUNITSUBTEST)&PgePacketTest::test_preparePktMsgAppFill_Bad_MaxMessageCountReached);
+        addSubTest("test_addPktMsgApp_Good_MultipleMsgApps", (PFNUNITSUBTEST)&PgePacketTest::test_addPktMsgApp_Good_MultipleMsgApps);
+        addSubTest("test_preparePktMsgAppFill_Good_MultipleMsgApps", (PFNUNITSUBTEST)&PgePacketTest::test_preparePktMsgAppFill_Good_MultipleMsgApps);
+        addSubTest("test_preparePktMsgAppFill_Bad_MsgAppAreaBecomesFull", (PFNUNITSUBTEST)&PgePacketTest::test_preparePktMsgAppFill_Bad_MsgAppAreaBecomesFull);
+        addSubTest("test_getPktActualSizeBytes", (PFNUNITSUBTEST)&PgePacketTest::test_getPktActualSizeBytes);
     }
 
 private:
@@ -562,4 +566,174 @@ private:
         return assertNull(pge_network::PgePacket::preparePktMsgAppFill(pkt, msgAppMsgId, 10u), "prepare msg app 1");
     }
 
+    bool test_addPktMsgApp_Good_MultipleMsgApps()
+    {
+        constexpr pge_network::PgeNetworkConnectionHandle connHandle = 5u;
+        constexpr pge_network::MsgApp::TMsgId msgAppMsgId1 = 23u;
+        constexpr pge_network::MsgApp::TMsgId msgAppMsgId2 = 42u;
+        constexpr char msgAppMsgData1[] = "almafa";
+        constexpr char msgAppMsgData2[] = "kortefa2";
+
+        pge_network::PgePacket pkt;
+        pge_network::PgePacket::initPktMsgApp(pkt, connHandle);
+
+        pge_network::MsgApp myAppMsg1;
+        pge_network::MsgApp myAppMsg2;
+        bool b = assertTrue(
+            pge_network::MsgApp::fillMsgApp(
+                myAppMsg1,
+                msgAppMsgId1,
+                reinterpret_cast<const pge_network::TByte*>(msgAppMsgData1),
+                sizeof(msgAppMsgData1)),
+            "fill msg app 1");
+        b &= assertTrue(
+            pge_network::MsgApp::fillMsgApp(
+                myAppMsg2,
+                msgAppMsgId2,
+                reinterpret_cast<const pge_network::TByte*>(msgAppMsgData2),
+                sizeof(msgAppMsgData2)),
+            "fill msg app 2");
+
+        b &= assertTrue(pge_network::PgePacket::addPktMsgApp(pkt, myAppMsg1), "add msg app 1");
+        b &= assertTrue(pge_network::PgePacket::addPktMsgApp(pkt, myAppMsg2), "add msg app 2");
+
+        const pge_network::MsgApp* const pMsgApp1 = pge_network::PgePacket::getMsgAppFromPkt(pkt);
+        const pge_network::MsgApp* const pMsgApp2 = pge_network::PgePacket::getNextMsgAppFromPkt(pkt, *pMsgApp1);
+        b &= assertNotNull(pMsgApp2, "msg app 2 not null");
+        if (!b)
+        {
+            return false;
+        }
+
+        return b &
+            assertEquals(2u, static_cast<uint32_t>(pge_network::PgePacket::getMessageAppCount(pkt)), "msg app count") &
+            assertEquals(
+                static_cast<uint32_t>(pge_network::MsgApp::getMsgAppTotalActualSizeBytes(myAppMsg1) + pge_network::MsgApp::getMsgAppTotalActualSizeBytes(myAppMsg2)),
+                static_cast<uint32_t>(pge_network::PgePacket::getMessageAppsTotalActualLengthBytes(pkt)),
+                "msg apps total length") &
+            assertEquals(
+                reinterpret_cast<const pge_network::TByte*>(pMsgApp1) + pge_network::MsgApp::getMsgAppTotalActualSizeBytes(myAppMsg1),
+                reinterpret_cast<const pge_network::TByte*>(pMsgApp2),
+                "msg app 2 is right after msg app 1") &
+            assertEquals(
+                0,
+                memcmp(pMsgApp1, &myAppMsg1, pge_network::MsgApp::getMsgAppTotalActualSizeBytes(myAppMsg1)),
+                "pkt msg app 1 ok") &
+            assertEquals(
+                0,
+                memcmp(pMsgApp2, &myAppMsg2, pge_network::MsgApp::getMsgAppTotalActualSizeBytes(myAppMsg2)),
+                "pkt msg app 2 ok") &
+            assertNull(pge_network::PgePacket::getNextMsgAppFromPkt(pkt, *pMsgApp2), "no msg app after msg app 2");
+    }
+
+    bool test_preparePktMsgAppFill_Good_MultipleMsgApps()
+    {
+        constexpr pge_network::PgeNetworkConnectionHandle connHandle = 5u;
+        constexpr pge_network::MsgApp::TMsgId msgAppMsgId1 = 23u;
+        constexpr pge_network::MsgApp::TMsgId msgAppMsgId2 = 42u;
+        constexpr char msgAppMsgData1[] = "almafa";
+        constexpr char msgAppMsgData2[] = "kortefa2";
+
+        pge_network::PgePacket pkt;
+        pge_network::PgePacket::initPktMsgApp(pkt, connHandle);
+
+        pge_network::TByte* const pMsgAppData1 =
+            pge_network::PgePacket::preparePktMsgAppFill(pkt, msgAppMsgId1, sizeof(msgAppMsgData1));
+        bool b = assertNotNull(pMsgAppData1, "prepare msg app 1");
+        if (b)
+        {
+            memcpy(pMsgAppData1, msgAppMsgData1, sizeof(msgAppMsgData1));
+        }
+
+        pge_network::TByte* const pMsgAppData2 =
+            pge_network::PgePacket::preparePktMsgAppFill(pkt, msgAppMsgId2, sizeof(msgAppMsgData2));
+        b &= assertNotNull(pMsgAppData2, "prepare msg app 2");
+        if (b)
+        {
+            memcpy(pMsgAppData2, msgAppMsgData2, sizeof(msgAppMsgData2));
+        }
+
+        if (!b)
+        {
+            return false;
+        }
+
+        // writing the 2nd msg app data shall not overwrite the 1st msg app
+        const pge_network::MsgApp* const pMsgApp1 = pge_network::PgePacket::getMsgAppFromPkt(pkt);
+        const pge_network::MsgApp* const pMsgApp2 = pge_network::PgePacket::getNextMsgAppFromPkt(pkt, *pMsgApp1);
+        b &= assertNotNull(pMsgApp2, "msg app 2 not null");
+        if (!b)
+        {
+            return false;
+        }
+
+        return b &
+            assertEquals(2u, static_cast<uint32_t>(pge_network::PgePacket::getMessageAppCount(pkt)), "msg app count") &
+            assertEquals(msgAppMsgId1, pge_network::MsgApp::getMsgAppMsgId(*pMsgApp1), "msg app id 1") &
+            assertEquals(msgAppMsgId2, pge_network::MsgApp::getMsgAppMsgId(*pMsgApp2), "msg app id 2") &
+            assertEquals(pge_network::MsgApp::getMsgAppDataActualSizeBytes(*pMsgApp1), sizeof(msgAppMsgData1), "msg app data size 1") &
+            assertEquals(pge_network::MsgApp::getMsgAppDataActualSizeBytes(*pMsgApp2), sizeof(msgAppMsgData2), "msg app data size 2") &
+            assertEquals(
+                static_cast<uint32_t>(pge_network::MsgApp::getMsgAppTotalActualSizeBytes(*pMsgApp1) + pge_network::MsgApp::getMsgAppTotalActualSizeBytes(*pMsgApp2)),
+                static_cast<uint32_t>(pge_network::PgePacket::getMessageAppsTotalActualLengthBytes(pkt)),
+                "msg apps total length") &
+            assertEquals(0, memcmp(msgAppMsgData1, pge_network::MsgApp::getMsgAppData(*pMsgApp1), sizeof(msgAppMsgData1)), "pkt msg app data 1 ok") &
+            assertEquals(0, memcmp(msgAppMsgData2, pge_network::MsgApp::getMsgAppData(*pMsgApp2), sizeof(msgAppMsgData2)), "pkt msg app data 2 ok") &
+            assertNull(pge_network::PgePacket::getNextMsgAppFromPkt(pkt, *pMsgApp2), "no msg app after msg app 2");
+    }
+
+    bool test_preparePktMsgAppFill_Bad_MsgAppAreaBecomesFull()
+    {
+        constexpr pge_network::PgeNetworkConnectionHandle connHandle = 5u;
+        constexpr pge_network::MsgApp::TMsgId msgAppMsgId = 23u;
+        constexpr pge_network::MsgApp::TMsgSize nMsgAppDataSize = 100u;
+
+        pge_network::PgePacket pkt;
+        pge_network::PgePacket::initPktMsgApp(pkt, connHandle);
+
+        // 2 msg apps of this size fit into the area, the 3rd does not
+        bool b = assertNotNull(pge_network::PgePacket::preparePktMsgAppFill(pkt, msgAppMsgId, nMsgAppDataSize), "prepare msg app 1");
+        b &= assertNotNull(pge_network::PgePacket::preparePktMsgAppFill(pkt, msgAppMsgId, nMsgAppDataSize), "prepare msg app 2");
+        b &= assertNull(pge_network::PgePacket::preparePktMsgAppFill(pkt, msgAppMsgId, nMsgAppDataSize), "prepare msg app 3");
+
+        return b &
+            assertEquals(2u, static_cast<uint32_t>(pge_network::PgePacket::getMessageAppCount(pkt)), "msg app count") &
+            assertEquals(
+                static_cast<uint32_t>(2 * (offsetof(pge_network::MsgApp, m_cMsgData) + nMsgAppDataSize)),
+                static_cast<uint32_t>(pge_network::PgePacket::getMessageAppsTotalActualLengthBytes(pkt)),
+                "msg apps total length");
+    }
+
+    bool test_getPktActualSizeBytes()
+    {
+        constexpr pge_network::PgeNetworkConnectionHandle connHandle = 5u;
+        constexpr pge_network::MsgApp::TMsgId msgAppMsgId = 23u;
+        constexpr pge_network::MsgApp::TMsgSize nMsgAppDataSize = 10u;
+
+        pge_network::PgePacket pktUserDisconnected;
+        pge_network::PgePacket::initPktPgeMsgUserDisconnected(pktUserDisconnected, connHandle);
+
+        pge_network::PgePacket pkt;
+        pge_network::PgePacket::initPktMsgApp(pkt, connHandle);
+        const uint32_t nEmptyPktSize = pge_network::PgePacket::getPktActualSizeBytes(pkt);
+
+        bool b = assertEquals(static_cast<uint32_t>(sizeof(pktUserDisconnected)), pge_network::PgePacket::getPktActualSizeBytes(pktUserDisconnected), "non-app pkt") &
+            assertEquals(
+                static_cast<uint32_t>(offsetof(pge_network::PgePacket, m_msg.m_app) + offsetof(pge_network::MsgAppArea, m_cData)),
+                nEmptyPktSize,
+                "empty app pkt");
+
+        b &= assertNotNull(pge_network::PgePacket::preparePktMsgAppFill(pkt, msgAppMsgId, nMsgAppDataSize), "prepare msg app 1");
+        b &= assertEquals(
+            static_cast<uint32_t>(nEmptyPktSize + offsetof(pge_network::MsgApp, m_cMsgData) + nMsgAppDataSize),
+            pge_network::PgePacket::getPktActualSizeBytes(pkt),
+            "app pkt with 1 msg app");
+
+        b &= assertNotNull(pge_network::PgePacket::preparePktMsgAppFill(pkt, msgAppMsgId, nMsgAppDataSize), "prepare msg app 2");
+        return b & assertEquals(
+            static_cast<uint32_t>(nEmptyPktSize + 2 * (offsetof(pge_network::MsgApp, m_cMsgData) + nMsgAppDataSize)),
+            pge_network::PgePacket::getPktActualSizeBytes(pkt),
+            "app pkt with 2 msg apps");
+    }
+
 };
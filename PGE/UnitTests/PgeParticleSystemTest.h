@@ -0,0 +1,426 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeParticleSystemTest.h
+    Unit test for ParticleSystem.
+    Made by PR00F88, West Whiskhyll Entertainment
+    2026
+    ###################################################################################
+*/
+
+#include "UnitTest.h"  // PCH
+
+#include "../Weapons/ParticleSystem.h"
+
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+class PgeParticleSystemTest :
+    public UnitTest
+{
+public:
+
+    PgeParticleSystemTest() :
+        UnitTest(__FILE__)
+    {
+        engine = NULL;
+    }
+
+    PgeParticleSystemTest(const PgeParticleSystemTest&) = delete;
+    PgeParticleSystemTest& operator=(const PgeParticleSystemTest&) = delete;
+    PgeParticleSystemTest(PgeParticleSystemTest&&) = delete;
+    PgeParticleSystemTest&& operator=(PgeParticleSystemTest&&) = delete;
+
+protected:
+
+    virtual void initialize() override
+    {
+        PGEInputHandler& inputHandler = PGEInputHandler::createAndGet(cfgProfiles);
+
+        // graphics is intentionally not initialized, same as in headless mode of PGE: particles are benchmarked without rendering
+        engine = &PR00FsUltimateRenderingEngine::createAndGet(cfgProfiles, inputHandler);
+
+        Bullet::resetGlobalBulletId();
+
+        addSubTest("test_ctor", (PFNUNITSUBTEST)&PgeParticleSystemTest::test_ctor);
+        addSubTest("test_ctor_InvalidArgs", (PFNUNITSUBTEST)&PgeParticleSystemTest::test_ctor_InvalidArgs);
+        addSubTest("test_addEmitter_removeEmitter", (PFNUNITSUBTEST)&PgeParticleSystemTest::test_addEmitter_removeEmitter);
+        addSubTest("test_addEmitter_InvalidArgs", (PFNUNITSUBTEST)&PgeParticleSystemTest::test_addEmitter_InvalidArgs);
+        addSubTest("test_emit_respects_budgets_and_capacity", (PFNUNITSUBTEST)&PgeParticleSystemTest::test_emit_respects_budgets_and_capacity);
+        addSubTest("test_emit_is_deterministic", (PFNUNITSUBTEST)&PgeParticleSystemTest::test_emit_is_deterministic);
+        addSubTest("test_update_moves_fades_and_expires", (PFNUNITSUBTEST)&PgeParticleSystemTest::test_update_moves_fades_and_expires);
+        addSubTest("test_emitBulletTrails", (PFNUNITSUBTEST)&PgeParticleSystemTest::test_emitBulletTrails);
+        addSubTest("test_buildVertices_batches_by_texture", (PFNUNITSUBTEST)&PgeParticleSystemTest::test_buildVertices_batches_by_texture);
+        addSubTest("test_benchmark_update", (PFNUNITSUBTEST)&PgeParticleSystemTest::test_benchmark_update);
+    }
+
+    virtual bool setUp() override
+    {
+        return assertTrue(engine && !engine->isInitialized());
+    }
+
+    virtual void tearDown() override
+    {
+        Bullet::resetGlobalBulletId();
+    }
+
+    virtual void finalize() override
+    {
+        Bullet::destroyReferenceObject();
+        if (engine)
+        {
+            engine->shutdown();
+            engine = NULL;
+        }
+    }
+
+private:
+
+    PR00FsUltimateRenderingEngine* engine;
+    PGEcfgProfiles cfgProfiles;
+
+    // ---------------------------------------------------------------------------
+
+    // textures are only compared by ParticleSystem, never dereferenced, so any distinct addresses do
+    static const PureTexture* fakeTexture(const int& i)
+    {
+        static char textures[2];
+        return reinterpret_cast<const PureTexture*>(&textures[i]);
+    }
+
+    static ParticleSystem::EmitterDesc makeDesc(
+        const PureTexture* pTexture,
+        uint32_t nMaxAlive,
+        uint32_t nMaxSpawnPerUpdate,
+        float fLifetime)
+    {
+        ParticleSystem::EmitterDesc desc{};
+        desc.m_pTexture = pTexture;
+        desc.m_nMaxAlive = nMaxAlive;
+        desc.m_nMaxSpawnPerUpdate = nMaxSpawnPerUpdate;
+        desc.m_nEmitPerNthPhysicsIteration = 2;
+        desc.m_nMaxParticlesPerBullet = 3;
+        desc.m_fLifetime = fLifetime;
+        desc.m_fSize = 2.f;
+        desc.m_fSpeed = 1.f;
+        desc.m_fGravity = 0.5f;
+        desc.m_color[0] = 1.f;
+        desc.m_color[1] = 0.5f;
+        desc.m_color[2] = 0.25f;
+        desc.m_color[3] = 0.8f;
+        return desc;
+    }
+
+    PooledBullet* createBullet(PgeObjectPool<PooledBullet>& bullets, const Bullet::ParticleType& particleType)
+    {
+        return bullets.create(
+            static_cast<WeaponId>(123u),
+            *engine,
+            static_cast<pge_network::PgeNetworkConnectionHandle>(0u),
+            0.f, 0.f, 0.f,
+            0.f, 90.f, 0.f,
+            false /* visible */,
+            1.f, 1.f, 1.f,
+            1.f, 0.f, 0.f, false /* fragile */,
+            0.f /* fDistMax */,
+            particleType,
+            5 /* AP */, 10 /* HP */,
+            0.f, Bullet::DamageAreaEffect::Constant, 0.f);
+    }
+
+    bool test_ctor()
+    {
+        const ParticleSystem ps(10);
+
+        return assertEquals(static_cast<std::size_t>(10), ps.getCapacity(), "capacity") &
+            assertEquals(static_cast<std::size_t>(0), ps.getParticleCount(), "particles") &
+            assertEquals(static_cast<std::size_t>(0), ps.getDroppedCount(), "dropped") &
+            assertEquals(static_cast<std::size_t>(0), ps.getEmitterCount(), "emitters") &
+            assertTrue(ps.getVertices().empty(), "vertices") &
+            assertTrue(ps.getBatches().empty(), "batches");
+    }
+
+    bool test_ctor_InvalidArgs()
+    {
+        try
+        {
+            const ParticleSystem ps(0);
+        }
+        catch (const std::exception&)
+        {
+            return true;
+        }
+
+        return assertTrue(false, "no exception");
+    }
+
+    bool test_addEmitter_removeEmitter()
+    {
+        ParticleSystem ps(10);
+
+        const ParticleSystem::EmitterId id0 = ps.addEmitter(makeDesc(nullptr, 10, 10, 5.f));
+        const ParticleSystem::EmitterId id1 = ps.addEmitter(makeDesc(fakeTexture(0), 10, 10, 5.f));
+        bool b = assertNotEquals(id0, id1, "ids");
+        b &= assertEquals(static_cast<std::size_t>(2), ps.getEmitterCount(), "emitters 1");
+        b &= assertTrue(fakeTexture(0) == ps.getEmitterDesc(id1).m_pTexture, "desc");
+
+        b &= assertEquals(static_cast<std::size_t>(3), ps.emit(id0, PureVector(), 3), "emit 0");
+        b &= assertEquals(static_cast<std::size_t>(2), ps.emit(id1, PureVector(), 2), "emit 1");
+
+        // particles of the removed emitter are removed too
+        ps.removeEmitter(id0);
+        b &= assertEquals(static_cast<std::size_t>(1), ps.getEmitterCount(), "emitters 2");
+        b &= assertEquals(static_cast<std::size_t>(2), ps.getParticleCount(), "particles");
+        b &= assertEquals(static_cast<std::size_t>(0), ps.getParticleCount(id0), "particles 0");
+        b &= assertEquals(static_cast<std::size_t>(2), ps.getParticleCount(id1), "particles 1");
+        b &= assertEquals(static_cast<std::size_t>(0), ps.emit(id0, PureVector(), 1), "emit removed");
+
+        // slot of removed emitter is reused
+        b &= assertEquals(id0, ps.addEmitter(makeDesc(nullptr, 10, 10, 5.f)), "reused id");
+        b &= assertEquals(static_cast<std::size_t>(2), ps.getEmitterCount(), "emitters 3");
+
+        return b;
+    }
+
+    bool test_addEmitter_InvalidArgs()
+    {
+        ParticleSystem ps(10);
+        bool b = true;
+
+        try
+        {
+            ps.addEmitter(makeDesc(nullptr, 10, 10, 0.f));
+            b &= assertTrue(false, "no exception for lifetime");
+        }
+        catch (const std::exception&) {}
+
+        try
+        {
+            ParticleSystem::EmitterDesc desc = makeDesc(nullptr, 10, 10, 5.f);
+            desc.m_nEmitPerNthPhysicsIteration = 0;
+            ps.addEmitter(desc);
+            b &= assertTrue(false, "no exception for emit per nth");
+        }
+        catch (const std::exception&) {}
+
+        return b & assertEquals(static_cast<std::size_t>(0), ps.getEmitterCount(), "emitters");
+    }
+
+    bool test_emit_respects_budgets_and_capacity()
+    {
+        ParticleSystem ps(10);
+        const ParticleSystem::EmitterId id0 = ps.addEmitter(makeDesc(nullptr, 5 /* alive */, 3 /* spawn */, 4.f));
+        const ParticleSystem::EmitterId id1 = ps.addEmitter(makeDesc(nullptr, 100, 100, 4.f));
+
+        // spawn budget
+        bool b = assertEquals(static_cast<std::size_t>(3), ps.emit(id0, PureVector(1.f, 2.f, 3.f), 5), "emit 1");
+        b &= assertEquals(static_cast<std::size_t>(2), ps.getDroppedCount(), "dropped 1");
+
+        // spawn budget is reset by Update(), alive budget still limits
+        ps.Update(1);
+        b &= assertEquals(static_cast<std::size_t>(2), ps.emit(id0, PureVector(1.f, 2.f, 3.f), 5), "emit 2");
+        b &= assertEquals(static_cast<std::size_t>(5), ps.getParticleCount(id0), "particles 0");
+        b &= assertEquals(static_cast<std::size_t>(5), ps.getDroppedCount(), "dropped 2");
+
+        // capacity of the system
+        b &= assertEquals(static_cast<std::size_t>(5), ps.emit(id1, PureVector(), 10), "emit 3");
+        b &= assertEquals(static_cast<std::size_t>(10), ps.getParticleCount(), "particles");
+        b &= assertEquals(static_cast<std::size_t>(10), ps.getDroppedCount(), "dropped 3");
+
+        ps.clear();
+        b &= assertEquals(static_cast<std::size_t>(0), ps.getParticleCount(), "particles cleared");
+        b &= assertEquals(static_cast<std::size_t>(0), ps.getParticleCount(id0), "particles 0 cleared");
+        b &= assertEquals(static_cast<std::size_t>(0), ps.getDroppedCount(), "dropped cleared");
+        b &= assertEquals(static_cast<std::size_t>(2), ps.getEmitterCount(), "emitters kept");
+
+        return b;
+    }
+
+    bool test_emit_is_deterministic()
+    {
+        ParticleSystem ps1(8);
+        ParticleSystem ps2(8);
+        const ParticleSystem::EmitterId id1 = ps1.addEmitter(makeDesc(nullptr, 8, 8, 10.f));
+        const ParticleSystem::EmitterId id2 = ps2.addEmitter(makeDesc(nullptr, 8, 8, 10.f));
+        ps1.emit(id1, PureVector(), 8);
+        ps2.emit(id2, PureVector(), 8);
+        ps1.Update(1);
+        ps2.Update(1);
+        ps1.buildVertices(PureVector(1.f, 0.f, 0.f), PureVector(0.f, 1.f, 0.f));
+        ps2.buildVertices(PureVector(1.f, 0.f, 0.f), PureVector(0.f, 1.f, 0.f));
+
+        bool b = assertEquals(ps1.getVertices().size(), ps2.getVertices().size(), "size");
+        bool bNotAllSame = false;
+        for (std::size_t i = 0; b && (i < ps1.getVertices().size()); i++)
+        {
+            const ParticleSystem::Vertex& v1 = ps1.getVertices()[i];
+            const ParticleSystem::Vertex& v2 = ps2.getVertices()[i];
+            b &= assertTrue((v1.m_pos[0] == v2.m_pos[0]) && (v1.m_pos[1] == v2.m_pos[1]) && (v1.m_pos[2] == v2.m_pos[2]), "same pos");
+            // same corner of different particles
+            bNotAllSame |= (v1.m_pos[0] != ps1.getVertices()[i % ParticleSystem::nVerticesPerParticle].m_pos[0]);
+        }
+
+        return b & assertTrue(bNotAllSame, "random directions");
+    }
+
+    bool test_update_moves_fades_and_expires()
+    {
+        ParticleSystem ps(4);
+        ParticleSystem::EmitterDesc desc = makeDesc(nullptr, 4, 4, 10.f);
+        desc.m_fSpeed = 0.f;
+        desc.m_fGravity = 1.f;
+        const ParticleSystem::EmitterId id = ps.addEmitter(desc);
+        bool b = assertEquals(static_cast<std::size_t>(1), ps.emit(id, PureVector(0.f, 0.f, 0.f), 1), "emit");
+
+        // nothing happens with zero factor
+        ps.Update(0);
+
+        // semi-implicit Euler with nFactor 2: vy = -0.5, then -1; y = -0.25, then -0.75
+        ps.Update(2);
+        ps.Update(2);
+        ps.buildVertices(PureVector(1.f, 0.f, 0.f), PureVector(0.f, 1.f, 0.f));
+        b &= assertEquals(static_cast<std::size_t>(ParticleSystem::nVerticesPerParticle), ps.getVertices().size(), "vertices");
+        if (b)
+        {
+            // 1st corner is bottom left, quad size is 2
+            const ParticleSystem::Vertex& vertex = ps.getVertices()[0];
+            b &= assertEquals(-1.f, vertex.m_pos[0], 0.0001f, "x");
+            b &= assertEquals(-1.75f, vertex.m_pos[1], 0.0001f, "y");
+            b &= assertEquals(0.f, vertex.m_pos[2], 0.0001f, "z");
+            b &= assertEquals(0.f, vertex.m_uv[0], "u");
+            b &= assertEquals(0.f, vertex.m_uv[1], "v");
+            b &= assertEquals(0.5f, vertex.m_color[1], "g");
+            b &= assertEquals(0.8f * 0.9f, vertex.m_color[3], 0.0001f, "alpha faded");
+        }
+
+        for (int i = 0; i < 8; i++)
+        {
+            ps.Update(1);
+        }
+        b &= assertEquals(static_cast<std::size_t>(1), ps.getParticleCount(), "alive before lifetime");
+        ps.Update(1);
+        b &= assertEquals(static_cast<std::size_t>(0), ps.getParticleCount(), "expired");
+        b &= assertEquals(static_cast<std::size_t>(0), ps.getParticleCount(id), "expired emitter");
+
+        return b;
+    }
+
+    bool test_emitBulletTrails()
+    {
+        PgeObjectPool<PooledBullet> bullets("pool", 4, *engine);
+        ParticleSystem ps(100);
+        const ParticleSystem::EmitterId id = ps.addEmitter(makeDesc(nullptr, 100, 100, 100.f));
+
+        bool b = assertNotNull(createBullet(bullets, Bullet::ParticleType::Smoke), "bullet smoke");
+        b &= assertNotNull(createBullet(bullets, Bullet::ParticleType::None), "bullet none");
+        if (!b)
+        {
+            return false;
+        }
+
+        // 1 particle per 2nd call, up to 3 particles per bullet, only by the bullet with smoke
+        std::size_t nSpawned = 0;
+        for (int i = 0; i < 10; i++)
+        {
+            nSpawned += ps.emitBulletTrails(bullets, id);
+            ps.Update(1);
+        }
+        b &= assertEquals(static_cast<std::size_t>(3), nSpawned, "spawned");
+        b &= assertEquals(static_cast<std::size_t>(3), ps.getParticleCount(id), "particles");
+        for (const auto& bullet : bullets)
+        {
+            if (bullet.used())
+            {
+                b &= assertEquals((bullet.getParticleType() == Bullet::ParticleType::Smoke) ? 3 : 0, bullet.getParticlesEmittedTotal(), "emitted total");
+            }
+        }
+
+        return b;
+    }
+
+    bool test_buildVertices_batches_by_texture()
+    {
+        ParticleSystem ps(100);
+        // emitters of the same texture are not added one after the other, still they must be in the same batch
+        const ParticleSystem::EmitterId id0 = ps.addEmitter(makeDesc(fakeTexture(1), 100, 100, 10.f));
+        const ParticleSystem::EmitterId id1 = ps.addEmitter(makeDesc(fakeTexture(0), 100, 100, 10.f));
+        const ParticleSystem::EmitterId id2 = ps.addEmitter(makeDesc(fakeTexture(1), 100, 100, 10.f));
+        const ParticleSystem::EmitterId id3 = ps.addEmitter(makeDesc(fakeTexture(0), 100, 100, 10.f));
+
+        // interleaved spawns
+        for (int i = 0; i < 5; i++)
+        {
+            ps.emit(id0, PureVector(0.f, 0.f, 0.f), 1);
+            ps.emit(id1, PureVector(1.f, 0.f, 0.f), 2);
+            ps.emit(id2, PureVector(0.f, 0.f, 0.f), 3);
+            ps.emit(id3, PureVector(1.f, 0.f, 0.f), 4);
+        }
+        ps.buildVertices(PureVector(1.f, 0.f, 0.f), PureVector(0.f, 1.f, 0.f));
+
+        bool b = assertEquals(static_cast<std::size_t>(50 * ParticleSystem::nVerticesPerParticle), ps.getVertices().size(), "vertices");
+        b &= assertEquals(static_cast<std::size_t>(2), ps.getBatches().size(), "batches");
+        if (!b)
+        {
+            return false;
+        }
+
+        std::size_t nNextVertex = 0;
+        for (const auto& batch : ps.getBatches())
+        {
+            b &= assertEquals(nNextVertex, batch.m_nFirstVertex, "contiguous");
+            const bool bTexture0 = (batch.m_pTexture == fakeTexture(0));
+            b &= assertEquals(static_cast<std::size_t>((bTexture0 ? 30 : 20) * ParticleSystem::nVerticesPerParticle), batch.m_nVertexCount, "vertex count");
+
+            // particles of texture 0 were spawned around x = 1, others around x = 0, particle speed is 1 and no Update() yet
+            for (std::size_t i = batch.m_nFirstVertex; i < batch.m_nFirstVertex + batch.m_nVertexCount; i++)
+            {
+                b &= assertTrue(std::abs(ps.getVertices()[i].m_pos[0] - (bTexture0 ? 1.f : 0.f)) <= 1.0001f, "vertex in batch of its texture");
+            }
+            nNextVertex += batch.m_nVertexCount;
+        }
+
+        return b;
+    }
+
+    bool test_benchmark_update()
+    {
+        constexpr std::size_t nParticleCount = 100000;
+        constexpr int nIterations = 100;
+
+        ParticleSystem ps(nParticleCount);
+        const ParticleSystem::EmitterId id = ps.addEmitter(
+            makeDesc(nullptr, static_cast<uint32_t>(nParticleCount), static_cast<uint32_t>(nParticleCount), 1000000.f));
+        bool b = assertEquals(nParticleCount, ps.emit(id, PureVector(), nParticleCount), "emit");
+
+        auto timeStart = std::chrono::steady_clock::now();
+        for (int iIter = 0; iIter < nIterations; iIter++)
+        {
+            ps.Update(1);
+        }
+        const auto nDurationUpdateUSecs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - timeStart).count();
+
+        timeStart = std::chrono::steady_clock::now();
+        for (int iIter = 0; iIter < nIterations; iIter++)
+        {
+            ps.buildVertices(PureVector(1.f, 0.f, 0.f), PureVector(0.f, 1.f, 0.f));
+        }
+        const auto nDurationBuildUSecs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - timeStart).count();
+
+        b &= assertEquals(nParticleCount, ps.getParticleCount(), "particles");
+        b &= assertEquals(nParticleCount * ParticleSystem::nVerticesPerParticle, ps.getVertices().size(), "vertices");
+
+        const double fParticleUpdates = static_cast<double>(nParticleCount) * nIterations;
+        CConsole::getConsoleInstance().OLn(
+            "PgeParticleSystemTest::%s(): %u particles x %d iterations: Update(): %.0f particles/ms, buildVertices(): %.0f particles/ms",
+            __func__,
+            static_cast<unsigned>(nParticleCount),
+            nIterations,
+            (nDurationUpdateUSecs > 0) ? (fParticleUpdates * 1000.0 / nDurationUpdateUSecs) : 0.0,
+            (nDurationBuildUSecs > 0) ? (fParticleUpdates * 1000.0 / nDurationBuildUSecs) : 0.0);
+
+        return b;
+    }
+
+}; // class PgeParticleSystemTest
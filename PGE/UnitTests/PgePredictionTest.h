@@ -0,0 +1,615 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgePredictionTest.h
+    Unit test for PgePredictionClient and PgePredictionServer.
+    Made by PR00F88, West Whiskhyll Entertainment
+    2026
+    ###################################################################################
+*/
+
+#include "UnitTest.h"  // PCH
+
+#include "../Network/PgeLoopbackClient.h"
+#include "../Network/PgeLoopbackServer.h"
+#include "../Network/PgeLoopbackTransport.h"
+#include "../Network/PgePrediction.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+class PgePredictionTest :
+    public UnitTest
+{
+public:
+
+    PgePredictionTest() :
+        UnitTest(__FILE__)
+    {
+    }
+
+protected:
+
+    virtual void initialize() override
+    {
+        addSubTest("test_ctor", (PFNUNITSUBTEST)&PgePredictionTest::test_ctor);
+        addSubTest("test_ctor_InvalidArgs", (PFNUNITSUBTEST)&PgePredictionTest::test_ctor_InvalidArgs);
+        addSubTest("test_client_addInput_PredictsImmediately", (PFNUNITSUBTEST)&PgePredictionTest::test_client_addInput_PredictsImmediately);
+        addSubTest("test_client_addInput_Overflow", (PFNUNITSUBTEST)&PgePredictionTest::test_client_addInput_Overflow);
+        addSubTest("test_client_reconcile_ReplaysPending", (PFNUNITSUBTEST)&PgePredictionTest::test_client_reconcile_ReplaysPending);
+        addSubTest("test_client_reconcile_IgnoresStale", (PFNUNITSUBTEST)&PgePredictionTest::test_client_reconcile_IgnoresStale);
+        addSubTest("test_client_handleMsgApp_Malformed", (PFNUNITSUBTEST)&PgePredictionTest::test_client_handleMsgApp_Malformed);
+        addSubTest("test_server_IgnoresDuplicates", (PFNUNITSUBTEST)&PgePredictionTest::test_server_IgnoresDuplicates);
+        addSubTest("test_server_QueueBounded", (PFNUNITSUBTEST)&PgePredictionTest::test_server_QueueBounded);
+        addSubTest("test_server_fillPktMsgAppState", (PFNUNITSUBTEST)&PgePredictionTest::test_server_fillPktMsgAppState);
+        addSubTest("test_loopback_Reliable", (PFNUNITSUBTEST)&PgePredictionTest::test_loopback_Reliable);
+        addSubTest("test_loopback_UnreliableLossy", (PFNUNITSUBTEST)&PgePredictionTest::test_loopback_UnreliableLossy);
+        addSubTest("test_loopback_Deterministic", (PFNUNITSUBTEST)&PgePredictionTest::test_loopback_Deterministic);
+    }
+
+private:
+
+    struct Input
+    {
+        int32_t m_nMove;   // -1, 0 or 1
+    };
+
+    struct State
+    {
+        float m_x;
+        float m_vx;
+    };
+
+    typedef pge_network::PgePredictionClient<Input, State> PredictionClient;
+    typedef pge_network::PgePredictionServer<Input, State> PredictionServer;
+
+    struct LoopbackResult
+    {
+        State m_statePredicted;
+        State m_stateServer;
+        pge_network::TPredictionSequence m_nLastAckedSequence;
+        std::size_t m_nPendingInputCount;
+        std::size_t m_nMaxPendingInputCount;
+        uint32_t m_nReconcileCount;
+        uint32_t m_nDuplicateInputCount;
+        bool m_bPredictedBeforeAck;   // first input was visible in predicted state before server could have acknowledged it
+        bool m_bMispredicted;         // server stopped at the wall the client does not know about, so the client had to be corrected
+    };
+
+    static constexpr pge_network::MsgApp::TMsgId nMsgIdInput = 1u;
+    static constexpr pge_network::MsgApp::TMsgId nMsgIdState = 2u;
+    static constexpr float fDeltaSecs = 0.01f;
+    static constexpr float fSpeed = 5.f;
+    static constexpr float fServerWallX = 0.8f;    // only the server knows about this wall, so the client mispredicts
+    static constexpr pge_network::PgeLoopbackTransport::TTimeUSecs nTickUSecs = 10000;
+    static constexpr uint32_t nInputTickCount = 100;
+    static constexpr uint32_t nDrainTickCount = 30;
+
+    // ---------------------------------------------------------------------------
+
+    PgePredictionTest(const PgePredictionTest&)
+    {};
+
+    PgePredictionTest& operator=(const PgePredictionTest&)
+    {
+        return *this;
+    };
+
+    static void step(State& state, const Input& input)
+    {
+        state.m_vx = static_cast<float>(input.m_nMove) * fSpeed;
+        state.m_x += state.m_vx * fDeltaSecs;
+    }
+
+    static void stepWithWall(State& state, const Input& input)
+    {
+        step(state, input);
+        if (state.m_x > fServerWallX)
+        {
+            state.m_x = fServerWallX;
+            state.m_vx = 0.f;
+        }
+    }
+
+    static Input makeInput(const int32_t& nMove)
+    {
+        Input input;
+        input.m_nMove = nMove;
+        return input;
+    }
+
+    /** Scripted movement: right long enough to hit the server-side wall, then left, then standing. */
+    static Input getScriptedInput(const uint32_t& iTick)
+    {
+        return makeInput((iTick < 40) ? 1 : ((iTick < 70) ? -1 : 0));
+    }
+
+    static bool equals(const State& a, const State& b)
+    {
+        return (a.m_x == b.m_x) && (a.m_vx == b.m_vx);
+    }
+
+    static pge_network::PgePacket makeStatePkt(const pge_network::TPredictionSequence& nLastProcessedSequence, const State& state)
+    {
+        pge_network::MsgPredictedState<State> msg;
+        msg.m_nLastProcessedSequence = nLastProcessedSequence;
+        msg.m_state = state;
+
+        pge_network::PgePacket pkt;
+        pge_network::PgePacket::initPktMsgApp(pkt, pge_network::ServerConnHandle, pge_network::PgePacket::AutoFill::NONE);
+        pge_network::TByte* const pMsgAppData = pge_network::PgePacket::preparePktMsgAppFill(pkt, nMsgIdState, sizeof(msg));
+        std::memcpy(pMsgAppData, &msg, sizeof(msg));
+        return pkt;
+    }
+
+    static void handleAllMsgApps(pge_network::PgePacket& pkt, const std::function<bool(const pge_network::PgePacket&, const pge_network::MsgApp&)>& handler)
+    {
+        if (pge_network::PgePacket::getPacketId(pkt) != pge_network::PgePktId::Application)
+        {
+            return;
+        }
+        for (const pge_network::MsgApp* pMsgApp = pge_network::PgePacket::getMsgAppFromPkt(pkt);
+            pMsgApp;
+            pMsgApp = pge_network::PgePacket::getNextMsgAppFromPkt(pkt, *pMsgApp))
+        {
+            handler(pkt, *pMsgApp);
+        }
+    }
+
+    /**
+        Runs a client predicting its movement and an authoritative server through loopback with the given link, one input per tick.
+    */
+    bool runLoopback(
+        const pge_network::PgeLoopbackTransport::LinkConfig& linkConfig,
+        const uint64_t& nSeed,
+        const bool& bUnreliable,
+        const std::size_t& nRedundantInputs,
+        LoopbackResult& result)
+    {
+        pge_network::PgeLoopbackTransport transport(linkConfig, nSeed);
+        pge_network::PgeLoopbackServer server(transport);
+        pge_network::PgeLoopbackClient client(transport);
+
+        bool b = assertTrue(server.initialize(), "server init") & assertTrue(client.initialize(), "client init");
+        server.getAllowListedAppMessages().insert(nMsgIdInput);
+        client.getAllowListedAppMessages().insert(nMsgIdState);
+        if (bUnreliable)
+        {
+            server.getMsgAppId2SendLaneMap()[nMsgIdState] = pge_network::PgeSendLane::Unreliable;
+            client.getMsgAppId2SendLaneMap()[nMsgIdInput] = pge_network::PgeSendLane::Unreliable;
+        }
+        b &= assertTrue(server.startListening(""), "listen") & assertTrue(client.connectToServer("127.0.0.1", ""), "connect");
+        for (int i = 0; i < 4; i++)
+        {
+            transport.advanceTime(linkConfig.m_nLatencyUSecs + linkConfig.m_nJitterUSecs + 1);
+            server.Update();
+            server.flushBatchedPackets();
+            client.Update();
+            client.flushBatchedPackets();
+        }
+        b &= assertTrue(client.isConnected(), "connected");
+        if (!b)
+        {
+            return false;
+        }
+
+        const State stateInitial = { 0.f, 0.f };
+        PredictionClient predictionClient(nMsgIdInput, nMsgIdState, &step, stateInitial);
+        PredictionServer predictionServer(nMsgIdInput, nMsgIdState, &stepWithWall);
+        const pge_network::PgeNetworkConnectionHandle connHandle = client.getConnectionHandleServerSide();
+
+        result.m_stateServer = stateInitial;
+        result.m_nMaxPendingInputCount = 0;
+        result.m_bPredictedBeforeAck = false;
+        result.m_bMispredicted = false;
+
+        for (uint32_t iTick = 0; iTick < nInputTickCount + nDrainTickCount; iTick++)
+        {
+            // client: predict and send input, on unreliable lane keep resending pending inputs even after the last one
+            if (iTick < nInputTickCount)
+            {
+                predictionClient.addInput(getScriptedInput(iTick));
+                if (iTick == 0)
+                {
+                    result.m_bPredictedBeforeAck = (predictionClient.getPredictedState().m_x > 0.f) && (predictionClient.getLastAckedSequence() == 0);
+                }
+            }
+            if (((iTick < nInputTickCount) || bUnreliable) && (predictionClient.getPendingInputCount() > 0))
+            {
+                pge_network::PgePacket pkt;
+                pge_network::PgePacket::initPktMsgApp(pkt, pge_network::ServerConnHandle, pge_network::PgePacket::AutoFill::NONE);
+                b &= assertEquals(std::min<std::size_t>(nRedundantInputs, predictionClient.getPendingInputCount()),
+                    predictionClient.fillPktMsgAppInputs(pkt, nRedundantInputs), "fill inputs");
+                client.send(pkt);
+            }
+            result.m_nMaxPendingInputCount = std::max(result.m_nMaxPendingInputCount, predictionClient.getPendingInputCount());
+            client.flushBatchedPackets();
+
+            transport.advanceTime(nTickUSecs);
+
+            // server: process inputs as they arrive and send back the authoritative state
+            server.Update();
+            while (server.getPacketQueueSize() > 0)
+            {
+                handleAllMsgApps(const_cast<pge_network::PgePacket&>(server.borrowFrontPacket()),
+                    [&](const pge_network::PgePacket& pkt, const pge_network::MsgApp& msgApp) { return predictionServer.handleMsgApp(pkt, msgApp); });
+                server.releaseFrontPacket();
+            }
+            predictionServer.processInputs(connHandle, result.m_stateServer);
+
+            pge_network::PgePacket pkt;
+            pge_network::PgePacket::initPktMsgApp(pkt, connHandle, pge_network::PgePacket::AutoFill::NONE);
+            b &= assertTrue(predictionServer.fillPktMsgAppState(pkt, connHandle, result.m_stateServer), "fill state");
+            server.send(pkt, connHandle);
+            server.flushBatchedPackets();
+
+            // client: reconcile with received states
+            client.Update();
+            while (client.getPacketQueueSize() > 0)
+            {
+                handleAllMsgApps(const_cast<pge_network::PgePacket&>(client.borrowFrontPacket()),
+                    [&](const pge_network::PgePacket& pkt, const pge_network::MsgApp& msgApp) { return predictionClient.handleMsgApp(pkt, msgApp); });
+                client.releaseFrontPacket();
+            }
+
+            State stateUnclamped = predictionClient.getAuthoritativeState();
+            for (pge_network::TPredictionSequence nSeq = predictionClient.getLastAckedSequence() + 1; nSeq <= predictionClient.getLastSequence(); nSeq++)
+            {
+                step(stateUnclamped, getScriptedInput(nSeq - 1));
+            }
+            b &= assertTrue(equals(stateUnclamped, predictionClient.getPredictedState()), "predicted = acked state + replayed inputs");
+            if (predictionClient.getAuthoritativeState().m_x == fServerWallX)
+            {
+                result.m_bMispredicted = true;
+            }
+        }
+
+        result.m_statePredicted = predictionClient.getPredictedState();
+        result.m_nLastAckedSequence = predictionClient.getLastAckedSequence();
+        result.m_nPendingInputCount = predictionClient.getPendingInputCount();
+        result.m_nReconcileCount = predictionClient.getReconcileCount();
+        result.m_nDuplicateInputCount = predictionServer.getDuplicateInputCount();
+        return b;
+    }
+
+    bool test_ctor()
+    {
+        const State stateInitial = { 1.f, 2.f };
+        const PredictionClient predictionClient(nMsgIdInput, nMsgIdState, &step, stateInitial, 8);
+        const PredictionServer predictionServer(nMsgIdInput, nMsgIdState, &step);
+
+        return (assertEquals(nMsgIdInput, predictionClient.getMsgAppIdInput(), "client input id") &
+            assertEquals(nMsgIdState, predictionClient.getMsgAppIdState(), "client state id") &
+            assertTrue(equals(stateInitial, predictionClient.getPredictedState()), "predicted") &
+            assertTrue(equals(stateInitial, predictionClient.getAuthoritativeState()), "authoritative") &
+            assertEquals(0u, predictionClient.getLastSequence(), "last seq") &
+            assertEquals(0u, predictionClient.getLastAckedSequence(), "last acked seq") &
+            assertEquals(0u, predictionClient.getPendingInputCount(), "pending") &
+            assertEquals(8u, predictionClient.getMaxPendingInputCount(), "max pending") &
+            assertEquals(0u, predictionClient.getReconcileCount(), "reconcile count") &
+            assertEquals(0u, predictionClient.getOverflowCount(), "overflow count") &
+            assertFalse(predictionServer.hasClient(pge_network::ServerConnHandle), "server has client") &
+            assertEquals(0u, predictionServer.getLastProcessedSequence(pge_network::ServerConnHandle), "server last processed") &
+            assertEquals(0u, predictionServer.getDuplicateInputCount(), "server duplicate count") &
+            assertEquals(0u, predictionServer.getDroppedInputCount(), "server dropped count")) != 0;
+    }
+
+    bool test_ctor_InvalidArgs()
+    {
+        const State stateInitial = { 0.f, 0.f };
+        const auto throwsClient = [&](const pge_network::MsgApp::TMsgId& idState, const PredictionClient::StepFunction& fn, const std::size_t& nMax)
+        {
+            try
+            {
+                const PredictionClient predictionClient(nMsgIdInput, idState, fn, stateInitial, nMax);
+            }
+            catch (const std::exception&)
+            {
+                return true;
+            }
+            return false;
+        };
+        const auto throwsServer = [&](const pge_network::MsgApp::TMsgId& idState, const PredictionServer::StepFunction& fn, const std::size_t& nMax)
+        {
+            try
+            {
+                const PredictionServer predictionServer(nMsgIdInput, idState, fn, nMax);
+            }
+            catch (const std::exception&)
+            {
+                return true;
+            }
+            return false;
+        };
+
+        return (assertTrue(throwsClient(nMsgIdInput, &step, 8), "client same ids") &
+            assertTrue(throwsClient(nMsgIdState, nullptr, 8), "client no step") &
+            assertTrue(throwsClient(nMsgIdState, &step, 0), "client zero size") &
+            assertFalse(throwsClient(nMsgIdState, &step, 1), "client valid") &
+            assertTrue(throwsServer(nMsgIdInput, &step, 8), "server same ids") &
+            assertTrue(throwsServer(nMsgIdState, nullptr, 8), "server no step") &
+            assertTrue(throwsServer(nMsgIdState, &step, 0), "server zero size") &
+            assertFalse(throwsServer(nMsgIdState, &step, 1), "server valid")) != 0;
+    }
+
+    bool test_client_addInput_PredictsImmediately()
+    {
+        PredictionClient predictionClient(nMsgIdInput, nMsgIdState, &step, State{ 0.f, 0.f });
+
+        bool b = assertEquals(1u, predictionClient.addInput(makeInput(1)), "seq 1");
+        b &= assertEquals(2u, predictionClient.addInput(makeInput(1)), "seq 2");
+        b &= assertEquals(3u, predictionClient.addInput(makeInput(-1)), "seq 3");
+
+        State stateExpected = { 0.f, 0.f };
+        step(stateExpected, makeInput(1));
+        step(stateExpected, makeInput(1));
+        step(stateExpected, makeInput(-1));
+
+        return (b &
+            assertTrue(equals(stateExpected, predictionClient.getPredictedState()), "predicted") &
+            assertEquals(0.f, predictionClient.getAuthoritativeState().m_x, "authoritative") &
+            assertEquals(3u, predictionClient.getLastSequence(), "last seq") &
+            assertEquals(3u, predictionClient.getPendingInputCount(), "pending")) != 0;
+    }
+
+    bool test_client_addInput_Overflow()
+    {
+        PredictionClient predictionClient(nMsgIdInput, nMsgIdState, &step, State{ 0.f, 0.f }, 4);
+        for (int i = 0; i < 6; i++)
+        {
+            predictionClient.addInput(makeInput(1));
+        }
+
+        // inputs 1 and 2 are forgotten, so acking 2 replays 3..6
+        predictionClient.reconcile(2, State{ 10.f, 0.f });
+        State stateExpected = { 10.f, 0.f };
+        for (int i = 0; i < 4; i++)
+        {
+            step(stateExpected, makeInput(1));
+        }
+
+        return (assertEquals(2u, predictionClient.getOverflowCount(), "overflow count") &
+            assertEquals(4u, predictionClient.getPendingInputCount(), "pending") &
+            assertEquals(6u, predictionClient.getLastSequence(), "last seq") &
+            assertTrue(equals(stateExpected, predictionClient.getPredictedState()), "predicted")) != 0;
+    }
+
+    bool test_client_reconcile_ReplaysPending()
+    {
+        PredictionClient predictionClient(nMsgIdInput, nMsgIdState, &step, State{ 0.f, 0.f });
+        const int32_t moves[] = { 1, 1, -1, 0, 1 };
+        for (const int32_t nMove : moves)
+        {
+            predictionClient.addInput(makeInput(nMove));
+        }
+
+        // server processed the first 2 inputs but its state differs from our prediction
+        const State stateServer = { -3.f, 0.f };
+        predictionClient.reconcile(2, stateServer);
+
+        State stateExpected = stateServer;
+        step(stateExpected, makeInput(-1));
+        step(stateExpected, makeInput(0));
+        step(stateExpected, makeInput(1));
+
+        return (assertTrue(equals(stateExpected, predictionClient.getPredictedState()), "predicted") &
+            assertTrue(equals(stateServer, predictionClient.getAuthoritativeState()), "authoritative") &
+            assertEquals(2u, predictionClient.getLastAckedSequence(), "last acked seq") &
+            assertEquals(3u, predictionClient.getPendingInputCount(), "pending") &
+            assertEquals(1u, predictionClient.getReconcileCount(), "reconcile count") &
+            assertEquals(static_cast<uint64_t>(3), predictionClient.getReplayedInputCount(), "replayed count")) != 0;
+    }
+
+    bool test_client_reconcile_IgnoresStale()
+    {
+        PredictionClient predictionClient(nMsgIdInput, nMsgIdState, &step, State{ 0.f, 0.f });
+        for (int i = 0; i < 4; i++)
+        {
+            predictionClient.addInput(makeInput(1));
+        }
+
+        predictionClient.reconcile(3, State{ 5.f, 0.f });
+        const State statePredicted = predictionClient.getPredictedState();
+
+        // older state arriving out of order, and a state acking an input never sent
+        predictionClient.reconcile(2, State{ 7.f, 0.f });
+        predictionClient.reconcile(5, State{ 9.f, 0.f });
+
+        // same sequence again is still valid, server may send states without processing new inputs
+        predictionClient.reconcile(3, State{ 5.f, 0.f });
+
+        return (assertTrue(equals(statePredicted, predictionClient.getPredictedState()), "predicted") &
+            assertEquals(5.f, predictionClient.getAuthoritativeState().m_x, "authoritative") &
+            assertEquals(3u, predictionClient.getLastAckedSequence(), "last acked seq") &
+            assertEquals(1u, predictionClient.getPendingInputCount(), "pending") &
+            assertEquals(2u, predictionClient.getReconcileCount(), "reconcile count")) != 0;
+    }
+
+    bool test_client_handleMsgApp_Malformed()
+    {
+        PredictionClient predictionClient(nMsgIdInput, nMsgIdState, &step, State{ 0.f, 0.f });
+        predictionClient.addInput(makeInput(1));
+
+        pge_network::PgePacket pktWrongSize;
+        pge_network::PgePacket::initPktMsgApp(pktWrongSize, pge_network::ServerConnHandle, pge_network::PgePacket::AutoFill::ZERO);
+        pge_network::PgePacket::preparePktMsgAppFill(pktWrongSize, nMsgIdState, sizeof(pge_network::MsgPredictedState<State>) - 1);
+
+        pge_network::PgePacket pktWrongId;
+        pge_network::PgePacket::initPktMsgApp(pktWrongId, pge_network::ServerConnHandle, pge_network::PgePacket::AutoFill::ZERO);
+        pge_network::PgePacket::preparePktMsgAppFill(pktWrongId, nMsgIdInput, sizeof(pge_network::MsgPredictedState<State>));
+
+        const pge_network::PgePacket pktValid = makeStatePkt(1, State{ 2.f, 0.f });
+
+        return (assertFalse(predictionClient.handleMsgApp(pktWrongSize, *pge_network::PgePacket::getMsgAppFromPkt(pktWrongSize)), "wrong size") &
+            assertFalse(predictionClient.handleMsgApp(pktWrongId, *pge_network::PgePacket::getMsgAppFromPkt(pktWrongId)), "wrong id") &
+            assertEquals(0u, predictionClient.getReconcileCount(), "reconcile count 1") &
+            assertTrue(predictionClient.handleMsgApp(pktValid, *pge_network::PgePacket::getMsgAppFromPkt(pktValid)), "valid") &
+            assertEquals(1u, predictionClient.getReconcileCount(), "reconcile count 2") &
+            assertEquals(2.f, predictionClient.getPredictedState().m_x, "predicted")) != 0;
+    }
+
+    bool test_server_IgnoresDuplicates()
+    {
+        PredictionClient predictionClient(nMsgIdInput, nMsgIdState, &step, State{ 0.f, 0.f });
+        PredictionServer predictionServer(nMsgIdInput, nMsgIdState, &step);
+        const pge_network::PgeNetworkConnectionHandle connHandle = 5;
+
+        // each packet carries the last 3 inputs, so inputs are received multiple times
+        for (int i = 0; i < 5; i++)
+        {
+            predictionClient.addInput(makeInput((i % 2 == 0) ? 1 : -1));
+            pge_network::PgePacket pkt;
+            pge_network::PgePacket::initPktMsgApp(pkt, connHandle, pge_network::PgePacket::AutoFill::NONE);
+            predictionClient.fillPktMsgAppInputs(pkt, 3);
+            handleAllMsgApps(pkt,
+                [&](const pge_network::PgePacket& pkt, const pge_network::MsgApp& msgApp) { return predictionServer.handleMsgApp(pkt, msgApp); });
+        }
+
+        State stateServer = { 0.f, 0.f };
+        const std::size_t nProcessed1 = predictionServer.processInputs(connHandle, stateServer, 2);
+        const pge_network::TPredictionSequence nLastProcessed1 = predictionServer.getLastProcessedSequence(connHandle);
+        const std::size_t nProcessed2 = predictionServer.processInputs(connHandle, stateServer);
+
+        return (assertTrue(predictionServer.hasClient(connHandle), "has client") &
+            assertEquals(5u, predictionServer.getLastReceivedSequence(connHandle), "last received") &
+            assertEquals(1u + 2u + 2u + 2u, predictionServer.getDuplicateInputCount(), "duplicate count") &
+            assertEquals(2u, nProcessed1, "processed 1") &
+            assertEquals(2u, nLastProcessed1, "last processed 1") &
+            assertEquals(3u, nProcessed2, "processed 2") &
+            assertEquals(5u, predictionServer.getLastProcessedSequence(connHandle), "last processed 2") &
+            assertEquals(0u, predictionServer.getQueuedInputCount(connHandle), "queued") &
+            assertTrue(equals(predictionClient.getPredictedState(), stateServer), "state") &
+            assertEquals(0u, predictionServer.processInputs(12345, stateServer), "unknown client") &
+            assertTrue(predictionServer.removeClient(connHandle), "remove") &
+            assertFalse(predictionServer.removeClient(connHandle), "remove again")) != 0;
+    }
+
+    bool test_server_QueueBounded()
+    {
+        PredictionClient predictionClient(nMsgIdInput, nMsgIdState, &step, State{ 0.f, 0.f });
+        PredictionServer predictionServer(nMsgIdInput, nMsgIdState, &step, 4);
+        const pge_network::PgeNetworkConnectionHandle connHandle = 5;
+
+        for (int i = 0; i < 7; i++)
+        {
+            predictionClient.addInput(makeInput(1));
+            pge_network::PgePacket pkt;
+            pge_network::PgePacket::initPktMsgApp(pkt, connHandle, pge_network::PgePacket::AutoFill::NONE);
+            predictionClient.fillPktMsgAppInputs(pkt);
+            handleAllMsgApps(pkt,
+                [&](const pge_network::PgePacket& pkt, const pge_network::MsgApp& msgApp) { return predictionServer.handleMsgApp(pkt, msgApp); });
+        }
+
+        State stateServer = { 0.f, 0.f };
+        const std::size_t nQueued = predictionServer.getQueuedInputCount(connHandle);
+        const std::size_t nProcessed = predictionServer.processInputs(connHandle, stateServer);
+
+        return (assertEquals(4u, nQueued, "queued") &
+            assertEquals(3u, predictionServer.getDroppedInputCount(), "dropped") &
+            assertEquals(4u, nProcessed, "processed") &
+            assertEquals(7u, predictionServer.getLastProcessedSequence(connHandle), "last processed")) != 0;
+    }
+
+    bool test_server_fillPktMsgAppState()
+    {
+        PredictionClient predictionClient(nMsgIdInput, nMsgIdState, &step, State{ 0.f, 0.f });
+        PredictionServer predictionServer(nMsgIdInput, nMsgIdState, &stepWithWall);
+        const pge_network::PgeNetworkConnectionHandle connHandle = 5;
+
+        pge_network::PgePacket pktInputs;
+        pge_network::PgePacket::initPktMsgApp(pktInputs, connHandle, pge_network::PgePacket::AutoFill::NONE);
+        for (int i = 0; i < 20; i++)
+        {
+            predictionClient.addInput(makeInput(1));
+        }
+        bool b = assertEquals(20u, predictionClient.fillPktMsgAppInputs(pktInputs, 100), "fill inputs");
+        handleAllMsgApps(pktInputs,
+            [&](const pge_network::PgePacket& pkt, const pge_network::MsgApp& msgApp) { return predictionServer.handleMsgApp(pkt, msgApp); });
+
+        State stateServer = { 0.f, 0.f };
+        b &= assertEquals(18u, predictionServer.processInputs(connHandle, stateServer, 18), "processed");
+
+        pge_network::PgePacket pktState;
+        pge_network::PgePacket::initPktMsgApp(pktState, connHandle, pge_network::PgePacket::AutoFill::NONE);
+        b &= assertTrue(predictionServer.fillPktMsgAppState(pktState, connHandle, stateServer), "fill state");
+        b &= assertTrue(predictionClient.handleMsgApp(pktState, *pge_network::PgePacket::getMsgAppFromPkt(pktState)), "handle state");
+
+        // server stopped at the wall, client replays its last 2 inputs on top of that
+        State stateExpected = stateServer;
+        step(stateExpected, makeInput(1));
+        step(stateExpected, makeInput(1));
+
+        return (b &
+            assertEquals(fServerWallX, stateServer.m_x, "server at wall") &
+            assertEquals(18u, predictionClient.getLastAckedSequence(), "last acked seq") &
+            assertEquals(2u, predictionClient.getPendingInputCount(), "pending") &
+            assertTrue(equals(stateExpected, predictionClient.getPredictedState()), "predicted")) != 0;
+    }
+
+    bool test_loopback_Reliable()
+    {
+        pge_network::PgeLoopbackTransport::LinkConfig linkConfig;
+        linkConfig.m_nLatencyUSecs = 30000;
+
+        LoopbackResult result;
+        if (!runLoopback(linkConfig, 1, false, 1, result))
+        {
+            return false;
+        }
+
+        // 30 ms one-way latency with 10 ms ticks: an input is acked about 6-7 ticks later
+        return (assertTrue(result.m_bPredictedBeforeAck, "predicted before ack") &
+            assertTrue(result.m_bMispredicted, "mispredicted") &
+            assertTrue(equals(result.m_stateServer, result.m_statePredicted), "converged") &
+            assertEquals(nInputTickCount, result.m_nLastAckedSequence, "last acked seq") &
+            assertEquals(0u, result.m_nPendingInputCount, "pending") &
+            assertLequals(6u, result.m_nMaxPendingInputCount, "max pending min") &
+            assertLequals(result.m_nMaxPendingInputCount, 8u, "max pending max") &
+            assertLess(0u, result.m_nReconcileCount, "reconcile count") &
+            assertEquals(0u, result.m_nDuplicateInputCount, "duplicate count")) != 0;
+    }
+
+    bool test_loopback_UnreliableLossy()
+    {
+        pge_network::PgeLoopbackTransport::LinkConfig linkConfig;
+        linkConfig.m_nLatencyUSecs = 30000;
+        linkConfig.m_nJitterUSecs = 15000;
+        linkConfig.m_fLossRate = 0.2f;
+
+        // each packet carries the last 8 inputs, so a lost packet does not lose inputs
+        LoopbackResult result;
+        if (!runLoopback(linkConfig, 7, true, 8, result))
+        {
+            return false;
+        }
+
+        return (assertTrue(result.m_bPredictedBeforeAck, "predicted before ack") &
+            assertTrue(equals(result.m_stateServer, result.m_statePredicted), "converged") &
+            assertEquals(nInputTickCount, result.m_nLastAckedSequence, "last acked seq") &
+            assertEquals(0u, result.m_nPendingInputCount, "pending") &
+            assertLess(0u, result.m_nDuplicateInputCount, "duplicate count")) != 0;
+    }
+
+    bool test_loopback_Deterministic()
+    {
+        pge_network::PgeLoopbackTransport::LinkConfig linkConfig;
+        linkConfig.m_nLatencyUSecs = 20000;
+        linkConfig.m_nJitterUSecs = 20000;
+        linkConfig.m_fLossRate = 0.1f;
+
+        LoopbackResult result1;
+        LoopbackResult result2;
+        if (!runLoopback(linkConfig, 42, true, 4, result1) || !runLoopback(linkConfig, 42, true, 4, result2))
+        {
+            return false;
+        }
+
+        return (assertTrue(equals(result1.m_statePredicted, result2.m_statePredicted), "predicted") &
+            assertTrue(equals(result1.m_stateServer, result2.m_stateServer), "server") &
+            assertEquals(result1.m_nReconcileCount, result2.m_nReconcileCount, "reconcile count") &
+            assertEquals(result1.m_nDuplicateInputCount, result2.m_nDuplicateInputCount, "duplicate count") &
+            assertEquals(result1.m_nMaxPendingInputCount, result2.m_nMaxPendingInputCount, "max pending")) != 0;
+    }
+
+}; // class PgePredictionTest
@@ -0,0 +1,422 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeSnapshotInterpolatorTest.h
+    Unit test for PgeSnapshotInterpolator.
+    Made by PR00F88, West Whiskhyll Entertainment
+    2026
+    ###################################################################################
+*/
+
+#include "UnitTest.h"  // PCH
+
+#include "../Network/PgeSnapshotInterpolator.h"
+
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+class PgeSnapshotInterpolatorTest :
+    public UnitTest
+{
+public:
+
+    PgeSnapshotInterpolatorTest() :
+        UnitTest(__FILE__)
+    {
+    }
+
+protected:
+
+    virtual void initialize() override
+    {
+        addSubTest("test_ctor_Bad", (PFNUNITSUBTEST)&PgeSnapshotInterpolatorTest::test_ctor_Bad);
+        addSubTest("test_ctor", (PFNUNITSUBTEST)&PgeSnapshotInterpolatorTest::test_ctor);
+        addSubTest("test_entities", (PFNUNITSUBTEST)&PgeSnapshotInterpolatorTest::test_entities);
+        addSubTest("test_interpolate_SteadyUpdates", (PFNUNITSUBTEST)&PgeSnapshotInterpolatorTest::test_interpolate_SteadyUpdates);
+        addSubTest("test_interpolate_AngleWrapAround", (PFNUNITSUBTEST)&PgeSnapshotInterpolatorTest::test_interpolate_AngleWrapAround);
+        addSubTest("test_interpolate_BeforeFirstUpdate", (PFNUNITSUBTEST)&PgeSnapshotInterpolatorTest::test_interpolate_BeforeFirstUpdate);
+        addSubTest("test_extrapolate_Bounded", (PFNUNITSUBTEST)&PgeSnapshotInterpolatorTest::test_extrapolate_Bounded);
+        addSubTest("test_teleported", (PFNUNITSUBTEST)&PgeSnapshotInterpolatorTest::test_teleported);
+        addSubTest("test_delay_AdaptsToJitter", (PFNUNITSUBTEST)&PgeSnapshotInterpolatorTest::test_delay_AdaptsToJitter);
+        addSubTest("test_delay_Clamped", (PFNUNITSUBTEST)&PgeSnapshotInterpolatorTest::test_delay_Clamped);
+        addSubTest("test_lateAndOutOfOrderSnapshots", (PFNUNITSUBTEST)&PgeSnapshotInterpolatorTest::test_lateAndOutOfOrderSnapshots);
+        addSubTest("test_clear", (PFNUNITSUBTEST)&PgeSnapshotInterpolatorTest::test_clear);
+    }
+
+private:
+
+    typedef pge_network::PgeSnapshotInterpolator::TTimeUSecs TTimeUSecs;
+    typedef pge_network::PgeSnapshotInterpolator::Result Result;
+
+    static constexpr TTimeUSecs nUpdateIntervalUSecs = 50000;  // 20 Hz
+    static constexpr TTimeUSecs nTransitUSecs = 30000;
+    static constexpr TTimeUSecs nMaxDelayUSecs = 200000;
+    static constexpr TTimeUSecs nMaxExtrapolationUSecs = 100000;
+    static constexpr pge_network::PgeSnapshotInterpolator::TEntityId entityId = 7;
+
+    // ---------------------------------------------------------------------------
+
+    PgeSnapshotInterpolatorTest(const PgeSnapshotInterpolatorTest&)
+    {};
+
+    PgeSnapshotInterpolatorTest& operator=(const PgeSnapshotInterpolatorTest&)
+    {
+        return *this;
+    };
+
+    /**
+        State moving 1 unit per millisecond along x, and 1 degree per millisecond around y.
+    */
+    static pge_network::PgeSnapshotInterpolator::EntityState getLinearState(const TTimeUSecs& nServerTimeUSecs)
+    {
+        const float fMillisecs = static_cast<float>(nServerTimeUSecs) / 1000.f;
+        return { fMillisecs, 2.f, 3.f, 0.f, std::fmod(fMillisecs, 360.f), 0.f };
+    }
+
+    /**
+        Adds an update with the linear state of the entity, sent at the given server time and received after the given transit time.
+    */
+    static void addLinearUpdate(
+        pge_network::PgeSnapshotInterpolator& interp,
+        const TTimeUSecs& nServerTimeUSecs,
+        const TTimeUSecs& nTransit)
+    {
+        interp.addSnapshot(nServerTimeUSecs, nServerTimeUSecs + nTransit);
+        interp.setEntityState(entityId, nServerTimeUSecs, getLinearState(nServerTimeUSecs));
+    }
+
+    bool isNear(const float& fExpected, const float& fActual, const float& fTolerance = 0.01f) const
+    {
+        return std::abs(fExpected - fActual) <= fTolerance;
+    }
+
+    bool test_ctor_Bad()
+    {
+        int nExceptions = 0;
+        for (const auto& params : { std::array<TTimeUSecs, 3>{ -1, 100, 0 }, std::array<TTimeUSecs, 3>{ 100, 99, 0 }, std::array<TTimeUSecs, 3>{ 0, 100, -1 } })
+        {
+            try
+            {
+                pge_network::PgeSnapshotInterpolator interp(params[0], params[1], params[2]);
+            }
+            catch (const std::exception&)
+            {
+                nExceptions++;
+            }
+        }
+        return assertEquals(3, nExceptions, "exceptions");
+    }
+
+    bool test_ctor()
+    {
+        pge_network::PgeSnapshotInterpolator interp(0, nMaxDelayUSecs, nMaxExtrapolationUSecs);
+        pge_network::PgeSnapshotInterpolator::EntityState state{};
+
+        interp.update(1000000);
+
+        return (assertEquals(0, interp.getMinDelayUSecs(), "min delay") &
+            assertEquals(nMaxDelayUSecs, interp.getMaxDelayUSecs(), "max delay") &
+            assertEquals(nMaxExtrapolationUSecs, interp.getMaxExtrapolationUSecs(), "max extrapolation") &
+            assertFalse(interp.isReady(), "ready") &
+            assertEquals(0, interp.getRenderTimeUSecs(), "render time") &
+            assertEquals(0, interp.getDelayUSecs(), "delay") &
+            assertEquals(0, interp.getJitterUSecs(), "jitter") &
+            assertEquals(0, interp.getUpdateIntervalUSecs(), "interval") &
+            assertEquals(0u, interp.getLateSnapshotCount(), "late") &
+            assertEquals(0u, interp.getEntityCount(), "entity count") &
+            assertTrue(Result::None == interp.getEntityState(entityId, state), "state")) != 0;
+    }
+
+    bool test_entities()
+    {
+        pge_network::PgeSnapshotInterpolator interp(0, nMaxDelayUSecs, nMaxExtrapolationUSecs);
+        const pge_network::PgeSnapshotInterpolator::EntityState state{};
+        interp.setEntityState(5, 1000, state);
+        interp.setEntityState(3, 1000, state);
+        interp.setEntityState(5, 2000, state);
+
+        bool b = assertEquals(2u, interp.getEntityCount(), "entity count 1") &
+            assertTrue(interp.hasEntity(3), "has 3") &
+            assertTrue(interp.hasEntity(5), "has 5") &
+            assertFalse(interp.hasEntity(4), "has 4");
+
+        b &= assertTrue(interp.removeEntity(3), "remove 3");
+        b &= assertFalse(interp.removeEntity(3), "remove 3 again");
+
+        return (b &
+            assertEquals(1u, interp.getEntityCount(), "entity count 2") &
+            assertFalse(interp.hasEntity(3), "has 3 after remove")) != 0;
+    }
+
+    bool test_interpolate_SteadyUpdates()
+    {
+        pge_network::PgeSnapshotInterpolator interp(0, nMaxDelayUSecs, nMaxExtrapolationUSecs);
+
+        bool b = true;
+        bool bAllInterpolated = true;
+        bool bAllExact = true;
+        TTimeUSecs nPrevRenderTimeUSecs = 0;
+        bool bMonotonic = true;
+        for (int iUpdate = 1; iUpdate <= 40; iUpdate++)
+        {
+            const TTimeUSecs nServerTimeUSecs = iUpdate * nUpdateIntervalUSecs;
+            addLinearUpdate(interp, nServerTimeUSecs, nTransitUSecs);
+
+            // 5 frames between updates
+            for (TTimeUSecs nFrame = 0; nFrame < 5; nFrame++)
+            {
+                interp.update(nServerTimeUSecs + nTransitUSecs + nFrame * 10000);
+                bMonotonic &= (interp.getRenderTimeUSecs() >= nPrevRenderTimeUSecs);
+                nPrevRenderTimeUSecs = interp.getRenderTimeUSecs();
+                if (iUpdate < 2)
+                {
+                    // not ready until 2 updates are added
+                    continue;
+                }
+
+                pge_network::PgeSnapshotInterpolator::EntityState state{};
+                bAllInterpolated &= (Result::Interpolated == interp.getEntityState(entityId, state));
+                const pge_network::PgeSnapshotInterpolator::EntityState stateExpected = getLinearState(interp.getRenderTimeUSecs());
+                bAllExact &= isNear(stateExpected.m_x, state.m_x) && isNear(stateExpected.m_fAngleY, state.m_fAngleY) &&
+                    isNear(2.f, state.m_y) && isNear(3.f, state.m_z);
+            }
+        }
+
+        b &= assertTrue(interp.isReady(), "ready");
+        b &= assertTrue(bAllInterpolated, "interpolated");
+        b &= assertTrue(bAllExact, "exact");
+        b &= assertTrue(bMonotonic, "monotonic");
+
+        // no jitter, so the delay settles at the update interval
+        return (b &
+            assertEquals(nUpdateIntervalUSecs, interp.getUpdateIntervalUSecs(), "interval") &
+            assertEquals(0, interp.getJitterUSecs(), "jitter") &
+            assertEquals(nUpdateIntervalUSecs, interp.getTargetDelayUSecs(), "target delay") &
+            assertEquals(nUpdateIntervalUSecs, interp.getDelayUSecs(), "delay") &
+            assertEquals(0u, interp.getLateSnapshotCount(), "late")) != 0;
+    }
+
+    bool test_interpolate_AngleWrapAround()
+    {
+        pge_network::PgeSnapshotInterpolator interp(0, nMaxDelayUSecs, nMaxExtrapolationUSecs);
+        interp.addSnapshot(nUpdateIntervalUSecs, nUpdateIntervalUSecs);
+        interp.addSnapshot(2 * nUpdateIntervalUSecs, 2 * nUpdateIntervalUSecs);
+        interp.setEntityState(entityId, nUpdateIntervalUSecs, { 0.f, 0.f, 0.f, 350.f, 10.f, 90.f });
+        interp.setEntityState(entityId, 2 * nUpdateIntervalUSecs, { 0.f, 0.f, 0.f, 10.f, 350.f, 90.f });
+
+        // delay is the update interval, so this is halfway between the 2 updates
+        interp.update(2 * nUpdateIntervalUSecs + nUpdateIntervalUSecs / 2);
+
+        pge_network::PgeSnapshotInterpolator::EntityState state{};
+        return (assertTrue(Result::Interpolated == interp.getEntityState(entityId, state), "result") &
+            assertTrue(isNear(0.f, state.m_fAngleX) || isNear(360.f, state.m_fAngleX), "angle x") &
+            assertTrue(isNear(0.f, state.m_fAngleY) || isNear(360.f, state.m_fAngleY), "angle y") &
+            assertTrue(isNear(90.f, state.m_fAngleZ), "angle z") &
+            assertLess(state.m_fAngleX, 360.f, "angle x range") &
+            assertLess(state.m_fAngleY, 360.f, "angle y range")) != 0;
+    }
+
+    bool test_interpolate_BeforeFirstUpdate()
+    {
+        pge_network::PgeSnapshotInterpolator interp(2 * nUpdateIntervalUSecs, nMaxDelayUSecs, nMaxExtrapolationUSecs);
+        addLinearUpdate(interp, nUpdateIntervalUSecs, nTransitUSecs);
+        interp.update(nUpdateIntervalUSecs + nTransitUSecs);
+        bool b = assertFalse(interp.isReady(), "ready after 1st update");
+
+        // entity appears only in the 2nd update
+        interp.addSnapshot(2 * nUpdateIntervalUSecs, 2 * nUpdateIntervalUSecs + nTransitUSecs);
+        interp.setEntityState(entityId + 1, 2 * nUpdateIntervalUSecs, getLinearState(2 * nUpdateIntervalUSecs));
+        interp.update(2 * nUpdateIntervalUSecs + nTransitUSecs);
+
+        pge_network::PgeSnapshotInterpolator::EntityState state{};
+        return (b &
+            assertTrue(interp.isReady(), "ready") &
+            assertEquals(2 * nUpdateIntervalUSecs, interp.getDelayUSecs(), "delay is min delay") &
+            assertEquals(0, interp.getRenderTimeUSecs(), "render time") &
+            assertTrue(Result::Held == interp.getEntityState(entityId + 1, state), "result 2nd") &
+            assertTrue(isNear(100.f, state.m_x), "x 2nd") &
+            assertTrue(Result::Held == interp.getEntityState(entityId, state), "result") &
+            assertTrue(isNear(50.f, state.m_x), "x")) != 0;
+    }
+
+    bool test_extrapolate_Bounded()
+    {
+        pge_network::PgeSnapshotInterpolator interp(0, nMaxDelayUSecs, nMaxExtrapolationUSecs);
+        for (int iUpdate = 1; iUpdate <= 10; iUpdate++)
+        {
+            addLinearUpdate(interp, iUpdate * nUpdateIntervalUSecs, nTransitUSecs);
+        }
+        const TTimeUSecs nLastServerTimeUSecs = 10 * nUpdateIntervalUSecs;
+        interp.update(nLastServerTimeUSecs + nTransitUSecs);
+
+        // updates stop arriving: render time passes the last update by half of the max extrapolation time
+        const TTimeUSecs nLocalTimeExtrapolatedUSecs = nLastServerTimeUSecs + nTransitUSecs + nUpdateIntervalUSecs + nMaxExtrapolationUSecs / 2;
+        interp.update(nLocalTimeExtrapolatedUSecs);
+        pge_network::PgeSnapshotInterpolator::EntityState state{};
+        bool b = assertTrue(Result::Extrapolated == interp.getEntityState(entityId, state), "result 1");
+        b &= assertTrue(isNear(getLinearState(interp.getRenderTimeUSecs()).m_x, state.m_x), "x 1");
+
+        // far beyond max extrapolation time: held at the state extrapolated up to the limit
+        interp.update(nLocalTimeExtrapolatedUSecs + 10 * nMaxExtrapolationUSecs);
+        b &= assertTrue(Result::Held == interp.getEntityState(entityId, state), "result 2");
+        b &= assertTrue(isNear(getLinearState(nLastServerTimeUSecs + nMaxExtrapolationUSecs).m_x, state.m_x), "x 2");
+
+        // entity with a single update cannot be extrapolated
+        interp.setEntityState(entityId + 1, nLastServerTimeUSecs, getLinearState(nLastServerTimeUSecs));
+        b &= assertTrue(Result::Held == interp.getEntityState(entityId + 1, state), "result single");
+        b &= assertTrue(isNear(getLinearState(nLastServerTimeUSecs).m_x, state.m_x), "x single");
+
+        return b;
+    }
+
+    bool test_teleported()
+    {
+        pge_network::PgeSnapshotInterpolator interp(0, nMaxDelayUSecs, 0);
+        for (int iUpdate = 1; iUpdate <= 4; iUpdate++)
+        {
+            addLinearUpdate(interp, iUpdate * nUpdateIntervalUSecs, nTransitUSecs);
+        }
+        interp.addSnapshot(5 * nUpdateIntervalUSecs, 5 * nUpdateIntervalUSecs + nTransitUSecs);
+        interp.setEntityState(entityId, 5 * nUpdateIntervalUSecs, { 1000.f, 0.f, 0.f, 0.f, 0.f, 0.f }, true);
+
+        // halfway between update 4 and 5, but teleported at 5, so old states are not used anymore
+        interp.update(5 * nUpdateIntervalUSecs + nTransitUSecs + nUpdateIntervalUSecs / 2);
+        pge_network::PgeSnapshotInterpolator::EntityState state{};
+        bool b = assertTrue(Result::Held == interp.getEntityState(entityId, state), "result 1");
+        b &= assertTrue(isNear(1000.f, state.m_x), "x 1");
+
+        addLinearUpdate(interp, 6 * nUpdateIntervalUSecs, nTransitUSecs);
+        interp.setEntityState(entityId, 6 * nUpdateIntervalUSecs, { 1100.f, 0.f, 0.f, 0.f, 0.f, 0.f });
+        interp.update(6 * nUpdateIntervalUSecs + nTransitUSecs + nUpdateIntervalUSecs / 2);
+        b &= assertTrue(Result::Interpolated == interp.getEntityState(entityId, state), "result 2");
+        b &= assertTrue(isNear(1050.f, state.m_x), "x 2");
+
+        return b;
+    }
+
+    bool test_delay_AdaptsToJitter()
+    {
+        pge_network::PgeSnapshotInterpolator interp(0, nMaxDelayUSecs, nMaxExtrapolationUSecs);
+        for (int iUpdate = 1; iUpdate <= 10; iUpdate++)
+        {
+            addLinearUpdate(interp, iUpdate * nUpdateIntervalUSecs, nTransitUSecs);
+        }
+        TTimeUSecs nLocalTimeUSecs = 10 * nUpdateIntervalUSecs + nTransitUSecs;
+        interp.update(nLocalTimeUSecs);
+        bool b = assertEquals(nUpdateIntervalUSecs, interp.getDelayUSecs(), "delay before jitter");
+
+        // from now every 2nd update is 40 ms late
+        constexpr TTimeUSecs nJitterUSecs = 40000;
+        const TTimeUSecs nTargetDelayUSecs = nUpdateIntervalUSecs + nJitterUSecs;
+        TTimeUSecs nPrevRenderTimeUSecs = interp.getRenderTimeUSecs();
+        TTimeUSecs nPrevDelayUSecs = interp.getDelayUSecs();
+        bool bMonotonic = true;
+        bool bGradual = true;
+        bool bAllAvailable = true;
+        for (int iUpdate = 11; iUpdate <= 100; iUpdate++)
+        {
+            const TTimeUSecs nServerTimeUSecs = iUpdate * nUpdateIntervalUSecs;
+            addLinearUpdate(interp, nServerTimeUSecs, nTransitUSecs + ((iUpdate % 2 == 0) ? nJitterUSecs : 0));
+            for (TTimeUSecs nFrame = 0; nFrame < 5; nFrame++)
+            {
+                nLocalTimeUSecs += 10000;
+                interp.update(nLocalTimeUSecs);
+                bMonotonic &= (interp.getRenderTimeUSecs() > nPrevRenderTimeUSecs);
+                bGradual &= (std::abs(interp.getDelayUSecs() - nPrevDelayUSecs) <= 10000 * pge_network::PgeSnapshotInterpolator::nDelayAdjustPercent / 100);
+                nPrevRenderTimeUSecs = interp.getRenderTimeUSecs();
+                nPrevDelayUSecs = interp.getDelayUSecs();
+
+                if (iUpdate > 50)
+                {
+                    // delay has adapted, render time is always between 2 arrived updates
+                    pge_network::PgeSnapshotInterpolator::EntityState state{};
+                    bAllAvailable &= (Result::Interpolated == interp.getEntityState(entityId, state));
+                }
+            }
+        }
+
+        return (b &
+            assertTrue(bMonotonic, "monotonic") &
+            assertTrue(bGradual, "gradual") &
+            assertTrue(bAllAvailable, "available") &
+            assertEquals(nJitterUSecs, interp.getJitterUSecs(), "jitter") &
+            assertEquals(nTargetDelayUSecs, interp.getTargetDelayUSecs(), "target delay") &
+            assertEquals(nTargetDelayUSecs, interp.getDelayUSecs(), "delay")) != 0;
+    }
+
+    bool test_delay_Clamped()
+    {
+        constexpr TTimeUSecs nMinDelayUSecs = 80000;
+        constexpr TTimeUSecs nSmallMaxDelayUSecs = 120000;
+        pge_network::PgeSnapshotInterpolator interp(nMinDelayUSecs, nSmallMaxDelayUSecs, nMaxExtrapolationUSecs);
+
+        for (int iUpdate = 1; iUpdate <= 10; iUpdate++)
+        {
+            addLinearUpdate(interp, iUpdate * nUpdateIntervalUSecs, nTransitUSecs);
+        }
+        interp.update(10 * nUpdateIntervalUSecs + nTransitUSecs);
+        bool b = assertEquals(nMinDelayUSecs, interp.getTargetDelayUSecs(), "min target delay");
+        b &= assertEquals(nMinDelayUSecs, interp.getDelayUSecs(), "min delay");
+
+        addLinearUpdate(interp, 11 * nUpdateIntervalUSecs, nTransitUSecs + 500000);
+        b &= assertEquals(nSmallMaxDelayUSecs, interp.getTargetDelayUSecs(), "max target delay");
+
+        return b;
+    }
+
+    bool test_lateAndOutOfOrderSnapshots()
+    {
+        pge_network::PgeSnapshotInterpolator interp(0, nMaxDelayUSecs, nMaxExtrapolationUSecs);
+        for (int iUpdate = 1; iUpdate <= 10; iUpdate++)
+        {
+            addLinearUpdate(interp, iUpdate * nUpdateIntervalUSecs, nTransitUSecs);
+        }
+        interp.update(10 * nUpdateIntervalUSecs + nTransitUSecs);
+        const TTimeUSecs nIntervalUSecs = interp.getUpdateIntervalUSecs();
+        const TTimeUSecs nJitterUSecs = interp.getJitterUSecs();
+
+        // older than render time: late, and ignored for timing
+        addLinearUpdate(interp, 5 * nUpdateIntervalUSecs, nTransitUSecs);
+        // duplicate of the newest: not late, also ignored for timing
+        interp.addSnapshot(10 * nUpdateIntervalUSecs, 10 * nUpdateIntervalUSecs + nTransitUSecs + 1000);
+
+        pge_network::PgeSnapshotInterpolator::EntityState state{};
+        return (assertEquals(1u, interp.getLateSnapshotCount(), "late") &
+            assertEquals(nIntervalUSecs, interp.getUpdateIntervalUSecs(), "interval") &
+            assertEquals(nJitterUSecs, interp.getJitterUSecs(), "jitter") &
+            assertTrue(Result::Interpolated == interp.getEntityState(entityId, state), "result") &
+            assertTrue(isNear(getLinearState(interp.getRenderTimeUSecs()).m_x, state.m_x), "x")) != 0;
+    }
+
+    bool test_clear()
+    {
+        pge_network::PgeSnapshotInterpolator interp(0, nMaxDelayUSecs, nMaxExtrapolationUSecs);
+        for (int iUpdate = 1; iUpdate <= 3; iUpdate++)
+        {
+            addLinearUpdate(interp, iUpdate * nUpdateIntervalUSecs, nTransitUSecs);
+        }
+        interp.update(3 * nUpdateIntervalUSecs + nTransitUSecs);
+        addLinearUpdate(interp, nUpdateIntervalUSecs, nTransitUSecs);  // late
+
+        bool b = assertTrue(interp.isReady(), "ready before clear");
+        interp.clear();
+        b &= assertFalse(interp.isReady(), "ready after clear");
+        b &= assertEquals(0u, interp.getEntityCount(), "entity count after clear");
+
+        // new server with its own clock starting over
+        addLinearUpdate(interp, 1000, 100);
+        addLinearUpdate(interp, 2000, 100);
+        interp.update(2100);
+
+        return (b &
+            assertEquals(1u, interp.getEntityCount(), "entity count") &
+            assertEquals(1000, interp.getUpdateIntervalUSecs(), "interval") &
+            assertEquals(0, interp.getJitterUSecs(), "jitter") &
+            assertEquals(1000, interp.getDelayUSecs(), "delay") &
+            assertEquals(1000, interp.getRenderTimeUSecs(), "render time") &
+            assertEquals(1u, interp.getLateSnapshotCount(), "late kept")) != 0;
+    }
+
+}; // class PgeSnapshotInterpolatorTest
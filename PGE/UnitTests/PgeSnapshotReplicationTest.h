@@ -0,0 +1,732 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeSnapshotReplicationTest.h
+    Unit test for PgeSnapshot, PgeSnapshotSender and PgeSnapshotReceiver.
+    Made by PR00F88, West Whiskhyll Entertainment
+    2026
+    ###################################################################################
+*/
+
+#include "UnitTest.h"  // PCH
+
+#include "../Config/PgeOldNewValue.h"
+#include "../Network/PgeSnapshot.h"
+#include "../Network/PgeSnapshotReceiver.h"
+#include "../Network/PgeSnapshotSender.h"
+#include "../Network/Stubs/PgeClientStub.h"
+#include "../Network/Stubs/PgeServerStub.h"
+
+#include <set>
+#include <stdexcept>
+
+class PgeSnapshotReplicationTest :
+    public UnitTest
+{
+public:
+
+    PgeSnapshotReplicationTest() :
+        UnitTest(__FILE__)
+    {
+    }
+
+protected:
+
+    virtual void initialize() override
+    {
+        addSubTest("test_snapshot_ctor_Bad", (PFNUNITSUBTEST)&PgeSnapshotReplicationTest::test_snapshot_ctor_Bad);
+        addSubTest("test_snapshot_setField_and_getField", (PFNUNITSUBTEST)&PgeSnapshotReplicationTest::test_snapshot_setField_and_getField);
+        addSubTest("test_snapshot_setField_OldNewValue", (PFNUNITSUBTEST)&PgeSnapshotReplicationTest::test_snapshot_setField_OldNewValue);
+        addSubTest("test_snapshot_getChangedFieldsMask", (PFNUNITSUBTEST)&PgeSnapshotReplicationTest::test_snapshot_getChangedFieldsMask);
+        addSubTest("test_sender_receiver_ctor_Bad", (PFNUNITSUBTEST)&PgeSnapshotReplicationTest::test_sender_receiver_ctor_Bad);
+        addSubTest("test_sendSnapshot_NothingCommitted", (PFNUNITSUBTEST)&PgeSnapshotReplicationTest::test_sendSnapshot_NothingCommitted);
+        addSubTest("test_full_then_delta", (PFNUNITSUBTEST)&PgeSnapshotReplicationTest::test_full_then_delta);
+        addSubTest("test_delta_NothingChanged", (PFNUNITSUBTEST)&PgeSnapshotReplicationTest::test_delta_NothingChanged);
+        addSubTest("test_delta_EntityAddedAndRemoved", (PFNUNITSUBTEST)&PgeSnapshotReplicationTest::test_delta_EntityAddedAndRemoved);
+        addSubTest("test_delta_RelevantEntitiesOnly", (PFNUNITSUBTEST)&PgeSnapshotReplicationTest::test_delta_RelevantEntitiesOnly);
+        addSubTest("test_delta_AgainstLastAckedAfterSnapshotLoss", (PFNUNITSUBTEST)&PgeSnapshotReplicationTest::test_delta_AgainstLastAckedAfterSnapshotLoss);
+        addSubTest("test_fallbackToFull_AfterAckLoss", (PFNUNITSUBTEST)&PgeSnapshotReplicationTest::test_fallbackToFull_AfterAckLoss);
+        addSubTest("test_removeClient_FallbackToFull", (PFNUNITSUBTEST)&PgeSnapshotReplicationTest::test_removeClient_FallbackToFull);
+        addSubTest("test_multiPart", (PFNUNITSUBTEST)&PgeSnapshotReplicationTest::test_multiPart);
+        addSubTest("test_multiPart_PartLoss", (PFNUNITSUBTEST)&PgeSnapshotReplicationTest::test_multiPart_PartLoss);
+        addSubTest("test_receiver_IgnoresOldAndDuplicateAndUnknown", (PFNUNITSUBTEST)&PgeSnapshotReplicationTest::test_receiver_IgnoresOldAndDuplicateAndUnknown);
+        addSubTest("test_sender_handleAckPkt_Bad", (PFNUNITSUBTEST)&PgeSnapshotReplicationTest::test_sender_handleAckPkt_Bad);
+    }
+
+private:
+
+    static constexpr pge_network::MsgApp::TMsgId msgIdSnapshot = 10;
+    static constexpr pge_network::MsgApp::TMsgId msgIdAck = 11;
+    static constexpr pge_network::PgeNetworkConnectionHandle connHandleClient = 5;
+
+    // posX, posY, health, frags
+    const std::vector<uint8_t> vFieldSizes{ sizeof(float), sizeof(float), sizeof(uint8_t), sizeof(uint16_t) };
+    static constexpr std::size_t iFieldPosX = 0;
+    static constexpr std::size_t iFieldPosY = 1;
+    static constexpr std::size_t iFieldHealth = 2;
+    static constexpr std::size_t iFieldFrags = 3;
+
+    PGEcfgProfiles cfgProfiles;
+
+    // ---------------------------------------------------------------------------
+
+    PgeSnapshotReplicationTest(const PgeSnapshotReplicationTest&)
+    {};
+
+    PgeSnapshotReplicationTest& operator=(const PgeSnapshotReplicationTest&)
+    {
+        return *this;
+    };
+
+    static void setPlayer(pge_network::PgeSnapshot& snapshot, const pge_network::PgeSnapshot::TEntityId& entityId, float fPosX, uint8_t nHealth)
+    {
+        snapshot.setField(entityId, iFieldPosX, fPosX);
+        snapshot.setField(entityId, iFieldPosY, fPosX * 2.f);
+        snapshot.setField(entityId, iFieldHealth, nHealth);
+        snapshot.setField(entityId, iFieldFrags, static_cast<uint16_t>(entityId * 10u));
+    }
+
+    /**
+        Delivers the packets sent by server to the receiver, except those having index in the given set.
+        Server tx packets are cleared.
+    */
+    static void deliverToClient(
+        pge_network::PgeServerStub& server,
+        pge_network::PgeClientStub& client,
+        pge_network::PgeSnapshotReceiver& receiver,
+        const std::set<std::size_t>& setDroppedIndices = {})
+    {
+        const auto& vTxPkts = server.getTxPackets();
+        for (std::size_t i = 0; i < vTxPkts.size(); i++)
+        {
+            if (setDroppedIndices.find(i) == setDroppedIndices.end())
+            {
+                receiver.handleSnapshotPkt(client, vTxPkts[i].second);
+            }
+        }
+        server.clearTxPackets();
+    }
+
+    /**
+        Delivers the packets sent by client to the sender, unless dropped.
+        Client tx packets are cleared.
+    */
+    static void deliverToServer(
+        pge_network::PgeClientStub& client,
+        pge_network::PgeSnapshotSender& sender,
+        bool bDrop = false)
+    {
+        if (!bDrop)
+        {
+            for (const auto& connHandleAndPkt : client.getTxPackets())
+            {
+                pge_network::PgePacket pkt = connHandleAndPkt.second;
+                // as done by PgeGnsServer::updateIncomingPgePacket()
+                pge_network::PgePacket::getServerSideConnectionHandle(pkt) = connHandleClient;
+                sender.handleAckPkt(pkt);
+            }
+        }
+        client.clearTxPackets();
+    }
+
+    /**
+        Commits the working snapshot of the sender, sends it to the client and delivers all packets in both directions.
+    */
+    static bool replicate(
+        pge_network::PgeServerStub& server,
+        pge_network::PgeClientStub& client,
+        pge_network::PgeSnapshotSender& sender,
+        pge_network::PgeSnapshotReceiver& receiver)
+    {
+        sender.commitSnapshot();
+        if (!sender.sendSnapshot(server, connHandleClient))
+        {
+            return false;
+        }
+        deliverToClient(server, client, receiver);
+        deliverToServer(client, sender);
+        return true;
+    }
+
+    static pge_network::MsgApp::TMsgSize getTxMsgAppDataSize(const pge_network::PgeServerStub& server, std::size_t iPkt)
+    {
+        return pge_network::MsgApp::getMsgAppDataActualSizeBytes(
+            *pge_network::PgePacket::getMsgAppFromPkt(server.getTxPackets()[iPkt].second));
+    }
+
+    static const pge_network::MsgSnapshotPartHeader& getTxPartHeader(const pge_network::PgeServerStub& server, std::size_t iPkt)
+    {
+        return pge_network::PgePacket::getMsgAppDataFromPkt<pge_network::MsgSnapshotPartHeader>(server.getTxPackets()[iPkt].second);
+    }
+
+    bool test_snapshot_ctor_Bad()
+    {
+        bool b = true;
+        const std::vector<std::vector<uint8_t>> vvBadFieldSizes{
+            {},
+            { 4, 0 },
+            { 4, pge_network::PgeSnapshot::nMaxFieldSizeBytes + 1 },
+            std::vector<uint8_t>(pge_network::PgeSnapshot::nMaxFieldCount + 1, 1)
+        };
+
+        for (const auto& vBadFieldSizes : vvBadFieldSizes)
+        {
+            try
+            {
+                const pge_network::PgeSnapshot snapshot(vBadFieldSizes);
+                b = assertTrue(false, "no exception") & b;
+            }
+            catch (const std::exception&)
+            {
+            }
+        }
+
+        const pge_network::PgeSnapshot snapshot(vFieldSizes);
+        b &= assertEquals(0u, snapshot.getSequence(), "sequence");
+        b &= assertEquals(vFieldSizes.size(), snapshot.getFieldCount(), "field count");
+        b &= assertEquals(sizeof(float), static_cast<std::size_t>(snapshot.getFieldSize(iFieldPosX)), "field size 0");
+        b &= assertEquals(sizeof(uint16_t), static_cast<std::size_t>(snapshot.getFieldSize(iFieldFrags)), "field size 3");
+        b &= assertEquals(0u, static_cast<unsigned>(snapshot.getFieldSize(vFieldSizes.size())), "field size out of range");
+        b &= assertEquals(0x0Fu, static_cast<unsigned>(snapshot.getAllFieldsMask()), "all fields mask");
+        b &= assertTrue(snapshot.getEntities().empty(), "entities");
+
+        return b;
+    }
+
+    bool test_snapshot_setField_and_getField()
+    {
+        pge_network::PgeSnapshot snapshot(vFieldSizes);
+
+        bool b = assertTrue(snapshot.setField(7, iFieldPosX, 1.5f), "set 7");
+        b &= assertTrue(snapshot.setField(3, iFieldFrags, static_cast<uint16_t>(42)), "set 3");
+        b &= assertFalse(snapshot.setField(3, iFieldFrags, 42u), "set size mismatch");
+        b &= assertFalse(snapshot.setField(3, vFieldSizes.size(), 1.f), "set field out of range");
+
+        b &= assertEquals(2u, snapshot.getEntities().size(), "entity count");
+        b &= assertEquals(3u, snapshot.getEntities()[0].m_id, "entities sorted 0");
+        b &= assertEquals(7u, snapshot.getEntities()[1].m_id, "entities sorted 1");
+
+        float fPosX = 0.f;
+        uint16_t nFrags = 0;
+        b &= assertTrue(snapshot.getField(7, iFieldPosX, fPosX), "get 7");
+        b &= assertEquals(1.5f, fPosX, "posX 7");
+        b &= assertTrue(snapshot.getField(7, iFieldFrags, nFrags), "get 7 frags");
+        b &= assertEquals(0u, nFrags, "frags 7 zero-initialized");
+        b &= assertTrue(snapshot.getField(3, iFieldFrags, nFrags), "get 3");
+        b &= assertEquals(42u, nFrags, "frags 3");
+        b &= assertFalse(snapshot.getField(4, iFieldFrags, nFrags), "get nonexisting");
+        b &= assertFalse(snapshot.getField(3, iFieldPosX, nFrags), "get size mismatch");
+
+        b &= assertTrue(snapshot.hasEntity(3), "has 3");
+        b &= assertTrue(snapshot.removeEntity(3), "remove 3");
+        b &= assertFalse(snapshot.removeEntity(3), "remove 3 again");
+        b &= assertFalse(snapshot.hasEntity(3), "has 3 after remove");
+        b &= assertNull(snapshot.getEntity(3), "getEntity 3 after remove");
+        b &= assertNotNull(snapshot.getEntity(7), "getEntity 7");
+
+        snapshot.setSequence(5);
+        snapshot.clear();
+        b &= assertTrue(snapshot.getEntities().empty(), "cleared");
+        b &= assertEquals(5u, snapshot.getSequence(), "sequence kept");
+
+        return b;
+    }
+
+    bool test_snapshot_setField_OldNewValue()
+    {
+        pge_network::PgeSnapshot snapshot(vFieldSizes);
+        PgeOldNewValue<float> posX(1.f);
+        posX.set(2.f);
+
+        bool b = assertTrue(snapshot.setField(1, iFieldPosX, posX), "set");
+        float fPosX = 0.f;
+        b &= assertTrue(snapshot.getField(1, iFieldPosX, fPosX), "get");
+        b &= assertEquals(2.f, fPosX, "new value is replicated");
+
+        return b;
+    }
+
+    bool test_snapshot_getChangedFieldsMask()
+    {
+        pge_network::PgeSnapshot snapshotOld(vFieldSizes);
+        setPlayer(snapshotOld, 1, 10.f, 100);
+        pge_network::PgeSnapshot snapshotNew(snapshotOld);
+
+        bool b = assertEquals(0u, static_cast<unsigned>(snapshotNew.getChangedFieldsMask(snapshotOld.getEntities()[0], snapshotNew.getEntities()[0])), "unchanged");
+        b &= assertTrue(snapshotNew.isEqualState(snapshotOld), "equal state");
+
+        snapshotNew.setField(1, iFieldHealth, static_cast<uint8_t>(50));
+        snapshotNew.setField(1, iFieldPosY, 3.f);
+        b &= assertEquals(
+            static_cast<unsigned>((1u << iFieldHealth) | (1u << iFieldPosY)),
+            static_cast<unsigned>(snapshotNew.getChangedFieldsMask(snapshotOld.getEntities()[0], snapshotNew.getEntities()[0])),
+            "changed");
+        b &= assertFalse(snapshotNew.isEqualState(snapshotOld), "not equal state");
+
+        return b;
+    }
+
+    bool test_sender_receiver_ctor_Bad()
+    {
+        bool b = true;
+        try
+        {
+            const pge_network::PgeSnapshotSender sender(vFieldSizes, msgIdSnapshot, msgIdSnapshot);
+            b = assertTrue(false, "sender no exception");
+        }
+        catch (const std::exception&)
+        {
+        }
+
+        try
+        {
+            const pge_network::PgeSnapshotReceiver receiver(vFieldSizes, msgIdAck, msgIdAck);
+            b = assertTrue(false, "receiver no exception") & b;
+        }
+        catch (const std::exception&)
+        {
+        }
+
+        const pge_network::PgeSnapshotSender sender(vFieldSizes, msgIdSnapshot, msgIdAck);
+        const pge_network::PgeSnapshotReceiver receiver(vFieldSizes, msgIdSnapshot, msgIdAck);
+        b &= assertEquals(msgIdSnapshot, sender.getMsgIdSnapshot(), "sender msgIdSnapshot");
+        b &= assertEquals(msgIdAck, sender.getMsgIdAck(), "sender msgIdAck");
+        b &= assertEquals(0u, sender.getLastCommittedSequence(), "sender seq");
+        b &= assertEquals(0u, sender.getAckedSequence(connHandleClient), "sender acked seq");
+        b &= assertEquals(msgIdSnapshot, receiver.getMsgIdSnapshot(), "receiver msgIdSnapshot");
+        b &= assertEquals(msgIdAck, receiver.getMsgIdAck(), "receiver msgIdAck");
+        b &= assertEquals(0u, receiver.getLatestSequence(), "receiver seq");
+        b &= assertEquals(0u, receiver.getLatestSnapshot().getSequence(), "receiver latest snapshot seq");
+        b &= assertEquals(0u, receiver.getDroppedSnapshotCount(), "receiver dropped");
+
+        return b;
+    }
+
+    bool test_sendSnapshot_NothingCommitted()
+    {
+        pge_network::PgeServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeSnapshotSender sender(vFieldSizes, msgIdSnapshot, msgIdAck);
+
+        bool b = assertFalse(sender.sendSnapshot(server, connHandleClient), "send");
+        b &= assertTrue(server.getTxPackets().empty(), "tx");
+
+        return b;
+    }
+
+    bool test_full_then_delta()
+    {
+        pge_network::PgeServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeClientStub client(cfgProfiles);
+        pge_network::PgeSnapshotSender sender(vFieldSizes, msgIdSnapshot, msgIdAck);
+        pge_network::PgeSnapshotReceiver receiver(vFieldSizes, msgIdSnapshot, msgIdAck);
+
+        setPlayer(sender.getSnapshot(), 1, 10.f, 100);
+        setPlayer(sender.getSnapshot(), 2, 20.f, 100);
+
+        bool b = assertEquals(1u, sender.commitSnapshot(), "commit 1");
+        b &= assertTrue(sender.sendSnapshot(server, connHandleClient), "send 1");
+        b &= assertEquals(1u, server.getTxPackets().size(), "tx 1");
+        b &= assertEquals(connHandleClient, server.getTxPackets()[0].first, "tx 1 conn");
+        b &= assertEquals(0u, getTxPartHeader(server, 0).m_seqBaseline, "tx 1 full");
+        b &= assertEquals(1u, sender.getFullSnapshotSentCount(), "full count 1");
+        const std::size_t nFullSize = getTxMsgAppDataSize(server, 0);
+        b &= assertEquals(
+            sizeof(pge_network::MsgSnapshotPartHeader) + 2 * (sizeof(uint32_t) + sizeof(uint16_t) + 11u),
+            nFullSize,
+            "full size");
+
+        deliverToClient(server, client, receiver);
+        b &= assertEquals(1u, receiver.getLatestSequence(), "receiver seq 1");
+        b &= assertTrue(receiver.getLatestSnapshot().isEqualState(sender.getSnapshot()), "receiver state 1");
+        b &= assertEquals(1u, client.getTxPackets().size(), "ack 1 sent");
+        b &= assertEquals(pge_network::ServerConnHandle, client.getTxPackets()[0].first, "ack 1 conn");
+
+        deliverToServer(client, sender);
+        b &= assertEquals(1u, sender.getAckedSequence(connHandleClient), "acked 1");
+
+        // only health of player 2 changes
+        sender.getSnapshot().setField(2, iFieldHealth, static_cast<uint8_t>(75));
+        b &= assertEquals(2u, sender.commitSnapshot(), "commit 2");
+        b &= assertTrue(sender.sendSnapshot(server, connHandleClient), "send 2");
+        b &= assertEquals(1u, server.getTxPackets().size(), "tx 2");
+        b &= assertEquals(1u, getTxPartHeader(server, 0).m_seqBaseline, "tx 2 delta");
+        b &= assertEquals(1u, sender.getDeltaSnapshotSentCount(), "delta count");
+        b &= assertEquals(
+            sizeof(pge_network::MsgSnapshotPartHeader) + sizeof(uint32_t) + sizeof(uint16_t) + sizeof(uint8_t),
+            static_cast<std::size_t>(getTxMsgAppDataSize(server, 0)),
+            "delta size");
+
+        deliverToClient(server, client, receiver);
+        deliverToServer(client, sender);
+        b &= assertEquals(2u, receiver.getLatestSequence(), "receiver seq 2");
+        b &= assertTrue(receiver.getLatestSnapshot().isEqualState(sender.getSnapshot()), "receiver state 2");
+        b &= assertEquals(2u, sender.getAckedSequence(connHandleClient), "acked 2");
+
+        uint8_t nHealth = 0;
+        b &= assertTrue(receiver.getLatestSnapshot().getField(2, iFieldHealth, nHealth), "get health");
+        b &= assertEquals(75u, nHealth, "health");
+        b &= assertEquals(0u, receiver.getDroppedSnapshotCount(), "dropped");
+
+        return b;
+    }
+
+    bool test_delta_NothingChanged()
+    {
+        pge_network::PgeServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeClientStub client(cfgProfiles);
+        pge_network::PgeSnapshotSender sender(vFieldSizes, msgIdSnapshot, msgIdAck);
+        pge_network::PgeSnapshotReceiver receiver(vFieldSizes, msgIdSnapshot, msgIdAck);
+
+        setPlayer(sender.getSnapshot(), 1, 10.f, 100);
+        bool b = assertTrue(replicate(server, client, sender, receiver), "replicate 1");
+
+        sender.commitSnapshot();
+        b &= assertTrue(sender.sendSnapshot(server, connHandleClient), "send 2");
+        b &= assertEquals(1u, server.getTxPackets().size(), "tx 2");
+        b &= assertEquals(sizeof(pge_network::MsgSnapshotPartHeader), static_cast<std::size_t>(getTxMsgAppDataSize(server, 0)), "header only");
+
+        deliverToClient(server, client, receiver);
+        deliverToServer(client, sender);
+        b &= assertEquals(2u, receiver.getLatestSequence(), "receiver seq 2");
+        b &= assertTrue(receiver.getLatestSnapshot().isEqualState(sender.getSnapshot()), "receiver state 2");
+        b &= assertEquals(2u, sender.getAckedSequence(connHandleClient), "acked 2");
+
+        return b;
+    }
+
+    bool test_delta_EntityAddedAndRemoved()
+    {
+        pge_network::PgeServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeClientStub client(cfgProfiles);
+        pge_network::PgeSnapshotSender sender(vFieldSizes, msgIdSnapshot, msgIdAck);
+        pge_network::PgeSnapshotReceiver receiver(vFieldSizes, msgIdSnapshot, msgIdAck);
+
+        setPlayer(sender.getSnapshot(), 1, 10.f, 100);
+        setPlayer(sender.getSnapshot(), 2, 20.f, 100);
+        bool b = assertTrue(replicate(server, client, sender, receiver), "replicate 1");
+
+        sender.getSnapshot().removeEntity(1);
+        setPlayer(sender.getSnapshot(), 3, 30.f, 100);
+        b &= assertTrue(replicate(server, client, sender, receiver), "replicate 2");
+
+        b &= assertEquals(2u, receiver.getLatestSequence(), "receiver seq 2");
+        b &= assertFalse(receiver.getLatestSnapshot().hasEntity(1), "receiver 1 removed");
+        b &= assertTrue(receiver.getLatestSnapshot().hasEntity(3), "receiver 3 added");
+        b &= assertTrue(receiver.getLatestSnapshot().isEqualState(sender.getSnapshot()), "receiver state 2");
+        b &= assertEquals(1u, sender.getFullSnapshotSentCount(), "full count");
+        b &= assertEquals(1u, sender.getDeltaSnapshotSentCount(), "delta count");
+
+        return b;
+    }
+
+    bool test_delta_RelevantEntitiesOnly()
+    {
+        pge_network::PgeServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeClientStub client(cfgProfiles);
+        pge_network::PgeSnapshotSender sender(vFieldSizes, msgIdSnapshot, msgIdAck);
+        pge_network::PgeSnapshotReceiver receiver(vFieldSizes, msgIdSnapshot, msgIdAck);
+
+        setPlayer(sender.getSnapshot(), 1, 10.f, 100);
+        setPlayer(sender.getSnapshot(), 2, 20.f, 100);
+        setPlayer(sender.getSnapshot(), 3, 30.f, 100);
+
+        // full snapshot with 1 and 2 only
+        const std::vector<pge_network::PgeSnapshot::TEntityId> vRelevant12{ 1, 2 };
+        sender.commitSnapshot();
+        bool b = assertTrue(sender.sendSnapshot(server, connHandleClient, &vRelevant12), "send 1");
+        deliverToClient(server, client, receiver);
+        deliverToServer(client, sender);
+        b &= assertTrue(receiver.getLatestSnapshot().hasEntity(1), "receiver 1 has 1");
+        b &= assertTrue(receiver.getLatestSnapshot().hasEntity(2), "receiver 1 has 2");
+        b &= assertFalse(receiver.getLatestSnapshot().hasEntity(3), "receiver 1 no 3");
+
+        // delta: 1 leaves, 3 enters, 2 changes while staying relevant
+        const std::vector<pge_network::PgeSnapshot::TEntityId> vRelevant23{ 2, 3 };
+        sender.getSnapshot().setField(2, iFieldHealth, static_cast<uint8_t>(50));
+        sender.commitSnapshot();
+        b &= assertTrue(sender.sendSnapshot(server, connHandleClient, &vRelevant23), "send 2");
+        b &= assertEquals(1u, getTxPartHeader(server, 0).m_seqBaseline, "tx 2 baseline");
+        deliverToClient(server, client, receiver);
+        deliverToServer(client, sender);
+
+        uint8_t nHealth = 0;
+        b &= assertEquals(2u, receiver.getLatestSequence(), "receiver seq 2");
+        b &= assertFalse(receiver.getLatestSnapshot().hasEntity(1), "receiver 2 no 1");
+        b &= assertTrue(receiver.getLatestSnapshot().hasEntity(3), "receiver 2 has 3");
+        b &= assertTrue(receiver.getLatestSnapshot().getField(2, iFieldHealth, nHealth), "receiver 2 health");
+        b &= assertEquals(50u, static_cast<uint32_t>(nHealth), "receiver 2 health value");
+
+        // delta without filtering: 1 enters again, receiver gets the full state
+        b &= assertTrue(replicate(server, client, sender, receiver), "replicate 3");
+        b &= assertTrue(receiver.getLatestSnapshot().isEqualState(sender.getSnapshot()), "receiver state 3");
+        b &= assertEquals(1u, sender.getFullSnapshotSentCount(), "full count");
+        b &= assertEquals(2u, sender.getDeltaSnapshotSentCount(), "delta count");
+
+        return b;
+    }
+
+    bool test_delta_AgainstLastAckedAfterSnapshotLoss()
+    {
+        pge_network::PgeServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeClientStub client(cfgProfiles);
+        pge_network::PgeSnapshotSender sender(vFieldSizes, msgIdSnapshot, msgIdAck);
+        pge_network::PgeSnapshotReceiver receiver(vFieldSizes, msgIdSnapshot, msgIdAck);
+
+        setPlayer(sender.getSnapshot(), 1, 10.f, 100);
+        bool b = assertTrue(replicate(server, client, sender, receiver), "replicate 1");
+
+        // snapshot 2 is lost
+        sender.getSnapshot().setField(1, iFieldPosX, 11.f);
+        sender.commitSnapshot();
+        b &= assertTrue(sender.sendSnapshot(server, connHandleClient), "send 2");
+        deliverToClient(server, client, receiver, { 0 });
+        b &= assertEquals(1u, receiver.getLatestSequence(), "receiver seq after loss");
+
+        // snapshot 3 is still encoded against 1, so it carries the change of snapshot 2 too
+        sender.getSnapshot().setField(1, iFieldHealth, static_cast<uint8_t>(90));
+        sender.commitSnapshot();
+        b &= assertTrue(sender.sendSnapshot(server, connHandleClient), "send 3");
+        b &= assertEquals(1u, getTxPartHeader(server, 0).m_seqBaseline, "tx 3 baseline");
+        deliverToClient(server, client, receiver);
+        deliverToServer(client, sender);
+
+        b &= assertEquals(3u, receiver.getLatestSequence(), "receiver seq 3");
+        b &= assertTrue(receiver.getLatestSnapshot().isEqualState(sender.getSnapshot()), "receiver state 3");
+        b &= assertEquals(3u, sender.getAckedSequence(connHandleClient), "acked 3");
+        b &= assertEquals(1u, sender.getFullSnapshotSentCount(), "full count");
+        b &= assertEquals(2u, sender.getDeltaSnapshotSentCount(), "delta count");
+
+        return b;
+    }
+
+    bool test_fallbackToFull_AfterAckLoss()
+    {
+        pge_network::PgeServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeClientStub client(cfgProfiles);
+        pge_network::PgeSnapshotSender sender(vFieldSizes, msgIdSnapshot, msgIdAck);
+        pge_network::PgeSnapshotReceiver receiver(vFieldSizes, msgIdSnapshot, msgIdAck);
+
+        setPlayer(sender.getSnapshot(), 1, 10.f, 100);
+        bool b = assertTrue(replicate(server, client, sender, receiver), "replicate 1");
+
+        // all acks are lost until the acked baseline is the oldest snapshot in the history
+        for (std::size_t i = 0; i < pge_network::PgeSnapshot::nHistorySize - 1; i++)
+        {
+            sender.getSnapshot().setField(1, iFieldPosX, static_cast<float>(i));
+            sender.commitSnapshot();
+            b &= assertTrue(sender.sendSnapshot(server, connHandleClient), ("send " + std::to_string(i)).c_str());
+            b &= assertEquals(1u, getTxPartHeader(server, 0).m_seqBaseline, ("baseline " + std::to_string(i)).c_str());
+            deliverToClient(server, client, receiver);
+            deliverToServer(client, sender, true);
+        }
+        b &= assertEquals(1u, sender.getAckedSequence(connHandleClient), "acked");
+        b &= assertEquals(pge_network::PgeSnapshot::nHistorySize, receiver.getLatestSequence(), "receiver seq");
+
+        // committing one more snapshot overwrites the acked baseline in the history
+        sender.commitSnapshot();
+        b &= assertTrue(sender.sendSnapshot(server, connHandleClient), "send full");
+        b &= assertEquals(0u, getTxPartHeader(server, 0).m_seqBaseline, "full");
+        b &= assertEquals(2u, sender.getFullSnapshotSentCount(), "full count");
+        deliverToClient(server, client, receiver);
+        deliverToServer(client, sender);
+
+        b &= assertEquals(pge_network::PgeSnapshot::nHistorySize + 1, receiver.getLatestSequence(), "receiver seq after full");
+        b &= assertTrue(receiver.getLatestSnapshot().isEqualState(sender.getSnapshot()), "receiver state");
+        b &= assertEquals(pge_network::PgeSnapshot::nHistorySize + 1, sender.getAckedSequence(connHandleClient), "acked after full");
+        b &= assertEquals(0u, receiver.getDroppedSnapshotCount(), "dropped");
+
+        return b;
+    }
+
+    bool test_removeClient_FallbackToFull()
+    {
+        pge_network::PgeServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeClientStub client(cfgProfiles);
+        pge_network::PgeSnapshotSender sender(vFieldSizes, msgIdSnapshot, msgIdAck);
+        pge_network::PgeSnapshotReceiver receiver(vFieldSizes, msgIdSnapshot, msgIdAck);
+
+        setPlayer(sender.getSnapshot(), 1, 10.f, 100);
+        bool b = assertTrue(replicate(server, client, sender, receiver), "replicate 1");
+        b &= assertEquals(1u, sender.getAckedSequence(connHandleClient), "acked 1");
+
+        sender.removeClient(connHandleClient);
+        b &= assertEquals(0u, sender.getAckedSequence(connHandleClient), "acked after remove");
+
+        sender.commitSnapshot();
+        b &= assertTrue(sender.sendSnapshot(server, connHandleClient), "send 2");
+        b &= assertEquals(0u, getTxPartHeader(server, 0).m_seqBaseline, "full");
+        b &= assertEquals(2u, sender.getFullSnapshotSentCount(), "full count");
+
+        return b;
+    }
+
+    bool test_multiPart()
+    {
+        pge_network::PgeServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeClientStub client(cfgProfiles);
+        pge_network::PgeSnapshotSender sender(vFieldSizes, msgIdSnapshot, msgIdAck);
+        pge_network::PgeSnapshotReceiver receiver(vFieldSizes, msgIdSnapshot, msgIdAck);
+
+        for (pge_network::PgeSnapshot::TEntityId i = 1; i <= 50; i++)
+        {
+            setPlayer(sender.getSnapshot(), i, static_cast<float>(i), 100);
+        }
+        sender.commitSnapshot();
+        bool b = assertTrue(sender.sendSnapshot(server, connHandleClient), "send 1");
+
+        // 17 bytes per record, 13 records fit into a part
+        const std::size_t nExpectedPartCount = 4;
+        b &= assertEquals(nExpectedPartCount, server.getTxPackets().size(), "part count");
+        for (std::size_t i = 0; i < server.getTxPackets().size(); i++)
+        {
+            b &= assertEquals(i, static_cast<std::size_t>(getTxPartHeader(server, i).m_iPart), ("iPart " + std::to_string(i)).c_str());
+            b &= assertEquals(nExpectedPartCount, static_cast<std::size_t>(getTxPartHeader(server, i).m_nPartCount), ("nPartCount " + std::to_string(i)).c_str());
+            b &= assertLequals(static_cast<std::size_t>(getTxMsgAppDataSize(server, i)), static_cast<std::size_t>(pge_network::MsgApp::nMaxMessageLengthBytes), ("size " + std::to_string(i)).c_str());
+        }
+
+        // parts arriving out of order
+        std::vector<std::pair<pge_network::PgeNetworkConnectionHandle, pge_network::PgePacket>> vTxPkts = server.getTxPackets();
+        server.clearTxPackets();
+        for (std::size_t i = vTxPkts.size(); i > 0; i--)
+        {
+            b &= assertEquals(0u, receiver.getLatestSequence(), ("incomplete " + std::to_string(i)).c_str());
+            b &= assertTrue(receiver.handleSnapshotPkt(client, vTxPkts[i - 1].second), ("handle " + std::to_string(i)).c_str());
+        }
+        b &= assertEquals(1u, receiver.getLatestSequence(), "receiver seq 1");
+        b &= assertTrue(receiver.getLatestSnapshot().isEqualState(sender.getSnapshot()), "receiver state 1");
+        b &= assertEquals(1u, client.getTxPackets().size(), "single ack");
+
+        return b;
+    }
+
+    bool test_multiPart_PartLoss()
+    {
+        pge_network::PgeServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeClientStub client(cfgProfiles);
+        pge_network::PgeSnapshotSender sender(vFieldSizes, msgIdSnapshot, msgIdAck);
+        pge_network::PgeSnapshotReceiver receiver(vFieldSizes, msgIdSnapshot, msgIdAck);
+
+        for (pge_network::PgeSnapshot::TEntityId i = 1; i <= 50; i++)
+        {
+            setPlayer(sender.getSnapshot(), i, static_cast<float>(i), 100);
+        }
+        sender.commitSnapshot();
+        bool b = assertTrue(sender.sendSnapshot(server, connHandleClient), "send 1");
+        deliverToClient(server, client, receiver, { 2 });
+        b &= assertEquals(0u, receiver.getLatestSequence(), "incomplete");
+        b &= assertTrue(client.getTxPackets().empty(), "no ack");
+
+        // newer snapshot abandons the incomplete one, and it is full again since nothing was acked
+        sender.getSnapshot().setField(1, iFieldHealth, static_cast<uint8_t>(1));
+        sender.commitSnapshot();
+        b &= assertTrue(sender.sendSnapshot(server, connHandleClient), "send 2");
+        b &= assertEquals(0u, getTxPartHeader(server, 0).m_seqBaseline, "full");
+        deliverToClient(server, client, receiver);
+        deliverToServer(client, sender);
+
+        b &= assertEquals(2u, receiver.getLatestSequence(), "receiver seq 2");
+        b &= assertTrue(receiver.getLatestSnapshot().isEqualState(sender.getSnapshot()), "receiver state 2");
+        b &= assertEquals(1u, receiver.getDroppedSnapshotCount(), "dropped");
+        b &= assertEquals(2u, sender.getAckedSequence(connHandleClient), "acked 2");
+
+        return b;
+    }
+
+    bool test_receiver_IgnoresOldAndDuplicateAndUnknown()
+    {
+        pge_network::PgeServerStub server(cfgProfiles);
+        server.initialize();
+        pge_network::PgeClientStub client(cfgProfiles);
+        pge_network::PgeSnapshotSender sender(vFieldSizes, msgIdSnapshot, msgIdAck);
+        pge_network::PgeSnapshotReceiver receiver(vFieldSizes, msgIdSnapshot, msgIdAck);
+
+        setPlayer(sender.getSnapshot(), 1, 10.f, 100);
+        sender.commitSnapshot();
+        sender.sendSnapshot(server, connHandleClient);
+        const pge_network::PgePacket pkt1 = server.getTxPackets()[0].second;
+        server.clearTxPackets();
+
+        sender.getSnapshot().setField(1, iFieldPosX, 12.f);
+        sender.commitSnapshot();
+        sender.sendSnapshot(server, connHandleClient);
+        const pge_network::PgePacket pkt2 = server.getTxPackets()[0].second;
+        server.clearTxPackets();
+
+        bool b = assertTrue(receiver.handleSnapshotPkt(client, pkt2), "handle 2");
+        b &= assertTrue(receiver.handleSnapshotPkt(client, pkt2), "handle 2 duplicate");
+        b &= assertTrue(receiver.handleSnapshotPkt(client, pkt1), "handle 1 old");
+        b &= assertEquals(2u, receiver.getLatestSequence(), "receiver seq 2");
+        b &= assertEquals(1u, client.getTxPackets().size(), "single ack");
+
+        float fPosX = 0.f;
+        b &= assertTrue(receiver.getLatestSnapshot().getField(1, iFieldPosX, fPosX), "get posX");
+        b &= assertEquals(12.f, fPosX, "posX");
+
+        pge_network::PgePacket pktOther;
+        pge_network::PgePacket::initPktMsgApp(pktOther, pge_network::ServerConnHandle);
+        pge_network::PgePacket::preparePktMsgAppFill(pktOther, msgIdSnapshot + 100, 4);
+        b &= assertFalse(receiver.handleSnapshotPkt(client, pktOther), "other app msg");
+
+        pge_network::PgePacket pktUserDisconnected;
+        pge_network::PgePacket::initPktPgeMsgUserDisconnected(pktUserDisconnected, connHandleClient);
+        b &= assertFalse(receiver.handleSnapshotPkt(client, pktUserDisconnected), "pge msg");
+
+        // delta against a baseline the receiver never had
+        pge_network::PgePacket pktBadBaseline = pkt2;
+        pge_network::MsgSnapshotPartHeader& header = pge_network::PgePacket::getMsgAppDataFromPkt<pge_network::MsgSnapshotPartHeader>(pktBadBaseline);
+        header.m_seq = 10;
+        header.m_seqBaseline = 9;
+        b &= assertTrue(receiver.handleSnapshotPkt(client, pktBadBaseline), "handle bad baseline");
+        b &= assertEquals(2u, receiver.getLatestSequence(), "receiver seq after bad baseline");
+        b &= assertEquals(1u, receiver.getDroppedSnapshotCount(), "dropped");
+
+        return b;
+    }
+
+    bool test_sender_handleAckPkt_Bad()
+    {
+        pge_network::PgeSnapshotSender sender(vFieldSizes, msgIdSnapshot, msgIdAck);
+        sender.commitSnapshot();
+
+        pge_network::PgePacket pktOther;
+        pge_network::PgePacket::initPktMsgApp(pktOther, connHandleClient);
+        pge_network::PgePacket::preparePktMsgAppFill(pktOther, msgIdSnapshot, 4);
+        bool b = assertFalse(sender.handleAckPkt(pktOther), "other app msg");
+
+        pge_network::PgePacket pktAck;
+        pge_network::PgePacket::initPktMsgApp(pktAck, connHandleClient);
+        pge_network::MsgSnapshotAck& ack = *reinterpret_cast<pge_network::MsgSnapshotAck*>(
+            pge_network::PgePacket::preparePktMsgAppFill(pktAck, msgIdAck, sizeof(pge_network::MsgSnapshotAck)));
+
+        // acking a snapshot never committed
+        ack.m_seq = 2;
+        b &= assertTrue(sender.handleAckPkt(pktAck), "ack 2");
+        b &= assertEquals(0u, sender.getAckedSequence(connHandleClient), "acked after ack 2");
+
+        ack.m_seq = 1;
+        b &= assertTrue(sender.handleAckPkt(pktAck), "ack 1");
+        b &= assertEquals(1u, sender.getAckedSequence(connHandleClient), "acked after ack 1");
+
+        // older ack arriving late does not move the baseline back
+        sender.commitSnapshot();
+        ack.m_seq = 2;
+        sender.handleAckPkt(pktAck);
+        ack.m_seq = 1;
+        b &= assertTrue(sender.handleAckPkt(pktAck), "ack 1 late");
+        b &= assertEquals(2u, sender.getAckedSequence(connHandleClient), "acked after late ack");
+
+        return b;
+    }
+
+}; // class PgeSnapshotReplicationTest
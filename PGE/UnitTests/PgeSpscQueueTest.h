@@ -0,0 +1,284 @@
+#pragma once
+
+/*
+    ###################################################################################
+    PgeSpscQueueTest.h
+    Unit test for PgeSpscQueue.
+    Made by PR00F88, West Whiskhyll Entertainment
+    2026
+    ###################################################################################
+*/
+
+#include "UnitTest.h"  // PCH
+
+#include "../Network/PgeSpscQueue.h"
+
+#include <thread>
+#include <vector>
+
+class PgeSpscQueueTest :
+    public UnitTest
+{
+public:
+
+    PgeSpscQueueTest() :
+        UnitTest(__FILE__)
+    {
+    }
+
+protected:
+
+    virtual void initialize() override
+    {
+        addSubTest("test_ctor", (PFNUNITSUBTEST)&PgeSpscQueueTest::test_ctor);
+        addSubTest("test_reserve_Bad", (PFNUNITSUBTEST)&PgeSpscQueueTest::test_reserve_Bad);
+        addSubTest("test_reserve_RoundsUpToPowerOfTwo", (PFNUNITSUBTEST)&PgeSpscQueueTest::test_reserve_RoundsUpToPowerOfTwo);
+        addSubTest("test_pushBack_and_front_and_popFront", (PFNUNITSUBTEST)&PgeSpscQueueTest::test_pushBack_and_front_and_popFront);
+        addSubTest("test_beginPushBack_without_endPushBack", (PFNUNITSUBTEST)&PgeSpscQueueTest::test_beginPushBack_without_endPushBack);
+        addSubTest("test_full", (PFNUNITSUBTEST)&PgeSpscQueueTest::test_full);
+        addSubTest("test_wrapAround", (PFNUNITSUBTEST)&PgeSpscQueueTest::test_wrapAround);
+        addSubTest("test_slotReuseKeepsItemCapacity", (PFNUNITSUBTEST)&PgeSpscQueueTest::test_slotReuseKeepsItemCapacity);
+        addSubTest("test_resetCounters", (PFNUNITSUBTEST)&PgeSpscQueueTest::test_resetCounters);
+        addSubTest("test_producerConsumerThreads", (PFNUNITSUBTEST)&PgeSpscQueueTest::test_producerConsumerThreads);
+    }
+
+private:
+
+    // ---------------------------------------------------------------------------
+
+    PgeSpscQueueTest(const PgeSpscQueueTest&)
+    {};
+
+    PgeSpscQueueTest& operator=(const PgeSpscQueueTest&)
+    {
+        return *this;
+    };
+
+    bool assertFrontAndPop(pge_network::PgeSpscQueue<uint32_t>& queue, const uint32_t& nExpected, const char* szText)
+    {
+        const uint32_t* const pFront = queue.front();
+        bool b = assertNotNull(pFront, (std::string("front not null, ") + szText).c_str());
+        if (b)
+        {
+            b &= assertEquals(nExpected, *pFront, (std::string("front, ") + szText).c_str());
+            queue.popFront();
+        }
+        return b;
+    }
+
+    bool test_ctor()
+    {
+        pge_network::PgeSpscQueue<uint32_t> queue;
+
+        return assertEquals(0u, queue.capacity(), "capacity") &
+            assertEquals(0u, queue.size(), "size") &
+            assertTrue(queue.empty(), "empty") &
+            assertNull(queue.front(), "front") &
+            assertEquals(0u, queue.getHighWaterMark(), "high water mark") &
+            assertEquals(0u, queue.getFullCount(), "full count") &
+            assertNull(queue.beginPushBack(), "beginPushBack") &
+            assertEquals(1u, queue.getFullCount(), "full count 2");
+    }
+
+    bool test_reserve_Bad()
+    {
+        pge_network::PgeSpscQueue<uint32_t> queue;
+
+        return assertFalse(queue.reserve(0), "reserve 0") &
+            assertFalse(queue.reserve(pge_network::PgeSpscQueue<uint32_t>::nMaxCapacity + 1), "reserve too big") &
+            assertEquals(0u, queue.capacity(), "capacity");
+    }
+
+    bool test_reserve_RoundsUpToPowerOfTwo()
+    {
+        pge_network::PgeSpscQueue<uint32_t> queue;
+
+        bool b = assertTrue(queue.reserve(5), "reserve 5") &
+            assertEquals(8u, queue.capacity(), "capacity 8");
+
+        b &= assertTrue(queue.pushBack(1), "pushBack");
+        b &= assertTrue(queue.reserve(7), "reserve 7") &
+            assertEquals(1u, queue.size(), "size kept with same capacity");
+
+        b &= assertTrue(queue.reserve(9), "reserve 9") &
+            assertEquals(16u, queue.capacity(), "capacity 16") &
+            assertTrue(queue.empty(), "empty after capacity change");
+
+        return b;
+    }
+
+    bool test_pushBack_and_front_and_popFront()
+    {
+        pge_network::PgeSpscQueue<uint32_t> queue;
+        bool b = assertTrue(queue.reserve(4), "reserve");
+
+        b &= assertTrue(queue.pushBack(10), "pushBack 1");
+        b &= assertTrue(queue.pushBack(11), "pushBack 2");
+        b &= assertEquals(2u, queue.size(), "size 2") &
+            assertEquals(2u, queue.getHighWaterMark(), "high water mark 2");
+
+        // front() does not remove
+        b &= assertNotNull(queue.front(), "front") && assertEquals(10u, *queue.front(), "front value");
+        b &= assertEquals(2u, queue.size(), "size still 2");
+
+        b &= assertFrontAndPop(queue, 10, "1");
+        b &= assertFrontAndPop(queue, 11, "2");
+        b &= assertTrue(queue.empty(), "empty") &
+            assertNull(queue.front(), "front when empty") &
+            assertEquals(2u, queue.getHighWaterMark(), "high water mark kept");
+
+        // no effect on empty queue
+        queue.popFront();
+        b &= assertEquals(0u, queue.size(), "size after popFront on empty");
+
+        return b;
+    }
+
+    bool test_beginPushBack_without_endPushBack()
+    {
+        pge_network::PgeSpscQueue<uint32_t> queue;
+        bool b = assertTrue(queue.reserve(2), "reserve");
+
+        uint32_t* const pSlot = queue.beginPushBack();
+        b &= assertNotNull(pSlot, "slot");
+        if (!b)
+        {
+            return false;
+        }
+        *pSlot = 5;
+        b &= assertTrue(queue.empty(), "not visible before endPushBack") &
+            assertNull(queue.front(), "front before endPushBack");
+
+        // abandoned slot is returned again
+        b &= assertEquals(pSlot, queue.beginPushBack(), "same slot");
+        *pSlot = 6;
+        queue.endPushBack();
+        b &= assertFrontAndPop(queue, 6, "after endPushBack");
+
+        // endPushBack() without beginPushBack() has no effect
+        queue.endPushBack();
+        b &= assertTrue(queue.empty(), "empty");
+
+        return b;
+    }
+
+    bool test_full()
+    {
+        pge_network::PgeSpscQueue<uint32_t> queue;
+        bool b = assertTrue(queue.reserve(2), "reserve");
+
+        b &= assertTrue(queue.pushBack(1), "pushBack 1");
+        b &= assertTrue(queue.pushBack(2), "pushBack 2");
+        b &= assertFalse(queue.pushBack(3), "pushBack 3") &
+            assertNull(queue.beginPushBack(), "beginPushBack when full") &
+            assertEquals(2u, queue.getFullCount(), "full count") &
+            assertEquals(2u, queue.size(), "size");
+
+        b &= assertFrontAndPop(queue, 1, "1");
+        b &= assertTrue(queue.pushBack(4), "pushBack 4 after pop");
+        b &= assertFrontAndPop(queue, 2, "2");
+        b &= assertFrontAndPop(queue, 4, "4");
+
+        return b;
+    }
+
+    bool test_wrapAround()
+    {
+        pge_network::PgeSpscQueue<uint32_t> queue;
+        bool b = assertTrue(queue.reserve(4), "reserve");
+
+        for (uint32_t i = 0; i < 50; i++)
+        {
+            b &= assertTrue(queue.pushBack(i), ("pushBack " + std::to_string(i)).c_str());
+            b &= assertTrue(queue.pushBack(1000 + i), ("pushBack 1000+" + std::to_string(i)).c_str());
+            b &= assertFrontAndPop(queue, i, std::to_string(i).c_str());
+            b &= assertFrontAndPop(queue, 1000 + i, ("1000+" + std::to_string(i)).c_str());
+        }
+
+        return b & assertTrue(queue.empty(), "empty") & assertEquals(2u, queue.getHighWaterMark(), "high water mark");
+    }
+
+    bool test_slotReuseKeepsItemCapacity()
+    {
+        pge_network::PgeSpscQueue<std::vector<uint32_t>> queue;
+        bool b = assertTrue(queue.reserve(1), "reserve");
+
+        std::vector<uint32_t>* pSlot = queue.beginPushBack();
+        b &= assertNotNull(pSlot, "slot 1");
+        if (!b)
+        {
+            return false;
+        }
+        pSlot->assign(100, 1);
+        queue.endPushBack();
+        queue.front()->clear();
+        queue.popFront();
+
+        pSlot = queue.beginPushBack();
+        b &= assertNotNull(pSlot, "slot 2");
+        if (!b)
+        {
+            return false;
+        }
+
+        return b & assertTrue(pSlot->empty(), "cleared") & assertLequals(100u, pSlot->capacity(), "capacity kept");
+    }
+
+    bool test_resetCounters()
+    {
+        pge_network::PgeSpscQueue<uint32_t> queue;
+        bool b = assertTrue(queue.reserve(2), "reserve");
+
+        b &= assertTrue(queue.pushBack(1), "pushBack 1");
+        b &= assertTrue(queue.pushBack(2), "pushBack 2");
+        b &= assertFalse(queue.pushBack(3), "pushBack 3");
+        queue.popFront();
+
+        queue.resetCounters();
+        return b & assertEquals(1u, queue.getHighWaterMark(), "high water mark is current size") &
+            assertEquals(0u, queue.getFullCount(), "full count");
+    }
+
+    bool test_producerConsumerThreads()
+    {
+        // small capacity so that both the full and the empty cases are frequently hit by the 2 threads
+        static constexpr uint32_t nItemCount = 200000;
+        pge_network::PgeSpscQueue<uint32_t> queue;
+        bool b = assertTrue(queue.reserve(16), "reserve");
+
+        std::thread thProducer([&queue]() {
+            for (uint32_t i = 0; i < nItemCount; )
+            {
+                uint32_t* const pSlot = queue.beginPushBack();
+                if (!pSlot)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                *pSlot = i++;
+                queue.endPushBack();
+            }
+            });
+
+        uint32_t nExpected = 0;
+        bool bInOrder = true;
+        while (nExpected < nItemCount)
+        {
+            const uint32_t* const pFront = queue.front();
+            if (!pFront)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            bInOrder &= (*pFront == nExpected);
+            nExpected++;
+            queue.popFront();
+        }
+        thProducer.join();
+
+        return b & assertTrue(bInOrder, "in order") &
+            assertTrue(queue.empty(), "empty") &
+            assertLequals(queue.getHighWaterMark(), queue.capacity(), "high water mark");
+    }
+
+};
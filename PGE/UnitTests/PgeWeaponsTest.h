@@ -12,6 +12,8 @@
 #include "UnitTest.h"  // PCH
 
 #include <cmath>
+#include <cstring>
+#include <limits>
 #include <thread>
 
 #include "../../../PFL/PFL/PFL.h"
@@ -144,6 +146,14 @@ protected:
         addSubTest("test_wpn_get_lowest_accuracy_possible", (PFNUNITSUBTEST)&PgeWeaponsTest::test_wpn_get_lowest_accuracy_possible);
         addSubTest("test_wpn_get_random_relative_bullet_angle", (PFNUNITSUBTEST)&PgeWeaponsTest::test_wpn_get_random_relative_bullet_angle);
         addSubTest("test_wpn_shoot_creates_bullet_within_momentary_accuracy_range_of_weapon", (PFNUNITSUBTEST)&PgeWeaponsTest::test_wpn_shoot_creates_bullet_within_momentary_accuracy_range_of_weapon);
+        addSubTest("test_wpn_deterministic_relative_bullet_angle", (PFNUNITSUBTEST)&PgeWeaponsTest::test_wpn_deterministic_relative_bullet_angle);
+        addSubTest("test_wpn_shoot_increments_shot_counter_and_saves_bullet_spawn", (PFNUNITSUBTEST)&PgeWeaponsTest::test_wpn_shoot_increments_shot_counter_and_saves_bullet_spawn);
+        addSubTest("test_wpn_copy_continues_shot_sequence", (PFNUNITSUBTEST)&PgeWeaponsTest::test_wpn_copy_continues_shot_sequence);
+        addSubTest("test_wpn_spawn_bullet_creates_same_bullet_as_shoot", (PFNUNITSUBTEST)&PgeWeaponsTest::test_wpn_spawn_bullet_creates_same_bullet_as_shoot);
+        addSubTest("test_wpn_spawn_bullet_rejects_spawn_of_other_weapon", (PFNUNITSUBTEST)&PgeWeaponsTest::test_wpn_spawn_bullet_rejects_spawn_of_other_weapon);
+        addSubTest("test_wpn_spawn_bullet_rejects_invalid_values", (PFNUNITSUBTEST)&PgeWeaponsTest::test_wpn_spawn_bullet_rejects_invalid_values);
+        addSubTest("test_wpn_spawn_bullet_does_not_rewind_or_jump_shot_counter", (PFNUNITSUBTEST)&PgeWeaponsTest::test_wpn_spawn_bullet_does_not_rewind_or_jump_shot_counter);
+        addSubTest("test_wpn_bullet_spawn_msg_app_roundtrip", (PFNUNITSUBTEST)&PgeWeaponsTest::test_wpn_bullet_spawn_msg_app_roundtrip);
         addSubTest("test_wpn_release_trigger_after_shoot", (PFNUNITSUBTEST)&PgeWeaponsTest::test_wpn_release_trigger_after_shoot);
         addSubTest("test_wpn_attack_does_not_decrease_mag_count_for_melee_type", (PFNUNITSUBTEST)&PgeWeaponsTest::test_wpn_attack_does_not_decrease_mag_count_for_melee_type);
         addSubTest("test_wpn_shoot_when_empty_does_not_shoot", (PFNUNITSUBTEST) &PgeWeaponsTest::test_wpn_shoot_when_empty_does_not_shoot);
@@ -154,6 +164,8 @@ protected:
         addSubTest("test_wpn_semi_shoot_has_to_release_and_pull_trigger_continuously_in_loop", (PFNUNITSUBTEST)&PgeWeaponsTest::test_wpn_semi_shoot_has_to_release_and_pull_trigger_continuously_in_loop);
         addSubTest("test_wpn_reload_doesnt_reload_during_shooting", (PFNUNITSUBTEST) &PgeWeaponsTest::test_wpn_reload_doesnt_reload_during_shooting);
         addSubTest("test_wpn_reset_sets_defaults", (PFNUNITSUBTEST)&PgeWeaponsTest::test_wpn_reset_sets_defaults);
+        addSubTest("test_wpn_stats_follow_cvar_changes", (PFNUNITSUBTEST)&PgeWeaponsTest::test_wpn_stats_follow_cvar_changes);
+        addSubTest("test_benchmark_wpn_pull_trigger", (PFNUNITSUBTEST)&PgeWeaponsTest::test_benchmark_wpn_pull_trigger);
         
         /* WeaponManager */
 
@@ -177,6 +189,10 @@ protected:
         addSubTest("test_wm_get_next_best_avail_weapon_with_any_ammo_not_in_keytoweaponmap", (PFNUNITSUBTEST)&PgeWeaponsTest::test_wm_get_next_best_avail_weapon_with_any_ammo_not_in_keytoweaponmap);
         addSubTest("test_wm_get_next_best_avail_weapon_with_loaded_ammo", (PFNUNITSUBTEST)&PgeWeaponsTest::test_wm_get_next_best_avail_weapon_with_loaded_ammo);
         addSubTest("test_wm_get_next_best_avail_weapon_with_loaded_ammo_not_in_keytoweaponmap", (PFNUNITSUBTEST)&PgeWeaponsTest::test_wm_get_next_best_avail_weapon_with_loaded_ammo_not_in_keytoweaponmap);
+
+        /* headless: shuts down and then reinitializes graphics and audio, so keep it last */
+
+        addSubTest("test_wpn_headless_shoot_creates_bullet_without_gfx_and_audio", (PFNUNITSUBTEST)&PgeWeaponsTest::test_wpn_headless_shoot_creates_bullet_without_gfx_and_audio);
     }
 
     virtual bool setUp() override
@@ -1596,6 +1612,352 @@ private:
         return b;
     }
 
+    bool test_wpn_deterministic_relative_bullet_angle()
+    {
+        bool b = false;
+        try
+        {
+            PgeObjectPool<PooledBullet> bullets("pool", nBulletPoolCap, *engine);
+            Weapon wpn("gamedata/weapons/sample_good_wpn_automatic.txt", bullets, m_audio, *engine, 52u);
+            b = true;
+
+            const float fAcc = wpn.getMomentaryAccuracy(false /* bMoving */, false /* bRun */, false /* bDuck */);
+            bool bDifferentByShot = false;
+            bool bDifferentByOwner = false;
+            for (uint32_t nShot = 0; b && (nShot < 100); nShot++)
+            {
+                const float fAngle = Weapon::getDeterministicRelativeBulletAngle(fAcc, 52u, wpn.getUniqueId(), nShot);
+                b &= assertEquals(fAngle, Weapon::getDeterministicRelativeBulletAngle(fAcc, 52u, wpn.getUniqueId(), nShot), ("same " + std::to_string(nShot)).c_str());
+                b &= assertGequals(fAcc, std::abs(fAngle), ("range " + std::to_string(nShot)).c_str());
+                bDifferentByShot |= (fAngle != Weapon::getDeterministicRelativeBulletAngle(fAcc, 52u, wpn.getUniqueId(), nShot + 1));
+                bDifferentByOwner |= (fAngle != Weapon::getDeterministicRelativeBulletAngle(fAcc, 53u, wpn.getUniqueId(), nShot));
+            }
+            b &= assertTrue(bDifferentByShot, "different by shot");
+            b &= assertTrue(bDifferentByOwner, "different by owner");
+            b &= assertEquals(0.f, Weapon::getDeterministicRelativeBulletAngle(0.f, 52u, wpn.getUniqueId(), 0), "zero accuracy");
+
+            // next bullet angle of weapon is the deterministic angle of its current shot
+            b &= assertEquals(
+                Weapon::getDeterministicRelativeBulletAngle(fAcc, 52u, wpn.getUniqueId(), wpn.getShotCounter()),
+                wpn.getRandomRelativeBulletAngle(false /* bMoving */, false /* bRun */, false /* bDuck */),
+                "random relative angle");
+        }
+        catch (const std::exception& e)
+        {
+            b &= assertTrue(false, e.what());
+        }
+
+        return b;
+    }
+
+    bool test_wpn_shoot_increments_shot_counter_and_saves_bullet_spawn()
+    {
+        bool b = false;
+        try
+        {
+            PgeObjectPool<PooledBullet> bullets("pool", nBulletPoolCap, *engine);
+            Weapon wpn("gamedata/weapons/sample_good_wpn_automatic.txt", bullets, m_audio, *engine, 52u);
+            b = true;
+
+            wpn.getObject3D().getPosVec().Set(1.f, 2.f, 3.f);
+            wpn.getObject3D().getAngleVec().Set(30.f, 40.f, 50.f);
+
+            b &= assertEquals(0u, wpn.getShotCounter(), "shot counter 1");
+            b &= assertTrue(wpn.pullTrigger(false /* bMoving */, false /* bRun */, false /* bDuck */), "shoot 1");
+            b &= assertEquals(1u, wpn.getShotCounter(), "shot counter 2");
+
+            const MsgBulletSpawn& spawn = wpn.getLastBulletSpawn();
+            b &= assertEquals(52u, spawn.m_connHandle, "spawn owner");
+            b &= assertEquals(static_cast<uint64_t>(wpn.getUniqueId()), spawn.m_nWpnId, "spawn wpn id");
+            b &= assertEquals(0u, spawn.m_nShot, "spawn shot");
+            b &= assertEquals(1.f, spawn.m_pos[0], "spawn pos x");
+            b &= assertEquals(2.f, spawn.m_pos[1], "spawn pos y");
+            b &= assertEquals(3.f, spawn.m_pos[2], "spawn pos z");
+            b &= assertEquals(30.f, spawn.m_angle[0], "spawn angle x");
+            b &= assertEquals(40.f, spawn.m_angle[1], "spawn angle y");
+            b &= assertEquals(50.f, spawn.m_angle[2], "spawn angle z");
+            b &= assertEquals(wpn.getAccuracyByPose(false /* bMoving */, false /* bRun */, false /* bDuck */), spawn.m_fAccuracy, "spawn accuracy");
+
+            // failed shot does not increment the counter
+            wpn.SetMagBulletCount(0);
+            std::this_thread::sleep_for(std::chrono::milliseconds(wpn.getVars()["firing_cooldown"].getAsInt()));
+            wpn.update();
+            b &= assertFalse(wpn.pullTrigger(false /* bMoving */, false /* bRun */, false /* bDuck */), "shoot 2");
+            b &= assertEquals(1u, wpn.getShotCounter(), "shot counter 3");
+        }
+        catch (const std::exception& e)
+        {
+            b &= assertTrue(false, e.what());
+        }
+
+        return b;
+    }
+
+    bool test_wpn_copy_continues_shot_sequence()
+    {
+        bool b = false;
+        try
+        {
+            PgeObjectPool<PooledBullet> bullets("pool", nBulletPoolCap, *engine);
+            Weapon wpn("gamedata/weapons/sample_good_wpn_automatic.txt", bullets, m_audio, *engine, 52u);
+            Weapon wpnAssigned("gamedata/weapons/sample_good_wpn_automatic.txt", bullets, m_audio, *engine, 52u);
+            b = true;
+
+            for (int i = 0; b && (i < 3); i++)
+            {
+                b &= assertTrue(wpn.pullTrigger(false /* bMoving */, false /* bRun */, false /* bDuck */), ("shoot " + std::to_string(i)).c_str());
+                std::this_thread::sleep_for(std::chrono::milliseconds(wpn.getVars()["firing_cooldown"].getAsInt()));
+                wpn.update();
+            }
+            b &= assertEquals(3u, wpn.getShotCounter(), "shot counter");
+
+            // copy and assigned weapon continue with the next shot of the source instead of repeating the spread from the 1st shot
+            const Weapon wpnCopy(wpn);
+            b &= assertEquals(wpn.getShotCounter(), wpnCopy.getShotCounter(), "copy shot counter");
+            b &= assertEquals(wpn.getLastBulletSpawn().m_nShot, wpnCopy.getLastBulletSpawn().m_nShot, "copy last spawn shot");
+            b &= assertEquals(wpn.getLastBulletSpawn().m_nWpnId, wpnCopy.getLastBulletSpawn().m_nWpnId, "copy last spawn wpn id");
+
+            b &= assertEquals(0u, wpnAssigned.getShotCounter(), "assigned shot counter 1");
+            wpnAssigned = wpn;
+            b &= assertEquals(wpn.getShotCounter(), wpnAssigned.getShotCounter(), "assigned shot counter 2");
+            b &= assertEquals(wpn.getLastBulletSpawn().m_nShot, wpnAssigned.getLastBulletSpawn().m_nShot, "assigned last spawn shot");
+            b &= assertEquals(wpn.getLastBulletSpawn().m_nWpnId, wpnAssigned.getLastBulletSpawn().m_nWpnId, "assigned last spawn wpn id");
+        }
+        catch (const std::exception& e)
+        {
+            b &= assertTrue(false, e.what());
+        }
+
+        return b;
+    }
+
+    bool test_wpn_spawn_bullet_creates_same_bullet_as_shoot()
+    {
+        bool b = false;
+        try
+        {
+            // server and client have their own pools and weapons
+            PgeObjectPool<PooledBullet> bulletsServer("pool server", nBulletPoolCap, *engine);
+            PgeObjectPool<PooledBullet> bulletsClient("pool client", nBulletPoolCap, *engine);
+            Weapon wpnServer("gamedata/weapons/sample_good_wpn_automatic.txt", bulletsServer, m_audio, *engine, 52u);
+            Weapon wpnClient("gamedata/weapons/sample_good_wpn_automatic.txt", bulletsClient, m_audio, *engine, 52u);
+            b = true;
+
+            wpnServer.getObject3D().getPosVec().Set(1.f, 2.f, 3.f);
+            wpnServer.getObject3D().getAngleVec().Set(30.f, 40.f, 50.f);
+
+            for (int i = 0; b && (i < 5); i++)
+            {
+                b &= assertTrue(wpnServer.pullTrigger(true /* bMoving */, true /* bRun */, false /* bDuck */), ("shoot " + std::to_string(i)).c_str());
+                const PooledBullet* const pBulletClient = wpnClient.spawnBullet(wpnServer.getLastBulletSpawn());
+                b &= assertNotNull(pBulletClient, ("client bullet " + std::to_string(i)).c_str());
+                b &= assertEquals(wpnServer.getShotCounter(), wpnClient.getShotCounter(), ("shot counter " + std::to_string(i)).c_str());
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(wpnServer.getVars()["firing_cooldown"].getAsInt()));
+                wpnServer.update();
+            }
+            b &= assertEquals(bulletsServer.size(), bulletsClient.size(), "bullets size");
+
+            auto itClient = bulletsClient.begin();
+            for (auto itServer = bulletsServer.begin(); b && (itServer != bulletsServer.end()); ++itServer, ++itClient)
+            {
+                b &= assertEquals(itServer->used(), itClient->used(), "used");
+                if (!itServer->used())
+                {
+                    continue;
+                }
+                b &= assertEquals(itServer->getOwner(), itClient->getOwner(), "owner");
+                b &= assertEquals(itServer->getWeaponId(), itClient->getWeaponId(), "wpn id");
+                b &= assertEquals(itServer->getObject3D().getPosVec(), itClient->getObject3D().getPosVec(), "pos");
+                b &= assertEquals(itServer->getObject3D().getAngleVec(), itClient->getObject3D().getAngleVec(), "angle");
+            }
+        }
+        catch (const std::exception& e)
+        {
+            b &= assertTrue(false, e.what());
+        }
+
+        return b;
+    }
+
+    bool test_wpn_spawn_bullet_rejects_spawn_of_other_weapon()
+    {
+        bool b = false;
+        try
+        {
+            PgeObjectPool<PooledBullet> bullets("pool", nBulletPoolCap, *engine);
+            Weapon wpn("gamedata/weapons/sample_good_wpn_automatic.txt", bullets, m_audio, *engine, 52u);
+            b = true;
+
+            MsgBulletSpawn spawn{};
+            spawn.m_connHandle = 52u;
+            spawn.m_nWpnId = static_cast<uint64_t>(wpn.getUniqueId()) + 1;
+            spawn.m_nShot = 10;
+            b &= assertNull(wpn.spawnBullet(spawn), "spawn other");
+            b &= assertTrue(bullets.empty(), "bullets empty 1");
+            b &= assertEquals(0u, wpn.getShotCounter(), "shot counter 1");
+
+            spawn.m_nWpnId = static_cast<uint64_t>(wpn.getUniqueId());
+            spawn.m_connHandle = 53u;
+            b &= assertNull(wpn.spawnBullet(spawn), "spawn other owner");
+            b &= assertTrue(bullets.empty(), "bullets empty 2");
+            b &= assertEquals(0u, wpn.getShotCounter(), "shot counter 2");
+
+            spawn.m_connHandle = 52u;
+            b &= assertNotNull(wpn.spawnBullet(spawn), "spawn own");
+            b &= assertEquals(1u, bullets.size(), "bullets size");
+            b &= assertEquals(11u, wpn.getShotCounter(), "shot counter 3");
+        }
+        catch (const std::exception& e)
+        {
+            b &= assertTrue(false, e.what());
+        }
+
+        return b;
+    }
+
+    bool test_wpn_spawn_bullet_rejects_invalid_values()
+    {
+        bool b = false;
+        try
+        {
+            PgeObjectPool<PooledBullet> bullets("pool", nBulletPoolCap, *engine);
+            Weapon wpn("gamedata/weapons/sample_good_wpn_automatic.txt", bullets, m_audio, *engine, 52u);
+            b = true;
+
+            MsgBulletSpawn spawnValid{};
+            spawnValid.m_connHandle = 52u;
+            spawnValid.m_nWpnId = static_cast<uint64_t>(wpn.getUniqueId());
+            spawnValid.m_fAccuracy = wpn.getLowestAccuracyPossible();
+
+            MsgBulletSpawn spawn = spawnValid;
+            spawn.m_pos[1] = std::numeric_limits<float>::quiet_NaN();
+            b &= assertNull(wpn.spawnBullet(spawn), "NaN pos");
+
+            spawn = spawnValid;
+            spawn.m_angle[2] = std::numeric_limits<float>::infinity();
+            b &= assertNull(wpn.spawnBullet(spawn), "inf angle");
+
+            spawn = spawnValid;
+            spawn.m_fAccuracy = std::numeric_limits<float>::quiet_NaN();
+            b &= assertNull(wpn.spawnBullet(spawn), "NaN accuracy");
+
+            spawn.m_fAccuracy = -0.1f;
+            b &= assertNull(wpn.spawnBullet(spawn), "negative accuracy");
+
+            spawn.m_fAccuracy = wpn.getLowestAccuracyPossible() + 0.1f;
+            b &= assertNull(wpn.spawnBullet(spawn), "too big accuracy");
+
+            b &= assertTrue(bullets.empty(), "bullets empty");
+            b &= assertEquals(0u, wpn.getShotCounter(), "shot counter 1");
+
+            b &= assertNotNull(wpn.spawnBullet(spawnValid), "valid");
+            b &= assertEquals(1u, bullets.size(), "bullets size");
+            b &= assertEquals(1u, wpn.getShotCounter(), "shot counter 2");
+        }
+        catch (const std::exception& e)
+        {
+            b &= assertTrue(false, e.what());
+        }
+
+        return b;
+    }
+
+    bool test_wpn_spawn_bullet_does_not_rewind_or_jump_shot_counter()
+    {
+        bool b = false;
+        try
+        {
+            PgeObjectPool<PooledBullet> bullets("pool", nBulletPoolCap, *engine);
+            Weapon wpn("gamedata/weapons/sample_good_wpn_automatic.txt", bullets, m_audio, *engine, 52u);
+            b = true;
+
+            MsgBulletSpawn spawn{};
+            spawn.m_connHandle = 52u;
+            spawn.m_nWpnId = static_cast<uint64_t>(wpn.getUniqueId());
+
+            spawn.m_nShot = Weapon::nMaxShotCounterStep - 1;
+            b &= assertNotNull(wpn.spawnBullet(spawn), "spawn 1");
+            b &= assertEquals(Weapon::nMaxShotCounterStep, wpn.getShotCounter(), "shot counter 1");
+
+            // bullets are still created with their own shot number, but the counter does not follow
+            spawn.m_nShot = 5u;
+            b &= assertNotNull(wpn.spawnBullet(spawn), "spawn behind");
+            b &= assertEquals(Weapon::nMaxShotCounterStep, wpn.getShotCounter(), "shot counter 2");
+
+            spawn.m_nShot = 2 * Weapon::nMaxShotCounterStep;
+            b &= assertNotNull(wpn.spawnBullet(spawn), "spawn too far ahead");
+            b &= assertEquals(Weapon::nMaxShotCounterStep, wpn.getShotCounter(), "shot counter 3");
+
+            spawn.m_nShot = Weapon::nMaxShotCounterStep;
+            b &= assertNotNull(wpn.spawnBullet(spawn), "spawn next");
+            b &= assertEquals(Weapon::nMaxShotCounterStep + 1, wpn.getShotCounter(), "shot counter 4");
+            b &= assertEquals(4u, bullets.size(), "bullets size");
+        }
+        catch (const std::exception& e)
+        {
+            b &= assertTrue(false, e.what());
+        }
+
+        return b;
+    }
+
+    bool test_wpn_bullet_spawn_msg_app_roundtrip()
+    {
+        bool b = false;
+        try
+        {
+            PgeObjectPool<PooledBullet> bullets("pool", nBulletPoolCap, *engine);
+            Weapon wpn("gamedata/weapons/sample_good_wpn_automatic.txt", bullets, m_audio, *engine, 52u);
+            b = true;
+
+            MsgBulletSpawn spawn{};
+            spawn.m_connHandle = 52u;
+            spawn.m_nWpnId = 0x0123456789ABCDEFull;
+            spawn.m_nShot = 300u;
+            spawn.m_pos[0] = 1.5f;
+            spawn.m_pos[1] = -2.25f;
+            spawn.m_pos[2] = 1e-7f;
+            spawn.m_angle[0] = 30.f;
+            spawn.m_angle[1] = 359.9f;
+            spawn.m_angle[2] = -50.123f;
+            spawn.m_fAccuracy = 0.3f;
+
+            pge_network::PgePacket pkt;
+            pge_network::PgePacket::initPktMsgApp(pkt, 0u);
+            b &= assertTrue(Weapon::fillPktMsgAppBulletSpawn(pkt, 7u, spawn), "fill");
+
+            const pge_network::MsgApp* const pMsgApp = pge_network::PgePacket::getMsgAppFromPkt(pkt);
+            const pge_network::MsgApp::TMsgSize nSize = pge_network::MsgApp::getMsgAppDataActualSizeBytes(*pMsgApp);
+            b &= assertEquals(static_cast<pge_network::MsgApp::TMsgId>(7u), pge_network::MsgApp::getMsgAppMsgId(*pMsgApp), "msg id");
+            b &= assertTrue(nSize <= Weapon::nMsgBulletSpawnMaxBytes, "msg size");
+
+            MsgBulletSpawn spawnRead{};
+            b &= assertTrue(Weapon::readMsgAppBulletSpawn(pge_network::MsgApp::getMsgAppData(*pMsgApp), nSize, spawnRead), "read");
+            b &= assertEquals(spawn.m_connHandle, spawnRead.m_connHandle, "conn handle");
+            b &= assertEquals(spawn.m_nWpnId, spawnRead.m_nWpnId, "wpn id");
+            b &= assertEquals(spawn.m_nShot, spawnRead.m_nShot, "shot");
+            for (int i = 0; i < 3; i++)
+            {
+                b &= assertEquals(spawn.m_pos[i], spawnRead.m_pos[i], ("pos " + std::to_string(i)).c_str());
+                b &= assertEquals(spawn.m_angle[i], spawnRead.m_angle[i], ("angle " + std::to_string(i)).c_str());
+            }
+            b &= assertEquals(spawn.m_fAccuracy, spawnRead.m_fAccuracy, "accuracy");
+
+            // anything shorter or longer is not a bullet spawn
+            pge_network::TByte data[Weapon::nMsgBulletSpawnMaxBytes + 1] = {};
+            std::memcpy(data, pge_network::MsgApp::getMsgAppData(*pMsgApp), nSize);
+            b &= assertFalse(Weapon::readMsgAppBulletSpawn(data, nSize - 1, spawnRead), "read shorter");
+            b &= assertFalse(Weapon::readMsgAppBulletSpawn(data, nSize + 1, spawnRead), "read longer");
+        }
+        catch (const std::exception& e)
+        {
+            b &= assertTrue(false, e.what());
+        }
+
+        return b;
+    }
+
     bool test_wpn_release_trigger_after_shoot()
     {
         bool b = false;
@@ -2085,6 +2447,173 @@ private:
         return b;
     }
 
+    bool test_wpn_stats_follow_cvar_changes()
+    {
+        bool b = false;
+        try
+        {
+            PgeObjectPool<PooledBullet> bullets("pool", nBulletPoolCap, *engine);
+            Weapon wpn("gamedata/weapons/sample_good_wpn_automatic.txt", bullets, m_audio, *engine, 0);
+            b = true;
+
+            // compiled by ctor
+            const WeaponStats& stats = wpn.getStats();
+            b &= assertEquals(50, stats.m_nFiringCooldownMillisecs, "firing_cooldown 1");
+            b &= assertEquals(999u, stats.m_nCapMax, "cap_max 1");
+            b &= assertEquals(30u, stats.m_nReloadable, "reloadable 1");
+            b &= assertEquals(30u, stats.m_nBulletsDefault, "bullets_default");
+            b &= assertEquals(1500, stats.m_nReloadTimeMillisecs, "reload_time");
+            b &= assertTrue(stats.m_bReloadPerMag, "reload_per_mag");
+            b &= assertTrue(stats.m_bReloadWholeMag, "reload_whole_mag");
+            b &= assertEquals(5.f, stats.m_fAccAngle, "acc_angle 1");
+            b &= assertEquals(1.2f, stats.m_fAccMWalk, "acc_m_walk");
+            b &= assertEquals(3.0f, stats.m_fAccMRun, "acc_m_run");
+            b &= assertEquals(0.6f, stats.m_fAccMDuck, "acc_m_duck");
+            b &= assertEquals(1.1f, stats.m_fRecoilM, "recoil_m");
+            b &= assertEquals(100.f, stats.m_fRecoilCooldownMillisecs, "recoil_cooldown");
+            b &= assertTrue(stats.m_bBulletVisible, "bullet_visible");
+            b &= assertTrue(stats.m_bBulletFragile, "bullet_fragile");
+            b &= assertEquals(1.f, stats.m_fBulletSizeX, "bullet_size_x");
+            b &= assertEquals(2.f, stats.m_fBulletSizeY, "bullet_size_y");
+            b &= assertEquals(3.f, stats.m_fBulletSizeZ, "bullet_size_z");
+            b &= assertEquals(2.f, stats.m_fBulletSpeed, "bullet_speed");
+            b &= assertEquals(0.f, stats.m_fBulletGravity, "bullet_gravity");
+            b &= assertEquals(0.2f, stats.m_fBulletDrag, "bullet_drag");
+            b &= assertEquals(0.f, stats.m_fBulletDistanceMax, "bullet_distance_max");
+            b &= assertEquals(Bullet::ParticleType::None, stats.m_eBulletParticle, "bullet_particle 1");
+            b &= assertEquals(10, stats.m_nDamageAp, "damage_ap");
+            b &= assertEquals(20, stats.m_nDamageHp, "damage_hp");
+            b &= assertEquals(0.f, stats.m_fDamageAreaSize, "damage_area_size");
+            b &= assertEquals(0.f, stats.m_fDamageAreaPulse, "damage_area_pulse");
+            b &= assertEquals(Bullet::DamageAreaEffect::Constant, stats.m_eDamageAreaEffect, "damage_area_effect 1");
+
+            // modifying CVARs through getVars() is picked up by the next call
+            wpn.getVars()["acc_angle"].Set(7.f);
+            wpn.getVars()["firing_cooldown"].Set(80);
+            wpn.getVars()["bullet_particle"].Set("smoke");
+            wpn.getVars()["damage_area_effect"].Set("linear");
+            b &= assertEquals(7.f, wpn.getStats().m_fAccAngle, "acc_angle 2");
+            b &= assertEquals(7.f, wpn.getAccuracyByPose(false /* bMoving */, false /* bRun */, false /* bDuck */), "accuracy by pose");
+            b &= assertEquals(80, wpn.getStats().m_nFiringCooldownMillisecs, "firing_cooldown 2");
+            b &= assertEquals(12.5f, wpn.getFiringRate(), "firing rate");
+            b &= assertEquals(Bullet::ParticleType::Smoke, wpn.getStats().m_eBulletParticle, "bullet_particle 2");
+            b &= assertEquals(Bullet::DamageAreaEffect::Linear, wpn.getStats().m_eDamageAreaEffect, "damage_area_effect 2");
+
+            wpn.getVars()["reloadable"].Set(0);
+            wpn.SetMagBulletCount(500); // not reloadable anymore, so limit is cap_max instead of reloadable
+            b &= assertEquals(500u, wpn.getMagBulletCount(), "mag bullet count");
+
+            // reference kept from an earlier getVars() call requires explicit update
+            PGEcfgVariable& cvarCapMax = wpn.getVars()["cap_max"];
+            b &= assertEquals(999u, wpn.getStats().m_nCapMax, "cap_max 2");
+            cvarCapMax.Set(600);
+            wpn.updateStats();
+            b &= assertEquals(600u, wpn.getStats().m_nCapMax, "cap_max 3");
+
+            // modifying CVARs through setVar() is picked up immediately, even with a reference kept from an earlier getStats() call
+            const WeaponStats& statsRef = wpn.getStats();
+            b &= assertTrue(wpn.setVar("cap_max", 700), "setVar cap_max");
+            b &= assertEquals(700u, statsRef.m_nCapMax, "cap_max 4");
+            b &= assertFalse(wpn.setVar("no_such_var", 1), "setVar no_such_var");
+
+            // copy has the same stats
+            const Weapon wpnCopy(wpn);
+            b &= assertEquals(7.f, wpnCopy.getStats().m_fAccAngle, "copy acc_angle");
+            b &= assertEquals(700u, wpnCopy.getStats().m_nCapMax, "copy cap_max");
+        }
+        catch (const std::exception& e)
+        {
+            b &= assertTrue(false, e.what());
+        }
+
+        return b;
+    }
+
+    bool test_benchmark_wpn_pull_trigger()
+    {
+        constexpr int nIterations = 100000;
+
+        bool b = false;
+        try
+        {
+            PgeObjectPool<PooledBullet> bullets("pool", nBulletPoolCap, *engine);
+            Weapon wpn("gamedata/weapons/sample_good_wpn_automatic.txt", bullets, m_audio, *engine, 0);
+            b = true;
+
+            // same values pullTrigger() and getMomentaryAccuracy() used to look up by CVAR names for each shot ...
+            const Weapon& wpnConst = wpn;
+            float fSumByVars = 0.f;
+            auto timeStart = std::chrono::steady_clock::now();
+            for (int i = 0; i < nIterations; i++)
+            {
+                const auto& vars = wpnConst.getVars();
+                fSumByVars +=
+                    (vars.at("reload_per_mag").getAsBool() ? 1.f : 0.f) +
+                    vars.at("acc_angle").getAsFloat() * vars.at("acc_m_duck").getAsFloat() * vars.at("acc_m_run").getAsFloat() +
+                    vars.at("recoil_m").getAsFloat() + vars.at("recoil_cooldown").getAsFloat() +
+                    (vars.at("bullet_visible").getAsBool() ? 1.f : 0.f) +
+                    vars.at("bullet_size_x").getAsFloat() + vars.at("bullet_size_y").getAsFloat() + vars.at("bullet_size_z").getAsFloat() +
+                    vars.at("bullet_speed").getAsFloat() + vars.at("bullet_gravity").getAsFloat() + vars.at("bullet_drag").getAsFloat() +
+                    (vars.at("bullet_fragile").getAsBool() ? 1.f : 0.f) + vars.at("bullet_distance_max").getAsFloat() +
+                    (vars.at("bullet_particle").getAsString() == "smoke" ? 1.f : 0.f) +
+                    vars.at("damage_ap").getAsInt() + vars.at("damage_hp").getAsInt() + vars.at("damage_area_size").getAsFloat() +
+                    (vars.at("damage_area_effect").getAsString() == "linear" ? 1.f : 0.f) + vars.at("damage_area_pulse").getAsFloat();
+            }
+            const auto nDurationByVarsUSecs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - timeStart).count();
+
+            // ... and now the same values from the compiled stats
+            float fSumByStats = 0.f;
+            timeStart = std::chrono::steady_clock::now();
+            for (int i = 0; i < nIterations; i++)
+            {
+                const WeaponStats& stats = wpnConst.getStats();
+                fSumByStats +=
+                    (stats.m_bReloadPerMag ? 1.f : 0.f) +
+                    stats.m_fAccAngle * stats.m_fAccMDuck * stats.m_fAccMRun +
+                    stats.m_fRecoilM + stats.m_fRecoilCooldownMillisecs +
+                    (stats.m_bBulletVisible ? 1.f : 0.f) +
+                    stats.m_fBulletSizeX + stats.m_fBulletSizeY + stats.m_fBulletSizeZ +
+                    stats.m_fBulletSpeed + stats.m_fBulletGravity + stats.m_fBulletDrag +
+                    (stats.m_bBulletFragile ? 1.f : 0.f) + stats.m_fBulletDistanceMax +
+                    (stats.m_eBulletParticle == Bullet::ParticleType::Smoke ? 1.f : 0.f) +
+                    stats.m_nDamageAp + stats.m_nDamageHp + stats.m_fDamageAreaSize +
+                    (stats.m_eDamageAreaEffect == Bullet::DamageAreaEffect::Linear ? 1.f : 0.f) + stats.m_fDamageAreaPulse;
+            }
+            const auto nDurationByStatsUSecs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - timeStart).count();
+            b &= assertEquals(fSumByVars, fSumByStats, "sum");
+
+            // whole shots, forcing ready state so firing cooldown does not limit the measurement
+            int nShots = 0;
+            timeStart = std::chrono::steady_clock::now();
+            for (int i = 0; i < nIterations; i++)
+            {
+                if (bullets.size() == bullets.capacity())
+                {
+                    bullets.clear();
+                }
+                wpn.clientReceiveStateFromServer(Weapon::WPN_READY);
+                wpn.SetMagBulletCount(30);
+                nShots += wpn.pullTrigger(false /* bMoving */, true /* bRun */, false /* bDuck */) ? 1 : 0;
+            }
+            const auto nDurationShotsUSecs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - timeStart).count();
+            b &= assertEquals(nIterations, nShots, "shots");
+
+            CConsole::getConsoleInstance().OLn(
+                "PgeWeaponsTest::%s(): per-shot CVAR reads: by getVars(): %d us, by getStats(): %d us (%d iterations); pullTrigger(): %.0f shots/sec",
+                __func__,
+                static_cast<int>(nDurationByVarsUSecs),
+                static_cast<int>(nDurationByStatsUSecs),
+                nIterations,
+                (nDurationShotsUSecs > 0) ? (nShots * 1000000.0 / nDurationShotsUSecs) : 0.0);
+        }
+        catch (const std::exception& e)
+        {
+            b &= assertTrue(false, e.what());
+        }
+
+        return b;
+    }
+
     bool test_wm_initially_empty()
     {
         PgeObjectPool<PooledBullet> bullets("pool", nBulletPoolCap, *engine);
@@ -2789,4 +3318,45 @@ private:
         return b;
     }
 
+    bool test_wpn_headless_shoot_creates_bullet_without_gfx_and_audio()
+    {
+        // same state as in headless mode of PGE: neither graphics nor audio is initialized
+        Bullet::destroyReferenceObject();
+        engine->shutdown();
+        m_audio.shutdown();
+
+        bool b = false;
+
+        try
+        {
+            PgeObjectPool<PooledBullet> bullets("pool", nBulletPoolCap, *engine);
+            Weapon wpn("gamedata/weapons/sample_good_wpn_automatic.txt", bullets, m_audio, *engine, 52u);
+            b = true;
+
+            wpn.UpdatePositions(PureVector(1.f, 2.f, 3.f), 180.f, 0.f);
+            b &= assertEquals(PureVector(1.f, 2.f + Weapon::WpnYBiasToPlayerCenter, 3.f), wpn.getPosVec(), "wpn pos");
+            b &= assertEquals(180.f, wpn.getAngleVec().getY(), "wpn angle Y");
+
+            b &= assertTrue(wpn.pullTrigger(false /* bMoving */, false /* bRun */, false /* bDuck */), "shoot");
+            b &= assertEquals(static_cast<size_t>(1), bullets.size(), "bullets size");
+            for (const auto& bullet : bullets)
+            {
+                if (bullet.used())
+                {
+                    b &= assertEquals(wpn.getPosVec(), bullet.getPut().getPosVec(), "bullet pos");
+                    b &= assertEquals(wpn.getOwner(), bullet.getOwner(), "bullet owner");
+                }
+            }
+        }
+        catch (const std::exception& e)
+        {
+            b &= assertTrue(false, e.what());
+        }
+
+        m_audio.initialize();
+        engine->initialize(PURE_RENDERER_HW_FP, 800, 600, PURE_WINDOWED, 0, 32, 24, 0, 0);
+
+        return b;
+    }
+
 }; 
@@ -30,9 +30,30 @@
 #include "PGEcfgVariableTest.h"
 #include "PGEcfgFileTest.h"
 #include "PGEcfgProfilesTest.h"
+#include "PgeNetworkStatsTest.h"
+#include "PgeSnapshotReplicationTest.h"
+#include "PgeSnapshotInterpolatorTest.h"
 #include "PgeOldNewValueTest.h"
 #include "PgePacketTest.h"
+#include "PgePacketCaptureTest.h"
+#include "PgePacketRingTest.h"
+#include "PgePredictionTest.h"
+#include "PgeSpscQueueTest.h"
+#include "PgeConnectionTelemetryTest.h"
+#include "PgeInterestManagerTest.h"
+#include "PgeLagCompensationTest.h"
+#include "PgeLoadGeneratorTest.h"
+#include "PgeBitStreamTest.h"
+#include "PgeBulkTransferTest.h"
+#include "PgeLoopbackTransportTest.h"
+#include "PgeMsgAppCompressorTest.h"
+#include "PgeMsgAppDispatcherTest.h"
+#include "PgeMsgIdAllowListTest.h"
 #include "PGEBulletTest.h"
+#include "PgeBulletSimulationTest.h"
+#include "PgeBulletCollisionTest.h"
+#include "PgeCounterRandomTest.h"
+#include "PgeParticleSystemTest.h"
 #include "PgeWeaponsTest.h"
 #include "PR00FsUltimateRenderingEngineTest.h"
 #include "PR00FsUltimateRenderingEngineTest2.h"
@@ -113,9 +134,30 @@ int WINAPI WinMain(_In_ HINSTANCE /*hInstance*/, _In_opt_ HINSTANCE /*hPrevInsta
     */
     
     //tests.push_back(std::unique_ptr<Test>(new PgePacketTest));
+    //tests.push_back(std::unique_ptr<Test>(new PgePacketCaptureTest));
+    //tests.push_back(std::unique_ptr<Test>(new PgePacketRingTest));
+    //tests.push_back(std::unique_ptr<Test>(new PgePredictionTest));
+    //tests.push_back(std::unique_ptr<Test>(new PgeSpscQueueTest));
+    //tests.push_back(std::unique_ptr<Test>(new PgeConnectionTelemetryTest));
+    //tests.push_back(std::unique_ptr<Test>(new PgeInterestManagerTest));
+    //tests.push_back(std::unique_ptr<Test>(new PgeLagCompensationTest));
+    //tests.push_back(std::unique_ptr<Test>(new PgeLoadGeneratorTest));
+    //tests.push_back(std::unique_ptr<Test>(new PgeNetworkStatsTest));
+    //tests.push_back(std::unique_ptr<Test>(new PgeSnapshotReplicationTest));
+    //tests.push_back(std::unique_ptr<Test>(new PgeSnapshotInterpolatorTest));
+    //tests.push_back(std::unique_ptr<Test>(new PgeBitStreamTest));
+    //tests.push_back(std::unique_ptr<Test>(new PgeBulkTransferTest));
+    //tests.push_back(std::unique_ptr<Test>(new PgeLoopbackTransportTest));
+    //tests.push_back(std::unique_ptr<Test>(new PgeMsgAppCompressorTest));
+    //tests.push_back(std::unique_ptr<Test>(new PgeMsgAppDispatcherTest));
+    //tests.push_back(std::unique_ptr<Test>(new PgeMsgIdAllowListTest));
     
     //tests.push_back(std::unique_ptr<Test>(new PgeWeaponsTest));
     //tests.push_back(std::unique_ptr<Test>(new PGEBulletTest));
+    //tests.push_back(std::unique_ptr<Test>(new PgeBulletSimulationTest));
+    //tests.push_back(std::unique_ptr<Test>(new PgeBulletCollisionTest));
+    //tests.push_back(std::unique_ptr<Test>(new PgeCounterRandomTest));
+    //tests.push_back(std::unique_ptr<Test>(new PgeParticleSystemTest));
     /**/
     
     /*  
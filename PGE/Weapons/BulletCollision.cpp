@@ -0,0 +1,503 @@
+/*
+    ###################################################################################
+    BulletCollision.cpp
+    This file is part of PGE.
+    PR00F's Game Engine swept bullet collision queries
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+#include "BulletCollision.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+
+// ############################### PUBLIC ################################
+
+
+const char* BulletCollision::getLoggerModuleName()
+{
+    return "BulletCollision";
+}
+
+/**
+    @param fCellSize Preferred size of the cells of the uniform grid built by buildWorld(). A good choice is a few times the size
+                     of a typical world box: too small cells make a query visit many empty cells, too big cells contain many boxes.
+                     Must be positive.
+*/
+BulletCollision::BulletCollision(const TPureFloat& fCellSize) noexcept(false) :
+    m_fCellSize(fCellSize),
+    m_bWorldBuilt(false),
+    m_fGridCellSize(fCellSize),
+    m_gridMin{ 0.f, 0.f, 0.f },
+    m_gridDims{ 0, 0, 0 },
+    m_nQueryStamp(0)
+{
+    if (!(fCellSize > 0.f))
+    {
+        getConsole().EOLnOO("BulletCollision ctor: fCellSize must be positive!");
+        throw std::runtime_error("BulletCollision ctor: fCellSize must be positive!");
+    }
+}
+
+/**
+    Returns access to console preset with logger module name as this class.
+*/
+CConsole& BulletCollision::getConsole() const
+{
+    return CConsole::getConsoleInstance(getLoggerModuleName());
+}
+
+const TPureFloat& BulletCollision::getCellSize() const
+{
+    return m_fCellSize;
+}
+
+/**
+    Adds a box to the static world. It is not tested by queries until the next buildWorld().
+
+    @return Index of the box, reported as id in a Hit with HitType::World.
+*/
+uint32_t BulletCollision::addWorldBox(const PureAxisAlignedBoundingBox& aabb)
+{
+    m_vWorldBoxes.push_back(toBox(aabb));
+    m_bWorldBuilt = false;
+    return static_cast<uint32_t>(m_vWorldBoxes.size() - 1);
+}
+
+/**
+    Builds the uniform grid of all world boxes added so far. Boxes are put into every cell they overlap.
+    The grid covers the bounding box of all world boxes, if it would have too many cells, the cell size is doubled until it fits.
+*/
+void BulletCollision::buildWorld()
+{
+    m_vCellStart.clear();
+    m_vCellBoxes.clear();
+    m_vBoxQueryStamp.assign(m_vWorldBoxes.size(), 0);
+    m_nQueryStamp = 0;
+    m_fGridCellSize = m_fCellSize;
+    for (int i = 0; i < 3; i++)
+    {
+        m_gridMin[i] = 0.f;
+        m_gridDims[i] = 0;
+    }
+    m_bWorldBuilt = true;
+
+    if (m_vWorldBoxes.empty())
+    {
+        return;
+    }
+
+    float gridMax[3];
+    for (int i = 0; i < 3; i++)
+    {
+        m_gridMin[i] = m_vWorldBoxes[0].m_min[i];
+        gridMax[i] = m_vWorldBoxes[0].m_max[i];
+    }
+    for (const auto& box : m_vWorldBoxes)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            m_gridMin[i] = std::min(m_gridMin[i], box.m_min[i]);
+            gridMax[i] = std::max(gridMax[i], box.m_max[i]);
+        }
+    }
+
+    std::size_t nCellCount;
+    while (true)
+    {
+        nCellCount = 1;
+        for (int i = 0; i < 3; i++)
+        {
+            m_gridDims[i] = std::max(1, static_cast<int>(std::ceil((gridMax[i] - m_gridMin[i]) / m_fGridCellSize)));
+            nCellCount *= static_cast<std::size_t>(m_gridDims[i]);
+        }
+        if (nCellCount <= nMaxCellCount)
+        {
+            break;
+        }
+        m_fGridCellSize *= 2.f;
+    }
+
+    // 2 passes: count boxes per cell, then fill the cells at the offsets calculated from the counts
+    m_vCellStart.assign(nCellCount + 1, 0);
+    for (const auto& box : m_vWorldBoxes)
+    {
+        for (int z = getCellCoord(2, box.m_min[2]); z <= getCellCoord(2, box.m_max[2]); z++)
+        {
+            for (int y = getCellCoord(1, box.m_min[1]); y <= getCellCoord(1, box.m_max[1]); y++)
+            {
+                for (int x = getCellCoord(0, box.m_min[0]); x <= getCellCoord(0, box.m_max[0]); x++)
+                {
+                    ++m_vCellStart[getCellIndex(x, y, z) + 1];
+                }
+            }
+        }
+    }
+    for (std::size_t i = 0; i < nCellCount; i++)
+    {
+        m_vCellStart[i + 1] += m_vCellStart[i];
+    }
+
+    m_vCellBoxes.resize(m_vCellStart[nCellCount]);
+    std::vector<uint32_t> vCellFill(m_vCellStart.begin(), m_vCellStart.end() - 1);
+    for (uint32_t iBox = 0; iBox < m_vWorldBoxes.size(); iBox++)
+    {
+        const Box& box = m_vWorldBoxes[iBox];
+        for (int z = getCellCoord(2, box.m_min[2]); z <= getCellCoord(2, box.m_max[2]); z++)
+        {
+            for (int y = getCellCoord(1, box.m_min[1]); y <= getCellCoord(1, box.m_max[1]); y++)
+            {
+                for (int x = getCellCoord(0, box.m_min[0]); x <= getCellCoord(0, box.m_max[0]); x++)
+                {
+                    m_vCellBoxes[vCellFill[getCellIndex(x, y, z)]++] = iBox;
+                }
+            }
+        }
+    }
+
+    getConsole().OLn("BulletCollision::%s(): %u boxes in %d x %d x %d cells of size %f",
+        __func__, static_cast<unsigned>(m_vWorldBoxes.size()), m_gridDims[0], m_gridDims[1], m_gridDims[2], m_fGridCellSize);
+}
+
+void BulletCollision::clearWorld()
+{
+    m_vWorldBoxes.clear();
+    buildWorld();
+}
+
+std::size_t BulletCollision::getWorldBoxCount() const
+{
+    return m_vWorldBoxes.size();
+}
+
+/**
+    @return False if world boxes were added since the last buildWorld().
+*/
+bool BulletCollision::isWorldBuilt() const
+{
+    return m_bWorldBuilt;
+}
+
+/**
+    Adds the bounding box of a player, tested by queries until the next clearPlayers().
+*/
+void BulletCollision::addPlayer(const pge_network::PgeNetworkConnectionHandle& connHandle, const PureAxisAlignedBoundingBox& aabb)
+{
+    m_vPlayers.push_back(PlayerBox{ connHandle, toBox(aabb) });
+}
+
+void BulletCollision::clearPlayers()
+{
+    m_vPlayers.clear();
+}
+
+std::size_t BulletCollision::getPlayerCount() const
+{
+    return m_vPlayers.size();
+}
+
+/**
+    Finds the earliest hit along the given segment, either with the static world or with a player.
+    If the segment hits a world box and a player at the same fraction, the world box is reported.
+
+    Not thread-safe, see the class description.
+
+    @return True if the segment hits anything, false otherwise. Hit type is HitType::None if there is no hit.
+*/
+bool BulletCollision::findFirstHit(const Segment& segment, Hit& hit)
+{
+    hit.m_type = HitType::None;
+
+    Ray ray;
+    initRay(segment, ray);
+
+    float fFraction = 1.f;
+    int iAxis = -1;
+    uint32_t id = 0;
+    if (findFirstWorldHit(ray, fFraction, iAxis, id))
+    {
+        hit.m_type = HitType::World;
+    }
+
+    uint32_t iPlayer = 0;
+    if (findFirstPlayerHit(ray, segment.m_ignoredPlayer, hit.m_type == HitType::World, fFraction, iAxis, iPlayer))
+    {
+        hit.m_type = HitType::Player;
+        id = m_vPlayers[iPlayer].m_connHandle;
+    }
+
+    if (hit.m_type == HitType::None)
+    {
+        return false;
+    }
+
+    hit.m_id = id;
+    hit.m_fFraction = fFraction;
+    hit.m_pos.Set(
+        ray.m_start[0] + ray.m_delta[0] * fFraction,
+        ray.m_start[1] + ray.m_delta[1] * fFraction,
+        ray.m_start[2] + ray.m_delta[2] * fFraction);
+    hit.m_normal.Set(0.f, 0.f, 0.f);
+    if (iAxis >= 0)
+    {
+        hit.m_normal[static_cast<TPureByte>(iAxis)] = (ray.m_delta[iAxis] > 0.f) ? -1.f : 1.f;
+    }
+    return true;
+}
+
+/**
+    Same as findFirstHit() for each given segment, e.g. for all bullets moved in the current tick.
+
+    @param vSegments The segments to be tested.
+    @param vHits     Resized to the number of segments, i-th element is the hit of the i-th segment.
+
+    @return Number of segments hitting anything.
+*/
+std::size_t BulletCollision::findFirstHits(const std::vector<Segment>& vSegments, std::vector<Hit>& vHits)
+{
+    vHits.resize(vSegments.size());
+    std::size_t nHits = 0;
+    for (std::size_t i = 0; i < vSegments.size(); i++)
+    {
+        if (findFirstHit(vSegments[i], vHits[i]))
+        {
+            ++nHits;
+        }
+    }
+    return nHits;
+}
+
+
+// ############################## PROTECTED ##############################
+
+
+// ############################### PRIVATE ###############################
+
+
+BulletCollision::Box BulletCollision::toBox(const PureAxisAlignedBoundingBox& aabb)
+{
+    const PureVector& pos = aabb.getPosVec();
+    const PureVector& size = aabb.getSizeVec();
+    return Box{
+        { pos.getX() - size.getX() / 2.f, pos.getY() - size.getY() / 2.f, pos.getZ() - size.getZ() / 2.f },
+        { pos.getX() + size.getX() / 2.f, pos.getY() + size.getY() / 2.f, pos.getZ() + size.getZ() / 2.f } };
+}
+
+void BulletCollision::initRay(const Segment& segment, Ray& ray)
+{
+    ray.m_start[0] = segment.m_start.getX();
+    ray.m_start[1] = segment.m_start.getY();
+    ray.m_start[2] = segment.m_start.getZ();
+    ray.m_delta[0] = segment.m_end.getX() - ray.m_start[0];
+    ray.m_delta[1] = segment.m_end.getY() - ray.m_start[1];
+    ray.m_delta[2] = segment.m_end.getZ() - ray.m_start[2];
+    for (int i = 0; i < 3; i++)
+    {
+        // zero means the segment is parallel to the slab
+        ray.m_invDelta[i] = (ray.m_delta[i] == 0.f) ? 0.f : (1.f / ray.m_delta[i]);
+    }
+}
+
+/**
+    Slab test of the segment against the box.
+
+    @param fFraction Where the segment enters the box, 0 if the segment starts inside the box.
+    @param iAxis     Axis of the face through which the segment enters the box, -1 if the segment starts inside the box.
+
+    @return True if the segment intersects the box.
+*/
+bool BulletCollision::intersect(const Ray& ray, const Box& box, float& fFraction, int& iAxis)
+{
+    float fEnter = 0.f;
+    float fExit = 1.f;
+    int iEnterAxis = -1;
+    for (int i = 0; i < 3; i++)
+    {
+        if (ray.m_invDelta[i] == 0.f)
+        {
+            if ((ray.m_start[i] < box.m_min[i]) || (ray.m_start[i] > box.m_max[i]))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        float fNear = (box.m_min[i] - ray.m_start[i]) * ray.m_invDelta[i];
+        float fFar = (box.m_max[i] - ray.m_start[i]) * ray.m_invDelta[i];
+        if (fNear > fFar)
+        {
+            std::swap(fNear, fFar);
+        }
+        if (fNear > fEnter)
+        {
+            fEnter = fNear;
+            iEnterAxis = i;
+        }
+        fExit = std::min(fExit, fFar);
+        if (fEnter > fExit)
+        {
+            return false;
+        }
+    }
+
+    fFraction = fEnter;
+    iAxis = iEnterAxis;
+    return true;
+}
+
+/**
+    @return True if fNewFraction is earlier than fFraction, or if the same but there is no hit yet, so hits at the very end of the
+            segment are also found.
+*/
+bool BulletCollision::isEarlier(const float& fNewFraction, const bool& bHit, const float& fFraction)
+{
+    return (fNewFraction < fFraction) || (!bHit && (fNewFraction == fFraction));
+}
+
+std::size_t BulletCollision::getCellIndex(const int& x, const int& y, const int& z) const
+{
+    return (static_cast<std::size_t>(z) * m_gridDims[1] + y) * m_gridDims[0] + x;
+}
+
+/**
+    @return Cell coordinate of the given position along the given axis, clamped to the grid.
+*/
+int BulletCollision::getCellCoord(const int& iAxis, const float& fPos) const
+{
+    const int c = static_cast<int>(std::floor((fPos - m_gridMin[iAxis]) / m_fGridCellSize));
+    return std::max(0, std::min(m_gridDims[iAxis] - 1, c));
+}
+
+/**
+    Walks the cells along the segment in order (3D DDA), testing the boxes of each visited cell.
+    The walk stops at the first cell whose far side is not closer than the earliest hit found so far: a box hit earlier would
+    have been registered in an already visited cell, since boxes are put into all cells they overlap.
+
+    @param fFraction In: only hits not after this are considered. Out: fraction of the earliest hit, if any.
+*/
+bool BulletCollision::findFirstWorldHit(const Ray& ray, float& fFraction, int& iAxis, uint32_t& iBox)
+{
+    if (!m_bWorldBuilt || m_vWorldBoxes.empty())
+    {
+        return false;
+    }
+
+    const Box gridBox{
+        { m_gridMin[0], m_gridMin[1], m_gridMin[2] },
+        { m_gridMin[0] + m_gridDims[0] * m_fGridCellSize, m_gridMin[1] + m_gridDims[1] * m_fGridCellSize, m_gridMin[2] + m_gridDims[2] * m_fGridCellSize } };
+    float fGridEnter;
+    int iGridAxis;
+    if (!intersect(ray, gridBox, fGridEnter, iGridAxis))
+    {
+        return false;
+    }
+
+    if (++m_nQueryStamp == 0)
+    {
+        // wrapped around, stamps from earlier queries could be mistaken for the current one
+        std::fill(m_vBoxQueryStamp.begin(), m_vBoxQueryStamp.end(), 0);
+        m_nQueryStamp = 1;
+    }
+
+    int cell[3];
+    int step[3];
+    float tMax[3];
+    float tDelta[3];
+    for (int i = 0; i < 3; i++)
+    {
+        cell[i] = getCellCoord(i, ray.m_start[i] + ray.m_delta[i] * fGridEnter);
+        if (ray.m_invDelta[i] == 0.f)
+        {
+            step[i] = 0;
+            tMax[i] = std::numeric_limits<float>::max();
+            tDelta[i] = std::numeric_limits<float>::max();
+            continue;
+        }
+        step[i] = (ray.m_delta[i] > 0.f) ? 1 : -1;
+        const float fBoundary = m_gridMin[i] + (cell[i] + ((step[i] > 0) ? 1 : 0)) * m_fGridCellSize;
+        tMax[i] = (fBoundary - ray.m_start[i]) * ray.m_invDelta[i];
+        tDelta[i] = m_fGridCellSize * std::abs(ray.m_invDelta[i]);
+    }
+
+    bool bHit = false;
+    while (true)
+    {
+        const std::size_t iCell = getCellIndex(cell[0], cell[1], cell[2]);
+        for (uint32_t i = m_vCellStart[iCell]; i < m_vCellStart[iCell + 1]; i++)
+        {
+            const uint32_t iCellBox = m_vCellBoxes[i];
+            if (m_vBoxQueryStamp[iCellBox] == m_nQueryStamp)
+            {
+                continue;
+            }
+            m_vBoxQueryStamp[iCellBox] = m_nQueryStamp;
+
+            float fBoxFraction;
+            int iBoxAxis;
+            if (intersect(ray, m_vWorldBoxes[iCellBox], fBoxFraction, iBoxAxis) && isEarlier(fBoxFraction, bHit, fFraction))
+            {
+                bHit = true;
+                fFraction = fBoxFraction;
+                iAxis = iBoxAxis;
+                iBox = iCellBox;
+            }
+        }
+
+        const int iNextAxis = (tMax[0] < tMax[1]) ? ((tMax[0] < tMax[2]) ? 0 : 2) : ((tMax[1] < tMax[2]) ? 1 : 2);
+        const float fCellExit = tMax[iNextAxis];
+        if ((fCellExit > 1.f) || (bHit && (fFraction <= fCellExit)))
+        {
+            break;
+        }
+
+        cell[iNextAxis] += step[iNextAxis];
+        if ((cell[iNextAxis] < 0) || (cell[iNextAxis] >= m_gridDims[iNextAxis]))
+        {
+            break;
+        }
+        tMax[iNextAxis] += tDelta[iNextAxis];
+    }
+
+    return bHit;
+}
+
+/**
+    @param bWorldHit True if findFirstWorldHit() found a hit at fFraction, then players are hit only if they are hit earlier.
+    @param fFraction In: only hits before this are considered. Out: fraction of the earliest hit, if any.
+*/
+bool BulletCollision::findFirstPlayerHit(
+    const Ray& ray,
+    const pge_network::PgeNetworkConnectionHandle& ignoredPlayer,
+    const bool& bWorldHit,
+    float& fFraction,
+    int& iAxis,
+    uint32_t& iPlayer) const
+{
+    bool bHit = bWorldHit;
+    bool bPlayerHit = false;
+    for (uint32_t i = 0; i < m_vPlayers.size(); i++)
+    {
+        const PlayerBox& player = m_vPlayers[i];
+        if (player.m_connHandle == ignoredPlayer)
+        {
+            continue;
+        }
+
+        float fPlayerFraction;
+        int iPlayerAxis;
+        if (intersect(ray, player.m_box, fPlayerFraction, iPlayerAxis) && isEarlier(fPlayerFraction, bHit, fFraction))
+        {
+            bHit = true;
+            bPlayerHit = true;
+            fFraction = fPlayerFraction;
+            iAxis = iPlayerAxis;
+            iPlayer = i;
+        }
+    }
+    return bPlayerHit;
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+/*
+    ###################################################################################
+    BulletCollision.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine swept bullet collision queries
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include <cstdint>
+#include <vector>
+
+#include "../PGEallHeaders.h"
+#include "../Pure/include/internal/SpatialStructures/PureAxisAlignedBoundingBox.h"
+#include "../Network/PgePacket.h"
+
+/**
+    Swept collision queries for bullets: the segment a bullet covers within a tick, from its position before the tick to its
+    position after the tick, is tested against the static world and the players, and the earliest hit along the segment is returned.
+    Since the whole segment is tested, a fast bullet cannot skip a thin wall even at low tick rate, unlike when only the position
+    after the tick is tested.
+
+    Static world boxes (e.g. map blocks) are added once by addWorldBox(), then buildWorld() puts them into a uniform grid,
+    so a query visits only the cells along the segment instead of testing all boxes of the world.
+    Player boxes change every tick, the application is expected to invoke clearPlayers() and then addPlayer() for each player every
+    tick before the queries. There are only a few players, so they are simply tested one by one.
+
+    Queries are not const and not thread-safe: boxes spanning multiple cells are marked as tested in an array shared by all queries,
+    so they are tested only once per query. Parallel queries need a separate BulletCollision instance per thread.
+*/
+class BulletCollision
+{
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  BulletCollision is included")
+#endif
+
+public:
+
+    enum class HitType
+    {
+        None,
+        World,
+        Player
+    };
+
+    struct Hit
+    {
+        HitType m_type;
+        uint32_t m_id;          /**< Index of the world box as returned by addWorldBox(), or connection handle of the player. */
+        float m_fFraction;      /**< Position of the hit along the segment, 0 is the start, 1 is the end. */
+        PureVector m_pos;       /**< World-space position where the segment enters the box. */
+        PureVector m_normal;    /**< Unit normal of the face of the box entered by the segment, zero vector if the segment starts inside the box. */
+    };
+
+    struct Segment
+    {
+        PureVector m_start;
+        PureVector m_end;
+        pge_network::PgeNetworkConnectionHandle m_ignoredPlayer;   /**< Usually owner of the bullet, to avoid hitting the shooter. */
+    };
+
+    static const char* getLoggerModuleName();          /**< Returns the logger module name of this class. */
+
+    // ---------------------------------------------------------------------------
+
+    explicit BulletCollision(const TPureFloat& fCellSize) noexcept(false);
+    ~BulletCollision() = default;
+
+    BulletCollision(const BulletCollision&) = delete;
+    BulletCollision& operator=(const BulletCollision&) = delete;
+    BulletCollision(BulletCollision&&) = delete;
+    BulletCollision& operator=(BulletCollision&&) = delete;
+
+    CConsole& getConsole() const;                      /**< Returns access to console preset with logger module name as this class. */
+
+    const TPureFloat& getCellSize() const;
+
+    uint32_t addWorldBox(const PureAxisAlignedBoundingBox& aabb);
+    void buildWorld();
+    void clearWorld();
+    std::size_t getWorldBoxCount() const;
+    bool isWorldBuilt() const;
+
+    void addPlayer(const pge_network::PgeNetworkConnectionHandle& connHandle, const PureAxisAlignedBoundingBox& aabb);
+    void clearPlayers();
+    std::size_t getPlayerCount() const;
+
+    bool findFirstHit(const Segment& segment, Hit& hit);
+    std::size_t findFirstHits(const std::vector<Segment>& vSegments, std::vector<Hit>& vHits);
+
+private:
+
+    /** Box stored as min and max corners, so the segment test does not need to compute them from center and size. */
+    struct Box
+    {
+        float m_min[3];
+        float m_max[3];
+    };
+
+    struct PlayerBox
+    {
+        pge_network::PgeNetworkConnectionHandle m_connHandle;
+        Box m_box;
+    };
+
+    /** Precalculated values of a segment, shared by all box tests of a query. */
+    struct Ray
+    {
+        float m_start[3];
+        float m_delta[3];
+        float m_invDelta[3];
+    };
+
+    static constexpr std::size_t nMaxCellCount = 1u << 20;   /**< Cell size is increased by buildWorld() if the grid would have more cells. */
+
+    const TPureFloat m_fCellSize;
+
+    std::vector<Box> m_vWorldBoxes;
+    std::vector<PlayerBox> m_vPlayers;
+
+    // uniform grid built by buildWorld(), box indices of cell i are m_vCellBoxes[m_vCellStart[i] .. m_vCellStart[i+1]-1]
+    bool m_bWorldBuilt;
+    float m_fGridCellSize;
+    float m_gridMin[3];
+    int m_gridDims[3];
+    std::vector<uint32_t> m_vCellStart;
+    std::vector<uint32_t> m_vCellBoxes;
+
+    std::vector<uint32_t> m_vBoxQueryStamp;   /**< Stamp of the last query that tested the box. */
+    uint32_t m_nQueryStamp;
+
+    // ---------------------------------------------------------------------------
+
+    static Box toBox(const PureAxisAlignedBoundingBox& aabb);
+    static void initRay(const Segment& segment, Ray& ray);
+    static bool intersect(const Ray& ray, const Box& box, float& fFraction, int& iAxis);
+    static bool isEarlier(const float& fNewFraction, const bool& bHit, const float& fFraction);
+
+    std::size_t getCellIndex(const int& x, const int& y, const int& z) const;
+    int getCellCoord(const int& iAxis, const float& fPos) const;
+    bool findFirstWorldHit(const Ray& ray, float& fFraction, int& iAxis, uint32_t& iBox);
+    bool findFirstPlayerHit(
+        const Ray& ray,
+        const pge_network::PgeNetworkConnectionHandle& ignoredPlayer,
+        const bool& bWorldHit,
+        float& fFraction,
+        int& iAxis,
+        uint32_t& iPlayer) const;
+
+}; // class BulletCollision
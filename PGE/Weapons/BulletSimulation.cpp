@@ -0,0 +1,307 @@
+/*
+    ###################################################################################
+    BulletSimulation.cpp
+    This file is part of PGE.
+    PR00F's Game Engine batched bullet simulation
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+#include "BulletSimulation.h"
+
+#include <algorithm>
+#include <cmath>
+
+// SSE is available on all x64 targets, and on x86 targets built with /arch:SSE or above
+#if defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1)) || defined(__SSE__)
+#define PGE_BULLETSIMULATION_SSE
+#include <xmmintrin.h>
+#endif
+
+
+// ############################### PUBLIC ################################
+
+
+const char* BulletSimulation::getLoggerModuleName()
+{
+    return "BulletSimulation";
+}
+
+/**
+    The pool can be empty or even zero-capacity at this point, the arrays are resized by Update() when the capacity of the pool changes.
+
+    @param bullets The pool of bullets to be simulated by Update().
+*/
+BulletSimulation::BulletSimulation(PgeObjectPool<PooledBullet>& bullets) :
+    m_bullets(bullets),
+    m_nSlotsInUse(0),
+    m_nActiveCount(0)
+{
+    resize(m_bullets.capacity());
+}
+
+/**
+    Returns access to console preset with logger module name as this class.
+*/
+CConsole& BulletSimulation::getConsole() const
+{
+    return CConsole::getConsoleInstance(getLoggerModuleName());
+}
+
+/**
+    Integrates all bullets of the pool by 1 physics iteration, same as invoking Bullet::Update() for each used bullet of the pool,
+    except that gravity and drag are also applied.
+    Newly created bullets are loaded first, then all bullets are integrated together, and finally the new positions and travelled
+    distances are written back to the bullets.
+
+    @param nFactor Same as for Bullet::Update(). Nothing happens if 0.
+*/
+void BulletSimulation::Update(const unsigned int& nFactor)
+{
+    if (nFactor == 0)
+    {
+        return;
+    }
+
+    if (m_vActive.size() != m_bullets.capacity())
+    {
+        resize(m_bullets.capacity());
+    }
+
+    gather();
+    integrate(1.f / nFactor);
+    scatter();
+}
+
+std::size_t BulletSimulation::getActiveCount() const
+{
+    return m_nActiveCount;
+}
+
+/**
+    @return Sum of 1/nFactor for each Update() since the bullet was created, 0 if the bullet is not in the pool or was not yet
+            seen by Update().
+*/
+TPureFloat BulletSimulation::getLifetime(const PooledBullet& bullet) const
+{
+    const std::size_t iSlot = static_cast<std::size_t>(&bullet - m_bullets.elems());
+    if ((iSlot >= m_vActive.size()) || !m_vActive[iSlot])
+    {
+        return 0.f;
+    }
+    return m_vLifetime[iSlot];
+}
+
+/**
+    @return Velocity of the bullet after the last Update(), zero vector if the bullet is not in the pool or was not yet seen by Update().
+*/
+PureVector BulletSimulation::getVelocity(const PooledBullet& bullet) const
+{
+    const std::size_t iSlot = static_cast<std::size_t>(&bullet - m_bullets.elems());
+    if ((iSlot >= m_vActive.size()) || !m_vActive[iSlot])
+    {
+        return PureVector();
+    }
+    return PureVector(m_vVelX[iSlot], m_vVelY[iSlot], m_vVelZ[iSlot]);
+}
+
+
+// ############################## PROTECTED ##############################
+
+
+// ############################### PRIVATE ###############################
+
+
+/**
+    Slots below both the old and the new capacity keep their state, so bullets already in flight keep the velocity accumulated by
+    gravity and drag and their lifetime. Slots at or above the new capacity are dropped, the remaining padding slots are zeroed.
+*/
+void BulletSimulation::resize(const std::size_t& nCapacity)
+{
+    // the integrate loop processes 4 slots at once, padding avoids a separate loop for the remaining slots
+    const std::size_t nPaddedCapacity = (nCapacity + 3) & ~static_cast<std::size_t>(3);
+
+    for (std::vector<float>* pArray : {
+        &m_vPosX, &m_vPosY, &m_vPosZ, &m_vVelX, &m_vVelY, &m_vVelZ, &m_vSpeed, &m_vGravity, &m_vDrag, &m_vDistTravelled, &m_vLifetime })
+    {
+        pArray->resize(nPaddedCapacity, 0.f);
+        // when shrinking, the padding slots might still hold the state of dropped slots
+        std::fill(pArray->begin() + nCapacity, pArray->end(), 0.f);
+    }
+    m_vActive.resize(nCapacity, 0);
+
+    m_nSlotsInUse = std::min(m_nSlotsInUse, nCapacity);
+    m_nActiveCount = static_cast<std::size_t>(std::count(m_vActive.begin(), m_vActive.end(), static_cast<uint8_t>(1)));
+}
+
+/**
+    Loads bullets created since the previous Update(), and drops bullets removed since then.
+*/
+void BulletSimulation::gather()
+{
+    PooledBullet* const pBullets = m_bullets.elems();
+    m_nSlotsInUse = 0;
+    m_nActiveCount = 0;
+    for (std::size_t i = 0; i < m_vActive.size(); i++)
+    {
+        PooledBullet& bullet = pBullets[i];
+        if (!bullet.used())
+        {
+            if (m_vActive[i])
+            {
+                deactivate(i);
+            }
+            continue;
+        }
+
+        if (!m_vActive[i] || !bullet.m_bSimulationLoaded)
+        {
+            load(i, bullet);
+            bullet.m_bSimulationLoaded = true;
+        }
+        m_nSlotsInUse = i + 1;
+        m_nActiveCount++;
+    }
+}
+
+void BulletSimulation::load(const std::size_t& iSlot, const Bullet& bullet)
+{
+    const PureVector& vecPos = bullet.m_put.getPosVec();
+    PureVector vecDir = bullet.m_put.getTargetVec() - vecPos;
+    vecDir.Normalize();
+
+    m_vPosX[iSlot] = vecPos.getX();
+    m_vPosY[iSlot] = vecPos.getY();
+    m_vPosZ[iSlot] = vecPos.getZ();
+    m_vVelX[iSlot] = vecDir.getX() * bullet.m_speed;
+    m_vVelY[iSlot] = vecDir.getY() * bullet.m_speed;
+    m_vVelZ[iSlot] = vecDir.getZ() * bullet.m_speed;
+    m_vSpeed[iSlot] = bullet.m_speed;
+    m_vGravity[iSlot] = bullet.m_gravity;
+    m_vDrag[iSlot] = bullet.m_drag;
+    m_vDistTravelled[iSlot] = bullet.m_fDistTravelled;
+    m_vLifetime[iSlot] = 0.f;
+    m_vActive[iSlot] = 1;
+}
+
+/**
+    Zero velocity, gravity and drag, so integrate() can process inactive slots without branching and without their values drifting away.
+*/
+void BulletSimulation::deactivate(const std::size_t& iSlot)
+{
+    m_vVelX[iSlot] = 0.f;
+    m_vVelY[iSlot] = 0.f;
+    m_vVelZ[iSlot] = 0.f;
+    m_vSpeed[iSlot] = 0.f;
+    m_vGravity[iSlot] = 0.f;
+    m_vDrag[iSlot] = 0.f;
+    m_vActive[iSlot] = 0;
+}
+
+/**
+    Semi-implicit Euler step: velocity is updated first by gravity and drag, then position by the new velocity.
+    Inactive slots below m_nSlotsInUse are integrated too, it is cheaper than skipping them.
+*/
+void BulletSimulation::integrate(const float& fInvFactor)
+{
+    float* const px = m_vPosX.data();
+    float* const py = m_vPosY.data();
+    float* const pz = m_vPosZ.data();
+    float* const vx = m_vVelX.data();
+    float* const vy = m_vVelY.data();
+    float* const vz = m_vVelZ.data();
+    float* const speed = m_vSpeed.data();
+    float* const dist = m_vDistTravelled.data();
+    float* const lifetime = m_vLifetime.data();
+    const float* const gravity = m_vGravity.data();
+    const float* const drag = m_vDrag.data();
+
+    const std::size_t nSlots = (m_nSlotsInUse + 3) & ~static_cast<std::size_t>(3);
+
+#ifdef PGE_BULLETSIMULATION_SSE
+    const __m128 invFactor = _mm_set1_ps(fInvFactor);
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 zero = _mm_setzero_ps();
+    for (std::size_t i = 0; i < nSlots; i += 4)
+    {
+        // keep = max(0, 1 - drag/nFactor)
+        const __m128 keep = _mm_max_ps(zero, _mm_sub_ps(one, _mm_mul_ps(_mm_loadu_ps(drag + i), invFactor)));
+        const __m128 newVx = _mm_mul_ps(_mm_loadu_ps(vx + i), keep);
+        const __m128 newVy = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(vy + i), _mm_mul_ps(_mm_loadu_ps(gravity + i), invFactor)), keep);
+        const __m128 newVz = _mm_mul_ps(_mm_loadu_ps(vz + i), keep);
+        _mm_storeu_ps(vx + i, newVx);
+        _mm_storeu_ps(vy + i, newVy);
+        _mm_storeu_ps(vz + i, newVz);
+
+        _mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(newVx, invFactor)));
+        _mm_storeu_ps(py + i, _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(newVy, invFactor)));
+        _mm_storeu_ps(pz + i, _mm_add_ps(_mm_loadu_ps(pz + i), _mm_mul_ps(newVz, invFactor)));
+
+        const __m128 newSpeed = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(newVx, newVx), _mm_mul_ps(newVy, newVy)), _mm_mul_ps(newVz, newVz)));
+        _mm_storeu_ps(speed + i, newSpeed);
+        _mm_storeu_ps(dist + i, _mm_add_ps(_mm_loadu_ps(dist + i), _mm_mul_ps(newSpeed, invFactor)));
+        _mm_storeu_ps(lifetime + i, _mm_add_ps(_mm_loadu_ps(lifetime + i), invFactor));
+    }
+#else
+    for (std::size_t i = 0; i < nSlots; i++)
+    {
+        const float keep = std::max(0.f, 1.f - drag[i] * fInvFactor);
+        vx[i] *= keep;
+        vy[i] = (vy[i] - gravity[i] * fInvFactor) * keep;
+        vz[i] *= keep;
+
+        px[i] += vx[i] * fInvFactor;
+        py[i] += vy[i] * fInvFactor;
+        pz[i] += vz[i] * fInvFactor;
+
+        speed[i] = std::sqrt(vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i]);
+        dist[i] += speed[i] * fInvFactor;
+        lifetime[i] += fInvFactor;
+    }
+#endif
+}
+
+/**
+    Writes back position and travelled distance to the bullets.
+    Target of the PUT is kept 1 unit ahead of the position in the direction of the velocity, same as Bullet::init() sets it,
+    so getPut() stays usable for anything expecting a direction.
+*/
+void BulletSimulation::scatter()
+{
+    PooledBullet* const pBullets = m_bullets.elems();
+    for (std::size_t i = 0; i < m_nSlotsInUse; i++)
+    {
+        if (!m_vActive[i])
+        {
+            continue;
+        }
+
+        Bullet& bullet = pBullets[i];
+        PureVector& vecPos = bullet.m_put.getPosVec();
+        PureVector& vecTarget = bullet.m_put.getTargetVec();
+        if (m_vSpeed[i] > 0.f)
+        {
+            const float fInvSpeed = 1.f / m_vSpeed[i];
+            vecTarget.Set(
+                m_vPosX[i] + m_vVelX[i] * fInvSpeed,
+                m_vPosY[i] + m_vVelY[i] * fInvSpeed,
+                m_vPosZ[i] + m_vVelZ[i] * fInvSpeed);
+        }
+        else
+        {
+            // stopped by drag, keep the last direction
+            vecTarget.Set(
+                m_vPosX[i] + (vecTarget.getX() - vecPos.getX()),
+                m_vPosY[i] + (vecTarget.getY() - vecPos.getY()),
+                m_vPosZ[i] + (vecTarget.getZ() - vecPos.getZ()));
+        }
+        vecPos.Set(m_vPosX[i], m_vPosY[i], m_vPosZ[i]);
+
+        if (bullet.m_obj)
+        {
+            bullet.m_obj->getPosVec() = vecPos;
+        }
+        bullet.m_fDistTravelled = m_vDistTravelled[i];
+    }
+}
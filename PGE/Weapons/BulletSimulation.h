@@ -0,0 +1,95 @@
+#pragma once
+
+/*
+    ###################################################################################
+    BulletSimulation.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine batched bullet simulation
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include <cstdint>
+#include <vector>
+
+#include "../PGEallHeaders.h"
+#include "WeaponManager.h"
+
+/**
+    Batched bullet simulation for bullets stored in a PgeObjectPool<PooledBullet>.
+    This is an alternative to invoking Bullet::Update() for each bullet one by one: the kinematics of the bullets
+    (position, velocity, distance travelled, lifetime) are kept in structure-of-arrays form, so a single Update()
+    integrates all bullets with SIMD, and then writes the new positions back to the bullets (PUT and 3D object) in one pass.
+
+    Unlike Bullet::Update(), this also applies the gravity and drag of the bullets:
+     - gravity is the decrease of the Y component of the velocity per physics iteration;
+     - drag is the fraction of the velocity lost per physics iteration.
+    Both are scaled by nFactor the same way as speed is scaled in Bullet::Update(), so with zero gravity and drag the
+    bullets move exactly as they would move by Bullet::Update().
+
+    The arrays are indexed by the position of the bullet in the pool, so no mapping is needed between pool and arrays.
+    Bullets created in the pool since the previous Update() are picked up automatically by their PUT and speed, even if
+    the pool reused the slot of a bullet removed since the previous Update(), and bullets removed from the pool are dropped automatically.
+    The game is expected to use either this or Bullet::Update() for the bullets of a pool, not both.
+*/
+class BulletSimulation
+{
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  BulletSimulation is included")
+#endif
+
+public:
+    static const char* getLoggerModuleName();          /**< Returns the logger module name of this class. */
+
+    // ---------------------------------------------------------------------------
+
+    explicit BulletSimulation(PgeObjectPool<PooledBullet>& bullets);
+    ~BulletSimulation() = default;
+
+    BulletSimulation(const BulletSimulation&) = delete;
+    BulletSimulation& operator=(const BulletSimulation&) = delete;
+    BulletSimulation(BulletSimulation&&) = delete;
+    BulletSimulation& operator=(BulletSimulation&&) = delete;
+
+    CConsole& getConsole() const;                      /**< Returns access to console preset with logger module name as this class. */
+
+    void Update(const unsigned int& nFactor);          /**< Integrates all bullets of the pool by 1 physics iteration. */
+
+    std::size_t getActiveCount() const;                /**< Number of bullets integrated by the last Update(). */
+    TPureFloat getLifetime(const PooledBullet& bullet) const;   /**< Physics iterations integrated for this bullet so far, scaled by nFactor. */
+    PureVector getVelocity(const PooledBullet& bullet) const;   /**< Current velocity of this bullet, per physics iteration. */
+
+private:
+
+    friend class PgeBulletSimulationTest;   /* Tests resize() directly, the capacity of a pool can be changed only while it is empty. */
+
+    PgeObjectPool<PooledBullet>& m_bullets;
+
+    // structure of arrays, each indexed by the position of the bullet in the pool
+    std::vector<float> m_vPosX;
+    std::vector<float> m_vPosY;
+    std::vector<float> m_vPosZ;
+    std::vector<float> m_vVelX;
+    std::vector<float> m_vVelY;
+    std::vector<float> m_vVelZ;
+    std::vector<float> m_vSpeed;            /**< Length of velocity, calculated by integrate(). */
+    std::vector<float> m_vGravity;
+    std::vector<float> m_vDrag;
+    std::vector<float> m_vDistTravelled;
+    std::vector<float> m_vLifetime;
+    std::vector<uint8_t> m_vActive;
+
+    std::size_t m_nSlotsInUse;              /**< One past the last active slot, only this many slots are integrated. */
+    std::size_t m_nActiveCount;
+
+    // ---------------------------------------------------------------------------
+
+    void resize(const std::size_t& nCapacity);
+    void gather();
+    void load(const std::size_t& iSlot, const Bullet& bullet);
+    void deactivate(const std::size_t& iSlot);
+    void integrate(const float& fInvFactor);
+    void scatter();
+
+}; // class BulletSimulation
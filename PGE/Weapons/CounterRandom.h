@@ -0,0 +1,79 @@
+#pragma once
+
+/*
+    ###################################################################################
+    CounterRandom.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine counter-based random number generator
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include <cstdint>
+
+/**
+    Counter-based random number generator: the n-th random number of a stream is a hash of the key of the stream and n, so there is
+    no generator state to be kept in sync, any number of the stream can be evaluated directly in any order, by anyone knowing the key
+    and the counter. Only integer operations are used, so the result is the same on all platforms and compilers.
+
+    This makes it suitable for random values both server and client need to know, e.g. bullet spread: the key is made from the shooter
+    and the weapon, the counter is the shot number, so the client can calculate the same spread as the server from the shot number alone.
+
+    Not suitable for cryptography.
+*/
+class CounterRandom
+{
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  CounterRandom is included")
+#endif
+
+public:
+
+    /** Makes a stream key from 2 arbitrary values, e.g. connection handle of a player and id of a weapon. */
+    static uint64_t makeKey(const uint64_t& a, const uint64_t& b)
+    {
+        return mix(mix(a) + b);
+    }
+
+    /** @return The n-th 32-bit random number of the stream identified by the given key. */
+    static uint32_t get(const uint64_t& nKey, const uint64_t& nCounter)
+    {
+        // the golden ratio constant spreads consecutive counters far apart before mixing
+        return static_cast<uint32_t>(mix(nKey ^ mix(nCounter * 0x9E3779B97F4A7C15ull)) >> 32);
+    }
+
+    /** @return The n-th random number of the stream identified by the given key, in [0, 1) range. */
+    static float getUnit(const uint64_t& nKey, const uint64_t& nCounter)
+    {
+        // 24 bits fit exactly into the mantissa of float, so the conversion does not round
+        return static_cast<float>(get(nKey, nCounter) >> 8) * (1.f / 16777216.f);
+    }
+
+    /** @return The n-th random number of the stream identified by the given key, in [-1, 1) range. */
+    static float getSigned(const uint64_t& nKey, const uint64_t& nCounter)
+    {
+        return getUnit(nKey, nCounter) * 2.f - 1.f;
+    }
+
+    CounterRandom() = delete;
+    ~CounterRandom() = delete;
+    CounterRandom(const CounterRandom&) = delete;
+    CounterRandom& operator=(const CounterRandom&) = delete;
+    CounterRandom(CounterRandom&&) = delete;
+    CounterRandom& operator=(CounterRandom&&) = delete;
+
+private:
+
+    /** Finalizer of SplitMix64: every input bit affects every output bit. */
+    static uint64_t mix(uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ull;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBull;
+        x ^= x >> 31;
+        return x;
+    }
+
+}; // class CounterRandom
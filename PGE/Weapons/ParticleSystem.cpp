@@ -0,0 +1,510 @@
+/*
+    ###################################################################################
+    ParticleSystem.cpp
+    This file is part of PGE.
+    PR00F's Game Engine pooled particle system
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include "PureBaseIncludes.h"  // PCH
+#include "ParticleSystem.h"
+#include "CounterRandom.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+
+// SSE is available on all x64 targets, and on x86 targets built with /arch:SSE or above
+#if defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1)) || defined(__SSE__)
+#define PGE_PARTICLESYSTEM_SSE
+#include <xmmintrin.h>
+#endif
+
+
+// ############################### PUBLIC ################################
+
+
+const char* ParticleSystem::getLoggerModuleName()
+{
+    return "ParticleSystem";
+}
+
+/**
+    All particle storage is allocated here, the system never holds more particles than the given capacity.
+
+    @param nCapacity Maximum number of particles alive at the same time, must be positive.
+*/
+ParticleSystem::ParticleSystem(const std::size_t& nCapacity) noexcept(false) :
+    m_nCapacity(nCapacity),
+    m_nCount(0),
+    m_nDropped(0),
+    m_nEmittersAdded(0)
+{
+    if (nCapacity == 0)
+    {
+        getConsole().EOLnOO("capacity must be positive!");
+        throw std::runtime_error("ParticleSystem capacity must be positive!");
+    }
+
+    // the integrate loop processes 4 particles at once, padding avoids a separate loop for the remaining particles
+    const std::size_t nPaddedCapacity = (nCapacity + 3) & ~static_cast<std::size_t>(3);
+
+    m_vPosX.assign(nPaddedCapacity, 0.f);
+    m_vPosY.assign(nPaddedCapacity, 0.f);
+    m_vPosZ.assign(nPaddedCapacity, 0.f);
+    m_vVelX.assign(nPaddedCapacity, 0.f);
+    m_vVelY.assign(nPaddedCapacity, 0.f);
+    m_vVelZ.assign(nPaddedCapacity, 0.f);
+    m_vGravity.assign(nPaddedCapacity, 0.f);
+    m_vAge.assign(nPaddedCapacity, 0.f);
+    m_vInvLifetime.assign(nPaddedCapacity, 0.f);
+    m_vAlphaBorn.assign(nPaddedCapacity, 0.f);
+    m_vAlpha.assign(nPaddedCapacity, 0.f);
+    m_vEmitter.assign(nCapacity, 0);
+}
+
+/**
+    Returns access to console preset with logger module name as this class.
+*/
+CConsole& ParticleSystem::getConsole() const
+{
+    return CConsole::getConsoleInstance(getLoggerModuleName());
+}
+
+std::size_t ParticleSystem::getCapacity() const
+{
+    return m_nCapacity;
+}
+
+std::size_t ParticleSystem::getParticleCount() const
+{
+    return m_nCount;
+}
+
+std::size_t ParticleSystem::getDroppedCount() const
+{
+    return m_nDropped;
+}
+
+void ParticleSystem::clear()
+{
+    m_nCount = 0;
+    m_nDropped = 0;
+    for (auto& emitter : m_vEmitters)
+    {
+        emitter.m_nAlive = 0;
+        emitter.m_nSpawnedSinceUpdate = 0;
+    }
+    m_vVertices.clear();
+    m_vBatches.clear();
+}
+
+/**
+    Slot of a removed emitter is reused, so the id of a removed emitter must not be used anymore.
+
+    @return Id of the new emitter, to be passed to emit() and emitBulletTrails().
+*/
+ParticleSystem::EmitterId ParticleSystem::addEmitter(const EmitterDesc& desc) noexcept(false)
+{
+    if (desc.m_fLifetime <= 0.f)
+    {
+        getConsole().EOLnOO("emitter lifetime must be positive!");
+        throw std::runtime_error("ParticleSystem emitter lifetime must be positive!");
+    }
+
+    if (desc.m_nEmitPerNthPhysicsIteration <= 0)
+    {
+        getConsole().EOLnOO("emitter m_nEmitPerNthPhysicsIteration must be positive!");
+        throw std::runtime_error("ParticleSystem emitter m_nEmitPerNthPhysicsIteration must be positive!");
+    }
+
+    auto it = std::find_if(m_vEmitters.begin(), m_vEmitters.end(), [](const Emitter& emitter) { return !emitter.m_bUsed; });
+    if (it == m_vEmitters.end())
+    {
+        it = m_vEmitters.insert(m_vEmitters.end(), Emitter{});
+    }
+
+    const EmitterId id = static_cast<EmitterId>(it - m_vEmitters.begin());
+    it->m_desc = desc;
+    it->m_bUsed = true;
+    it->m_nAlive = 0;
+    it->m_nSpawnedSinceUpdate = 0;
+    it->m_nKey = CounterRandom::makeKey(id, m_nEmittersAdded++);
+    it->m_nSpawnCounter = 0;
+    it->m_nVertexCursor = 0;
+    return id;
+}
+
+/**
+    Removes the emitter together with all its particles.
+*/
+void ParticleSystem::removeEmitter(const EmitterId& id)
+{
+    if (!isValidEmitter(id))
+    {
+        getConsole().EOLn("ParticleSystem::removeEmitter(): invalid emitter id: %u!", id);
+        return;
+    }
+
+    std::size_t i = 0;
+    while (i < m_nCount)
+    {
+        if (m_vEmitter[i] == id)
+        {
+            removeParticle(i);
+        }
+        else
+        {
+            i++;
+        }
+    }
+    m_vEmitters[id].m_bUsed = false;
+}
+
+/**
+    @return Number of emitters added and not removed.
+*/
+std::size_t ParticleSystem::getEmitterCount() const
+{
+    return static_cast<std::size_t>(
+        std::count_if(m_vEmitters.begin(), m_vEmitters.end(), [](const Emitter& emitter) { return emitter.m_bUsed; }));
+}
+
+const ParticleSystem::EmitterDesc& ParticleSystem::getEmitterDesc(const EmitterId& id) const
+{
+    return m_vEmitters.at(id).m_desc;
+}
+
+/**
+    @return Number of alive particles of the given emitter, 0 for invalid emitter.
+*/
+std::size_t ParticleSystem::getParticleCount(const EmitterId& id) const
+{
+    return isValidEmitter(id) ? m_vEmitters[id].m_nAlive : 0;
+}
+
+/**
+    Spawns particles by the given emitter at the given position, e.g. an impact burst where a bullet hit something.
+    Spawns over the budgets of the emitter or over the capacity of the system are dropped.
+
+    @return Number of particles actually spawned.
+*/
+std::size_t ParticleSystem::emit(const EmitterId& id, const PureVector& pos, const std::size_t& nCount)
+{
+    if (!isValidEmitter(id))
+    {
+        getConsole().EOLn("ParticleSystem::emit(): invalid emitter id: %u!", id);
+        return 0;
+    }
+
+    Emitter& emitter = m_vEmitters[id];
+    std::size_t nSpawned = 0;
+    while ((nSpawned < nCount) &&
+        (m_nCount < m_nCapacity) &&
+        (emitter.m_nAlive < emitter.m_desc.m_nMaxAlive) &&
+        (emitter.m_nSpawnedSinceUpdate < emitter.m_desc.m_nMaxSpawnPerUpdate))
+    {
+        spawn(emitter, id, pos);
+        nSpawned++;
+    }
+    m_nDropped += nCount - nSpawned;
+
+    return nSpawned;
+}
+
+/**
+    Spawns trail particles by the given emitter at the position of each used bullet of the pool with Bullet::ParticleType::Smoke.
+    A bullet emits 1 particle per m_nEmitPerNthPhysicsIteration calls, up to m_nMaxParticlesPerBullet in total, counted by the
+    particle counters of the bullet.
+    Expected to be invoked once per physics iteration, after the bullets are moved.
+
+    @return Number of particles actually spawned.
+*/
+std::size_t ParticleSystem::emitBulletTrails(PgeObjectPool<PooledBullet>& bullets, const EmitterId& id)
+{
+    if (!isValidEmitter(id))
+    {
+        getConsole().EOLn("ParticleSystem::emitBulletTrails(): invalid emitter id: %u!", id);
+        return 0;
+    }
+
+    const EmitterDesc& desc = m_vEmitters[id].m_desc;
+    std::size_t nSpawned = 0;
+    for (auto& bullet : bullets)
+    {
+        if (!bullet.used() || (bullet.getParticleType() != Bullet::ParticleType::Smoke))
+        {
+            continue;
+        }
+
+        if ((desc.m_nMaxParticlesPerBullet > 0) && (bullet.getParticlesEmittedTotal() >= desc.m_nMaxParticlesPerBullet))
+        {
+            continue;
+        }
+
+        if (++bullet.getParticleEmitPerNthPhysicsIterationCntr() < desc.m_nEmitPerNthPhysicsIteration)
+        {
+            continue;
+        }
+        bullet.getParticleEmitPerNthPhysicsIterationCntr() = 0;
+
+        if (emit(id, bullet.getPut().getPosVec(), 1) == 1)
+        {
+            bullet.getParticlesEmittedTotal()++;
+            nSpawned++;
+        }
+    }
+
+    return nSpawned;
+}
+
+/**
+    Moves all particles by their velocity, applies gravity, fades them by their age, then removes the expired ones.
+    Spawn budgets of the emitters are reset, so emitters can spawn again until the next Update().
+
+    @param nFactor Same as for Bullet::Update(): the particles move and age 1/nFactor physics iteration. Nothing happens if 0.
+*/
+void ParticleSystem::Update(const unsigned int& nFactor)
+{
+    if (nFactor == 0)
+    {
+        return;
+    }
+
+    integrate(1.f / nFactor);
+
+    std::size_t i = 0;
+    while (i < m_nCount)
+    {
+        if (m_vAge[i] >= m_vEmitters[m_vEmitter[i]].m_desc.m_fLifetime)
+        {
+            removeParticle(i);
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    for (auto& emitter : m_vEmitters)
+    {
+        emitter.m_nSpawnedSinceUpdate = 0;
+    }
+}
+
+/**
+    Builds the vertex stream of all particles as camera-facing quads, see getVertices() and getBatches().
+    Particles with the same texture are put into a contiguous range of the stream, so each texture needs only 1 draw call.
+
+    @param vecRight Unit vector pointing to the right of the camera in world space.
+    @param vecUp    Unit vector pointing upwards from the camera in world space.
+*/
+void ParticleSystem::buildVertices(const PureVector& vecRight, const PureVector& vecUp)
+{
+    // emitters are sorted by texture, then each emitter gets its own range in the stream, ranges of the same texture are adjacent
+    m_vSortedEmitters.clear();
+    for (EmitterId id = 0; id < static_cast<EmitterId>(m_vEmitters.size()); id++)
+    {
+        if (m_vEmitters[id].m_bUsed && (m_vEmitters[id].m_nAlive > 0))
+        {
+            m_vSortedEmitters.push_back(id);
+        }
+    }
+    std::sort(m_vSortedEmitters.begin(), m_vSortedEmitters.end(),
+        [this](const EmitterId& a, const EmitterId& b) { return std::less<const PureTexture*>()(m_vEmitters[a].m_desc.m_pTexture, m_vEmitters[b].m_desc.m_pTexture); });
+
+    m_vBatches.clear();
+    std::size_t nVertexCursor = 0;
+    for (const EmitterId& id : m_vSortedEmitters)
+    {
+        Emitter& emitter = m_vEmitters[id];
+        const std::size_t nVertexCount = emitter.m_nAlive * nVerticesPerParticle;
+        if (m_vBatches.empty() || (m_vBatches.back().m_pTexture != emitter.m_desc.m_pTexture))
+        {
+            m_vBatches.push_back(Batch{ emitter.m_desc.m_pTexture, nVertexCursor, 0 });
+        }
+        m_vBatches.back().m_nVertexCount += nVertexCount;
+        emitter.m_nVertexCursor = nVertexCursor;
+        nVertexCursor += nVertexCount;
+    }
+
+    // corners of a quad as multipliers of vecRight and vecUp, also as uv by adding 0.5
+    static constexpr float corners[nVerticesPerParticle][2] = {
+        { -0.5f, -0.5f }, { 0.5f, -0.5f }, { 0.5f, 0.5f },
+        { -0.5f, -0.5f }, { 0.5f, 0.5f }, { -0.5f, 0.5f }
+    };
+
+    m_vVertices.resize(nVertexCursor);
+    for (std::size_t i = 0; i < m_nCount; i++)
+    {
+        Emitter& emitter = m_vEmitters[m_vEmitter[i]];
+        const float fSize = emitter.m_desc.m_fSize;
+        Vertex* const pVertices = &m_vVertices[emitter.m_nVertexCursor];
+        emitter.m_nVertexCursor += nVerticesPerParticle;
+
+        for (std::size_t iCorner = 0; iCorner < nVerticesPerParticle; iCorner++)
+        {
+            const float fRight = corners[iCorner][0] * fSize;
+            const float fUp = corners[iCorner][1] * fSize;
+            Vertex& vertex = pVertices[iCorner];
+            vertex.m_pos[0] = m_vPosX[i] + vecRight.getX() * fRight + vecUp.getX() * fUp;
+            vertex.m_pos[1] = m_vPosY[i] + vecRight.getY() * fRight + vecUp.getY() * fUp;
+            vertex.m_pos[2] = m_vPosZ[i] + vecRight.getZ() * fRight + vecUp.getZ() * fUp;
+            vertex.m_uv[0] = corners[iCorner][0] + 0.5f;
+            vertex.m_uv[1] = corners[iCorner][1] + 0.5f;
+            vertex.m_color[0] = emitter.m_desc.m_color[0];
+            vertex.m_color[1] = emitter.m_desc.m_color[1];
+            vertex.m_color[2] = emitter.m_desc.m_color[2];
+            vertex.m_color[3] = m_vAlpha[i];
+        }
+    }
+}
+
+/**
+    @return Vertex stream built by the last buildVertices(), to be drawn as triangle list.
+*/
+const std::vector<ParticleSystem::Vertex>& ParticleSystem::getVertices() const
+{
+    return m_vVertices;
+}
+
+/**
+    @return Ranges of the vertex stream built by the last buildVertices(), 1 per texture.
+*/
+const std::vector<ParticleSystem::Batch>& ParticleSystem::getBatches() const
+{
+    return m_vBatches;
+}
+
+
+// ############################## PROTECTED ##############################
+
+
+// ############################### PRIVATE ###############################
+
+
+bool ParticleSystem::isValidEmitter(const EmitterId& id) const
+{
+    return (id < m_vEmitters.size()) && m_vEmitters[id].m_bUsed;
+}
+
+/**
+    Caller is expected to check the budgets and the capacity.
+    Velocity direction is random but still uniquely defined by the emitter and the number of particles spawned by it so far.
+*/
+void ParticleSystem::spawn(Emitter& emitter, const EmitterId& id, const PureVector& pos)
+{
+    const uint64_t nCounter = emitter.m_nSpawnCounter * 3;
+    emitter.m_nSpawnCounter++;
+
+    PureVector vecDir(
+        CounterRandom::getSigned(emitter.m_nKey, nCounter),
+        CounterRandom::getSigned(emitter.m_nKey, nCounter + 1),
+        CounterRandom::getSigned(emitter.m_nKey, nCounter + 2));
+    if (vecDir.getLength() > 0.f)
+    {
+        vecDir.Normalize();
+    }
+    else
+    {
+        vecDir.Set(0.f, 1.f, 0.f);
+    }
+
+    const std::size_t i = m_nCount++;
+    m_vPosX[i] = pos.getX();
+    m_vPosY[i] = pos.getY();
+    m_vPosZ[i] = pos.getZ();
+    m_vVelX[i] = vecDir.getX() * emitter.m_desc.m_fSpeed;
+    m_vVelY[i] = vecDir.getY() * emitter.m_desc.m_fSpeed;
+    m_vVelZ[i] = vecDir.getZ() * emitter.m_desc.m_fSpeed;
+    m_vGravity[i] = emitter.m_desc.m_fGravity;
+    m_vAge[i] = 0.f;
+    m_vInvLifetime[i] = 1.f / emitter.m_desc.m_fLifetime;
+    m_vAlphaBorn[i] = emitter.m_desc.m_color[3];
+    m_vAlpha[i] = emitter.m_desc.m_color[3];
+    m_vEmitter[i] = id;
+
+    emitter.m_nAlive++;
+    emitter.m_nSpawnedSinceUpdate++;
+}
+
+/**
+    Semi-implicit Euler step, same as in BulletSimulation, then alpha is faded linearly by age.
+    Padding particles after m_nCount are integrated too, it is cheaper than handling the remainder separately.
+*/
+void ParticleSystem::integrate(const float& fInvFactor)
+{
+    float* const px = m_vPosX.data();
+    float* const py = m_vPosY.data();
+    float* const pz = m_vPosZ.data();
+    const float* const vx = m_vVelX.data();
+    float* const vy = m_vVelY.data();
+    const float* const vz = m_vVelZ.data();
+    const float* const gravity = m_vGravity.data();
+    float* const age = m_vAge.data();
+    const float* const invLifetime = m_vInvLifetime.data();
+    const float* const alphaBorn = m_vAlphaBorn.data();
+    float* const alpha = m_vAlpha.data();
+
+    const std::size_t nParticles = (m_nCount + 3) & ~static_cast<std::size_t>(3);
+
+#ifdef PGE_PARTICLESYSTEM_SSE
+    const __m128 invFactor = _mm_set1_ps(fInvFactor);
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 zero = _mm_setzero_ps();
+    for (std::size_t i = 0; i < nParticles; i += 4)
+    {
+        const __m128 newVy = _mm_sub_ps(_mm_loadu_ps(vy + i), _mm_mul_ps(_mm_loadu_ps(gravity + i), invFactor));
+        _mm_storeu_ps(vy + i, newVy);
+
+        _mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(_mm_loadu_ps(vx + i), invFactor)));
+        _mm_storeu_ps(py + i, _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(newVy, invFactor)));
+        _mm_storeu_ps(pz + i, _mm_add_ps(_mm_loadu_ps(pz + i), _mm_mul_ps(_mm_loadu_ps(vz + i), invFactor)));
+
+        // alpha = alphaBorn * max(0, 1 - age/lifetime)
+        const __m128 newAge = _mm_add_ps(_mm_loadu_ps(age + i), invFactor);
+        _mm_storeu_ps(age + i, newAge);
+        const __m128 fade = _mm_max_ps(zero, _mm_sub_ps(one, _mm_mul_ps(newAge, _mm_loadu_ps(invLifetime + i))));
+        _mm_storeu_ps(alpha + i, _mm_mul_ps(_mm_loadu_ps(alphaBorn + i), fade));
+    }
+#else
+    for (std::size_t i = 0; i < nParticles; i++)
+    {
+        vy[i] -= gravity[i] * fInvFactor;
+
+        px[i] += vx[i] * fInvFactor;
+        py[i] += vy[i] * fInvFactor;
+        pz[i] += vz[i] * fInvFactor;
+
+        age[i] += fInvFactor;
+        alpha[i] = alphaBorn[i] * std::max(0.f, 1.f - age[i] * invLifetime[i]);
+    }
+#endif
+}
+
+/**
+    The last particle is moved into the place of the removed one, so particles stay packed.
+*/
+void ParticleSystem::removeParticle(const std::size_t& i)
+{
+    m_vEmitters[m_vEmitter[i]].m_nAlive--;
+
+    const std::size_t iLast = --m_nCount;
+    if (i != iLast)
+    {
+        m_vPosX[i] = m_vPosX[iLast];
+        m_vPosY[i] = m_vPosY[iLast];
+        m_vPosZ[i] = m_vPosZ[iLast];
+        m_vVelX[i] = m_vVelX[iLast];
+        m_vVelY[i] = m_vVelY[iLast];
+        m_vVelZ[i] = m_vVelZ[iLast];
+        m_vGravity[i] = m_vGravity[iLast];
+        m_vAge[i] = m_vAge[iLast];
+        m_vInvLifetime[i] = m_vInvLifetime[iLast];
+        m_vAlphaBorn[i] = m_vAlphaBorn[iLast];
+        m_vAlpha[i] = m_vAlpha[iLast];
+        m_vEmitter[i] = m_vEmitter[iLast];
+    }
+}
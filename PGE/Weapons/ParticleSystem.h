@@ -0,0 +1,159 @@
+#pragma once
+
+/*
+    ###################################################################################
+    ParticleSystem.h
+    This file is part of PGE.
+    External header.
+    PR00F's Game Engine pooled particle system
+    Made by PR00F88
+    ###################################################################################
+*/
+
+#include <cstdint>
+#include <vector>
+
+#include "../PGEallHeaders.h"
+#include "WeaponManager.h"
+
+class PureTexture;
+
+/**
+    Pooled particle system for bullet trails and impacts.
+    Particles are not PureObject3D instances: they are stored in preallocated structure-of-arrays form, so a single Update()
+    moves and fades all particles with SIMD, and buildVertices() produces a single vertex stream in which particles of the same
+    texture are contiguous, so the renderer can draw each texture by a single draw call.
+
+    Particles are spawned by emitters, each emitter has its own texture, appearance and budgets:
+     - at most m_nMaxAlive particles of an emitter are alive at the same time;
+     - at most m_nMaxSpawnPerUpdate particles of an emitter are spawned between 2 Update() calls.
+    Spawns over budget or over the capacity of the system are dropped, so a heavy firefight cannot slow down the frame.
+
+    Particles can be spawned by emit() (e.g. impact bursts at the position of a BulletCollision::Hit), and by emitBulletTrails()
+    for bullets with Bullet::ParticleType::Smoke.
+    Velocity directions are taken from CounterRandom keyed by the emitter, so the same sequence of calls gives the same particles.
+
+    Capacity is fixed by the ctor, nothing is allocated by Update() and emit(), and buildVertices() allocates only when the number of
+    particles is higher than before.
+*/
+class ParticleSystem
+{
+#ifdef PGE_CLASS_IS_INCLUDED_NOTIFICATION
+#pragma message("  ParticleSystem is included")
+#endif
+
+public:
+
+    typedef uint32_t EmitterId;
+
+    struct EmitterDesc
+    {
+        const PureTexture* m_pTexture;         /**< Particles of emitters with the same texture are rendered together, can be null e.g. in headless mode. */
+        uint32_t m_nMaxAlive;                  /**< Budget: maximum number of particles of the emitter alive at the same time. */
+        uint32_t m_nMaxSpawnPerUpdate;         /**< Budget: maximum number of particles spawned by the emitter between 2 Update() calls. */
+        int m_nEmitPerNthPhysicsIteration;     /**< Bullet trails: a bullet emits 1 particle per this many emitBulletTrails() calls. */
+        int m_nMaxParticlesPerBullet;          /**< Bullet trails: maximum number of particles emitted by a bullet in total, 0 means unlimited. */
+        TPureFloat m_fLifetime;                /**< Lifetime of particles in physics iterations. */
+        TPureFloat m_fSize;                    /**< Width and height of the quad of particles. */
+        TPureFloat m_fSpeed;                   /**< Initial speed of particles in random direction, per physics iteration. */
+        TPureFloat m_fGravity;                 /**< Decrease of the Y component of the velocity of particles per physics iteration. */
+        TPureFloat m_color[4];                 /**< RGBA color of particles when born, alpha fades linearly to 0 by the end of lifetime. */
+    };
+
+    struct Vertex
+    {
+        TPureFloat m_pos[3];
+        TPureFloat m_uv[2];
+        TPureFloat m_color[4];
+    };
+
+    /** Range of the vertex stream to be rendered with the same texture, as triangle list. */
+    struct Batch
+    {
+        const PureTexture* m_pTexture;
+        std::size_t m_nFirstVertex;
+        std::size_t m_nVertexCount;
+    };
+
+    static constexpr std::size_t nVerticesPerParticle = 6;   /**< 2 triangles per particle, so the stream can be drawn without index buffer. */
+
+    static const char* getLoggerModuleName();          /**< Returns the logger module name of this class. */
+
+    // ---------------------------------------------------------------------------
+
+    explicit ParticleSystem(const std::size_t& nCapacity) noexcept(false);
+    ~ParticleSystem() = default;
+
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+    ParticleSystem(ParticleSystem&&) = delete;
+    ParticleSystem& operator=(ParticleSystem&&) = delete;
+
+    CConsole& getConsole() const;                      /**< Returns access to console preset with logger module name as this class. */
+
+    std::size_t getCapacity() const;
+    std::size_t getParticleCount() const;
+    std::size_t getDroppedCount() const;               /**< Number of spawns dropped due to budgets or capacity since ctor or clear(). */
+    void clear();                                      /**< Removes all particles, emitters are kept. */
+
+    EmitterId addEmitter(const EmitterDesc& desc) noexcept(false);
+    void removeEmitter(const EmitterId& id);
+    std::size_t getEmitterCount() const;
+    const EmitterDesc& getEmitterDesc(const EmitterId& id) const;
+    std::size_t getParticleCount(const EmitterId& id) const;
+
+    std::size_t emit(const EmitterId& id, const PureVector& pos, const std::size_t& nCount);
+    std::size_t emitBulletTrails(PgeObjectPool<PooledBullet>& bullets, const EmitterId& id);
+
+    void Update(const unsigned int& nFactor);          /**< Moves, fades and ages all particles by 1 physics iteration, removes expired particles. */
+
+    void buildVertices(const PureVector& vecRight, const PureVector& vecUp);
+    const std::vector<Vertex>& getVertices() const;
+    const std::vector<Batch>& getBatches() const;
+
+private:
+
+    struct Emitter
+    {
+        EmitterDesc m_desc;
+        bool m_bUsed;
+        uint32_t m_nAlive;
+        uint32_t m_nSpawnedSinceUpdate;
+        uint64_t m_nKey;                               /**< CounterRandom key. */
+        uint64_t m_nSpawnCounter;                      /**< CounterRandom counter. */
+        std::size_t m_nVertexCursor;                   /**< Used by buildVertices(). */
+    };
+
+    const std::size_t m_nCapacity;
+    std::size_t m_nCount;                              /**< Particles are kept packed in [0, m_nCount). */
+    std::size_t m_nDropped;
+
+    // structure of arrays, each indexed by particle
+    std::vector<float> m_vPosX;
+    std::vector<float> m_vPosY;
+    std::vector<float> m_vPosZ;
+    std::vector<float> m_vVelX;
+    std::vector<float> m_vVelY;
+    std::vector<float> m_vVelZ;
+    std::vector<float> m_vGravity;
+    std::vector<float> m_vAge;
+    std::vector<float> m_vInvLifetime;
+    std::vector<float> m_vAlphaBorn;
+    std::vector<float> m_vAlpha;
+    std::vector<EmitterId> m_vEmitter;
+
+    std::vector<Emitter> m_vEmitters;
+    uint64_t m_nEmittersAdded;                         /**< Keys emitters reusing the slot of a removed emitter differently. */
+
+    std::vector<EmitterId> m_vSortedEmitters;          /**< Used by buildVertices(). */
+    std::vector<Vertex> m_vVertices;
+    std::vector<Batch> m_vBatches;
+
+    // ---------------------------------------------------------------------------
+
+    bool isValidEmitter(const EmitterId& id) const;
+    void spawn(Emitter& emitter, const EmitterId& id, const PureVector& pos);
+    void integrate(const float& fInvFactor);
+    void removeParticle(const std::size_t& i);
+
+}; // class ParticleSystem
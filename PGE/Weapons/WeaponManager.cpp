@@ -10,8 +10,11 @@
 
 #include "PureBaseIncludes.h"  // PCH
 #include "WeaponManager.h"
+#include "CounterRandom.h"
+#include "../Network/PgeBitStream.h"
 
 #include <cmath>
+#include <cstring>
 
 
 /*
@@ -285,6 +288,7 @@ void Bullet::init(
     // must not do performance-extensive stuff in this function because if Bullet is pooled (PooledBullet) then the pool's create() invokes this!
 
     m_bCreateSentToClients = false;  // maintained only by server instance, always false on client
+    m_bSimulationLoaded = false;     // BulletSimulation needs to load this bullet again even if it is reused in the same pool slot
 
     m_wpnId = wpnId;
     m_gfx = gfx;
@@ -304,11 +308,14 @@ void Bullet::init(
     m_eDamageAreaEffect = eDamageAreaEffect;
     m_fDamageAreaPulse = fDamageAreaPulse;
 
-    assert(m_obj);
-    m_obj->getPosVec().Set(wpn_px, wpn_py, wpn_pz);
-    m_obj->getAngleVec().Set(wpn_ax, wpn_ay, wpn_az);
-    m_obj->SetScaling(PureVector(sx, sy, 1.f));
-    m_obj->SetRenderingAllowed(visible);
+    // m_obj is null in headless mode, see build3dObject()
+    if (m_obj)
+    {
+        m_obj->getPosVec().Set(wpn_px, wpn_py, wpn_pz);
+        m_obj->getAngleVec().Set(wpn_ax, wpn_ay, wpn_az);
+        m_obj->SetScaling(PureVector(sx, sy, 1.f));
+        m_obj->SetRenderingAllowed(visible);
+    }
 
     m_put.getPosVec().Set(wpn_px, wpn_py, wpn_pz);
     m_put.SetRotation(wpn_ax, (wpn_ay > 0.0f) ? 90.f : -90.f, (wpn_ay > 0.0f) ? wpn_az : -wpn_az);
@@ -394,10 +401,13 @@ void Bullet::Update(const unsigned int& nFactor)
     */
     const float fMoveDistance = m_speed / nFactor;
     m_put.Move(fMoveDistance);
-    m_obj->getPosVec() = m_put.getPosVec();
+    if (m_obj)
+    {
+        m_obj->getPosVec() = m_put.getPosVec();
+    }
     m_fDistTravelled += fMoveDistance;
 
-    // TODO: particle can be emitted here
+    // particles are emitted by ParticleSystem::emitBulletTrails()
 }
 
 
@@ -411,8 +421,19 @@ const PureObject3D& Bullet::getObject3D() const
     return *m_obj;
 }
 
+bool Bullet::hasObject3D() const
+{
+    return m_obj != NULL;
+}
+
 void Bullet::build3dObject()
 {
+    if (!m_gfx.isInitialized())
+    {
+        // headless mode: nothing to be rendered, position is tracked by m_put anyway
+        return;
+    }
+
     if (m_pObjRef == nullptr)
     {
         // unit-sized plane, the real size is set in init() by scaling based on sx, sy
@@ -472,7 +493,10 @@ Weapon::Weapon(
     m_nMagBulletCount(0),
     m_nBulletsToReload(0),
     m_bAvailable(false),
-    m_bTriggerReleased(true)
+    m_bTriggerReleased(true),
+    m_bStatsDirty(true),
+    m_nShotCounter(0),
+    m_lastBulletSpawn{}
 {
     getConsole().OLnOI("Weapon::Weapon(%s) ...", fname);
 
@@ -782,32 +806,44 @@ Weapon::Weapon(
         throw std::runtime_error("damage_hp and damage_ap must be positive values in " + std::string(fname));
     }
 
+    updateStats();
     Reset();
 
-    // TODO: this is same as in copy ctor and operator=
-    m_obj = m_gfx.getObject3DManager().createPlane(1.f, 0.5f); // TODO: grab sizes from wpn file
-    if ( !m_obj )
+    // in headless mode neither graphics nor audio is initialized, there we need only the weapon logic
+    if (m_gfx.isInitialized())
     {
-        getConsole().EOLnOO("m_obj is null for %s! ", fname);
-        throw std::runtime_error("m_obj is null for " + std::string(fname));
-    }
+        // TODO: this is same as in copy ctor and operator=
+        m_obj = m_gfx.getObject3DManager().createPlane(1.f, 0.5f); // TODO: grab sizes from wpn file
+        if ( !m_obj )
+        {
+            getConsole().EOLnOO("m_obj is null for %s! ", fname);
+            throw std::runtime_error("m_obj is null for " + std::string(fname));
+        }
 
-    m_obj->SetDoubleSided(true);
-    m_obj->Hide();
+        m_obj->SetDoubleSided(true);
+        m_obj->Hide();
 
-    // TODO: hardcoded directory should be coming from somewhere instead!
-    PureTexture* const wpntex = m_gfx.getTextureManager().createFromFile(
-        (std::string("gamedata\\textures\\weapons\\") + PFL::changeExtension(this->getFilename().c_str(), "bmp")).c_str());
-    if (wpntex)
-    {
-        // set blending only when texture is available, otherwise object might not be visible at all
-        m_obj->getMaterial().setTexture(wpntex);
-        m_obj->getMaterial(false).setBlendFuncs(PURE_SRC_ALPHA, PURE_ONE);
+        // TODO: hardcoded directory should be coming from somewhere instead!
+        PureTexture* const wpntex = m_gfx.getTextureManager().createFromFile(
+            (std::string("gamedata\\textures\\weapons\\") + PFL::changeExtension(this->getFilename().c_str(), "bmp")).c_str());
+        if (wpntex)
+        {
+            // set blending only when texture is available, otherwise object might not be visible at all
+            m_obj->getMaterial().setTexture(wpntex);
+            m_obj->getMaterial(false).setBlendFuncs(PURE_SRC_ALPHA, PURE_ONE);
+        }
+        else
+        {
+            getConsole().EOLnOO("texture file was not found for %s! ", fname);
+            throw std::runtime_error("texture file was not found for " + std::string(fname));
+        }
     }
-    else
+
+    if (!m_audio.isInitialized())
     {
-        getConsole().EOLnOO("texture file was not found for %s! ", fname);
-        throw std::runtime_error("texture file was not found for " + std::string(fname));
+        // loadSound() would just log an error for each sound
+        getConsole().SOLnOO("Weapon loaded without sounds!");
+        return;
     }
 
     // finally we load sounds, failing to load is NOT fatal error, weapons will stay simply silent in such case, SoLoud handles that!
@@ -857,6 +893,115 @@ CConsole& Weapon::getConsole() const
     return CConsole::getConsoleInstance(getLoggerModuleName());
 }
 
+/**
+ * Returns the CVARs of this weapon.
+ * Since the caller might modify the returned CVARs, the typed stats are compiled again by the next getStats().
+ * A reference kept and modified after that getStats() call is not detected, updateStats() needs to be invoked in such case.
+ */
+std::map<std::string, PGEcfgVariable>& Weapon::getVars()
+{
+    m_bStatsDirty = true;
+    return PGEcfgFile::getVars();
+}
+
+const std::map<std::string, PGEcfgVariable>& Weapon::getVars() const
+{
+    return PGEcfgFile::getVars();
+}
+
+/**
+ * Sets the given CVAR of this weapon, and compiles the typed stats again right away.
+ * The value is not validated again as by the ctor.
+ * 
+ * @param sVarName Name of the CVAR, must be already present in getVars().
+ * @param value    New value of the CVAR.
+ * 
+ * @return True on success, false if there is no such CVAR.
+ */
+bool Weapon::setVar(const std::string& sVarName, const PGEcfgVariable& value)
+{
+    std::map<std::string, PGEcfgVariable>& vars = PGEcfgFile::getVars();
+    const auto it = vars.find(sVarName);
+    if (it == vars.end())
+    {
+        getConsole().EOLn("%s: no such CVAR: %s in %s!", __func__, sVarName.c_str(), getFilename().c_str());
+        return false;
+    }
+
+    it->second = value;
+    compileStats();
+    return true;
+}
+
+/**
+ * Returns the typed stats compiled from the CVARs of this weapon.
+ * Functions invoked frequently, e.g. pullTrigger() and update(), read these instead of getVars().
+ * If the CVARs might have been modified through getVars() since the last compile, they are compiled again first.
+ */
+const WeaponStats& Weapon::getStats() const
+{
+    if (m_bStatsDirty)
+    {
+        compileStats();
+    }
+    return m_stats;
+}
+
+/**
+ * Compiles the CVARs of this weapon into the typed stats returned by getStats().
+ * Needed only if a reference returned by getVars() is used to modify a CVAR after getStats() has been already invoked.
+ */
+void Weapon::updateStats()
+{
+    compileStats();
+}
+
+void Weapon::compileStats() const
+{
+    // the ctor already made sure all accepted CVARs are present, at() would throw only if someone removed any of them since then
+    const std::map<std::string, PGEcfgVariable>& vars = getVars();
+
+    m_stats.m_nFiringCooldownMillisecs = vars.at("firing_cooldown").getAsInt();
+    m_stats.m_nCapMax = static_cast<TPureUInt>(vars.at("cap_max").getAsInt());
+    m_stats.m_nReloadable = static_cast<TPureUInt>(vars.at("reloadable").getAsInt());
+    m_stats.m_nBulletsDefault = static_cast<TPureUInt>(vars.at("bullets_default").getAsInt());
+    m_stats.m_nReloadTimeMillisecs = vars.at("reload_time").getAsInt();
+    m_stats.m_bReloadPerMag = vars.at("reload_per_mag").getAsBool();
+    m_stats.m_bReloadWholeMag = vars.at("reload_whole_mag").getAsBool();
+
+    m_stats.m_fAccAngle = vars.at("acc_angle").getAsFloat();
+    m_stats.m_fAccMWalk = vars.at("acc_m_walk").getAsFloat();
+    m_stats.m_fAccMRun = vars.at("acc_m_run").getAsFloat();
+    m_stats.m_fAccMDuck = vars.at("acc_m_duck").getAsFloat();
+    m_stats.m_fRecoilM = vars.at("recoil_m").getAsFloat();
+    m_stats.m_fRecoilCooldownMillisecs = vars.at("recoil_cooldown").getAsFloat();
+
+    m_stats.m_bBulletVisible = vars.at("bullet_visible").getAsBool();
+    m_stats.m_bBulletFragile = vars.at("bullet_fragile").getAsBool();
+    m_stats.m_fBulletSizeX = vars.at("bullet_size_x").getAsFloat();
+    m_stats.m_fBulletSizeY = vars.at("bullet_size_y").getAsFloat();
+    m_stats.m_fBulletSizeZ = vars.at("bullet_size_z").getAsFloat();
+    m_stats.m_fBulletSpeed = vars.at("bullet_speed").getAsFloat();
+    m_stats.m_fBulletGravity = vars.at("bullet_gravity").getAsFloat();
+    m_stats.m_fBulletDrag = vars.at("bullet_drag").getAsFloat();
+    m_stats.m_fBulletDistanceMax = vars.at("bullet_distance_max").getAsFloat();
+    m_stats.m_eBulletParticle =
+        (vars.at("bullet_particle").getAsString() == "smoke") ?
+        Bullet::ParticleType::Smoke :
+        Bullet::ParticleType::None;
+
+    m_stats.m_nDamageAp = vars.at("damage_ap").getAsInt();
+    m_stats.m_nDamageHp = vars.at("damage_hp").getAsInt();
+    m_stats.m_fDamageAreaSize = vars.at("damage_area_size").getAsFloat();
+    m_stats.m_fDamageAreaPulse = vars.at("damage_area_pulse").getAsFloat();
+    m_stats.m_eDamageAreaEffect =
+        (vars.at("damage_area_effect").getAsString() == "linear") ?
+        Bullet::DamageAreaEffect::Linear :
+        Bullet::DamageAreaEffect::Constant;
+
+    m_bStatsDirty = false;
+}
+
 const WeaponId& Weapon::getUniqueId() const
 {
     return m_id;
@@ -887,6 +1032,116 @@ std::string Weapon::stateToString(const State& eState)
     }
 }
 
+/**
+ * Returns the relative Z angle of a bullet, i.e. the difference of the Z angles of the weapon and the bullet.
+ * The angle is not really random: it is derived from the shooter, the weapon and the shot number by CounterRandom,
+ * so server and client calculate the same angle for the same shot, without replicating the angle itself.
+ * 
+ * @param fAccuracy  Momentary accuracy of the weapon when firing, see getMomentaryAccuracy().
+ * @param connHandle Owner (shooter) of the weapon.
+ * @param wpnId      Unique id of the weapon.
+ * @param nShot      Shot number of the weapon, see getShotCounter().
+ * 
+ * @return Relative Z angle of the bullet in the [-fAccuracy, fAccuracy] range.
+ */
+float Weapon::getDeterministicRelativeBulletAngle(
+    const float& fAccuracy,
+    const pge_network::PgeNetworkConnectionHandle& connHandle,
+    const WeaponId& wpnId,
+    const uint32_t& nShot)
+{
+    return fAccuracy * CounterRandom::getSigned(CounterRandom::makeKey(connHandle, static_cast<uint64_t>(wpnId)), nShot);
+}
+
+/**
+ * Adds the given bullet spawn as app message to the given packet, e.g. the one returned by getLastBulletSpawn() after a successful pullTrigger().
+ * The packet must be initialized by PgePacket::initPktMsgApp() already.
+ * The spawn is written field by field by PgeBitWriter, floats are written with all their bits so the receiver simulates exactly the same bullet.
+ * The receiver is expected to read it by readMsgAppBulletSpawn() and pass it to spawnBullet() of the same weapon of the same player.
+ * 
+ * @return True on success, false if the packet is already full.
+ */
+bool Weapon::fillPktMsgAppBulletSpawn(
+    pge_network::PgePacket& pkt,
+    const pge_network::MsgApp::TMsgId& msgAppId,
+    const MsgBulletSpawn& spawn)
+{
+    static_assert(nMsgBulletSpawnMaxBytes <= pge_network::MsgApp::nMaxMessageLengthBytes);
+
+    pge_network::TByte buffer[nMsgBulletSpawnMaxBytes];
+    pge_network::PgeBitWriter writer(buffer, sizeof(buffer));
+    writer.writeVarUInt(spawn.m_connHandle);
+    writer.writeBits(static_cast<uint32_t>(spawn.m_nWpnId), 32);
+    writer.writeBits(static_cast<uint32_t>(spawn.m_nWpnId >> 32), 32);
+    writer.writeVarUInt(spawn.m_nShot);
+    for (const TPureFloat& f : spawn.m_pos)
+    {
+        writer.writeFloat(f);
+    }
+    for (const TPureFloat& f : spawn.m_angle)
+    {
+        writer.writeFloat(f);
+    }
+    writer.writeFloat(spawn.m_fAccuracy);
+    if (writer.isOverflowed())
+    {
+        // cannot happen unless the fields above are changed without updating nMsgBulletSpawnMaxBytes
+        CConsole::getConsoleInstance(getLoggerModuleName()).EOLn("%s: nMsgBulletSpawnMaxBytes is too small!", __func__);
+        return false;
+    }
+
+    pge_network::TByte* const pMsgAppData = pge_network::PgePacket::preparePktMsgAppFill(
+        pkt, msgAppId, static_cast<pge_network::MsgApp::TMsgSize>(writer.getSizeBytes()));
+    if (!pMsgAppData)
+    {
+        return false;
+    }
+    std::memcpy(pMsgAppData, buffer, writer.getSizeBytes());
+    return true;
+}
+
+/**
+ * Reads the bullet spawn added to a packet by fillPktMsgAppBulletSpawn(), from the data of the received app message.
+ * The values are not validated here, spawnBullet() validates them.
+ * 
+ * @param pMsgAppData     Data of the received app message.
+ * @param nMsgAppDataSize Size of the data of the received app message.
+ * @param spawn           The read bullet spawn, might be partially overwritten even if the function fails.
+ * 
+ * @return True on success, false if the data is too short or too long to be a bullet spawn.
+ */
+bool Weapon::readMsgAppBulletSpawn(
+    const pge_network::TByte* pMsgAppData,
+    const pge_network::MsgApp::TMsgSize& nMsgAppDataSize,
+    MsgBulletSpawn& spawn)
+{
+    pge_network::PgeBitReader reader(pMsgAppData, nMsgAppDataSize);
+    uint32_t nWpnIdLow = 0;
+    uint32_t nWpnIdHigh = 0;
+    reader.readVarUInt(spawn.m_connHandle);
+    reader.readBits(nWpnIdLow, 32);
+    reader.readBits(nWpnIdHigh, 32);
+    reader.readVarUInt(spawn.m_nShot);
+    for (TPureFloat& f : spawn.m_pos)
+    {
+        reader.readFloat(f);
+    }
+    for (TPureFloat& f : spawn.m_angle)
+    {
+        reader.readFloat(f);
+    }
+    reader.readFloat(spawn.m_fAccuracy);
+    spawn.m_nWpnId = (static_cast<uint64_t>(nWpnIdHigh) << 32) | nWpnIdLow;
+
+    // the writer pads the last byte only, anything more is not a bullet spawn
+    if (reader.isOverflowed() || (reader.getRemainingBits() >= 8))
+    {
+        CConsole::getConsoleInstance(getLoggerModuleName()).EOLn("%s: malformed bullet spawn of %u bytes!", __func__, nMsgAppDataSize);
+        return false;
+    }
+    return true;
+}
+
 /**
  * Returns the graphical object entity associated to this weapon object.
  */
@@ -903,13 +1158,53 @@ const PureObject3D& Weapon::getObject3D() const
     return *m_obj;
 }
 
+/**
+ * Returns the position of this weapon object.
+ * This is the position of the graphical object entity if there is any, so it is the same as getObject3D().getPosVec().
+ * In headless mode there is no graphical object entity, so the position is stored by this weapon object itself.
+ */
+PureVector& Weapon::getPosVec()
+{
+    return m_obj ? m_obj->getPosVec() : m_vecPos;
+}
+
+/**
+ * Returns the position of this weapon object.
+ * This is the position of the graphical object entity if there is any, so it is the same as getObject3D().getPosVec().
+ * In headless mode there is no graphical object entity, so the position is stored by this weapon object itself.
+ */
+const PureVector& Weapon::getPosVec() const
+{
+    return m_obj ? m_obj->getPosVec() : m_vecPos;
+}
+
+/**
+ * Returns the angles of this weapon object.
+ * These are the angles of the graphical object entity if there is any, so it is the same as getObject3D().getAngleVec().
+ * In headless mode there is no graphical object entity, so the angles are stored by this weapon object itself.
+ */
+PureVector& Weapon::getAngleVec()
+{
+    return m_obj ? m_obj->getAngleVec() : m_vecAngle;
+}
+
+/**
+ * Returns the angles of this weapon object.
+ * These are the angles of the graphical object entity if there is any, so it is the same as getObject3D().getAngleVec().
+ * In headless mode there is no graphical object entity, so the angles are stored by this weapon object itself.
+ */
+const PureVector& Weapon::getAngleVec() const
+{
+    return m_obj ? m_obj->getAngleVec() : m_vecAngle;
+}
+
 /**
  * Updates the graphical object entity associated to this weapon object.
  * Only the position is updated.
  */
 void Weapon::UpdatePosition(const PureVector& playerPos, bool bStickToCenter)
 {
-    getObject3D().getPosVec().Set(
+    getPosVec().Set(
         playerPos.getX(),
         bStickToCenter ? playerPos.getY() : playerPos.getY() + WpnYBiasToPlayerCenter,
         playerPos.getZ());
@@ -922,9 +1217,9 @@ void Weapon::UpdatePosition(const PureVector& playerPos, bool bStickToCenter)
  */
 void Weapon::UpdatePositions(const PureVector& playerPos, TPureFloat fAngleY, TPureFloat fAngleZ)
 {
-    getObject3D().getPosVec().Set(playerPos.getX(), playerPos.getY() + WpnYBiasToPlayerCenter, playerPos.getZ());
-    getObject3D().getAngleVec().SetY(fAngleY);
-    getObject3D().getAngleVec().SetZ(fAngleZ);
+    getPosVec().Set(playerPos.getX(), playerPos.getY() + WpnYBiasToPlayerCenter, playerPos.getZ());
+    getAngleVec().SetY(fAngleY);
+    getAngleVec().SetZ(fAngleZ);
 }
 
 /**
@@ -934,7 +1229,13 @@ void Weapon::UpdatePositions(const PureVector& playerPos, TPureFloat fAngleY, TP
  */
 void Weapon::UpdatePositions(const PureVector& playerPos, const PureVector& targetPos2D)
 {
-    getObject3D().getPosVec().Set( playerPos.getX(), playerPos.getY() + WpnYBiasToPlayerCenter, playerPos.getZ() );
+    getPosVec().Set( playerPos.getX(), playerPos.getY() + WpnYBiasToPlayerCenter, playerPos.getZ() );
+
+    if (!m_gfx.isInitialized())
+    {
+        // no camera to project with in headless mode, but that is fine since this is for our weapon on our side anyway
+        return;
+    }
 
     /*
          By default with AngleY 0 and AngleZ 0, weapon looks to <- direction.
@@ -972,9 +1273,9 @@ void Weapon::UpdatePositions(const PureVector& playerPos, const PureVector& targ
 
     PureVector vecWpnPosProjected2D;
     if (!m_gfx.getCamera().project3dTo2d(
-        getObject3D().getPosVec().getX(),
-        getObject3D().getPosVec().getY(),
-        getObject3D().getPosVec().getZ(),
+        getPosVec().getX(),
+        getPosVec().getY(),
+        getPosVec().getZ(),
         vecWpnPosProjected2D))
     {
         // Failure is expected when the weapon is out of frustum, so this is not a real error, ignore it silently
@@ -995,13 +1296,13 @@ void Weapon::UpdatePositions(const PureVector& playerPos, const PureVector& targ
     const float distYXratio = (vecNewTargetPos2D.getX() == 0.f) ? vecNewTargetPos2D.getY() : vecNewTargetPos2D.getY()/ vecNewTargetPos2D.getX();
     if (vecNewTargetPos2D.getX() < 0.f )
     {
-        getObject3D().getAngleVec().SetY( 0.f );
-        getObject3D().getAngleVec().SetZ( atan( distYXratio )*180.f / PFL::PI );
+        getAngleVec().SetY( 0.f );
+        getAngleVec().SetZ( atan( distYXratio )*180.f / PFL::PI );
     }
     else
     {
-        getObject3D().getAngleVec().SetY( 180.f );
-        getObject3D().getAngleVec().SetZ( -atan( distYXratio )*180.f / PFL::PI );
+        getAngleVec().SetY( 180.f );
+        getAngleVec().SetZ( -atan( distYXratio )*180.f / PFL::PI );
     }
 }
 
@@ -1037,7 +1338,7 @@ TPureUInt Weapon::getUnmagBulletCount() const
  */
 void Weapon::SetUnmagBulletCount(TPureUInt count)
 {
-    if (count <= static_cast<TPureUInt>(getVars()["cap_max"].getAsInt()))
+    if (count <= getStats().m_nCapMax)
     {
         m_nUnmagBulletCount = count;
     }
@@ -1068,14 +1369,15 @@ TPureUInt Weapon::getMagBulletCount() const
  */
 void Weapon::SetMagBulletCount(TPureUInt count)
 {
-    if (getVars()["reloadable"].getAsInt() > 0)
+    const WeaponStats& stats = getStats();
+    if (stats.m_nReloadable > 0)
     {
-        if (count <= static_cast<TPureUInt>(getVars()["reloadable"].getAsInt()))
+        if (count <= stats.m_nReloadable)
         {
             m_nMagBulletCount = count;
         }
     }
-    else if (count <= static_cast<TPureUInt>(getVars()["cap_max"].getAsInt()))
+    else if (count <= stats.m_nCapMax)
     {
         m_nMagBulletCount = count;
     }
@@ -1090,13 +1392,14 @@ void Weapon::SetMagBulletCount(TPureUInt count)
  */
 bool Weapon::canIncBulletCount() const
 {
-    if (getVars().at("reloadable").getAsInt() > 0)
+    const WeaponStats& stats = getStats();
+    if (stats.m_nReloadable > 0)
     {
-        return m_nUnmagBulletCount < static_cast<TPureUInt>(getVars().at("cap_max").getAsInt());
+        return m_nUnmagBulletCount < stats.m_nCapMax;
     }
     else
     {
-        return m_nMagBulletCount < static_cast<TPureUInt>(getVars().at("cap_max").getAsInt());
+        return m_nMagBulletCount < stats.m_nCapMax;
     }
 }
 
@@ -1108,14 +1411,15 @@ bool Weapon::canIncBulletCount() const
  */
 void Weapon::IncBulletCount(TPureUInt count)
 {
-    if (getVars()["reloadable"].getAsInt() > 0)
+    const WeaponStats& stats = getStats();
+    if (stats.m_nReloadable > 0)
     {
-        m_nUnmagBulletCount = std::min(static_cast<TPureUInt>(getVars()["cap_max"].getAsInt()), (m_nUnmagBulletCount + count));
+        m_nUnmagBulletCount = std::min(stats.m_nCapMax, (m_nUnmagBulletCount + count));
     }
     else
     {
         // not reloadable has always zero m_nUnmagBulletCount, e.g. rail gun
-        m_nMagBulletCount = std::min(static_cast<TPureUInt>(getVars()["cap_max"].getAsInt()), (m_nMagBulletCount + count));
+        m_nMagBulletCount = std::min(stats.m_nCapMax, (m_nMagBulletCount + count));
     }
 }
 
@@ -1160,10 +1464,11 @@ bool Weapon::update()
     PFL::timeval timeNow;
     PFL::gettimeofday(&timeNow, 0);
 
+    const WeaponStats& stats = getStats();
     if ( m_state == WPN_SHOOTING )
     {      
         const TPureFloat fMillisecsSinceLastShot = PFL::getTimeDiffInUs(timeNow, m_timeLastShot) / 1000.f;
-        if ( getVars()["firing_cooldown"].getAsInt() <= fMillisecsSinceLastShot )
+        if ( stats.m_nFiringCooldownMillisecs <= fMillisecsSinceLastShot )
         {
             m_state = WPN_READY;
         }
@@ -1171,12 +1476,12 @@ bool Weapon::update()
     }
 
     // WPN_RELOADING
-    if ( getVars()["reload_per_mag"].getAsBool() )
+    if ( stats.m_bReloadPerMag )
     {
         const TPureFloat fMillisecsSinceReloadStarted = PFL::getTimeDiffInUs(timeNow, m_timeReloadStarted) / 1000.f;
-        if ( getVars()["reload_time"].getAsInt() <= fMillisecsSinceReloadStarted )
+        if ( stats.m_nReloadTimeMillisecs <= fMillisecsSinceReloadStarted )
         {
-            if ( getVars()["reload_whole_mag"].getAsBool() )
+            if ( stats.m_bReloadWholeMag )
             {
                 m_nMagBulletCount = m_nBulletsToReload;
             }
@@ -1192,7 +1497,7 @@ bool Weapon::update()
     else
     {
         const TPureFloat fMillisecsSinceLastBulletReload = PFL::getTimeDiffInUs(timeNow, m_timeReloadStarted) / 1000.f;
-        if ( getVars()["reload_time"].getAsInt() <= fMillisecsSinceLastBulletReload )
+        if ( stats.m_nReloadTimeMillisecs <= fMillisecsSinceLastBulletReload )
         {
             m_nMagBulletCount++;
             m_nUnmagBulletCount--;
@@ -1251,7 +1556,8 @@ TPureBool Weapon::reload()
         return false;
     }
 
-    const TPureUInt nCapMagazine = getVars()["reloadable"].getAsInt();
+    const WeaponStats& stats = getStats();
+    const TPureUInt nCapMagazine = stats.m_nReloadable;
     if ( nCapMagazine == 0 )
     {
         // not reloadable
@@ -1271,7 +1577,7 @@ TPureBool Weapon::reload()
     }
 
     m_state = WPN_RELOADING;
-    if ( getVars()["reload_whole_mag"].getAsBool() )
+    if ( stats.m_bReloadWholeMag )
     {
         m_nBulletsToReload = std::min(nCapMagazine, m_nUnmagBulletCount);
     }
@@ -1303,8 +1609,9 @@ TPureBool Weapon::pullTrigger(bool bMoving, bool bRun, bool bDuck)
     const bool bPrevTriggerReleased = m_bTriggerReleased;
     m_bTriggerReleased = false;
     
+    const WeaponStats& stats = getStats();
     if ( (m_state != WPN_READY) && /* reloading can be stopped if it is per-bullet */
-         !( (m_state == WPN_RELOADING) && (!getVars()["reload_per_mag"].getAsBool()) ) )
+         !( (m_state == WPN_RELOADING) && (!stats.m_bReloadPerMag) ) )
     {
         return false;
     }
@@ -1327,45 +1634,116 @@ TPureBool Weapon::pullTrigger(bool bMoving, bool bRun, bool bDuck)
         m_nMagBulletCount--;
     }
 
-    const float fRelativeBulletAngleZ = getRandomRelativeBulletAngle(bMoving, bRun, bDuck);
-    //getConsole().EOLn("bMoving: %b, bRun: %b, bDuck: %b, fRelativeBulletAngleZ: %f! ", bMoving, bRun, bDuck, fRelativeBulletAngleZ);
+    MsgBulletSpawn spawn{};
+    spawn.m_connHandle = m_connHandle;
+    spawn.m_nWpnId = static_cast<uint64_t>(m_id);
+    spawn.m_nShot = m_nShotCounter;
+    spawn.m_pos[0] = getPosVec().getX();
+    spawn.m_pos[1] = getPosVec().getY();
+    spawn.m_pos[2] = getPosVec().getZ();
+    spawn.m_angle[0] = getAngleVec().getX();
+    spawn.m_angle[1] = getAngleVec().getY();
+    spawn.m_angle[2] = getAngleVec().getZ();
+    spawn.m_fAccuracy = getMomentaryAccuracy(bMoving, bRun, bDuck);
     
-    // here create() invokes PooledBullet::init(), should invoke the server version!
-    if (!m_bullets.create(
-        m_id,
-        m_gfx,
-        m_connHandle,
-        m_obj->getPosVec().getX(), m_obj->getPosVec().getY(), m_obj->getPosVec().getZ(),
-        m_obj->getAngleVec().getX(), m_obj->getAngleVec().getY(), m_obj->getAngleVec().getZ() + fRelativeBulletAngleZ,
-        getVars()["bullet_visible"].getAsBool(),
-        getVars()["bullet_size_x"].getAsFloat(),
-        getVars()["bullet_size_y"].getAsFloat(),
-        getVars()["bullet_size_z"].getAsFloat(),
-        getVars()["bullet_speed"].getAsFloat(),
-        getVars()["bullet_gravity"].getAsFloat(),
-        getVars()["bullet_drag"].getAsFloat(),
-        getVars()["bullet_fragile"].getAsBool(),
-        getVars()["bullet_distance_max"].getAsFloat(),
-        (getVars()["bullet_particle"].getAsString() == "smoke" ?
-            Bullet::ParticleType::Smoke :
-            Bullet::ParticleType::None),
-        getVars()["damage_ap"].getAsInt(),
-        getVars()["damage_hp"].getAsInt(),
-        getVars()["damage_area_size"].getAsFloat(),
-        (getVars()["damage_area_effect"].getAsString() == "linear" ?
-            Bullet::DamageAreaEffect::Linear :
-            Bullet::DamageAreaEffect::Constant),
-        getVars()["damage_area_pulse"].getAsFloat()))
-    {
-        getConsole().EOLn("Weapon::pullTrigger(): pool did not create bullet!");
+    if (!spawnBullet(spawn))
+    {
         return false;
     }
+    m_lastBulletSpawn = spawn;
 
     PFL::gettimeofday(&m_timeLastShot, 0);
 
     return true;
 }
 
+/**
+ * Creates a bullet in the pool as fired by this weapon, with the stats of this weapon and with the position, angles and spread given by the spawn.
+ * Server invokes this by pullTrigger(), client invokes this with the MsgBulletSpawn received from the server, so both sides create the
+ * same bullet and can simulate it on their own, the server does not need to replicate the bullet itself.
+ * Shot counter of this weapon follows the shot number of the spawn only if that is ahead of the counter by less than nMaxShotCounterStep,
+ * so a spawn cannot rewind the counter or make it jump arbitrarily, but the bullet is still created with the spread of its own shot number,
+ * e.g. when a client joins after the shooter has already fired many bullets.
+ * 
+ * @param spawn The bullet spawn, e.g. returned by getLastBulletSpawn() of the same weapon on server side.
+ * 
+ * @return The created bullet on success, nullptr if the spawn is for another weapon or owner, has invalid values or the pool is full.
+ */
+PooledBullet* Weapon::spawnBullet(const MsgBulletSpawn& spawn)
+{
+    if (spawn.m_nWpnId != static_cast<uint64_t>(m_id))
+    {
+        getConsole().EOLn("Weapon::spawnBullet(): bullet spawn is for another weapon!");
+        return nullptr;
+    }
+
+    // owner keys the spread, so a spawn of another owner would create a bullet with a spread that the owner never fired
+    if (spawn.m_connHandle != m_connHandle)
+    {
+        getConsole().EOLn("Weapon::spawnBullet(): bullet spawn is for another owner!");
+        return nullptr;
+    }
+
+    bool bFinite = std::isfinite(spawn.m_fAccuracy);
+    for (int i = 0; i < 3; i++)
+    {
+        bFinite &= std::isfinite(spawn.m_pos[i]) && std::isfinite(spawn.m_angle[i]);
+    }
+    if (!bFinite)
+    {
+        getConsole().EOLn("Weapon::spawnBullet(): bullet spawn has non-finite position, angle or accuracy!");
+        return nullptr;
+    }
+
+    // momentary accuracy of this weapon cannot be anything else
+    if ((spawn.m_fAccuracy < 0.f) || (spawn.m_fAccuracy > getLowestAccuracyPossible()))
+    {
+        getConsole().EOLn("Weapon::spawnBullet(): bullet spawn has out of range accuracy: %f!", spawn.m_fAccuracy);
+        return nullptr;
+    }
+
+    const WeaponStats& stats = getStats();
+    const float fRelativeBulletAngleZ = getDeterministicRelativeBulletAngle(spawn.m_fAccuracy, spawn.m_connHandle, m_id, spawn.m_nShot);
+    //getConsole().EOLn("fAccuracy: %f, fRelativeBulletAngleZ: %f! ", spawn.m_fAccuracy, fRelativeBulletAngleZ);
+    
+    // here create() invokes PooledBullet::init(), should invoke the server version!
+    PooledBullet* const pBullet = m_bullets.create(
+        m_id,
+        m_gfx,
+        spawn.m_connHandle,
+        spawn.m_pos[0], spawn.m_pos[1], spawn.m_pos[2],
+        spawn.m_angle[0], spawn.m_angle[1], spawn.m_angle[2] + fRelativeBulletAngleZ,
+        stats.m_bBulletVisible,
+        stats.m_fBulletSizeX,
+        stats.m_fBulletSizeY,
+        stats.m_fBulletSizeZ,
+        stats.m_fBulletSpeed,
+        stats.m_fBulletGravity,
+        stats.m_fBulletDrag,
+        stats.m_bBulletFragile,
+        stats.m_fBulletDistanceMax,
+        stats.m_eBulletParticle,
+        stats.m_nDamageAp,
+        stats.m_nDamageHp,
+        stats.m_fDamageAreaSize,
+        stats.m_eDamageAreaEffect,
+        stats.m_fDamageAreaPulse);
+    if (!pBullet)
+    {
+        getConsole().EOLn("Weapon::spawnBullet(): pool did not create bullet!");
+        return nullptr;
+    }
+
+    // unsigned difference, so shot numbers behind the counter give huge steps too, even after wraparound
+    const uint32_t nShotStep = spawn.m_nShot - m_nShotCounter;
+    if (nShotStep < nMaxShotCounterStep)
+    {
+        m_nShotCounter = spawn.m_nShot + 1;
+    }
+
+    return pBullet;
+}
+
 /**
  * Releases the trigger of the weapon.
  * It is important to invoke this function whenever the player's input imply it.
@@ -1400,7 +1778,7 @@ void Weapon::Reset()
     const auto itDefFiringModePos = std::find_if(
         m_vecOrderOfFiringModes.begin(),
         m_vecOrderOfFiringModes.end(),
-        [this](const FiringModeEnumToStringPair& fm) { return fm.second == getVars()["firing_mode_def"].getAsString(); }
+        [this](const FiringModeEnumToStringPair& fm) { return fm.second == PGEcfgFile::getVars()["firing_mode_def"].getAsString(); }
     );
 
     if (itDefFiringModePos == m_vecOrderOfFiringModes.end())
@@ -1417,7 +1795,7 @@ void Weapon::Reset()
     m_bAvailable = false;
     m_bTriggerReleased = true;
     // it doesnt matter if weapon is reloadable or not, the loaded bullet count is in nMagBulletCount
-    m_nMagBulletCount = getVars()["bullets_default"].getAsInt();
+    m_nMagBulletCount = getStats().m_nBulletsDefault;
     m_nUnmagBulletCount = 0;
     m_nBulletsToReload = 0;
 }
@@ -1457,7 +1835,7 @@ float Weapon::getDamagePerFireRating() const
       firing_mode_def -> greater is better
     */
     // later we can also add damage_area_size and bullet distance and firing_mode_def to this calculation
-    return (getVars().at("damage_hp").getAsInt() * getVars().at("damage_ap").getAsInt()) / 100.f;
+    return (getStats().m_nDamageHp * getStats().m_nDamageAp) / 100.f;
 }
 
 /**
@@ -1472,7 +1850,7 @@ float Weapon::getDamagePerFireRating() const
 */
 float Weapon::getFiringRate() const
 {
-    const int nCooldownMsecs = getVars().at("firing_cooldown").getAsInt();
+    const int nCooldownMsecs = getStats().m_nFiringCooldownMillisecs;
     assert(nCooldownMsecs > 0); // ctor throws if 0
     return 1000.f / nCooldownMsecs;
 }
@@ -1507,11 +1885,12 @@ float Weapon::getDamagePerSecondRating() const
 */
 float Weapon::getAccuracyByPose(bool bMoving, bool bRun, bool bDuck) const
 {
-    float fAccuracy = getVars().at("acc_angle").getAsFloat() * (bDuck ? getVars().at("acc_m_duck").getAsFloat() : 1.f);
+    const WeaponStats& stats = getStats();
+    float fAccuracy = stats.m_fAccAngle * (bDuck ? stats.m_fAccMDuck : 1.f);
 
     if (bMoving)
     {
-        fAccuracy *= bRun ? getVars().at("acc_m_run").getAsFloat() : getVars().at("acc_m_walk").getAsFloat();
+        fAccuracy *= bRun ? stats.m_fAccMRun : stats.m_fAccMWalk;
     }
 
     return fAccuracy;
@@ -1557,7 +1936,7 @@ float Weapon::getMomentaryRecoilMultiplier() const
         return 1.f;
     }
 
-    const float fRecoilCooldownMillisecs = getVars().at("recoil_cooldown").getAsFloat();
+    const float fRecoilCooldownMillisecs = getStats().m_fRecoilCooldownMillisecs;
 
     // ctor makes sure that recoil_cooldown is positive (bigger than firing_cooldown) if recoil_m is > 1.f, so
     // this assertion is implied from ctor behavior, thus we cannot divide by zero below!
@@ -1580,7 +1959,7 @@ float Weapon::getMomentaryRecoilMultiplier() const
 */
 float Weapon::getMaximumRecoilMultiplier() const
 {
-    return getVars().at("recoil_m").getAsFloat();
+    return getStats().m_fRecoilM;
 }
 
 /**
@@ -1616,9 +1995,11 @@ float Weapon::getLowestAccuracyPossible() const
 }
 
 /**
-* Returns a random relative Z angle for a newborn bullet.
+* Returns a random relative Z angle for the next newborn bullet.
 * This relative Z angle is the difference of the Z angles of the weapon and the newborn bullet.
 * The relative Z angle can be positive or negative but its absolute maximum value is the momentary accuracy (aim) (getMomentaryAccuracy()).
+* The angle is the same as what getDeterministicRelativeBulletAngle() returns for the current shot counter, so it changes only when
+* a bullet is fired.
 * 
 * Note: I use the term "weapon accuracy" interchangeably with "aim".
 * 
@@ -1630,11 +2011,26 @@ float Weapon::getLowestAccuracyPossible() const
 */
 float Weapon::getRandomRelativeBulletAngle(bool bMoving, bool bRun, bool bDuck) const
 {
-    const float fMomentaryAccuracy = getMomentaryAccuracy(bMoving, bRun, bDuck);
+    return getDeterministicRelativeBulletAngle(getMomentaryAccuracy(bMoving, bRun, bDuck), m_connHandle, m_id, m_nShotCounter);
+}
+
+/**
+* Returns the shot number of the next bullet fired by this weapon.
+* Starts from 0, incremented by each bullet created by pullTrigger() or spawnBullet(). Not reset by Reset(), so the spread of bullets
+* does not repeat itself after respawn.
+*/
+uint32_t Weapon::getShotCounter() const
+{
+    return m_nShotCounter;
+}
 
-    return PFL::random(
-        static_cast<int>(std::lroundf(-fMomentaryAccuracy * 100)),
-        static_cast<int>(std::lroundf(fMomentaryAccuracy * 100))) / 100.f;
+/**
+* Returns the spawn of the last bullet fired by pullTrigger(), to be replicated to clients e.g. by fillPktMsgAppBulletSpawn().
+* All zero before the first shot.
+*/
+const MsgBulletSpawn& Weapon::getLastBulletSpawn() const
+{
+    return m_lastBulletSpawn;
 }
 
 SoLoud::Wav& Weapon::getFiringSound()
@@ -1695,7 +2091,10 @@ Weapon::Weapon() :
     m_state(WPN_READY),
     m_nUnmagBulletCount(0),
     m_nMagBulletCount(0),
-    m_nBulletsToReload(0)
+    m_nBulletsToReload(0),
+    m_bStatsDirty(true),
+    m_nShotCounter(0),
+    m_lastBulletSpawn{}
 {}
 
 void Weapon::UpdateGraphics()
@@ -1793,7 +2192,10 @@ Weapon* WeaponManager::load(const char* fname, pge_network::PgeNetworkConnection
         }
 
         m_weapons.push_back(wpn);
-        wpn->getObject3D().SetName(wpn->getObject3D().getName() + " (WeaponManager-loaded " + fname + ")");
+        if (m_gfx.isInitialized())
+        {
+            wpn->getObject3D().SetName(wpn->getObject3D().getName() + " (WeaponManager-loaded " + fname + ")");
+        }
         return wpn;
     }
     catch (const std::exception& e)
@@ -1926,15 +2328,21 @@ bool WeaponManager::setCurrentWeapon(Weapon* wpn, bool bRecordSwitchTime, bool b
         }
 
         // we already have a current different weapon, so this will be a weapon switch
-        m_pCurrentWpn->getObject3D().Hide();
-        wpn->getObject3D().getAngleVec() = m_pCurrentWpn->getObject3D().getAngleVec();
+        if (m_gfx.isInitialized())
+        {
+            m_pCurrentWpn->getObject3D().Hide();
+        }
+        wpn->getAngleVec() = m_pCurrentWpn->getAngleVec();
 
         if (bRecordSwitchTime)
         {
             m_timeLastWeaponSwitch = std::chrono::steady_clock::now();
         }
     }
-    wpn->getObject3D().Show();
+    if (m_gfx.isInitialized())
+    {
+        wpn->getObject3D().Show();
+    }
     m_pCurrentWpn = wpn;
 
     return true;
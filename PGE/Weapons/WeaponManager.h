@@ -226,8 +226,10 @@ public:
 
     void Update(const unsigned int& nFactor);
 
+    /** Must not be used when graphics is not initialized e.g. in headless mode (see PGE::isHeadless()), use getPut() instead. */
     PureObject3D& getObject3D();
     const PureObject3D& getObject3D() const;
+    bool hasObject3D() const;                              /**< False when graphics is not initialized e.g. in headless mode. */
 
 protected:
 
@@ -257,9 +259,13 @@ private:
     TPureFloat m_fDamageAreaPulse;                         /**< Area damage pulse to HP as defined by weapon file. Used by both PGE client and server instances. */
 
     PureObject3D* m_obj;                                   /**< Associated Pure object to be rendered. Used by PGE server and client instances.
+                                                                Null if graphics is not initialized e.g. in headless mode.
                                                                 TODO: shared ptr would be better though, so deleting the obj earlier than bullet
                                                                 instance wouldn't be a problem. */
     bool m_bCreateSentToClients;                           /**< Server should send update to clients about creation of new bullets. By default false, client ignores. */
+    bool m_bSimulationLoaded;                              /**< Cleared by init(), set by BulletSimulation when it has loaded the kinematics of this bullet. */
+
+    friend class BulletSimulation;                         /* BulletSimulation writes back position and travelled distance. */
 
     // ---------------------------------------------------------------------------
 
@@ -310,13 +316,72 @@ public:
 
     virtual void onSetUsed() override
     {
-        if (!used())
+        if (!used() && hasObject3D())
         {
             getObject3D().SetRenderingAllowed(false);
         }
     }
 }; // class PooledBullet
 
+/**
+    Weapon CVARs compiled into typed values.
+    Weapon functions invoked for every shot read these instead of looking up and parsing the same strings in getVars() again and again.
+    Filled by Weapon::updateStats(), the validation of the values is still done by the Weapon ctor.
+*/
+struct WeaponStats
+{
+    int m_nFiringCooldownMillisecs;          /**< firing_cooldown */
+    TPureUInt m_nCapMax;                     /**< cap_max */
+    TPureUInt m_nReloadable;                 /**< reloadable: magazine capacity, 0 if the weapon is not reloadable. */
+    TPureUInt m_nBulletsDefault;             /**< bullets_default */
+    int m_nReloadTimeMillisecs;              /**< reload_time */
+    bool m_bReloadPerMag;                    /**< reload_per_mag */
+    bool m_bReloadWholeMag;                  /**< reload_whole_mag */
+
+    float m_fAccAngle;                       /**< acc_angle */
+    float m_fAccMWalk;                       /**< acc_m_walk */
+    float m_fAccMRun;                        /**< acc_m_run */
+    float m_fAccMDuck;                       /**< acc_m_duck */
+    float m_fRecoilM;                        /**< recoil_m */
+    float m_fRecoilCooldownMillisecs;        /**< recoil_cooldown */
+
+    bool m_bBulletVisible;                   /**< bullet_visible */
+    bool m_bBulletFragile;                   /**< bullet_fragile */
+    float m_fBulletSizeX;                    /**< bullet_size_x */
+    float m_fBulletSizeY;                    /**< bullet_size_y */
+    float m_fBulletSizeZ;                    /**< bullet_size_z */
+    float m_fBulletSpeed;                    /**< bullet_speed */
+    float m_fBulletGravity;                  /**< bullet_gravity */
+    float m_fBulletDrag;                     /**< bullet_drag */
+    float m_fBulletDistanceMax;              /**< bullet_distance_max */
+    Bullet::ParticleType m_eBulletParticle;  /**< bullet_particle */
+
+    int m_nDamageAp;                         /**< damage_ap */
+    int m_nDamageHp;                         /**< damage_hp */
+    float m_fDamageAreaSize;                 /**< damage_area_size */
+    float m_fDamageAreaPulse;                /**< damage_area_pulse */
+    Bullet::DamageAreaEffect m_eDamageAreaEffect;  /**< damage_area_effect */
+}; // struct WeaponStats
+
+/**
+    Everything needed to spawn a bullet fired by a weapon, so instead of the bullet itself, only this needs to be replicated to clients:
+    both server and client spawn the bullet by Weapon::spawnBullet() and simulate it on their own.
+    The spread of the bullet is not stored, it is calculated from the shooter, the weapon and the shot number by
+    Weapon::getDeterministicRelativeBulletAngle(), the same way on both sides.
+    All members are fixed width, and the message is written and read field by field by Weapon::fillPktMsgAppBulletSpawn() and
+    Weapon::readMsgAppBulletSpawn(), so neither the layout nor the padding of this struct is sent, sender and receiver can be built
+    for different platforms.
+*/
+struct MsgBulletSpawn
+{
+    pge_network::PgeNetworkConnectionHandle m_connHandle;  /**< Owner (shooter) of the weapon. */
+    uint64_t m_nWpnId;                                     /**< WeaponId of the weapon, widened so its size does not depend on the platform. */
+    uint32_t m_nShot;                                      /**< Shot number of the weapon of the shooter, see Weapon::getShotCounter(). */
+    TPureFloat m_pos[3];                                   /**< Position of the weapon when firing. */
+    TPureFloat m_angle[3];                                 /**< Angles of the weapon when firing, without spread. */
+    TPureFloat m_fAccuracy;                                /**< Momentary accuracy of the weapon when firing, see Weapon::getMomentaryAccuracy(). */
+}; // struct MsgBulletSpawn
+
 /**
     Weapon class for PR00F's Game Engine Weapon Manager
 */
@@ -350,9 +415,24 @@ public:
     };
 
     static constexpr TPureFloat WpnYBiasToPlayerCenter{ 0.15f };  // TODO: I guess this supposed to be get/set through functions later based on something ...
+    static constexpr uint32_t nMaxShotCounterStep{ 1024u };        /**< spawnBullet() moves the shot counter forward by less than this only. */
+    static constexpr std::size_t nMsgBulletSpawnMaxBytes{ 46u };   /**< Max size of the app message data written by fillPktMsgAppBulletSpawn(). */
 
     static const char* getLoggerModuleName();          /**< Returns the logger module name of this class. */
     static std::string stateToString(const State& eState);
+    static float getDeterministicRelativeBulletAngle(
+        const float& fAccuracy,
+        const pge_network::PgeNetworkConnectionHandle& connHandle,
+        const WeaponId& wpnId,
+        const uint32_t& nShot);                        /**< Returns the relative angle of a bullet, same on server and client. */
+    static bool fillPktMsgAppBulletSpawn(
+        pge_network::PgePacket& pkt,
+        const pge_network::MsgApp::TMsgId& msgAppId,
+        const MsgBulletSpawn& spawn);                  /**< Adds the given bullet spawn as app message to the given packet. */
+    static bool readMsgAppBulletSpawn(
+        const pge_network::TByte* pMsgAppData,
+        const pge_network::MsgApp::TMsgSize& nMsgAppDataSize,
+        MsgBulletSpawn& spawn);                        /**< Reads the bullet spawn added by fillPktMsgAppBulletSpawn() from the given app message data. */
 
     // ---------------------------------------------------------------------------
 
@@ -366,11 +446,21 @@ public:
 
     CConsole&   getConsole() const;                     /**< Returns access to console preset with logger module name as this class. */
 
+    std::map<std::string, PGEcfgVariable>& getVars();              /**< Returns the CVARs of this weapon, the typed stats are compiled again by the next getStats(). */
+    const std::map<std::string, PGEcfgVariable>& getVars() const;  /**< Returns the CVARs of this weapon. */
+    bool setVar(const std::string& sVarName, const PGEcfgVariable& value);  /**< Sets the given CVAR of this weapon and compiles the typed stats again. */
+    const WeaponStats& getStats() const;                /**< Returns the typed stats compiled from the CVARs of this weapon. */
+    void updateStats();                                 /**< Compiles the CVARs of this weapon into the typed stats. */
+
     const WeaponId& getUniqueId() const;
     const Type& getType() const;
 
     PureObject3D& getObject3D();                        /**< Returns the graphical object entity associated to this weapon object. */
     const PureObject3D& getObject3D() const;            /**< Returns the graphical object entity associated to this weapon object. */
+    PureVector& getPosVec();                            /**< Returns the position of this weapon object. */
+    const PureVector& getPosVec() const;                /**< Returns the position of this weapon object. */
+    PureVector& getAngleVec();                          /**< Returns the angles of this weapon object. */
+    const PureVector& getAngleVec() const;              /**< Returns the angles of this weapon object. */
     void UpdatePosition(
         const PureVector& playerPos, bool bStickToCenter);   /**< Updates the graphical object entity associated to this weapon object. */
     void UpdatePositions(
@@ -419,7 +509,11 @@ public:
     float getMaximumRecoilMultiplier() const;                                        /**< Returns the weapon's maximum recoil multiplier. */
     float getMomentaryAccuracy(bool bMoving, bool bRun, bool bDuck) const;           /**< Returns the calculated momentary accuracy based on all factors. */
     float getLowestAccuracyPossible() const;                                         /**< Returns a positive relative bullet angle representing the lowest possible accuracy with this weapon. */
-    float getRandomRelativeBulletAngle(bool bMoving, bool bRun, bool bDuck) const;   /**< Returns a random relative angle for a bullet. */
+    float getRandomRelativeBulletAngle(bool bMoving, bool bRun, bool bDuck) const;   /**< Returns a random relative angle for the next bullet. */
+
+    uint32_t getShotCounter() const;                    /**< Returns the shot number of the next bullet fired by this weapon. */
+    const MsgBulletSpawn& getLastBulletSpawn() const;   /**< Returns the spawn of the last bullet fired by pullTrigger(). */
+    PooledBullet* spawnBullet(const MsgBulletSpawn& spawn);   /**< Creates a bullet in the pool as fired by this weapon. */
 
     SoLoud::Wav& getFiringSound();
     SoLoud::Wav& getDryFiringSound();
@@ -434,6 +528,9 @@ public:
         m_audio(other.m_audio),
         m_gfx(other.m_gfx),
         m_connHandle(other.m_connHandle),
+        m_obj(NULL),
+        m_vecPos(other.m_vecPos),
+        m_vecAngle(other.m_vecAngle),
         m_id(other.m_id),
         m_type(other.m_type),
         m_state(other.m_state),
@@ -444,9 +541,19 @@ public:
         m_timeReloadStarted(other.m_timeReloadStarted),
         m_timeLastShot(other.m_timeLastShot),
         m_bAvailable(false),
-        m_bTriggerReleased(true)
+        m_bTriggerReleased(true),
+        m_stats(other.m_stats),
+        m_bStatsDirty(other.m_bStatsDirty),
+        m_nShotCounter(other.m_nShotCounter),
+        m_lastBulletSpawn(other.m_lastBulletSpawn)
     {
         // TODO: this is same as in regular ctor and operator=
+        if (!other.m_obj)
+        {
+            // headless mode
+            return;
+        }
+
         m_obj = m_gfx.getObject3DManager().createPlane(other.m_obj->getSizeVec().getX(), other.m_obj->getSizeVec().getY());
         m_obj->SetDoubleSided(true);
         m_obj->Hide();
@@ -463,6 +570,10 @@ public:
 
     Weapon& operator=(const Weapon& other) // TODO check if we really cannot live with just compiler generated operator_=?
     {
+        // CVARs and the stats compiled from them go together, same as in copy ctor
+        PGEcfgFile::operator=(other);
+        m_stats = other.m_stats;
+        m_bStatsDirty = other.m_bStatsDirty;
         //m_bullets = other.m_bullets;
         //m_audio = other.m_audio; // deleted assignment operator
         m_gfx = other.m_gfx;
@@ -476,10 +587,21 @@ public:
         m_nBulletsToReload = other.m_nBulletsToReload;
         m_timeReloadStarted = other.m_timeReloadStarted;
         m_timeLastShot = other.m_timeLastShot;
+        m_vecPos = other.m_vecPos;
+        m_vecAngle = other.m_vecAngle;
         m_bAvailable = other.m_bAvailable;
         m_bTriggerReleased = other.m_bTriggerReleased;
+        m_nShotCounter = other.m_nShotCounter;
+        m_lastBulletSpawn = other.m_lastBulletSpawn;
 
         // TODO: this is same as in regular ctor and copy ctor
+        if (!other.m_obj)
+        {
+            // headless mode
+            m_obj = NULL;
+            return *this;
+        }
+
         m_obj = m_gfx.getObject3DManager().createPlane(other.m_obj->getSizeVec().getX(), other.m_obj->getSizeVec().getY());
         m_obj->SetDoubleSided(true);
         m_obj->Hide();
@@ -510,7 +632,9 @@ private:
     pge_audio::PgeAudio& m_audio;
     PR00FsUltimateRenderingEngine& m_gfx;
     pge_network::PgeNetworkConnectionHandle m_connHandle;  /**< Owner (shooter) of this weapon. Should be used by PGE server instance only. */
-    PureObject3D* m_obj;
+    PureObject3D* m_obj;                               /**< Null if graphics is not initialized e.g. in headless mode. */
+    PureVector m_vecPos;                               /**< Position when there is no m_obj, otherwise position of m_obj is used. */
+    PureVector m_vecAngle;                             /**< Angles when there is no m_obj, otherwise angles of m_obj are used. */
     WeaponId m_id{};                                   /**< Unique ID, filled by ctor. */
     Type m_type{};                                     /**< Type of weapon, filled by ctor. */
     PgeOldNewValue<State> m_state;                     /**< State as calculated and updated by PGE server instance. */
@@ -522,6 +646,10 @@ private:
     PFL::timeval m_timeLastShot;                       /**< Only updated during pullTrigger() / Update(). Should be managed by PGE server instance. */
     bool m_bAvailable;                                 /**< Flag for the game, e.g. if true then the player has this weapon. */
     bool m_bTriggerReleased;                           /**< True if trigger is released, false when being pulled. True by default. */
+    mutable WeaponStats m_stats{};                     /**< Compiled from getVars() by compileStats(). */
+    mutable bool m_bStatsDirty;                        /**< Set by non-const getVars(), since the returned CVARs might be modified by the caller. */
+    uint32_t m_nShotCounter;                           /**< Shot number of the next bullet, keys the bullet spread together with owner and id. */
+    MsgBulletSpawn m_lastBulletSpawn;                  /**< Filled by pullTrigger(), to be replicated to clients. */
     SoLoud::Wav m_sndShoot;
     SoLoud::Wav m_sndShootDry;
     SoLoud::Wav m_sndReloadStart;
@@ -534,6 +662,7 @@ private:
     Weapon();
 
     void UpdateGraphics();
+    void compileStats() const;
 
 }; // class Weapon
 